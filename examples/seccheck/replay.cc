@@ -0,0 +1,455 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// replay sends events recorded by server.cc (see -o) to a seccheck sink, the
+// same way a sandbox would. It's used to benchmark sinks with a reproducible
+// load, without running sandboxes.
+
+#include <err.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/strings/string_view.h"
+#include "pkg/sentry/seccheck/points/common.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+
+// LINT.IfChange
+#pragma pack(push, 1)
+struct header {
+  uint16_t header_size;
+  uint16_t message_type;
+  uint32_t dropped_count;
+};
+#pragma pack(pop)
+// LINT.ThenChange(../../pkg/sentry/seccheck/sinks/remote/wire/wire.go)
+
+constexpr size_t maxEventSize = 300 * 1024;
+
+// Number of log2 buckets in latency histograms, enough for any int64_t value.
+constexpr int latencyBuckets = 64;
+
+// If greater than 0, events are sent at the pace they were generated in the
+// sandbox, sped up by this factor. Otherwise, they are sent as fast as the
+// sink takes them.
+double speed = 0;
+
+// Events due in less than this are sent right away, because such short sleeps
+// overshoot by about as much as they last and events would fall behind.
+constexpr int64_t minSleepNs = 100 * 1000;
+
+// If set, sends never block. Events that don't fit in the socket are dropped
+// and reported in the header of the next event, like the sentry does.
+bool drop = false;
+
+// If set, the time in the context of each event is replaced with the time it
+// was sent. The sink's ingest latency is then measured from the send, e.g.
+// with server_cc -s.
+bool restamp = false;
+
+int64_t now(clockid_t clock) {
+  timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+// Histogram counts latencies in log2 buckets.
+struct Histogram {
+  void add(int64_t ns) {
+    count++;
+    sum_ns += ns;
+    max_ns = std::max(max_ns, ns);
+    buckets[ns == 0 ? 0 : 64 - __builtin_clzll(ns)]++;
+  }
+
+  void merge(const Histogram& other) {
+    count += other.count;
+    sum_ns += other.sum_ns;
+    max_ns = std::max(max_ns, other.max_ns);
+    for (int i = 0; i < latencyBuckets; ++i) {
+      buckets[i] += other.buckets[i];
+    }
+  }
+
+  // percentile returns the upper bound of the bucket that contains the qth
+  // latency.
+  double percentile(double q) const {
+    uint64_t target = q * count;
+    uint64_t seen = 0;
+    for (int i = 0; i < latencyBuckets; ++i) {
+      seen += buckets[i];
+      if (seen > target) {
+        return std::min(static_cast<double>(max_ns), std::ldexp(1.0, i));
+      }
+    }
+    return max_ns;
+  }
+
+  void print(const char* name) const {
+    if (count == 0) {
+      return;
+    }
+    printf("  %s(us) avg=%.1f p50<=%.1f p99<=%.1f max=%.1f\n", name,
+           sum_ns / 1e3 / count, percentile(0.5) / 1e3, percentile(0.99) / 1e3,
+           max_ns / 1e3);
+  }
+
+  uint64_t count = 0;
+  double sum_ns = 0;
+  int64_t max_ns = 0;
+  // Bucket i counts latencies in [2^(i-1), 2^i) nanoseconds.
+  std::array<uint64_t, latencyBuckets> buckets = {};
+};
+
+// Event is a recorded event. time_off is the offset of the time in its
+// context, or 0 if it doesn't have one.
+struct Event {
+  absl::string_view buf;
+  int64_t time_ns = 0;
+  size_t time_off = 0;
+};
+
+// skipField skips the value of the field with the given tag. Returns false if
+// the message is malformed.
+bool skipField(google::protobuf::io::CodedInputStream* in, uint32_t tag) {
+  uint64_t varint;
+  uint32_t len;
+  switch (tag & 7) {
+    case 0:  // Varint.
+      return in->ReadVarint64(&varint);
+    case 1:  // 64-bit.
+      return in->Skip(8);
+    case 2:  // Length delimited.
+      return in->ReadVarint32(&len) && in->Skip(len);
+    case 5:  // 32-bit.
+      return in->Skip(4);
+    default:  // Groups are not used.
+      return false;
+  }
+}
+
+// findTime sets the time of evt and the offset of the varint that holds it, if
+// the event has one. All event messages carry context_data as field 1, and
+// time_ns is field 1 of ContextData, see common.proto.
+void findTime(Event* evt) {
+  constexpr uint32_t contextDataTag = (1 << 3) | 2;
+  constexpr uint32_t timeTag = (1 << 3) | 0;
+  const header* hdr = reinterpret_cast<const header*>(evt->buf.data());
+  if (hdr->header_size < sizeof(header) || hdr->header_size > evt->buf.size()) {
+    return;
+  }
+  absl::string_view proto = evt->buf.substr(hdr->header_size);
+  google::protobuf::io::CodedInputStream in(
+      reinterpret_cast<const uint8_t*>(proto.data()), proto.size());
+  for (uint32_t tag; (tag = in.ReadTag()) != 0;) {
+    if (tag != contextDataTag) {
+      if (!skipField(&in, tag)) {
+        return;
+      }
+      continue;
+    }
+    uint32_t len;
+    if (!in.ReadVarint32(&len)) {
+      return;
+    }
+    in.PushLimit(len);
+    while ((tag = in.ReadTag()) != 0) {
+      if (tag == timeTag) {
+        size_t off = hdr->header_size + in.CurrentPosition();
+        uint64_t time_ns;
+        if (in.ReadVarint64(&time_ns)) {
+          evt->time_ns = time_ns;
+          evt->time_off = off;
+        }
+        return;
+      }
+      if (!skipField(&in, tag)) {
+        return;
+      }
+    }
+    return;
+  }
+}
+
+// setTime replaces the time in buf, which is a copy of evt. The time is only
+// replaced if it takes as many bytes as the recorded time, which is always the
+// case for times that are close enough.
+void setTime(const Event& evt, char* buf, int64_t time_ns) {
+  // Varints take at most 10 bytes.
+  uint8_t varint[10];
+  uint8_t* end = google::protobuf::io::CodedOutputStream::WriteVarint64ToArray(
+      time_ns, varint);
+  size_t len = end - varint;
+  if (len == google::protobuf::io::CodedOutputStream::VarintSize64(
+                 evt.time_ns)) {
+    memcpy(buf + evt.time_off, varint, len);
+  }
+}
+
+// loadFile maps a file recorded by server.cc and appends its events to events.
+// See Recorder in server.cc for the format.
+void loadFile(const char* name, std::vector<Event>* events) {
+  int fd = open(name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    err(1, "open(%s)", name);
+  }
+  auto closer = absl::MakeCleanup([fd] { close(fd); });
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    err(1, "fstat(%s)", name);
+  }
+  if (st.st_size == 0) {
+    return;
+  }
+  // The mapping is never released, events point into it.
+  void* mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mem == MAP_FAILED) {
+    err(1, "mmap(%s)", name);
+  }
+  absl::string_view data(static_cast<const char*>(mem), st.st_size);
+  while (!data.empty()) {
+    uint32_t size;
+    if (data.size() < sizeof(size)) {
+      errx(1, "%s: truncated record after %zu events", name, events->size());
+    }
+    memcpy(&size, data.data(), sizeof(size));
+    data.remove_prefix(sizeof(size));
+    if (size > data.size() || size > maxEventSize) {
+      errx(1, "%s: truncated record after %zu events", name, events->size());
+    }
+    Event evt;
+    evt.buf = data.substr(0, size);
+    data.remove_prefix(size);
+    if (evt.buf.size() < sizeof(header)) {
+      printf("%s: skipping message smaller than header\n", name);
+      continue;
+    }
+    findTime(&evt);
+    events->push_back(evt);
+  }
+}
+
+// connectSink connects to the sink listening at path and performs the version
+// exchange. See common.proto for details about the protocol.
+int connectSink(const std::string& path) {
+  int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    err(1, "socket");
+  }
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    errx(1, "socket path too long: %s", path.c_str());
+  }
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    err(1, "connect(%s)", path.c_str());
+  }
+
+  ::gvisor::common::Handshake out;
+  out.set_version(1);
+  if (!out.SerializeToFileDescriptor(fd)) {
+    err(1, "sending handshake message");
+  }
+  std::vector<char> buf(10240);
+  int bytes = read(fd, buf.data(), buf.size());
+  if (bytes < 0) {
+    err(1, "receiving handshake message");
+  }
+  ::gvisor::common::Handshake in;
+  if (bytes == static_cast<int>(buf.size()) ||
+      !in.ParseFromArray(buf.data(), bytes)) {
+    errx(1, "invalid handshake message");
+  }
+  if (in.version() < 1) {
+    errx(1, "sink has unsupported version %u", in.version());
+  }
+  return fd;
+}
+
+// Result is what a connection measured while replaying events.
+struct Result {
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+  uint64_t dropped = 0;
+  // Time spent in send(2), which grows when the sink falls behind.
+  Histogram send;
+  // Time between when events were meant to be sent and when they were, when
+  // events are paced.
+  Histogram lag;
+};
+
+// replay sends all events to fd the given number of times. When pacing, events
+// are scheduled using the times in their context, and events without a time
+// are sent right after the previous one.
+void replay(int fd, const std::vector<Event>& events, int loops,
+            Result* result) {
+  std::vector<char> copy(maxEventSize);
+  uint32_t dropped = 0;
+  for (int loop = 0; loop < loops; ++loop) {
+    int64_t start_ns = now(CLOCK_MONOTONIC);
+    int64_t first_ns = 0;
+    int64_t last_ns = 0;
+    for (const Event& evt : events) {
+      int64_t due_ns = 0;
+      if (speed > 0 && evt.time_ns != 0) {
+        if (first_ns == 0) {
+          first_ns = evt.time_ns;
+        }
+        // Events are recorded in the order they are received, which isn't
+        // exactly the order they were generated. Never go back in time.
+        last_ns = std::max(last_ns, evt.time_ns);
+        due_ns = start_ns + (last_ns - first_ns) / speed;
+        if (due_ns - now(CLOCK_MONOTONIC) >= minSleepNs) {
+          timespec ts = {due_ns / 1000000000, due_ns % 1000000000};
+          while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+                                 nullptr) == EINTR) {
+          }
+        }
+      }
+
+      // The header is always updated, so send a copy of the event. The copy
+      // isn't included in the send latency.
+      memcpy(copy.data(), evt.buf.data(), evt.buf.size());
+      reinterpret_cast<header*>(copy.data())->dropped_count = dropped;
+      if (restamp && evt.time_off != 0) {
+        setTime(evt, copy.data(), now(CLOCK_REALTIME));
+      }
+      int64_t before_ns = now(CLOCK_MONOTONIC);
+      ssize_t n;
+      do {
+        n = send(fd, copy.data(), evt.buf.size(),
+                 MSG_NOSIGNAL | (drop ? MSG_DONTWAIT : 0));
+      } while (n < 0 && errno == EINTR);
+      int64_t after_ns = now(CLOCK_MONOTONIC);
+      if (n < 0) {
+        if (drop && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          dropped++;
+          result->dropped++;
+          continue;
+        }
+        err(1, "send");
+      }
+      result->events++;
+      result->bytes += n;
+      result->send.add(after_ns - before_ns);
+      if (due_ns != 0) {
+        result->lag.add(std::max<int64_t>(0, before_ns - due_ns));
+      }
+    }
+  }
+}
+
+void printResult(const char* title, const Result& r, int64_t elapsed_ns) {
+  double sec = elapsed_ns / 1e9;
+  printf("%s: %lu events, %lu dropped, %.1f MiB in %.3f s: %.0f events/s, "
+         "%.1f MiB/s\n",
+         title, r.events, r.dropped, r.bytes / double(1 << 20), sec,
+         r.events / sec, r.bytes / double(1 << 20) / sec);
+  r.send.print("send latency");
+  r.lag.print("schedule lag");
+}
+
+int main(int argc, char** argv) {
+  int conns = 1;
+  int loops = 1;
+  for (int c = 0; (c = getopt(argc, argv, "dl:n:Tt:")) != -1;) {
+    switch (c) {
+      case 'd':
+        drop = true;
+        break;
+      case 'l':
+        loops = atoi(optarg);
+        if (loops <= 0) {
+          errx(1, "invalid loop count: %s", optarg);
+        }
+        break;
+      case 'n':
+        conns = atoi(optarg);
+        if (conns <= 0) {
+          errx(1, "invalid connection count: %s", optarg);
+        }
+        break;
+      case 'T':
+        restamp = true;
+        break;
+      case 't':
+        speed = atof(optarg);
+        if (!(speed > 0)) {
+          errx(1, "invalid speed: %s", optarg);
+        }
+        break;
+      default:
+        exit(1);
+    }
+  }
+  if (argc - optind < 2) {
+    errx(1, "usage: %s [-d] [-l loops] [-n connections] [-T] [-t speed] "
+            "<socket> <file>...",
+         argv[0]);
+  }
+  std::string path = argv[optind];
+
+  std::vector<Event> events;
+  for (int i = optind + 1; i < argc; ++i) {
+    loadFile(argv[i], &events);
+  }
+  printf("Loaded %zu events\n", events.size());
+
+  std::vector<int> fds;
+  for (int i = 0; i < conns; ++i) {
+    fds.push_back(connectSink(path));
+  }
+
+  // Each connection replays all events, as if they came from a different
+  // sandbox.
+  std::vector<Result> results(conns);
+  int64_t start_ns = now(CLOCK_MONOTONIC);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < conns; ++i) {
+    threads.emplace_back(
+        [&, i] { replay(fds[i], events, loops, &results[i]); });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  int64_t elapsed_ns = now(CLOCK_MONOTONIC) - start_ns;
+
+  Result total;
+  for (int i = 0; i < conns; ++i) {
+    close(fds[i]);
+    total.events += results[i].events;
+    total.bytes += results[i].bytes;
+    total.dropped += results[i].dropped;
+    total.send.merge(results[i].send);
+    total.lag.merge(results[i].lag);
+  }
+  printResult("Replayed", total, elapsed_ns);
+  return 0;
+}
@@ -13,34 +13,549 @@
 // limitations under the License.
 
 #include <err.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <sys/epoll.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "pkg/sentry/seccheck/points/common.pb.h"
 #include "pkg/sentry/seccheck/points/container.pb.h"
 #include "pkg/sentry/seccheck/points/sentry.pb.h"
 #include "pkg/sentry/seccheck/points/syscall.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
 
-typedef std::function<void(absl::string_view buf)> Callback;
+typedef std::function<void(absl::string_view buf,
+                           google::protobuf::Arena* arena)>
+    Callback;
+
+// EventSummary holds the fields of an event that are aggregated. Strings point
+// into the received event and are only valid while it's being handled.
+struct EventSummary {
+  absl::string_view container_id;
+  int64_t errorno = 0;
+  absl::string_view path;
+};
+
+typedef std::function<bool(absl::string_view buf, EventSummary* out)>
+    Summarizer;
+
+typedef std::function<std::unique_ptr<google::protobuf::Message>(
+    absl::string_view buf)>
+    Decoder;
+
+typedef std::function<void(const google::protobuf::Message& msg)> Printer;
+
+struct Dispatcher {
+  // Decodes and prints the event.
+  Callback unpack;
+  // Extracts the fields that are aggregated, without decoding the event.
+  // Returns false if the event is malformed.
+  Summarizer summarize;
+  // Decodes the event into a message that outlives the batch. Returns nullptr
+  // if the event is malformed.
+  Decoder decode;
+  // Prints an event returned by decode.
+  Printer print;
+};
 
 constexpr size_t maxEventSize = 300 * 1024;
 
+// Number of messages received with a single recvmmsg(2) call, or read from a
+// ring before the ring's consumer position is updated.
+constexpr int recvBatchSize = 16;
+
+// Shared memory ring transport. See
+// pkg/sentry/seccheck/sinks/remote/wire/wire.go for details.
+// LINT.IfChange
+constexpr uint32_t ringVersion = 2;
+constexpr size_t ringHeaderSize = 4096;
+constexpr size_t ringProducerOffset = 0;
+constexpr size_t ringConsumerOffset = 64;
+constexpr size_t ringFlagsOffset = 128;
+constexpr uint64_t ringAlignment = 8;
+constexpr uint32_t ringPadding = ~0u;
+constexpr uint32_t ringFlagWakeup = 1;
+constexpr uint32_t ringMinSize = 64 << 10;
+constexpr uint32_t ringMaxSize = 1 << 30;
+// LINT.ThenChange(../../pkg/sentry/seccheck/sinks/remote/wire/wire.go)
+
+// Size of the block that each worker reserves for decoding a batch of events.
+// Events that don't fit in it spill to blocks allocated by the arena.
+constexpr size_t arenaBlockSize = 1024 * 1024;
+
 bool quiet = false;
 
+// If not empty, only events from this container are processed.
+std::string container_filter;
+
+// Recorded events are buffered per worker and handed to the recorder once the
+// buffer reaches this size, or after recordFlushTimeoutMs without new events.
+constexpr size_t recordFlushSize = 1024 * 1024;
+constexpr int recordFlushTimeoutMs = 1000;
+
+// Maximum number of buffers waiting to be written. Workers block when the
+// recorder falls behind, which makes sandboxes drop events and report it.
+constexpr size_t recordMaxPending = 64;
+
+// Recorder writes events to a set of files, each one a sequence of records.
+// Every record is a 32-bit native endian size followed by the event exactly as
+// it was received from the sandbox, header included. Files are named
+// <prefix>.<N>, starting at 0, and a new file is started once the current one
+// grows past the rotation size. Writes happen on a separate thread. See
+// replay() for a reader.
+class Recorder {
+ public:
+  Recorder(std::string prefix, uint64_t rotate_size)
+      : prefix_(std::move(prefix)), rotate_size_(rotate_size) {
+    openNext();
+    std::thread([this] { writeLoop(); }).detach();
+  }
+
+  // append adds one event to buf in the record format.
+  static void append(std::string* buf, absl::string_view event) {
+    uint32_t size = event.size();
+    buf->append(reinterpret_cast<const char*>(&size), sizeof(size));
+    buf->append(event.data(), event.size());
+  }
+
+  // submit queues buf to be written and leaves it empty.
+  void submit(std::string* buf) {
+    std::unique_lock<std::mutex> lock(mu_);
+    space_.wait(lock, [this] { return pending_.size() < recordMaxPending; });
+    pending_.push_back(std::move(*buf));
+    buf->clear();
+    ready_.notify_one();
+  }
+
+ private:
+  void openNext() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    std::string name = absl::StrCat(prefix_, ".", index_++);
+    fd_ = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      err(1, "open(%s)", name.c_str());
+    }
+    file_size_ = 0;
+    printf("Recording events to %s\n", name.c_str());
+  }
+
+  void writeLoop() {
+    for (;;) {
+      std::string buf;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        ready_.wait(lock, [this] { return !pending_.empty(); });
+        buf = std::move(pending_.front());
+        pending_.pop_front();
+        space_.notify_one();
+      }
+      // Buffers only contain whole records, so files never split a record.
+      if (file_size_ > 0 && file_size_ + buf.size() > rotate_size_) {
+        openNext();
+      }
+      for (size_t done = 0; done < buf.size();) {
+        ssize_t n = write(fd_, buf.data() + done, buf.size() - done);
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          err(1, "write");
+        }
+        done += n;
+      }
+      file_size_ += buf.size();
+    }
+  }
+
+  const std::string prefix_;
+  const uint64_t rotate_size_;
+  int fd_ = -1;
+  int index_ = 0;
+  uint64_t file_size_ = 0;
+
+  std::mutex mu_;
+  std::condition_variable ready_;
+  std::condition_variable space_;
+  std::deque<std::string> pending_;
+};
+
+// If set, events are recorded instead of being unpacked.
+Recorder* recorder = nullptr;
+
+// Number of most frequent paths printed in each summary.
+constexpr size_t topPaths = 10;
+
+// Maximum number of distinct paths tracked per interval. Paths seen after the
+// table is full are only counted in the total.
+constexpr size_t maxPaths = 64 * 1024;
+
+// Aggregator counts events per container, message type and errno, and the
+// number of times each path is used.
+class Aggregator {
+ public:
+  void add(uint16_t message_type, const EventSummary& summary) {
+    auto it = counts_.find(summary.container_id);
+    if (it == counts_.end()) {
+      it = counts_.emplace(std::string(summary.container_id), Counts()).first;
+    }
+    it->second[{message_type, summary.errorno}]++;
+    if (!summary.path.empty()) {
+      addPath(summary.path, 1);
+    }
+  }
+
+  bool empty() const { return counts_.empty(); }
+
+  // merge adds all counts from other into this aggregator and clears other.
+  void merge(Aggregator* other) {
+    for (const auto& [container_id, counts] : other->counts_) {
+      Counts& dst = counts_[container_id];
+      for (const auto& [key, count] : counts) {
+        dst[key] += count;
+      }
+    }
+    for (const auto& [path, count] : other->paths_) {
+      addPath(path, count);
+    }
+    // Add uses of paths that didn't fit in other's table.
+    path_total_ += other->path_total_ - other->path_table_total_;
+    *other = Aggregator();
+  }
+
+  void print(absl::string_view title) const {
+    printf("%.*s\n", static_cast<int>(title.size()), title.data());
+    struct Line {
+      absl::string_view container_id;
+      uint16_t message_type;
+      int64_t errorno;
+      uint64_t count;
+    };
+    std::vector<Line> lines;
+    for (const auto& [container_id, counts] : counts_) {
+      for (const auto& [key, count] : counts) {
+        lines.push_back({container_id, key.first, key.second, count});
+      }
+    }
+    std::sort(lines.begin(), lines.end(),
+              [](const Line& a, const Line& b) { return a.count > b.count; });
+    for (const Line& line : lines) {
+      std::string name = ::gvisor::common::MessageType_Name(
+          static_cast<::gvisor::common::MessageType>(line.message_type));
+      printf("  %10lu %.*s %s errno=%ld\n", line.count,
+             static_cast<int>(line.container_id.size()),
+             line.container_id.data(), name.c_str(), line.errorno);
+    }
+
+    if (path_total_ == 0) {
+      return;
+    }
+    std::vector<std::pair<absl::string_view, uint64_t>> paths(paths_.begin(),
+                                                              paths_.end());
+    size_t top = std::min(topPaths, paths.size());
+    std::partial_sort(
+        paths.begin(), paths.begin() + top, paths.end(),
+        [](const auto& a, const auto& b) { return a.second > b.second; });
+    printf("  Top paths (%lu uses, %zu distinct paths tracked):\n", path_total_,
+           paths.size());
+    for (size_t i = 0; i < top; ++i) {
+      printf("  %10lu %.*s\n", paths[i].second,
+             static_cast<int>(paths[i].first.size()), paths[i].first.data());
+    }
+  }
+
+ private:
+  void addPath(absl::string_view path, uint64_t count) {
+    path_total_ += count;
+    auto it = paths_.find(path);
+    if (it != paths_.end()) {
+      it->second += count;
+    } else if (paths_.size() < maxPaths) {
+      paths_.emplace(std::string(path), count);
+    } else {
+      return;
+    }
+    path_table_total_ += count;
+  }
+
+  // Counts indexed by message type and errno.
+  typedef absl::flat_hash_map<std::pair<uint16_t, int64_t>, uint64_t> Counts;
+  absl::flat_hash_map<std::string, Counts> counts_;
+
+  absl::flat_hash_map<std::string, uint64_t> paths_;
+  // Number of path uses, including the ones that didn't fit in paths_.
+  uint64_t path_total_ = 0;
+  // Number of path uses counted in paths_.
+  uint64_t path_table_total_ = 0;
+};
+
+// If set, events are aggregated instead of being printed and summaries are
+// printed every aggregate_interval_sec.
+int aggregate_interval_sec = 0;
+
+// Number of log2 buckets in latency histograms, enough for any int64_t value.
+constexpr int latencyBuckets = 64;
+
+// Stats counts events and drops per client, and events and ingest latency per
+// message type. Ingest latency is the time from when the sentry generated the
+// event until it was received, including the time spent queued in the sentry
+// and in the socket or ring. It's only known for points that have the "time"
+// context field enabled.
+//
+// The sentry only reports the total number of events dropped, so drops can't be
+// attributed to message types.
+class Stats {
+ public:
+  // addEvent counts an event. latency_ns is negative if it's unknown.
+  void addEvent(uint64_t client_id, uint16_t message_type, int64_t latency_ns) {
+    clients_[client_id].events++;
+    PointStats& point = points_[message_type];
+    point.events++;
+    if (latency_ns < 0) {
+      return;
+    }
+    point.latency_count++;
+    point.latency_sum_ns += latency_ns;
+    point.latency_max_ns = std::max(point.latency_max_ns, latency_ns);
+    point.buckets[bucket(latency_ns)]++;
+  }
+
+  // addDropped counts events dropped by a client since it last reported drops.
+  // total is the number of events dropped by the client since it connected.
+  void addDropped(uint64_t client_id, uint32_t dropped, uint32_t total) {
+    ClientStats& client = clients_[client_id];
+    client.dropped += dropped;
+    client.dropped_total = total;
+  }
+
+  // merge adds all stats from other into this and clears other.
+  void merge(Stats* other) {
+    for (const auto& [id, src] : other->clients_) {
+      ClientStats& dst = clients_[id];
+      dst.events += src.events;
+      dst.dropped += src.dropped;
+      dst.dropped_total = std::max(dst.dropped_total, src.dropped_total);
+    }
+    for (const auto& [message_type, src] : other->points_) {
+      PointStats& dst = points_[message_type];
+      dst.events += src.events;
+      dst.latency_count += src.latency_count;
+      dst.latency_sum_ns += src.latency_sum_ns;
+      dst.latency_max_ns = std::max(dst.latency_max_ns, src.latency_max_ns);
+      for (int i = 0; i < latencyBuckets; ++i) {
+        dst.buckets[i] += src.buckets[i];
+      }
+    }
+    *other = Stats();
+  }
+
+  void print(absl::string_view title) const {
+    std::vector<std::pair<uint64_t, ClientStats>> clients(clients_.begin(),
+                                                          clients_.end());
+    std::sort(clients.begin(), clients.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+    for (const auto& [id, client] : clients) {
+      events += client.events;
+      dropped += client.dropped;
+    }
+    printf("%.*s %lu events, %lu dropped\n", static_cast<int>(title.size()),
+           title.data(), events, dropped);
+    for (const auto& [id, client] : clients) {
+      printf("  client %lu: %lu events, %lu dropped (%u total)\n", id,
+             client.events, client.dropped, client.dropped_total);
+    }
+    for (const auto& [message_type, point] : points_) {
+      std::string name = ::gvisor::common::MessageType_Name(
+          static_cast<::gvisor::common::MessageType>(message_type));
+      printf("  %s: %lu events", name.c_str(), point.events);
+      if (point.latency_count > 0) {
+        printf(", latency(us) avg=%.1f p50<=%.1f p99<=%.1f max=%.1f",
+               point.latency_sum_ns / 1e3 / point.latency_count,
+               percentile(point, 0.5) / 1e3, percentile(point, 0.99) / 1e3,
+               point.latency_max_ns / 1e3);
+      }
+      printf("\n");
+    }
+  }
+
+ private:
+  struct ClientStats {
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+    uint32_t dropped_total = 0;
+  };
+
+  struct PointStats {
+    uint64_t events = 0;
+    // Number of events with a known latency.
+    uint64_t latency_count = 0;
+    double latency_sum_ns = 0;
+    int64_t latency_max_ns = 0;
+    // Bucket i counts latencies in [2^(i-1), 2^i) nanoseconds.
+    std::array<uint64_t, latencyBuckets> buckets = {};
+  };
+
+  static int bucket(int64_t ns) {
+    return ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+  }
+
+  // percentile returns the upper bound of the bucket that contains the qth
+  // latency.
+  static double percentile(const PointStats& point, double q) {
+    uint64_t target = q * point.latency_count;
+    uint64_t seen = 0;
+    for (int i = 0; i < latencyBuckets; ++i) {
+      seen += point.buckets[i];
+      if (seen > target) {
+        return std::min(static_cast<double>(point.latency_max_ns),
+                        std::ldexp(1.0, i));
+      }
+    }
+    return point.latency_max_ns;
+  }
+
+  absl::flat_hash_map<uint64_t, ClientStats> clients_;
+  absl::flat_hash_map<uint16_t, PointStats> points_;
+};
+
+// If set, stats are printed every stats_interval_sec.
+int stats_interval_sec = 0;
+
+class EventQueue;
+
+// Worker owns an epoll instance and the clients assigned to it. A client is
+// only ever served by the worker that it was assigned to at accept time.
+struct Worker {
+  int poll_fd = -1;
+  // CPU the worker is pinned to, or -1 if it is not pinned.
+  int cpu = -1;
+  // Number of clients currently assigned to this worker.
+  std::atomic<int> clients = 0;
+
+  // Receive buffers, one per message in a batch, each maxEventSize bytes.
+  std::vector<char> buffers;
+  std::array<iovec, recvBatchSize> iovs;
+  std::array<mmsghdr, recvBatchSize> msgs;
+
+  // Arena used to decode events. It's reset after every batch.
+  std::vector<char> arena_block;
+  std::unique_ptr<google::protobuf::Arena> arena;
+
+  // Events waiting to be handed to the recorder.
+  std::string record_buf;
+
+  // Events aggregated since the last summary. The mutex is only contended
+  // when the summary thread collects the counts.
+  std::mutex agg_mu;
+  Aggregator agg;
+
+  // Stats collected since they were last printed, same as above.
+  std::mutex stats_mu;
+  Stats stats;
+
+  // Queues to the in-process sinks, one per sink, in the same order as sinks.
+  std::vector<EventQueue*> queues;
+};
+
+// Ring is the consumer side of the shared memory ring transport.
+struct Ring {
+  ~Ring() {
+    if (mem != nullptr) {
+      munmap(mem, ringHeaderSize + size);
+    }
+    if (doorbell >= 0) {
+      close(doorbell);
+    }
+  }
+
+  uint64_t* producer() const {
+    return reinterpret_cast<uint64_t*>(mem + ringProducerOffset);
+  }
+  uint64_t* consumerPtr() const {
+    return reinterpret_cast<uint64_t*>(mem + ringConsumerOffset);
+  }
+  uint32_t* flags() const {
+    return reinterpret_cast<uint32_t*>(mem + ringFlagsOffset);
+  }
+  const char* data() const { return mem + ringHeaderSize; }
+
+  char* mem = nullptr;
+  // Size of the data area.
+  uint64_t size = 0;
+  // Eventfd signaled by the sentry when messages are published.
+  int doorbell = -1;
+  // Position of the next message to read. It's published to the sentry via
+  // consumerPtr() after messages are processed.
+  uint64_t consumer = 0;
+};
+
+struct Client;
+
+// PollSource is what is registered with epoll for each file descriptor that
+// belongs to a client.
+struct PollSource {
+  Client* client;
+  // Set for the ring doorbell, otherwise it's the client socket.
+  bool doorbell;
+};
+
+struct Client {
+  int fd;
+  Worker* worker;
+  // Identifies the client in logs and stats.
+  uint64_t id = 0;
+  // Set if the client uses the shared memory ring transport.
+  std::unique_ptr<Ring> ring;
+  // Set when the client is closed. The client is deleted after all events
+  // returned by epoll_wait(2) have been processed, because both the socket and
+  // the ring doorbell refer to it.
+  bool closed = false;
+  PollSource socket_source;
+  PollSource doorbell_source;
+  // Last dropped count reported by the client.
+  uint32_t dropped_count = 0;
+  // Number of events and recvmmsg(2) calls that returned events.
+  uint64_t events = 0;
+  uint64_t syscalls = 0;
+};
+
 #pragma pack(push, 1)
 struct header {
   uint16_t header_size;
@@ -59,7 +574,7 @@ void log(const char* fmt, ...) {
 }
 
 template <class T>
-std::string shortfmt(T msg) {
+std::string shortfmt(const T& msg) {
   std::string short_text_msg;
   google::protobuf::TextFormat::PrintToString(msg, &short_text_msg);
   return absl::StrReplaceAll(short_text_msg,
@@ -67,121 +582,296 @@ std::string shortfmt(T msg) {
 }
 
 template <class T>
-void unpackSyscall(absl::string_view buf) {
-  T evt;
-  if (!evt.ParseFromArray(buf.data(), buf.size())) {
-    err(1, "ParseFromString(): %.*s", static_cast<int>(buf.size()), buf.data());
+void printSyscall(const google::protobuf::Message& msg) {
+  if (quiet) {
+    return;
   }
+  const T& evt = static_cast<const T&>(msg);
   absl::string_view name = evt.GetDescriptor()->name();
   log("%s %.*s %s\n", evt.has_exit() ? "X" : "E", static_cast<int>(name.size()),
       name.data(), shortfmt(evt).c_str());
 }
 
 template <class T>
-void unpack(absl::string_view buf) {
-  T evt;
-  if (!evt.ParseFromArray(buf.data(), buf.size())) {
-    err(1, "ParseFromString(): %.*s", static_cast<int>(buf.size()), buf.data());
+void print(const google::protobuf::Message& msg) {
+  if (quiet) {
+    return;
   }
+  const T& evt = static_cast<const T&>(msg);
   absl::string_view name = evt.GetDescriptor()->name();
   log("%.*s => %s\n", static_cast<int>(name.size()), name.data(),
       shortfmt(evt).c_str());
 }
 
+template <class T, void (*Print)(const google::protobuf::Message&)>
+void unpack(absl::string_view buf, google::protobuf::Arena* arena) {
+  T& evt = *google::protobuf::Arena::CreateMessage<T>(arena);
+  if (!evt.ParseFromArray(buf.data(), buf.size())) {
+    err(1, "ParseFromString(): %.*s", static_cast<int>(buf.size()), buf.data());
+  }
+  Print(evt);
+}
+
+template <class T>
+std::unique_ptr<google::protobuf::Message> decode(absl::string_view buf) {
+  auto evt = std::make_unique<T>();
+  if (!evt->ParseFromArray(buf.data(), buf.size())) {
+    return nullptr;
+  }
+  return evt;
+}
+
+// WireField is a field of a serialized message, as returned by scanFields.
+struct WireField {
+  uint32_t number;
+  // Value of varint fields.
+  uint64_t varint;
+  // Value of length delimited fields. It points into the scanned message.
+  absl::string_view bytes;
+};
+
+// scanFields calls fn for each varint and length delimited field of the
+// serialized message in buf, skipping fixed size fields. Strings and
+// submessages are returned as views into buf, so unlike decoding the message
+// nothing is copied. This makes it much cheaper when only a few fields are
+// needed, as paths and arguments are often most of an event. Returns false if
+// the message is malformed or fn returns false.
+template <class F>
+bool scanFields(absl::string_view buf, F fn) {
+  google::protobuf::io::CodedInputStream in(
+      reinterpret_cast<const uint8_t*>(buf.data()), buf.size());
+  for (;;) {
+    uint32_t tag = in.ReadTag();
+    if (tag == 0) {
+      return in.ConsumedEntireMessage();
+    }
+    WireField field = {tag >> 3, 0, {}};
+    uint32_t len;
+    switch (tag & 7) {
+      case 0:  // Varint.
+        if (!in.ReadVarint64(&field.varint)) {
+          return false;
+        }
+        break;
+      case 1:  // 64-bit.
+        if (!in.Skip(8)) {
+          return false;
+        }
+        continue;
+      case 2:  // Length delimited.
+        if (!in.ReadVarint32(&len) ||
+            len > buf.size() - in.CurrentPosition()) {
+          return false;
+        }
+        field.bytes = buf.substr(in.CurrentPosition(), len);
+        in.Skip(len);
+        break;
+      case 5:  // 32-bit.
+        if (!in.Skip(4)) {
+          return false;
+        }
+        continue;
+      default:  // Groups are not used.
+        return false;
+    }
+    if (!fn(field)) {
+      return false;
+    }
+  }
+}
+
+// ContextView holds the ContextData fields used by the server. Strings point
+// into the event.
+struct ContextView {
+  int64_t time_ns = 0;
+  absl::string_view container_id;
+};
+
+// scanContextData extracts ContextView from a serialized ContextData.
+bool scanContextData(absl::string_view buf, ContextView* ctx) {
+  return scanFields(buf, [ctx](const WireField& f) {
+    switch (f.number) {
+      case ::gvisor::common::ContextData::kTimeNsFieldNumber:
+        ctx->time_ns = f.varint;
+        break;
+      case ::gvisor::common::ContextData::kContainerIdFieldNumber:
+        ctx->container_id = f.bytes;
+        break;
+    }
+    return true;
+  });
+}
+
+// scanContext extracts ContextView from an event, skipping over everything
+// else. All event messages carry context_data as field 1, see common.proto.
+// Returns false if the event is malformed.
+bool scanContext(absl::string_view buf, ContextView* ctx) {
+  return scanFields(buf, [ctx](const WireField& f) {
+    return f.number != 1 || scanContextData(f.bytes, ctx);
+  });
+}
+
+template <class T, class = void>
+struct hasPathname : std::false_type {};
+template <class T>
+struct hasPathname<T, std::void_t<decltype(std::declval<T>().pathname())>>
+    : std::true_type {};
+
+template <class T, bool isSyscall>
+bool summarize(absl::string_view buf, EventSummary* out) {
+  return scanFields(buf, [out](const WireField& f) {
+    if (f.number == T::kContextDataFieldNumber) {
+      ContextView ctx;
+      if (!scanContextData(f.bytes, &ctx)) {
+        return false;
+      }
+      out->container_id = ctx.container_id;
+    }
+    if constexpr (isSyscall) {
+      if (f.number == T::kExitFieldNumber) {
+        return scanFields(f.bytes, [out](const WireField& f) {
+          if (f.number == ::gvisor::syscall::Exit::kErrornoFieldNumber) {
+            out->errorno = static_cast<int64_t>(f.varint);
+          }
+          return true;
+        });
+      }
+    }
+    if constexpr (hasPathname<T>::value) {
+      if (f.number == T::kPathnameFieldNumber) {
+        out->path = f.bytes;
+      }
+    }
+    return true;
+  });
+}
+
+template <class T>
+Dispatcher syscallDispatcher() {
+  return {unpack<T, printSyscall<T>>, summarize<T, true>, decode<T>,
+          printSyscall<T>};
+}
+
+template <class T>
+Dispatcher eventDispatcher() {
+  return {unpack<T, print<T>>, summarize<T, false>, decode<T>, print<T>};
+}
+
 // List of dispatchers indexed based on MessageType enum values.
 // LINT.IfChange
-const std::vector<Callback> dispatchers = [] {
-  std::vector<Callback> result(::gvisor::common::MessageType_MAX + 1, nullptr);
+const std::vector<Dispatcher> dispatchers = [] {
+  std::vector<Dispatcher> result(::gvisor::common::MessageType_MAX + 1);
   result[::gvisor::common::MESSAGE_CONTAINER_START] =
-      unpack<::gvisor::container::Start>;
+      eventDispatcher<::gvisor::container::Start>();
   result[::gvisor::common::MESSAGE_SENTRY_CLONE] =
-      unpack<::gvisor::sentry::CloneInfo>;
+      eventDispatcher<::gvisor::sentry::CloneInfo>();
   result[::gvisor::common::MESSAGE_SENTRY_EXEC] =
-      unpack<::gvisor::sentry::ExecveInfo>;
+      eventDispatcher<::gvisor::sentry::ExecveInfo>();
   result[::gvisor::common::MESSAGE_SENTRY_EXIT_NOTIFY_PARENT] =
-      unpack<::gvisor::sentry::ExitNotifyParentInfo>;
+      eventDispatcher<::gvisor::sentry::ExitNotifyParentInfo>();
   result[::gvisor::common::MESSAGE_SENTRY_TASK_EXIT] =
-      unpack<::gvisor::sentry::TaskExit>;
+      eventDispatcher<::gvisor::sentry::TaskExit>();
   result[::gvisor::common::MESSAGE_SYSCALL_RAW] =
-      unpackSyscall<::gvisor::syscall::Syscall>;
+      syscallDispatcher<::gvisor::syscall::Syscall>();
   result[::gvisor::common::MESSAGE_SYSCALL_OPEN] =
-      unpackSyscall<::gvisor::syscall::Open>;
+      syscallDispatcher<::gvisor::syscall::Open>();
   result[::gvisor::common::MESSAGE_SYSCALL_CLOSE] =
-      unpackSyscall<::gvisor::syscall::Close>;
+      syscallDispatcher<::gvisor::syscall::Close>();
   result[::gvisor::common::MESSAGE_SYSCALL_READ] =
-      unpackSyscall<::gvisor::syscall::Read>;
+      syscallDispatcher<::gvisor::syscall::Read>();
   result[::gvisor::common::MESSAGE_SYSCALL_CONNECT] =
-      unpackSyscall<::gvisor::syscall::Connect>;
+      syscallDispatcher<::gvisor::syscall::Connect>();
   result[::gvisor::common::MESSAGE_SYSCALL_EXECVE] =
-      unpackSyscall<::gvisor::syscall::Execve>;
+      syscallDispatcher<::gvisor::syscall::Execve>();
   result[::gvisor::common::MESSAGE_SYSCALL_SOCKET] =
-      unpackSyscall<::gvisor::syscall::Socket>;
+      syscallDispatcher<::gvisor::syscall::Socket>();
   result[::gvisor::common::MESSAGE_SYSCALL_CHDIR] =
-      unpackSyscall<::gvisor::syscall::Chdir>;
+      syscallDispatcher<::gvisor::syscall::Chdir>();
   result[::gvisor::common::MESSAGE_SYSCALL_SETID] =
-      unpackSyscall<::gvisor::syscall::Setid>;
+      syscallDispatcher<::gvisor::syscall::Setid>();
   result[::gvisor::common::MESSAGE_SYSCALL_SETRESID] =
-      unpackSyscall<::gvisor::syscall::Setresid>;
+      syscallDispatcher<::gvisor::syscall::Setresid>();
   result[::gvisor::common::MESSAGE_SYSCALL_DUP] =
-      unpackSyscall<::gvisor::syscall::Dup>;
+      syscallDispatcher<::gvisor::syscall::Dup>();
   result[::gvisor::common::MESSAGE_SYSCALL_PRLIMIT64] =
-      unpackSyscall<::gvisor::syscall::Prlimit>;
+      syscallDispatcher<::gvisor::syscall::Prlimit>();
   result[::gvisor::common::MESSAGE_SYSCALL_PIPE] =
-      unpackSyscall<::gvisor::syscall::Pipe>;
+      syscallDispatcher<::gvisor::syscall::Pipe>();
   result[::gvisor::common::MESSAGE_SYSCALL_FCNTL] =
-      unpackSyscall<::gvisor::syscall::Fcntl>;
+      syscallDispatcher<::gvisor::syscall::Fcntl>();
   result[::gvisor::common::MESSAGE_SYSCALL_SIGNALFD] =
-      unpackSyscall<::gvisor::syscall::Signalfd>;
+      syscallDispatcher<::gvisor::syscall::Signalfd>();
   result[::gvisor::common::MESSAGE_SYSCALL_EVENTFD] =
-      unpackSyscall<::gvisor::syscall::Eventfd>;
+      syscallDispatcher<::gvisor::syscall::Eventfd>();
   result[::gvisor::common::MESSAGE_SYSCALL_CHROOT] =
-      unpackSyscall<::gvisor::syscall::Chroot>;
+      syscallDispatcher<::gvisor::syscall::Chroot>();
   result[::gvisor::common::MESSAGE_SYSCALL_CLONE] =
-      unpackSyscall<::gvisor::syscall::Clone>;
+      syscallDispatcher<::gvisor::syscall::Clone>();
   result[::gvisor::common::MESSAGE_SYSCALL_BIND] =
-      unpackSyscall<::gvisor::syscall::Bind>;
+      syscallDispatcher<::gvisor::syscall::Bind>();
   result[::gvisor::common::MESSAGE_SYSCALL_ACCEPT] =
-      unpackSyscall<::gvisor::syscall::Accept>;
+      syscallDispatcher<::gvisor::syscall::Accept>();
   result[::gvisor::common::MESSAGE_SYSCALL_TIMERFD_CREATE] =
-      unpackSyscall<::gvisor::syscall::TimerfdCreate>;
+      syscallDispatcher<::gvisor::syscall::TimerfdCreate>();
   result[::gvisor::common::MESSAGE_SYSCALL_TIMERFD_SETTIME] =
-      unpackSyscall<::gvisor::syscall::TimerfdSetTime>;
+      syscallDispatcher<::gvisor::syscall::TimerfdSetTime>();
   result[::gvisor::common::MESSAGE_SYSCALL_TIMERFD_GETTIME] =
-      unpackSyscall<::gvisor::syscall::TimerfdGetTime>;
+      syscallDispatcher<::gvisor::syscall::TimerfdGetTime>();
   result[::gvisor::common::MESSAGE_SYSCALL_FORK] =
-      unpackSyscall<::gvisor::syscall::Fork>;
+      syscallDispatcher<::gvisor::syscall::Fork>();
   result[::gvisor::common::MESSAGE_SYSCALL_INOTIFY_INIT] =
-      unpackSyscall<::gvisor::syscall::InotifyInit>;
+      syscallDispatcher<::gvisor::syscall::InotifyInit>();
   result[::gvisor::common::MESSAGE_SYSCALL_INOTIFY_ADD_WATCH] =
-      unpackSyscall<::gvisor::syscall::InotifyAddWatch>;
+      syscallDispatcher<::gvisor::syscall::InotifyAddWatch>();
   result[::gvisor::common::MESSAGE_SYSCALL_INOTIFY_RM_WATCH] =
-      unpackSyscall<::gvisor::syscall::InotifyRmWatch>;
+      syscallDispatcher<::gvisor::syscall::InotifyRmWatch>();
   result[::gvisor::common::MESSAGE_SYSCALL_SOCKETPAIR] =
-      unpackSyscall<::gvisor::syscall::SocketPair>;
+      syscallDispatcher<::gvisor::syscall::SocketPair>();
   result[::gvisor::common::MESSAGE_SYSCALL_WRITE] =
-      unpackSyscall<::gvisor::syscall::Write>;
+      syscallDispatcher<::gvisor::syscall::Write>();
   result[::gvisor::common::MESSAGE_SENTRY_MMAP] =
-      unpack<::gvisor::sentry::MmapInfo>;
+      eventDispatcher<::gvisor::sentry::MmapInfo>();
   result[::gvisor::common::MESSAGE_SYSCALL_MMAP] =
-      unpackSyscall<::gvisor::syscall::Mmap>;
+      syscallDispatcher<::gvisor::syscall::Mmap>();
   result[::gvisor::common::MESSAGE_SYSCALL_LISTEN] =
-      unpackSyscall<::gvisor::syscall::Listen>;
+      syscallDispatcher<::gvisor::syscall::Listen>();
   result[::gvisor::common::MESSAGE_SYSCALL_PTRACE] =
-      unpackSyscall<::gvisor::syscall::Ptrace>;
+      syscallDispatcher<::gvisor::syscall::Ptrace>();
   return result;
 }();
 // LINT.ThenChange(../../pkg/sentry/seccheck/points/common.proto)
 
-void unpack(absl::string_view buf) {
+// filtered returns true if the event must be skipped. When a filter is set,
+// only the event's context is scanned to make the decision, which is much
+// cheaper than decoding the entire event.
+bool filtered(absl::string_view proto) {
+  if (container_filter.empty()) {
+    return false;
+  }
+  ContextView ctx;
+  if (!scanContext(proto, &ctx)) {
+    printf("Error parsing event context\n");
+    return true;
+  }
+  return ctx.container_id != container_filter;
+}
+
+// unpack decodes an event and prints it or, if agg is set, adds it to agg.
+void unpack(absl::string_view buf, google::protobuf::Arena* arena,
+            Aggregator* agg) {
+  if (buf.size() < sizeof(header)) {
+    printf("Message is smaller than header: %lu\n", buf.size());
+    return;
+  }
   const header* hdr = reinterpret_cast<const header*>(&buf[0]);
 
   // Payload size can be zero when proto object contains only defaults values.
-  size_t payload_size = buf.size() - hdr->header_size;
-  if (payload_size < 0) {
+  if (hdr->header_size > buf.size()) {
     printf("Header size (%u) is larger than message %lu\n", hdr->header_size,
            buf.size());
     return;
   }
+  size_t payload_size = buf.size() - hdr->header_size;
 
   auto proto = buf.substr(hdr->header_size);
   if (proto.size() < payload_size) {
@@ -194,72 +884,795 @@ void unpack(absl::string_view buf) {
     printf("Invalid message type: %u\n", hdr->message_type);
     return;
   }
-  Callback cb = dispatchers[hdr->message_type];
-  if (cb) {
-    cb(proto);
+  const Dispatcher& d = dispatchers[hdr->message_type];
+  if (d.unpack) {
+    if (filtered(proto)) {
+      return;
+    }
+    if (agg != nullptr) {
+      EventSummary summary;
+      if (!d.summarize(proto, &summary)) {
+        printf("Error parsing event of type: %u\n", hdr->message_type);
+        return;
+      }
+      agg->add(hdr->message_type, summary);
+    } else {
+      d.unpack(proto, arena);
+    }
   } else {
     printf("No dispatcher configured for message type: %u\n",
            hdr->message_type);
   }
 }
 
-bool readAndUnpack(int client) {
-  std::array<char, maxEventSize> buf;
-  int bytes = read(client, buf.data(), buf.size());
-  if (bytes < 0) {
-    err(1, "read");
+// In-process sinks. When they are enabled, workers decode each event once and
+// hand it to every sink, and each sink handles events on its own thread. This
+// way several consumers can be fed from a single stream, instead of having the
+// sandbox send every event to each one of them.
+
+// SharedEvent is an event handed to all sinks. It's deleted by the last sink
+// that handles it.
+struct SharedEvent {
+  uint64_t client_id;
+  uint16_t message_type;
+  // The event as received from the sandbox, header included.
+  std::string raw;
+  // The decoded payload, or nullptr if no sink needs it.
+  std::unique_ptr<google::protobuf::Message> msg;
+  std::atomic<int> refs;
+
+  absl::string_view payload() const {
+    return absl::string_view(raw).substr(
+        reinterpret_cast<const header*>(raw.data())->header_size);
   }
-  if (bytes == 0) {
-    return false;
+};
+
+// Number of events that can be queued between a worker and a sink.
+constexpr uint64_t sinkQueueSize = 4096;
+
+// Time after which a sink is given a chance to flush buffered state when
+// there are no events.
+constexpr int sinkIdleTimeoutMs = 100;
+
+class Sink;
+
+// EventQueue is a lock-free single producer, single consumer queue that
+// carries events from a worker to a sink.
+class EventQueue {
+ public:
+  explicit EventQueue(Sink* sink) : sink_(sink) {}
+
+  // push adds evt to the queue, waiting for the sink to make room if it's
+  // full. Workers fall behind when a sink does, which makes sandboxes drop
+  // events and report it. Only called by the worker that owns the queue.
+  void push(SharedEvent* evt);
+
+  // pop returns the next event, or nullptr if the queue is empty. Only called
+  // by the sink.
+  SharedEvent* pop() {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    SharedEvent* evt = slots_[head % sinkQueueSize];
+    head_.store(head + 1, std::memory_order_release);
+    return evt;
+  }
+
+ private:
+  Sink* const sink_;
+  // Position of the next event to pop, written by the sink.
+  alignas(64) std::atomic<uint64_t> head_ = 0;
+  // Position of the next event to push, written by the worker.
+  alignas(64) std::atomic<uint64_t> tail_ = 0;
+  std::array<SharedEvent*, sinkQueueSize> slots_;
+};
+
+// Sink consumes events from all workers on its own thread.
+class Sink {
+ public:
+  virtual ~Sink() = default;
+
+  // needsMessage returns true if the sink uses SharedEvent::msg.
+  virtual bool needsMessage() const { return false; }
+
+  // addQueue returns a new queue to the sink. It must be called for all
+  // workers before the sink is started.
+  EventQueue* addQueue() {
+    queues_.push_back(std::make_unique<EventQueue>(this));
+    return queues_.back().get();
+  }
+
+  void start() {
+    std::thread([this] { loop(); }).detach();
+  }
+
+  // wake wakes the sink up if it's waiting for events. Workers call it after
+  // queueing a batch of events.
+  void wake() {
+    if (sleeping_.load(std::memory_order_seq_cst) != 0) {
+      sleeping_.store(0, std::memory_order_relaxed);
+      syscall(SYS_futex, &sleeping_, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr,
+              0);
+    }
+  }
+
+ protected:
+  // handle is called for every event, in the order that they were received
+  // from each client.
+  virtual void handle(const SharedEvent& evt) = 0;
+
+  // idle is called when no events have arrived in a while.
+  virtual void idle() {}
+
+ private:
+  // drain handles all queued events. Returns false if there were none.
+  bool drain() {
+    bool found = false;
+    for (const auto& queue : queues_) {
+      while (SharedEvent* evt = queue->pop()) {
+        found = true;
+        handle(*evt);
+        if (evt->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          delete evt;
+        }
+      }
+    }
+    return found;
+  }
+
+  void loop() {
+    static_assert(sizeof(sleeping_) == sizeof(uint32_t));
+    for (;;) {
+      if (drain()) {
+        continue;
+      }
+      // Check again after setting the flag, in case an event was queued in
+      // between. Workers check the flag after queueing events.
+      sleeping_.store(1, std::memory_order_seq_cst);
+      if (drain()) {
+        sleeping_.store(0, std::memory_order_relaxed);
+        continue;
+      }
+      timespec timeout = {0, sinkIdleTimeoutMs * 1000000l};
+      if (syscall(SYS_futex, &sleeping_, FUTEX_WAIT_PRIVATE, 1, &timeout,
+                  nullptr, 0) < 0 &&
+          errno == ETIMEDOUT) {
+        idle();
+      }
+      sleeping_.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::vector<std::unique_ptr<EventQueue>> queues_;
+  // Set while the sink waits for events.
+  std::atomic<uint32_t> sleeping_ = 0;
+};
+
+void EventQueue::push(SharedEvent* evt) {
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  while (tail - head_.load(std::memory_order_acquire) == sinkQueueSize) {
+    sink_->wake();
+    sched_yield();
+  }
+  slots_[tail % sinkQueueSize] = evt;
+  tail_.store(tail + 1, std::memory_order_release);
+}
+
+// PrintSink prints every event.
+class PrintSink : public Sink {
+ public:
+  bool needsMessage() const override { return true; }
+
+ protected:
+  void handle(const SharedEvent& evt) override {
+    dispatchers[evt.message_type].print(*evt.msg);
+  }
+};
+
+// SummarySink aggregates events and prints a summary every
+// aggregate_interval_sec.
+class SummarySink : public Sink {
+ protected:
+  void handle(const SharedEvent& evt) override {
+    EventSummary summary;
+    if (!dispatchers[evt.message_type].summarize(evt.payload(), &summary)) {
+      printf("Error parsing event of type: %u\n", evt.message_type);
+      return;
+    }
+    agg_.add(evt.message_type, summary);
+    maybePrint();
+  }
+
+  void idle() override { maybePrint(); }
+
+ private:
+  void maybePrint() {
+    time_t now = time(nullptr);
+    if (now - last_ < aggregate_interval_sec) {
+      return;
+    }
+    last_ = now;
+    if (agg_.empty()) {
+      return;
+    }
+    agg_.print(absl::StrCat("Summary for the last ", aggregate_interval_sec,
+                            " seconds:"));
+    agg_ = Aggregator();
+    fflush(stdout);
+  }
+
+  Aggregator agg_;
+  time_t last_ = time(nullptr);
+};
+
+// RecordSink hands events to the recorder.
+class RecordSink : public Sink {
+ protected:
+  void handle(const SharedEvent& evt) override {
+    Recorder::append(&buf_, evt.raw);
+    idle_count_ = 0;
+    if (buf_.size() >= recordFlushSize) {
+      recorder->submit(&buf_);
+    }
+  }
+
+  // Events are only buffered for a while when idle, like workers do.
+  void idle() override {
+    if (!buf_.empty() && ++idle_count_ * sinkIdleTimeoutMs >=
+                             recordFlushTimeoutMs) {
+      recorder->submit(&buf_);
+      idle_count_ = 0;
+    }
+  }
+
+ private:
+  std::string buf_;
+  int idle_count_ = 0;
+};
+
+// In-process sinks, if enabled.
+std::vector<std::unique_ptr<Sink>> sinks;
+
+// Set if any sink needs events to be decoded.
+bool sinks_need_message = false;
+
+// newSinks creates the sinks in the comma separated list of names.
+void newSinks(absl::string_view names) {
+  for (absl::string_view name : absl::StrSplit(names, ',')) {
+    if (name == "print") {
+      sinks.push_back(std::make_unique<PrintSink>());
+    } else if (name == "summary") {
+      if (aggregate_interval_sec <= 0) {
+        errx(1, "summary sink requires -a");
+      }
+      sinks.push_back(std::make_unique<SummarySink>());
+    } else if (name == "record") {
+      if (recorder == nullptr) {
+        errx(1, "record sink requires -o");
+      }
+      sinks.push_back(std::make_unique<RecordSink>());
+    } else {
+      errx(1, "unknown sink: %.*s", static_cast<int>(name.size()),
+           name.data());
+    }
+    sinks_need_message |= sinks.back()->needsMessage();
+  }
+}
+
+// fanOut decodes an event once and queues it to all sinks.
+void fanOut(Worker* worker, uint64_t client_id, absl::string_view buf) {
+  if (buf.size() < sizeof(header)) {
+    printf("Message is smaller than header: %lu\n", buf.size());
+    return;
+  }
+  const header* hdr = reinterpret_cast<const header*>(buf.data());
+  if (hdr->header_size > buf.size()) {
+    printf("Header size (%u) is larger than message %lu\n", hdr->header_size,
+           buf.size());
+    return;
+  }
+  if (hdr->message_type == 0 || hdr->message_type >= dispatchers.size() ||
+      !dispatchers[hdr->message_type].decode) {
+    printf("Invalid message type: %u\n", hdr->message_type);
+    return;
+  }
+  absl::string_view proto = buf.substr(hdr->header_size);
+  if (filtered(proto)) {
+    return;
+  }
+  auto* evt = new SharedEvent{client_id, hdr->message_type, std::string(buf)};
+  if (sinks_need_message) {
+    evt->msg = dispatchers[hdr->message_type].decode(proto);
+    if (evt->msg == nullptr) {
+      printf("Error parsing event of type: %u\n", hdr->message_type);
+      delete evt;
+      return;
+    }
+  }
+  evt->refs.store(worker->queues.size(), std::memory_order_relaxed);
+  for (EventQueue* queue : worker->queues) {
+    queue->push(evt);
+  }
+}
+
+// Batch holds the worker tables that are updated while a batch of messages is
+// handled. They are locked once for the entire batch.
+struct Batch {
+  std::unique_lock<std::mutex> agg_lock;
+  Aggregator* agg = nullptr;
+  std::unique_lock<std::mutex> stats_lock;
+  Stats* stats = nullptr;
+  // Time when the batch was received.
+  int64_t received_ns = 0;
+};
+
+// startBatch locks the worker tables that are in use.
+void startBatch(Worker* worker, Batch* batch) {
+  if (aggregate_interval_sec > 0) {
+    batch->agg_lock = std::unique_lock<std::mutex>(worker->agg_mu);
+    batch->agg = &worker->agg;
+  }
+  if (stats_interval_sec > 0) {
+    batch->stats_lock = std::unique_lock<std::mutex>(worker->stats_mu);
+    batch->stats = &worker->stats;
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    batch->received_ns = now.tv_sec * 1000000000ll + now.tv_nsec;
   }
-  unpack(absl::string_view(buf.data(), bytes));
-  return true;
+}
+
+// ingestLatency returns the time between the event being generated and
+// received_ns, or -1 if the event doesn't have a timestamp.
+int64_t ingestLatency(absl::string_view buf, int64_t received_ns) {
+  const header* hdr = reinterpret_cast<const header*>(buf.data());
+  if (hdr->header_size > buf.size()) {
+    return -1;
+  }
+  ContextView ctx;
+  if (!scanContext(buf.substr(hdr->header_size), &ctx) || ctx.time_ns == 0) {
+    return -1;
+  }
+  // Clamp it in case the clocks disagree.
+  return std::max<int64_t>(0, received_ns - ctx.time_ns);
+}
+
+// handleEvent records or unpacks a single message received from the client.
+void handleEvent(Worker* worker, Client* client, absl::string_view buf,
+                 const Batch& batch) {
+  client->events++;
+  if (buf.size() >= sizeof(header)) {
+    const header* hdr = reinterpret_cast<const header*>(buf.data());
+    if (batch.stats != nullptr) {
+      if (hdr->dropped_count != client->dropped_count) {
+        batch.stats->addDropped(client->id,
+                                hdr->dropped_count - client->dropped_count,
+                                hdr->dropped_count);
+      }
+      batch.stats->addEvent(
+          client->id, hdr->message_type,
+          ingestLatency(buf, batch.received_ns));
+    }
+    client->dropped_count = hdr->dropped_count;
+  }
+  if (!sinks.empty()) {
+    fanOut(worker, client->id, buf);
+  } else if (recorder != nullptr) {
+    Recorder::append(&worker->record_buf, buf);
+  } else {
+    unpack(buf, worker->arena.get(), batch.agg);
+  }
+}
+
+// finishBatch releases resources used to handle a batch of messages.
+void finishBatch(Worker* worker) {
+  worker->arena->Reset();
+  for (const auto& sink : sinks) {
+    sink->wake();
+  }
+  if (worker->record_buf.size() >= recordFlushSize) {
+    recorder->submit(&worker->record_buf);
+  }
+}
+
+// drain reads and unpacks all messages queued in the client socket, in batches
+// of up to recvBatchSize. Returns false if the client closed the connection.
+bool drain(Worker* worker, Client* client) {
+  for (;;) {
+    int count = recvmmsg(client->fd, worker->msgs.data(), worker->msgs.size(),
+                         MSG_DONTWAIT, nullptr);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+      }
+      err(1, "recvmmsg");
+    }
+    if (count == 0) {
+      return false;
+    }
+    client->syscalls++;
+    Batch batch;
+    startBatch(worker, &batch);
+    for (int i = 0; i < count; ++i) {
+      const mmsghdr& msg = worker->msgs[i];
+      // Messages always have a header, so an empty message means the socket
+      // has been shut down.
+      if (msg.msg_len == 0) {
+        return false;
+      }
+      const char* buf = static_cast<const char*>(msg.msg_hdr.msg_iov->iov_base);
+      handleEvent(worker, client, absl::string_view(buf, msg.msg_len), batch);
+    }
+    finishBatch(worker);
+    if (count < recvBatchSize) {
+      // The socket is most likely empty now. If not, epoll will report it
+      // again and it saves a recvmmsg(2) call returning EAGAIN.
+      return true;
+    }
+  }
+}
+
+// drainRing reads and unpacks all messages in the client's ring, in batches of
+// up to recvBatchSize. Before returning, it asks the sentry to signal the
+// doorbell when more messages are published. Returns false if the ring is
+// corrupt.
+bool drainRing(Worker* worker, Client* client) {
+  Ring& ring = *client->ring;
+  uint64_t ignored;
+  if (read(ring.doorbell, &ignored, sizeof(ignored)) > 0) {
+    client->syscalls++;
+  }
+  for (;;) {
+    uint64_t producer = __atomic_load_n(ring.producer(), __ATOMIC_ACQUIRE);
+    if (producer == ring.consumer) {
+      // Check again after setting the flag, in case a message was published in
+      // between. The sentry checks the flag after publishing messages.
+      __atomic_store_n(ring.flags(), ringFlagWakeup, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n(ring.producer(), __ATOMIC_SEQ_CST) == ring.consumer) {
+        return true;
+      }
+      continue;
+    }
+    if (producer - ring.consumer > ring.size) {
+      printf("Invalid ring producer position: %lu\n", producer);
+      return false;
+    }
+
+    Batch batch;
+    startBatch(worker, &batch);
+    for (int i = 0; i < recvBatchSize && ring.consumer != producer; ++i) {
+      uint64_t off = ring.consumer & (ring.size - 1);
+      uint64_t avail = producer - ring.consumer;
+      uint32_t len;
+      memcpy(&len, ring.data() + off, sizeof(len));
+      if (len == ringPadding) {
+        if (avail < ring.size - off) {
+          printf("Invalid ring padding at: %lu\n", ring.consumer);
+          return false;
+        }
+        ring.consumer += ring.size - off;
+        continue;
+      }
+      uint64_t need = (sizeof(len) + len + ringAlignment - 1) &
+                      ~(ringAlignment - 1);
+      if (len > maxEventSize || need > avail ||
+          off + sizeof(len) + len > ring.size) {
+        printf("Invalid ring message size: %u\n", len);
+        return false;
+      }
+      // The sentry can change the message while it's being decoded, so copy it
+      // to memory that it doesn't have access to.
+      memcpy(worker->buffers.data(), ring.data() + off + sizeof(len), len);
+      handleEvent(worker, client,
+                  absl::string_view(worker->buffers.data(), len), batch);
+      ring.consumer += need;
+    }
+    __atomic_store_n(ring.consumerPtr(), ring.consumer, __ATOMIC_RELEASE);
+    finishBatch(worker);
+  }
+}
+
+void closeClient(Client* client) {
+  client->closed = true;
+  client->ring.reset();
+  close(client->fd);
+  client->worker->clients.fetch_sub(1, std::memory_order_relaxed);
+  printf("Connection closed, client %lu, %lu events in %lu syscalls "
+         "(%.1f events/syscall)",
+         client->id, client->events, client->syscalls,
+         client->syscalls ? double(client->events) / client->syscalls : 0);
+  if (client->dropped_count != 0) {
+    printf(", %u events dropped", client->dropped_count);
+  }
+  printf("\n");
+  // Flush it right away, since tools use it to know when a client is done.
+  fflush(stdout);
 }
 
 void* pollLoop(void* ptr) {
-  const int poll_fd = *reinterpret_cast<int*>(&ptr);
+  Worker* worker = reinterpret_cast<Worker*>(ptr);
   for (;;) {
     epoll_event evts[64];
-    int nfds = epoll_wait(poll_fd, evts, 64, -1);
+    // Wake up periodically when there are buffered events, so they don't sit
+    // in memory while clients are idle.
+    int timeout = worker->record_buf.empty() ? -1 : recordFlushTimeoutMs;
+    int nfds = epoll_wait(worker->poll_fd, evts, 64, timeout);
     if (nfds < 0) {
       if (errno == EINTR) {
         continue;
       }
       err(1, "epoll_wait");
     }
+    if (nfds == 0) {
+      recorder->submit(&worker->record_buf);
+      continue;
+    }
 
+    std::vector<Client*> closed;
     for (int i = 0; i < nfds; ++i) {
-      if (evts[i].events & EPOLLIN) {
-        int client = evts[i].data.fd;
-        readAndUnpack(client);
-      }
-      if ((evts[i].events & (EPOLLRDHUP | EPOLLHUP)) != 0) {
-        int client = evts[i].data.fd;
-        // Drain any remaining messages before closing the socket.
-        while (readAndUnpack(client)) {
+      const PollSource* source =
+          reinterpret_cast<const PollSource*>(evts[i].data.ptr);
+      Client* client = source->client;
+      if (client->closed) {
+        continue;
+      }
+      if (source->doorbell) {
+        // Clients are only closed when the socket reports it, otherwise it
+        // could race with the socket being added to epoll.
+        if (client->ring != nullptr && !drainRing(worker, client)) {
+          client->ring.reset();
+          shutdown(client->fd, SHUT_RDWR);
+        }
+        continue;
+      }
+      if ((evts[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0) {
+        // On hang up, this drains any remaining messages before closing the
+        // socket.
+        bool open = drain(worker, client);
+        if (!open && client->ring != nullptr) {
+          drainRing(worker, client);
+        }
+        if (!open) {
+          closeClient(client);
+          closed.push_back(client);
+          continue;
         }
-        close(client);
-        printf("Connection closed\n");
       }
       if (evts[i].events & EPOLLERR) {
         printf("error\n");
       }
     }
+    for (Client* client : closed) {
+      delete client;
+    }
   }
 }
 
-void startPollThread(int poll_fd) {
+void startPollThread(Worker* worker) {
+  pthread_attr_t attr;
+  if (pthread_attr_init(&attr) != 0) {
+    err(1, "pthread_attr_init");
+  }
+  auto attr_cleanup =
+      absl::MakeCleanup([&attr] { pthread_attr_destroy(&attr); });
+  if (worker->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker->cpu, &set);
+    if (pthread_attr_setaffinity_np(&attr, sizeof(set), &set) != 0) {
+      err(1, "pthread_attr_setaffinity_np");
+    }
+  }
   pthread_t thread;
-  if (pthread_create(&thread, nullptr, pollLoop,
-                     reinterpret_cast<void*>(poll_fd)) != 0) {
+  if (pthread_create(&thread, &attr, pollLoop, worker) != 0) {
     err(1, "pthread_create");
   }
   pthread_detach(thread);
 }
 
+// startWorkers creates count workers, each with its own epoll instance and
+// poll thread. If count is 0, one worker is started per CPU available to the
+// process. When there is more than one worker, each one is pinned to a CPU.
+std::vector<std::unique_ptr<Worker>> startWorkers(int count) {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) < 0) {
+    err(1, "sched_getaffinity");
+  }
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  if (count == 0) {
+    count = cpus.size();
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (int i = 0; i < count; ++i) {
+    auto worker = std::make_unique<Worker>();
+    worker->poll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (worker->poll_fd < 0) {
+      err(1, "epoll_create1");
+    }
+    if (count > 1) {
+      worker->cpu = cpus[i % cpus.size()];
+    }
+    worker->buffers.resize(recvBatchSize * maxEventSize);
+    for (int j = 0; j < recvBatchSize; ++j) {
+      worker->iovs[j].iov_base = &worker->buffers[j * maxEventSize];
+      worker->iovs[j].iov_len = maxEventSize;
+      worker->msgs[j] = {};
+      worker->msgs[j].msg_hdr.msg_iov = &worker->iovs[j];
+      worker->msgs[j].msg_hdr.msg_iovlen = 1;
+    }
+    worker->arena_block.resize(arenaBlockSize);
+    google::protobuf::ArenaOptions options;
+    options.initial_block = worker->arena_block.data();
+    options.initial_block_size = worker->arena_block.size();
+    worker->arena = std::make_unique<google::protobuf::Arena>(options);
+    for (const auto& sink : sinks) {
+      worker->queues.push_back(sink->addQueue());
+    }
+    startPollThread(worker.get());
+    workers.push_back(std::move(worker));
+  }
+  return workers;
+}
+
+// pickWorker returns the worker with the fewest clients assigned to it.
+Worker* pickWorker(const std::vector<std::unique_ptr<Worker>>& workers) {
+  Worker* best = workers[0].get();
+  for (const auto& worker : workers) {
+    if (worker->clients.load(std::memory_order_relaxed) <
+        best->clients.load(std::memory_order_relaxed)) {
+      best = worker.get();
+    }
+  }
+  return best;
+}
+
+// startSummaryThread starts a thread that collects the counts aggregated by
+// all workers and prints a summary every aggregate_interval_sec.
+void startSummaryThread(const std::vector<std::unique_ptr<Worker>>& workers) {
+  std::vector<Worker*> ptrs;
+  for (const auto& worker : workers) {
+    ptrs.push_back(worker.get());
+  }
+  std::thread([ptrs] {
+    for (;;) {
+      sleep(aggregate_interval_sec);
+      Aggregator total;
+      for (Worker* worker : ptrs) {
+        std::lock_guard<std::mutex> lock(worker->agg_mu);
+        total.merge(&worker->agg);
+      }
+      if (total.empty()) {
+        continue;
+      }
+      total.print(absl::StrCat("Summary for the last ", aggregate_interval_sec,
+                               " seconds:"));
+      fflush(stdout);
+    }
+  }).detach();
+}
+
+// startStatsThread starts a thread that collects the stats from all workers
+// and prints them every stats_interval_sec.
+void startStatsThread(const std::vector<std::unique_ptr<Worker>>& workers) {
+  std::vector<Worker*> ptrs;
+  for (const auto& worker : workers) {
+    ptrs.push_back(worker.get());
+  }
+  std::thread([ptrs] {
+    for (;;) {
+      sleep(stats_interval_sec);
+      Stats total;
+      for (Worker* worker : ptrs) {
+        std::lock_guard<std::mutex> lock(worker->stats_mu);
+        total.merge(&worker->stats);
+      }
+      total.print(
+          absl::StrCat("Stats for the last ", stats_interval_sec, " seconds:"));
+      fflush(stdout);
+    }
+  }).detach();
+}
+
+// replay reads events recorded in a file by Recorder and unpacks them.
+void replay(const char* name) {
+  FILE* f = fopen(name, "re");
+  if (f == nullptr) {
+    err(1, "fopen(%s)", name);
+  }
+  auto closer = absl::MakeCleanup([f] { fclose(f); });
+  google::protobuf::Arena arena;
+  Aggregator agg;
+  std::vector<char> buf(maxEventSize);
+  for (uint64_t count = 0;; ++count) {
+    uint32_t size;
+    size_t n = fread(&size, 1, sizeof(size), f);
+    if (n == 0 && feof(f)) {
+      printf("Replayed %lu events\n", count);
+      if (aggregate_interval_sec > 0) {
+        agg.print("Summary:");
+      }
+      return;
+    }
+    if (n != sizeof(size) || size > buf.size() ||
+        fread(buf.data(), 1, size, f) != size) {
+      errx(1, "%s: truncated record after %lu events", name, count);
+    }
+    unpack(absl::string_view(buf.data(), size), &arena,
+           aggregate_interval_sec > 0 ? &agg : nullptr);
+    arena.Reset();
+  }
+}
+
+// setupRing creates a shared memory ring of the given size and sends it to the
+// client. See pkg/sentry/seccheck/sinks/remote/wire/wire.go for details.
+std::unique_ptr<Ring> setupRing(int client_fd, uint32_t size) {
+  int memfd = memfd_create("seccheck-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (memfd < 0) {
+    printf("Error creating ring: %d\n", errno);
+    return nullptr;
+  }
+  auto memfd_closer = absl::MakeCleanup([memfd] { close(memfd); });
+  if (ftruncate(memfd, ringHeaderSize + size) < 0) {
+    printf("Error setting ring size: %d\n", errno);
+    return nullptr;
+  }
+  // The sentry only maps rings that can't be resized.
+  constexpr int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+  if (fcntl(memfd, F_ADD_SEALS, seals) < 0) {
+    printf("Error sealing ring: %d\n", errno);
+    return nullptr;
+  }
+  auto ring = std::make_unique<Ring>();
+  void* mem = mmap(nullptr, ringHeaderSize + size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, memfd, 0);
+  if (mem == MAP_FAILED) {
+    printf("Error mapping ring: %d\n", errno);
+    return nullptr;
+  }
+  ring->mem = static_cast<char*>(mem);
+  ring->size = size;
+  // The ring starts empty, ask to be woken up by the first message.
+  *ring->flags() = ringFlagWakeup;
+  ring->doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (ring->doorbell < 0) {
+    printf("Error creating ring doorbell: %d\n", errno);
+    return nullptr;
+  }
+
+  header hdr = {sizeof(header), ::gvisor::common::MESSAGE_UNKNOWN, 0};
+  iovec iov = {&hdr, sizeof(hdr)};
+  int fds[2] = {memfd, ring->doorbell};
+  char control[CMSG_SPACE(sizeof(fds))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+  if (sendmsg(client_fd, &msg, MSG_NOSIGNAL) < 0) {
+    printf("Error sending ring: %d\n", errno);
+    return nullptr;
+  }
+  return ring;
+}
+
 // handshake performs version exchange with client. See common.proto for details
-// about the protocol.
-bool handshake(int client_fd) {
+// about the protocol. If the client requests a shared memory ring, it's
+// returned in ring.
+bool handshake(int client_fd, std::unique_ptr<Ring>* ring) {
   std::vector<char> buf(10240);
   int bytes = read(client_fd, buf.data(), buf.size());
   if (bytes < 0) {
@@ -285,19 +1698,78 @@ bool handshake(int client_fd) {
 
   ::gvisor::common::Handshake out;
   out.set_version(1);
+  uint32_t ring_size = in.ring_size();
+  if (ring_size != 0) {
+    if (in.version() >= ringVersion && ring_size >= ringMinSize &&
+        ring_size <= ringMaxSize && (ring_size & (ring_size - 1)) == 0) {
+      out.set_version(ringVersion);
+      out.set_ring_size(ring_size);
+    } else {
+      // The client fails the handshake when the size isn't echoed back.
+      printf("Invalid ring size requested: %u\n", ring_size);
+      ring_size = 0;
+    }
+  }
   if (!out.SerializeToFileDescriptor(client_fd)) {
     printf("Error sending handshake message: %d\n", errno);
     return false;
   }
+  if (ring_size != 0) {
+    *ring = setupRing(client_fd, ring_size);
+    if (*ring == nullptr) {
+      return false;
+    }
+  }
   return true;
 }
 
 int main(int argc, char** argv) {
-  for (int c = 0; (c = getopt(argc, argv, "q")) != -1;) {
+  int worker_count = 1;
+  const char* record_prefix = nullptr;
+  const char* replay_file = nullptr;
+  const char* sink_names = nullptr;
+  uint64_t rotate_size = 1ull << 30;
+  for (int c = 0; (c = getopt(argc, argv, "a:c:f:i:o:qr:s:w:")) != -1;) {
     switch (c) {
+      case 'a':
+        aggregate_interval_sec = atoi(optarg);
+        if (aggregate_interval_sec <= 0) {
+          errx(1, "invalid aggregation interval: %s", optarg);
+        }
+        break;
+      case 'c':
+        container_filter = optarg;
+        break;
+      case 'f':
+        sink_names = optarg;
+        break;
+      case 'i':
+        replay_file = optarg;
+        break;
+      case 'o':
+        record_prefix = optarg;
+        break;
+      case 'r':
+        rotate_size = strtoull(optarg, nullptr, 10);
+        if (rotate_size == 0) {
+          errx(1, "invalid rotation size: %s", optarg);
+        }
+        break;
       case 'q':
         quiet = true;
         break;
+      case 's':
+        stats_interval_sec = atoi(optarg);
+        if (stats_interval_sec <= 0) {
+          errx(1, "invalid stats interval: %s", optarg);
+        }
+        break;
+      case 'w':
+        worker_count = atoi(optarg);
+        if (worker_count < 0) {
+          errx(1, "invalid worker count: %s", optarg);
+        }
+        break;
       default:
         exit(1);
     }
@@ -307,6 +1779,20 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
     setbuf(stderr, NULL);
   }
+  if (sink_names == nullptr && record_prefix != nullptr &&
+      aggregate_interval_sec > 0) {
+    errx(1, "-o and -a can't be used together without -f");
+  }
+  if (replay_file != nullptr) {
+    replay(replay_file);
+    return 0;
+  }
+  if (record_prefix != nullptr) {
+    recorder = new Recorder(record_prefix, rotate_size);
+  }
+  if (sink_names != nullptr) {
+    newSinks(sink_names);
+  }
   std::string path("/tmp/gvisor_events.sock");
   if (optind < argc) {
     path = argv[optind];
@@ -333,13 +1819,19 @@ int main(int argc, char** argv) {
     err(1, "listen");
   }
 
-  int epoll_fd = epoll_create(1);
-  if (epoll_fd < 0) {
-    err(1, "epoll_create");
+  std::vector<std::unique_ptr<Worker>> workers = startWorkers(worker_count);
+  printf("Started %zu worker(s)\n", workers.size());
+  for (const auto& sink : sinks) {
+    sink->start();
+  }
+  if (aggregate_interval_sec > 0 && sinks.empty()) {
+    startSummaryThread(workers);
+  }
+  if (stats_interval_sec > 0) {
+    startStatsThread(workers);
   }
-  auto epoll_closer = absl::MakeCleanup([epoll_fd] { close(epoll_fd); });
-  startPollThread(epoll_fd);
 
+  uint64_t last_client_id = 0;
   for (;;) {
     int client = accept(sock, nullptr, nullptr);
     if (client < 0) {
@@ -348,17 +1840,35 @@ int main(int argc, char** argv) {
       }
       err(1, "accept");
     }
-    printf("Connection accepted\n");
+    uint64_t id = ++last_client_id;
+    printf("Connection accepted, client %lu\n", id);
 
-    if (!handshake(client)) {
+    std::unique_ptr<Ring> ring;
+    if (!handshake(client, &ring)) {
       close(client);
       continue;
     }
 
+    Worker* worker = pickWorker(workers);
+    worker->clients.fetch_add(1, std::memory_order_relaxed);
+    Client* c = new Client{client, worker, id};
+    c->socket_source = {c, false};
+    c->doorbell_source = {c, true};
     struct epoll_event evt;
-    evt.data.fd = client;
     evt.events = EPOLLIN;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client, &evt) < 0) {
+    if (ring != nullptr) {
+      printf("Using shared memory ring of %lu bytes\n", ring->size);
+      int doorbell = ring->doorbell;
+      c->ring = std::move(ring);
+      evt.data.ptr = &c->doorbell_source;
+      if (epoll_ctl(worker->poll_fd, EPOLL_CTL_ADD, doorbell, &evt) < 0) {
+        err(1, "epoll_ctl(ADD)");
+      }
+    }
+    // The client can be closed by the worker as soon as the socket is added,
+    // so it must be the last thing done with it.
+    evt.data.ptr = &c->socket_source;
+    if (epoll_ctl(worker->poll_fd, EPOLL_CTL_ADD, client, &evt) < 0) {
       err(1, "epoll_ctl(ADD)");
     }
   }
@@ -0,0 +1,177 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// memsoak keeps a fixed amount of anonymous memory resident while churning
+// through mappings, so that memory the kernel fails to release shows up as
+// growth over time rather than as application memory.
+//
+// The working set is split into regions. Each step picks a random region and
+// either replaces its mapping (munmap then mmap), discards its pages with
+// MADV_DONTNEED, or forks a child that dirties part of it. In all cases the
+// region is fully touched again before the next step, so the resident
+// application memory stays at --bytes.
+//
+// Once every second, and once done, a line "ops: <n> bytes: <n>" is printed
+// with the number of steps so far and the resident working set.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static long seconds = 60;
+static size_t bytes = 256 << 20;
+static int regions = 64;
+
+static void show_usage(const char *cmd) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "-s, --seconds <num>\t\tHow long to run, default 60\n"
+          "-b, --bytes <num>\t\tResident working set, default 256MB\n"
+          "-r, --regions <num>\t\tNumber of mappings the working set is "
+          "split into, default 64\n",
+          cmd);
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void touch(char *p, size_t len, size_t page_size, char val) {
+  for (size_t off = 0; off < len; off += page_size) {
+    p[off] = val;
+  }
+}
+
+static char *map_region(size_t len) {
+  char *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1, 0);
+  if (p == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+  return p;
+}
+
+int main(int argc, char *argv[]) {
+  int c;
+  struct option long_options[] = {{"seconds", required_argument, 0, 's'},
+                                  {"bytes", required_argument, 0, 'b'},
+                                  {"regions", required_argument, 0, 'r'},
+                                  {0, 0, 0, 0}};
+  int option_index = 0;
+
+  while ((c = getopt_long(argc, argv, "s:b:r:", long_options,
+                          &option_index)) != -1) {
+    switch (c) {
+      case 's':
+        seconds = atol(optarg);
+        break;
+      case 'b':
+        bytes = strtoull(optarg, NULL, 0);
+        break;
+      case 'r':
+        regions = atoi(optarg);
+        break;
+      default:
+        show_usage(argv[0]);
+        exit(1);
+    }
+  }
+  if (seconds <= 0 || regions <= 0 || bytes == 0) {
+    show_usage(argv[0]);
+    exit(1);
+  }
+
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t region_size = bytes / regions;
+  region_size -= region_size % page_size;
+  if (region_size == 0) {
+    fprintf(stderr, "--bytes must be at least one page per region\n");
+    exit(1);
+  }
+
+  char **mappings = calloc(regions, sizeof(char *));
+  if (mappings == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+  for (int i = 0; i < regions; i++) {
+    mappings[i] = map_region(region_size);
+    touch(mappings[i], region_size, page_size, 1);
+  }
+
+  unsigned int seed = 1;
+  long ops = 0;
+  const double start = now();
+  double next_report = start + 1;
+  for (;;) {
+    const double t = now();
+    if (t >= next_report || t - start >= seconds) {
+      printf("ops: %ld bytes: %zu\n", ops, region_size * regions);
+      fflush(stdout);
+      next_report = t + 1;
+      if (t - start >= seconds) {
+        break;
+      }
+    }
+
+    const int i = rand_r(&seed) % regions;
+    switch (rand_r(&seed) % 3) {
+      case 0:
+        // Replace the mapping with a fresh one.
+        if (munmap(mappings[i], region_size) != 0) {
+          perror("munmap");
+          exit(1);
+        }
+        mappings[i] = map_region(region_size);
+        break;
+      case 1:
+        // Release the pages, as allocators do for freed memory.
+        if (madvise(mappings[i], region_size, MADV_DONTNEED) != 0) {
+          perror("madvise");
+          exit(1);
+        }
+        break;
+      case 2: {
+        // Fork a child that breaks copy-on-write on part of the region.
+        pid_t pid = fork();
+        if (pid < 0) {
+          perror("fork");
+          exit(1);
+        }
+        if (pid == 0) {
+          touch(mappings[i], region_size / 4, page_size, 2);
+          _exit(0);
+        }
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+          fprintf(stderr, "child failed\n");
+          exit(1);
+        }
+        break;
+      }
+    }
+    touch(mappings[i], region_size, page_size, 1);
+    ops++;
+  }
+  return 0;
+}
@@ -0,0 +1,228 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This program measures the cost of CUDA operations that go through the
+// driver, and therefore through nvproxy when run in gVisor:
+//
+// - cudaMemcpy bandwidth between host and device, for pageable memory (plain
+//   malloc), pinned memory (cudaHostAlloc) and registered memory
+//   (cudaHostRegister).
+// - Page fault driven migration throughput of cudaMallocManaged memory, from
+//   host to device and back.
+// - Kernel launch latency, both synchronous (launch then wait) and
+//   asynchronous (many launches then a single wait).
+//
+// Each result is printed on its own line as "<name>: <value> <unit>".
+//
+// Usage: cuda_bench [--iterations=N] [--bytes=N]
+
+#include <cuda_runtime.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "cuda_test_util.h"  // NOLINT(build/include)
+
+__global__ void emptyKernel() {}
+
+// touchKernel writes one byte per page of data, faulting each page onto the
+// device.
+__global__ void touchKernel(char* data, size_t bytes, size_t page_size) {
+  size_t pages = bytes / page_size;
+  for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < pages;
+       i += blockDim.x * gridDim.x) {
+    data[i * page_size] += 1;
+  }
+}
+
+void printResult(const char* name, double value, const char* unit) {
+  printf("%s: %.3f %s\n", name, value, unit);
+  fflush(stdout);
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// BenchmarkMemcpy measures the bandwidth of copies between host and the
+// device buffer, in both directions.
+void BenchmarkMemcpy(const char* kind, void* host, void* device, size_t bytes,
+                     int iterations) {
+  cudaEvent_t start, stop;
+  CHECK_CUDA(cudaEventCreate(&start));
+  CHECK_CUDA(cudaEventCreate(&stop));
+
+  // Warm up, so that one-time costs such as pinning pageable staging buffers
+  // are not measured.
+  CHECK_CUDA(cudaMemcpy(device, host, bytes, cudaMemcpyHostToDevice));
+  CHECK_CUDA(cudaMemcpy(host, device, bytes, cudaMemcpyDeviceToHost));
+
+  for (auto direction : {cudaMemcpyHostToDevice, cudaMemcpyDeviceToHost}) {
+    void* dst = direction == cudaMemcpyHostToDevice ? device : host;
+    void* src = direction == cudaMemcpyHostToDevice ? host : device;
+    CHECK_CUDA(cudaEventRecord(start));
+    for (int i = 0; i < iterations; i++) {
+      CHECK_CUDA(cudaMemcpy(dst, src, bytes, direction));
+    }
+    CHECK_CUDA(cudaEventRecord(stop));
+    CHECK_CUDA(cudaEventSynchronize(stop));
+    float ms;
+    CHECK_CUDA(cudaEventElapsedTime(&ms, start, stop));
+
+    char name[64];
+    snprintf(name, sizeof(name), "memcpy_%s_%s",
+             direction == cudaMemcpyHostToDevice ? "h2d" : "d2h", kind);
+    printResult(name,
+                static_cast<double>(bytes) * iterations / (ms / 1e3) / 1e9,
+                "GB/s");
+  }
+
+  CHECK_CUDA(cudaEventDestroy(start));
+  CHECK_CUDA(cudaEventDestroy(stop));
+}
+
+void BenchmarkMemcpyAll(size_t bytes, int iterations) {
+  void* device;
+  CHECK_CUDA(cudaMalloc(&device, bytes));
+
+  void* pageable = malloc(bytes);
+  if (pageable == nullptr) {
+    fprintf(stderr, "malloc(%zu) failed\n", bytes);
+    abort();
+  }
+  memset(pageable, 1, bytes);
+  BenchmarkMemcpy("pageable", pageable, device, bytes, iterations);
+
+  // Registering the same buffer pins it, so the only difference with the
+  // pageable case is how the driver treats the memory.
+  CHECK_CUDA(cudaHostRegister(pageable, bytes, cudaHostRegisterDefault));
+  BenchmarkMemcpy("registered", pageable, device, bytes, iterations);
+  CHECK_CUDA(cudaHostUnregister(pageable));
+  free(pageable);
+
+  void* pinned;
+  CHECK_CUDA(cudaHostAlloc(&pinned, bytes, cudaHostAllocDefault));
+  memset(pinned, 1, bytes);
+  BenchmarkMemcpy("pinned", pinned, device, bytes, iterations);
+  CHECK_CUDA(cudaFreeHost(pinned));
+
+  CHECK_CUDA(cudaFree(device));
+}
+
+// BenchmarkManagedMigration measures how fast cudaMallocManaged memory
+// migrates on page faults: first to the device when a kernel touches every
+// page, then back to the host when the host touches every page.
+void BenchmarkManagedMigration(int device, size_t bytes, int iterations) {
+  int cma = 0;
+  CHECK_CUDA(
+      cudaDeviceGetAttribute(&cma, cudaDevAttrConcurrentManagedAccess, device));
+  if (!cma) {
+    printf("// cudaDevAttrConcurrentManagedAccess not available, skipping "
+           "managed memory migration\n");
+    return;
+  }
+
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  char* data;
+  CHECK_CUDA(cudaMallocManaged(&data, bytes, cudaMemAttachGlobal));
+  memset(data, 0, bytes);
+
+  double h2d_seconds = 0;
+  double d2h_seconds = 0;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    touchKernel<<<256, 256>>>(data, bytes, page_size);
+    CHECK_CUDA(cudaGetLastError());
+    CHECK_CUDA(cudaDeviceSynchronize());
+    h2d_seconds += secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t off = 0; off < bytes; off += page_size) {
+      data[off] += 1;
+    }
+    d2h_seconds += secondsSince(start);
+  }
+  printResult("managed_migration_h2d",
+              static_cast<double>(bytes) * iterations / h2d_seconds / 1e9,
+              "GB/s");
+  printResult("managed_migration_d2h",
+              static_cast<double>(bytes) * iterations / d2h_seconds / 1e9,
+              "GB/s");
+
+  CHECK_CUDA(cudaFree(data));
+}
+
+// BenchmarkLaunch measures kernel launch latency.
+void BenchmarkLaunch(int iterations) {
+  // Warm up, so that module loading is not measured.
+  emptyKernel<<<1, 1>>>();
+  CHECK_CUDA(cudaGetLastError());
+  CHECK_CUDA(cudaDeviceSynchronize());
+
+  // Synchronous launches include the round trip to wait for completion.
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    emptyKernel<<<1, 1>>>();
+    CHECK_CUDA(cudaDeviceSynchronize());
+  }
+  printResult("launch_sync_latency", secondsSince(start) / iterations * 1e6,
+              "us");
+
+  // Asynchronous launches only measure the cost of queueing the launch.
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    emptyKernel<<<1, 1>>>();
+  }
+  CHECK_CUDA(cudaDeviceSynchronize());
+  printResult("launch_async_latency", secondsSince(start) / iterations * 1e6,
+              "us");
+}
+
+int main(int argc, char* argv[]) {
+  int iterations = 100;
+  size_t bytes = 64 << 20;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--iterations=", 13) == 0) {
+      iterations = atoi(argv[i] + 13);
+    } else if (strncmp(argv[i], "--bytes=", 8) == 0) {
+      bytes = strtoull(argv[i] + 8, nullptr, 0);
+    } else {
+      fprintf(stderr, "Usage: %s [--iterations=N] [--bytes=N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (iterations <= 0 || bytes == 0) {
+    fprintf(stderr, "--iterations and --bytes must be positive\n");
+    return 1;
+  }
+
+  int device;
+  CHECK_CUDA(cudaGetDevice(&device));
+  cudaDeviceProp properties;
+  CHECK_CUDA(cudaGetDeviceProperties(&properties, device));
+  printf("// Device: %s, %zu bytes per transfer, %d iterations\n",
+         properties.name, bytes, iterations);
+
+  BenchmarkMemcpyAll(bytes, iterations);
+  BenchmarkManagedMigration(device, bytes, iterations);
+  BenchmarkLaunch(iterations * 100);
+  return 0;
+}
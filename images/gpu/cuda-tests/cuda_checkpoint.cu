@@ -0,0 +1,176 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This program is the workload of GPU checkpoint/restore benchmarks. It
+// allocates device memory, fills it with a pattern derived from a seed, then
+// prints "ready" and waits for SIGUSR1. The container is meant to be
+// checkpointed and restored while it waits. On SIGUSR1, it checks that device
+// memory still holds the pattern, prints "verified" and exits, or prints the
+// number of mismatched words and aborts.
+//
+// Results are printed on their own line as "<name>: <value> <unit>", like
+// cuda_bench.
+//
+// Usage: cuda_checkpoint [--bytes=N] [--seed=N]
+
+#include <cuda_runtime.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "cuda_test_util.h"  // NOLINT(build/include)
+
+constexpr int kBlocks = 1024;
+constexpr int kThreads = 256;
+
+// pattern returns the expected value of word i, which differs for every word
+// so that misplaced pages are detected as well as lost ones.
+__device__ std::uint64_t pattern(std::uint64_t seed, size_t i) {
+  std::uint64_t x = seed ^ (i * 0x9e3779b97f4a7c15ULL);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  return x;
+}
+
+__global__ void fillKernel(std::uint64_t* data, size_t words,
+                           std::uint64_t seed) {
+  for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < words;
+       i += blockDim.x * gridDim.x) {
+    data[i] = pattern(seed, i);
+  }
+}
+
+__global__ void verifyKernel(const std::uint64_t* data, size_t words,
+                             std::uint64_t seed,
+                             unsigned long long* mismatches) {
+  unsigned long long local = 0;
+  for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < words;
+       i += blockDim.x * gridDim.x) {
+    if (data[i] != pattern(seed, i)) {
+      local++;
+    }
+  }
+  if (local != 0) {
+    atomicAdd(mismatches, local);
+  }
+}
+
+void printResult(const char* name, double value, const char* unit) {
+  printf("%s: %.3f %s\n", name, value, unit);
+  fflush(stdout);
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Verify returns the number of words of data that don't match the pattern.
+unsigned long long Verify(const std::uint64_t* data, size_t words,
+                          std::uint64_t seed) {
+  unsigned long long* mismatches;
+  CHECK_CUDA(cudaMalloc(&mismatches, sizeof(*mismatches)));
+  CHECK_CUDA(cudaMemset(mismatches, 0, sizeof(*mismatches)));
+  verifyKernel<<<kBlocks, kThreads>>>(data, words, seed, mismatches);
+  CHECK_CUDA(cudaGetLastError());
+  unsigned long long result;
+  CHECK_CUDA(cudaMemcpy(&result, mismatches, sizeof(result),
+                        cudaMemcpyDeviceToHost));
+  CHECK_CUDA(cudaFree(mismatches));
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  size_t bytes = 1ULL << 30;
+  std::uint64_t seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--bytes=", 8) == 0) {
+      bytes = strtoull(argv[i] + 8, nullptr, 0);
+    } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+      seed = strtoull(argv[i] + 7, nullptr, 0);
+    } else {
+      fprintf(stderr, "Usage: %s [--bytes=N] [--seed=N]\n", argv[0]);
+      return 1;
+    }
+  }
+  const size_t words = bytes / sizeof(std::uint64_t);
+  if (words == 0) {
+    fprintf(stderr, "--bytes must be at least %zu\n", sizeof(std::uint64_t));
+    return 1;
+  }
+
+  // Block SIGUSR1 before announcing readiness, so that it stays pending
+  // until sigwait even if it is sent right away.
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  if (sigprocmask(SIG_BLOCK, &set, nullptr) != 0) {
+    perror("sigprocmask");
+    return 1;
+  }
+
+  int device;
+  CHECK_CUDA(cudaGetDevice(&device));
+  cudaDeviceProp properties;
+  CHECK_CUDA(cudaGetDeviceProperties(&properties, device));
+  size_t free_bytes, total_bytes;
+  CHECK_CUDA(cudaMemGetInfo(&free_bytes, &total_bytes));
+  printf("// Device: %s, %zu bytes free of %zu, %zu bytes to fill\n",
+         properties.name, free_bytes, total_bytes,
+         words * sizeof(std::uint64_t));
+  fflush(stdout);
+
+  std::uint64_t* data;
+  CHECK_CUDA(cudaMalloc(&data, words * sizeof(*data)));
+  auto start = std::chrono::steady_clock::now();
+  fillKernel<<<kBlocks, kThreads>>>(data, words, seed);
+  CHECK_CUDA(cudaGetLastError());
+  CHECK_CUDA(cudaDeviceSynchronize());
+  printResult("fill_bandwidth",
+              static_cast<double>(words * sizeof(*data)) / secondsSince(start) /
+                  1e9,
+              "GB/s");
+
+  // Check the pattern once before checkpointing, so that a mismatch after
+  // restore can only be caused by checkpoint/restore.
+  if (unsigned long long mismatches = Verify(data, words, seed)) {
+    printf("%llu words mismatched before checkpoint\n", mismatches);
+    abort();
+  }
+  printf("ready\n");
+  fflush(stdout);
+
+  int sig;
+  if (sigwait(&set, &sig) != 0) {
+    perror("sigwait");
+    return 1;
+  }
+
+  start = std::chrono::steady_clock::now();
+  if (unsigned long long mismatches = Verify(data, words, seed)) {
+    printf("%llu words mismatched after restore\n", mismatches);
+    abort();
+  }
+  printResult("verify_latency", secondsSince(start) * 1e6, "us");
+  printf("verified\n");
+  fflush(stdout);
+  CHECK_CUDA(cudaFree(data));
+  return 0;
+}
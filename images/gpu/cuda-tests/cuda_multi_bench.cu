@@ -0,0 +1,279 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This program measures how CUDA throughput scales with the number of
+// processes driving GPUs concurrently, the way training jobs run one process
+// per GPU. Serialization in the driver, or in nvproxy when run in gVisor,
+// shows up as aggregate throughput that doesn't grow with the number of
+// processes.
+//
+// It forks the given number of processes, each using a different GPU, or all
+// sharing the first GPU with --shared. All processes run each phase at the
+// same time, and the parent measures the wall time until all of them are done:
+//
+// - Launching empty kernels asynchronously.
+// - Copying pinned memory from host to device, then from device to host.
+//
+// Each aggregate result is printed on its own line as
+// "<name>: <value> <unit>".
+//
+// Usage: cuda_multi_bench [--processes=N] [--shared] [--iterations=N]
+//                         [--bytes=N]
+
+#include <cuda_runtime.h>
+#include <err.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+#include "cuda_test_util.h"  // NOLINT(build/include)
+
+__global__ void emptyKernel() {}
+
+// Phases run by each process, in order.
+enum Phase { kLaunch, kMemcpyH2D, kMemcpyD2H, kNumPhases };
+
+struct Options {
+  int processes = 0;
+  bool shared = false;
+  int iterations = 100;
+  size_t bytes = 64 << 20;
+};
+
+// Launches per iteration, since a single launch is much cheaper than a copy.
+constexpr int kLaunchesPerIteration = 100;
+
+void writeByte(int fd) {
+  char c = 0;
+  while (write(fd, &c, 1) != 1) {
+    if (errno != EINTR) {
+      err(1, "write");
+    }
+  }
+}
+
+void readByte(int fd) {
+  char c;
+  for (;;) {
+    ssize_t n = read(fd, &c, 1);
+    if (n == 1) {
+      return;
+    }
+    if (n == 0) {
+      errx(1, "read: unexpected EOF, a process probably failed");
+    }
+    if (errno != EINTR) {
+      err(1, "read");
+    }
+  }
+}
+
+// runChild sets up the device, then runs each phase when told to by the
+// parent through `go`, and reports completion through `done`.
+void runChild(const Options& opts, int device, int go, int done) {
+  CHECK_CUDA(cudaSetDevice(device));
+  void* host;
+  void* dev;
+  CHECK_CUDA(cudaHostAlloc(&host, opts.bytes, cudaHostAllocDefault));
+  CHECK_CUDA(cudaMalloc(&dev, opts.bytes));
+  memset(host, 1, opts.bytes);
+
+  // Warm up, so that context creation and module loading are not measured.
+  emptyKernel<<<1, 1>>>();
+  CHECK_CUDA(cudaGetLastError());
+  CHECK_CUDA(cudaMemcpy(dev, host, opts.bytes, cudaMemcpyHostToDevice));
+  CHECK_CUDA(cudaMemcpy(host, dev, opts.bytes, cudaMemcpyDeviceToHost));
+
+  writeByte(done);
+  for (int phase = 0; phase < kNumPhases; phase++) {
+    readByte(go);
+    switch (phase) {
+      case kLaunch:
+        for (int i = 0; i < opts.iterations * kLaunchesPerIteration; i++) {
+          emptyKernel<<<1, 1>>>();
+        }
+        CHECK_CUDA(cudaGetLastError());
+        CHECK_CUDA(cudaDeviceSynchronize());
+        break;
+      case kMemcpyH2D:
+        for (int i = 0; i < opts.iterations; i++) {
+          CHECK_CUDA(
+              cudaMemcpy(dev, host, opts.bytes, cudaMemcpyHostToDevice));
+        }
+        break;
+      case kMemcpyD2H:
+        for (int i = 0; i < opts.iterations; i++) {
+          CHECK_CUDA(
+              cudaMemcpy(host, dev, opts.bytes, cudaMemcpyDeviceToHost));
+        }
+        break;
+    }
+    writeByte(done);
+  }
+
+  CHECK_CUDA(cudaFree(dev));
+  CHECK_CUDA(cudaFreeHost(host));
+}
+
+// deviceCount returns the number of GPUs. The CUDA runtime must not be
+// initialized in the parent before forking, so this runs in a child process.
+int deviceCount() {
+  int fds[2];
+  if (pipe(fds) < 0) {
+    err(1, "pipe");
+  }
+  pid_t pid = fork();
+  if (pid < 0) {
+    err(1, "fork");
+  }
+  if (pid == 0) {
+    int count;
+    CHECK_CUDA(cudaGetDeviceCount(&count));
+    if (write(fds[1], &count, sizeof(count)) != sizeof(count)) {
+      err(1, "write");
+    }
+    _exit(0);
+  }
+  close(fds[1]);
+  int count = 0;
+  if (read(fds[0], &count, sizeof(count)) != sizeof(count)) {
+    errx(1, "failed to get the number of GPUs");
+  }
+  close(fds[0]);
+  int status;
+  if (waitpid(pid, &status, 0) < 0) {
+    err(1, "waitpid");
+  }
+  return count;
+}
+
+void printResult(const char* name, double value, const char* unit) {
+  printf("%s: %.3f %s\n", name, value, unit);
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--processes=", 12) == 0) {
+      opts.processes = atoi(argv[i] + 12);
+    } else if (strcmp(argv[i], "--shared") == 0) {
+      opts.shared = true;
+    } else if (strncmp(argv[i], "--iterations=", 13) == 0) {
+      opts.iterations = atoi(argv[i] + 13);
+    } else if (strncmp(argv[i], "--bytes=", 8) == 0) {
+      opts.bytes = strtoull(argv[i] + 8, nullptr, 0);
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--processes=N] [--shared] [--iterations=N] "
+              "[--bytes=N]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  int devices = deviceCount();
+  if (devices == 0) {
+    errx(1, "no GPUs found");
+  }
+  if (opts.processes == 0) {
+    // Default to one process per GPU.
+    opts.processes = devices;
+  }
+  if (opts.processes < 0 || opts.iterations <= 0 || opts.bytes == 0) {
+    errx(1, "--processes, --iterations and --bytes must be positive");
+  }
+  if (!opts.shared && opts.processes > devices) {
+    errx(1, "%d processes requested but only %d GPUs found; use --shared",
+         opts.processes, devices);
+  }
+  printf("// %d processes on %d GPUs (%s), %zu bytes per transfer, %d "
+         "iterations\n",
+         opts.processes, opts.shared ? 1 : opts.processes,
+         opts.shared ? "shared" : "one per process", opts.bytes,
+         opts.iterations);
+  // Don't let the processes inherit buffered output.
+  fflush(stdout);
+
+  std::vector<pid_t> pids;
+  std::vector<int> go_fds, done_fds;
+  for (int i = 0; i < opts.processes; i++) {
+    int go[2], done[2];
+    if (pipe(go) < 0 || pipe(done) < 0) {
+      err(1, "pipe");
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+      err(1, "fork");
+    }
+    if (pid == 0) {
+      close(go[1]);
+      close(done[0]);
+      runChild(opts, opts.shared ? 0 : i, go[0], done[1]);
+      _exit(0);
+    }
+    close(go[0]);
+    close(done[1]);
+    pids.push_back(pid);
+    go_fds.push_back(go[1]);
+    done_fds.push_back(done[0]);
+  }
+
+  // Wait for all processes to be ready. Each process then reports when it's
+  // done with a phase, which also means it's ready for the next one.
+  for (int fd : done_fds) {
+    readByte(fd);
+  }
+  double seconds[kNumPhases];
+  for (int phase = 0; phase < kNumPhases; phase++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int fd : go_fds) {
+      writeByte(fd);
+    }
+    for (int fd : done_fds) {
+      readByte(fd);
+    }
+    seconds[phase] = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  }
+
+  for (pid_t pid : pids) {
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+      err(1, "waitpid");
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      errx(1, "process %d failed with status %d", pid, status);
+    }
+  }
+
+  const double total_bytes =
+      static_cast<double>(opts.bytes) * opts.iterations * opts.processes;
+  printResult("aggregate_launch_rate",
+              static_cast<double>(opts.iterations) * kLaunchesPerIteration *
+                  opts.processes / seconds[kLaunch],
+              "launches/s");
+  printResult("aggregate_memcpy_h2d", total_bytes / seconds[kMemcpyH2D] / 1e9,
+              "GB/s");
+  printResult("aggregate_memcpy_d2h", total_bytes / seconds[kMemcpyD2H] / 1e9,
+              "GB/s");
+  return 0;
+}
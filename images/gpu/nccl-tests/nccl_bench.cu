@@ -0,0 +1,347 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This program measures NCCL all-reduce and all-gather bandwidth over a sweep
+// of message sizes. Each process drives --gpus local GPUs, and --procs
+// processes, possibly in different sandboxes, join the same communicator.
+// Process 0 creates the NCCL unique ID and hands it to the others over TCP on
+// --port; the others connect to it with --root=<host>:<port>.
+//
+// Bus bandwidth is computed like nccl-tests does, so that it is comparable
+// across numbers of ranks and to the hardware's link bandwidth:
+// - all-reduce: algbw * 2 * (n - 1) / n, where algbw is the buffer size over
+//   the time taken.
+// - all-gather: algbw * (n - 1) / n, where algbw is the size of the gathered
+//   buffer over the time taken.
+//
+// Process 0 prints each result on its own line as "<name>: <value> <unit>",
+// like cuda_bench.
+//
+// Usage: nccl_bench [--gpus=N] [--procs=N --proc=N (--port=N|--root=H:P)]
+//                   [--min_bytes=N] [--max_bytes=N] [--iterations=N]
+
+#include <arpa/inet.h>
+#include <cuda_runtime.h>
+#include <nccl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define CHECK_CUDA(expr)                                                 \
+  do {                                                                   \
+    cudaError_t code = (expr);                                           \
+    if (code != cudaSuccess) {                                           \
+      fprintf(stderr, "Check failed at %s:%d: %s: %s\n", __FILE__,       \
+              __LINE__, #expr, cudaGetErrorString(code));                \
+      abort();                                                           \
+    }                                                                    \
+  } while (0)
+
+#define CHECK_NCCL(expr)                                                 \
+  do {                                                                   \
+    ncclResult_t code = (expr);                                          \
+    if (code != ncclSuccess) {                                           \
+      fprintf(stderr, "Check failed at %s:%d: %s: %s\n", __FILE__,       \
+              __LINE__, #expr, ncclGetErrorString(code));                \
+      abort();                                                           \
+    }                                                                    \
+  } while (0)
+
+#define CHECK_ERRNO(expr) \
+  do {                    \
+    if ((expr) < 0) {     \
+      perror(#expr);      \
+      abort();            \
+    }                     \
+  } while (0)
+
+// Local holds the per-GPU state of this process.
+struct Local {
+  int device;
+  ncclComm_t comm;
+  cudaStream_t stream;
+  float* send;
+  float* recv;
+};
+
+void printResult(const std::string& name, double value, const char* unit) {
+  printf("%s: %.3f %s\n", name.c_str(), value, unit);
+  fflush(stdout);
+}
+
+void writeAll(int fd, const void* buf, size_t len) {
+  const char* p = static_cast<const char*>(buf);
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    CHECK_ERRNO(n);
+    p += n;
+    len -= n;
+  }
+}
+
+void readAll(int fd, void* buf, size_t len) {
+  char* p = static_cast<char*>(buf);
+  while (len > 0) {
+    ssize_t n = read(fd, p, len);
+    CHECK_ERRNO(n);
+    if (n == 0) {
+      fprintf(stderr, "unexpected EOF while reading the NCCL unique ID\n");
+      abort();
+    }
+    p += n;
+    len -= n;
+  }
+}
+
+// ServeID sends id to the procs - 1 other processes as they connect to port.
+void ServeID(const ncclUniqueId& id, int port, int procs) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  CHECK_ERRNO(fd);
+  int one = 1;
+  CHECK_ERRNO(setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  CHECK_ERRNO(bind(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                   sizeof(addr)));
+  CHECK_ERRNO(listen(fd, procs));
+  printf("// Waiting for %d processes on port %d\n", procs - 1, port);
+  fflush(stdout);
+  for (int i = 1; i < procs; i++) {
+    int conn = accept(fd, nullptr, nullptr);
+    CHECK_ERRNO(conn);
+    writeAll(conn, &id, sizeof(id));
+    close(conn);
+  }
+  close(fd);
+}
+
+// FetchID receives the unique ID from process 0 at root, retrying until it
+// listens.
+ncclUniqueId FetchID(const std::string& root) {
+  size_t colon = root.rfind(':');
+  if (colon == std::string::npos) {
+    fprintf(stderr, "--root must be <host>:<port>, got %s\n", root.c_str());
+    abort();
+  }
+  const std::string host = root.substr(0, colon);
+  const std::string port = root.substr(colon + 1);
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  for (int attempt = 0;; attempt++) {
+    struct addrinfo* res;
+    int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (err == 0) {
+      int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+      CHECK_ERRNO(fd);
+      if (connect(fd, res->ai_addr, res->ai_addrlen) == 0) {
+        freeaddrinfo(res);
+        ncclUniqueId id;
+        readAll(fd, &id, sizeof(id));
+        close(fd);
+        return id;
+      }
+      close(fd);
+      freeaddrinfo(res);
+    }
+    if (attempt == 600) {
+      fprintf(stderr, "could not get the NCCL unique ID from %s\n",
+              root.c_str());
+      abort();
+    }
+    usleep(100 * 1000);
+  }
+}
+
+// Collective runs one collective of count elements per rank on every local
+// GPU.
+typedef void (*Collective)(const Local& local, size_t count);
+
+void AllReduce(const Local& l, size_t count) {
+  CHECK_NCCL(ncclAllReduce(l.send, l.recv, count, ncclFloat, ncclSum, l.comm,
+                           l.stream));
+}
+
+void AllGather(const Local& l, size_t count) {
+  CHECK_NCCL(ncclAllGather(l.send, l.recv, count, ncclFloat, l.comm,
+                           l.stream));
+}
+
+// Time returns the average duration in seconds of running collective on all
+// local GPUs, over iterations.
+double Time(std::vector<Local>& locals, Collective collective, size_t count,
+            int iterations) {
+  auto run = [&](int n) {
+    for (int i = 0; i < n; i++) {
+      CHECK_NCCL(ncclGroupStart());
+      for (const Local& l : locals) {
+        collective(l, count);
+      }
+      CHECK_NCCL(ncclGroupEnd());
+    }
+    for (const Local& l : locals) {
+      CHECK_CUDA(cudaSetDevice(l.device));
+      CHECK_CUDA(cudaStreamSynchronize(l.stream));
+    }
+  };
+  // Warm up, so that connection setup is not measured.
+  run(2);
+  auto start = std::chrono::steady_clock::now();
+  run(iterations);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+             .count() /
+         iterations;
+}
+
+int main(int argc, char* argv[]) {
+  int gpus = 0;
+  int procs = 1;
+  int proc = 0;
+  int port = 0;
+  std::string root;
+  size_t min_bytes = 1 << 20;
+  size_t max_bytes = 1 << 30;
+  int iterations = 20;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--gpus=", 7) == 0) {
+      gpus = atoi(argv[i] + 7);
+    } else if (strncmp(argv[i], "--procs=", 8) == 0) {
+      procs = atoi(argv[i] + 8);
+    } else if (strncmp(argv[i], "--proc=", 7) == 0) {
+      proc = atoi(argv[i] + 7);
+    } else if (strncmp(argv[i], "--port=", 7) == 0) {
+      port = atoi(argv[i] + 7);
+    } else if (strncmp(argv[i], "--root=", 7) == 0) {
+      root = argv[i] + 7;
+    } else if (strncmp(argv[i], "--min_bytes=", 12) == 0) {
+      min_bytes = strtoull(argv[i] + 12, nullptr, 0);
+    } else if (strncmp(argv[i], "--max_bytes=", 12) == 0) {
+      max_bytes = strtoull(argv[i] + 12, nullptr, 0);
+    } else if (strncmp(argv[i], "--iterations=", 13) == 0) {
+      iterations = atoi(argv[i] + 13);
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--gpus=N] [--procs=N --proc=N "
+              "(--port=N|--root=H:P)] [--min_bytes=N] [--max_bytes=N] "
+              "[--iterations=N]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (gpus == 0) {
+    CHECK_CUDA(cudaGetDeviceCount(&gpus));
+  }
+  if (gpus <= 0 || procs <= 0 || proc < 0 || proc >= procs ||
+      iterations <= 0 || min_bytes < sizeof(float) || min_bytes > max_bytes) {
+    fprintf(stderr, "invalid arguments\n");
+    return 1;
+  }
+  if (procs > 1 && (proc == 0 ? port == 0 : root.empty())) {
+    fprintf(stderr, "--proc=0 needs --port, other processes need --root\n");
+    return 1;
+  }
+  const int nranks = gpus * procs;
+
+  ncclUniqueId id;
+  if (proc == 0) {
+    CHECK_NCCL(ncclGetUniqueId(&id));
+    if (procs > 1) {
+      ServeID(id, port, procs);
+    }
+  } else {
+    id = FetchID(root);
+  }
+
+  // The all-gather output buffer holds every rank's input, so it bounds the
+  // allocation.
+  std::vector<Local> locals(gpus);
+  CHECK_NCCL(ncclGroupStart());
+  for (int g = 0; g < gpus; g++) {
+    Local& l = locals[g];
+    l.device = g;
+    CHECK_CUDA(cudaSetDevice(g));
+    CHECK_CUDA(cudaStreamCreate(&l.stream));
+    CHECK_CUDA(cudaMalloc(&l.send, max_bytes));
+    CHECK_CUDA(cudaMalloc(&l.recv, max_bytes));
+    CHECK_CUDA(cudaMemset(l.send, 0, max_bytes));
+    CHECK_NCCL(ncclCommInitRank(&l.comm, nranks, id, proc * gpus + g));
+  }
+  CHECK_NCCL(ncclGroupEnd());
+
+  if (proc == 0) {
+    int version;
+    CHECK_NCCL(ncclGetVersion(&version));
+    printf("// NCCL %d, %d ranks (%d processes of %d GPUs), %d iterations\n",
+           version, nranks, procs, gpus, iterations);
+    fflush(stdout);
+  }
+
+  struct {
+    const char* name;
+    Collective collective;
+    double bus_factor;
+    // Whether the element count per rank is the buffer size divided by the
+    // number of ranks.
+    bool per_rank;
+  } collectives[] = {
+      {"all_reduce", AllReduce, 2.0 * (nranks - 1) / nranks, false},
+      {"all_gather", AllGather, 1.0 * (nranks - 1) / nranks, true},
+  };
+  for (const auto& c : collectives) {
+    double sum = 0;
+    int sizes = 0;
+    for (size_t bytes = min_bytes; bytes <= max_bytes; bytes *= 4) {
+      size_t count = bytes / sizeof(float);
+      if (c.per_rank) {
+        count /= nranks;
+        if (count == 0) {
+          continue;
+        }
+      }
+      const size_t total =
+          count * sizeof(float) * (c.per_rank ? nranks : 1);
+      const double seconds = Time(locals, c.collective, count, iterations);
+      const double busbw = total / seconds / 1e9 * c.bus_factor;
+      sum += busbw;
+      sizes++;
+      if (proc == 0) {
+        printResult(std::string(c.name) + "_busbw_" + std::to_string(bytes),
+                    busbw, "GB/s");
+      }
+    }
+    if (proc == 0 && sizes > 0) {
+      printResult(std::string(c.name) + "_avg_busbw", sum / sizes, "GB/s");
+    }
+  }
+
+  for (Local& l : locals) {
+    CHECK_CUDA(cudaSetDevice(l.device));
+    CHECK_NCCL(ncclCommDestroy(l.comm));
+    CHECK_CUDA(cudaStreamDestroy(l.stream));
+    CHECK_CUDA(cudaFree(l.send));
+    CHECK_CUDA(cudaFree(l.recv));
+  }
+  return 0;
+}
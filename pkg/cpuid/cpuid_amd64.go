@@ -444,6 +444,18 @@ func (fs FeatureSet) AMXExtendedStateSize() uint {
 	return total
 }
 
+// ExtendedStateComponent returns the offset and the size in bytes of the
+// given state component in the standard (non-compacted) format of the XSAVE
+// area. It returns zeroes for unsupported components and for x87 and SSE
+// state, which live in the legacy region.
+func (fs FeatureSet) ExtendedStateComponent(i uint32) (offset, size uint32) {
+	if !fs.UseXsave() || i < 2 || i >= xSaveInfoNumLeaves {
+		return 0, 0
+	}
+	out := fs.Query(In{Eax: uint32(xSaveInfo), Ecx: i})
+	return out.Ebx, out.Eax
+}
+
 // ValidXCR0Mask returns the valid bits in control register XCR0.
 //
 // Always exclude AMX bits, because we do not support it.
@@ -90,6 +90,12 @@ func (fs FeatureSet) HasFeature(feature Feature) bool {
 	return fs.hwCap.hwCap1&(1<<feature) != 0
 }
 
+// HasSelfSyncCounter returns true if 'fs' supports FEAT_ECV, which adds the
+// self-synchronized virtual counter CNTVCTSS_EL0.
+func (fs FeatureSet) HasSelfSyncCounter() bool {
+	return fs.hwCap.hwCap2&HWCAP2_ECV != 0
+}
+
 // WriteCPUInfoTo is to generate a section of one cpu in /proc/cpuinfo. This is
 // a minimal /proc/cpuinfo, and the bogomips field is simply made up.
 func (fs FeatureSet) WriteCPUInfoTo(cpu, numCPU uint, w io.Writer) {
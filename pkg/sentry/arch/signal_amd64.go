@@ -242,10 +242,8 @@ func (c *Context64) SignalRestore(st *Stack, rt bool, featureSet cpuid.FeatureSe
 	if _, err := uc.CopyIn(st, StackBottomMagic); err != nil {
 		return 0, linux.SignalStack{}, err
 	}
-	var info linux.SignalInfo
-	if _, err := info.CopyIn(st, StackBottomMagic); err != nil {
-		return 0, linux.SignalStack{}, err
-	}
+	// The siginfo that follows the ucontext isn't read: like Linux's
+	// rt_sigreturn, nothing in it is restored.
 
 	// Restore registers.
 	c.Regs.R8 = uc.MContext.R8
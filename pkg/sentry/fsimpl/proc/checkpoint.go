@@ -48,6 +48,10 @@ func (fs *filesystem) newGvisorInode(ctx context.Context, root *auth.Credentials
 		log.Infof("Setting up fscheckpoint files under [procfs]/gvisor")
 		gvisorFiles["fscheckpoint"] = newFSCheckpointInode(ctx, k, root, linux.UNNAMED_MAJOR, fs.devMinor, fs.NextIno())
 	}
+	if internalData.ProfileTriggerEnabled {
+		log.Infof("Setting up profile file under [procfs]/gvisor")
+		gvisorFiles["profile"] = newProfileInode(ctx, k, root, linux.UNNAMED_MAJOR, fs.devMinor, fs.NextIno())
+	}
 	if len(gvisorFiles) == 0 {
 		return nil
 	}
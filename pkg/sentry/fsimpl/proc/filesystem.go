@@ -170,6 +170,10 @@ type InternalData struct {
 	// filesystem checkpoint by writing to /proc/gvisor/fscheckpoint.
 	FSCheckpointEnabled bool
 
+	// ProfileTriggerEnabled indicates whether the application can collect
+	// profiles of the sentry through /proc/gvisor/profile.
+	ProfileTriggerEnabled bool
+
 	// GVisorMarkerFile indicates whether a file named gvisor/kernel_is_gvisor
 	// should exist in the procfs.
 	GVisorMarkerFile bool
@@ -0,0 +1,269 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package proc
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"runtime"
+	"runtime/pprof"
+	"strings"
+
+	"gvisor.dev/gvisor/pkg/abi/linux"
+	"gvisor.dev/gvisor/pkg/context"
+	"gvisor.dev/gvisor/pkg/errors/linuxerr"
+	"gvisor.dev/gvisor/pkg/log"
+	"gvisor.dev/gvisor/pkg/sentry/fsimpl/kernfs"
+	"gvisor.dev/gvisor/pkg/sentry/kernel"
+	"gvisor.dev/gvisor/pkg/sentry/kernel/auth"
+	"gvisor.dev/gvisor/pkg/sentry/vfs"
+	"gvisor.dev/gvisor/pkg/sync"
+	"gvisor.dev/gvisor/pkg/usermem"
+)
+
+// profileMutexFraction is the mutex profile fraction used while a mutex
+// profile is collected through /proc/gvisor/profile, as for
+// control.DefaultMutexProfileRate.
+const profileMutexFraction = 10
+
+// profileMutexUsers counts the open files of /proc/gvisor/profile that are
+// collecting a mutex profile. Profiles may overlap, so the mutex profile
+// fraction is set when the first one starts, and restored when the last one
+// stops.
+var profileMutexUsers struct {
+	mu sync.Mutex
+
+	// count is the number of mutex profiles being collected. It is
+	// protected by mu.
+	count int
+
+	// prevFraction is the mutex profile fraction to restore when count
+	// drops to 0. It is protected by mu.
+	prevFraction int
+}
+
+// startMutexProfile enables mutex profiling, if no other mutex profile is
+// being collected.
+func startMutexProfile() {
+	profileMutexUsers.mu.Lock()
+	defer profileMutexUsers.mu.Unlock()
+	if profileMutexUsers.count == 0 {
+		profileMutexUsers.prevFraction = runtime.SetMutexProfileFraction(profileMutexFraction)
+	}
+	profileMutexUsers.count++
+}
+
+// stopMutexProfile restores the mutex profile fraction from before the first
+// of the mutex profiles being collected started, if this stops the last one.
+func stopMutexProfile() {
+	profileMutexUsers.mu.Lock()
+	defer profileMutexUsers.mu.Unlock()
+	profileMutexUsers.count--
+	if profileMutexUsers.count == 0 {
+		runtime.SetMutexProfileFraction(profileMutexUsers.prevFraction)
+	}
+}
+
+// profileInode implements kernfs.Inode for /proc/gvisor/profile, which lets
+// the application collect profiles of the sentry around the code it is
+// interested in, e.g. the measured region of a benchmark.
+//
+// Each open file collects one profile: writing "cpu" or "mutex" starts it, and
+// the first read stops it and returns the profile in pprof format. Only one
+// CPU profile can be collected at a time in the sandbox, including one
+// requested with runsc debug --profile-cpu. Mutex profiles are cumulative
+// from the first time mutex profiling was enabled, so the profile of a region
+// should be compared with one taken just before it, with
+// go tool pprof -diff_base.
+//
+// +stateify savable
+type profileInode struct {
+	// This uses fdInfoDirInodeRefs for the same reason as checkpointInode.
+	kernfs.InodeAttrs
+	kernfs.InodeNoStatFS
+	fdInfoDirInodeRefs
+	kernfs.InodeTemporary
+	kernfs.InodeNotAnonymous
+	kernfs.InodeNotDirectory
+	kernfs.InodeNotSymlink
+	kernfs.InodeWatches
+	kernfs.InodeFSOwned
+	locks vfs.FileLocks
+
+	k         *kernel.Kernel
+	rdevMajor uint32
+}
+
+func newProfileInode(ctx context.Context, k *kernel.Kernel, creds *auth.Credentials, devMajor, devMinor uint32, ino uint64) *profileInode {
+	rdevMajor, err := k.VFS().GetDynamicCharDevMajor()
+	if err != nil {
+		panic(fmt.Sprintf("failed to allocate device number for /proc/gvisor/profile: %v", err))
+	}
+	i := &profileInode{
+		k:         k,
+		rdevMajor: rdevMajor,
+	}
+	i.fdInfoDirInodeRefs.InitRefs()
+	// Appear to be a character device so that applications don't carelessly
+	// try to read from us.
+	i.InodeAttrs.Init(ctx, creds, devMajor, devMinor, ino, linux.ModeCharacterDevice|0o666)
+	return i
+}
+
+// DecRef implements kernfs.Inode.DecRef.
+func (i *profileInode) DecRef(ctx context.Context) {
+	i.fdInfoDirInodeRefs.DecRef(func() {
+		i.k.VFS().PutDynamicCharDevMajor(i.rdevMajor)
+	})
+}
+
+// Stat implements kernfs.Inode.Stat.
+func (i *profileInode) Stat(ctx context.Context, vfsfs *vfs.Filesystem, opts vfs.StatOptions) (linux.Statx, error) {
+	stat, err := i.InodeAttrs.Stat(ctx, vfsfs, opts)
+	stat.RdevMajor = i.rdevMajor
+	stat.RdevMinor = 0
+	return stat, err
+}
+
+// Open implements kernfs.Inode.Open.
+func (i *profileInode) Open(ctx context.Context, rp *vfs.ResolvingPath, d *kernfs.Dentry, opts vfs.OpenOptions) (*vfs.FileDescription, error) {
+	f := &profileFile{}
+	f.vfsfd.Init(f, opts.Flags, rp.Credentials(), rp.Mount(), d.VFSDentry(), &vfs.FileDescriptionOptions{
+		DenyPRead:         true,
+		DenyPWrite:        true,
+		UseDentryMetadata: true,
+	})
+	return &f.vfsfd, nil
+}
+
+// Possible values of profileFile.kind.
+const (
+	profileNone  = ""
+	profileCPU   = "cpu"
+	profileMutex = "mutex"
+)
+
+// profileFile implements vfs.FileDescriptionImpl for /proc/gvisor/profile.
+//
+// Profiles are collected by the Go runtime of the sentry, so an in-progress
+// profile doesn't survive save/restore, and reads after restore return EOF.
+//
+// +stateify savable
+type profileFile struct {
+	vfsfd vfs.FileDescription
+	vfs.FileDescriptionDefaultImpl
+	vfs.DentryMetadataFileDescriptionImpl
+	vfs.NoLockFD
+
+	mu sync.Mutex `state:"nosave"`
+
+	// kind is the kind of profile being collected, or profileNone if none
+	// has been started. It is protected by mu.
+	kind string `state:"nosave"`
+
+	// running is true while the profile is being collected. It is protected
+	// by mu.
+	running bool `state:"nosave"`
+
+	// buf holds the profile once it is stopped. It is protected by mu.
+	buf bytes.Buffer `state:"nosave"`
+
+	// off is the file offset. It is protected by mu.
+	off int64 `state:"nosave"`
+}
+
+// Release implements vfs.FileDescriptionImpl.Release.
+func (f *profileFile) Release(context.Context) {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	f.stopLocked()
+}
+
+// Write implements vfs.FileDescriptionImpl.Write.
+func (f *profileFile) Write(ctx context.Context, src usermem.IOSequence, opts vfs.WriteOptions) (int64, error) {
+	const maxLen = len(profileMutex) + 1
+	if src.NumBytes() > int64(maxLen) {
+		return 0, linuxerr.EINVAL
+	}
+	if src.NumBytes() == 0 {
+		return 0, nil
+	}
+
+	var buf [maxLen]byte
+	n, err := src.CopyIn(ctx, buf[:])
+	if err != nil {
+		return 0, err
+	}
+	// Accept new line at the end to allow `echo cpu` for convenience.
+	kind := strings.TrimSuffix(string(buf[:n]), "\n")
+	if kind != profileCPU && kind != profileMutex {
+		return 0, linuxerr.EINVAL
+	}
+
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	if f.kind != profileNone {
+		return 0, linuxerr.EBUSY
+	}
+	switch kind {
+	case profileCPU:
+		// Fails if a CPU profile is already being collected.
+		if err := pprof.StartCPUProfile(&f.buf); err != nil {
+			return 0, linuxerr.EBUSY
+		}
+	case profileMutex:
+		startMutexProfile()
+	}
+	log.Infof("%s profile started by user", kind)
+	f.kind = kind
+	f.running = true
+	return int64(n), nil
+}
+
+// stopLocked stops the profile, if it is running.
+//
+// Preconditions: f.mu must be locked.
+func (f *profileFile) stopLocked() {
+	if !f.running {
+		return
+	}
+	f.running = false
+	switch f.kind {
+	case profileCPU:
+		pprof.StopCPUProfile()
+	case profileMutex:
+		if err := pprof.Lookup("mutex").WriteTo(&f.buf, 0); err != nil {
+			log.Warningf("Failed to write mutex profile: %v", err)
+		}
+		stopMutexProfile()
+	}
+	log.Infof("%s profile stopped by user", f.kind)
+}
+
+// Read implements vfs.FileDescriptionImpl.Read.
+func (f *profileFile) Read(ctx context.Context, dst usermem.IOSequence, opts vfs.ReadOptions) (int64, error) {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	f.stopLocked()
+
+	data := f.buf.Bytes()
+	if f.off >= int64(len(data)) {
+		return 0, io.EOF
+	}
+	n, err := dst.CopyOut(ctx, data[f.off:])
+	f.off += int64(n)
+	return int64(n), err
+}
@@ -48,6 +48,28 @@ func MaxPossibleCPU() (uint32, error) {
 	return uint32(i), nil
 }
 
+// MaxPossibleNode returns the highest possible NUMA node number, which is
+// guaranteed not to change for the lifetime of the host kernel. It returns 0
+// if the host kernel was built without NUMA support.
+func MaxPossibleNode() (uint32, error) {
+	const path = "/sys/devices/system/node/possible"
+	data, err := os.ReadFile(path)
+	if os.IsNotExist(err) {
+		return 0, nil
+	}
+	if err != nil {
+		return 0, err
+	}
+	str := string(data)
+	// Linux: drivers/base/node.c:show_node_state() =>
+	// lib/bitmap.c:bitmap_print_to_pagebuf()
+	i, err := maxValueInLinuxBitmap(str)
+	if err != nil {
+		return 0, fmt.Errorf("invalid %s (%q): %v", path, str, err)
+	}
+	return uint32(i), nil
+}
+
 // maxValueInLinuxBitmap returns the maximum value specified in str, which is a
 // string emitted by Linux's lib/bitmap.c:bitmap_print_to_pagebuf(list=true).
 func maxValueInLinuxBitmap(str string) (uint64, error) {
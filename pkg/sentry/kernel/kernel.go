@@ -570,6 +570,9 @@ func (k *Kernel) Init(args InitKernelArgs) error {
 	k.extraAuxv = args.ExtraAuxv
 	k.vdso = args.Vdso
 	k.vdsoParams = args.VdsoParams
+	if k.vdsoParams != nil {
+		k.initVDSOParams()
+	}
 	k.futexes = futex.NewManager()
 	k.netlinkPorts = port.New()
 	k.ptraceExceptions = make(map[*Task]*Task)
@@ -663,6 +666,7 @@ func (k *Kernel) Init(args InitKernelArgs) error {
 	k.rootCgroupNamespace.SetInode(nsfs.NewInode(ctx, k.nsfsMount, k.rootCgroupNamespace))
 
 	k.MaxKeySetSize = atomicbitops.FromInt32(auth.MaxSetSize)
+	registerSyscallAnswerKernel(k)
 	return nil
 }
 
@@ -1001,6 +1005,9 @@ func (k *Kernel) LoadFrom(ctx context.Context, r io.Reader, asyncMFLoader *Async
 		timeline.Reached("Main MemoryFile loading started")
 	}
 
+	// The VDSO modes depend on the platform and host, which may differ from
+	// the ones that were saved.
+	k.initVDSOParams()
 	k.Timekeeper().SetClocks(clocks, k.vdsoParams)
 
 	if timeReady != nil {
@@ -1037,6 +1044,7 @@ func (k *Kernel) LoadFrom(ctx context.Context, r io.Reader, asyncMFLoader *Async
 		return fmt.Errorf("UseHostCores enabled: can't increase ApplicationCores from %d to %d after restore", k.applicationCores, initAppCores)
 	}
 
+	registerSyscallAnswerKernel(k)
 	return nil
 }
 
@@ -1906,6 +1914,11 @@ func (k *Kernel) MonotonicClock() ktime.SampledClock {
 	return k.timekeeper.monotonicClock
 }
 
+// TAIClock returns the application CLOCK_TAI clock.
+func (k *Kernel) TAIClock() ktime.SampledClock {
+	return k.timekeeper.taiClock
+}
+
 // Syslog returns the syslog.
 func (k *Kernel) Syslog() *syslog {
 	return &k.syslog
@@ -2241,6 +2254,7 @@ func (k *Kernel) releaseCgroupMounts(ctx context.Context) {
 // Precondition: This should only be called after the kernel is fully
 // initialized, e.g. after k.Start() has been called.
 func (k *Kernel) Release() {
+	unregisterSyscallAnswerKernel(k)
 	ctx := k.SupervisorContext()
 	k.releaseCgroupMounts(ctx)
 	k.hostMount.DecRef(ctx)
@@ -20,6 +20,7 @@ import (
 	"gvisor.dev/gvisor/pkg/abi/linux"
 	"gvisor.dev/gvisor/pkg/errors/linuxerr"
 	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/metric"
 	"gvisor.dev/gvisor/pkg/usermem"
 )
 
@@ -34,6 +35,30 @@ import (
 // to as "old rseq". This interface was never merged upstream, but is supported
 // for a limited set of applications that use it regardless.
 
+// Field values for the rseq_aborts metric, by what caused the abort.
+var (
+	// rseqAbortPreempt is a preemption that left the task on the same CPU.
+	rseqAbortPreempt = metric.FieldValue{"preempt"}
+
+	// rseqAbortMigration is a preemption after which the task runs on a
+	// different CPU.
+	rseqAbortMigration = metric.FieldValue{"migration"}
+
+	// rseqAbortSignal is the delivery of a signal to an application handler.
+	rseqAbortSignal = metric.FieldValue{"signal"}
+)
+
+// rseqAbortCounter counts the critical sections, old or new, that the sentry
+// restarted.
+var rseqAbortCounter = metric.MustCreateNewUint64Metric(
+	"/task/rseq_aborts", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "The number of restartable sequence critical sections that were aborted, by cause.",
+		Fields: []metric.Field{
+			metric.NewField("cause", &rseqAbortPreempt, &rseqAbortMigration, &rseqAbortSignal),
+		},
+	})
+
 // OldRSeqCriticalRegion describes an old rseq critical region.
 //
 // +stateify savable
@@ -261,6 +286,7 @@ func (t *Task) rseqClearCPU() error {
 }
 
 // rseqAddrInterrupt checks if IP is in a critical section, and aborts if so.
+// It returns true if the critical section was aborted.
 //
 // This is a bit complex since both the RSeq and RSeqCriticalSection structs
 // are stored in userspace. So we must:
@@ -279,9 +305,9 @@ func (t *Task) rseqClearCPU() error {
 // Preconditions:
 //   - The caller must be running on the task goroutine.
 //   - t's AddressSpace must be active.
-func (t *Task) rseqAddrInterrupt() {
+func (t *Task) rseqAddrInterrupt() bool {
 	if t.rseqAddr == 0 {
-		return
+		return false
 	}
 
 	critAddrAddr, ok := t.rseqAddr.AddLength(linux.OffsetOfRSeqCriticalSection)
@@ -295,7 +321,7 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Only 64-bit rseq supported.")
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	buf := t.CopyScratchBuffer(8)
@@ -303,12 +329,12 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Failed to copy critical section address from %#x for rseq: %v", critAddrAddr, err)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	critAddr := hostarch.Addr(hostarch.ByteOrder.Uint64(buf))
 	if critAddr == 0 {
-		return
+		return false
 	}
 
 	var cs linux.RSeqCriticalSection
@@ -316,14 +342,14 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Failed to copy critical section from %#x for rseq: %v", critAddr, err)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	if cs.Version != 0 {
 		t.Debugf("Unknown version in %+v", cs)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	start := hostarch.Addr(cs.Start)
@@ -332,7 +358,7 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Invalid start and offset in %+v", cs)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	abort := hostarch.Addr(cs.Abort)
@@ -340,7 +366,7 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Abort in critical section in %+v", cs)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	// Verify signature.
@@ -351,7 +377,7 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Failed to copy critical section signature from %#x for rseq: %v", sigAddr, err)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	sig := hostarch.ByteOrder.Uint32(buf)
@@ -359,7 +385,7 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Mismatched rseq signature %d != %d", sig, t.rseqSignature)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	// Clear the critical section address.
@@ -371,29 +397,42 @@ func (t *Task) rseqAddrInterrupt() {
 		t.Debugf("Failed to clear critical section address from %#x for rseq: %v", critAddrAddr, err)
 		t.forceSignal(linux.SIGSEGV, false /* unconditional */)
 		t.SendSignal(SignalInfoPriv(linux.SIGSEGV))
-		return
+		return false
 	}
 
 	// Finally we can actually decide whether or not to restart.
 	if !critRange.Contains(hostarch.Addr(t.Arch().IP())) {
-		return
+		return false
 	}
 
 	t.Arch().SetIP(uintptr(cs.Abort))
+	return true
 }
 
+// oldRSeqInterrupt returns true if the old rseq critical section was aborted.
+//
 // Preconditions: The caller must be running on the task goroutine.
-func (t *Task) oldRSeqInterrupt() {
+func (t *Task) oldRSeqInterrupt() bool {
 	r := t.tg.oldRSeqCritical.Load()
 	if ip := t.Arch().IP(); r.CriticalSection.Contains(hostarch.Addr(ip)) {
 		t.Debugf("Interrupted rseq critical section at %#x; restarting at %#x", ip, r.Restart)
 		t.Arch().SetIP(uintptr(r.Restart))
 		t.Arch().SetOldRSeqInterruptedIP(ip)
+		return true
 	}
+	return false
 }
 
+// rseqInterrupt aborts critical sections that IP is in. cause is the
+// rseq_aborts metric field value that aborts are counted under.
+//
 // Preconditions: The caller must be running on the task goroutine.
-func (t *Task) rseqInterrupt() {
-	t.rseqAddrInterrupt()
-	t.oldRSeqInterrupt()
+func (t *Task) rseqInterrupt(cause *metric.FieldValue) {
+	aborted := t.rseqAddrInterrupt()
+	if t.oldRSeqInterrupt() {
+		aborted = true
+	}
+	if aborted {
+		rseqAbortCounter.Increment(cause)
+	}
 }
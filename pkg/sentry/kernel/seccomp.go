@@ -307,6 +307,9 @@ func (t *Task) AppendSyscallFilter(p bpf.Program, syncAll bool) error {
 				seccompCopy := newSeccomp.copy()
 				seccompCopy.populateCache(ot)
 				ot.seccomp.Store(seccompCopy)
+				// ot may be running application code, with syscall
+				// answers that skip the new filter.
+				ot.invalidateSyscallAnswers()
 			}
 		}
 	}
@@ -161,6 +161,8 @@ func (e *SyscallFlagsTable) init(table map[uintptr]Syscall) {
 //
 // It is called when per-syscall seccheck event enablement changes.
 func (e *SyscallFlagsTable) UpdateSecCheck(state *seccheck.State) {
+	// Runs after e.mu is unlocked.
+	defer invalidateSyscallAnswers()
 	e.mu.Lock()
 	defer e.mu.Unlock()
 	for sysno := uintptr(0); sysno <= sentry.MaxSyscallNum; sysno++ {
@@ -195,6 +197,47 @@ func (e *SyscallFlagsTable) UpdateSecCheck(state *seccheck.State) {
 	}
 }
 
+// syscallAnswerKernels are the kernels whose tasks are interrupted when the
+// enable bits of a SyscallFlagsTable change, so that none of them keeps using
+// syscall answers computed under the old bits. See Task.syscallAnswers.
+var syscallAnswerKernels struct {
+	mu      sync.Mutex
+	kernels map[*Kernel]struct{}
+}
+
+// registerSyscallAnswerKernel adds k to syscallAnswerKernels.
+func registerSyscallAnswerKernel(k *Kernel) {
+	syscallAnswerKernels.mu.Lock()
+	defer syscallAnswerKernels.mu.Unlock()
+	if syscallAnswerKernels.kernels == nil {
+		syscallAnswerKernels.kernels = make(map[*Kernel]struct{})
+	}
+	syscallAnswerKernels.kernels[k] = struct{}{}
+}
+
+// unregisterSyscallAnswerKernel removes k from syscallAnswerKernels.
+func unregisterSyscallAnswerKernel(k *Kernel) {
+	syscallAnswerKernels.mu.Lock()
+	defer syscallAnswerKernels.mu.Unlock()
+	delete(syscallAnswerKernels.kernels, k)
+}
+
+// invalidateSyscallAnswers invalidates the syscall answers of all tasks of all
+// registered kernels.
+func invalidateSyscallAnswers() {
+	syscallAnswerKernels.mu.Lock()
+	defer syscallAnswerKernels.mu.Unlock()
+	for k := range syscallAnswerKernels.kernels {
+		k.tasks.mu.RLock()
+		k.tasks.forEachTaskLocked(func(t *Task) {
+			if t.exitStateLocked() == TaskExitNone {
+				t.invalidateSyscallAnswers()
+			}
+		})
+		k.tasks.mu.RUnlock()
+	}
+}
+
 // Word returns the enable bitfield for sysno.
 func (e *SyscallFlagsTable) Word(sysno uintptr) uint32 {
 	if sysno <= sentry.MaxSyscallNum {
@@ -213,6 +256,8 @@ func (e *SyscallFlagsTable) Word(sysno uintptr) uint32 {
 // Callers to Word may see either the old or new value while this function
 // is executing.
 func (e *SyscallFlagsTable) Enable(bit uint32, s map[uintptr]bool, missingEnable bool) {
+	// Runs after e.mu is unlocked.
+	defer invalidateSyscallAnswers()
 	e.mu.Lock()
 	defer e.mu.Unlock()
 
@@ -243,6 +288,8 @@ func (e *SyscallFlagsTable) Enable(bit uint32, s map[uintptr]bool, missingEnable
 
 // EnableAll sets enable bit bit for all syscalls, present and missing.
 func (e *SyscallFlagsTable) EnableAll(bit uint32) {
+	// Runs after e.mu is unlocked.
+	defer invalidateSyscallAnswers()
 	e.mu.Lock()
 	defer e.mu.Unlock()
 
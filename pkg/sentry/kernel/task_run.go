@@ -195,8 +195,13 @@ func (app *runApp) execute(t *Task) taskRunState {
 	// Apply restartable sequences.
 	if t.rseqPreempted {
 		t.rseqPreempted = false
+		cause := &rseqAbortPreempt
 		if t.rseqAddr != 0 || t.oldRSeqCPUAddr != 0 {
-			t.rseqCPU = t.CPU()
+			cpu := t.CPU()
+			if t.rseqCPU >= 0 && cpu != t.rseqCPU {
+				cause = &rseqAbortMigration
+			}
+			t.rseqCPU = cpu
 			if err := t.rseqCopyOutCPU(); err != nil {
 				t.Debugf("Failed to copy CPU to %#x for rseq: %v", t.rseqAddr, err)
 				t.forceSignal(linux.SIGSEGV, false)
@@ -212,7 +217,7 @@ func (app *runApp) execute(t *Task) taskRunState {
 				return (*runApp)(nil)
 			}
 		}
-		t.rseqInterrupt()
+		t.rseqInterrupt(cause)
 	}
 
 	// Check if we need to enable single-stepping. Tracers expect that the
@@ -236,6 +241,11 @@ func (app *runApp) execute(t *Task) taskRunState {
 		t.tg.pidns.owner.mu.RUnlock()
 	}
 
+	if c, ok := t.p.(platform.SyscallAnswerCache); ok {
+		a := t.syscallAnswers()
+		c.SetSyscallAnswers(&a)
+	}
+
 	region := trace.StartRegion(t.traceContext, runRegion)
 	t.accountTaskGoroutineEnter(TaskGoroutineRunningApp)
 	info, at, err := t.p.Switch(t, t.MemoryManager(), t.Arch(), t.rseqCPU)
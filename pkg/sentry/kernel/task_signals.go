@@ -235,7 +235,7 @@ func (t *Task) deliverSignal(info *linux.SignalInfo, act linux.SigAction) taskRu
 func (t *Task) deliverSignalToHandler(info *linux.SignalInfo, act linux.SigAction) error {
 	// Signal delivery to an application handler interrupts restartable
 	// sequences.
-	t.rseqInterrupt()
+	t.rseqInterrupt(&rseqAbortSignal)
 
 	// Are executing on the main stack,
 	// or the provided alternate stack?
@@ -315,7 +315,12 @@ func (t *Task) SignalReturn(rt bool) (*SyscallControl, error) {
 	t.SetSignalStack(alt)
 
 	// Restore our signal mask. SIGKILL and SIGSTOP should not be blocked.
-	t.SetSignalMask(sigset &^ UnblockableSignals)
+	// Handlers that run with their own signal unblocked (SA_NODEFER) and an
+	// empty sa_mask return to the mask they ran with, in which case there is
+	// nothing for SetSignalMask to do and the signal mutex can be skipped.
+	if mask := sigset &^ UnblockableSignals; mask != t.SignalMask() {
+		t.SetSignalMask(mask)
+	}
 	t.p.FullStateChanged()
 
 	return ctrlResume, nil
@@ -20,6 +20,7 @@ import (
 	"runtime/trace"
 
 	"golang.org/x/sys/unix"
+	"gvisor.dev/gvisor/pkg/abi"
 	"gvisor.dev/gvisor/pkg/abi/linux"
 	"gvisor.dev/gvisor/pkg/bits"
 	"gvisor.dev/gvisor/pkg/errors"
@@ -29,6 +30,7 @@ import (
 	"gvisor.dev/gvisor/pkg/metric"
 	"gvisor.dev/gvisor/pkg/sentry/arch"
 	"gvisor.dev/gvisor/pkg/sentry/memmap"
+	"gvisor.dev/gvisor/pkg/sentry/mm"
 	"gvisor.dev/gvisor/pkg/sentry/platform"
 	"gvisor.dev/gvisor/pkg/sentry/seccheck"
 	pb "gvisor.dev/gvisor/pkg/sentry/seccheck/points/points_go_proto"
@@ -140,7 +142,12 @@ func (t *Task) executeSyscall(sysno uintptr, args arch.SyscallArguments) (rval u
 		}
 		if fn != nil {
 			// Call our syscall implementation.
+			m := t.MemoryManager()
+			vdsoAddr := m.VDSOAddr()
 			rval, ctrl, err = fn(t, sysno, args)
+			if m.VDSOAddr() != vdsoAddr {
+				t.invalidateVDSOUsers(m)
+			}
 		} else {
 			// Use the missing function if not found.
 			rval, err = t.SyscallTable().Missing(t, sysno, args)
@@ -258,6 +265,81 @@ func (t *Task) doSyscall() taskRunState {
 	return t.doSyscallEnter(sysno, args)
 }
 
+// answeredSyscalls are the syscalls that platform.SyscallAnswers answers.
+var answeredSyscalls = [...]uintptr{
+	unix.SYS_GETPID,
+	unix.SYS_GETTID,
+	unix.SYS_GETUID,
+	unix.SYS_GETEUID,
+	unix.SYS_GETGID,
+	unix.SYS_GETEGID,
+}
+
+// syscallAnswers returns the answers that the platform may give to t's next
+// identity syscalls without calling into the Sentry, and the VDSO functions
+// that it may run for t's vsyscalls.
+//
+// The answers are not valid if anything needs to observe the syscalls: ptrace,
+// seccomp filters, strace, seccheck or an external handler. The identity of a
+// task is only changed by the task itself, but seccomp filters (with
+// SECCOMP_FILTER_FLAG_TSYNC) and the syscall table's enable bits are changed
+// from other goroutines while the task runs application code, so these call
+// invalidateSyscallAnswers to make the task compute its answers again.
+//
+// Preconditions: The caller must be running on the task goroutine.
+func (t *Task) syscallAnswers() platform.SyscallAnswers {
+	if t.hasTracer() || t.seccomp.Load() != nil {
+		return platform.SyscallAnswers{}
+	}
+	s := t.SyscallTable()
+	if s.OS != abi.Linux {
+		return platform.SyscallAnswers{}
+	}
+	for _, sysno := range answeredSyscalls {
+		if s.FeatureEnable.Word(sysno) != 0 {
+			return platform.SyscallAnswers{}
+		}
+	}
+	c := t.Credentials()
+	return platform.SyscallAnswers{
+		Valid:           true,
+		Pid:             int32(t.tg.ID()),
+		Tid:             int32(t.ThreadID()),
+		UID:             uint32(c.RealKUID.In(c.UserNamespace).OrOverflow()),
+		EUID:            uint32(c.EffectiveKUID.In(c.UserNamespace).OrOverflow()),
+		GID:             uint32(c.RealKGID.In(c.UserNamespace).OrOverflow()),
+		EGID:            uint32(c.EffectiveKGID.In(c.UserNamespace).OrOverflow()),
+		VsyscallTargets: t.vsyscallTargets(s),
+	}
+}
+
+// invalidateSyscallAnswers makes t stop using the answers last returned by
+// syscallAnswers, by interrupting it if it is running application code. The
+// task goroutine then gets new answers before switching back to application
+// code.
+//
+// Unlike interrupt, it doesn't interrupt blocking syscalls of t.
+func (t *Task) invalidateSyscallAnswers() {
+	if _, ok := t.p.(platform.SyscallAnswerCache); ok {
+		t.p.Interrupt()
+	}
+}
+
+// invalidateVDSOUsers invalidates the syscall answers of all other tasks using
+// m, after the VDSO was unmapped or moved: their vsyscalls may be redirected to
+// VDSO functions at its old address.
+func (t *Task) invalidateVDSOUsers(m *mm.MemoryManager) {
+	t.k.tasks.mu.RLock()
+	defer t.k.tasks.mu.RUnlock()
+	t.k.tasks.forEachTaskLocked(func(ot *Task) {
+		ot.mu.Lock()
+		defer ot.mu.Unlock()
+		if ot != t && ot.exitStateLocked() == TaskExitNone && ot.MemoryManager() == m {
+			ot.invalidateSyscallAnswers()
+		}
+	})
+}
+
 type runSyscallAfterPtraceEventSeccomp struct{}
 
 func (*runSyscallAfterPtraceEventSeccomp) execute(t *Task) taskRunState {
@@ -59,6 +59,10 @@ type Timekeeper struct {
 	// monotonicClock is a ktime.Clock based on timekeeper's Monotonic.
 	monotonicClock *timekeeperClock
 
+	// taiClock is a ktime.Clock based on timekeeper's Realtime, offset by
+	// taiOffset.
+	taiClock *timekeeperClock
+
 	// bootTime is the realtime when the system "booted". i.e., when
 	// SetClocks was called in the initial (not restored) run.
 	bootTime ktime.Time
@@ -72,6 +76,13 @@ type Timekeeper struct {
 	// monotonicLowerBound is the lowerBound for monotonic time.
 	monotonicLowerBound atomicbitops.Int64 `state:"nosave"`
 
+	// taiOffset is the offset of CLOCK_TAI from CLOCK_REALTIME in
+	// nanoseconds, as last sampled from the host.
+	//
+	// It isn't saved, as the new machine may know about a different number
+	// of leap seconds.
+	taiOffset atomicbitops.Int64 `state:"nosave"`
+
 	// restored, if non-nil, indicates that this Timekeeper was restored
 	// from a state file. The clocks are not set until restored is closed.
 	restored chan struct{} `state:"nosave"`
@@ -131,6 +142,7 @@ func NewTimekeeper() *Timekeeper {
 	t := Timekeeper{}
 	t.realtimeClock = &timekeeperClock{tk: &t, c: sentrytime.Realtime}
 	t.monotonicClock = &timekeeperClock{tk: &t, c: sentrytime.Monotonic}
+	t.taiClock = &timekeeperClock{tk: &t, c: sentrytime.Realtime, tai: true}
 	return &t
 }
 
@@ -190,6 +202,7 @@ func (t *Timekeeper) SetClocks(c sentrytime.Clocks, params *VDSOParamPage) {
 	}
 
 	t.monotonicOffset = wantMonotonic - nowMonotonic
+	t.taiOffset.Store(sentrytime.HostTAIOffset())
 
 	if t.restored == nil {
 		// Hold on to the initial "boot" time.
@@ -210,6 +223,11 @@ func (t *Timekeeper) SetClocks(c sentrytime.Clocks, params *VDSOParamPage) {
 //
 // Preconditions: updateMu must be held
 func (t *Timekeeper) update(parked bool) {
+	// The host's TAI offset only changes when NTP announces a leap second,
+	// so sampling it once per update is more than often enough.
+	taiOffset := sentrytime.HostTAIOffset()
+	t.taiOffset.Store(taiOffset)
+
 	// Call Update within a Write block to prevent the VDSO from using the old
 	// params between Update and Write.
 	if err := t.params.Write(func() vdsoParams {
@@ -221,13 +239,18 @@ func (t *Timekeeper) update(parked bool) {
 			p.monotonicBaseCycles = int64(monotonicParams.BaseCycles)
 			p.monotonicBaseRef = int64(monotonicParams.BaseRef) + t.monotonicOffset
 			p.monotonicFrequency = monotonicParams.Frequency
+			p.monotonicMult = vdsoMult(monotonicParams.Frequency)
+			p.monotonicShift = vdsoMultShift
 		}
 		if realtimeOk {
 			p.realtimeReady = 1
 			p.realtimeBaseCycles = int64(realtimeParams.BaseCycles)
 			p.realtimeBaseRef = int64(realtimeParams.BaseRef)
 			p.realtimeFrequency = realtimeParams.Frequency
+			p.realtimeMult = vdsoMult(realtimeParams.Frequency)
+			p.realtimeShift = vdsoMultShift
 		}
+		p.taiOffset = taiOffset
 		return p
 	}); err != nil {
 		log.Warningf("Unable to update VDSO parameter page: %v", err)
@@ -438,6 +461,10 @@ type timekeeperClock struct {
 	tk *Timekeeper
 	c  sentrytime.ClockID
 
+	// tai is true if this is CLOCK_TAI, which is c (Realtime) offset by
+	// tk.taiOffset.
+	tai bool
+
 	// Implements ktime.SampledClock.WallTimeUntil.
 	ktime.WallRateClock `state:"nosave"`
 
@@ -452,6 +479,9 @@ func (tc *timekeeperClock) Now() ktime.Time {
 	if err != nil {
 		panic(fmt.Sprintf("timekeeperClock(ClockID=%v)).Now: %v", tc.c, err))
 	}
+	if tc.tai {
+		now += tc.tk.taiOffset.Load()
+	}
 	return ktime.FromNanoseconds(now)
 }
 
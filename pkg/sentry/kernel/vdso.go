@@ -16,9 +16,13 @@ package kernel
 
 import (
 	"context"
+	"encoding/binary"
 	"fmt"
+	"time"
 
+	"gvisor.dev/gvisor/pkg/atomicbitops"
 	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/rand"
 	"gvisor.dev/gvisor/pkg/safemem"
 	"gvisor.dev/gvisor/pkg/sentry/memmap"
 	"gvisor.dev/gvisor/pkg/sentry/pgalloc"
@@ -35,11 +39,84 @@ type vdsoParams struct {
 	monotonicBaseCycles int64
 	monotonicBaseRef    int64
 	monotonicFrequency  uint64
+	monotonicMult       uint64
+	monotonicShift      uint64
 
 	realtimeReady      uint64
 	realtimeBaseCycles int64
 	realtimeBaseRef    int64
 	realtimeFrequency  uint64
+	realtimeMult       uint64
+	realtimeShift      uint64
+
+	getcpuMode     uint64
+	cycleClockMode uint64
+
+	// taiOffset is the offset of CLOCK_TAI from CLOCK_REALTIME in
+	// nanoseconds. It is only meaningful if realtimeReady is set.
+	taiOffset int64
+
+	// rngGeneration changes whenever the VDSO's getrandom states must fetch a
+	// new key from the sentry before generating more bytes. If it is 0, the
+	// VDSO's getrandom must make a system call.
+	rngGeneration uint64
+}
+
+// vdsoMultShift is the shift published in vdsoParams.*Shift. The VDSO converts
+// elapsed cycles to nanoseconds as (cycles * mult) >> shift, computing the
+// product with 128-bit precision.
+const vdsoMultShift = 32
+
+// vdsoMult returns the multiplier published in vdsoParams.*Mult for a clock
+// with the given frequency, in cycles per second.
+//
+// Precondition: frequency != 0.
+func vdsoMult(frequency uint64) uint64 {
+	return (uint64(1e9) << vdsoMultShift) / frequency
+}
+
+// Values of vdsoParams.getcpuMode.
+//
+// These must be kept in sync with kGetcpu* in vdso/params.h.
+const (
+	// vdsoGetcpuSyscall indicates that the VDSO must make a system call to
+	// implement getcpu(2).
+	vdsoGetcpuSyscall = 0
+
+	// vdsoGetcpuSingleCPU indicates that every task runs on CPU 0.
+	vdsoGetcpuSingleCPU = 1
+
+	// vdsoGetcpuTSCAux indicates that IA32_TSC_AUX holds the CPU number
+	// returned by Task.CPU, so the VDSO can read it with rdtscp.
+	vdsoGetcpuTSCAux = 2
+)
+
+// vdsoRNGReseedInterval is the interval at which the VDSO's getrandom states
+// are reseeded, as for the Linux kernel's CRNG.
+const vdsoRNGReseedInterval = time.Minute
+
+// initVDSOParams sets the parts of the VDSO parameter page that are fixed for
+// the lifetime of k on this host.
+func (k *Kernel) initVDSOParams() {
+	k.vdsoParams.SetGetcpuMode(k.vdsoGetcpuMode())
+	k.vdsoParams.SetCycleClockMode(vdsoCycleClockMode())
+	// A restored sandbox must not generate the same bytes as the one that was
+	// saved, or as any other sandbox restored from the same image.
+	k.vdsoParams.ReseedRNG()
+}
+
+// vdsoGetcpuMode returns the vdsoGetcpu* mode under which the VDSO returns the
+// same CPU number as Task.CPU for every task in k.
+func (k *Kernel) vdsoGetcpuMode() uint64 {
+	switch {
+	case k.HasTSCAuxCPUNumbers():
+		return vdsoGetcpuTSCAux
+	case !k.useHostCores && !k.HasCPUNumbers() && k.applicationCores == 1:
+		// assignCPU can only pick CPU 0.
+		return vdsoGetcpuSingleCPU
+	default:
+		return vdsoGetcpuSyscall
+	}
 }
 
 // VDSOParamPage manages a VDSO parameter page.
@@ -49,12 +126,17 @@ type vdsoParams struct {
 //	type page struct {
 //		// seq is a sequence counter that protects the fields below.
 //		seq uint64
-//		vdsoParams
+//		data [2]vdsoParams
 //	}
 //
 // Everything in the struct is 8 bytes for easy alignment.
 //
-// It must be kept in sync with params in vdso/vdso_time.cc.
+// seq is used as a latch, like Linux's seqcount_latch_t: the VDSO reads
+// data[seq&1], and Write updates the other copy of the parameters before
+// incrementing seq to switch the VDSO to it. VDSO readers thus never wait for
+// Write; they only retry a read that straddles one of the increments.
+//
+// It must be kept in sync with params in vdso/params.h.
 //
 // +stateify savable
 type VDSOParamPage struct {
@@ -64,7 +146,8 @@ type VDSOParamPage struct {
 
 	// seq is the current sequence count written to the page.
 	//
-	// A write is in progress if bit 1 of the counter is set.
+	// A write is in progress if the counter is odd, in which case the VDSO
+	// reads data[1], in which no clock is ready.
 	//
 	// Timekeeper's updater goroutine may call Write before equality is
 	// checked in state_test_util tests, causing this field to change across
@@ -77,6 +160,20 @@ type VDSOParamPage struct {
 	// the sentry, so reusing this buffer is a good tradeoff between memory
 	// usage and the cost of allocation.
 	copyScratchBuffer []byte
+
+	// getcpuMode and cycleClockMode are the vdsoGetcpu* and vdsoCycleClock*
+	// modes written to every update of the page. They depend on the
+	// platform and host, so they are recomputed by the Kernel after restore.
+	getcpuMode     atomicbitops.Uint64 `state:"nosave"`
+	cycleClockMode atomicbitops.Uint64 `state:"nosave"`
+
+	// rngGeneration is the vdsoParams.rngGeneration written to every update
+	// of the page. It is 0 until ReseedRNG is called.
+	rngGeneration atomicbitops.Uint64 `state:"nosave"`
+
+	// rngReseedTime is when ReseedRNG last changed rngGeneration. It is only
+	// accessed by ReseedRNG and Write.
+	rngReseedTime time.Time `state:"nosave"`
 }
 
 // afterLoad is invoked by stateify.
@@ -100,6 +197,36 @@ func NewVDSOParamPage(mf *pgalloc.MemoryFile, fr memmap.FileRange) *VDSOParamPag
 	}
 }
 
+// SetGetcpuMode sets the getcpu(2) implementation advertised to the VDSO. It
+// takes effect on the next call to Write.
+func (v *VDSOParamPage) SetGetcpuMode(mode uint64) {
+	v.getcpuMode.Store(mode)
+}
+
+// SetCycleClockMode sets the cycle counter read sequence used by the VDSO. It
+// takes effect on the next call to Write.
+func (v *VDSOParamPage) SetCycleClockMode(mode uint64) {
+	v.cycleClockMode.Store(mode)
+}
+
+// ReseedRNG makes every VDSO getrandom state fetch a new key from the sentry
+// before generating more bytes. It takes effect on the next call to Write.
+func (v *VDSOParamPage) ReseedRNG() {
+	// The generation is random rather than incremented so that it differs
+	// between sandboxes restored from the same image.
+	var b [8]byte
+	for {
+		if _, err := rand.Read(b[:]); err != nil {
+			panic(fmt.Sprintf("rand.Read failed: %v", err))
+		}
+		if gen := binary.LittleEndian.Uint64(b[:]); gen != 0 && gen != v.rngGeneration.Load() {
+			v.rngGeneration.Store(gen)
+			v.rngReseedTime = time.Now()
+			return
+		}
+	}
+}
+
 // access returns a mapping of the param page.
 func (v *VDSOParamPage) access() (safemem.Block, error) {
 	bs, err := v.mf.MapInternal(v.fr, hostarch.ReadWrite)
@@ -130,35 +257,53 @@ func (v *VDSOParamPage) incrementSeq(paramPage safemem.Block) error {
 
 // Write updates the VDSO parameters.
 //
-// Write starts a write block, calls f to get the new parameters, writes
-// out the new parameters, then ends the write block.
+// Write calls f to get the new parameters. f may change the clocks used by
+// the Sentry's own time syscalls, so the VDSO must not use the previous
+// parameters once f starts: before calling f, Write switches the VDSO to a
+// copy of the parameters in which no clock is ready, which makes VDSO clock
+// reads fall back to system calls until the new parameters are published.
 func (v *VDSOParamPage) Write(f func() vdsoParams) error {
 	paramPage, err := v.access()
 	if err != nil {
 		return err
 	}
 
-	// Write begin.
-	next := v.seq + 1
-	if next%2 != 1 {
+	if v.seq%2 != 0 {
 		panic("Out-of-order sequence count")
 	}
 
-	err = v.incrementSeq(paramPage)
-	if err != nil {
+	var stale vdsoParams
+	v.setFixedParams(&stale)
+	if err := v.publish(paramPage, &stale); err != nil {
 		return err
 	}
 
 	// Get the new params.
 	p := f()
+	v.setFixedParams(&p)
+	return v.publish(paramPage, &p)
+}
+
+// setFixedParams sets the fields of p that don't come from Write's f.
+func (v *VDSOParamPage) setFixedParams(p *vdsoParams) {
+	p.getcpuMode = v.getcpuMode.Load()
+	p.cycleClockMode = v.cycleClockMode.Load()
+	if v.rngGeneration.Load() != 0 && time.Since(v.rngReseedTime) >= vdsoRNGReseedInterval {
+		v.ReseedRNG()
+	}
+	p.rngGeneration = v.rngGeneration.Load()
+}
+
+// publish writes p to the copy of the params that the VDSO isn't reading, then
+// switches the VDSO to it. incrementSeq is a full barrier, so the copy is
+// complete before the VDSO switches to it.
+func (v *VDSOParamPage) publish(paramPage safemem.Block, p *vdsoParams) error {
 	buf := v.copyScratchBuffer[:p.SizeBytes()]
 	p.MarshalUnsafe(buf)
-
-	// Skip the sequence counter.
-	if _, err := safemem.Copy(paramPage.DropFirst(8), safemem.BlockFromSafeSlice(buf)); err != nil {
+	// Skip the sequence counter. The VDSO reads data[seq&1].
+	off := 8 + int((v.seq+1)%2)*len(buf)
+	if _, err := safemem.Copy(paramPage.DropFirst(off), safemem.BlockFromSafeSlice(buf)); err != nil {
 		panic(fmt.Sprintf("Unable to get set VDSO parameters: %v", err))
 	}
-
-	// Write end.
 	return v.incrementSeq(paramPage)
 }
@@ -0,0 +1,89 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//go:build amd64
+// +build amd64
+
+package kernel
+
+import (
+	"golang.org/x/sys/unix"
+	"gvisor.dev/gvisor/pkg/cpuid"
+	"gvisor.dev/gvisor/pkg/sentry/loader"
+	"gvisor.dev/gvisor/pkg/sentry/platform"
+)
+
+// Values of vdsoParams.cycleClockMode.
+//
+// These must be kept in sync with kCycleClock* in vdso/params.h.
+const (
+	// vdsoCycleClockLFence orders rdtsc with lfence.
+	vdsoCycleClockLFence = 0
+
+	// vdsoCycleClockMFence orders rdtsc with mfence.
+	vdsoCycleClockMFence = 1
+
+	// vdsoCycleClockRDTSCP reads the cycle counter with rdtscp.
+	vdsoCycleClockRDTSCP = 2
+)
+
+// vdsoCycleClockMode returns the vdsoCycleClock* sequence the VDSO should use
+// on this host.
+//
+// This mirrors the Linux kernel's rdtsc_ordered(): rdtscp is preferred where
+// available, since it orders the counter read against preceding instructions
+// on both Intel and AMD. Otherwise, AMD CPUs may need mfence (lfence is only
+// dispatch serializing there if the host kernel set
+// MSR_F10H_DECFG_LFENCE_SERIALIZE_BIT, which we cannot observe).
+func vdsoCycleClockMode() uint64 {
+	fs := cpuid.HostFeatureSet()
+	switch {
+	case fs.HasFeature(cpuid.X86FeatureRDTSCP):
+		return vdsoCycleClockRDTSCP
+	case fs.AMD():
+		return vdsoCycleClockMFence
+	default:
+		return vdsoCycleClockLFence
+	}
+}
+
+// vsyscallSysnos are the syscalls made by the entries of the vsyscall page, in
+// order.
+var vsyscallSysnos = [platform.Vsyscalls]uintptr{
+	unix.SYS_GETTIMEOFDAY,
+	unix.SYS_TIME,
+	unix.SYS_GETCPU,
+}
+
+// vsyscallTargets returns the VDSO functions that the platform may run for t's
+// vsyscalls instead of calling into the Sentry. See
+// platform.SyscallAnswers.VsyscallTargets.
+//
+// The targets are published with the other syscall answers, so they are
+// invalidated in the same cases: filters synced to t with TSYNC and changes of
+// the enable bits of s interrupt t (see invalidateSyscallAnswers). Since they
+// point into the VDSO, t is also interrupted when another task unmaps or moves
+// it (see invalidateVDSOUsers).
+//
+// Preconditions: The same as for syscallAnswers, and t has no tracer or
+// seccomp filters.
+func (t *Task) vsyscallTargets(s *SyscallTable) [platform.Vsyscalls]uint64 {
+	targets := loader.VsyscallTargets(t.MemoryManager().VDSOAddr())
+	for i, sysno := range vsyscallSysnos {
+		// The syscall must be observed, e.g. by strace.
+		if s.FeatureEnable.Word(sysno) != 0 {
+			targets[i] = 0
+		}
+	}
+	return targets
+}
@@ -0,0 +1,53 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//go:build arm64
+// +build arm64
+
+package kernel
+
+import (
+	"gvisor.dev/gvisor/pkg/cpuid"
+	"gvisor.dev/gvisor/pkg/sentry/platform"
+)
+
+// Values of vdsoParams.cycleClockMode.
+//
+// These must be kept in sync with kCycleClock* in vdso/params.h.
+const (
+	// vdsoCycleClockCNTVCT reads CNTVCT_EL0 without an isb.
+	vdsoCycleClockCNTVCT = 0
+
+	// vdsoCycleClockCNTVCTSS reads CNTVCTSS_EL0, which can't be read
+	// speculatively.
+	vdsoCycleClockCNTVCTSS = 1
+)
+
+// vdsoCycleClockMode returns the vdsoCycleClock* sequence the VDSO should use
+// on this host.
+//
+// Like the Linux kernel's __arch_counter_get_cntvct(), this prefers the
+// self-synchronized counter added by FEAT_ECV, which is ordered against
+// preceding instructions without the cost of an isb.
+func vdsoCycleClockMode() uint64 {
+	if cpuid.HostFeatureSet().HasSelfSyncCounter() {
+		return vdsoCycleClockCNTVCTSS
+	}
+	return vdsoCycleClockCNTVCT
+}
+
+// vsyscallTargets returns the VDSO functions that the platform may run for t's
+// vsyscalls. There is no vsyscall page on arm64.
+func (t *Task) vsyscallTargets(s *SyscallTable) [platform.Vsyscalls]uint64 {
+	return [platform.Vsyscalls]uint64{}
+}
@@ -0,0 +1,57 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package kernel
+
+import (
+	"gvisor.dev/gvisor/pkg/abi/linux"
+	"gvisor.dev/gvisor/pkg/metric"
+)
+
+// VDSO clock reads fall back to a clock_gettime system call when the VDSO
+// can't compute the time itself, e.g. when the Sentry has not published
+// parameters for the clock. The fallbacks are counted by the Sentry when it
+// handles these system calls, rather than by the VDSO: anything the VDSO could
+// write is writable by the application too.
+//
+// Seqlock retries in the VDSO don't reach the Sentry, so they aren't counted.
+var (
+	vdsoRealtimeFallbacks = metric.MustCreateNewUint64Metric("/vdso/realtime_fallbacks", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of VDSO CLOCK_REALTIME, CLOCK_REALTIME_COARSE and CLOCK_TAI reads that were served by a clock_gettime system call.",
+	})
+	vdsoMonotonicFallbacks = metric.MustCreateNewUint64Metric("/vdso/monotonic_fallbacks", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of VDSO CLOCK_MONOTONIC, CLOCK_MONOTONIC_COARSE, CLOCK_MONOTONIC_RAW and CLOCK_BOOTTIME reads that were served by a clock_gettime system call.",
+	})
+)
+
+// RecordVDSOClockFallback counts a read of clockID that fell back from the
+// VDSO to a system call, if t's current clock_gettime system call was made by
+// the VDSO.
+//
+// Preconditions: The caller must be running on the task goroutine, in a
+// system call.
+func (t *Task) RecordVDSOClockFallback(clockID int32) {
+	if !t.MemoryManager().InVDSO(uint64(t.Arch().IP())) {
+		return
+	}
+	// These follow the paths of vdso/vdso.cc:__common_clock_gettime.
+	switch clockID {
+	case linux.CLOCK_REALTIME, linux.CLOCK_REALTIME_COARSE, linux.CLOCK_TAI:
+		vdsoRealtimeFallbacks.Increment()
+	case linux.CLOCK_MONOTONIC, linux.CLOCK_MONOTONIC_COARSE, linux.CLOCK_MONOTONIC_RAW, linux.CLOCK_BOOTTIME:
+		vdsoMonotonicFallbacks.Increment()
+	}
+}
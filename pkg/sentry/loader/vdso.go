@@ -31,6 +31,7 @@ import (
 	"gvisor.dev/gvisor/pkg/sentry/memmap"
 	"gvisor.dev/gvisor/pkg/sentry/mm"
 	"gvisor.dev/gvisor/pkg/sentry/pgalloc"
+	"gvisor.dev/gvisor/pkg/sentry/platform"
 	"gvisor.dev/gvisor/pkg/sentry/uniqueid"
 	"gvisor.dev/gvisor/pkg/sentry/usage"
 	"gvisor.dev/gvisor/pkg/usermem"
@@ -367,7 +368,9 @@ func (v *VDSO) Release(ctx context.Context) {
 	v.vdso.DecRef(ctx)
 }
 
-var vdsoSigreturnOffset = func() uint64 {
+// vdsoSymbols maps the names of the global symbols defined by vdso.so to
+// their prelinked addresses.
+var vdsoSymbols = func() map[string]uint64 {
 	f, err := elf.NewFile(bytes.NewReader(vdsodata.Binary))
 	if err != nil {
 		panic(fmt.Sprintf("failed to parse vdso.so as ELF file: %v", err))
@@ -376,11 +379,48 @@ var vdsoSigreturnOffset = func() uint64 {
 	if err != nil {
 		panic(fmt.Sprintf("failed to read symbols from vdso.so: %v", err))
 	}
-	const sigreturnSymbol = "__kernel_rt_sigreturn"
+	m := make(map[string]uint64)
 	for _, sym := range syms {
-		if elf.ST_BIND(sym.Info) != elf.STB_LOCAL && sym.Section != elf.SHN_UNDEF && sym.Name == sigreturnSymbol {
-			return sym.Value
+		if elf.ST_BIND(sym.Info) != elf.STB_LOCAL && sym.Section != elf.SHN_UNDEF {
+			m[sym.Name] = sym.Value
 		}
 	}
+	return m
+}()
+
+var vdsoSigreturnOffset = func() uint64 {
+	const sigreturnSymbol = "__kernel_rt_sigreturn"
+	if v, ok := vdsoSymbols[sigreturnSymbol]; ok {
+		return v
+	}
 	panic(fmt.Sprintf("no symbol %q in vdso.so", sigreturnSymbol))
 }()
+
+// vdsoVsyscallOffsets are the prelinked addresses of the VDSO functions that
+// implement the entries of the vsyscall page, or 0 if the VDSO doesn't define
+// them (e.g. on arm64, which has no vsyscall page).
+var vdsoVsyscallOffsets = func() (offsets [platform.Vsyscalls]uint64) {
+	for i, name := range [platform.Vsyscalls]string{
+		"__vdso_gettimeofday",
+		"__vdso_time",
+		"__vdso_getcpu",
+	} {
+		offsets[i] = vdsoSymbols[name]
+	}
+	return offsets
+}()
+
+// VsyscallTargets returns the addresses of the VDSO functions that implement
+// the entries of the vsyscall page, for a VDSO mapped at vdsoAddr. See
+// platform.SyscallAnswers.VsyscallTargets.
+func VsyscallTargets(vdsoAddr uint64) (targets [platform.Vsyscalls]uint64) {
+	if vdsoAddr == 0 {
+		return targets
+	}
+	for i, off := range vdsoVsyscallOffsets {
+		if off != 0 {
+			targets[i] = vdsoAddr + off - vdsoPrelink
+		}
+	}
+	return targets
+}
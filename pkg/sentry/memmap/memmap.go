@@ -362,6 +362,11 @@ type MMapOpts struct {
 	// Linux.
 	Stack bool
 
+	// WipeOnFork is true if the mapping should be replaced by zero-filled
+	// memory in the child of fork(2), as for Linux's VM_WIPEONFORK. It is
+	// only valid for private mappings with no Mappable.
+	WipeOnFork bool
+
 	// PlatformEffect controls the synchronous effect of this call on the
 	// underlying platform.AddressSpace.
 	PlatformEffect MMapPlatformEffect
@@ -103,10 +103,13 @@ func (mm *MemoryManager) Fork(ctx context.Context) (*MemoryManager, error) {
 		dumpability:       atomicbitops.FromInt32(mm.dumpability.Load()),
 		aioManager:        aioManager{contexts: make(map[uint64]*AIOContext)},
 		vdsoSigReturnAddr: mm.vdsoSigReturnAddr,
+		vdsoAddr:          atomicbitops.FromUint64(mm.vdsoAddr.Load()),
+		vdsoLen:           mm.vdsoLen,
 	}
 
 	// Copy vmas.
 	dontforks := false
+	wipeOnForks := false
 	dstvgap := mm2.vmas.FirstGap()
 	for srcvseg := mm.vmas.FirstSegment(); srcvseg.Ok(); srcvseg = srcvseg.NextSegment() {
 		vma := srcvseg.ValuePtr().copy()
@@ -121,6 +124,9 @@ func (mm *MemoryManager) Fork(ctx context.Context) (*MemoryManager, error) {
 			dontforks = true
 			continue
 		}
+		if vma.wipeOnFork {
+			wipeOnForks = true
+		}
 
 		// Inform the Mappable, if any, of the new mapping.
 		if vma.mappable != nil {
@@ -151,7 +157,10 @@ func (mm *MemoryManager) Fork(ctx context.Context) (*MemoryManager, error) {
 	defer mm.activeMu.Unlock()
 	mm2.activeMu.NestedLock(activeLockForked)
 	defer mm2.activeMu.NestedUnlock(activeLockForked)
-	if dontforks {
+	// vmas that weren't copied, or were copied without their memory, need
+	// their pmas split from the others to skip them.
+	skipPMAs := dontforks || wipeOnForks
+	if skipPMAs {
 		defer mm.pmas.MergeInsideRange(mm.applicationAddrRange())
 	}
 	srcvseg := mm.vmas.FirstSegment()
@@ -164,7 +173,7 @@ func (mm *MemoryManager) Fork(ctx context.Context) (*MemoryManager, error) {
 			continue
 		}
 
-		if dontforks {
+		if skipPMAs {
 			// Find the 'vma' that contains the starting address
 			// associated with the 'pma' (there must be one).
 			srcvseg = srcvseg.seekNextLowerBound(srcpseg.Start())
@@ -178,7 +187,7 @@ func (mm *MemoryManager) Fork(ctx context.Context) (*MemoryManager, error) {
 			}
 
 			srcpseg = mm.pmas.Isolate(srcpseg, srcvseg.Range())
-			if srcvseg.ValuePtr().dontfork {
+			if v := srcvseg.ValuePtr(); v.dontfork || v.wipeOnFork {
 				continue
 			}
 			pma = srcpseg.ValuePtr()
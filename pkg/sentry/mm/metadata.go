@@ -178,3 +178,36 @@ func (mm *MemoryManager) SetVDSOSigReturn(addr uint64) {
 	defer mm.metadataMu.Unlock()
 	mm.vdsoSigReturnAddr = addr
 }
+
+// VDSOAddr returns the address at which the VDSO is mapped, or 0 if it isn't
+// known or the VDSO has since been unmapped.
+func (mm *MemoryManager) VDSOAddr() uint64 {
+	return mm.vdsoAddr.Load()
+}
+
+// InVDSO returns true if addr is in the VDSO mapping.
+func (mm *MemoryManager) InVDSO(addr uint64) bool {
+	vdsoAddr := mm.vdsoAddr.Load()
+	return vdsoAddr != 0 && addr >= vdsoAddr && addr-vdsoAddr < mm.vdsoLen
+}
+
+// SetVDSOAddr sets the address and length of the VDSO mapping.
+//
+// Preconditions: The VDSO has just been mapped at [addr, addr+length), and no
+// other task is using mm.
+func (mm *MemoryManager) SetVDSOAddr(addr, length uint64) {
+	mm.vdsoLen = length
+	mm.vdsoAddr.Store(addr)
+}
+
+// vdsoRangeLocked returns the range of the VDSO mapping, or an empty range if
+// the VDSO isn't mapped.
+//
+// Preconditions: mm.mappingMu must be locked.
+func (mm *MemoryManager) vdsoRangeLocked() hostarch.AddrRange {
+	addr := hostarch.Addr(mm.vdsoAddr.Load())
+	if addr == 0 {
+		return hostarch.AddrRange{}
+	}
+	return hostarch.AddrRange{addr, addr + hostarch.Addr(mm.vdsoLen)}
+}
@@ -212,6 +212,18 @@ type MemoryManager struct {
 	// vdsoSigReturnAddr is the address of 'vdso_sigreturn'.
 	vdsoSigReturnAddr uint64
 
+	// vdsoAddr is the address at which the VDSO is mapped, or 0. Unlike
+	// vdsoSigReturnAddr, it is read on every switch to application code, so
+	// it is accessed atomically rather than under metadataMu. Like Linux's
+	// mm->context.vdso, it is cleared when the VDSO is unmapped and follows the
+	// VDSO when it is moved by mremap; both of these happen with mappingMu
+	// locked.
+	vdsoAddr atomicbitops.Uint64
+
+	// vdsoLen is the length of the VDSO mapping at vdsoAddr. It is immutable
+	// after the VDSO is mapped.
+	vdsoLen uint64
+
 	// membarrierPrivateEnabled is non-zero if EnableMembarrierPrivate has
 	// previously been called. Since, as of this writing,
 	// MEMBARRIER_CMD_PRIVATE_EXPEDITED is implemented as a global memory
@@ -276,6 +288,11 @@ type vma struct {
 	// dontfork is the MADV_DONTFORK setting for this vma configured by madvise().
 	dontfork bool
 
+	// wipeOnFork is true if this is a MAP_DROPPABLE mapping, whose copy in
+	// the child of fork(2) starts zero-filled. If wipeOnFork is true, private
+	// is true and mappable is nil.
+	wipeOnFork bool
+
 	mlockMode memmap.MLockMode
 
 	// numaPolicy is the NUMA policy for this vma set by mbind().
@@ -313,6 +330,7 @@ func (v *vma) copy() vma {
 		growsDown:      v.growsDown,
 		isStack:        v.isStack,
 		dontfork:       v.dontfork,
+		wipeOnFork:     v.wipeOnFork,
 		mlockMode:      v.mlockMode,
 		numaPolicy:     v.numaPolicy,
 		numaNodemask:   v.numaNodemask,
@@ -21,11 +21,13 @@ import (
 	"gvisor.dev/gvisor/pkg/context"
 	"gvisor.dev/gvisor/pkg/errors/linuxerr"
 	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/metric"
 	"gvisor.dev/gvisor/pkg/rand"
 	"gvisor.dev/gvisor/pkg/sentry/kernel/auth"
 	"gvisor.dev/gvisor/pkg/sentry/kernel/futex"
 	"gvisor.dev/gvisor/pkg/sentry/limits"
 	"gvisor.dev/gvisor/pkg/sentry/memmap"
+	"gvisor.dev/gvisor/pkg/sentry/platform"
 )
 
 // HandleUserFault handles an application page fault. sp is the faulting
@@ -52,6 +54,10 @@ func (mm *MemoryManager) HandleUserFault(ctx context.Context, addr hostarch.Addr
 		return err
 	}
 
+	// Only private anonymous memory is populated around the fault, since
+	// populating pages of other mappings may be observable by the Mappable.
+	faultAround := vseg.ValuePtr().mappable == nil && vseg.ValuePtr().private
+
 	// Ensure that we have a usable pma.
 	mm.activeMu.Lock()
 	pseg, _, err := mm.getPMAsLocked(ctx, vseg, ar, at, true /* callerIndirectCommit */)
@@ -67,10 +73,60 @@ func (mm *MemoryManager) HandleUserFault(ctx context.Context, addr hostarch.Addr
 
 	// Map the faulted page into the active AddressSpace.
 	err = mm.mapASLocked(ctx, pseg, ar, memmap.PlatformEffectDefault)
+	if err == nil && faultAround {
+		mm.faultAroundLocked(ctx, pseg, ar)
+	}
 	mm.activeMu.RUnlock()
 	return err
 }
 
+var (
+	faultAroundFaults = metric.MustCreateNewUint64Metric("/memory/fault_around_faults", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of application page faults on anonymous memory that populated neighbouring pages.",
+	})
+	faultAroundPages = metric.MustCreateNewUint64Metric("/memory/fault_around_pages", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of pages populated around application page faults on anonymous memory.",
+	})
+)
+
+// faultAroundLocked populates the mappings of the pages of pseg in the
+// platform's fault-around window around ar. Errors are ignored, since the
+// faulting page has already been mapped.
+//
+// Preconditions:
+//   - mm.activeMu must be locked.
+//   - ar must be page-aligned.
+//   - pseg.Range().IsSupersetOf(ar).
+//   - ar has been mapped into mm.as.
+func (mm *MemoryManager) faultAroundLocked(ctx context.Context, pseg pmaIterator, ar hostarch.AddrRange) {
+	fa, ok := mm.p.(platform.FaultArounder)
+	if !ok {
+		return
+	}
+	size := fa.FaultAroundSize()
+	if size <= hostarch.PageSize {
+		return
+	}
+	mask := hostarch.Addr(size - 1)
+	window := hostarch.AddrRange{ar.Start &^ mask, ar.Start&^mask + hostarch.Addr(size)}
+	if window.End < window.Start {
+		window.End = ^hostarch.Addr(hostarch.PageSize - 1)
+	}
+	window = window.Intersect(pseg.Range())
+	if window == ar {
+		return
+	}
+	// mapASLocked requires pseg to be the first pma overlapping window, which
+	// holds since window is a subset of pseg.Range().
+	if err := mm.mapASLocked(ctx, pseg, window, memmap.PlatformEffectCommit); err != nil {
+		return
+	}
+	faultAroundFaults.Increment()
+	faultAroundPages.IncrementBy(uint64(window.Length()-ar.Length()) / hostarch.PageSize)
+}
+
 // MMap establishes a memory mapping.
 func (mm *MemoryManager) MMap(ctx context.Context, opts memmap.MMapOpts) (hostarch.Addr, error) {
 	if opts.Length == 0 {
@@ -608,6 +664,15 @@ func (mm *MemoryManager) MRemap(ctx context.Context, oldAddr hostarch.Addr, oldS
 	if vma.mlockMode != memmap.MLockNone {
 		mm.lockedAS = mm.lockedAS - uint64(oldAR.Length()) + uint64(newAR.Length())
 	}
+	if vdsoAR := mm.vdsoRangeLocked(); vdsoAR.Overlaps(oldAR) {
+		// Follow the VDSO if it was moved in its entirety, as Linux's
+		// vdso_mremap() does; otherwise it is no longer usable.
+		if oldAR.IsSupersetOf(vdsoAR) {
+			mm.vdsoAddr.Store(uint64(newAR.Start + (vdsoAR.Start - oldAR.Start)))
+		} else {
+			mm.vdsoAddr.Store(0)
+		}
+	}
 
 	// Move pmas. This is technically optional for non-private pmas, which
 	// could just go through memmap.Mappable.Translate again, but it's required
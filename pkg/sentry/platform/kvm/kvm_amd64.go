@@ -220,6 +220,10 @@ func (c *cpuidEntries) Set(in cpuid.In, out cpuid.Out) {
 
 var hasFSGSBASE bool
 
+// hasGuestRDTSCP indicates that the guest supports rdtscp, in which case each
+// vCPU's IA32_TSC_AUX is set to its vCPU id.
+var hasGuestRDTSCP bool
+
 // updateGlobalOnce does global initialization. It has to be called only once.
 func updateGlobalOnce(fd int) error {
 	hasFSGSBASE = cpuid.HostFeatureSet().UseFSGSBASE()
@@ -234,6 +238,7 @@ func updateGlobalOnce(fd int) error {
 	}
 	// Calculate whether guestPCID is supported.
 	hasGuestPCID = fs.HasFeature(cpuid.X86FeaturePCID)
+	hasGuestRDTSCP = fs.HasFeature(cpuid.X86FeatureRDTSCP)
 	// Create a static feature set from the KVM entries. Then, we
 	// explicitly set OSXSAVE, since this does not come in the feature
 	// entries, but can be provided when the relevant CR4 bit is set.
@@ -252,3 +257,8 @@ func updateGlobalOnce(fd int) error {
 	physicalInit()
 	return nil
 }
+
+// HasTSCAuxCPUNumbers implements platform.Platform.HasTSCAuxCPUNumbers.
+func (k *KVM) HasTSCAuxCPUNumbers() bool {
+	return k.HasCPUNumbers() && hasGuestRDTSCP
+}
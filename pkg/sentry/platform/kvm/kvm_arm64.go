@@ -92,3 +92,8 @@ func updateGlobalOnce(fd int) error {
 	}
 	return err
 }
+
+// HasTSCAuxCPUNumbers implements platform.Platform.HasTSCAuxCPUNumbers.
+func (*KVM) HasTSCAuxCPUNumbers() bool {
+	return false
+}
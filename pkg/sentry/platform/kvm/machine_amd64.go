@@ -135,6 +135,13 @@ func (c *vCPU) initArchState() error {
 		return err
 	}
 
+	// Expose the vCPU id to rdtscp; see HasTSCAuxCPUNumbers.
+	if hasGuestRDTSCP {
+		if err := c.setTSCAux(); err != nil {
+			return err
+		}
+	}
+
 	// Set the entrypoint for the kernel.
 	kernelUserRegs.RIP = uint64(ring0.AddrOfStart())
 	kernelUserRegs.RAX = uint64(reflect.ValueOf(&c.CPU).Pointer())
@@ -171,6 +171,25 @@ func (c *vCPU) setTSC(value uint64) error {
 	return nil
 }
 
+// setTSCAux sets IA32_TSC_AUX to the vCPU id, so application code can read
+// it with rdtscp. See platform.Platform.HasTSCAuxCPUNumbers.
+func (c *vCPU) setTSCAux() error {
+	const _MSR_TSC_AUX = 0xc0000103
+	registers := modelControlRegisters{
+		nmsrs: 1,
+	}
+	registers.entries[0].index = _MSR_TSC_AUX
+	registers.entries[0].data = uint64(c.id)
+	if errno := hostsyscall.RawSyscallErrno(
+		unix.SYS_IOCTL,
+		uintptr(c.fd),
+		KVM_SET_MSRS,
+		uintptr(unsafe.Pointer(&registers))); errno != 0 {
+		return fmt.Errorf("error setting TSC_AUX: %v", errno)
+	}
+	return nil
+}
+
 func (c *vCPU) enableCPUIDFaulting() error {
 	const (
 		_MSR_MISC_FEATURES_ENABLE              = 0x140
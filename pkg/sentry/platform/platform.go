@@ -116,6 +116,11 @@ type Platform interface {
 
 	// NumCPUs returns the number of CPUs on the platform.
 	NumCPUs() int
+
+	// HasTSCAuxCPUNumbers returns true if application code can read the CPU
+	// number of the context it is running in from IA32_TSC_AUX (using
+	// rdtscp), without a system call. It implies HasCPUNumbers.
+	HasTSCAuxCPUNumbers() bool
 }
 
 // NoCPUPreemptionDetection implements Platform.DetectsCPUPreemption and
@@ -146,6 +151,11 @@ func (NoCPUNumbers) NumCPUs() int {
 	panic("platform does not support CPU numbers")
 }
 
+// HasTSCAuxCPUNumbers implements Platform.HasTSCAuxCPUNumbers.
+func (NoCPUNumbers) HasTSCAuxCPUNumbers() bool {
+	return false
+}
+
 // PreemptCPU implements Platform.PreemptCPU.
 func (NoCPUNumbers) PreemptCPU(int32) error {
 	panic("platform does not support preempting a specific CPU")
@@ -309,6 +319,54 @@ func (NoCPUNumbers) LastCPUNumber() int32 {
 	panic("context does not support last CPU number")
 }
 
+// FaultArounder is implemented by Platforms that want the Sentry to populate
+// neighbouring pages of private anonymous memory when it handles an
+// application page fault, so that the application doesn't take host page
+// faults on them soon after.
+type FaultArounder interface {
+	// FaultAroundSize returns the size of the naturally-aligned window around
+	// a faulting address that is populated. A FaultAroundSize of 0 disables
+	// fault-around. Otherwise, it must be a power-of-2 multiple of
+	// hostarch.PageSize.
+	FaultAroundSize() uint64
+}
+
+// SyscallAnswers contains the results of system calls that only depend on the
+// identity of the calling thread: getpid, gettid, getuid, geteuid, getgid and
+// getegid.
+type SyscallAnswers struct {
+	// Valid is false if these system calls must be handled by the Sentry,
+	// e.g. because they are traced or filtered.
+	Valid bool
+	Pid   int32
+	Tid   int32
+	UID   uint32
+	EUID  uint32
+	GID   uint32
+	EGID  uint32
+
+	// VsyscallTargets are the addresses of the VDSO functions that
+	// implement the entries of the vsyscall page (gettimeofday, time and
+	// getcpu, in this order), or 0 if a vsyscall has to be handled by the
+	// Sentry. Contexts may run them instead of trapping into the Sentry
+	// for vsyscalls. They are only set on amd64.
+	VsyscallTargets [Vsyscalls]uint64
+}
+
+// Vsyscalls is the number of entries in the vsyscall page.
+const Vsyscalls = 3
+
+// SyscallAnswerCache is implemented by Contexts that can answer the system
+// calls in SyscallAnswers without switching to the Sentry.
+type SyscallAnswerCache interface {
+	// SetSyscallAnswers sets the answers that the Context may return for
+	// system calls made after the next call to Switch.
+	//
+	// Preconditions: The caller must be running on the task goroutine, and
+	// Switch must not be running.
+	SetSyscallAnswers(a *SyscallAnswers)
+}
+
 // ContextError is one of the possible errors returned by Context.Switch().
 type ContextError struct {
 	// Err is the underlying error.
@@ -592,6 +650,33 @@ type Options struct {
 	// DisableFastPath, if true, completely disables the Systrap fast path.
 	DisableFastPath bool
 
+	// PowerEfficientSpin, if true, makes Systrap stub threads wait for the
+	// context queue to be written to with UMWAIT or WFE where supported,
+	// rather than poll it.
+	PowerEfficientSpin bool
+
+	// VsyscallVDSO, if true, makes Systrap stub threads redirect vsyscalls
+	// to the VDSO functions in SyscallAnswers.VsyscallTargets.
+	VsyscallVDSO bool
+
+	// StubHugePages, if true, makes Systrap back the memory that it shares
+	// with stub threads for thread contexts with huge pages where possible.
+	StubHugePages bool
+
+	// WarmStubProcesses is the number of idle stub processes that Systrap
+	// keeps ready for new address spaces. It must be at most 16.
+	WarmStubProcesses uint64
+
+	// ContextQueueCapacity is the capacity of Systrap context queues, which
+	// bounds the number of contexts of each stub process. It must be 0 (the
+	// default) or a power of 2.
+	ContextQueueCapacity uint64
+
+	// FaultAroundBytes is the size of the window of private anonymous
+	// memory that Systrap populates around application page faults. 0
+	// disables fault-around.
+	FaultAroundBytes uint64
+
 	// ApplicationCores is used by KVM to determine the correct amount of
 	// vCPUs to create.
 	ApplicationCores int
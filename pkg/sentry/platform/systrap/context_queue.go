@@ -18,13 +18,27 @@ import (
 	"sync/atomic"
 
 	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/log"
+	"gvisor.dev/gvisor/pkg/sentry/hostcpu"
 	"gvisor.dev/gvisor/pkg/sentry/platform"
 )
 
 // LINT.IfChange
 const (
-	// maxEntries is the size of the ringbuffer.
-	maxContextQueueEntries uint32 = uint32(maxGuestContexts) + 1
+	// maxContextQueueEntries is the size of the ringbuffer, and so the
+	// maximum context queue capacity.
+	maxContextQueueEntries uint32 = 32768
+
+	// maxContextQueueShards is the maximum number of context queue shards.
+	maxContextQueueShards = 4
+)
+
+const (
+	// minContextQueueEntries is the minimum context queue capacity.
+	minContextQueueEntries uint32 = 64
+
+	// defaultContextQueueEntries is the default context queue capacity.
+	defaultContextQueueEntries uint32 = 4096
 )
 
 type queuedContext struct {
@@ -32,12 +46,37 @@ type queuedContext struct {
 	threadID  uint32
 }
 
+// contextQueueShard is a lockless ringbuffer of contexts that are ready to
+// resume running.
+type contextQueueShard struct {
+	// end is an index used for putting new contexts into the ringbuffer.
+	// It is written only by the Sentry (add) and read by stub threads.
+	end uint32
+	_   [hostarch.CacheLineSize - 4]byte
+
+	// start is an index used for taking contexts out of the ringbuffer.
+	// It is written only by stub threads and read by both sides.
+	start uint32
+	_     [hostarch.CacheLineSize - 4]byte
+
+	// ringbuffer starts on its own cache line.
+	ringbuffer [maxContextQueueEntries]uint64
+}
+
 // contextQueue is a structure shared with the each stub thread that is used to
 // signal to stub threads which contexts are ready to resume running.
 //
-// It is a lockless ringbuffer where threads try to police themselves on whether
-// they should continue waiting for a context or go to sleep if they are
-// unneeded.
+// It is made of lockless ringbuffers (shards) where threads try to police
+// themselves on whether they should continue waiting for a context or go to
+// sleep if they are unneeded.
+//
+// On multi-node hosts there is one shard per NUMA node (up to
+// maxContextQueueShards). A context is queued on the shard of the node where
+// it was last picked up, and stub threads drain the shard of their own node
+// first and only steal from other shards when it is empty. This keeps
+// contexts (and the cache lines of their thread_context) on one node, and
+// keeps stub threads from different nodes off each other's start and end
+// indexes.
 //
 // The control words below are atomically read and written by the Sentry and
 // by stub threads from different CPUs.
@@ -46,23 +85,13 @@ type queuedContext struct {
 // each group is padded out to its own cache line. A field shares a line only
 // with fields written by the same side, so a writer never invalidates a line
 // that another core needs for an unrelated read-mostly field.
-// The ringbuffer starts on its own cache line instead of sharing the first
-// line with the control words. This also guarantees the 8-byte alignment
-// required by Go's 64-bit atomic ints.
+// Each ringbuffer starts on its own cache line instead of sharing a line with
+// the indexes. This also guarantees the 8-byte alignment required by Go's
+// 64-bit atomic ints.
 //
 // The layout must stay byte-identical to `context_queue` in
 // `sysmsg/sysmsg_lib.c`.
 type contextQueue struct {
-	// end is an index used for putting new contexts into the ringbuffer.
-	// It is written only by the Sentry (add) and read by stub threads.
-	end uint32
-	_   [hostarch.CacheLineSize - 4]byte
-
-	// start is an index used for taking contexts out of the ringbuffer.
-	// It is written only by stub threads and read by both sides.
-	start uint32
-	_     [hostarch.CacheLineSize - 4]byte
-
 	// Sentry-written control words, read by spinning stub threads.
 
 	// fastPathDisabled is set by the Sentry to make stub threads sleep in a
@@ -71,7 +100,17 @@ type contextQueue struct {
 	// numAwakeContexts is the number of awake contexts. It includes all
 	// active contexts and contexts that are running in the Sentry.
 	numAwakeContexts uint32
-	_                [hostarch.CacheLineSize - 8]byte
+	// numShards is the number of shards in use, for stub threads. It is
+	// set in init and is never changed after that by the Sentry, which
+	// doesn't read it back (see activeShards).
+	numShards uint32
+	// capacity is the number of entries of each ringbuffer that are in use.
+	// It is a power of two, so that indexes don't jump when start or end
+	// overflow. Context IDs are below capacity. It is set in init for stub
+	// threads and is never changed or read back by the Sentry after that
+	// (see indexMask).
+	capacity uint32
+	_        [hostarch.CacheLineSize - 16]byte
 
 	// Stub-written status words, read by the Sentry.
 
@@ -101,8 +140,7 @@ type contextQueue struct {
 	usedFastPath uint32
 	_            [hostarch.CacheLineSize - 8]byte
 
-	// ringbuffer starts on its own cache line.
-	ringbuffer [maxContextQueueEntries]uint64
+	shards [maxContextQueueShards]contextQueueShard
 }
 
 const (
@@ -113,14 +151,60 @@ const (
 
 // LINT.ThenChange(./sysmsg/sysmsg_lib.c)
 
+// contextQueueEntries is the capacity of new context queues. It is set once by
+// initContextQueueCapacity.
+//
+// Every subprocess has a context queue and a thread context region sized by
+// it, so small capacities make sandboxes with few threads denser, while large
+// ones let a subprocess run more threads.
+var contextQueueEntries = defaultContextQueueEntries
+
+// initContextQueueCapacity sets the capacity of context queues, and with it
+// the maximum number of contexts of a subprocess. capacity must be 0, which
+// selects the default, or a power of two in [minContextQueueEntries,
+// maxContextQueueEntries].
+func initContextQueueCapacity(capacity uint32) {
+	if capacity != 0 {
+		contextQueueEntries = capacity
+	}
+	maxGuestContexts = contextQueueEntries - 1
+	log.Debugf("Using a context queue capacity of %d", contextQueueEntries)
+}
+
+// contextQueueShards is the number of shards used by new context queues.
+// It is set once by initContextQueueShards.
+var contextQueueShards uint32 = 1
+
+// initContextQueueShards sets contextQueueShards to the number of NUMA nodes
+// of the host, capped at maxContextQueueShards.
+func initContextQueueShards() {
+	if !canShardContextQueue() {
+		return
+	}
+	maxNode, err := hostcpu.MaxPossibleNode()
+	if err != nil {
+		log.Warningf("Failed to get the number of NUMA nodes, using one context queue shard: %v", err)
+		return
+	}
+	contextQueueShards = min(maxNode+1, maxContextQueueShards)
+	log.Debugf("Using %d context queue shards", contextQueueShards)
+}
+
 func (q *contextQueue) init() {
-	for i := uint32(0); i < maxContextQueueEntries; i++ {
-		q.ringbuffer[i] = uint64(invalidContextID)
+	atomic.StoreUint32(&q.numShards, contextQueueShards)
+	atomic.StoreUint32(&q.capacity, contextQueueEntries)
+	for s := range q.activeShards() {
+		shard := &q.shards[s]
+		// Entries past the capacity are never touched, so the pages
+		// backing them are never allocated.
+		for i := uint32(0); i < contextQueueEntries; i++ {
+			shard.ringbuffer[i] = uint64(invalidContextID)
+		}
+		// Allow tests to trigger overflows of start and end.
+		idx := ^uint32(0) - contextQueueEntries*4
+		atomic.StoreUint32(&shard.start, idx)
+		atomic.StoreUint32(&shard.end, idx)
 	}
-	// Allow tests to trigger overflows of start and end.
-	idx := ^uint32(0) - maxContextQueueEntries*4
-	atomic.StoreUint32(&q.start, idx)
-	atomic.StoreUint32(&q.end, idx)
 	atomic.StoreUint32(&q.numActiveThreads, 0)
 	atomic.StoreUint32(&q.numSpinningThreads, 0)
 	atomic.StoreUint32(&q.numThreadsToWakeup, 0)
@@ -130,17 +214,57 @@ func (q *contextQueue) init() {
 	atomic.StoreUint32(&q.usedFastPath, 0)
 }
 
+// activeShards returns the number of shards in use.
+//
+// It never reads numShards back: the context queue is mapped writable into
+// stub threads, so the application can change it, and a zero or oversized
+// value would make the Sentry divide by zero or index q.shards out of range.
+// contextQueueShards is private to the Sentry and fixed before any context
+// queue is initialized, so it always matches what init stored.
+func (q *contextQueue) activeShards() uint32 {
+	return contextQueueShards
+}
+
 func (q *contextQueue) isEmpty() bool {
-	return atomic.LoadUint32(&q.start) == atomic.LoadUint32(&q.end)
+	for s := range q.activeShards() {
+		shard := &q.shards[s]
+		if atomic.LoadUint32(&shard.start) != atomic.LoadUint32(&shard.end) {
+			return false
+		}
+	}
+	return true
 }
 
+// indexMask returns the mask of ringbuffer indexes.
+//
+// Like activeShards, it never reads capacity back from the shared context
+// queue: a zero value would make the mask all ones and let add index the
+// ringbuffer out of range. contextQueueEntries is fixed before any context
+// queue is initialized.
+func (q *contextQueue) indexMask() uint32 {
+	return contextQueueEntries - 1
+}
+
+// queuedContexts returns the number of contexts waiting in the context queue.
+//
+// start is written by stub threads, so the result is only an estimate, but it
+// never exceeds activeShards() * indexMask(): it is sampled periodically for
+// metrics, and must not depend on anything else the application can change.
 func (q *contextQueue) queuedContexts() uint32 {
-	return (atomic.LoadUint32(&q.end) + maxContextQueueEntries - atomic.LoadUint32(&q.start)) % maxContextQueueEntries
+	mask := q.indexMask()
+	n := uint32(0)
+	for s := range q.activeShards() {
+		shard := &q.shards[s]
+		n += (atomic.LoadUint32(&shard.end) - atomic.LoadUint32(&shard.start)) & mask
+	}
+	return n
 }
 
 // add puts the given ctx onto the context queue, and records a state of
 // the subprocess after insertion to see if there are more active stub threads
 // or more waiting contexts.
+//
+// The context is queued on the shard it was last picked up from.
 func (q *contextQueue) add(ctx *sharedContext) *platform.ContextError {
 	ctx.startWaitingTS = cputicks()
 
@@ -150,17 +274,19 @@ func (q *contextQueue) add(ctx *sharedContext) *platform.ContextError {
 
 	q.setFastPathDisabled(!fastpath.stubFastPath())
 	contextID := ctx.contextID
+	// LastShard is written by the stub, so it must be bounded here.
+	shard := &q.shards[atomic.LoadUint32(&ctx.shared.LastShard)%q.activeShards()]
+	mask := q.indexMask()
 	atomic.AddUint32(&q.numActiveContexts, 1)
-	next := atomic.AddUint32(&q.end, 1)
-	if (next % maxContextQueueEntries) ==
-		(atomic.LoadUint32(&q.start) % maxContextQueueEntries) {
+	next := atomic.AddUint32(&shard.end, 1)
+	if (next & mask) == (atomic.LoadUint32(&shard.start) & mask) {
 		// reachable only in case of corrupted memory
 		return corruptedSharedMemoryErr("context queue is full, indicates tampering with queue counters")
 	}
 	idx := next - 1
-	next = idx % maxContextQueueEntries
+	next = idx & mask
 	v := (uint64(idx) << contextQueueIndexShift) + uint64(contextID)
-	atomic.StoreUint64(&q.ringbuffer[next], v)
+	atomic.StoreUint64(&shard.ringbuffer[next], v)
 
 	// Check before swapping: usedFastPath is usually zero, and the swap's
 	// write would invalidate the cache line for stub threads even when it
@@ -19,6 +19,7 @@ import (
 	"unsafe"
 
 	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/sentry/platform/systrap/sysmsg"
 )
 
 // TestContextQueueLayout ensures layout consistency of contextQueue.
@@ -30,26 +31,116 @@ func TestContextQueueLayout(t *testing.T) {
 		got   uintptr
 		want  uintptr
 	}{
-		{"end", unsafe.Offsetof(q.end), 0 * line},
-		{"start", unsafe.Offsetof(q.start), 1 * line},
-		{"fastPathDisabled", unsafe.Offsetof(q.fastPathDisabled), 2 * line},
-		{"numAwakeContexts", unsafe.Offsetof(q.numAwakeContexts), 2*line + 4},
-		{"numActiveThreads", unsafe.Offsetof(q.numActiveThreads), 3 * line},
-		{"numSpinningThreads", unsafe.Offsetof(q.numSpinningThreads), 3*line + 4},
-		{"numThreadsToWakeup", unsafe.Offsetof(q.numThreadsToWakeup), 4 * line},
-		{"numActiveContexts", unsafe.Offsetof(q.numActiveContexts), 5 * line},
-		{"usedFastPath", unsafe.Offsetof(q.usedFastPath), 5*line + 4},
-		{"ringbuffer", unsafe.Offsetof(q.ringbuffer), 6 * line},
+		{"fastPathDisabled", unsafe.Offsetof(q.fastPathDisabled), 0 * line},
+		{"numAwakeContexts", unsafe.Offsetof(q.numAwakeContexts), 0*line + 4},
+		{"numShards", unsafe.Offsetof(q.numShards), 0*line + 8},
+		{"capacity", unsafe.Offsetof(q.capacity), 0*line + 12},
+		{"numActiveThreads", unsafe.Offsetof(q.numActiveThreads), 1 * line},
+		{"numSpinningThreads", unsafe.Offsetof(q.numSpinningThreads), 1*line + 4},
+		{"numThreadsToWakeup", unsafe.Offsetof(q.numThreadsToWakeup), 2 * line},
+		{"numActiveContexts", unsafe.Offsetof(q.numActiveContexts), 3 * line},
+		{"usedFastPath", unsafe.Offsetof(q.usedFastPath), 3*line + 4},
+		{"shards", unsafe.Offsetof(q.shards), 4 * line},
+		{"shards[].end", unsafe.Offsetof(q.shards[0].end), 0 * line},
+		{"shards[].start", unsafe.Offsetof(q.shards[0].start), 1 * line},
+		{"shards[].ringbuffer", unsafe.Offsetof(q.shards[0].ringbuffer), 2 * line},
 	} {
 		if tc.got != tc.want {
 			t.Errorf("unsafe.Offsetof(contextQueue.%s) = %d, want %d", tc.field, tc.got, tc.want)
 		}
 	}
-	if got, want := unsafe.Sizeof(q), 6*line+uintptr(maxContextQueueEntries)*8; got != want {
+	shardSize := 2*line + uintptr(maxContextQueueEntries)*8
+	if got := unsafe.Sizeof(q.shards[0]); got != shardSize {
+		t.Errorf("unsafe.Sizeof(contextQueueShard{}) = %d, want %d", got, shardSize)
+	}
+	if got, want := unsafe.Sizeof(q), 4*line+maxContextQueueShards*shardSize; got != want {
 		t.Errorf("unsafe.Sizeof(contextQueue{}) = %d, want %d", got, want)
 	}
 	// Go's sync/atomic requires 64-bit words to be 8-byte aligned.
-	if off := unsafe.Offsetof(q.ringbuffer); off%8 != 0 {
+	if off := unsafe.Offsetof(q.shards) + unsafe.Offsetof(q.shards[0].ringbuffer); off%8 != 0 {
 		t.Errorf("ringbuffer offset %d is not 8-byte aligned", off)
 	}
 }
+
+// TestContextQueueCapacity ensures that a context queue only uses capacity
+// entries of its ringbuffers.
+func TestContextQueueCapacity(t *testing.T) {
+	defer func(entries uint32) { contextQueueEntries = entries }(contextQueueEntries)
+	contextQueueEntries = minContextQueueEntries
+
+	q := new(contextQueue)
+	q.init()
+	// A queue of capacity entries holds up to capacity-1 contexts.
+	for i := uint32(0); i < minContextQueueEntries-1; i++ {
+		ctx := &sharedContext{contextID: i, shared: &sysmsg.ThreadContext{}}
+		if err := q.add(ctx); err != nil {
+			t.Fatalf("add(%d) failed: %v", i, err)
+		}
+	}
+	if got, want := q.queuedContexts(), minContextQueueEntries-1; got != want {
+		t.Errorf("queuedContexts() = %d, want %d", got, want)
+	}
+	ctx := &sharedContext{contextID: minContextQueueEntries, shared: &sysmsg.ThreadContext{}}
+	if err := q.add(ctx); err == nil {
+		t.Errorf("add succeeded on a full queue")
+	}
+	for i := minContextQueueEntries; i < maxContextQueueEntries; i++ {
+		if v := q.shards[0].ringbuffer[i]; v != 0 {
+			t.Fatalf("ringbuffer[%d] = %#x past the capacity was written", i, v)
+		}
+	}
+}
+
+// TestContextQueueTamperedShards ensures that the Sentry doesn't use the shard
+// count stored in the context queue, which the application can change.
+func TestContextQueueTamperedShards(t *testing.T) {
+	for _, numShards := range []uint32{0, maxContextQueueShards + 1, ^uint32(0)} {
+		q := new(contextQueue)
+		q.init()
+		q.numShards = numShards
+		ctx := &sharedContext{shared: &sysmsg.ThreadContext{LastShard: 1}}
+		if err := q.add(ctx); err != nil {
+			t.Fatalf("numShards=%d: add failed: %v", numShards, err)
+		}
+		if got := q.queuedContexts(); got != 1 {
+			t.Errorf("numShards=%d: queuedContexts() = %d, want 1", numShards, got)
+		}
+	}
+}
+
+// TestContextQueueTamperedCapacity ensures that the Sentry doesn't use the
+// capacity stored in the context queue, which the application can change.
+func TestContextQueueTamperedCapacity(t *testing.T) {
+	for _, capacity := range []uint32{0, 1, maxContextQueueEntries * 2, ^uint32(0)} {
+		q := new(contextQueue)
+		q.init()
+		q.capacity = capacity
+		for i := uint32(0); i < 2; i++ {
+			ctx := &sharedContext{contextID: i, shared: &sysmsg.ThreadContext{}}
+			if err := q.add(ctx); err != nil {
+				t.Fatalf("capacity=%d: add(%d) failed: %v", capacity, i, err)
+			}
+		}
+		if got := q.queuedContexts(); got != 2 {
+			t.Errorf("capacity=%d: queuedContexts() = %d, want 2", capacity, got)
+		}
+	}
+}
+
+// TestContextQueueTamperedDepth ensures that the queue depth sampled for
+// metrics stays bounded when the application changes the shared counters.
+func TestContextQueueTamperedDepth(t *testing.T) {
+	q := new(contextQueue)
+	q.init()
+	q.numShards = 0
+	q.capacity = 0
+	for i := range q.shards {
+		q.shards[i].start = 1
+		q.shards[i].end = 0
+	}
+	got := q.queuedContexts()
+	if limit := q.activeShards() * q.indexMask(); got > limit {
+		t.Errorf("queuedContexts() = %d, want at most %d", got, limit)
+	}
+	recordContextQueueDepth(got)
+}
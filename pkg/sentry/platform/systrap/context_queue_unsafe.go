@@ -22,6 +22,8 @@ import (
 	"gvisor.dev/gvisor/pkg/hostsyscall"
 )
 
+// wakeupSysmsgThread wakes up one stub thread sleeping on numThreadsToWakeup.
+// The caller must have incremented numThreadsToWakeup.
 func (q *contextQueue) wakeupSysmsgThread() {
 	hostsyscall.RawSyscall(unix.SYS_FUTEX,
 		uintptr(unsafe.Pointer(&q.numThreadsToWakeup)),
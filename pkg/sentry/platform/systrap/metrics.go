@@ -15,11 +15,21 @@
 package systrap
 
 import (
+	"fmt"
+	"math/bits"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
 	"time"
 
 	"gvisor.dev/gvisor/pkg/atomicbitops"
 	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/log"
 	"gvisor.dev/gvisor/pkg/metric"
+	"gvisor.dev/gvisor/pkg/sentry/platform/systrap/sysmsg"
+	"gvisor.dev/gvisor/pkg/sentry/platform/systrap/usertrap"
 )
 
 // This file contains all logic related to context switch latency metrics.
@@ -143,6 +153,459 @@ func (sc *sharedContext) recordLatency() {
 	}
 
 	updateDebugMetrics(stubBoundLatency, sentryBoundLatency)
+
+	// Export the spin budget chosen by the stub thread.
+	if budget := sc.getSpinBudget(); budget != 0 {
+		stubSpinBudgetNS.Set(uint64(budget) * deepSleepTimeoutNS / deepSleepTimeout)
+	}
+}
+
+// Trap latency histograms.
+//
+// Each stub thread keeps log2 histograms of trap latencies in its sysmsg.Msg:
+// from a context trapping into the sentry until a stub thread picks it up
+// again (trap-to-ack), and from then until the context is resumed
+// (ack-to-resume). Stub threads update them without any synchronization with
+// the sentry, and the sentry periodically adds what is new in them to the
+// trap latency metrics.
+
+// trapLatencyFlushInterval is the number of switches of a context after which
+// the histograms of the stub thread that ran it are flushed to the metrics.
+const trapLatencyFlushInterval = 64
+
+// trapLatencySnapshot is the state of the histograms of one stub thread that
+// has been added to the metrics.
+type trapLatencySnapshot struct {
+	mu          sync.Mutex
+	trapToAck   [sysmsg.TrapLatencyBuckets]uint32
+	ackToResume [sysmsg.TrapLatencyBuckets]uint32
+	// syscallSamples is the sysmsg.Msg.SyscallSamplesHead up to which
+	// syscall samples have been added to the subprocess syscall table.
+	syscallSamples uint32
+	// contextPickups are the context pickup counters of the stub thread
+	// that have been added to the metric.
+	contextPickups [sysmsg.NumContextPickupPaths]uint32
+}
+
+var (
+	// trapLatencyBucketFields are the field values of the trap latency
+	// metrics: "N" stands for latencies in [2^N, 2^(N+1)) cputicks.
+	trapLatencyBucketFields = func() []*metric.FieldValue {
+		fields := make([]*metric.FieldValue, sysmsg.TrapLatencyBuckets)
+		for i := range fields {
+			fields[i] = &metric.FieldValue{Value: strconv.Itoa(i)}
+		}
+		return fields
+	}()
+
+	trapToAckLatency = metric.MustCreateNewUint64Metric("/systrap/trap_to_ack_latency", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of context switches by the log2 of the cputicks between a context trapping into the Sentry and a stub thread picking it up again.",
+		Fields:      []metric.Field{metric.NewField("log2_cputicks", trapLatencyBucketFields...)},
+	})
+	ackToResumeLatency = metric.MustCreateNewUint64Metric("/systrap/ack_to_resume_latency", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of context switches by the log2 of the cputicks between a stub thread picking up a context and resuming it.",
+		Fields:      []metric.Field{metric.NewField("log2_cputicks", trapLatencyBucketFields...)},
+	})
+)
+
+// flushTrapLatencies adds the new samples in the trap latency histograms of
+// the stub thread to the trap latency metrics.
+func (p *sysmsgThread) flushTrapLatencies() {
+	s := &p.trapLatencies
+	// Another goroutine is already flushing this thread.
+	if !s.mu.TryLock() {
+		return
+	}
+	defer s.mu.Unlock()
+	flushTrapLatencyHistogram(trapToAckLatency, &p.msg.TrapToAckHist, &s.trapToAck)
+	flushTrapLatencyHistogram(ackToResumeLatency, &p.msg.AckToResumeHist, &s.ackToResume)
+	for i := range p.msg.ContextPickups {
+		v := atomic.LoadUint32(&p.msg.ContextPickups[i])
+		if d := v - s.contextPickups[i]; d != 0 {
+			stubContextPickups.IncrementBy(uint64(d), stubContextPickupFields[i])
+			s.contextPickups[i] = v
+		}
+	}
+	if t := p.subproc.syscallSamples; t != nil {
+		p.flushSyscallSamples(t)
+	}
+}
+
+func flushTrapLatencyHistogram(m *metric.Uint64Metric, hist, flushed *[sysmsg.TrapLatencyBuckets]uint32) {
+	for i := range hist {
+		// The histogram is written by the stub thread. Wrapped-around
+		// counters are handled by the unsigned subtraction.
+		v := atomic.LoadUint32(&hist[i])
+		if d := v - flushed[i]; d != 0 {
+			m.IncrementBy(uint64(d), trapLatencyBucketFields[i])
+			flushed[i] = v
+		}
+	}
+}
+
+// maybeFlushTrapLatencies flushes the trap latency histograms of the stub
+// thread that ran ctx every trapLatencyFlushInterval switches of ctx. It also
+// samples the depth of the context queue of the subprocess at that rate.
+func (s *subprocess) maybeFlushTrapLatencies(ctx *sharedContext) {
+	ctx.switches++
+	if ctx.switches%trapLatencyFlushInterval != 0 {
+		return
+	}
+	// queuedContexts is bounded by the Sentry's own shard count and capacity,
+	// whatever the application has done to the shared context queue.
+	recordContextQueueDepth(s.contextQueue.queuedContexts())
+	threadID := atomic.LoadUint32(&ctx.shared.LastThreadID)
+	s.sysmsgThreadsMu.RLock()
+	p, ok := s.sysmsgThreads[threadID]
+	s.sysmsgThreadsMu.RUnlock()
+	if ok {
+		p.flushTrapLatencies()
+	}
+	ctx.flushSyscallEntries()
+	ctx.flushSentryWakeups()
+}
+
+// Context queue metrics.
+//
+// These explain the decisions of the fast path state machine below: how many
+// contexts wait in the context queue for a stub thread, how stub threads get
+// contexts from it and how task goroutines learn that their context is back,
+// and how often each fast path is turned on and off. A low share of fast path
+// pickups with a deep queue means that there are too few stub threads (or
+// CPUs) to keep up, while a high share of wakeups with an empty queue means
+// that spinning doesn't pay off for the workload.
+
+// sentryWakeupPath is how a task goroutine learned that a stub thread handed
+// its context back to the Sentry.
+type sentryWakeupPath int
+
+const (
+	// sentryWakeupFastPath means that the context was handed back while
+	// the dispatcher was polling it, or before the goroutine waited.
+	sentryWakeupFastPath sentryWakeupPath = iota
+	// sentryWakeupFutex means that the goroutine slept on the futex of the
+	// context state.
+	sentryWakeupFutex
+
+	numSentryWakeupPaths
+)
+
+// contextQueueDepthBuckets is the number of buckets of contextQueueDepth:
+// bucket 0 counts empty queues, and bucket N counts depths in
+// [2^(N-1), 2^N).
+var contextQueueDepthBuckets = bits.Len32(maxContextQueueEntries) + 1
+
+var (
+	stubContextPickupFields = [sysmsg.NumContextPickupPaths]*metric.FieldValue{
+		sysmsg.ContextPickupQueued:   &metric.FieldValue{Value: "queued"},
+		sysmsg.ContextPickupFastPath: &metric.FieldValue{Value: "fast_path"},
+		sysmsg.ContextPickupWoken:    &metric.FieldValue{Value: "woken"},
+	}
+	stubContextPickups = metric.MustCreateNewUint64Metric("/systrap/stub_context_pickups", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of contexts picked up by stub threads, by whether they were already queued, were queued while the thread spun on the fast path, or after the thread stopped spinning to go to sleep.",
+		Fields:      []metric.Field{metric.NewField("path", stubContextPickupFields[:]...)},
+	})
+
+	sentryWakeupFields = [numSentryWakeupPaths]*metric.FieldValue{
+		sentryWakeupFastPath: &metric.FieldValue{Value: "fast_path"},
+		sentryWakeupFutex:    &metric.FieldValue{Value: "futex"},
+	}
+	sentryWakeups = metric.MustCreateNewUint64Metric("/systrap/sentry_wakeups", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of contexts handed back to the Sentry by stub threads, by whether the task goroutine learned about it from the fast path dispatcher or by sleeping on a futex.",
+		Fields:      []metric.Field{metric.NewField("path", sentryWakeupFields[:]...)},
+	})
+
+	contextQueueDepthFields = func() []*metric.FieldValue {
+		fields := make([]*metric.FieldValue, contextQueueDepthBuckets)
+		for i := range fields {
+			fields[i] = &metric.FieldValue{Value: strconv.Itoa(i)}
+		}
+		return fields
+	}()
+	contextQueueDepth = metric.MustCreateNewUint64Metric("/systrap/context_queue_depth", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of samples of the number of contexts waiting in a context queue, by its log2: \"0\" stands for an empty queue, and \"N\" for depths in [2^(N-1), 2^N).",
+		Fields:      []metric.Field{metric.NewField("log2_depth", contextQueueDepthFields...)},
+	})
+
+	fastPathSideFields = []*metric.FieldValue{
+		&metric.FieldValue{Value: "stub"},
+		&metric.FieldValue{Value: "sentry"},
+	}
+	fastPathToggleFields = []*metric.FieldValue{
+		&metric.FieldValue{Value: "enabled"},
+		&metric.FieldValue{Value: "disabled"},
+	}
+	fastPathToggles = metric.MustCreateNewUint64Metric("/systrap/fast_path_toggles", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of times the stub or Sentry fast path was enabled or disabled, including being disabled while the platform is idle.",
+		Fields: []metric.Field{
+			metric.NewField("side", fastPathSideFields...),
+			metric.NewField("toggle", fastPathToggleFields...),
+		},
+	})
+)
+
+// recordSentryWakeup counts how the task goroutine of sc learned that its
+// context is back. Like syscall entries, the counts are kept in sc.
+func (sc *sharedContext) recordSentryWakeup(slowPath bool) {
+	if slowPath {
+		sc.sentryWakeups[sentryWakeupFutex]++
+	} else {
+		sc.sentryWakeups[sentryWakeupFastPath]++
+	}
+}
+
+// flushSentryWakeups adds the wakeups counted in sc to the metric.
+func (sc *sharedContext) flushSentryWakeups() {
+	for path, n := range sc.sentryWakeups {
+		if n != 0 {
+			sentryWakeups.IncrementBy(uint64(n), sentryWakeupFields[path])
+			sc.sentryWakeups[path] = 0
+		}
+	}
+}
+
+// recordContextQueueDepth adds a sample of the depth of a context queue.
+func recordContextQueueDepth(depth uint32) {
+	contextQueueDepth.Increment(contextQueueDepthFields[min(bits.Len32(depth), contextQueueDepthBuckets-1)])
+}
+
+// recordFastPathToggle counts a change of the stub (stub=true) or Sentry fast
+// path.
+func recordFastPathToggle(stub, enabled bool) {
+	side := fastPathSideFields[1]
+	if stub {
+		side = fastPathSideFields[0]
+	}
+	toggle := fastPathToggleFields[1]
+	if enabled {
+		toggle = fastPathToggleFields[0]
+	}
+	fastPathToggles.Increment(side, toggle)
+}
+
+// Syscall patching metrics.
+//
+// The stub replaces common syscall instruction sequences in application code
+// with jumps to trampolines (see the usertrap package), so that syscalls made
+// from them avoid the seccomp signal. The share of syscalls that enter the
+// Sentry from patched sites is the hit rate of syscall patching. Syscalls
+// that trap through the signal from sites that match a pattern are patched
+// right away, so most of the remaining ones come from sites that don't match
+// any pattern.
+
+// syscallEntryPath is how a syscall entered the Sentry.
+type syscallEntryPath int
+
+const (
+	// syscallEntryPatched is a syscall made from a patched site.
+	syscallEntryPatched syscallEntryPath = iota
+	// syscallEntryPatchable is a syscall that trapped through the seccomp
+	// signal from a site that matches a pattern, and is going to be
+	// patched.
+	syscallEntryPatchable
+	// syscallEntryUnpatchable is a syscall that trapped through the
+	// seccomp signal from a site that doesn't match any pattern.
+	syscallEntryUnpatchable
+
+	numSyscallEntryPaths
+)
+
+var (
+	syscallEntryPathFields = [numSyscallEntryPaths]*metric.FieldValue{
+		syscallEntryPatched:     &metric.FieldValue{Value: "patched"},
+		syscallEntryPatchable:   &metric.FieldValue{Value: "patchable"},
+		syscallEntryUnpatchable: &metric.FieldValue{Value: "unpatchable"},
+	}
+	syscallEntriesByPath = metric.MustCreateNewUint64Metric("/systrap/syscall_entries", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of syscalls by whether they entered the Sentry from a patched syscall site, or through the seccomp signal from a site that can or can't be patched.",
+		Fields:      []metric.Field{metric.NewField("path", syscallEntryPathFields[:]...)},
+	})
+
+	// syscallPatchResultFields are the field values of syscallPatches by
+	// the outcome of usertrap.State.PatchSyscall. PatchNone isn't counted.
+	syscallPatchResultFields = make(map[usertrap.PatchResult]*metric.FieldValue)
+	syscallPatches           = metric.MustCreateNewUint64Metric("/systrap/syscall_patches", metric.Uint64Metadata{
+		Cumulative:  true,
+		Description: "Number of attempts to patch a syscall site, by the instruction pattern that was patched, or the reason why the site wasn't patched.",
+		Fields:      []metric.Field{metric.NewField("result", newSyscallPatchResultFields()...)},
+	})
+)
+
+// newSyscallPatchResultFields creates the field values of syscallPatches.
+func newSyscallPatchResultFields() []*metric.FieldValue {
+	var values []*metric.FieldValue
+	for _, r := range []usertrap.PatchResult{
+		usertrap.PatchedMovEAX,
+		usertrap.PatchedMovRAX,
+		usertrap.PatchSkippedTraced,
+		usertrap.PatchFailedTableFull,
+		usertrap.PatchFailed,
+	} {
+		f := &metric.FieldValue{Value: r.String()}
+		syscallPatchResultFields[r] = f
+		values = append(values, f)
+	}
+	return values
+}
+
+// recordSyscallEntry counts a syscall that entered the Sentry in ctx. The
+// counts are kept in ctx and added to the metric periodically, so that
+// syscalls from different CPUs don't contend on the metric.
+func (sc *sharedContext) recordSyscallEntry(path syscallEntryPath) {
+	sc.syscallEntries[path]++
+}
+
+// flushSyscallEntries adds the syscalls counted in sc to the metric.
+func (sc *sharedContext) flushSyscallEntries() {
+	for path, n := range sc.syscallEntries {
+		if n != 0 {
+			syscallEntriesByPath.IncrementBy(uint64(n), syscallEntryPathFields[path])
+			sc.syscallEntries[path] = 0
+		}
+	}
+}
+
+// recordSyscallPatch counts the result of an attempt to patch a syscall site.
+func recordSyscallPatch(r usertrap.PatchResult) {
+	if f, ok := syscallPatchResultFields[r]; ok {
+		syscallPatches.Increment(f)
+	}
+}
+
+// Syscall sampling.
+//
+// In builds with the systrap_profiling tag, stub threads record the number of
+// each syscall that they handle, including the ones that they answer without
+// switching to the Sentry, in a ring in their sysmsg.Msg. When the trap latency
+// histograms of a stub thread are flushed, the new entries of its ring are
+// added to the syscall table of its subprocess, and the syscalls sampled most
+// often are logged when the subprocess is released. Entries that are
+// overwritten before the Sentry reads them are lost, so the counts are only
+// meaningful relative to each other.
+
+const (
+	// maxSampledSyscall is the number of syscall numbers that are counted
+	// separately in a syscallSampleTable. Larger ones are only invalid or
+	// x32 syscalls, and are counted together.
+	maxSampledSyscall = 1024
+
+	// syscallSampleTopN is the number of syscalls that are logged for each
+	// subprocess.
+	syscallSampleTopN = 16
+)
+
+// syscallSampleTable counts the syscall samples of a subprocess by syscall
+// number.
+type syscallSampleTable struct {
+	mu     sync.Mutex
+	counts [maxSampledSyscall + 1]uint64
+}
+
+// newSyscallSampleTable returns a new syscall table if syscall sampling is
+// enabled, and nil otherwise.
+func newSyscallSampleTable() *syscallSampleTable {
+	if !syscallSampling {
+		return nil
+	}
+	return &syscallSampleTable{}
+}
+
+// reset clears the counts of t, if t isn't nil.
+func (t *syscallSampleTable) reset() {
+	if t == nil {
+		return
+	}
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	t.counts = [maxSampledSyscall + 1]uint64{}
+}
+
+// flushSyscallSamples adds the new entries in the syscall sample ring of the
+// stub thread to t. p.trapLatencies.mu must be locked.
+func (p *sysmsgThread) flushSyscallSamples(t *syscallSampleTable) {
+	flushed := &p.trapLatencies.syscallSamples
+	head := atomic.LoadUint32(&p.msg.SyscallSamplesHead)
+	start := *flushed
+	if head-start > sysmsg.SyscallSampleRingLen {
+		start = head - sysmsg.SyscallSampleRingLen
+	}
+	var samples [sysmsg.SyscallSampleRingLen]uint32
+	n := 0
+	for i := start; i != head; i++ {
+		samples[n] = atomic.LoadUint32(&p.msg.SyscallSamples[i%sysmsg.SyscallSampleRingLen])
+		n++
+	}
+	// The stub thread may have overwritten the oldest entries while they
+	// were read.
+	skip := 0
+	if d := atomic.LoadUint32(&p.msg.SyscallSamplesHead) - start; d > sysmsg.SyscallSampleRingLen {
+		skip = min(int(d-sysmsg.SyscallSampleRingLen), n)
+	}
+	*flushed = head
+
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	for _, sysno := range samples[skip:n] {
+		t.counts[min(sysno, maxSampledSyscall)]++
+	}
+}
+
+// logSyscallSamples logs the syscalls sampled most often in the subprocess,
+// and resets its syscall table.
+func (s *subprocess) logSyscallSamples() {
+	t := s.syscallSamples
+	if t == nil {
+		return
+	}
+	s.sysmsgThreadsMu.RLock()
+	for _, p := range s.sysmsgThreads {
+		p.flushTrapLatencies()
+	}
+	s.sysmsgThreadsMu.RUnlock()
+
+	t.mu.Lock()
+	counts := t.counts
+	t.counts = [maxSampledSyscall + 1]uint64{}
+	t.mu.Unlock()
+
+	var total uint64
+	sysnos := make([]int, 0, len(counts))
+	for sysno, n := range counts {
+		if n != 0 {
+			total += n
+			sysnos = append(sysnos, sysno)
+		}
+	}
+	if total == 0 {
+		return
+	}
+	sort.Slice(sysnos, func(i, j int) bool {
+		return counts[sysnos[i]] > counts[sysnos[j]]
+	})
+	var b strings.Builder
+	for i, sysno := range sysnos[:min(len(sysnos), syscallSampleTopN)] {
+		if i != 0 {
+			b.WriteString(", ")
+		}
+		if sysno == maxSampledSyscall {
+			b.WriteString("other")
+		} else {
+			b.WriteString(strconv.Itoa(sysno))
+		}
+		fmt.Fprintf(&b, ": %d (%.1f%%)", counts[sysno], float64(counts[sysno])*100/float64(total))
+	}
+	var pid int32
+	if s.syscallThread != nil {
+		pid = s.syscallThread.thread.tgid
+	}
+	log.Infof("Syscalls sampled most often in stub process %d (%d samples): %s", pid, total, b.String())
 }
 
 // When a measurement period ends, the latencies are used to determine the fast
@@ -332,9 +795,11 @@ func (s *fastPathState) park() {
 	// it's set unconditionally.
 	if s.sentryFastPathEnabled.Load() {
 		s.sentryFastPathEnabled.Store(false)
+		recordFastPathToggle(false, false)
 	}
 	if s.stubFastPathEnabled.Load() {
 		s.stubFastPathEnabled.Store(false)
+		recordFastPathToggle(true, false)
 	}
 	s.curState = sentryOffStubOff
 
@@ -397,6 +862,7 @@ func (s *fastPathState) stubFastPath() bool {
 func (s *fastPathState) enableSentryFP() {
 	s.sentryFastPathEnabled.Store(true)
 	numTimesSentryFastPathEnabled.Increment()
+	recordFastPathToggle(false, true)
 }
 
 // disableSentryFP returns true if the sentry fastpath was able to be disabled.
@@ -412,6 +878,7 @@ func (s *fastPathState) disableSentryFP() bool {
 	s.consecutiveSentryFPFailures = 0
 	s.sentryFastPathEnabled.Store(false)
 	numTimesSentryFastPathDisabled.Increment()
+	recordFastPathToggle(false, false)
 
 	s.sentryFPBackoff = getBackoff(s.sentryFPRecentFailures)
 	s.sentryFPRecentFailures = min(maxRecentFPFailures, s.sentryFPRecentFailures+1)
@@ -423,6 +890,7 @@ func (s *fastPathState) disableSentryFP() bool {
 func (s *fastPathState) enableStubFP() {
 	s.stubFastPathEnabled.Store(true)
 	numTimesStubFastPathEnabled.Increment()
+	recordFastPathToggle(true, true)
 }
 
 // disableStubFP returns true if the stub fastpath was able to be disabled.
@@ -438,6 +906,7 @@ func (s *fastPathState) disableStubFP() bool {
 	s.consecutiveStubFPFailures = 0
 	s.stubFastPathEnabled.Store(false)
 	numTimesStubFastPathDisabled.Increment()
+	recordFastPathToggle(true, false)
 
 	s.stubFPBackoff = getBackoff(s.stubFPRecentFailures)
 	s.stubFPRecentFailures = min(maxRecentFPFailures, s.stubFPRecentFailures+1)
@@ -674,6 +1143,11 @@ var (
 	numTimesStubFastPathEnabled    = SystrapProfiling.MustCreateNewUint64Metric("/systrap/numTimesStubFastPathEnabled", metric.Uint64Metadata{Cumulative: true})
 	numTimesStubKicked             = SystrapProfiling.MustCreateNewUint64Metric("/systrap/numTimesStubKicked", metric.Uint64Metadata{Cumulative: true})
 
+	// stubSpinBudgetNS is the spin budget of the stub thread that acked the
+	// last context, in nanoseconds. Stub threads pick their budget from
+	// their recent handoff latencies (see sysmsg_lib.c:update_spin_budget).
+	stubSpinBudgetNS = SystrapProfiling.MustCreateNewUint64Metric("/systrap/stubSpinBudgetNS", metric.Uint64Metadata{})
+
 	stubLatWithin1kUS   = SystrapProfiling.MustCreateNewUint64Metric("/systrap/stubLatWithin1kUS", metric.Uint64Metadata{Cumulative: true})
 	stubLatWithin5kUS   = SystrapProfiling.MustCreateNewUint64Metric("/systrap/stubLatWithin5kUS", metric.Uint64Metadata{Cumulative: true})
 	stubLatWithin10kUS  = SystrapProfiling.MustCreateNewUint64Metric("/systrap/stubLatWithin10kUS", metric.Uint64Metadata{Cumulative: true})
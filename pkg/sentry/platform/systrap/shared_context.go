@@ -63,6 +63,15 @@ type sharedContext struct {
 	kicked         bool
 	// The task associated with the context fell asleep.
 	sleeping bool
+	// switches is the number of times the context has been switched to.
+	switches uint32
+	// syscallEntries is the number of syscalls by how they entered the
+	// Sentry, since they were last added to the metric.
+	syscallEntries [numSyscallEntryPaths]uint32
+	// sentryWakeups is the number of times the context was handed back to
+	// the Sentry by how the task goroutine was woken up, since they were
+	// last added to the metric.
+	sentryWakeups [numSentryWakeupPaths]uint32
 }
 
 // String returns the ID of this shared context.
@@ -110,6 +119,8 @@ func (sc *sharedContext) release() {
 	if !sc.sleeping {
 		sc.subprocess.decAwakeContexts()
 	}
+	sc.flushSyscallEntries()
+	sc.flushSentryWakeups()
 	sc.subprocess.threadContextPool.Put(uint64(sc.contextID))
 	sc.subprocess.DecRef(sc.subprocess.release)
 }
@@ -227,6 +238,23 @@ func (sc *sharedContext) getStateChangedTimeDiff() cpuTicks {
 	return cpuTicks(now - changedAt)
 }
 
+// maxStubSpinBudgetShift bounds stub thread spin budgets to
+// deepSleepTimeout << maxStubSpinBudgetShift. It must match
+// SPIN_BUDGET_MAX_SHIFT in sysmsg/sysmsg_lib.c.
+const maxStubSpinBudgetShift = 1
+
+// getSpinBudget returns the spin budget of the stub thread that acked this
+// context, or 0 if the value in shared memory is out of range.
+//
+//go:nosplit
+func (sc *sharedContext) getSpinBudget() cpuTicks {
+	budget := atomic.LoadUint64(&sc.shared.SpinBudget)
+	if budget > deepSleepTimeout<<maxStubSpinBudgetShift {
+		return 0
+	}
+	return cpuTicks(budget)
+}
+
 func (sc *sharedContext) resetLatencyMeasures() {
 	atomic.StoreUint64(&sc.shared.AckedTime, ackReset)
 	atomic.StoreUint64(&sc.shared.StateChangedTime, stateChangedReset)
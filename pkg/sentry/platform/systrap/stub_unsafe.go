@@ -220,7 +220,14 @@ func stubInit() {
 
 	// Allocate thread context region
 	stubContextRegion = mapLen
-	stubContextRegionLen = sysmsg.AllocatedSizeofThreadContextStruct * (maxGuestContexts + 1)
+	stubContextRegionLen = sysmsg.AllocatedSizeofThreadContextStruct * uintptr(maxGuestContexts+1)
+	if stubHugePages {
+		// The region has to be hugepage-aligned in both the file and
+		// the stub address space to be mapped with huge pages, so
+		// reserve space to align it below.
+		stubContextRegionLen, _ = hostarch.HugePageRoundUp(stubContextRegionLen)
+		mapLen += hostarch.HugePageSize
+	}
 	mapLen, _ = hostarch.PageRoundUp(mapLen + stubContextRegionLen)
 
 	// Try a few times to avoid cases when new mappings are created.
@@ -285,6 +292,9 @@ func stubInit() {
 	if offset := stubSysmsgStack % sysmsg.PerThreadMemSize; offset != 0 {
 		stubSysmsgStack += sysmsg.PerThreadMemSize - offset
 	}
+	if stubHugePages {
+		stubContextRegion, _ = hostarch.HugePageRoundUp(stubContextRegion)
+	}
 	stubSysmsgRules += stubStart
 	stubSyscallRules += stubStart
 	targetSlice = unsafe.Slice((*byte)(unsafe.Pointer(stubSysmsgStart)), stubSysmsgLen)
@@ -307,6 +317,14 @@ func stubInit() {
 		p = (*uint64)(unsafe.Pointer(stubSysmsgStart + uintptr(sysmsg.Sighandler_blob_offset____export_disable_syscall_patching)))
 		*p = 1
 	}
+	if powerEfficientSpin {
+		p = (*uint64)(unsafe.Pointer(stubSysmsgStart + uintptr(sysmsg.Sighandler_blob_offset____export_spin_wait_mode)))
+		*p = 1
+	}
+	if syscallSampling {
+		p = (*uint64)(unsafe.Pointer(stubSysmsgStart + uintptr(sysmsg.Sighandler_blob_offset____export_syscall_sampling)))
+		*p = 1
+	}
 
 	prepareSeccompRules(stubSysmsgStart,
 		stubSysmsgRules, stubSysmsgRulesLen,
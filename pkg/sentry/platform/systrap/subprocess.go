@@ -112,10 +112,12 @@ var maxSysmsgThreads = 0
 // subprocess can create, including sysmsg threads.
 var maxChildThreads = 0
 
+// maxGuestContexts specifies the maximum number of task contexts that a
+// subprocess can handle. It is one less than the context queue capacity, and
+// set once by initContextQueueCapacity.
+var maxGuestContexts uint32 = defaultContextQueueEntries - 1
+
 const (
-	// maxGuestContexts specifies the maximum number of task contexts that a
-	// subprocess can handle.
-	maxGuestContexts = 4095
 	// invalidContextID specifies an invalid ID.
 	invalidContextID uint32 = 0xfefefefe
 	// invalidThreadID is used to indicate that a context is not being worked on by
@@ -159,6 +161,10 @@ type subprocess struct {
 	// trampolines.
 	usertrap *usertrap.State
 
+	// syscallSamples counts the syscalls sampled by stub threads. It is nil
+	// if syscall sampling is disabled.
+	syscallSamples *syscallSampleTable
+
 	syscallThreadMu sync.Mutex
 	syscallThread   *syscallThread
 
@@ -346,10 +352,16 @@ func (s *subprocess) handlePtraceSyscallRequest(req any) {
 func newSubprocess(create func() (*thread, error), memoryFile *pgalloc.MemoryFile, seccompNotify bool) (*subprocess, error) {
 	if sp := globalPool.fetchAvailable(); sp != nil {
 		sp.subprocessRefs.InitRefs()
+		// Don't carry over state of the previous address space.
 		sp.usertrap = usertrap.New()
+		sp.syscallSamples.reset()
 		return sp, nil
 	}
+	return createSubprocess(create, memoryFile, seccompNotify)
+}
 
+// createSubprocess creates a new subprocess. See newSubprocess.
+func createSubprocess(create func() (*thread, error), memoryFile *pgalloc.MemoryFile, seccompNotify bool) (*subprocess, error) {
 	// The following goroutine is responsible for creating the first traced
 	// thread, and responding to requests to make additional threads in the
 	// traced process. The process will be killed and reaped when the
@@ -361,9 +373,10 @@ func newSubprocess(create func() (*thread, error), memoryFile *pgalloc.MemoryFil
 		requests:          requests,
 		faultedContexts:   make(map[*platformContext]struct{}),
 		sysmsgStackPool:   pool.Pool{Start: 0, Limit: uint64(maxChildThreads)},
-		threadContextPool: pool.Pool{Start: 0, Limit: maxGuestContexts},
+		threadContextPool: pool.Pool{Start: 0, Limit: uint64(maxGuestContexts)},
 		memoryFile:        memoryFile,
 		sysmsgThreads:     make(map[uint32]*sysmsgThread),
+		syscallSamples:    newSyscallSampleTable(),
 	}
 	sp.subprocessRefs.InitRefs()
 	runtime.LockOSThread()
@@ -445,17 +458,17 @@ func (s *subprocess) mapSharedRegions() {
 	s.contextQueue = contextQueue
 
 	// Map thread context region into the sentry.
+	//
+	// The sentry touches the thread contexts of all running tasks, which
+	// can take many TLB misses with thousands of contexts, so the region
+	// is hugepage-backed if possible. stubContextRegion is hugepage-aligned
+	// in that case (see stubInit).
+	opts.Huge = stubHugePages
 	threadContextFR, err := s.memoryFile.Allocate(uint64(stubContextRegionLen), opts)
 	if err != nil {
 		panic("failed to allocate a new subprocess context memory region")
 	}
-	sentryThreadContextRegionAddr, errno := hostsyscall.RawSyscall6(
-		unix.SYS_MMAP,
-		0,
-		uintptr(threadContextFR.Length()),
-		unix.PROT_WRITE|unix.PROT_READ,
-		unix.MAP_SHARED|unix.MAP_FILE,
-		uintptr(s.memoryFile.FD()), uintptr(threadContextFR.Start))
+	sentryThreadContextRegionAddr, errno := mmapSharedRegionForSentry(s.memoryFile.FD(), threadContextFR, opts.Huge)
 	if errno != 0 {
 		panic(fmt.Sprintf("mmap failed for subprocess context memory region: %v", errno))
 	}
@@ -475,6 +488,59 @@ func (s *subprocess) mapSharedRegions() {
 	s.threadContextRegion = sentryThreadContextRegionAddr
 }
 
+// mmapSharedRegionForSentry maps fr of the memory file fd into the sentry. If
+// huge is true, the mapping is hugepage-aligned, so that the host can map a
+// hugepage-backed fr with huge pages.
+func mmapSharedRegionForSentry(fd int, fr memmap.FileRange, huge bool) (uintptr, unix.Errno) {
+	length := uintptr(fr.Length())
+	if !huge {
+		return hostsyscall.RawSyscall6(
+			unix.SYS_MMAP,
+			0,
+			length,
+			unix.PROT_WRITE|unix.PROT_READ,
+			unix.MAP_SHARED|unix.MAP_FILE,
+			uintptr(fd), uintptr(fr.Start))
+	}
+
+	// Reserve enough address space to align the mapping, and release what
+	// isn't used by it afterwards.
+	resvLen := length + hostarch.HugePageSize
+	resv, errno := hostsyscall.RawSyscall6(
+		unix.SYS_MMAP,
+		0,
+		resvLen,
+		unix.PROT_NONE,
+		unix.MAP_PRIVATE|unix.MAP_ANONYMOUS|unix.MAP_NORESERVE,
+		^uintptr(0), 0)
+	if errno != 0 {
+		return 0, errno
+	}
+	addr := hostarch.MustHugePageRoundUp(resv)
+	if _, errno := hostsyscall.RawSyscall6(
+		unix.SYS_MMAP,
+		addr,
+		length,
+		unix.PROT_WRITE|unix.PROT_READ,
+		unix.MAP_SHARED|unix.MAP_FILE|unix.MAP_FIXED,
+		uintptr(fd), uintptr(fr.Start)); errno != 0 {
+		hostsyscall.RawSyscall(unix.SYS_MUNMAP, resv, resvLen, 0)
+		return 0, errno
+	}
+	if head := addr - resv; head != 0 {
+		hostsyscall.RawSyscall(unix.SYS_MUNMAP, resv, head, 0)
+	}
+	if tail := resv + resvLen - (addr + length); tail != 0 {
+		hostsyscall.RawSyscall(unix.SYS_MUNMAP, addr+length, tail, 0)
+	}
+	// With shmem_enabled=advise, pages of fr that are first touched through
+	// this mapping are only hugepage-backed if it is advised too.
+	if errno := hostsyscall.RawSyscallErrno(unix.SYS_MADVISE, addr, length, unix.MADV_HUGEPAGE); errno != 0 {
+		log.Warningf("madvise(%#x, %d, MADV_HUGEPAGE) failed: %s", addr, length, errno)
+	}
+	return addr, 0
+}
+
 func (s *subprocess) mapPrivateRegions() {
 	_, err := s.syscallThread.syscall(
 		unix.SYS_MMAP,
@@ -512,6 +578,7 @@ func (s *subprocess) Release() {
 	if !s.alive() {
 		return
 	}
+	s.logSyscallSamples()
 	s.unmap()
 	s.DecRef(s.release)
 }
@@ -817,6 +884,7 @@ func (s *subprocess) switchToApp(c *platformContext, ac *arch.Context64) (isSysc
 	ctx := c.sharedContext
 	ctx.shared.Regs = regs.PtraceRegs
 	restoreArchSpecificState(ctx.shared, ac)
+	ctx.shared.Answers = c.syscallAnswers
 
 	// Check for interrupts, and ensure that future interrupts signal the context.
 	if !c.interrupt.Enable(c.sharedContext) {
@@ -869,9 +937,15 @@ func (s *subprocess) switchToApp(c *platformContext, ac *arch.Context64) (isSysc
 	// don't respect other signals.
 	c.signalInfo = ctx.shared.SignalInfo
 	ctxState := ctx.state()
-	if ctxState == sysmsg.ContextStateSyscallCanBePatched {
+	switch ctxState {
+	case sysmsg.ContextStateSyscallCanBePatched:
 		ctxState = sysmsg.ContextStateSyscall
 		shouldPatchSyscall = true
+		ctx.recordSyscallEntry(syscallEntryPatchable)
+	case sysmsg.ContextStateSyscall:
+		ctx.recordSyscallEntry(syscallEntryUnpatchable)
+	case sysmsg.ContextStateSyscallTrap:
+		ctx.recordSyscallEntry(syscallEntryPatched)
 	}
 	if ctxState == sysmsg.ContextStateSyscall || ctxState == sysmsg.ContextStateSyscallTrap {
 		if maybePatchSignalInfo(regs, &c.signalInfo) {
@@ -936,6 +1010,8 @@ func (s *subprocess) waitOnState(ctx *sharedContext) error {
 
 	ctx.recordLatency()
 	ctx.resetLatencyMeasures()
+	ctx.recordSentryWakeup(slowPath)
+	s.maybeFlushTrapLatencies(ctx)
 	ctx.enableSentryFastPath()
 
 	return nil
@@ -16,8 +16,25 @@ package systrap
 
 import (
 	"sync"
+
+	"gvisor.dev/gvisor/pkg/log"
+	"gvisor.dev/gvisor/pkg/sentry/pgalloc"
 )
 
+// maxWarmSubprocesses is the maximum of platform.Options.WarmStubProcesses.
+const maxWarmSubprocesses = 16
+
+// warmSubprocesses is the number of subprocesses that the pool tries to
+// keep available, so that new address spaces don't wait for a stub
+// process and its first sysmsg thread to be created. This matters for
+// workloads that fork and exec many short-lived processes, where a burst
+// of new address spaces would otherwise drain the pool. Each warm
+// subprocess is an idle host process, so it is 0 unless configured by
+// platform.Options.WarmStubProcesses.
+//
+// Like disableSyscallPatching, it applies to all Systrap instances.
+var warmSubprocesses int
+
 // subprocessPool exists to solve these distinct problems:
 //
 // 1) Subprocesses can't always be killed properly (see subprocess.Release).
@@ -34,6 +51,10 @@ type subprocessPool struct {
 	// available stores all subprocesses that are available for reuse.
 	// +checklocks:mu
 	available []*subprocess
+	// warming is the number of subprocesses that are being created by
+	// prewarm.
+	// +checklocks:mu
+	warming int
 }
 
 func (p *subprocessPool) markAvailable(s *subprocess) {
@@ -54,3 +75,33 @@ func (p *subprocessPool) fetchAvailable() *subprocess {
 	}
 	return nil
 }
+
+// prewarm creates subprocesses in the background until warmSubprocesses of
+// them are available. It does nothing if warmSubprocesses is 0.
+func (p *subprocessPool) prewarm(memoryFile *pgalloc.MemoryFile) {
+	p.mu.Lock()
+	n := warmSubprocesses - len(p.available) - p.warming
+	if n <= 0 {
+		p.mu.Unlock()
+		return
+	}
+	p.warming += n
+	p.mu.Unlock()
+
+	go func() { // S/R-SAFE: Platform-related.
+		for ; n > 0; n-- {
+			sp, err := createSubprocess(p.source.createStub, memoryFile, true)
+			if err != nil {
+				log.Warningf("Unable to create a warm stub process: %v", err)
+				break
+			}
+			p.mu.Lock()
+			p.warming--
+			p.available = append(p.available, sp)
+			p.mu.Unlock()
+		}
+		p.mu.Lock()
+		p.warming -= n
+		p.mu.Unlock()
+	}()
+}
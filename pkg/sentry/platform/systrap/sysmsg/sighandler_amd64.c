@@ -134,23 +134,70 @@ static void ptregs_to_gregs(ucontext_t *ucontext,
   ucontext->uc_mcontext.gregs[REG_CSGSFS] = csgsfs.csgsfs;
 }
 
-// get_fsbase writes the current thread's fsbase value to ptregs.
-static uint64_t get_fsbase(void) {
+// FS_BASE_UNKNOWN is stored in sysmsg->fs_base when the stub doesn't know the
+// fsbase of the current thread. It isn't a user address, so
+// arch_prctl(ARCH_SET_FS) never installs it.
+#define FS_BASE_UNKNOWN (~0UL)
+
+static __inline__ uint16_t get_fs_selector(void) {
+  uint16_t fs;
+  asm volatile("mov %%fs, %0" : "=r"(fs));
+  return fs;
+}
+
+// fs_base_nonzero returns true if the current thread's fsbase isn't 0, by
+// reading %fs:0, which faults if fsbase is 0 because the zero page is never
+// mapped when arch_state.fsbase_cache is set. It may also return false if
+// fsbase isn't 0 but %fs:0 isn't readable.
+static bool fs_base_nonzero(struct sysmsg *sysmsg) {
+  uint64_t val;
+  // fault_jump is set to the size of "mov %fs:(%rbx), %rax" which is 4 bytes.
+  // The fault handler resets it, which is how a fault is detected.
+  atomic_store(&sysmsg->fault_jump, 4);
+  asm volatile("movq %%fs:(%1), %0\n"
+               : "=a"(val)
+               : "b"(0UL)
+               : "cc", "memory");
+  bool ok = atomic_load(&sysmsg->fault_jump) != 0;
+  atomic_store(&sysmsg->fault_jump, 0);
+  return ok;
+}
+
+// get_fsbase returns the current thread's fsbase.
+//
+// Without FSGSBASE, reading fsbase takes an arch_prctl syscall, so the value
+// that set_fsbase last installed is used instead when it can be trusted.
+// Syscalls are handled by the Sentry, which passes back the new fsbase in
+// ptregs, so the application can only change fsbase without the stub knowing
+// by loading a selector into %fs:
+// - A non-null selector loads fsbase from its descriptor, so the cached value
+//   isn't trusted while the selector is non-null.
+// - A null selector clears fsbase on Intel CPUs and leaves it unchanged on
+//   AMD CPUs, where it may still be the base of a previous non-null selector.
+// Every descriptor that the application can load has a zero base (the Sentry
+// doesn't install TLS or LDT descriptors on the host), so with a null selector
+// fsbase is either the cached value or 0, which fs_base_nonzero tells apart.
+static uint64_t get_fsbase(struct sysmsg *sysmsg) {
   uint64_t fsbase;
   if (__export_arch_state.fsgsbase) {
     asm volatile("rdfsbase %0" : "=r"(fsbase));
-  } else {
-    int ret =
-        __syscall(__NR_arch_prctl, ARCH_GET_FS, (long)&fsbase, 0, 0, 0, 0);
-    if (ret) {
-      panic(STUB_ERROR_ARCH_PRCTL, ret);
-    }
+    return fsbase;
   }
+  fsbase = sysmsg->fs_base;
+  if (__export_arch_state.fsbase_cache && fsbase != FS_BASE_UNKNOWN &&
+      get_fs_selector() == 0 && (fsbase == 0 || fs_base_nonzero(sysmsg))) {
+    return fsbase;
+  }
+  int ret = __syscall(__NR_arch_prctl, ARCH_GET_FS, (long)&fsbase, 0, 0, 0, 0);
+  if (ret) {
+    panic(STUB_ERROR_ARCH_PRCTL, ret);
+  }
+  sysmsg->fs_base = fsbase;
   return fsbase;
 }
 
-// set_fsbase sets the current thread's fsbase to the fsbase value in ptregs.
-static void set_fsbase(uint64_t fsbase) {
+// set_fsbase sets the current thread's fsbase.
+static void set_fsbase(struct sysmsg *sysmsg, uint64_t fsbase) {
   if (__export_arch_state.fsgsbase) {
     asm volatile("wrfsbase %0" : : "r"(fsbase) : "memory");
   } else {
@@ -158,9 +205,21 @@ static void set_fsbase(uint64_t fsbase) {
     if (ret) {
       panic(STUB_ERROR_ARCH_PRCTL, ret);
     }
+    sysmsg->fs_base = fsbase;
   }
 }
 
+// read_app_code reads 8 bytes of application memory at addr. It returns 0 if
+// addr isn't readable.
+static uint64_t read_app_code(struct sysmsg *sysmsg, uint8_t *addr) {
+  uint64_t code = 0;
+  // fault_jump is set to the size of "mov (%rbx)" which is 3 bytes.
+  atomic_store(&sysmsg->fault_jump, 3);
+  asm volatile("movq (%1), %0\n" : "+a"(code) : "b"(addr) : "cc", "memory");
+  atomic_store(&sysmsg->fault_jump, 0);
+  return code;
+}
+
 // switch_context_amd64 is a wrapper of switch_context() which does checks
 // specific to amd64.
 struct thread_context *switch_context_amd64(
@@ -199,6 +258,85 @@ struct thread_context *switch_context_amd64(
 static void prep_fpstate_for_sigframe(void *buf, uint32_t user_size,
                                       bool use_xsave);
 
+// The size of the legacy region plus the XSAVE header of an XSAVE area.
+#define XSAVE_LEGACY_AND_HEADER_SIZE (512 + 64)
+// The offset of XSTATE_BV in an XSAVE area.
+#define XSAVE_XSTATE_BV_OFFSET 512
+// The first state component which is stored after the XSAVE header.
+#define XSTATE_FIRST_EXTENDED_COMPONENT 2
+
+// save_fpstate copies the FPU state from the signal frame into ctx->fpstate.
+//
+// With XSAVE, it only copies the state components that are marked as in use
+// in XSTATE_BV. The others are in their initial configuration and XRSTOR
+// ignores their bytes in memory, so ctx->fpstate can keep stale bytes there.
+// This is the same layout that XSAVEOPT leaves in ctx->fpstate in the
+// syshandler path. Most syscalls are made with the AVX and AVX-512 state in
+// the initial configuration, so this avoids copying up to ~2.5KB per trap.
+static void save_fpstate(struct thread_context *ctx, uint8_t *fpregs) {
+  uint32_t fp_len = __export_arch_state.fp_len;
+
+  if (__export_arch_state.xsave_mode == XSAVE_MODE_FXSAVE ||
+      fp_len < XSAVE_LEGACY_AND_HEADER_SIZE) {
+    memcpy(ctx->fpstate, fpregs, fp_len);
+    return;
+  }
+
+  memcpy(ctx->fpstate, fpregs, XSAVE_LEGACY_AND_HEADER_SIZE);
+  uint64_t xstate_bv = *(uint64_t *)(fpregs + XSAVE_XSTATE_BV_OFFSET);
+  xstate_bv >>= XSTATE_FIRST_EXTENDED_COMPONENT;
+  for (int i = XSTATE_FIRST_EXTENDED_COMPONENT;
+       xstate_bv != 0 && i < XSTATE_MAX_COMPONENTS; i++, xstate_bv >>= 1) {
+    if ((xstate_bv & 1) == 0) continue;
+    struct xstate_component *c = &__export_arch_state.xstate[i];
+    if (c->size == 0) {
+      // The component location is unknown, so fall back to a full copy.
+      memcpy(ctx->fpstate, fpregs, fp_len);
+      return;
+    }
+    memcpy(ctx->fpstate + c->offset, fpregs + c->offset, c->size);
+  }
+}
+
+#define VSYSCALL_ADDR 0xffffffffff600000UL
+#define VSYSCALL_ENTRY_SIZE 0x400
+
+// write_app_word writes val to 8 bytes of application memory at addr. It
+// returns false if addr isn't writable.
+static bool write_app_word(struct sysmsg *sysmsg, uint64_t *addr,
+                           uint64_t val) {
+  // fault_jump is set to the size of "mov %rax, (%rbx)" which is 3 bytes. The
+  // fault handler resets it, which is how a fault is detected.
+  atomic_store(&sysmsg->fault_jump, 3);
+  asm volatile("movq %0, (%1)\n" : : "a"(val), "b"(addr) : "cc", "memory");
+  bool ok = atomic_load(&sysmsg->fault_jump) != 0;
+  atomic_store(&sysmsg->fault_jump, 0);
+  return ok;
+}
+
+// vsyscall_to_vdso redirects a vsyscall to the VDSO function that implements
+// it, if the Sentry allows it for ctx. It returns false if the vsyscall has to
+// be handled by the Sentry.
+//
+// The host kernel has already emulated the return from the vsyscall when it
+// sends SIGSYS: RIP is the caller's return address, and RSP is above it. The
+// return address is pushed again for the VDSO function to return to.
+static bool vsyscall_to_vdso(struct sysmsg *sysmsg, struct thread_context *ctx,
+                             siginfo_t *siginfo, ucontext_t *ucontext) {
+  uint64_t addr = (uint64_t)siginfo->si_call_addr;
+  if (addr < VSYSCALL_ADDR || addr % VSYSCALL_ENTRY_SIZE != 0) return false;
+  uint64_t i = (addr - VSYSCALL_ADDR) / VSYSCALL_ENTRY_SIZE;
+  if (i >= VSYSCALLS || !ctx->answers.valid) return false;
+  uint64_t target = ctx->answers.vsyscall_targets[i];
+  if (target == 0) return false;
+  greg_t *gregs = ucontext->uc_mcontext.gregs;
+  uint64_t *sp = (uint64_t *)(gregs[REG_RSP] - 8);
+  if (!write_app_word(sysmsg, sp, gregs[REG_RIP])) return false;
+  gregs[REG_RSP] = (greg_t)sp;
+  gregs[REG_RIP] = target;
+  return true;
+}
+
 void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
   ucontext_t *ucontext = _ucontext;
   void *sp = sysmsg_sp();
@@ -213,6 +351,8 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
   if (thread_state == THREAD_STATE_INITIALIZING) {
     // Find a new context and exit to restore it.
     init_new_thread();
+    // fsbase of a new thread is inherited from the thread that created it.
+    sysmsg->fs_base = FS_BASE_UNKNOWN;
     goto init;
   }
 
@@ -231,7 +371,11 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
     return;
   }
 
-  fs_base = get_fsbase();
+  if (signo == SIGSYS && vsyscall_to_vdso(sysmsg, ctx, siginfo, ucontext)) {
+    return;
+  }
+
+  fs_base = get_fsbase(sysmsg);
 
   ctx->signo = signo;
   ctx->siginfo = *siginfo;
@@ -243,8 +387,7 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
     ctx->ptregs.fs_base = fs_base;
     ctx->err = 0;
     gregs_to_ptregs(ucontext, &ctx->ptregs);
-    memcpy(ctx->fpstate, (uint8_t *)ucontext->uc_mcontext.fpregs,
-           __export_arch_state.fp_len);
+    save_fpstate(ctx, (uint8_t *)ucontext->uc_mcontext.fpregs);
   }
 
   switch (signo) {
@@ -270,22 +413,25 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
         // twice. If the second copy will not contain the FAULT_OPCODE, this
         // will mean that the first copy is in the consistent state.
         for (int i = 0; i < 2; i++) {
-          // fault_jump is set to the size of "mov (%rbx)" which is 3 bytes.
-          atomic_store(&sysmsg->fault_jump, 3);
-          asm volatile("movq (%1), %0\n"
-                       : "=a"(syscall_code_int[i])
-                       : "b"(rip - 8)
-                       : "cc", "memory");
-          atomic_store(&sysmsg->fault_jump, 0);
+          syscall_code_int[i] = read_app_code(sysmsg, rip - 8);
         }
         // The mov instruction is 5 bytes:  b8 <sysno, 4 bytes>.
         // The syscall instruction is 2 bytes: 0f 05.
         uint32_t sysno = *(uint32_t *)(syscall_code + 2);
         int need_trap = *(syscall_code + 6) == 0x0f &&  // syscall
                         *(syscall_code + 7) == 0x05 &&
-                        *(syscall_code + 1) == 0xb8 &&  // mov sysno, %eax
                         sysno == siginfo->si_syscall &&
                         sysno == ctx->ptregs.rax;
+        if (*(syscall_code + 1) == 0xb8) {  // mov sysno, %eax
+          // need_trap stays as is.
+        } else if (*(syscall_code + 0) == 0xc7 && *(syscall_code + 1) == 0xc0) {
+          // The Go assembler emits "mov sysno, %rax" which is 7 bytes:
+          // 48 c7 c0 <sysno, 4 bytes>. The REX prefix is the 9th byte before
+          // rip.
+          need_trap = need_trap && read_app_code(sysmsg, rip - 16) >> 56 == 0x48;
+        } else {
+          need_trap = 0;
+        }
 
         // Restart syscall if it has been patched by another thread.  When a
         // syscall instruction set is replaced on a function call, all threads
@@ -299,7 +445,13 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
         // case, this means that another thread has been patched this syscall
         // and we need to restart it.
         if (syscall_opcode == FAULT_OPCODE) {
-          ucontext->uc_mcontext.gregs[REG_RIP] -= 7;
+          // The byte at rip - 7 is the opcode of "mov sysno, %eax" or the
+          // first byte of the jmp that replaced it. For "mov sysno, %rax",
+          // it is the ModRM byte of either instruction and the patch starts
+          // two bytes earlier.
+          uint8_t b = *(syscall_code + 1);
+          ucontext->uc_mcontext.gregs[REG_RIP] -=
+              (b == 0xc0 || b == 0x25) ? 9 : 7;
           return;
         }
 
@@ -310,6 +462,7 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
       }
       ctx->ptregs.orig_rax = ctx->ptregs.rax;
       ctx->ptregs.rax = (unsigned long)-ENOSYS;
+      record_syscall(sysmsg, ctx->ptregs.orig_rax);
       if (siginfo->si_arch != AUDIT_ARCH_X86_64)
         // gVisor doesn't support x32 system calls, so let's change the syscall
         // number so that it returns ENOSYS.
@@ -338,7 +491,7 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
 init:
   ctx = switch_context_amd64(sysmsg, ctx, ctx_state);
   if (fs_base != ctx->ptregs.fs_base) {
-    set_fsbase(ctx->ptregs.fs_base);
+    set_fsbase(sysmsg, ctx->ptregs.fs_base);
   }
 
   if (atomic_load(&ctx->fpstate_changed)) {
@@ -348,6 +501,41 @@ init:
     ucontext->uc_mcontext.fpregs = (void *)ctx->fpstate;
   }
   ptregs_to_gregs(ucontext, &ctx->ptregs);
+  record_context_resume(sysmsg, ctx);
+}
+
+// answer_syscall sets the return value of syscalls which can be answered
+// from ctx->answers. It returns false if the syscall has to be handled by the
+// sentry.
+static bool answer_syscall(struct thread_context *ctx) {
+  struct syscall_answers *a = &ctx->answers;
+  long ret;
+
+  if (!a->valid) return false;
+  switch (ctx->ptregs.rax) {
+    case __NR_getpid:
+      ret = a->pid;
+      break;
+    case __NR_gettid:
+      ret = a->tid;
+      break;
+    case __NR_getuid:
+      ret = a->uid;
+      break;
+    case __NR_geteuid:
+      ret = a->euid;
+      break;
+    case __NR_getgid:
+      ret = a->gid;
+      break;
+    case __NR_getegid:
+      ret = a->egid;
+      break;
+    default:
+      return false;
+  }
+  ctx->ptregs.rax = ret;
+  return true;
 }
 
 void __syshandler() {
@@ -361,23 +549,39 @@ void __syshandler() {
   struct thread_context *ctx = sysmsg->context;
 
   enum context_state ctx_state = CONTEXT_STATE_SYSCALL_TRAP;
-  ctx->signo = SIGSYS;
-  ctx->siginfo.si_addr = 0;
-  ctx->siginfo.si_syscall = ctx->ptregs.rax;
-  ctx->ptregs.rax = (unsigned long)-ENOSYS;
+  atomic_store(&ctx->fpstate_changed, 0);
+  record_syscall(sysmsg, ctx->ptregs.rax);
+  if (answer_syscall(ctx)) {
+    // Same as in switch_context_amd64: once the state is THREAD_STATE_NONE,
+    // interrupts are delivered by SIGCHLD, but an interrupt that came before
+    // that has to be reported to the sentry.
+    atomic_store(&sysmsg->state, THREAD_STATE_NONE);
+    if (atomic_load(&ctx->interrupt) == 0) return;
+    atomic_store(&sysmsg->state, THREAD_STATE_PREP);
+    atomic_store(&ctx->interrupt, 0);
+    ctx_state = CONTEXT_STATE_FAULT;
+    ctx->signo = SIGCHLD;
+    ctx->siginfo.si_signo = SIGCHLD;
+    ctx->ptregs.orig_rax = -1;
+  } else {
+    ctx->signo = SIGSYS;
+    ctx->siginfo.si_addr = 0;
+    ctx->siginfo.si_syscall = ctx->ptregs.rax;
+    ctx->ptregs.rax = (unsigned long)-ENOSYS;
+  }
 
-  long fs_base = get_fsbase();
+  long fs_base = get_fsbase(sysmsg);
   ctx->ptregs.fs_base = fs_base;
 
-  atomic_store(&ctx->fpstate_changed, 0);
   ctx = switch_context_amd64(sysmsg, ctx, ctx_state);
   // switch_context_amd64 changed sysmsg->state to THREAD_STATE_NONE, so we can
   // only resume the current process, all other actions are
   // prohibited after this point.
 
   if (fs_base != ctx->ptregs.fs_base) {
-    set_fsbase(ctx->ptregs.fs_base);
+    set_fsbase(sysmsg, ctx->ptregs.fs_base);
   }
+  record_context_resume(sysmsg, ctx);
 }
 
 // asm_restore_state is implemented in syshandler_amd64.S
@@ -386,7 +590,7 @@ void asm_restore_state();
 // On x86 restore_state jumps straight to user code and does not return.
 void restore_state(struct sysmsg *sysmsg, struct thread_context *ctx,
                    void *unused) {
-  set_fsbase(ctx->ptregs.fs_base);
+  set_fsbase(sysmsg, ctx->ptregs.fs_base);
   asm_restore_state();
 }
 
@@ -20,6 +20,7 @@
 #include <linux/futex.h>
 #include <linux/unistd.h>
 #include <signal.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -93,6 +94,66 @@ static void ptregs_to_gregs(ucontext_t *ucontext,
   ucontext->uc_mcontext.pstate = ptregs->pstate;
 }
 
+// sigframe_record returns the record with the given magic in the signal
+// frame, or NULL if there is none. Records in an extra_context, which the
+// kernel only uses for large SVE vector lengths, aren't searched.
+//
+// See: arch/arm64/include/uapi/asm/sigcontext.h
+static struct _aarch64_ctx *sigframe_record(ucontext_t *ucontext,
+                                            uint32_t magic) {
+  unsigned char *base = &ucontext->uc_mcontext.__reserved[0];
+  size_t offset = 0;
+  while (offset + sizeof(struct _aarch64_ctx) <=
+         sizeof(ucontext->uc_mcontext.__reserved)) {
+    struct _aarch64_ctx *head = (struct _aarch64_ctx *)(base + offset);
+    if (head->magic == magic) return head;
+    if (head->magic == 0 || head->magic == EXTRA_MAGIC || head->size == 0)
+      break;
+    offset += head->size;
+  }
+  return NULL;
+}
+
+// The Sentry only knows about the FPSIMD state, which takes the first fp_len
+// bytes of ctx->fpstate. If the SVE registers were live when the context
+// trapped, the stub saves the sve_context record of the signal frame after
+// it, so that the SVE state can be restored when the context is resumed on
+// another stub thread. Otherwise, the upper bits of the Z registers and the
+// P and FFR registers would be reset, as the kernel does on syscalls.
+//
+// The registers are only live after a fault, since the kernel discards them
+// on syscalls, so SIGSYS traps copy just the record header.
+static struct sve_context *saved_sve_context(struct thread_context *ctx) {
+  uint32_t offset = __export_arch_state.fp_len;
+  if (offset + sizeof(struct sve_context) > MAX_FPSTATE_LEN) return NULL;
+  return (struct sve_context *)(ctx->fpstate + offset);
+}
+
+static void save_sve_state(struct thread_context *ctx, ucontext_t *ucontext) {
+  struct sve_context *dst = saved_sve_context(ctx);
+  if (dst == NULL) return;
+
+  struct sve_context *sve =
+      (struct sve_context *)sigframe_record(ucontext, SVE_MAGIC);
+  if (sve == NULL || sve->head.size <= sizeof(struct sve_context) ||
+#ifdef SVE_SIG_FLAG_SM
+      // Streaming mode state goes with the SME records, which aren't saved.
+      (sve->flags & SVE_SIG_FLAG_SM) ||
+#endif
+      sve->head.size > MAX_FPSTATE_LEN - __export_arch_state.fp_len) {
+    dst->head.magic = 0;
+    return;
+  }
+  memcpy((uint8_t *)dst, (uint8_t *)sve, sve->head.size);
+}
+
+// drop_sve_state forgets the SVE state saved by save_sve_state. It must be
+// called when the Sentry changes the FP state.
+static void drop_sve_state(struct thread_context *ctx) {
+  struct sve_context *sve = saved_sve_context(ctx);
+  if (sve != NULL) sve->head.magic = 0;
+}
+
 void __export_start(struct sysmsg *sysmsg, void *_ucontext) {
   panic(0x11111111, 0);
 }
@@ -139,12 +200,15 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
   }
 
   memcpy(ctx->fpstate, fpStatePointer, kFpsimdContextSize);
+  save_sve_state(ctx, ucontext);
+  atomic_store(&ctx->fpstate_changed, 0);
   ctx->tls = get_tls();
   ctx->siginfo = *siginfo;
   ctx->err = 0;
   switch (signo) {
     case SIGSYS: {
       ctx_state = CONTEXT_STATE_SYSCALL;
+      record_syscall(sysmsg, ctx->ptregs.regs[8]);
       if (siginfo->si_arch != AUDIT_ARCH_AARCH64) {
         // gVisor doesn't support x32 system calls, so let's change the syscall
         // number so that it returns ENOSYS. The value added here is just a
@@ -155,16 +219,9 @@ void __export_sighandler(int signo, siginfo_t *siginfo, void *_ucontext) {
       break;
     }
     case SIGSEGV: {
-      unsigned char *base = &ucontext->uc_mcontext.__reserved[0];
-      size_t offset = 0;
-      while (1) {
-        struct _aarch64_ctx *head = (struct _aarch64_ctx *)(base + offset);
-        if (head->magic == ESR_MAGIC) {
-          ctx->err = ((struct esr_context *)head)->esr;
-          break;
-        }
-        if (head->magic == 0 || head->magic == EXTRA_MAGIC) break;
-        offset += head->size;
+      struct _aarch64_ctx *esr = sigframe_record(ucontext, ESR_MAGIC);
+      if (esr != NULL) {
+        ctx->err = ((struct esr_context *)esr)->esr;
       }
     }
     // fallthrough
@@ -196,9 +253,15 @@ init:
     }
   }
 
+  // fpstate_changed is reset when the context traps, so it is only set here if
+  // the Sentry has changed the FP state since.
+  if (atomic_load(&ctx->fpstate_changed)) {
+    drop_sve_state(ctx);
+  }
   if (old_ctx != ctx || ctx->last_thread_id != sysmsg->thread_id) {
     ctx->fpstate_changed = 1;
   }
+  record_context_resume(sysmsg, ctx);
   restore_state(sysmsg, ctx, _ucontext);
 }
 
@@ -212,9 +275,24 @@ void restore_state(struct sysmsg *sysmsg, struct thread_context *ctx,
   uint8_t *fpStatePointer = (uint8_t *)&fpctx->fpsr;
 
   if (atomic_load(&ctx->fpstate_changed)) {
+    // The kernel only accepts SVE state for the vector length of the current
+    // thread, so check it before the frame's records are overwritten.
+    struct sve_context *frame_sve =
+        (struct sve_context *)sigframe_record(ucontext, SVE_MAGIC);
+    struct sve_context *sve = saved_sve_context(ctx);
+    bool restore_sve =
+        sve != NULL && sve->head.magic == SVE_MAGIC &&
+        sve->head.size <= MAX_FPSTATE_LEN - __export_arch_state.fp_len &&
+        frame_sve != NULL && frame_sve->vl == sve->vl;
+
     memcpy(fpStatePointer, ctx->fpstate, __export_arch_state.fp_len);
-    fpctx[1].head.size = 0;
-    fpctx[1].head.magic = 0;
+    struct _aarch64_ctx *next = &fpctx[1].head;
+    if (restore_sve) {
+      memcpy((uint8_t *)next, (uint8_t *)sve, sve->head.size);
+      next = (struct _aarch64_ctx *)((uint8_t *)next + sve->head.size);
+    }
+    next->size = 0;
+    next->magic = 0;
   }
   ptregs_to_gregs(ucontext, &ctx->ptregs);
   set_tls(ctx->tls);
@@ -27,7 +27,6 @@ import (
 
 	"golang.org/x/sys/unix"
 	"gvisor.dev/gvisor/pkg/abi/linux"
-	"gvisor.dev/gvisor/pkg/hostarch"
 	"gvisor.dev/gvisor/pkg/sentry/platform"
 )
 
@@ -51,13 +50,14 @@ import (
 // |------------|
 // |   sysmsg   |
 // *------------*
+//
+// On hosts with 64KB pages, each stack is a single page and sysmsg takes the
+// last MsgSize bytes of the altstack page, so that the per-thread memory
+// doesn't grow with the page size more than required.
 const (
 	// MsgOffsetFromSharedStack is the offset of the Msg structure on
 	// the thread stack.
-	MsgOffsetFromSharedStack = PerThreadMemSize - hostarch.PageSize - PerThreadSharedStackOffset
-
-	// SpinningQueueMemSize is the size of a spinning queue memory region.
-	SpinningQueueMemSize = hostarch.PageSize
+	MsgOffsetFromSharedStack = PerThreadMemSize - MsgSize - PerThreadSharedStackOffset
 )
 
 // StackAddrToMsg returns an address of a sysmsg structure.
@@ -156,8 +156,67 @@ type Msg struct {
 	Debug uint64
 	// ThreadID is the ID of the sysmsg thread.
 	ThreadID uint32
+	// LastHandoffTime is the time when the sysmsg thread last gave a context
+	// back to the sentry.
+	LastHandoffTime uint64
+	// HandoffLatency is a moving average of the time between the sysmsg thread
+	// giving a context back to the sentry and picking up the next one.
+	HandoffLatency uint64
+	// SpinBudget is how long the sysmsg thread spins waiting for a context
+	// before it goes to sleep. It is derived from HandoffLatency, and zero
+	// means the default deep sleep timeout.
+	SpinBudget uint64
+	// FSBase is the fsbase that the stub last installed on the sysmsg thread,
+	// or an invalid value if it is unknown. It is only used on amd64 hosts
+	// without FSGSBASE.
+	FSBase uint64
+	// TrapToAckHist is a histogram of the time between a context trapping
+	// into the sentry and this thread picking it up from the context queue
+	// afterwards. Bucket i counts latencies in [2^i, 2^(i+1)) cputicks.
+	TrapToAckHist [TrapLatencyBuckets]uint32
+	// AckToResumeHist is a histogram of the time between this thread picking
+	// up a context from the context queue and resuming it.
+	AckToResumeHist [TrapLatencyBuckets]uint32
+	// SyscallSamplesHead is the number of syscalls that this thread has
+	// recorded in SyscallSamples.
+	SyscallSamplesHead uint32
+	// SyscallSamples is a ring of the numbers of the last syscalls handled by
+	// this thread. Syscall i is at index i % SyscallSampleRingLen. It is only
+	// written if syscall sampling is enabled.
+	SyscallSamples [SyscallSampleRingLen]uint32
+	// ContextPickups counts the contexts that this thread got from the
+	// context queue by ContextPickupPath.
+	ContextPickups [NumContextPickupPaths]uint32
 }
 
+// TrapLatencyBuckets is the number of buckets in Msg trap latency histograms.
+// The last bucket also counts all latencies longer than 2^TrapLatencyBuckets
+// cputicks.
+const TrapLatencyBuckets = 32
+
+// SyscallSampleRingLen is the number of entries in the Msg syscall sample ring.
+const SyscallSampleRingLen = 64
+
+// ContextPickupPath is how a sysmsg thread got a context from the context
+// queue.
+type ContextPickupPath int
+
+// Context pickup paths. They must match sysmsg.h:context_pickup_path.
+const (
+	// ContextPickupQueued means that the context was already queued when
+	// the thread looked for one.
+	ContextPickupQueued ContextPickupPath = iota
+	// ContextPickupFastPath means that the context was queued while the
+	// thread was spinning on the stub fast path.
+	ContextPickupFastPath
+	// ContextPickupWoken means that the context was queued after the thread
+	// stopped spinning to go to sleep.
+	ContextPickupWoken
+
+	// NumContextPickupPaths is the number of context pickup paths.
+	NumContextPickupPaths
+)
+
 // ContextState defines the reason the context has exited back to the sentry,
 // or ContextStateNone if running/ready-to-run.
 type ContextState uint32
@@ -260,6 +319,10 @@ type ThreadContext struct {
 	// goroutine used for this thread context is busy-polling for a response
 	// instead of using FUTEX_WAIT.
 	SentryFastPath uint32
+	// LastShard is the context queue shard of the sysmsg thread that last
+	// picked up the context. The sentry queues the context on the same shard
+	// so that it is resumed on the same NUMA node.
+	LastShard uint32
 	// AckedTime is used by sysmsg threads to signal to the sentry that this context
 	// has been picked up from the context queue and is actively being worked on.
 	// The stub thread puts down the timestamp at which it has started processing
@@ -276,6 +339,31 @@ type ThreadContext struct {
 	Debug uint64
 	// SigError is an error code that clarifies the nature of the signal.
 	SigError uint64
+	// SpinBudget is the spin budget of the sysmsg thread that last picked up
+	// the context (see Msg.SpinBudget). It is only used for metrics.
+	SpinBudget uint64
+	// TrapTime is the time when the context last trapped into the sentry.
+	// Unlike StateChangedTime, it isn't reset by the sentry.
+	TrapTime uint64
+	// Answers are the results of identity syscalls that the stub can return
+	// without switching to the sentry.
+	Answers SyscallAnswers
+}
+
+// SyscallAnswers is a mirror of platform.SyscallAnswers that is shared with
+// the stub thread.
+type SyscallAnswers struct {
+	Valid uint32
+	Pid   int32
+	Tid   int32
+	UID   uint32
+	EUID  uint32
+	GID   uint32
+	EGID  uint32
+	_     uint32
+	// VsyscallTargets are the addresses to which the stub redirects
+	// vsyscalls, or 0. See platform.SyscallAnswers.VsyscallTargets.
+	VsyscallTargets [platform.Vsyscalls]uint64
 }
 
 // StubError are values that represent known stub-thread failure modes.
@@ -322,6 +410,8 @@ func (c *ThreadContext) Init(initialThreadID uint32) {
 	c.SignalInfo = linux.SignalInfo{}
 	c.State = ContextStateNone
 	c.ThreadID = initialThreadID
+	c.TrapTime = 0
+	c.Answers = SyscallAnswers{}
 }
 
 // ConvertSysmsgErr converts m.Err to platform.ContextError.
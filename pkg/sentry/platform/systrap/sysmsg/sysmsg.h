@@ -23,10 +23,25 @@
 
 #if defined(__x86_64__)
 // LINT.IfChange
+// XSTATE_MAX_COMPONENTS is the number of XSAVE state components described in
+// arch_state.xstate.
+#define XSTATE_MAX_COMPONENTS 32
+
+// xstate_component is the location of an XSAVE state component in the
+// standard (non-compacted) XSAVE area. size is zero if the component is not
+// supported or lies outside of fp_len.
+struct xstate_component {
+  uint32_t offset;
+  uint32_t size;
+};
+
 struct arch_state {
   uint32_t xsave_mode;
   uint32_t fp_len;
   uint32_t fsgsbase;
+  // fsbase_cache is set if get_fsbase may use sysmsg->fs_base.
+  uint32_t fsbase_cache;
+  struct xstate_component xstate[XSTATE_MAX_COMPONENTS];
 };
 // LINT.ThenChange(sysmsg_amd64.go)
 #else
@@ -48,6 +63,27 @@ enum thread_state {
 
 struct thread_context;
 
+// TRAP_LATENCY_BUCKETS is the number of buckets in trap latency histograms.
+// Bucket i counts latencies in [2^i, 2^(i+1)) cputicks, and the last bucket
+// also counts all longer latencies.
+#define TRAP_LATENCY_BUCKETS 32
+
+// SYSCALL_SAMPLES is the number of entries in the syscall sample ring. It has
+// to be a power of two.
+#define SYSCALL_SAMPLES 64
+
+// context_pickup_path is how a sysmsg thread got a context from the context
+// queue. See sysmsg.go:ContextPickupPath.
+enum context_pickup_path {
+  // The context was already queued when the thread looked for one.
+  CONTEXT_PICKUP_QUEUED,
+  // The context was queued while the thread was spinning on the fast path.
+  CONTEXT_PICKUP_FAST_PATH,
+  // The context was queued after the thread stopped spinning to go to sleep.
+  CONTEXT_PICKUP_WOKEN,
+  CONTEXT_PICKUP_PATHS,
+};
+
 // sysmsg contains the current state of the sysmsg thread. See: sysmsg.go:Msg
 struct sysmsg {
   struct sysmsg *self;
@@ -67,6 +103,20 @@ struct sysmsg {
   int32_t err_line;
   uint64_t debug;
   uint32_t thread_id;
+  uint64_t last_handoff_time;
+  uint64_t handoff_latency;
+  uint64_t spin_budget;
+  // fs_base is the fsbase that the stub last installed on this thread. It is
+  // only used on amd64 hosts without FSGSBASE; see get_fsbase.
+  uint64_t fs_base;
+  // Trap latency histograms, see sysmsg.go:Msg.
+  uint32_t trap_to_ack_hist[TRAP_LATENCY_BUCKETS];
+  uint32_t ack_to_resume_hist[TRAP_LATENCY_BUCKETS];
+  // Syscall sample ring, see sysmsg.go:Msg.
+  uint32_t syscall_samples_head;
+  uint32_t syscall_samples[SYSCALL_SAMPLES];
+  // Context pickup counters by context_pickup_path, see sysmsg.go:Msg.
+  uint32_t context_pickups[CONTEXT_PICKUP_PATHS];
 };
 
 enum context_state {
@@ -79,8 +129,26 @@ enum context_state {
   CONTEXT_STATE_INVALID,
 };
 
+// VSYSCALLS is the number of entries in the vsyscall page. See
+// platform.Vsyscalls.
+#define VSYSCALLS 3
+
 // thread_context contains the current context of the sysmsg thread.
 // See sysmsg.go:SysThreadContext
+// syscall_answers contains results of identity syscalls which the stub can
+// return without switching to the sentry. See sysmsg.go:SyscallAnswers.
+struct syscall_answers {
+  uint32_t valid;
+  int32_t pid;
+  int32_t tid;
+  uint32_t uid;
+  uint32_t euid;
+  uint32_t gid;
+  uint32_t egid;
+  uint32_t unused;
+  uint64_t vsyscall_targets[VSYSCALLS];
+};
+
 struct thread_context {
   uint8_t fpstate[MAX_FPSTATE_LEN];
   uint64_t fpstate_changed;
@@ -95,11 +163,15 @@ struct thread_context {
   uint32_t thread_id;
   uint32_t last_thread_id;
   uint32_t sentry_fast_path;
+  uint32_t last_shard;
   uint64_t acked_time;
   uint64_t state_changed_time;
   uint64_t tls;
   uint64_t debug;
   uint64_t err;
+  uint64_t spin_budget;
+  uint64_t trap_time;
+  struct syscall_answers answers;
 };
 
 enum stub_error {
@@ -117,15 +189,19 @@ enum stub_error {
 #endif
 
 #if PAGE_SIZE == 65536
-#define PER_THREAD_MEM_SIZE (5 * PAGE_SIZE)
+// A single page is enough for each stack, so the sysmsg structure shares a
+// page with the signal stack.
+#define PER_THREAD_MEM_SIZE (4 * PAGE_SIZE)
+#define SPINNING_QUEUE_MEM_SIZE (PAGE_SIZE)
+#define SYSMSG_SIZE (4096)
 #else
 #define PER_THREAD_MEM_SIZE (8 * PAGE_SIZE)
+#define SPINNING_QUEUE_MEM_SIZE (5 * PAGE_SIZE)
+#define SYSMSG_SIZE (PAGE_SIZE)
 #endif
 
 #define GUARD_SIZE (PAGE_SIZE)
-#define MSG_OFFSET_FROM_START (PER_THREAD_MEM_SIZE - PAGE_SIZE)
-
-#define SPINNING_QUEUE_MEM_SIZE PAGE_SIZE
+#define MSG_OFFSET_FROM_START (PER_THREAD_MEM_SIZE - SYSMSG_SIZE)
 // LINT.ThenChange(sysmsg.go)
 
 #define FAULT_OPCODE 0x06  // "push %es" on x32 and invalid opcode on x64.
@@ -134,11 +210,11 @@ enum stub_error {
 #define __stringify(x...) __stringify_1(x)
 #define BUILD_BUG_ON(condition) ((void)sizeof(char[1 - 2 * !!(condition)]))
 
-extern uint64_t __export_pr_sched_core;
 extern uint64_t __export_deep_sleep_timeout;
 extern struct arch_state __export_arch_state;
 struct context_queue;
 extern struct context_queue *__export_context_queue_addr;
+extern uint64_t __export_syscall_sampling;
 
 // NOLINTBEGIN(runtime/int)
 static void *sysmsg_sp() {
@@ -193,6 +269,8 @@ void restore_state(struct sysmsg *sysmsg, struct thread_context *ctx,
 struct thread_context *switch_context(struct sysmsg *sysmsg,
                                       struct thread_context *ctx,
                                       enum context_state new_context_state);
+void record_context_resume(struct sysmsg *sysmsg, struct thread_context *ctx);
+void record_syscall(struct sysmsg *sysmsg, uint64_t sysno);
 
 int wait_state(struct sysmsg *sysmsg, enum thread_state new_thread_state);
 void init_new_thread(void);
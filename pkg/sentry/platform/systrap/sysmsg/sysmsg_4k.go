@@ -30,4 +30,11 @@ const (
 	// PerThreadSharedStackSize is the size of a per-thread stack region (16KB, includes stack + sysmsg).
 	PerThreadSharedStackSize   = 4 * hostarch.PageSize
 	PerThreadSharedStackOffset = 4 * hostarch.PageSize
+	// MsgSize is the size reserved for the sysmsg structure at the end of
+	// the shared stack region (4KB).
+	MsgSize = hostarch.PageSize
+
+	// SpinningQueueMemSize is the size of a spinning queue memory region
+	// (20KB, one cache line per queue slot).
+	SpinningQueueMemSize = 5 * hostarch.PageSize
 )
@@ -21,13 +21,24 @@ import (
 )
 
 const (
-	// PerThreadMemSize is the size of a per-thread memory region (320KB).
-	PerThreadMemSize = 5 * hostarch.PageSize
+	// PerThreadMemSize is the size of a per-thread memory region (256KB).
+	//
+	// Only the two stack pages are backed by memory, guard pages are
+	// not, so each stub thread uses 128KB.
+	PerThreadMemSize = 4 * hostarch.PageSize
 	// GuardSize is the size of an unmapped region before the signal stack (64KB).
 	GuardSize                   = hostarch.PageSize
 	PerThreadPrivateStackOffset = GuardSize
 	PerThreadPrivateStackSize   = 1 * hostarch.PageSize // 64KB (sufficient for syshandler private stack)
-	// PerThreadSharedStackSize is the size of a per-thread stack region (128KB, includes stack + sysmsg).
-	PerThreadSharedStackSize   = 2 * hostarch.PageSize
+	// PerThreadSharedStackSize is the size of a per-thread stack region (64KB, includes stack + sysmsg).
+	PerThreadSharedStackSize   = 1 * hostarch.PageSize
 	PerThreadSharedStackOffset = 3 * hostarch.PageSize
+	// MsgSize is the size reserved for the sysmsg structure at the end of
+	// the shared stack region (4KB). The signal stack gets the rest of the
+	// page.
+	MsgSize = 4 << 10
+
+	// SpinningQueueMemSize is the size of a spinning queue memory region
+	// (64KB, one cache line per queue slot).
+	SpinningQueueMemSize = hostarch.PageSize
 )
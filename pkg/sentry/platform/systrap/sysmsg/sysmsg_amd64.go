@@ -23,6 +23,8 @@ import (
 	"strings"
 
 	"gvisor.dev/gvisor/pkg/cpuid"
+	"gvisor.dev/gvisor/pkg/hostarch"
+	"gvisor.dev/gvisor/pkg/sentry/platform"
 )
 
 // SighandlerBlob contains the compiled code of the sysmsg signal handler.
@@ -36,6 +38,24 @@ type ArchState struct {
 	xsaveMode uint32
 	fpLen     uint32
 	fsgsbase  uint32
+	// fsbaseCache is set if the stub may use the fsbase it last installed
+	// instead of asking the host (see sighandler_amd64.c:get_fsbase). It
+	// relies on the zero page being unmapped.
+	fsbaseCache uint32
+	xstate      [xstateMaxComponents]xstateComponent
+}
+
+// xstateMaxComponents is the number of XSAVE state components described in
+// ArchState.xstate.
+const xstateMaxComponents = 32
+
+// xstateComponent is the location of an XSAVE state component in the standard
+// XSAVE area. The stub uses it to copy only the components that are in use
+// (see sighandler_amd64.c:save_fpstate).
+type xstateComponent struct {
+	offset uint32
+	// size is zero if the component isn't supported or doesn't fit in fpLen.
+	size uint32
 }
 
 // The linux kernel does not allow using xsavec from userspace, so we are limited
@@ -64,6 +84,16 @@ func (s *ArchState) Init() {
 
 	if fs.UseFSGSBASE() {
 		s.fsgsbase = 1
+	} else if platform.SystemMMapMinAddr() >= hostarch.PageSize {
+		s.fsbaseCache = 1
+	}
+
+	for i := range s.xstate {
+		s.xstate[i] = xstateComponent{}
+		offset, size := fs.ExtendedStateComponent(uint32(i))
+		if size != 0 && uint64(offset)+uint64(size) <= uint64(s.fpLen) {
+			s.xstate[i] = xstateComponent{offset: offset, size: size}
+		}
 	}
 }
 
@@ -77,6 +107,7 @@ func (s *ArchState) String() string {
 	fmt.Fprintf(&b, "sysmsg.ArchState{")
 	fmt.Fprintf(&b, " xsaveMode %d", s.xsaveMode)
 	fmt.Fprintf(&b, " fsgsbase %d", s.fsgsbase)
+	fmt.Fprintf(&b, " fsbaseCache %d", s.fsbaseCache)
 	fmt.Fprintf(&b, " fpLen %d", s.fpLen)
 	b.WriteString(" }")
 
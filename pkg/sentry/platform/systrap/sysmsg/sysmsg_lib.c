@@ -29,9 +29,19 @@
 // polling and fall asleep.
 uint64_t __export_deep_sleep_timeout;
 
+// __export_spin_wait_mode is set by the Sentry if stub threads waiting for a
+// context should wait for the context queue to be written to, rather than
+// poll it. See spin_wait.
+uint64_t __export_spin_wait_mode;
+
+// __export_syscall_sampling is set by the Sentry if stub threads should record
+// the numbers of syscalls that they handle. See record_syscall.
+uint64_t __export_syscall_sampling;
+
 // LINT.IfChange
-#define MAX_GUEST_CONTEXTS (4095)
-#define MAX_CONTEXT_QUEUE_ENTRIES (MAX_GUEST_CONTEXTS + 1)
+// MAX_CONTEXT_QUEUE_ENTRIES is the size of context queue ring buffers, and so
+// the maximum context queue capacity.
+#define MAX_CONTEXT_QUEUE_ENTRIES 32768
 #define INVALID_CONTEXT_ID 0xfefefefe
 #define INVALID_THREAD_ID 0xfefefefe
 
@@ -42,16 +52,25 @@ uint64_t __export_deep_sleep_timeout;
 
 #define CACHE_LINE_SIZE 64
 
-// See `systrap/context_queue.go` for the bye layout of this struct and the
+// MAX_CONTEXT_QUEUE_SHARDS is the maximum number of context queue shards.
+#define MAX_CONTEXT_QUEUE_SHARDS 4
+
+// See `systrap/context_queue.go` for the byte layout of these structs and the
 // semantics of the fields.
-struct context_queue {
+struct context_queue_shard {
   uint32_t end;
   uint8_t _pad_end[CACHE_LINE_SIZE - 4];
   uint32_t start;
   uint8_t _pad_start[CACHE_LINE_SIZE - 4];
+  uint64_t ringbuffer[MAX_CONTEXT_QUEUE_ENTRIES];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct context_queue {
   uint32_t fast_path_disabled;
   uint32_t num_awake_contexts;
-  uint8_t _pad_sentry_written[CACHE_LINE_SIZE - 8];
+  uint32_t num_shards;
+  uint32_t capacity;
+  uint8_t _pad_sentry_written[CACHE_LINE_SIZE - 16];
   uint32_t num_active_threads;
   uint32_t num_spinning_threads;
   uint8_t _pad_stub_written[CACHE_LINE_SIZE - 8];
@@ -60,21 +79,47 @@ struct context_queue {
   uint32_t num_active_contexts;
   uint32_t used_fast_path;
   uint8_t _pad_both_written[CACHE_LINE_SIZE - 8];
-  uint64_t ringbuffer[MAX_CONTEXT_QUEUE_ENTRIES];
+  struct context_queue_shard shards[MAX_CONTEXT_QUEUE_SHARDS];
 } __attribute__((aligned(CACHE_LINE_SIZE)));
 
 struct context_queue *__export_context_queue_addr;
 
 // LINT.ThenChange(../context_queue.go)
 
-uint32_t is_empty(struct context_queue *queue) {
-  return atomic_load(&queue->start) == atomic_load(&queue->end);
+// num_shards returns the number of context queue shards in use. The value is
+// set by the Sentry, but is clamped so that a corrupted value can't make stub
+// threads index out of bounds.
+static uint32_t num_shards(struct context_queue *queue) {
+  uint32_t n = atomic_load(&queue->num_shards);
+  if (n == 0 || n > MAX_CONTEXT_QUEUE_SHARDS) {
+    return 1;
+  }
+  return n;
 }
 
-int32_t queued_contexts(struct context_queue *queue) {
-  return (atomic_load(&queue->end) + MAX_CONTEXT_QUEUE_ENTRIES -
-          atomic_load(&queue->start)) %
-         MAX_CONTEXT_QUEUE_ENTRIES;
+// index_mask returns the mask of ring buffer indexes for the capacity of the
+// context queue. Like num_shards, it is clamped so that a corrupted capacity
+// can't make stub threads index out of bounds.
+static uint32_t index_mask(struct context_queue *queue) {
+  uint32_t n = atomic_load(&queue->capacity);
+  if (n == 0 || n > MAX_CONTEXT_QUEUE_ENTRIES || (n & (n - 1)) != 0) {
+    return MAX_CONTEXT_QUEUE_ENTRIES - 1;
+  }
+  return n - 1;
+}
+
+static uint32_t shard_is_empty(struct context_queue_shard *shard) {
+  return atomic_load(&shard->start) == atomic_load(&shard->end);
+}
+
+uint32_t is_empty(struct context_queue *queue) {
+  uint32_t n = num_shards(queue);
+  for (uint32_t i = 0; i < n; i++) {
+    if (!shard_is_empty(&queue->shards[i])) {
+      return 0;
+    }
+  }
+  return 1;
 }
 
 #if defined(__x86_64__)
@@ -85,6 +130,37 @@ static __inline__ unsigned long rdtsc(void) {
 }
 
 static __inline__ void spinloop(void) { asm("pause"); }
+
+// wait_for_write waits until *addr is written to or the TSC reaches deadline,
+// unless *addr already differs from val. It puts the core into the C0.1 state,
+// which frees its resources to the SMT sibling and wakes up in well under a
+// microsecond.
+//
+// The Sentry only sets __export_spin_wait_mode if the CPU supports WAITPKG.
+static __inline__ void wait_for_write(uint32_t *addr, uint32_t val,
+                                      unsigned long deadline) {
+  __asm__ __volatile__("umonitor %0" : : "r"(addr) : "memory");
+  // Re-check after arming the monitor, or a write that raced with it would be
+  // missed.
+  if (atomic_load(addr) != val) return;
+  // Bit 0 of the control register selects C0.1 rather than C0.2.
+  __asm__ __volatile__("umwait %%ecx"
+                       :
+                       : "c"(1), "a"((uint32_t)deadline),
+                         "d"((uint32_t)(deadline >> 32))
+                       : "cc", "memory");
+}
+
+// current_node returns the NUMA node of the current CPU. Linux stores it in
+// the upper 20 bits of IA32_TSC_AUX; see
+// arch/x86/entry/vdso/vma.c:vgetcpu_cpu_init().
+//
+// The Sentry only uses more than one shard when RDTSCP is available.
+static __inline__ uint32_t current_node(void) {
+  uint32_t lo, hi, aux;
+  __asm__ __volatile__("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux));
+  return aux >> 12;
+}
 #elif defined(__aarch64__)
 static __inline__ unsigned long rdtsc(void) {
   long val;
@@ -93,6 +169,25 @@ static __inline__ unsigned long rdtsc(void) {
 }
 
 static __inline__ void spinloop(void) { asm volatile("yield" : : : "memory"); }
+
+// wait_for_write waits until *addr is written to, unless it already differs
+// from val. The exclusive load arms the local monitor, and a write by another
+// CPU clears it, which generates the event that WFE waits for.
+//
+// There is no deadline: the wait is bounded by the event stream that Linux
+// configures on the generic timer (every 100us), so a thread may spin for up
+// to that long beyond its spin budget.
+static __inline__ void wait_for_write(uint32_t *addr, uint32_t val,
+                                      unsigned long deadline) {
+  uint32_t cur;
+  asm volatile("ldaxr %w0, [%1]" : "=r"(cur) : "r"(addr) : "memory");
+  if (cur != val) return;
+  asm volatile("wfe" : : : "memory");
+}
+
+// current_node returns the NUMA node of the current CPU. There is no cheap way
+// to read it on arm64, so the Sentry always uses one shard there.
+static __inline__ uint32_t current_node(void) { return 0; }
 #endif
 
 void *__export_context_region;
@@ -103,11 +198,39 @@ static struct thread_context *thread_context_addr(uint32_t tcid) {
                                        ALLOCATED_SIZEOF_THREAD_CONTEXT_STRUCT);
 }
 
+// memcpy is mostly used to copy the FPU state, which is a few kilobytes. The
+// stub is built with -mgeneral-regs-only, so SIMD registers can't be used.
+#if defined(__x86_64__)
 void memcpy(uint8_t *dest, uint8_t *src, size_t n) {
-  for (size_t i = 0; i < n; i += 1) {
-    dest[i] = src[i];
+  // rep movsb is the fastest way to copy larger buffers on CPUs with ERMS
+  // (Enhanced REP MOVSB), and it is still reasonable on older ones. The
+  // direction flag is cleared explicitly, as the stub doesn't rely on the
+  // state of application flags.
+  asm volatile("cld\n"
+               "rep movsb\n"
+               : "+D"(dest), "+S"(src), "+c"(n)
+               :
+               : "memory", "cc");
+}
+#elif defined(__aarch64__)
+void memcpy(uint8_t *dest, uint8_t *src, size_t n) {
+  // Copy 16 bytes at a time with a pair of general purpose registers.
+  // Unaligned accesses are allowed on normal memory.
+  while (n >= 16) {
+    uint64_t lo, hi;
+    asm volatile(
+        "ldp %0, %1, [%2], #16\n"
+        "stp %0, %1, [%3], #16\n"
+        : "=&r"(lo), "=&r"(hi), "+r"(src), "+r"(dest)
+        :
+        : "memory");
+    n -= 16;
+  }
+  for (; n > 0; n--) {
+    *dest++ = *src++;
   }
 }
+#endif
 
 // The spinning queue is a queue of spinning threads. It solves the
 // fragmentation problem. The idea is to minimize the number of threads
@@ -127,13 +250,23 @@ void memcpy(uint8_t *dest, uint8_t *src, size_t n) {
 // in order to mitigate rdtsc inaccuracies.
 #define MAX_RE_ENQUEUE 2
 
+// Each slot of the spinning queue takes a whole cache line, so that stub
+// threads that push and remove neighbouring entries don't false-share.
+struct spinning_queue_slot {
+  uint64_t start_time;
+  uint8_t num_times_re_enqueued;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
 struct spinning_queue {
+  // len and end are written by spinning_queue_push, start is written by
+  // spinning_queue_remove_first.
   uint32_t len;
-  uint32_t start;
   uint32_t end;
-  uint64_t start_times[SPINNING_QUEUE_SIZE];
-  uint8_t num_times_re_enqueued[SPINNING_QUEUE_SIZE];
-};
+  uint8_t _pad_push[CACHE_LINE_SIZE - 8];
+  uint32_t start;
+  uint8_t _pad_remove[CACHE_LINE_SIZE - 4];
+  struct spinning_queue_slot slots[SPINNING_QUEUE_SIZE];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
 
 struct spinning_queue *__export_spinning_queue_addr;
 
@@ -158,9 +291,9 @@ static bool spinning_queue_push(uint8_t re_enqueue_times) {
   end = atomic_add(&queue->end, 1);
 
   idx = end - 1;
-  atomic_store(&queue->num_times_re_enqueued[idx % SPINNING_QUEUE_SIZE],
-               re_enqueue_times);
-  atomic_store(&queue->start_times[idx % SPINNING_QUEUE_SIZE], rdtsc());
+  struct spinning_queue_slot *slot = &queue->slots[idx % SPINNING_QUEUE_SIZE];
+  atomic_store(&slot->num_times_re_enqueued, re_enqueue_times);
+  atomic_store(&slot->start_time, rdtsc());
   return true;
 }
 
@@ -188,18 +321,19 @@ static bool spinning_queue_remove_first(uint64_t timeout) {
   uint8_t re_enqueue = 0;
 
   while (1) {
-    uint32_t idx, qidx;
+    struct spinning_queue_slot *slot;
+    uint32_t idx;
 
     idx = atomic_load(&queue->start);
-    qidx = idx % SPINNING_QUEUE_SIZE;
-    ts = atomic_load(&queue->start_times[qidx]);
+    slot = &queue->slots[idx % SPINNING_QUEUE_SIZE];
+    ts = atomic_load(&slot->start_time);
 
     if (ts == 0) continue;
     if (rdtsc() - ts < timeout) return false;
     if (idx != atomic_load(&queue->start)) continue;  // Lose the race.
 
-    re_enqueue = atomic_load(&queue->num_times_re_enqueued[qidx]);
-    if (atomic_compare_exchange(&queue->start_times[qidx], &ts, 0)) {
+    re_enqueue = atomic_load(&slot->num_times_re_enqueued);
+    if (atomic_compare_exchange(&slot->start_time, &ts, 0)) {
       atomic_add(&queue->start, 1);
       break;
     }
@@ -210,22 +344,125 @@ static bool spinning_queue_remove_first(uint64_t timeout) {
   return !spinning_queue_push(re_enqueue + 1);
 }
 
-struct thread_context *queue_get_context(struct sysmsg *sysmsg) {
-  struct context_queue *queue = __export_context_queue_addr;
+// The spin budget of a stub thread is twice the moving average of its handoff
+// latency, i.e. the time from giving a context back to the Sentry to picking
+// up the next one. It is clamped to
+// [deep_sleep_timeout >> SPIN_BUDGET_MIN_SHIFT,
+//  deep_sleep_timeout << SPIN_BUDGET_MAX_SHIFT]. If the handoff latency is
+// above the upper bound, the thread would most likely fall asleep before the
+// next context arrives anyway, so it only spins for the lower bound.
+#define SPIN_BUDGET_MIN_SHIFT 3
+#define SPIN_BUDGET_MAX_SHIFT 1
+
+// HANDOFF_LATENCY_WEIGHT_SHIFT is the weight of a new sample in the moving
+// average of the handoff latency (1/8).
+#define HANDOFF_LATENCY_WEIGHT_SHIFT 3
+
+// spin_budget returns how long the current thread spins waiting for a context.
+static uint64_t spin_budget(struct sysmsg *sysmsg) {
+  uint64_t budget = sysmsg->spin_budget;
+  return budget ? budget : __export_deep_sleep_timeout;
+}
 
-  // Indexes should not jump when start or end are overflowed.
-  BUILD_BUG_ON(UINT32_MAX % MAX_CONTEXT_QUEUE_ENTRIES !=
-               MAX_CONTEXT_QUEUE_ENTRIES - 1);
+// update_spin_budget records the handoff latency of a context picked up at
+// `now` and recomputes the spin budget of the current thread.
+static void update_spin_budget(struct sysmsg *sysmsg, uint64_t now) {
+  uint64_t last = sysmsg->last_handoff_time;
+  if (last == 0 || now < last) return;
+
+  uint64_t latency = now - last;
+  uint64_t avg = sysmsg->handoff_latency;
+  if (avg == 0) {
+    avg = latency;
+  } else {
+    avg = avg - (avg >> HANDOFF_LATENCY_WEIGHT_SHIFT) +
+          (latency >> HANDOFF_LATENCY_WEIGHT_SHIFT);
+  }
+  sysmsg->handoff_latency = avg;
+
+  uint64_t min_budget = __export_deep_sleep_timeout >> SPIN_BUDGET_MIN_SHIFT;
+  uint64_t max_budget = __export_deep_sleep_timeout << SPIN_BUDGET_MAX_SHIFT;
+  uint64_t budget = avg * 2;
+  if (budget > max_budget || budget < min_budget) {
+    budget = min_budget;
+  }
+  sysmsg->spin_budget = budget;
+}
+
+// spin_wait is called by a thread spinning in get_context_fast between checks
+// of the context queue, and waits for end of the shard of the current NUMA node
+// to be written to, which is how the Sentry queues a context. A context
+// queued to another shard is only noticed once the wait times out, so the
+// wait is bounded by the minimum spin budget.
+static void spin_wait(struct context_queue *queue) {
+  uint32_t n = num_shards(queue);
+  uint32_t home = n == 1 ? 0 : current_node() % n;
+  struct context_queue_shard *shard = &queue->shards[home];
+  uint32_t start = atomic_load(&shard->start);
+
+  wait_for_write(&shard->end, start,
+                 rdtsc() + (__export_deep_sleep_timeout >>
+                            SPIN_BUDGET_MIN_SHIFT));
+}
+
+// record_trap_latency adds latency to a trap latency histogram. Each sysmsg
+// thread only updates its own histograms, so no atomic read-modify-write is
+// needed, but the values are stored atomically because the Sentry reads them
+// concurrently.
+static void record_trap_latency(uint32_t *hist, uint64_t latency) {
+  uint32_t bucket = 0;
+  if (latency != 0) {
+    bucket = 63 - __builtin_clzll(latency);
+  }
+  if (bucket >= TRAP_LATENCY_BUCKETS) {
+    bucket = TRAP_LATENCY_BUCKETS - 1;
+  }
+  atomic_store(&hist[bucket], atomic_load(&hist[bucket]) + 1);
+}
+
+// record_context_resume records the time between picking up ctx from the
+// context queue and returning to it. It is called right before the stub
+// thread resumes ctx.
+void record_context_resume(struct sysmsg *sysmsg, struct thread_context *ctx) {
+  uint64_t acked = atomic_load(&ctx->acked_time);
+  uint64_t now = rdtsc();
+  if (acked != 0 && now >= acked) {
+    record_trap_latency(sysmsg->ack_to_resume_hist, now - acked);
+  }
+}
+
+// record_syscall adds sysno to the syscall sample ring of the sysmsg thread if
+// syscall sampling is enabled. Only the sysmsg thread writes to its ring, and
+// the Sentry reads it concurrently, so the head is stored after the entry.
+void record_syscall(struct sysmsg *sysmsg, uint64_t sysno) {
+  if (!__export_syscall_sampling) return;
+  uint32_t head = sysmsg->syscall_samples_head;
+  atomic_store(&sysmsg->syscall_samples[head % SYSCALL_SAMPLES], sysno);
+  atomic_store(&sysmsg->syscall_samples_head, head + 1);
+}
+
+// record_context_pickup counts a context that the sysmsg thread got from the
+// context queue through path. Like the trap latency histograms, the counters
+// are only written by the sysmsg thread and read concurrently by the Sentry.
+static void record_context_pickup(struct sysmsg *sysmsg,
+                                  enum context_pickup_path path) {
+  atomic_store(&sysmsg->context_pickups[path],
+               atomic_load(&sysmsg->context_pickups[path]) + 1);
+}
 
-  while (!is_empty(queue)) {
-    uint64_t idx = atomic_load(&queue->start);
-    uint32_t next = idx % MAX_CONTEXT_QUEUE_ENTRIES;
-    uint64_t v = atomic_load(&queue->ringbuffer[next]);
+// shard_get_context takes a context from shard, if it has one.
+static struct thread_context *shard_get_context(
+    struct sysmsg *sysmsg, struct context_queue_shard *shard,
+    uint32_t home_shard, uint32_t mask) {
+  while (!shard_is_empty(shard)) {
+    uint64_t idx = atomic_load(&shard->start);
+    uint32_t next = idx & mask;
+    uint64_t v = atomic_load(&shard->ringbuffer[next]);
 
     // We need to check the index to be sure that a ring buffer hasn't been
     // recycled.
     if ((v >> CQ_INDEX_SHIFT) != idx) continue;
-    if (!atomic_compare_exchange(&queue->ringbuffer[next], &v,
+    if (!atomic_compare_exchange(&shard->ringbuffer[next], &v,
                                  INVALID_CONTEXT_ID)) {
       continue;
     }
@@ -233,19 +470,51 @@ struct thread_context *queue_get_context(struct sysmsg *sysmsg) {
     uint32_t context_id = v & CQ_CONTEXT_MASK;
     if (context_id == INVALID_CONTEXT_ID) continue;
 
-    atomic_add(&queue->start, 1);
-    if (context_id > MAX_GUEST_CONTEXTS) {
+    atomic_add(&shard->start, 1);
+    if (context_id > mask) {
       panic(STUB_ERROR_BAD_CONTEXT_ID, context_id);
     }
     struct thread_context *ctx = thread_context_addr(context_id);
     sysmsg->context = ctx;
-    atomic_store(&ctx->acked_time, rdtsc());
+    uint64_t now = rdtsc();
+    atomic_store(&ctx->acked_time, now);
+    update_spin_budget(sysmsg, now);
+    uint64_t trap_time = atomic_load(&ctx->trap_time);
+    if (trap_time != 0 && now >= trap_time) {
+      record_trap_latency(sysmsg->trap_to_ack_hist, now - trap_time);
+    }
+    atomic_store(&ctx->spin_budget, spin_budget(sysmsg));
     atomic_store(&ctx->thread_id, sysmsg->thread_id);
+    atomic_store(&ctx->last_shard, home_shard);
     return ctx;
   }
   return NULL;
 }
 
+// queue_get_context takes a context from the shard of the current NUMA node,
+// or steals one from another shard if that one is empty.
+struct thread_context *queue_get_context(struct sysmsg *sysmsg) {
+  struct context_queue *queue = __export_context_queue_addr;
+
+  // Indexes should not jump when start or end are overflowed. This holds
+  // for every power of two up to MAX_CONTEXT_QUEUE_ENTRIES, which index_mask
+  // enforces for the capacity.
+  BUILD_BUG_ON(UINT32_MAX % MAX_CONTEXT_QUEUE_ENTRIES !=
+               MAX_CONTEXT_QUEUE_ENTRIES - 1);
+
+  uint32_t mask = index_mask(queue);
+  uint32_t n = num_shards(queue);
+  uint32_t home = n == 1 ? 0 : current_node() % n;
+  for (uint32_t i = 0; i < n; i++) {
+    struct thread_context *ctx = shard_get_context(
+        sysmsg, &queue->shards[(home + i) % n], home, mask);
+    if (ctx) {
+      return ctx;
+    }
+  }
+  return NULL;
+}
+
 // get_context_fast sets nr_active_threads_p only if it deactivates the thread.
 static struct thread_context *get_context_fast(struct sysmsg *sysmsg,
                                                struct context_queue *queue,
@@ -284,10 +553,14 @@ static struct thread_context *get_context_fast(struct sysmsg *sysmsg,
       }
     }
 
-    if (spinning_queue_remove_first(__export_deep_sleep_timeout)) {
+    if (spinning_queue_remove_first(spin_budget(sysmsg))) {
       break;
     }
-    spinloop();
+    if (__export_spin_wait_mode) {
+      spin_wait(queue);
+    } else {
+      spinloop();
+    }
   }
   return NULL;
 }
@@ -327,6 +600,7 @@ struct thread_context *get_context(struct sysmsg *sysmsg) {
     atomic_store(&sysmsg->state, THREAD_STATE_PREP);
     ctx = queue_get_context(sysmsg);
     if (ctx) {
+      record_context_pickup(sysmsg, CONTEXT_PICKUP_QUEUED);
       goto exit;
     }
 
@@ -335,7 +609,10 @@ struct thread_context *get_context(struct sysmsg *sysmsg) {
     nr_active_threads = NR_IF_THREAD_IS_ACTIVE;
     if (fast_path_enabled) {
       ctx = get_context_fast(sysmsg, queue, &nr_active_threads);
-      if (ctx) goto exit;
+      if (ctx) {
+        record_context_pickup(sysmsg, CONTEXT_PICKUP_FAST_PATH);
+        goto exit;
+      }
     }
     if (nr_active_threads == NR_IF_THREAD_IS_ACTIVE) {
       nr_active_threads = atomic_sub(&queue->num_active_threads, 1);
@@ -352,12 +629,19 @@ struct thread_context *get_context(struct sysmsg *sysmsg) {
     if (nr_active_threads < nr_active_contexts) {
       ctx = queue_get_context(sysmsg);
       if (ctx) {
+        record_context_pickup(sysmsg, CONTEXT_PICKUP_WOKEN);
         atomic_store(&sysmsg->state, THREAD_STATE_PREP);
         atomic_add(&queue->num_active_threads, 1);
         return ctx;
       }
     }
 
+    // Sleeping threads share one futex word, but this doesn't lead to
+    // thundering-herd wakeups: the sentry adds one token per thread it wants
+    // to kick and wakes a single waiter with FUTEX_WAKE(1) (see
+    // contextQueue.wakeupSysmsgThread). A woken thread that loses its token
+    // to a thread that hasn't gone to sleep yet simply waits again. Per-thread
+    // futex words would only move this arbitration into the sentry.
     while (1) {
       if (!try_to_dec_threads_to_wakeup(queue)) {
         sys_futex(&queue->num_threads_to_wakeup, FUTEX_WAIT, 0, NULL, NULL, 0);
@@ -366,6 +650,7 @@ struct thread_context *get_context(struct sysmsg *sysmsg) {
       // Mark this thread as being active only if it can get a context.
       ctx = queue_get_context(sysmsg);
       if (ctx) {
+        record_context_pickup(sysmsg, CONTEXT_PICKUP_WOKEN);
         atomic_store(&sysmsg->state, THREAD_STATE_PREP);
         atomic_add(&queue->num_active_threads, 1);
         return ctx;
@@ -379,6 +664,13 @@ exit:
 
 // switch_context signals the sentry that the old context is ready to be worked
 // on and retrieves a new context to switch to.
+//
+// Every trap of a context is handed off to the sentry on its own. Syscalls of
+// one context can't be batched: the application issues the next syscall only
+// after it has seen the result of the previous one, so there is never more
+// than one pending syscall per context. Contexts of different application
+// threads are already handled in parallel through the context queue, and
+// the handoff cost is amortized by the stub and sentry fast paths instead.
 struct thread_context *switch_context(struct sysmsg *sysmsg,
                                       struct thread_context *ctx,
                                       enum context_state new_context_state) {
@@ -388,7 +680,10 @@ struct thread_context *switch_context(struct sysmsg *sysmsg,
     atomic_sub(&queue->num_active_contexts, 1);
     atomic_store(&ctx->thread_id, INVALID_THREAD_ID);
     atomic_store(&ctx->last_thread_id, sysmsg->thread_id);
-    atomic_store(&ctx->state_changed_time, rdtsc());
+    uint64_t now = rdtsc();
+    atomic_store(&ctx->state_changed_time, now);
+    atomic_store(&ctx->trap_time, now);
+    sysmsg->last_handoff_time = now;
     atomic_store(&ctx->state, new_context_state);
     if (atomic_load(&ctx->sentry_fast_path) == 0) {
       int ret = sys_futex(&ctx->state, FUTEX_WAKE, 1, NULL, NULL, 0);
@@ -426,25 +721,35 @@ void verify_offsets() {
                ALLOCATED_SIZEOF_THREAD_CONTEXT_STRUCT);
 
   // struct context_queue must stay byte-identical to the Go `contextQueue`.
-  BUILD_BUG_ON(offsetof(struct context_queue, end) != 0 * CACHE_LINE_SIZE);
-  BUILD_BUG_ON(offsetof(struct context_queue, start) != 1 * CACHE_LINE_SIZE);
   BUILD_BUG_ON(offsetof(struct context_queue, fast_path_disabled) !=
-               2 * CACHE_LINE_SIZE);
+               0 * CACHE_LINE_SIZE);
   BUILD_BUG_ON(offsetof(struct context_queue, num_awake_contexts) !=
-               2 * CACHE_LINE_SIZE + 4);
+               0 * CACHE_LINE_SIZE + 4);
+  BUILD_BUG_ON(offsetof(struct context_queue, num_shards) !=
+               0 * CACHE_LINE_SIZE + 8);
+  BUILD_BUG_ON(offsetof(struct context_queue, capacity) !=
+               0 * CACHE_LINE_SIZE + 12);
   BUILD_BUG_ON(offsetof(struct context_queue, num_active_threads) !=
-               3 * CACHE_LINE_SIZE);
+               1 * CACHE_LINE_SIZE);
   BUILD_BUG_ON(offsetof(struct context_queue, num_spinning_threads) !=
-               3 * CACHE_LINE_SIZE + 4);
+               1 * CACHE_LINE_SIZE + 4);
   BUILD_BUG_ON(offsetof(struct context_queue, num_threads_to_wakeup) !=
-               4 * CACHE_LINE_SIZE);
+               2 * CACHE_LINE_SIZE);
   BUILD_BUG_ON(offsetof(struct context_queue, num_active_contexts) !=
-               5 * CACHE_LINE_SIZE);
+               3 * CACHE_LINE_SIZE);
   BUILD_BUG_ON(offsetof(struct context_queue, used_fast_path) !=
-               5 * CACHE_LINE_SIZE + 4);
-  BUILD_BUG_ON(offsetof(struct context_queue, ringbuffer) !=
-               6 * CACHE_LINE_SIZE);
-  BUILD_BUG_ON(sizeof(struct context_queue) !=
-               6 * CACHE_LINE_SIZE +
+               3 * CACHE_LINE_SIZE + 4);
+  BUILD_BUG_ON(offsetof(struct context_queue, shards) != 4 * CACHE_LINE_SIZE);
+  BUILD_BUG_ON(offsetof(struct context_queue_shard, end) !=
+               0 * CACHE_LINE_SIZE);
+  BUILD_BUG_ON(offsetof(struct context_queue_shard, start) !=
+               1 * CACHE_LINE_SIZE);
+  BUILD_BUG_ON(offsetof(struct context_queue_shard, ringbuffer) !=
+               2 * CACHE_LINE_SIZE);
+  BUILD_BUG_ON(sizeof(struct context_queue_shard) !=
+               2 * CACHE_LINE_SIZE +
                    MAX_CONTEXT_QUEUE_ENTRIES * sizeof(uint64_t));
+  BUILD_BUG_ON(sizeof(struct context_queue) !=
+               4 * CACHE_LINE_SIZE + MAX_CONTEXT_QUEUE_SHARDS *
+                                         sizeof(struct context_queue_shard));
 }
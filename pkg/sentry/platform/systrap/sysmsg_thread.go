@@ -51,6 +51,10 @@ type sysmsgThread struct {
 
 	// fpuStateToMsgOffset is the offset of a thread fpu state relative to sysmsg.
 	fpuStateToMsgOffset uint64
+
+	// trapLatencies is the part of the msg trap latency histograms that has
+	// already been added to the trap latency metrics.
+	trapLatencies trapLatencySnapshot
 }
 
 // sysmsgPerThreadMemAddr returns a sysmsg stack address in the thread address
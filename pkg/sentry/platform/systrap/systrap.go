@@ -122,6 +122,21 @@ var (
 	// been flipped for one Systrap instance, it will apply to all previously
 	// created and future instances too.
 	disableSyscallPatching bool
+
+	// powerEfficientSpin is set if spinning stub threads should wait for the
+	// context queue to be written to rather than poll it. Like
+	// disableSyscallPatching, it applies to all Systrap instances.
+	powerEfficientSpin bool
+
+	// vsyscallVDSO is set if stub threads may redirect vsyscalls to the VDSO
+	// functions that implement them. Like disableSyscallPatching, it applies
+	// to all Systrap instances.
+	vsyscallVDSO bool
+
+	// stubHugePages is set if the thread context region is backed by huge
+	// pages. Like disableSyscallPatching, it applies to all Systrap
+	// instances.
+	stubHugePages bool
 )
 
 // platformContext is an implementation of the platform context.
@@ -147,6 +162,31 @@ type platformContext struct {
 	// needToPullFullState indicates that the Sentry doesn't have a full
 	// state of the thread.
 	needToPullFullState bool
+
+	// syscallAnswers are the answers that the stub thread may return for
+	// identity syscalls. They are copied into the shared context by
+	// switchToApp.
+	syscallAnswers sysmsg.SyscallAnswers
+}
+
+// SetSyscallAnswers implements platform.SyscallAnswerCache.SetSyscallAnswers.
+func (c *platformContext) SetSyscallAnswers(a *platform.SyscallAnswers) {
+	if !a.Valid {
+		c.syscallAnswers = sysmsg.SyscallAnswers{}
+		return
+	}
+	c.syscallAnswers = sysmsg.SyscallAnswers{
+		Valid: 1,
+		Pid:   a.Pid,
+		Tid:   a.Tid,
+		UID:   a.UID,
+		EUID:  a.EUID,
+		GID:   a.GID,
+		EGID:  a.EGID,
+	}
+	if vsyscallVDSO {
+		c.syscallAnswers.VsyscallTargets = a.VsyscallTargets
+	}
 }
 
 // PullFullState implements platform.Context.PullFullState.
@@ -182,7 +222,7 @@ restart:
 		return nil, hostarch.NoAccess, err
 	}
 	if needPatch {
-		s.usertrap.PatchSyscall(ctx, ac, mm)
+		recordSyscallPatch(s.usertrap.PatchSyscall(ctx, ac, mm))
 	}
 	if !isSyscall && linux.Signal(c.signalInfo.Signo) == linux.SIGILL {
 		err := s.usertrap.HandleFault(ctx, ac, mm)
@@ -263,6 +303,9 @@ type Systrap struct {
 	// the Sentry. Since memoryFile is platform-private, it is never restored,
 	// so it is safe to call memoryFile.FD() rather than memoryFile.DataFD().
 	memoryFile *pgalloc.MemoryFile
+
+	// faultAroundSize is the value returned by FaultAroundSize.
+	faultAroundSize uint64
 }
 
 // MinUserAddress implements platform.MinUserAddress.
@@ -272,10 +315,28 @@ func (*Systrap) MinUserAddress() hostarch.Addr {
 
 // New returns a new seccomp-based implementation of the platform interface.
 func New(opts platform.Options) (*Systrap, error) {
+	if fa := opts.FaultAroundBytes; fa != 0 && (fa%hostarch.PageSize != 0 || fa&(fa-1) != 0) {
+		return nil, fmt.Errorf("fault-around size %d is not a power-of-2 multiple of the page size", fa)
+	}
+	if c := opts.ContextQueueCapacity; c != 0 && (c < uint64(minContextQueueEntries) || c > uint64(maxContextQueueEntries) || c&(c-1) != 0) {
+		return nil, fmt.Errorf("context queue capacity %d is not a power of 2 in [%d, %d]", c, minContextQueueEntries, maxContextQueueEntries)
+	}
+	if w := opts.WarmStubProcesses; w > maxWarmSubprocesses {
+		return nil, fmt.Errorf("%d warm stub processes exceeds the maximum of %d", w, maxWarmSubprocesses)
+	}
 	mbCh := hostmm.Probe(false)
 	if !disableSyscallPatching {
 		disableSyscallPatching = opts.DisableSyscallPatching
 	}
+	if !powerEfficientSpin {
+		powerEfficientSpin = opts.PowerEfficientSpin && canWaitForWrite()
+	}
+	if !vsyscallVDSO {
+		vsyscallVDSO = opts.VsyscallVDSO
+	}
+	if warmSubprocesses == 0 {
+		warmSubprocesses = int(opts.WarmStubProcesses)
+	}
 
 	if maxSysmsgThreads == 0 {
 		// CPUID information has been initialized at this point.
@@ -284,9 +345,18 @@ func New(opts platform.Options) (*Systrap, error) {
 		maxSysmsgThreads = runtime.GOMAXPROCS(0)
 		// Account for syscall thread.
 		maxChildThreads = maxSysmsgThreads + 1
+		// The stub layout depends on the context queue capacity, so it
+		// is set once as well.
+		initContextQueueCapacity(uint32(opts.ContextQueueCapacity))
+	}
+	if !stubHugePages {
+		// Huge pages are only worth it if the thread context region
+		// spans at least one of them, which isn't the case e.g. with
+		// 64K base pages on arm64 or small context queues.
+		stubHugePages = opts.StubHugePages && sysmsg.AllocatedSizeofThreadContextStruct*uintptr(contextQueueEntries) >= hostarch.HugePageSize
 	}
 
-	mf, err := createMemoryFile()
+	mf, err := createMemoryFile(stubHugePages)
 	if err != nil {
 		return nil, err
 	}
@@ -305,6 +375,9 @@ func New(opts platform.Options) (*Systrap, error) {
 		// copies deepSleepTimeout into the stub.
 		initSleepTimeouts()
 
+		// Pick the number of context queue shards for the host topology.
+		initContextQueueShards()
+
 		// Initialize the stub.
 		stubInit()
 
@@ -338,6 +411,7 @@ func New(opts platform.Options) (*Systrap, error) {
 	return &Systrap{
 		UseHostGlobalMemoryBarrier: platform.UseHostGlobalMemoryBarrier{MemBarrier: <-mbCh},
 		memoryFile:                 mf,
+		faultAroundSize:            opts.FaultAroundBytes,
 	}, nil
 }
 
@@ -346,6 +420,16 @@ func (*Systrap) SupportsAddressSpaceIO() bool {
 	return false
 }
 
+// FaultAroundSize implements platform.FaultArounder.FaultAroundSize.
+//
+// Populating neighbouring pages in the host mmap that maps the faulting page
+// saves the host page faults that the application would take on them soon
+// after. This is only worthwhile for workloads that touch most of the memory
+// they allocate, so it's disabled by default.
+func (s *Systrap) FaultAroundSize() uint64 {
+	return s.faultAroundSize
+}
+
 // MapUnit implements platform.Platform.MapUnit.
 func (*Systrap) MapUnit() uint64 {
 	// The host kernel manages page tables and arbitrary-sized mappings
@@ -361,7 +445,11 @@ func (*Systrap) MaxUserAddress() hostarch.Addr {
 
 // NewAddressSpace returns a new subprocess.
 func (p *Systrap) NewAddressSpace() (platform.AddressSpace, error) {
-	return newSubprocess(globalPool.source.createStub, p.memoryFile, true)
+	sp, err := newSubprocess(globalPool.source.createStub, p.memoryFile, true)
+	if err == nil {
+		globalPool.prewarm(p.memoryFile)
+	}
+	return sp, err
 }
 
 // NewContext returns an interruptible platformContext.
@@ -398,14 +486,21 @@ func init() {
 	platform.Register("systrap", &constructor{})
 }
 
-func createMemoryFile() (*pgalloc.MemoryFile, error) {
+// createMemoryFile creates the platform-private memory file. If hugePages is
+// true, allocations from it with pgalloc.AllocOpts.Huge set are advised to be
+// backed by huge pages, which the host honors unless its shmem_enabled THP
+// setting is "never" or "deny".
+func createMemoryFile(hugePages bool) (*pgalloc.MemoryFile, error) {
 	const memfileName = "systrap-memory"
 	fd, err := memutil.CreateMemFD(memfileName, 0)
 	if err != nil {
 		return nil, fmt.Errorf("error creating memfd: %v", err)
 	}
 	memfile := os.NewFile(uintptr(fd), memfileName)
-	mf, err := pgalloc.NewMemoryFile(memfile, pgalloc.MemoryFileOpts{})
+	mf, err := pgalloc.NewMemoryFile(memfile, pgalloc.MemoryFileOpts{
+		ExpectHugepages: hugePages,
+		AdviseHugepage:  hugePages,
+	})
 	if err != nil {
 		memfile.Close()
 		return nil, fmt.Errorf("error creating pgalloc.MemoryFile: %v", err)
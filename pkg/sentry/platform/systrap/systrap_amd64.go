@@ -15,6 +15,7 @@
 package systrap
 
 import (
+	"gvisor.dev/gvisor/pkg/cpuid"
 	"gvisor.dev/gvisor/pkg/sentry/arch"
 )
 
@@ -33,6 +34,18 @@ func cputicksFreq() uint64 {
 	return nominalTSCFreq
 }
 
+// canShardContextQueue returns true if stub threads can find their NUMA node
+// cheaply. The stub reads it from IA32_TSC_AUX with RDTSCP.
+func canShardContextQueue() bool {
+	return cpuid.HostFeatureSet().HasFeature(cpuid.X86FeatureRDTSCP)
+}
+
+// canWaitForWrite returns true if spinning stub threads can wait for the
+// context queue to be written to. The stub uses UMONITOR/UMWAIT.
+func canWaitForWrite() bool {
+	return cpuid.HostFeatureSet().HasFeature(cpuid.X86FeatureWAITPKG)
+}
+
 // x86 use the fs_base register to store the TLS pointer which can be
 // get/set in "func (t *thread) get/setRegs(regs *arch.Registers)".
 // So both of the get/setTLS() operations are noop here.
@@ -19,6 +19,19 @@ import (
 	"gvisor.dev/gvisor/pkg/sentry/arch"
 )
 
+// canShardContextQueue returns true if stub threads can find their NUMA node
+// cheaply. There is no such way on arm64.
+func canShardContextQueue() bool {
+	return false
+}
+
+// canWaitForWrite returns true if spinning stub threads can wait for the
+// context queue to be written to. The stub uses LDAXR/WFE, which are always
+// available.
+func canWaitForWrite() bool {
+	return true
+}
+
 // getCNTFRQ returns the frequency (in Hz) of the system counter read by
 // cputicks(), as reported by CNTFRQ_EL0.
 func getCNTFRQ() int64
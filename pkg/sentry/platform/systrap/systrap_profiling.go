@@ -26,6 +26,10 @@ import (
 // "systrap_profiling" go-tag is specified at compilation.
 var SystrapProfiling = metric.RealMetricBuilder{}
 
+// syscallSampling is true if stub threads record the numbers of the syscalls
+// that they handle.
+const syscallSampling = true
+
 //go:nosplit
 func updateDebugMetrics(stubBoundLat, sentryBoundLat cpuTicks) {
 	if stubBoundLat == 0 {
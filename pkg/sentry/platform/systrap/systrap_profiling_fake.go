@@ -26,5 +26,9 @@ import (
 // "systrap_profiling" go-tag is specified at compilation.
 var SystrapProfiling = metric.FakeMetricBuilder{}
 
+// syscallSampling is true if stub threads record the numbers of the syscalls
+// that they handle.
+const syscallSampling = false
+
 //go:nosplit
 func updateDebugMetrics(stubBoundLat, sentryBoundLat cpuTicks) {}
@@ -19,7 +19,8 @@
 // instruction: mov sysno, %eax; syscall.  The size of the mov instruction is 5
 // bytes and the size of the syscall instruction is 2 bytes. These two
 // instruction can be replaced with a single jmp instruction with an absolute
-// address below 2 gigabytes.
+// address below 2 gigabytes. The Go assembler emits "mov sysno, %rax" instead,
+// which is 7 bytes long, and is replaced the same way.
 //
 // Here is a few tricks:
 //   - The GS register is used to access a per-thread memory.
@@ -47,3 +48,46 @@ var (
 	// ErrFaultSyscall indicates that the current fault has to be handled as a system call.
 	ErrFaultSyscall = fmt.Errorf("need to handle as syscall")
 )
+
+// PatchResult is the outcome of State.PatchSyscall.
+type PatchResult int
+
+const (
+	// PatchNone means that there was nothing to patch, because another
+	// thread has patched the syscall already or because syscall patching
+	// isn't supported.
+	PatchNone PatchResult = iota
+	// PatchedMovEAX means that "mov sysno, %eax; syscall" was patched.
+	PatchedMovEAX
+	// PatchedMovRAX means that "mov sysno, %rax; syscall" was patched.
+	PatchedMovRAX
+	// PatchSkippedTraced means that the syscall wasn't patched because the
+	// task is being ptraced.
+	PatchSkippedTraced
+	// PatchFailedTableFull means that the syscall wasn't patched because
+	// there is no space left in the trap table.
+	PatchFailedTableFull
+	// PatchFailed means that the syscall wasn't patched because of an
+	// error accessing application memory.
+	PatchFailed
+)
+
+// String implements fmt.Stringer.String.
+func (r PatchResult) String() string {
+	switch r {
+	case PatchNone:
+		return "none"
+	case PatchedMovEAX:
+		return "mov_eax"
+	case PatchedMovRAX:
+		return "mov_rax"
+	case PatchSkippedTraced:
+		return "traced"
+	case PatchFailedTableFull:
+		return "table_full"
+	case PatchFailed:
+		return "failed"
+	default:
+		return fmt.Sprintf("PatchResult(%d)", int(r))
+	}
+}
@@ -18,6 +18,7 @@
 package usertrap
 
 import (
+	"bytes"
 	"encoding/binary"
 	"fmt"
 
@@ -45,8 +46,6 @@ var (
 	jmpInstOpcodeLen = 3
 	// faultInst is the single byte invalid instruction.
 	faultInst = [1]byte{0x6}
-	// faultInstOffset is the offset of the syscall instruction.
-	faultInstOffset = uintptr(5)
 )
 
 type memoryManager interface {
@@ -122,7 +121,7 @@ func (s *State) newTrapLocked(ctx context.Context, mm memoryManager) (hostarch.A
 	ctx.Debugf("Allocate a new trap: %p %d", s, s.nextTrap)
 	if s.nextTrap >= trapNR {
 		ctx.Warningf("No space in the trap table")
-		return 0, fmt.Errorf("no space in the trap table")
+		return 0, errTrapTableFull
 	}
 	trap := s.nextTrap
 	s.nextTrap++
@@ -186,11 +185,56 @@ func loadUsertrap(ctx context.Context, mm memoryManager, addr hostarch.Addr) err
 	return nil
 }
 
+// syscallPattern is an instruction sequence which sets the syscall number with
+// an immediate operand and makes the syscall. It is replaced with a jmp to a
+// trampoline which does the same.
+type syscallPattern struct {
+	// opcode is the bytes of the mov instruction before the syscall number.
+	opcode []byte
+	// result is returned by PatchSyscall when the pattern is patched.
+	result PatchResult
+}
+
+// syscallInstLen is the length of the syscall instruction.
+const syscallInstLen = 2
+
+// len returns the length of the pattern including the syscall instruction.
+func (p *syscallPattern) len() int {
+	return len(p.opcode) + 4 + syscallInstLen
+}
+
+var syscallPatterns = []syscallPattern{
+	// mov sysno, %eax; syscall
+	{opcode: []byte{0xb8}, result: PatchedMovEAX},
+	// mov sysno, %rax; syscall
+	{opcode: []byte{0x48, 0xc7, 0xc0}, result: PatchedMovRAX},
+}
+
+// errTrapTableFull is returned by newTrapLocked if all traps are in use.
+var errTrapTableFull = fmt.Errorf("no space in the trap table")
+
+// matchSyscallPattern returns the pattern that ends at ip, and the address at
+// which it starts.
+func matchSyscallPattern(task *kernel.Task, ip uintptr) (*syscallPattern, uintptr) {
+	for i := range syscallPatterns {
+		p := &syscallPatterns[i]
+		addr := ip - uintptr(p.len())
+		code := make([]uint8, len(p.opcode))
+		if _, err := primitive.CopyUint8SliceIn(task, hostarch.Addr(addr), code); err != nil {
+			continue
+		}
+		if bytes.Equal(code, p.opcode) {
+			return p, addr
+		}
+	}
+	return nil, 0
+}
+
 // PatchSyscall changes the syscall instruction into a function call.
-func (s *State) PatchSyscall(ctx context.Context, ac *arch.Context64, mm memoryManager) error {
+func (s *State) PatchSyscall(ctx context.Context, ac *arch.Context64, mm memoryManager) PatchResult {
 	task := kernel.TaskFromContext(ctx)
 	if task == nil {
-		return fmt.Errorf("no task found")
+		return PatchFailed
 	}
 
 	// Skip syscall patching when the task is being ptraced, because
@@ -208,85 +252,139 @@ func (s *State) PatchSyscall(ctx context.Context, ac *arch.Context64, mm memoryM
 		if s.nextTrap > 0 {
 			ctx.Warningf("LIKELY ERROR: Attached tracer to process with patched syscalls (traps %d)! Systrap is not fully compatible with ptrace/debuggers, program may die unexpectedly soon! Use `--systrap-disable-syscall-patching` as a workaround.", s.nextTrap)
 		}
-		return nil
+		return PatchSkippedTraced
 	}
 
 	sysno := ac.SyscallNo()
-	patchAddr := ac.IP() - uintptr(len(jmpInst))
 
-	prevCode := make([]uint8, len(jmpInst))
-	if _, err := primitive.CopyUint8SliceIn(task, hostarch.Addr(patchAddr), prevCode); err != nil {
-		return err
+	// Check that another thread has not patched this syscall yet, in which
+	// case the first bytes have been replaced already.
+	p, patchAddr := matchSyscallPattern(task, ac.IP())
+	if p == nil {
+		return PatchNone
 	}
+	ctx.Debugf("Found the pattern %v at ip %x:sysno %d", p.result, patchAddr, sysno)
 
-	// Check that another thread has not patched this syscall yet.
-	// 0xb8 is the first byte of "mov sysno, %eax".
-	if prevCode[0] == uint8(0xb8) {
-		ctx.Debugf("Found the pattern at ip %x:sysno %d", patchAddr, sysno)
-
-		trapAddr, err := s.addTrapLocked(ctx, ac, mm, uint32(sysno))
-		if trapAddr == 0 || err != nil {
-			ctx.Warningf("Failed to add a new trap: %v", err)
-			return nil
+	trapAddr, err := s.addTrapLocked(ctx, ac, mm, uint32(sysno))
+	if trapAddr == 0 || err != nil {
+		ctx.Warningf("Failed to add a new trap: %v", err)
+		if err == errTrapTableFull {
+			return PatchFailedTableFull
 		}
+		return PatchFailed
+	}
 
-		// Replace "mov sysno, %eax; syscall" with "jmp trapAddr".
-		newCode := make([]uint8, len(jmpInst))
-		copy(newCode[:jmpInstOpcodeLen], jmpInst[:jmpInstOpcodeLen])
-		binary.LittleEndian.PutUint32(newCode[jmpInstOpcodeLen:], uint32(trapAddr))
-
-		ctx.Debugf("Apply the binary patch addr %x trap addr %x (%v -> %v)", patchAddr, trapAddr, prevCode, newCode)
-
-		ignorePermContext := task.OwnCopyContext(usermem.IOOpts{IgnorePermissions: true})
+	// Replace "mov sysno, %eax; syscall" with "jmp trapAddr".
+	newCode := make([]uint8, len(jmpInst))
+	copy(newCode[:jmpInstOpcodeLen], jmpInst[:jmpInstOpcodeLen])
+	binary.LittleEndian.PutUint32(newCode[jmpInstOpcodeLen:], uint32(trapAddr))
+
+	ctx.Debugf("Apply the binary patch addr %x trap addr %x (-> %v)", patchAddr, trapAddr, newCode)
+
+	ignorePermContext := task.OwnCopyContext(usermem.IOOpts{IgnorePermissions: true})
+
+	// The patch can't be applied atomically, so we need to
+	// guarantee that in each moment other threads will read a
+	// valid set of instructions, detect any inconsistent states
+	// and restart the patched code if so.
+	//
+	// A subtle aspect is the address at which the user trap table
+	// is always mapped which is 0x60000. The first byte of this is
+	// 0x06 which is an invalid opcode. That’s why when we
+	// overwrite all the bytes but the first 1 in the second step
+	// it works fine since the jump address still writes a 0x6 at
+	// the location of the first byte of syscall instruction that
+	// we are removing and any threads reading the instructions
+	// will still fault at the same place.
+	//
+	// Another subtle aspect is the second step is done using a
+	// regular non-atomic write which means a thread decoding the
+	// mov instruction could read a garbage value of the immediate
+	// operand for the ‘mov sysyno, %eax” instruction. But it
+	// doesn’t matter since we don’t change the first byte which is
+	// the one that contains the opcode. Also since the thread will
+	// fault on the 0x6 right after and will be restarted with the
+	// patched code the mov reading a garbage immediate operand
+	// doesn’t impact correctness.
+	//
+	// "mov sysno, %rax" is two bytes longer, so the jmp instruction
+	// ends before the syscall instruction, and the second step
+	// overwrites the rest of the opcode of the mov instruction. To
+	// keep other threads from decoding a partially written opcode,
+	// the first byte of the pattern is also replaced with the
+	// invalid instruction in the first step. Threads which fault on
+	// it are restarted by HandleFault once the patch is complete.
+
+	// The patch is applied in three steps:
+	//
+	// The first step is to replace the first byte of the syscall
+	// instruction by one-byte invalid instruction (0x06), so that
+	// other threads which have passed the mov instruction fault on
+	// the invalid instruction and restart a patched code.
+	faultInstB := primitive.ByteSlice(faultInst[:])
+	if _, err := faultInstB.CopyOut(ignorePermContext, hostarch.Addr(ac.IP()-syscallInstLen)); err != nil {
+		return PatchFailed
+	}
+	if len(p.opcode) > 1 {
+		if _, err := faultInstB.CopyOut(ignorePermContext, hostarch.Addr(patchAddr)); err != nil {
+			return PatchFailed
+		}
+	}
+	// The second step is to replace all bytes except the first one
+	// which is the opcode of the mov instruction, so that the first
+	// five bytes remain "mov XXX, %rax".
+	if _, err := primitive.CopyUint8SliceOut(ignorePermContext, hostarch.Addr(patchAddr+1), newCode[1:]); err != nil {
+		return PatchFailed
+	}
+	// The final step is to replace the first byte of the patch.
+	// After this point, all threads will read the valid jmp
+	// instruction.
+	if _, err := primitive.CopyUint8SliceOut(ignorePermContext, hostarch.Addr(patchAddr), newCode[0:1]); err != nil {
+		return PatchFailed
+	}
+	return p.result
+}
 
-		// The patch can't be applied atomically, so we need to
-		// guarantee that in each moment other threads will read a
-		// valid set of instructions, detect any inconsistent states
-		// and restart the patched code if so.
-		//
-		// A subtle aspect is the address at which the user trap table
-		// is always mapped which is 0x60000. The first byte of this is
-		// 0x06 which is an invalid opcode. That’s why when we
-		// overwrite all the bytes but the first 1 in the second step
-		// it works fine since the jump address still writes a 0x6 at
-		// the location of the first byte of syscall instruction that
-		// we are removing and any threads reading the instructions
-		// will still fault at the same place.
-		//
-		// Another subtle aspect is the second step is done using a
-		// regular non-atomic write which means a thread decoding the
-		// mov instruction could read a garbage value of the immediate
-		// operand for the ‘mov sysyno, %eax” instruction. But it
-		// doesn’t matter since we don’t change the first byte which is
-		// the one that contains the opcode. Also since the thread will
-		// fault on the 0x6 right after and will be restarted with the
-		// patched code the mov reading a garbage immediate operand
-		// doesn’t impact correctness.
-
-		// The patch is applied in three steps:
-		//
-		// The first step is to replace the first byte of the syscall
-		// instruction by one-byte invalid instruction (0x06), so that
-		// other threads which have passed the mov instruction fault on
-		// the invalid instruction and restart a patched code.
-		faultInstB := primitive.ByteSlice(faultInst[:])
-		if _, err := faultInstB.CopyOut(ignorePermContext, hostarch.Addr(patchAddr+faultInstOffset)); err != nil {
-			return err
+// isTrapJmp returns true if code starts with a jmp instruction to the trap
+// table.
+func isTrapJmp(code []uint8) bool {
+	if len(code) < len(jmpInst) {
+		return false
+	}
+	for i := 0; i < jmpInstOpcodeLen; i++ {
+		if code[i] != jmpInst[i] {
+			return false
 		}
-		// The second step is to replace all bytes except the first one
-		// which is the opcode of the mov instruction, so that the first
-		// five bytes remain "mov XXX, %rax".
-		if _, err := primitive.CopyUint8SliceOut(ignorePermContext, hostarch.Addr(patchAddr+1), newCode[1:]); err != nil {
-			return err
+	}
+	target := hostarch.Addr(binary.LittleEndian.Uint32(code[jmpInstOpcodeLen:]))
+	return trapTableAddrRange.Contains(target)
+}
+
+// patchedJmpAddr returns the address of the jmp instruction which replaced
+// the syscall pattern that a fault at ip has been caused by, or false if the
+// fault isn't caused by a patched syscall.
+func patchedJmpAddr(task *kernel.Task, ip uintptr) (uintptr, bool) {
+	for i := range syscallPatterns {
+		// A thread that has executed the mov instruction before the
+		// patch faults on the first byte of the syscall instruction.
+		p := &syscallPatterns[i]
+		addr := ip + syscallInstLen - uintptr(p.len())
+		code := make([]uint8, max(len(jmpInst), int(ip-addr)+len(faultInst)))
+		if _, err := primitive.CopyUint8SliceIn(task, hostarch.Addr(addr), code); err != nil {
+			continue
 		}
-		// The final step is to replace the first byte of the patch.
-		// After this point, all threads will read the valid jmp
-		// instruction.
-		if _, err := primitive.CopyUint8SliceOut(ignorePermContext, hostarch.Addr(patchAddr), newCode[0:1]); err != nil {
-			return err
+		if isTrapJmp(code) && code[ip-addr] == faultInst[0] {
+			return addr, true
 		}
 	}
-	return nil
+
+	// A thread can also fault on the first byte of a pattern with a
+	// multi-byte opcode while it's being patched.
+	code := make([]uint8, len(jmpInst))
+	if _, err := primitive.CopyUint8SliceIn(task, hostarch.Addr(ip), code); err == nil && isTrapJmp(code) {
+		return ip, true
+	}
+	return 0, false
 }
 
 // HandleFault handles a fault on a patched syscall instruction.
@@ -310,25 +408,13 @@ func (s *State) HandleFault(ctx context.Context, ac *arch.Context64, mm memoryMa
 	s.mu.RLock()
 	defer s.mu.RUnlock()
 
-	code := make([]uint8, len(jmpInst))
-	ip := ac.IP() - faultInstOffset
-	if _, err := primitive.CopyUint8SliceIn(task, hostarch.Addr(ip), code); err != nil {
-		return err
-	}
-
-	for i := 0; i < jmpInstOpcodeLen; i++ {
-		if code[i] != jmpInst[i] {
-			return nil
-		}
-	}
-	for i := 0; i < len(faultInst); i++ {
-		if code[i+int(faultInstOffset)] != faultInst[i] {
-			return nil
-		}
+	ip, ok := patchedJmpAddr(task, ac.IP())
+	if !ok {
+		return nil
 	}
 
 	regs := &ac.StateData().Regs
-	if regs.Rax == uint64(unix.SYS_RESTART_SYSCALL) {
+	if regs.Rax == uint64(unix.SYS_RESTART_SYSCALL) && ip != ac.IP() {
 		// restart_syscall is usually set by the Sentry to restart a
 		// system call after interruption by a stop signal. The Sentry
 		// sets RAX and moves RIP back on the size of the syscall
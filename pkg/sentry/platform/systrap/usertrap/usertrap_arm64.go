@@ -52,8 +52,9 @@ func New() *State {
 	return &State{}
 }
 
-func (*State) PatchSyscall(ctx context.Context, ac *arch.Context64, mm memoryManager) (restart bool, err error) {
-	return false /* restart */, nil
+// PatchSyscall does nothing on arm64 as syscall trapping is not supported.
+func (*State) PatchSyscall(ctx context.Context, ac *arch.Context64, mm memoryManager) PatchResult {
+	return PatchNone
 }
 
 // HandleFault handles a fault on a patched syscall instruction.
@@ -50,9 +50,15 @@ func init() {
 // serialized point proto, preceded by a standard header. If the point cannot
 // be sent, e.g. buffer full, the point is dropped on the floor to avoid
 // delaying/hanging indefinitely the application.
+//
+// Optionally, messages are written to a ring in memory shared with the remote
+// process instead of the socket. See wire.RingHeaderSize for details.
 type remote struct {
 	endpoint *fd.FD
 
+	// ring is set when the shared memory ring transport is used.
+	ring *ring
+
 	droppedCount atomicbitops.Uint32
 
 	retries        int
@@ -74,10 +80,16 @@ func setupSink(config map[string]any) (*os.File, error) {
 	if !ok {
 		return nil, fmt.Errorf("endpoint %q is not a string", addrOpaque)
 	}
-	return setup(addr)
+	ringSize, err := parseRingSize(config)
+	if err != nil {
+		return nil, err
+	}
+	return setup(addr, ringSize)
 }
 
-func setup(path string) (*os.File, error) {
+// setup connects to the remote process and performs the handshake. If ringSize
+// is not zero, it requests the shared memory ring transport.
+func setup(path string, ringSize uint64) (*os.File, error) {
 	log.Debugf("Remote sink connecting to %q", path)
 	socket, err := unix.Socket(unix.AF_UNIX, unix.SOCK_SEQPACKET, 0)
 	if err != nil {
@@ -96,6 +108,10 @@ func setup(path string) (*os.File, error) {
 
 	// Perform handshake. See common.proto for details about the protocol.
 	hsOut := pb.Handshake{Version: wire.CurrentVersion}
+	if ringSize > 0 {
+		hsOut.Version = wire.RingVersion
+		hsOut.RingSize = uint32(ringSize)
+	}
 	out, err := proto.Marshal(&hsOut)
 	if err != nil {
 		return nil, fmt.Errorf("marshalling handshake message: %w", err)
@@ -124,6 +140,9 @@ func setup(path string) (*os.File, error) {
 	if hsIn.Version < minSupportedVersion {
 		return nil, fmt.Errorf("remote version (%d) is smaller than minimum supported (%d)", hsIn.Version, minSupportedVersion)
 	}
+	if ringSize > 0 && (hsIn.Version < wire.RingVersion || uint64(hsIn.RingSize) != ringSize) {
+		return nil, fmt.Errorf("remote doesn't support shared memory ring, version: %d, ring size: %d", hsIn.Version, hsIn.RingSize)
+	}
 
 	if err := unix.SetNonblock(int(f.Fd()), true); err != nil {
 		return nil, err
@@ -182,6 +201,15 @@ func new(config map[string]any, endpoint *fd.FD) (seccheck.Sink, error) {
 	if r.initialBackoff > r.maxBackoff {
 		return nil, fmt.Errorf("initial backoff (%v) cannot be larger than max backoff (%v)", r.initialBackoff, r.maxBackoff)
 	}
+	ringSize, err := parseRingSize(config)
+	if err != nil {
+		return nil, err
+	}
+	if ringSize > 0 {
+		if r.ring, err = receiveRing(r.endpoint.FD(), ringSize); err != nil {
+			return nil, err
+		}
+	}
 
 	log.Debugf("Remote sink created, endpoint FD: %d, %+v", r.endpoint.FD(), r)
 	return r, nil
@@ -204,6 +232,9 @@ func (r *remote) Stop() {
 		// simply fail to be delivered.
 		r.endpoint.Close()
 	}
+	if r.ring != nil {
+		r.ring.close()
+	}
 }
 
 func (r *remote) write(msg proto.Message, msgType pb.MessageType) {
@@ -222,7 +253,12 @@ func (r *remote) write(msg proto.Message, msgType pb.MessageType) {
 
 	backoff := r.initialBackoff
 	for i := 0; ; i++ {
-		_, err := unix.Writev(r.endpoint.FD(), [][]byte{hdrOut[:], out})
+		var err error
+		if r.ring != nil {
+			err = r.ring.write(hdrOut[:], out)
+		} else {
+			_, err = unix.Writev(r.endpoint.FD(), [][]byte{hdrOut[:], out})
+		}
 		if err == nil {
 			// Write succeeded, we're done!
 			return
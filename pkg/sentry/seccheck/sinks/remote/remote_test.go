@@ -26,6 +26,7 @@ import (
 	"time"
 
 	"github.com/cenkalti/backoff"
+	"golang.org/x/sys/unix"
 	"google.golang.org/protobuf/proto"
 	"google.golang.org/protobuf/types/known/anypb"
 	"gvisor.dev/gvisor/pkg/fd"
@@ -115,7 +116,7 @@ func TestBasic(t *testing.T) {
 	}
 	defer server.Close()
 
-	endpoint, err := setup(server.Endpoint)
+	endpoint, err := setup(server.Endpoint, 0)
 	if err != nil {
 		t.Fatalf("setup(): %v", err)
 	}
@@ -163,7 +164,7 @@ func TestVersionUnsupported(t *testing.T) {
 
 	server.SetVersion(0)
 
-	_, err = setup(server.Endpoint)
+	_, err = setup(server.Endpoint, 0)
 	if err == nil || !strings.Contains(err.Error(), "remote version") {
 		t.Fatalf("Wrong error: %v", err)
 	}
@@ -178,7 +179,7 @@ func TestVersionNewer(t *testing.T) {
 
 	server.SetVersion(wire.CurrentVersion + 10)
 
-	endpoint, err := setup(server.Endpoint)
+	endpoint, err := setup(server.Endpoint, 0)
 	if err != nil {
 		t.Fatalf("setup(): %v", err)
 	}
@@ -194,7 +195,7 @@ func TestExample(t *testing.T) {
 	}
 	defer server.stop()
 
-	endpoint, err := setup(server.path)
+	endpoint, err := setup(server.path, 0)
 	if err != nil {
 		t.Fatalf("setup(): %v", err)
 	}
@@ -228,6 +229,135 @@ func TestExample(t *testing.T) {
 	}
 }
 
+// Test that the example C++ server works with the shared memory ring.
+func TestExampleRing(t *testing.T) {
+	server, err := newExampleServer(false)
+	if err != nil {
+		t.Fatalf("newExampleServer(): %v", err)
+	}
+	defer server.stop()
+
+	endpoint, err := setup(server.path, wire.RingMinSize)
+	if err != nil {
+		t.Fatalf("setup(): %v", err)
+	}
+	endpointFD, err := fd.NewFromFile(endpoint)
+	if err != nil {
+		_ = endpoint.Close()
+		t.Fatalf("NewFromFile(): %v", err)
+	}
+	_ = endpoint.Close()
+
+	// Retry for long enough to never drop points if the server falls behind.
+	config := map[string]any{
+		"ring_size": float64(wire.RingMinSize),
+		"retries":   float64(1000),
+	}
+	r, err := new(config, endpointFD)
+	if err != nil {
+		t.Fatalf("New(): %v", err)
+	}
+	defer r.Stop()
+
+	// Send enough points to wrap around the ring a few times.
+	const count = 10000
+	for i := 0; i < count; i++ {
+		info := pb.ExitNotifyParentInfo{ExitStatus: int32(i)}
+		if err := r.ExitNotifyParent(nil, seccheck.FieldSet{}, &info); err != nil {
+			t.Fatalf("ExitNotifyParent: %v", err)
+		}
+	}
+	check := func() error {
+		gotRaw := server.out.String()
+		got := strings.Join(strings.Fields(gotRaw), " ")
+		if want := fmt.Sprintf("ExitNotifyParentInfo => exit_status: %d", count-1); !strings.Contains(got, want) {
+			return fmt.Errorf("last point didn't get to the server, out: %q", got)
+		}
+		return nil
+	}
+	if err := testutil.Poll(check, 10*time.Second); err != nil {
+		t.Fatalf("%s", err.Error())
+	}
+	if dropped := r.Status().DroppedCount; dropped != 0 {
+		t.Errorf("%d points dropped", dropped)
+	}
+}
+
+// sendRing sends a ring of size bytes to fd, with a memfd sealed with seals.
+func sendRing(fd int, size uint64, seals int) error {
+	memFD, err := unix.MemfdCreate("ring", unix.MFD_CLOEXEC|unix.MFD_ALLOW_SEALING)
+	if err != nil {
+		return fmt.Errorf("memfd_create(): %w", err)
+	}
+	defer unix.Close(memFD)
+	if err := unix.Ftruncate(memFD, int64(wire.RingHeaderSize+size)); err != nil {
+		return fmt.Errorf("ftruncate(): %w", err)
+	}
+	if seals != 0 {
+		if _, err := unix.FcntlInt(uintptr(memFD), unix.F_ADD_SEALS, seals); err != nil {
+			return fmt.Errorf("fcntl(F_ADD_SEALS): %w", err)
+		}
+	}
+	doorbell, err := unix.Eventfd(0, unix.EFD_CLOEXEC)
+	if err != nil {
+		return fmt.Errorf("eventfd(): %w", err)
+	}
+	defer unix.Close(doorbell)
+
+	hdr := wire.Header{HeaderSize: wire.HeaderStructSize}
+	var hdrOut [wire.HeaderStructSize]byte
+	hdr.MarshalUnsafe(hdrOut[:])
+	return unix.Sendmsg(fd, hdrOut[:], unix.UnixRights(memFD, doorbell), nil, 0)
+}
+
+func TestRingSeals(t *testing.T) {
+	for _, tc := range []struct {
+		name  string
+		seals int
+		ok    bool
+	}{
+		{name: "none"},
+		{name: "shrink", seals: unix.F_SEAL_SHRINK},
+		{name: "grow", seals: unix.F_SEAL_GROW},
+		{name: "shrink-grow", seals: unix.F_SEAL_SHRINK | unix.F_SEAL_GROW, ok: true},
+	} {
+		t.Run(tc.name, func(t *testing.T) {
+			fds, err := unix.Socketpair(unix.AF_UNIX, unix.SOCK_SEQPACKET|unix.SOCK_CLOEXEC, 0)
+			if err != nil {
+				t.Fatalf("socketpair(): %v", err)
+			}
+			defer unix.Close(fds[0])
+			defer unix.Close(fds[1])
+
+			if err := sendRing(fds[1], wire.RingMinSize, tc.seals); err != nil {
+				t.Fatalf("sendRing(): %v", err)
+			}
+			r, err := receiveRing(fds[0], wire.RingMinSize)
+			if err == nil {
+				r.close()
+			}
+			if tc.ok && err != nil {
+				t.Errorf("receiveRing(): %v", err)
+			} else if !tc.ok && err == nil {
+				t.Errorf("receiveRing() succeeded with seals %#x", tc.seals)
+			}
+		})
+	}
+}
+
+func TestRingUnsupported(t *testing.T) {
+	server, err := test.NewServer()
+	if err != nil {
+		t.Fatalf("newServer(): %v", err)
+	}
+	defer server.Close()
+
+	_, err = setup(server.Endpoint, wire.RingMinSize)
+	if err == nil {
+		t.Fatalf("setup() with ring succeeded with server that doesn't support it")
+	}
+}
+
 func TestConfig(t *testing.T) {
 	for _, tc := range []struct {
 		name   string
@@ -287,6 +417,13 @@ func TestConfig(t *testing.T) {
 			},
 			err: "cannot be larger than max",
 		},
+		{
+			name: "bad-ring-size",
+			config: map[string]any{
+				"ring_size": float64(wire.RingMinSize + 1),
+			},
+			err: "must be a power of 2",
+		},
 	} {
 		t.Run(tc.name, func(t *testing.T) {
 			var endpoint fd.FD
@@ -315,7 +452,7 @@ func BenchmarkSmall(t *testing.B) {
 	}
 	defer server.stop()
 
-	endpoint, err := setup(server.path)
+	endpoint, err := setup(server.path, 0)
 	if err != nil {
 		t.Fatalf("setup(): %v", err)
 	}
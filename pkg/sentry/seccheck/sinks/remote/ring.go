@@ -0,0 +1,238 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package remote
+
+import (
+	"errors"
+	"fmt"
+	"time"
+
+	"golang.org/x/sys/unix"
+	"gvisor.dev/gvisor/pkg/atomicbitops"
+	"gvisor.dev/gvisor/pkg/hostarch"
+	pb "gvisor.dev/gvisor/pkg/sentry/seccheck/points/points_go_proto"
+	"gvisor.dev/gvisor/pkg/sentry/seccheck/sinks/remote/wire"
+	"gvisor.dev/gvisor/pkg/sync"
+)
+
+// ringSetupTimeout is how long to wait for the remote to send the ring file
+// descriptors. They are sent right after the handshake, so they are normally
+// already queued in the socket by the time the sink is created.
+const ringSetupTimeout = 5 * time.Second
+
+// ring is the producer side of the shared memory ring transport. See
+// wire.RingHeaderSize for a description of the protocol.
+type ring struct {
+	mu sync.Mutex
+
+	// mem is the mapping of the memfd shared with the remote. It's set to nil
+	// after the ring is closed.
+	//
+	// +checklocks:mu
+	mem []byte
+
+	// data is the data area of mem. len(data) is a power of 2.
+	//
+	// +checklocks:mu
+	data []byte
+
+	// producer, consumer and flags point to the shared values in the ring
+	// header. Only the sentry updates producer.
+	producer *atomicbitops.Uint64
+	consumer *atomicbitops.Uint64
+	flags    *atomicbitops.Uint32
+
+	// doorbell is the eventfd used to wake up the remote.
+	doorbell int
+
+	// cachedProducer is the last value stored to producer.
+	//
+	// +checklocks:mu
+	cachedProducer uint64
+}
+
+// parseRingSize returns the ring size set in the configuration, or 0 if it's
+// not set.
+func parseRingSize(config map[string]any) (uint64, error) {
+	opaque, ok := config["ring_size"]
+	if !ok {
+		return 0, nil
+	}
+	sizeFloat, ok := opaque.(float64)
+	if !ok {
+		return 0, fmt.Errorf("ring_size %q is not an int", opaque)
+	}
+	size := uint64(sizeFloat)
+	if float64(size) != sizeFloat {
+		return 0, fmt.Errorf("ring_size %v is not an int", opaque)
+	}
+	if size < wire.RingMinSize || size > wire.RingMaxSize || size&(size-1) != 0 {
+		return 0, fmt.Errorf("ring_size %d must be a power of 2 between %d and %d", size, wire.RingMinSize, wire.RingMaxSize)
+	}
+	return size, nil
+}
+
+// receiveRing receives the ring file descriptors sent by the remote after the
+// handshake and maps the ring.
+func receiveRing(endpoint int, size uint64) (*ring, error) {
+	// Wait with ppoll rather than a blocking recvmsg, which the sentry
+	// seccomp filters don't allow.
+	if err := waitReadable(endpoint, ringSetupTimeout); err != nil {
+		return nil, fmt.Errorf("waiting for ring file descriptors: %w", err)
+	}
+	var hdrIn [wire.HeaderStructSize]byte
+	oob := make([]byte, unix.CmsgSpace(2*4))
+	n, oobn, flags, _, err := unix.Recvmsg(endpoint, hdrIn[:], oob, unix.MSG_DONTWAIT|unix.MSG_TRUNC)
+	if err != nil {
+		return nil, fmt.Errorf("receiving ring file descriptors: %w", err)
+	}
+
+	var fds []int
+	if msgs, err := unix.ParseSocketControlMessage(oob[:oobn]); err == nil && len(msgs) == 1 {
+		fds, _ = unix.ParseUnixRights(&msgs[0])
+	}
+	defer func() {
+		for _, fd := range fds {
+			_ = unix.Close(fd)
+		}
+	}()
+	if flags&(unix.MSG_TRUNC|unix.MSG_CTRUNC) != 0 || n != wire.HeaderStructSize || len(fds) != 2 {
+		return nil, fmt.Errorf("invalid ring setup message, size: %d, flags: %#x, fds: %d", n, flags, len(fds))
+	}
+	hdr := wire.Header{}
+	hdr.UnmarshalUnsafe(hdrIn[:])
+	if hdr.MessageType != uint16(pb.MessageType_MESSAGE_UNKNOWN) {
+		return nil, fmt.Errorf("invalid ring setup message type: %d", hdr.MessageType)
+	}
+
+	memFD := fds[0]
+	// The ring is mapped shared with the remote, which could otherwise
+	// truncate the file to make the sentry fault when accessing the mapping.
+	// Seals can't be removed, so once they are checked the size can't change.
+	const requiredSeals = unix.F_SEAL_SHRINK | unix.F_SEAL_GROW
+	seals, err := unix.FcntlInt(uintptr(memFD), unix.F_GET_SEALS, 0)
+	if err != nil {
+		return nil, fmt.Errorf("fcntl(ring, F_GET_SEALS): %w", err)
+	}
+	if seals&requiredSeals != requiredSeals {
+		return nil, fmt.Errorf("ring file must be sealed with F_SEAL_SHRINK and F_SEAL_GROW, seals: %#x", seals)
+	}
+	var stat unix.Stat_t
+	if err := unix.Fstat(memFD, &stat); err != nil {
+		return nil, fmt.Errorf("fstat(ring): %w", err)
+	}
+	mapSize := wire.RingHeaderSize + size
+	if uint64(stat.Size) != mapSize {
+		return nil, fmt.Errorf("wrong ring file size, want: %d, got: %d", mapSize, stat.Size)
+	}
+	mem, err := unix.Mmap(memFD, 0, int(mapSize), unix.PROT_READ|unix.PROT_WRITE, unix.MAP_SHARED)
+	if err != nil {
+		return nil, fmt.Errorf("mmap(ring): %w", err)
+	}
+
+	r := &ring{
+		mem:      mem,
+		data:     mem[wire.RingHeaderSize:],
+		doorbell: fds[1],
+	}
+	r.init()
+	// The doorbell is now owned by the ring.
+	fds = fds[:1]
+	return r, nil
+}
+
+// waitReadable waits until fd is readable, for at most timeout.
+func waitReadable(fd int, timeout time.Duration) error {
+	events := []unix.PollFd{{Fd: int32(fd), Events: unix.POLLIN}}
+	for deadline := time.Now().Add(timeout); ; {
+		remaining := time.Until(deadline)
+		if remaining <= 0 {
+			return unix.ETIMEDOUT
+		}
+		ts := unix.NsecToTimespec(remaining.Nanoseconds())
+		n, err := unix.Ppoll(events, &ts, nil)
+		if errors.Is(err, unix.EINTR) {
+			continue
+		}
+		if err != nil {
+			return err
+		}
+		if n == 0 {
+			return unix.ETIMEDOUT
+		}
+		// Errors and hang ups are reported by recvmsg.
+		return nil
+	}
+}
+
+// write copies a message made of hdr and payload into the ring. It returns
+// EAGAIN if there is no space for it.
+func (r *ring) write(hdr, payload []byte) error {
+	size := len(hdr) + len(payload)
+	need := uint64(4+size+wire.RingAlignment-1) &^ (wire.RingAlignment - 1)
+
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	if r.mem == nil {
+		return unix.EBADF
+	}
+	ringSize := uint64(len(r.data))
+	if need > ringSize {
+		return unix.EMSGSIZE
+	}
+	pos := r.cachedProducer
+	off := pos & (ringSize - 1)
+	var pad uint64
+	if off+need > ringSize {
+		// Messages are never split, skip to the beginning of the data area.
+		pad = ringSize - off
+	}
+	if pos+pad+need-r.consumer.Load() > ringSize {
+		return unix.EAGAIN
+	}
+	if pad > 0 {
+		hostarch.ByteOrder.PutUint32(r.data[off:], wire.RingPadding)
+		off = 0
+	}
+	hostarch.ByteOrder.PutUint32(r.data[off:], uint32(size))
+	copy(r.data[off+4:], hdr)
+	copy(r.data[off+4+uint64(len(hdr)):], payload)
+	r.cachedProducer = pos + pad + need
+	r.producer.Store(r.cachedProducer)
+
+	// The remote sets the flag and then checks producer before waiting, so
+	// either it sees the message or we see the flag.
+	if r.flags.Load()&wire.RingFlagWakeup != 0 && r.flags.CompareAndSwap(wire.RingFlagWakeup, 0) {
+		var one [8]byte
+		hostarch.ByteOrder.PutUint64(one[:], 1)
+		// The remote is responsible for draining the eventfd, if it's full
+		// there is a wake up pending anyway.
+		_, _ = unix.Write(r.doorbell, one[:])
+	}
+	return nil
+}
+
+// close unmaps the ring. Subsequent writes fail.
+func (r *ring) close() {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	if r.mem == nil {
+		return
+	}
+	_ = unix.Munmap(r.mem)
+	_ = unix.Close(r.doorbell)
+	r.mem = nil
+	r.data = nil
+}
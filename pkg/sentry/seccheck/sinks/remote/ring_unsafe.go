@@ -0,0 +1,33 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package remote
+
+import (
+	"unsafe"
+
+	"gvisor.dev/gvisor/pkg/atomicbitops"
+	"gvisor.dev/gvisor/pkg/sentry/seccheck/sinks/remote/wire"
+)
+
+// init points the shared values to the ring header. It must be called before
+// the ring is used.
+//
+// +checklocksignore
+func (r *ring) init() {
+	r.producer = (*atomicbitops.Uint64)(unsafe.Pointer(&r.mem[wire.RingProducerOffset]))
+	r.consumer = (*atomicbitops.Uint64)(unsafe.Pointer(&r.mem[wire.RingConsumerOffset]))
+	r.flags = (*atomicbitops.Uint32)(unsafe.Pointer(&r.mem[wire.RingFlagsOffset]))
+	r.cachedProducer = r.producer.Load()
+}
@@ -18,6 +18,11 @@ package wire
 // CurrentVersion is the current wire and protocol version.
 const CurrentVersion = 1
 
+// RingVersion is the protocol version that adds the shared memory ring
+// transport. The sentry only reports it in the handshake when it requests a
+// ring, so remotes that don't support the ring are not affected otherwise.
+const RingVersion = 2
+
 // HeaderStructSize size of header struct in bytes.
 const HeaderStructSize = 8
 
@@ -45,3 +50,50 @@ type Header struct {
 	// be dropped. It wraps around after max(uint32).
 	DroppedCount uint32
 }
+
+// The shared memory ring is an alternative to sending messages over the socket,
+// which saves a write from the sentry and a read from the remote per message.
+// The sentry requests it by reporting RingVersion and setting ring_size in the
+// handshake. A remote that supports it replies with RingVersion and the same
+// ring_size, and then sends a message with a header where MessageType is
+// MESSAGE_UNKNOWN, with two file descriptors attached with SCM_RIGHTS: a memfd
+// of RingHeaderSize+ring_size bytes, sealed with F_SEAL_SHRINK and
+// F_SEAL_GROW, and an eventfd used as doorbell. The socket is still used to
+// detect when the peer goes away.
+//
+// The memfd starts with a header followed by the data area:
+//
+//	0 ------ 8 ---- 64 ------ 72 ---- 128 --- 132 ---- RingHeaderSize ---+
+//	| Producer |  ... | Consumer |  ...  | Flags |  ...  | Data...        |
+//	+--- 64 ---+------+--- 64 ---+-------+- 32 --+-------+----------------+
+//
+// Producer and Consumer are byte positions in the data area that only increase
+// and wrap around ring_size. Only the sentry writes Producer and only the remote
+// writes Consumer. Each message in the data area is a 32-bit length followed by
+// the message as it would have been sent over the socket (header and payload),
+// padded so that the next message starts at a multiple of RingAlignment. A
+// length equal to RingPadding means that the rest of the data area is unused
+// and the next message starts at the beginning of the data area. All integers
+// are in native byte order.
+//
+// Before waiting on the eventfd, the remote sets RingFlagWakeup in Flags and
+// then checks Producer again. After publishing messages, the sentry writes to
+// the eventfd if it's the one to clear RingFlagWakeup. When the ring is full,
+// messages are dropped and counted in Header.DroppedCount, as they are when the
+// socket is full.
+const (
+	RingHeaderSize     = 4096
+	RingProducerOffset = 0
+	RingConsumerOffset = 64
+	RingFlagsOffset    = 128
+
+	RingAlignment = 8
+	RingPadding   = ^uint32(0)
+
+	RingFlagWakeup = 1
+
+	// RingMinSize and RingMaxSize are the limits for ring_size, which must
+	// also be a power of 2.
+	RingMinSize = 64 << 10
+	RingMaxSize = 1 << 30
+)
@@ -49,11 +49,20 @@ func Mmap(t *kernel.Task, sysno uintptr, args arch.SyscallArguments) (uintptr, *
 	fixed := flags&linux.MAP_FIXED != 0
 	private := flags&linux.MAP_PRIVATE != 0
 	shared := flags&linux.MAP_SHARED != 0
+	droppable := flags&linux.MAP_DROPPABLE != 0
 	anon := flags&linux.MAP_ANONYMOUS != 0
 	map32bit := flags&linux.MAP_32BIT != 0
 
-	// Require exactly one of MAP_PRIVATE and MAP_SHARED.
-	if private == shared {
+	// Require exactly one of MAP_PRIVATE, MAP_SHARED and MAP_DROPPABLE.
+	if droppable {
+		// MAP_DROPPABLE mappings are private and anonymous. The sentry never
+		// drops their pages under memory pressure, which Linux permits but
+		// does not require, but they are zeroed in the child on fork.
+		if private || shared || !anon {
+			return 0, nil, linuxerr.EINVAL
+		}
+		private = true
+	} else if private == shared {
 		return 0, nil, linuxerr.EINVAL
 	}
 
@@ -70,9 +79,10 @@ func Mmap(t *kernel.Task, sysno uintptr, args arch.SyscallArguments) (uintptr, *
 			Write:   linux.PROT_WRITE&prot != 0,
 			Execute: linux.PROT_EXEC&prot != 0,
 		},
-		MaxPerms:  hostarch.AnyAccess,
-		GrowsDown: linux.MAP_GROWSDOWN&flags != 0,
-		Stack:     linux.MAP_STACK&flags != 0,
+		MaxPerms:   hostarch.AnyAccess,
+		GrowsDown:  linux.MAP_GROWSDOWN&flags != 0,
+		Stack:      linux.MAP_STACK&flags != 0,
+		WipeOnFork: droppable,
 	}
 	if linux.MAP_POPULATE&flags != 0 {
 		opts.PlatformEffect = memmap.PlatformEffectCommit
@@ -249,3 +249,25 @@ func clockGettime(c ClockID) (ReferenceNS, error) {
 
 	return ReferenceNS(ts.Nano()), nil
 }
+
+// hostClockTAI is the host's CLOCK_TAI. It isn't a ClockID of Clocks, since
+// the sentry derives TAI from Realtime; see HostTAIOffset.
+const hostClockTAI ClockID = 11
+
+// HostTAIOffset returns the offset of the host's CLOCK_TAI from its
+// CLOCK_REALTIME in nanoseconds, which is a whole number of seconds (the
+// leap seconds that NTP has told the host kernel about). It returns 0 if the
+// host doesn't support CLOCK_TAI or its offset has never been set.
+func HostTAIOffset() int64 {
+	var realtime, tai unix.Timespec
+	if vdsoClockGettime(Realtime, &realtime) != 0 || vdsoClockGettime(hostClockTAI, &tai) != 0 {
+		return 0
+	}
+	// The two reads are a few nanoseconds apart, so round to the nearest
+	// second.
+	offset := (tai.Nano() - realtime.Nano() + 5e8) / 1e9
+	if offset < 0 {
+		return 0
+	}
+	return offset * 1e9
+}
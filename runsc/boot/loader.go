@@ -978,10 +978,22 @@ func createPlatform(conf *config.Config, numCPU int, deviceFile *fd.FD, sandboxI
 	}
 
 	log.Infof("Platform: %s", platformName)
+	var faultAroundBytes, warmStubProcesses, contextQueueCapacity uint64
+	if platformName == "systrap" {
+		faultAroundBytes = conf.SystrapFaultAroundBytes
+		warmStubProcesses = conf.SystrapWarmStubProcesses
+		contextQueueCapacity = conf.SystrapContextQueueCapacity
+	}
 	return p.New(platform.Options{
 		DeviceFile:             deviceFile,
 		DisableSyscallPatching: platformName == "systrap" && conf.SystrapDisableSyscallPatching,
 		DisableFastPath:        platformName == "systrap" && conf.SystrapDisableFastPath,
+		PowerEfficientSpin:     platformName == "systrap" && conf.SystrapPowerEfficientSpin,
+		VsyscallVDSO:           platformName == "systrap" && conf.SystrapVsyscallVDSO,
+		StubHugePages:          platformName == "systrap" && conf.SystrapHugePages,
+		FaultAroundBytes:       faultAroundBytes,
+		WarmStubProcesses:      warmStubProcesses,
+		ContextQueueCapacity:   contextQueueCapacity,
 		ApplicationCores:       numCPU,
 		UseCPUNums:             platformName == "kvm" && conf.UseCPUNums,
 		SandboxID:              sandboxID,
@@ -238,6 +238,7 @@ func newProcInternalData(conf *config.Config, spec *specs.Spec) *proc.InternalDa
 		AppDrivenCheckpointEnabled: appDrivenCheckpointEnabled,
 		SaveTriggerEnabled:         specutils.AnnotationToBool(spec, annotationCheckpointEnable),
 		FSCheckpointEnabled:        specutils.AnnotationToBool(spec, annotationFSCheckpointEnable),
+		ProfileTriggerEnabled:      conf.ProfileEnable && conf.ProfileAppTrigger,
 	}
 }
 
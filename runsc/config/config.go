@@ -270,6 +270,10 @@ type Config struct {
 	// duration of the container execution. Requires ProfileEnabled.
 	ProfileMutex string `flag:"profile-mutex"`
 
+	// ProfileAppTrigger lets the application collect CPU and mutex profiles
+	// of the sentry through /proc/gvisor/profile. Requires ProfileEnabled.
+	ProfileAppTrigger bool `flag:"profile-app-trigger"`
+
 	// TraceFile collects a Go runtime execution trace to the passed file
 	// for the duration of the container execution.
 	TraceFile string `flag:"trace"`
@@ -434,6 +438,31 @@ type Config struct {
 	// SystrapDisableFastPath disables the Systrap fast path entirely.
 	SystrapDisableFastPath bool `flag:"systrap-disable-fast-path"`
 
+	// SystrapPowerEfficientSpin makes Systrap stub threads wait for the
+	// context queue to be written to while spinning, rather than poll it.
+	SystrapPowerEfficientSpin bool `flag:"systrap-power-efficient-spin"`
+
+	// SystrapVsyscallVDSO makes Systrap stub threads redirect vsyscalls to
+	// the VDSO functions that implement them, rather than trap into the
+	// Sentry.
+	SystrapVsyscallVDSO bool `flag:"systrap-vsyscall-vdso"`
+
+	// SystrapHugePages makes Systrap back the thread contexts that it
+	// shares with stub threads with huge pages where possible.
+	SystrapHugePages bool `flag:"systrap-huge-pages"`
+
+	// SystrapFaultAroundBytes is the size of the window of anonymous memory
+	// that Systrap populates around application page faults.
+	SystrapFaultAroundBytes uint64 `flag:"systrap-fault-around-bytes"`
+
+	// SystrapWarmStubProcesses is the number of idle stub processes that
+	// Systrap keeps ready for new address spaces.
+	SystrapWarmStubProcesses uint64 `flag:"systrap-warm-stub-processes"`
+
+	// SystrapContextQueueCapacity is the capacity of Systrap context queues,
+	// which bounds the number of application threads of each stub process.
+	SystrapContextQueueCapacity uint64 `flag:"systrap-context-queue-capacity"`
+
 	// Nftables enables support for nftables to be used instead of iptables.
 	Nftables bool `flag:"TESTONLY-nftables"`
 
@@ -511,6 +540,9 @@ func (c *Config) Validate() error {
 	if c.ProfileMutex != "" && !c.ProfileEnable {
 		return fmt.Errorf("profile-mutex flag requires enabling profiling with profile flag")
 	}
+	if c.ProfileAppTrigger && !c.ProfileEnable {
+		return fmt.Errorf("profile-app-trigger flag requires enabling profiling with profile flag")
+	}
 	if c.FSGoferHostUDS && c.HostUDS != HostUDSNone {
 		// Deprecated flag was used together with flag that replaced it.
 		return fmt.Errorf("fsgofer-host-uds has been replaced with host-uds flag")
@@ -109,6 +109,7 @@ func RegisterFlags(flagSet *flag.FlagSet) {
 	flagSet.Duration("profile-gc-interval", 0, "forces a garbage collection cycle every this duration while another type of time-based profiling is enabled. Requires -profile=true.")
 	flagSet.String("profile-heap", "", "collects a heap profile to this file path for the duration of the container execution. Requires -profile=true.")
 	flagSet.String("profile-mutex", "", "collects a mutex profile to this file path for the duration of the container execution. Requires -profile=true.")
+	flagSet.Bool("profile-app-trigger", false, "lets the application collect CPU and mutex profiles of the sandbox through /proc/gvisor/profile. This exposes sandbox internals to the application (DO NOT USE IN PRODUCTION). Requires -profile=true.")
 	flagSet.String("trace", "", "collects a Go runtime execution trace to this file path for the duration of the container execution.")
 	flagSet.Bool("rootless", false, "it allows the sandbox to be started with a user that is not root. Sandbox and Gofer processes may run with same privileges as current user.")
 	flagSet.Var(leakModePtr(refs.NoLeakChecking), "ref-leak-mode", "sets reference leak check mode: disabled (default), log-names, log-traces.")
@@ -122,6 +123,12 @@ func RegisterFlags(flagSet *flag.FlagSet) {
 	flagSet.Var(RestoreSpecValidationEnforce.Ptr(), "restore-spec-validation", "how to handle spec validation during restore.")
 	flagSet.Bool("systrap-disable-syscall-patching", false, "disables syscall patching when using the Systrap platform. May be necessary to use in case the workload uses the GS register, or uses ptrace within gVisor. Has significant performance implications and is only recommended when the sandbox is known to run otherwise-incompatible workloads. Only relevant for x86.")
 	flagSet.Bool("systrap-disable-fast-path", false, "unconditionally disables the Systrap fast path.")
+	flagSet.Bool("systrap-power-efficient-spin", false, "makes Systrap stub threads that spin waiting for work wait for the context queue to be written to with UMWAIT (x86, if WAITPKG is supported) or WFE (arm64), rather than busy-poll it. Reduces the power and SMT sibling cycles used by spinning, at the cost of some wakeup latency.")
+	flagSet.Bool("systrap-vsyscall-vdso", false, "makes Systrap stub threads redirect legacy vsyscall calls of gettimeofday, time and getcpu to the corresponding VDSO functions, rather than handle them in the Sentry. Vsyscalls made by traced tasks or tasks with seccomp filters are still handled by the Sentry. Only relevant for x86.")
+	flagSet.Bool("systrap-huge-pages", false, "makes Systrap back the thread context region that it shares with stub threads with huge pages, to reduce TLB misses in the Sentry with many application threads. Only takes effect if the host shmem_enabled transparent huge page setting allows huge pages on MADV_HUGEPAGE.")
+	flagSet.Uint64("systrap-fault-around-bytes", 0, "size of the aligned window of anonymous memory that the Systrap platform populates when handling an application page fault. Must be 0 (disabled) or a power-of-2 multiple of the page size.")
+	flagSet.Uint64("systrap-warm-stub-processes", 0, "number of idle stub processes, at most 16, that the Systrap platform keeps ready so that new address spaces, e.g. from fork and exec, don't wait for one to be created. Each one is an additional host process in the sandbox.")
+	flagSet.Uint64("systrap-context-queue-capacity", 0, "capacity of the queue of application threads waiting for a Systrap stub thread, which also bounds the number of application threads per stub process to one less. Must be 0 (default, 4096) or a power of 2 in [64, 32768]. Smaller capacities reduce the memory and cache footprint of each stub process.")
 	flagSet.Bool("allow-suid", false, "allows ID elevation when executing binaries with the SUID/SGID bits set. The OCI --no-new-privileges flag continues to prevent ID elevation even when this flag is true.")
 	flagSet.Bool("kvm-use-cpu-nums", false, "on KVM use vCPU numbers as CPU numbers in the sentry. This is necessary to support features like rseq.")
 	flagSet.Bool("allow-rootfs-tar-annotation", false, "allows the rootfs tar annotation to be set.")
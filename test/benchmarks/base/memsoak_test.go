@@ -0,0 +1,208 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package memsoak_test
+
+import (
+	"context"
+	"flag"
+	"fmt"
+	"os"
+	"regexp"
+	"strconv"
+	"testing"
+	"time"
+
+	"gvisor.dev/gvisor/pkg/test/dockerutil"
+	"gvisor.dev/gvisor/test/benchmarks/harness"
+	"gvisor.dev/gvisor/test/benchmarks/tools"
+	"gvisor.dev/gvisor/test/metricsviz"
+)
+
+var (
+	soakDuration   = flag.Duration("soak_duration", 5*time.Minute, "How long the memory soak workload runs.")
+	sampleInterval = flag.Duration("sample_interval", 10*time.Second, "How often memory usage is sampled during the soak.")
+	workingSet     = flag.Uint64("working_set", 256<<20, "Bytes of anonymous memory kept resident by the workload.")
+)
+
+// sample is a measurement of the memory used by the container.
+type sample struct {
+	// elapsed is the time since the workload started.
+	elapsed time.Duration
+	// host is the usage of the container's cgroup on the host, which for
+	// gVisor includes the sentry, gofer and page tables.
+	host uint64
+	// sandbox is the used memory reported by /proc/meminfo in the
+	// container, i.e. what the sandbox accounts to the application.
+	sandbox uint64
+}
+
+// BenchmarkMemorySoak runs a workload that keeps --working_set bytes resident
+// while churning through mmap, munmap, madvise(MADV_DONTNEED) and fork for
+// --soak_duration, and samples memory usage from the host and from inside the
+// container.
+//
+// It reports the memory used beyond the working set for each byte of it,
+// which is what determines how densely sandboxes can be packed, and the rate
+// at which host usage grows over the soak, which should be zero for a workload
+// whose working set doesn't change. Early samples are skipped for the growth
+// rate, since they include the working set being faulted in.
+func BenchmarkMemorySoak(b *testing.B) {
+	ctx := context.Background()
+	machine, err := harness.GetMachine()
+	if err != nil {
+		b.Fatalf("failed to get machine: %v", err)
+	}
+	defer machine.CleanUp()
+
+	container := machine.GetContainer(ctx, b)
+	defer container.CleanUp(ctx)
+	if err := container.Spawn(ctx, dockerutil.RunOpts{
+		Image: "benchmarks/memsoak",
+	}, "memsoak", fmt.Sprintf("--seconds=%d", int64(soakDuration.Seconds())), fmt.Sprintf("--bytes=%d", *workingSet)); err != nil {
+		b.Fatalf("failed to run container: %v", err)
+	}
+	defer metricsviz.FromContainerLogs(ctx, b, container)
+
+	b.ResetTimer()
+	var samples []sample
+	start := time.Now()
+	ticker := time.NewTicker(*sampleInterval)
+	defer ticker.Stop()
+	for range ticker.C {
+		elapsed := time.Since(start)
+		if elapsed >= *soakDuration {
+			break
+		}
+		s, err := takeSample(ctx, container)
+		if err != nil {
+			b.Fatalf("failed to sample memory usage: %v", err)
+		}
+		s.elapsed = elapsed
+		samples = append(samples, s)
+	}
+	if err := container.WaitTimeout(ctx, time.Minute); err != nil {
+		b.Fatalf("workload failed: %v", err)
+	}
+	b.StopTimer()
+
+	logs, err := container.Logs(ctx)
+	if err != nil {
+		b.Fatalf("failed to get logs: %v", err)
+	}
+	ops, resident, err := parseProgress(logs)
+	if err != nil {
+		b.Fatalf("failed to parse workload output: %v", err)
+	}
+	// Skip the first quarter of the soak, while the working set is brought
+	// in and caches fill up.
+	steady := samples[len(samples)/4:]
+	if len(steady) < 2 {
+		b.Fatalf("only %d samples in steady state, increase --soak_duration or decrease --sample_interval", len(steady))
+	}
+
+	var hostSum, sandboxSum, hostMax float64
+	for _, s := range steady {
+		hostSum += float64(s.host)
+		sandboxSum += float64(s.sandbox)
+		hostMax = max(hostMax, float64(s.host))
+	}
+	n := float64(len(steady))
+	ws := float64(resident)
+	tools.ReportCustomMetric(b, (hostSum/n-ws)/ws, "host_overhead_per_app_byte", "ratio")
+	tools.ReportCustomMetric(b, (sandboxSum/n-ws)/ws, "sandbox_overhead_per_app_byte", "ratio")
+	tools.ReportCustomMetric(b, hostMax, "host_max_usage", "bytes")
+	tools.ReportCustomMetric(b, growthPerMinute(steady), "host_usage_growth", "bytes_per_minute")
+	tools.ReportCustomMetric(b, float64(ops)/soakDuration.Seconds(), "workload_ops", "ops_per_second")
+}
+
+// takeSample measures the memory used by the container.
+func takeSample(ctx context.Context, container *dockerutil.Container) (sample, error) {
+	stats, err := container.Stats(ctx)
+	if err != nil {
+		return sample{}, fmt.Errorf("failed to get container stats: %w", err)
+	}
+	meminfo, err := container.Exec(ctx, dockerutil.ExecOpts{}, "cat", "/proc/meminfo")
+	if err != nil {
+		return sample{}, fmt.Errorf("failed to read /proc/meminfo: %w", err)
+	}
+	used, err := parseMemUsed(meminfo)
+	if err != nil {
+		return sample{}, err
+	}
+	return sample{host: stats.MemoryStats.Usage, sandbox: used}, nil
+}
+
+var (
+	memTotalRE = regexp.MustCompile(`MemTotal:\s*(\d+) kB`)
+	memFreeRE  = regexp.MustCompile(`MemFree:\s*(\d+) kB`)
+	progressRE = regexp.MustCompile(`ops: (\d+) bytes: (\d+)`)
+)
+
+// parseMemUsed returns MemTotal - MemFree from /proc/meminfo, in bytes.
+func parseMemUsed(data string) (uint64, error) {
+	var kb [2]uint64
+	for i, re := range []*regexp.Regexp{memTotalRE, memFreeRE} {
+		match := re.FindStringSubmatch(data)
+		if len(match) < 2 {
+			return 0, fmt.Errorf("couldn't find %v in %q", re, data)
+		}
+		v, err := strconv.ParseUint(match[1], 10, 64)
+		if err != nil {
+			return 0, err
+		}
+		kb[i] = v
+	}
+	return (kb[0] - kb[1]) * 1024, nil
+}
+
+// parseProgress returns the number of operations and the resident working set
+// from the last progress line printed by memsoak.
+func parseProgress(logs string) (ops, resident uint64, err error) {
+	matches := progressRE.FindAllStringSubmatch(logs, -1)
+	if len(matches) == 0 {
+		return 0, 0, fmt.Errorf("no progress lines in output: %q", logs)
+	}
+	last := matches[len(matches)-1]
+	if ops, err = strconv.ParseUint(last[1], 10, 64); err != nil {
+		return 0, 0, err
+	}
+	if resident, err = strconv.ParseUint(last[2], 10, 64); err != nil {
+		return 0, 0, err
+	}
+	return ops, resident, nil
+}
+
+// growthPerMinute returns the slope of the least squares fit of host usage
+// over time.
+func growthPerMinute(samples []sample) float64 {
+	var sumX, sumY, sumXY, sumXX float64
+	for _, s := range samples {
+		x := s.elapsed.Minutes()
+		y := float64(s.host)
+		sumX += x
+		sumY += y
+		sumXY += x * y
+		sumXX += x * x
+	}
+	n := float64(len(samples))
+	return (n*sumXY - sumX*sumY) / (n*sumXX - sumX*sumX)
+}
+
+// TestMain is the main method for this package.
+func TestMain(m *testing.M) {
+	harness.Init()
+	harness.SetFixedBenchmarks()
+	os.Exit(m.Run())
+}
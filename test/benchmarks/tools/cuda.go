@@ -0,0 +1,201 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tools
+
+import (
+	"fmt"
+	"regexp"
+	"strconv"
+	"testing"
+	"time"
+)
+
+// CUDABench makes 'cuda_bench' commands, from the gpu/cuda-tests image, and
+// parses their output.
+type CUDABench struct {
+	// Bytes is the size of each transfer. If zero, cuda_bench's default is
+	// used.
+	Bytes int
+}
+
+// MakeCmd makes commands for CUDABench.
+func (c *CUDABench) MakeCmd(b *testing.B) []string {
+	cmd := []string{"/cuda_bench", fmt.Sprintf("--iterations=%d", b.N)}
+	if c.Bytes > 0 {
+		cmd = append(cmd, fmt.Sprintf("--bytes=%d", c.Bytes))
+	}
+	return cmd
+}
+
+// Report reports the relevant metrics for CUDABench.
+func (c *CUDABench) Report(b *testing.B, output string) {
+	b.Helper()
+	reportCUDAResults(b, output)
+}
+
+// CUDAMultiBench makes 'cuda_multi_bench' commands, from the gpu/cuda-tests
+// image, and parses their output.
+type CUDAMultiBench struct {
+	// Processes is the number of processes driving GPUs concurrently. If
+	// zero, one process per GPU is used.
+	Processes int
+
+	// Shared makes all processes share the first GPU, instead of each using
+	// a different one.
+	Shared bool
+
+	// Bytes is the size of each transfer. If zero, cuda_multi_bench's
+	// default is used.
+	Bytes int
+}
+
+// MakeCmd makes commands for CUDAMultiBench.
+func (c *CUDAMultiBench) MakeCmd(b *testing.B) []string {
+	cmd := []string{"/cuda_multi_bench", fmt.Sprintf("--iterations=%d", b.N)}
+	if c.Processes > 0 {
+		cmd = append(cmd, fmt.Sprintf("--processes=%d", c.Processes))
+	}
+	if c.Shared {
+		cmd = append(cmd, "--shared")
+	}
+	if c.Bytes > 0 {
+		cmd = append(cmd, fmt.Sprintf("--bytes=%d", c.Bytes))
+	}
+	return cmd
+}
+
+// Report reports the relevant metrics for CUDAMultiBench.
+func (c *CUDAMultiBench) Report(b *testing.B, output string) {
+	b.Helper()
+	reportCUDAResults(b, output)
+}
+
+// CUDACheckpoint makes 'cuda_checkpoint' commands, from the gpu/cuda-tests
+// image, and reports the duration of checkpointing and restoring the
+// container running them.
+type CUDACheckpoint struct {
+	// Bytes is the amount of device memory to fill. If zero,
+	// cuda_checkpoint's default is used.
+	Bytes int
+}
+
+// MakeCmd makes commands for CUDACheckpoint.
+func (c *CUDACheckpoint) MakeCmd() []string {
+	cmd := []string{"/cuda_checkpoint"}
+	if c.Bytes > 0 {
+		cmd = append(cmd, fmt.Sprintf("--bytes=%d", c.Bytes))
+	}
+	return cmd
+}
+
+// Report reports the relevant metrics for CUDACheckpoint. checkpoint and
+// restore are the average durations of checkpointing the container and of
+// restoring it, and resume is the average time from starting the restore to
+// the workload having verified device memory.
+func (c *CUDACheckpoint) Report(b *testing.B, output string, checkpoint, restore, resume time.Duration) {
+	b.Helper()
+	reportCUDAResults(b, output)
+	ReportCustomMetric(b, checkpoint.Seconds(), "checkpoint", "s")
+	ReportCustomMetric(b, restore.Seconds(), "restore", "s")
+	ReportCustomMetric(b, resume.Seconds(), "resume", "s")
+	if c.Bytes > 0 {
+		ReportCustomMetric(b, float64(c.Bytes)/checkpoint.Seconds(), "checkpoint_bandwidth", "bytes_per_second")
+		ReportCustomMetric(b, float64(c.Bytes)/resume.Seconds(), "restore_bandwidth", "bytes_per_second")
+	}
+}
+
+// NCCLBench makes 'nccl_bench' commands, from the gpu/nccl-tests image, and
+// parses their output.
+type NCCLBench struct {
+	// GPUs is the number of GPUs driven by each process. If zero, all GPUs
+	// visible to the process are used.
+	GPUs int
+
+	// Procs is the number of processes joining the communicator, and Proc
+	// is the index of this one. Process 0 listens on Port for the others,
+	// which connect to it at Root.
+	Procs int
+	Proc  int
+	Port  int
+	Root  string
+
+	// MaxBytes is the largest buffer size of the sweep. If zero,
+	// nccl_bench's default is used.
+	MaxBytes int
+}
+
+// MakeCmd makes commands for NCCLBench.
+func (n *NCCLBench) MakeCmd(b *testing.B) []string {
+	cmd := []string{"/nccl_bench", fmt.Sprintf("--iterations=%d", b.N)}
+	if n.GPUs > 0 {
+		cmd = append(cmd, fmt.Sprintf("--gpus=%d", n.GPUs))
+	}
+	if n.Procs > 1 {
+		cmd = append(cmd, fmt.Sprintf("--procs=%d", n.Procs), fmt.Sprintf("--proc=%d", n.Proc))
+		if n.Proc == 0 {
+			cmd = append(cmd, fmt.Sprintf("--port=%d", n.Port))
+		} else {
+			cmd = append(cmd, fmt.Sprintf("--root=%s", n.Root))
+		}
+	}
+	if n.MaxBytes > 0 {
+		cmd = append(cmd, fmt.Sprintf("--max_bytes=%d", n.MaxBytes))
+	}
+	return cmd
+}
+
+// Report reports the relevant metrics for NCCLBench. Only process 0 prints
+// results.
+func (n *NCCLBench) Report(b *testing.B, output string) {
+	b.Helper()
+	reportCUDAResults(b, output)
+}
+
+func reportCUDAResults(b *testing.B, output string) {
+	b.Helper()
+	results, err := parseCUDAResults(output)
+	if err != nil {
+		b.Fatalf("parsing results from %s failed: %v", output, err)
+	}
+	for _, r := range results {
+		ReportCustomMetric(b, r.Sample, r.Name, r.Unit)
+	}
+}
+
+var cudaResultRegexp = regexp.MustCompile(`(?m)^(\w+): (\d+\.?\d*) (GB/s|us|launches/s)$`)
+
+// parseCUDAResults parses all results printed by cuda_bench, cuda_multi_bench,
+// cuda_checkpoint and nccl_bench, converted to the units used by other benchmarks.
+func parseCUDAResults(data string) ([]Metric, error) {
+	var results []Metric
+	for _, match := range cudaResultRegexp.FindAllStringSubmatch(data, -1) {
+		value, err := strconv.ParseFloat(match[2], 64)
+		if err != nil {
+			return nil, fmt.Errorf("failed to parse %q: %v", match[0], err)
+		}
+		switch match[3] {
+		case "GB/s":
+			results = append(results, Metric{Name: match[1], Unit: "bytes_per_second", Sample: value * 1e9})
+		case "us":
+			results = append(results, Metric{Name: match[1], Unit: "s", Sample: value / 1e6})
+		case "launches/s":
+			results = append(results, Metric{Name: match[1], Unit: "launches_per_second", Sample: value})
+		}
+	}
+	if len(results) == 0 {
+		return nil, fmt.Errorf("no results found: %s", data)
+	}
+	return results, nil
+}
@@ -0,0 +1,57 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tools
+
+import (
+	"testing"
+
+	"github.com/google/go-cmp/cmp"
+)
+
+// TestCUDAResults checks the CUDABench, CUDAMultiBench, CUDACheckpoint and
+// NCCLBench parser on sample output.
+func TestCUDAResults(t *testing.T) {
+	sampleData := `// Device: NVIDIA H100 80GB HBM3, 67108864 bytes per transfer, 10 iterations
+memcpy_h2d_pageable: 12.500 GB/s
+memcpy_d2h_pinned: 25.000 GB/s
+// cudaDevAttrConcurrentManagedAccess not available, skipping managed memory migration
+launch_sync_latency: 8.000 us
+aggregate_launch_rate: 250000.500 launches/s
+ready
+verify_latency: 1200.000 us
+verified
+// NCCL 22105, 8 ranks (1 processes of 8 GPUs), 20 iterations
+all_reduce_busbw_1048576: 45.250 GB/s
+`
+	got, err := parseCUDAResults(sampleData)
+	if err != nil {
+		t.Fatalf("failed to parse: %v", err)
+	}
+	want := []Metric{
+		{Name: "memcpy_h2d_pageable", Unit: "bytes_per_second", Sample: 12.5e9},
+		{Name: "memcpy_d2h_pinned", Unit: "bytes_per_second", Sample: 25e9},
+		{Name: "launch_sync_latency", Unit: "s", Sample: 8e-6},
+		{Name: "aggregate_launch_rate", Unit: "launches_per_second", Sample: 250000.5},
+		{Name: "verify_latency", Unit: "s", Sample: 1.2e-3},
+		{Name: "all_reduce_busbw_1048576", Unit: "bytes_per_second", Sample: 45.25e9},
+	}
+	if diff := cmp.Diff(want, got); diff != "" {
+		t.Errorf("results mismatch (-want +got):\n%s", diff)
+	}
+
+	if _, err := parseCUDAResults("Check failed at cuda_bench.cu:10"); err == nil {
+		t.Errorf("parsing output without results succeeded")
+	}
+}
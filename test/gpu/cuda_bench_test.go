@@ -0,0 +1,124 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package cuda_bench_test benchmarks CUDA host-device transfers and kernel
+// launches, from one or several processes. Running it with runc and runsc
+// quantifies nvproxy's overhead.
+package cuda_bench_test
+
+import (
+	"context"
+	"fmt"
+	"strings"
+	"testing"
+
+	"gvisor.dev/gvisor/pkg/test/dockerutil"
+	"gvisor.dev/gvisor/test/benchmarks/tools"
+)
+
+// BenchmarkCUDATransfer runs cuda_bench with different transfer sizes.
+func BenchmarkCUDATransfer(b *testing.B) {
+	ctx := context.Background()
+	for _, size := range []int{1 << 20, 64 << 20} {
+		param := tools.Parameter{
+			Name:  "bytes",
+			Value: fmt.Sprintf("%dMiB", size>>20),
+		}
+		name, err := tools.ParametersToName(param)
+		if err != nil {
+			b.Fatalf("Failed to parse params: %v", err)
+		}
+		b.Run(name, func(b *testing.B) {
+			container := dockerutil.MakeContainer(ctx, b)
+			defer container.CleanUp(ctx)
+			opts, err := dockerutil.GPURunOpts(dockerutil.SniffGPUOpts{Capabilities: "compute,utility"})
+			if err != nil {
+				b.Fatalf("Failed to get GPU run options: %v", err)
+			}
+			opts.Image = "gpu/cuda-tests"
+			if err := container.Spawn(ctx, opts, "sleep", "24h"); err != nil {
+				b.Fatalf("Failed to start container: %v", err)
+			}
+
+			bench := tools.CUDABench{Bytes: size}
+			cmd := bench.MakeCmd(b)
+			b.ResetTimer()
+			out, err := container.Exec(ctx, dockerutil.ExecOpts{}, cmd...)
+			if err != nil {
+				b.Fatalf("Failed to run cuda_bench: %v, logs: %s", err, out)
+			}
+			b.StopTimer()
+			bench.Report(b, out)
+		})
+	}
+}
+
+// BenchmarkCUDAMultiProcess runs cuda_multi_bench with a growing number of
+// processes, each driving a different GPU or all sharing one GPU, to expose
+// serialization points as the number of processes grows.
+func BenchmarkCUDAMultiProcess(b *testing.B) {
+	ctx := context.Background()
+	container := dockerutil.MakeContainer(ctx, b)
+	defer container.CleanUp(ctx)
+	opts, err := dockerutil.GPURunOpts(dockerutil.SniffGPUOpts{Capabilities: "compute,utility"})
+	if err != nil {
+		b.Fatalf("Failed to get GPU run options: %v", err)
+	}
+	opts.Image = "gpu/cuda-tests"
+	if err := container.Spawn(ctx, opts, "sleep", "24h"); err != nil {
+		b.Fatalf("Failed to start container: %v", err)
+	}
+	out, err := container.Exec(ctx, dockerutil.ExecOpts{}, "nvidia-smi", "--list-gpus")
+	if err != nil {
+		b.Fatalf("Failed to list GPUs: %v, logs: %s", err, out)
+	}
+	numGPUs := len(strings.Split(strings.TrimSpace(out), "\n"))
+
+	for _, shared := range []bool{false, true} {
+		for _, processes := range []int{1, 2, 4, 8} {
+			if !shared && processes > numGPUs {
+				continue
+			}
+			mode := tools.Parameter{
+				Name:  "mode",
+				Value: "per_gpu",
+			}
+			if shared {
+				mode.Value = "shared"
+			}
+			procs := tools.Parameter{
+				Name:  "processes",
+				Value: fmt.Sprintf("%d", processes),
+			}
+			name, err := tools.ParametersToName(mode, procs)
+			if err != nil {
+				b.Fatalf("Failed to parse params: %v", err)
+			}
+			b.Run(name, func(b *testing.B) {
+				bench := tools.CUDAMultiBench{
+					Processes: processes,
+					Shared:    shared,
+				}
+				cmd := bench.MakeCmd(b)
+				b.ResetTimer()
+				out, err := container.Exec(ctx, dockerutil.ExecOpts{}, cmd...)
+				if err != nil {
+					b.Fatalf("Failed to run cuda_multi_bench: %v, logs: %s", err, out)
+				}
+				b.StopTimer()
+				bench.Report(b, out)
+			})
+		}
+	}
+}
@@ -12,15 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// Package nccl_test runs through NCCL tests.
+// Package nccl_test runs through NCCL tests, and benchmarks NCCL collectives
+// within a sandbox and between sandboxes.
 package nccl_test
 
 import (
 	"context"
 	"fmt"
+	"net"
+	"strconv"
+	"strings"
 	"testing"
 
 	"gvisor.dev/gvisor/pkg/test/dockerutil"
+	"gvisor.dev/gvisor/test/benchmarks/tools"
 )
 
 // runNCCL runs the given script and command in a NCCL container.
@@ -62,3 +67,107 @@ func TestNCCL(t *testing.T) {
 		})
 	}
 }
+
+// ncclPort is the port nccl_bench's first process listens on for the others.
+const ncclPort = 29500
+
+// BenchmarkNCCL runs nccl_bench all-reduce and all-gather sweeps across all
+// GPUs of one sandbox. Running it with runc and runsc compares bus bandwidth
+// to native, which exposes nvproxy overhead in multi-GPU communication.
+func BenchmarkNCCL(b *testing.B) {
+	ctx := context.Background()
+	c := dockerutil.MakeContainer(ctx, b)
+	defer c.CleanUp(ctx)
+	opts, err := dockerutil.GPURunOpts(dockerutil.SniffGPUOpts{})
+	if err != nil {
+		b.Fatalf("Failed to get GPU run options: %v", err)
+	}
+	opts.Image = "gpu/nccl-tests"
+	if err := c.Spawn(ctx, opts, "sleep", "24h"); err != nil {
+		b.Fatalf("Failed to start container: %v", err)
+	}
+
+	bench := tools.NCCLBench{}
+	cmd := bench.MakeCmd(b)
+	b.ResetTimer()
+	out, err := c.Exec(ctx, dockerutil.ExecOpts{}, cmd...)
+	if err != nil {
+		b.Fatalf("Failed to run nccl_bench: %v, logs: %s", err, out)
+	}
+	b.StopTimer()
+	bench.Report(b, out)
+}
+
+// BenchmarkNCCLTwoSandboxes runs nccl_bench in two sandboxes that join the
+// same communicator and communicate over NCCL's socket transport, which goes
+// through the sandboxes' network stacks. If there are at least two GPUs, each
+// sandbox gets half of them; otherwise both share the only one.
+func BenchmarkNCCLTwoSandboxes(b *testing.B) {
+	ctx := context.Background()
+	opts, err := dockerutil.GPURunOpts(dockerutil.SniffGPUOpts{})
+	if err != nil {
+		b.Fatalf("Failed to get GPU run options: %v", err)
+	}
+	opts.Image = "gpu/nccl-tests"
+	opts.Env = append(opts.Env, "NCCL_NET=Socket", "NCCL_SOCKET_IFNAME=eth0")
+
+	c := dockerutil.MakeContainer(ctx, b)
+	out, err := c.Run(ctx, opts, "nvidia-smi", "--list-gpus")
+	c.CleanUp(ctx)
+	if err != nil {
+		b.Fatalf("Failed to list GPUs: %v, logs: %s", err, out)
+	}
+	numGPUs := len(strings.Split(strings.TrimSpace(out), "\n"))
+	perSandbox := numGPUs / 2
+	if perSandbox == 0 {
+		perSandbox = 1
+	}
+	visible := func(sandbox int) string {
+		if numGPUs < 2 {
+			return "CUDA_VISIBLE_DEVICES=0"
+		}
+		var devices []string
+		for i := sandbox * perSandbox; i < (sandbox+1)*perSandbox; i++ {
+			devices = append(devices, strconv.Itoa(i))
+		}
+		return "CUDA_VISIBLE_DEVICES=" + strings.Join(devices, ",")
+	}
+
+	rootOpts := opts
+	rootOpts.Env = append(append([]string(nil), opts.Env...), visible(0))
+	root := dockerutil.MakeContainer(ctx, b)
+	defer root.CleanUp(ctx)
+	rootBench := tools.NCCLBench{GPUs: perSandbox, Procs: 2, Proc: 0, Port: ncclPort}
+	b.ResetTimer()
+	if err := root.Spawn(ctx, rootOpts, rootBench.MakeCmd(b)...); err != nil {
+		b.Fatalf("Failed to start container: %v", err)
+	}
+	ip, err := root.FindIP(ctx, false)
+	if err != nil {
+		b.Fatalf("Failed to find IP of the first sandbox: %v", err)
+	}
+
+	peerOpts := opts
+	peerOpts.Env = append(append([]string(nil), opts.Env...), visible(1))
+	peer := dockerutil.MakeContainer(ctx, b)
+	defer peer.CleanUp(ctx)
+	peerBench := tools.NCCLBench{
+		GPUs:  perSandbox,
+		Procs: 2,
+		Proc:  1,
+		Root:  net.JoinHostPort(ip.String(), strconv.Itoa(ncclPort)),
+	}
+	if out, err := peer.Run(ctx, peerOpts, peerBench.MakeCmd(b)...); err != nil {
+		b.Fatalf("Failed to run nccl_bench in the second sandbox: %v, logs: %s", err, out)
+	}
+	err = root.Wait(ctx)
+	b.StopTimer()
+	logs, logsErr := root.Logs(ctx)
+	if logsErr != nil {
+		b.Fatalf("Failed to get logs of the first sandbox: %v", logsErr)
+	}
+	if err != nil {
+		b.Fatalf("nccl_bench failed in the first sandbox: %v, logs: %s", err, logs)
+	}
+	rootBench.Report(b, logs)
+}
@@ -12,10 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// Package sr_test runs checkpoint/restore tests for nvproxy.
+// Package sr_test runs checkpoint/restore tests and benchmarks for nvproxy.
 package sr_test
 
 import (
+	"fmt"
+	"strconv"
 	"strings"
 	"testing"
 	"time"
@@ -23,6 +25,7 @@ import (
 	"gvisor.dev/gvisor/pkg/context"
 	"gvisor.dev/gvisor/pkg/test/dockerutil"
 	"gvisor.dev/gvisor/pkg/test/testutil"
+	"gvisor.dev/gvisor/test/benchmarks/tools"
 )
 
 func TestGPUCheckpointRestore(t *testing.T) {
@@ -79,3 +82,125 @@ func TestGPUCheckpointRestore(t *testing.T) {
 		t.Fatalf("docker exec failed: %v", err)
 	}
 }
+
+// BenchmarkGPUCheckpointRestore measures how long it takes to checkpoint and
+// restore a container holding different amounts of device memory, and checks
+// that the memory is intact after restore.
+func BenchmarkGPUCheckpointRestore(b *testing.B) {
+	if !testutil.IsCheckpointSupported() {
+		b.Skip("Checkpoint is not supported.")
+	}
+	dockerutil.EnsureDockerExperimentalEnabled()
+	if !dockerutil.IsRestoreSupported() {
+		b.Skip("Restore is not supported.")
+	}
+
+	ctx := context.Background()
+	opts, err := dockerutil.GPURunOpts(dockerutil.SniffGPUOpts{
+		Capabilities: "compute,utility",
+	})
+	if err != nil {
+		b.Fatalf("failed to get GPU run options: %v", err)
+	}
+	opts.Image = "gpu/cuda-tests"
+
+	// Skip sizes that don't fit on the first GPU, keeping some headroom for
+	// the CUDA context.
+	c := dockerutil.MakeContainer(ctx, b)
+	out, err := c.Run(ctx, opts, "nvidia-smi", "--id=0", "--query-gpu=memory.total", "--format=csv,noheader,nounits")
+	c.CleanUp(ctx)
+	if err != nil {
+		b.Fatalf("failed to query GPU memory: %v, logs: %s", err, out)
+	}
+	totalMiB, err := strconv.Atoi(strings.TrimSpace(out))
+	if err != nil {
+		b.Fatalf("failed to parse GPU memory %q: %v", out, err)
+	}
+	const headroom = 2 << 30
+
+	for _, gb := range []int{1, 8, 32, 80} {
+		size := gb * 1e9
+		param := tools.Parameter{
+			Name:  "bytes",
+			Value: fmt.Sprintf("%dGB", gb),
+		}
+		name, err := tools.ParametersToName(param)
+		if err != nil {
+			b.Fatalf("Failed to parse params: %v", err)
+		}
+		b.Run(name, func(b *testing.B) {
+			if size+headroom > totalMiB<<20 {
+				b.Skipf("GPU has %d MiB of memory, need %d bytes", totalMiB, size+headroom)
+			}
+			bench := tools.CUDACheckpoint{Bytes: size}
+			var checkpoint, restore, resume time.Duration
+			var logs string
+			for i := 0; i < b.N; i++ {
+				logs = runCheckpointRestore(ctx, b, opts, &bench, &checkpoint, &restore, &resume)
+			}
+			n := time.Duration(b.N)
+			bench.Report(b, logs, checkpoint/n, restore/n, resume/n)
+		})
+	}
+}
+
+// runCheckpointRestore runs a cuda_checkpoint container, checkpoints and
+// restores it, and signals it to verify device memory. It adds the duration of
+// each step to the given totals, and returns the container logs.
+func runCheckpointRestore(ctx context.Context, b *testing.B, opts dockerutil.RunOpts, bench *tools.CUDACheckpoint, checkpoint, restore, resume *time.Duration) string {
+	b.StopTimer()
+	c := dockerutil.MakeContainer(ctx, b)
+	defer c.CleanUp(ctx)
+	if err := c.Spawn(ctx, opts, bench.MakeCmd()...); err != nil {
+		b.Fatalf("could not start cuda_checkpoint container: %v", err)
+	}
+	if _, err := c.WaitForOutput(ctx, "(?m)^ready$", 10*time.Minute); err != nil {
+		logs, _ := c.Logs(ctx)
+		b.Fatalf("cuda_checkpoint not ready: %v, logs: %s", err, logs)
+	}
+
+	b.StartTimer()
+	const ckptName = "bench"
+	start := time.Now()
+	if err := c.Checkpoint(ctx, ckptName); err != nil {
+		b.Fatalf("docker checkpoint failed: %v", err)
+	}
+	if err := c.WaitTimeout(ctx, 30*time.Minute); err != nil {
+		b.Fatalf("wait failed: %v", err)
+	}
+	*checkpoint += time.Since(start)
+
+	// TODO(b/143498576): Remove sleep after github.com/moby/moby/issues/38963
+	// is fixed.
+	b.StopTimer()
+	time.Sleep(2 * time.Second)
+	b.StartTimer()
+
+	start = time.Now()
+	if err := c.Restore(ctx, ckptName); err != nil {
+		b.Fatalf("docker restore failed: %v", err)
+	}
+	*restore += time.Since(start)
+	if out, err := c.Exec(ctx, dockerutil.ExecOpts{}, "sh", "-c", "kill -USR1 1"); err != nil {
+		b.Fatalf("failed to signal cuda_checkpoint: %v, output: %s", err, out)
+	}
+	match, err := c.WaitForOutput(ctx, "(?m)^(verified|.*mismatched after restore)$", 30*time.Minute)
+	if err != nil {
+		logs, _ := c.Logs(ctx)
+		b.Fatalf("cuda_checkpoint did not finish: %v, logs: %s", err, logs)
+	}
+	*resume += time.Since(start)
+	b.StopTimer()
+
+	logs, err := c.Logs(ctx)
+	if err != nil {
+		b.Fatalf("could not get container logs: %v", err)
+	}
+	if match != "verified" {
+		b.Fatalf("device memory changed across checkpoint/restore: %s, logs: %s", match, logs)
+	}
+	if err := c.Wait(ctx); err != nil {
+		b.Fatalf("cuda_checkpoint failed: %v, logs: %s", err, logs)
+	}
+	return logs
+}
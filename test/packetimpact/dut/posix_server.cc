@@ -16,6 +16,7 @@
 #include <getopt.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,10 +26,19 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "include/grpcpp/security/server_credentials.h"
 #include "include/grpcpp/server_builder.h"
 #include "include/grpcpp/server_context.h"
@@ -111,10 +121,19 @@
   return ::grpc::Status::OK;
 }
 
-class PosixImpl final : public posix_server::Posix::Service {
-  ::grpc::Status Accept(grpc::ServerContext *context,
-                        const ::posix_server::AcceptRequest *request,
-                        ::posix_server::AcceptResponse *response) override {
+// Returns the current CLOCK_MONOTONIC time in nanoseconds.
+int64_t monotonic_nanos() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// PosixHandlers implements each RPC by making the corresponding syscalls. The
+// handlers block for as long as the syscalls do.
+class PosixHandlers {
+ public:
+  ::grpc::Status Accept(const ::posix_server::AcceptRequest *request,
+                        ::posix_server::AcceptResponse *response) {
     sockaddr_storage addr;
     socklen_t addrlen = sizeof(addr);
     response->set_fd(accept(request->sockfd(),
@@ -125,9 +144,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return sockaddr_to_proto(addr, addrlen, response->mutable_addr());
   }
 
-  ::grpc::Status Bind(grpc::ServerContext *context,
-                      const ::posix_server::BindRequest *request,
-                      ::posix_server::BindResponse *response) override {
+  ::grpc::Status Bind(const ::posix_server::BindRequest *request,
+                      ::posix_server::BindResponse *response) {
     if (!request->has_addr()) {
       return ::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
                             "Missing address");
@@ -148,9 +166,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Close(grpc::ServerContext *context,
-                       const ::posix_server::CloseRequest *request,
-                       ::posix_server::CloseResponse *response) override {
+  ::grpc::Status Close(const ::posix_server::CloseRequest *request,
+                       ::posix_server::CloseResponse *response) {
     response->set_ret(close(request->fd()));
     if (response->ret() < 0) {
       response->set_errno_(errno);
@@ -158,9 +175,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Connect(grpc::ServerContext *context,
-                         const ::posix_server::ConnectRequest *request,
-                         ::posix_server::ConnectResponse *response) override {
+  ::grpc::Status Connect(const ::posix_server::ConnectRequest *request,
+                         ::posix_server::ConnectResponse *response) {
     if (!request->has_addr()) {
       return ::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
                             "Missing address");
@@ -180,10 +196,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status GetSockName(
-      grpc::ServerContext *context,
-      const ::posix_server::GetSockNameRequest *request,
-      ::posix_server::GetSockNameResponse *response) override {
+  ::grpc::Status GetSockName(const ::posix_server::GetSockNameRequest *request,
+                             ::posix_server::GetSockNameResponse *response) {
     sockaddr_storage addr;
     socklen_t addrlen = sizeof(addr);
     response->set_ret(getsockname(
@@ -194,10 +208,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return sockaddr_to_proto(addr, addrlen, response->mutable_addr());
   }
 
-  ::grpc::Status GetSockOpt(
-      grpc::ServerContext *context,
-      const ::posix_server::GetSockOptRequest *request,
-      ::posix_server::GetSockOptResponse *response) override {
+  ::grpc::Status GetSockOpt(const ::posix_server::GetSockOptRequest *request,
+                            ::posix_server::GetSockOptResponse *response) {
     switch (request->type()) {
       case ::posix_server::GetSockOptRequest::BYTES: {
         socklen_t optlen = request->optlen();
@@ -238,9 +250,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Listen(grpc::ServerContext *context,
-                        const ::posix_server::ListenRequest *request,
-                        ::posix_server::ListenResponse *response) override {
+  ::grpc::Status Listen(const ::posix_server::ListenRequest *request,
+                        ::posix_server::ListenResponse *response) {
     response->set_ret(listen(request->sockfd(), request->backlog()));
     if (response->ret() < 0) {
       response->set_errno_(errno);
@@ -248,9 +259,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Poll(::grpc::ServerContext *context,
-                      const ::posix_server::PollRequest *request,
-                      ::posix_server::PollResponse *response) override {
+  ::grpc::Status Poll(const ::posix_server::PollRequest *request,
+                      ::posix_server::PollResponse *response) {
     std::vector<struct pollfd> pfds;
     pfds.reserve(request->pfds_size());
     for (const auto &pfd : request->pfds()) {
@@ -286,9 +296,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Send(::grpc::ServerContext *context,
-                      const ::posix_server::SendRequest *request,
-                      ::posix_server::SendResponse *response) override {
+  ::grpc::Status Send(const ::posix_server::SendRequest *request,
+                      ::posix_server::SendResponse *response) {
     response->set_ret(::send(request->sockfd(), request->buf().data(),
                              request->buf().size(), request->flags()));
     if (response->ret() < 0) {
@@ -297,9 +306,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status SendTo(::grpc::ServerContext *context,
-                        const ::posix_server::SendToRequest *request,
-                        ::posix_server::SendToResponse *response) override {
+  ::grpc::Status SendTo(const ::posix_server::SendToRequest *request,
+                        ::posix_server::SendToResponse *response) {
     if (!request->has_dest_addr()) {
       return ::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
                             "Missing address");
@@ -321,9 +329,8 @@ class PosixImpl final : public posix_server::Posix::Service {
   }
 
   ::grpc::Status SetNonblocking(
-      grpc::ServerContext *context,
       const ::posix_server::SetNonblockingRequest *request,
-      ::posix_server::SetNonblockingResponse *response) override {
+      ::posix_server::SetNonblockingResponse *response) {
     int flags = fcntl(request->fd(), F_GETFL);
     if (flags == -1) {
       response->set_ret(-1);
@@ -345,10 +352,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status SetSockOpt(
-      grpc::ServerContext *context,
-      const ::posix_server::SetSockOptRequest *request,
-      ::posix_server::SetSockOptResponse *response) override {
+  ::grpc::Status SetSockOpt(const ::posix_server::SetSockOptRequest *request,
+                            ::posix_server::SetSockOptResponse *response) {
     switch (request->optval().val_case()) {
       case ::posix_server::SockOptVal::kBytesval:
         response->set_ret(setsockopt(request->sockfd(), request->level(),
@@ -381,9 +386,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Socket(grpc::ServerContext *context,
-                        const ::posix_server::SocketRequest *request,
-                        ::posix_server::SocketResponse *response) override {
+  ::grpc::Status Socket(const ::posix_server::SocketRequest *request,
+                        ::posix_server::SocketResponse *response) {
     response->set_fd(
         socket(request->domain(), request->type(), request->protocol()));
     if (response->fd() < 0) {
@@ -392,9 +396,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Shutdown(grpc::ServerContext *context,
-                          const ::posix_server::ShutdownRequest *request,
-                          ::posix_server::ShutdownResponse *response) override {
+  ::grpc::Status Shutdown(const ::posix_server::ShutdownRequest *request,
+                          ::posix_server::ShutdownResponse *response) {
     response->set_ret(shutdown(request->fd(), request->how()));
     if (response->ret() < 0) {
       response->set_errno_(errno);
@@ -402,9 +405,8 @@ class PosixImpl final : public posix_server::Posix::Service {
     return ::grpc::Status::OK;
   }
 
-  ::grpc::Status Recv(::grpc::ServerContext *context,
-                      const ::posix_server::RecvRequest *request,
-                      ::posix_server::RecvResponse *response) override {
+  ::grpc::Status Recv(const ::posix_server::RecvRequest *request,
+                      ::posix_server::RecvResponse *response) {
     std::vector<char> buf(request->len());
     response->set_ret(
         recv(request->sockfd(), buf.data(), buf.size(), request->flags()));
@@ -416,6 +418,431 @@ class PosixImpl final : public posix_server::Posix::Service {
     }
     return ::grpc::Status::OK;
   }
+
+  ::grpc::Status Transfer(const ::posix_server::TransferRequest *request,
+                          ::posix_server::TransferResponse *response) {
+    const bool is_send =
+        request->direction() == ::posix_server::TransferRequest::SEND;
+    if (!is_send &&
+        request->direction() != ::posix_server::TransferRequest::RECV) {
+      return ::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            "Unknown Transfer Direction");
+    }
+    constexpr int kDefaultChunkSize = 64 << 10;
+    std::vector<char> buf(request->chunk_size() > 0 ? request->chunk_size()
+                                                    : kDefaultChunkSize);
+
+    const int64_t start = monotonic_nanos();
+    int64_t done = 0;
+    auto snapshot = [&]() {
+      // Larger than any struct tcp_info, the kernel truncates it to its own
+      // size.
+      char info[512] = {};
+      socklen_t optlen = sizeof(info);
+      if (getsockopt(request->sockfd(), IPPROTO_TCP, TCP_INFO, info,
+                     &optlen) < 0) {
+        return;
+      }
+      auto *proto_snapshot = response->add_snapshots();
+      proto_snapshot->set_elapsed_nanos(monotonic_nanos() - start);
+      proto_snapshot->set_bytes(done);
+      proto_snapshot->set_tcp_info(info, optlen);
+    };
+
+    snapshot();
+    int64_t next_snapshot = request->snapshot_interval_bytes();
+    while (done < request->bytes()) {
+      size_t len = std::min<int64_t>(buf.size(), request->bytes() - done);
+      ssize_t ret =
+          is_send ? ::send(request->sockfd(), buf.data(), len, MSG_NOSIGNAL)
+                  : ::recv(request->sockfd(), buf.data(), len, 0);
+      if (ret < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        response->set_ret(-1);
+        response->set_errno_(errno);
+        break;
+      }
+      if (ret == 0) {
+        // The peer closed the connection.
+        break;
+      }
+      done += ret;
+      if (request->snapshot_interval_bytes() > 0 && done >= next_snapshot &&
+          done < request->bytes()) {
+        snapshot();
+        next_snapshot = done + request->snapshot_interval_bytes();
+      }
+    }
+    response->set_bytes(done);
+    response->set_elapsed_nanos(monotonic_nanos() - start);
+    snapshot();
+    return ::grpc::Status::OK;
+  }
+
+  ::grpc::Status Execute(const ::posix_server::ExecuteRequest *request,
+                         ::posix_server::ExecuteResponse *response) {
+    for (const auto &op : request->ops()) {
+      auto *result = response->add_results();
+      ::grpc::Status status;
+      int err = 0;
+      switch (op.op_case()) {
+        case ::posix_server::Operation::kAccept:
+          status = Accept(&op.accept(), result->mutable_accept());
+          err = result->accept().errno_();
+          break;
+        case ::posix_server::Operation::kBind:
+          status = Bind(&op.bind(), result->mutable_bind());
+          err = result->bind().errno_();
+          break;
+        case ::posix_server::Operation::kClose:
+          status = Close(&op.close(), result->mutable_close());
+          err = result->close().errno_();
+          break;
+        case ::posix_server::Operation::kConnect:
+          status = Connect(&op.connect(), result->mutable_connect());
+          err = result->connect().errno_();
+          break;
+        case ::posix_server::Operation::kGetSockName:
+          status = GetSockName(&op.get_sock_name(),
+                               result->mutable_get_sock_name());
+          err = result->get_sock_name().errno_();
+          break;
+        case ::posix_server::Operation::kGetSockOpt:
+          status = GetSockOpt(&op.get_sock_opt(),
+                              result->mutable_get_sock_opt());
+          err = result->get_sock_opt().errno_();
+          break;
+        case ::posix_server::Operation::kListen:
+          status = Listen(&op.listen(), result->mutable_listen());
+          err = result->listen().errno_();
+          break;
+        case ::posix_server::Operation::kPoll:
+          status = Poll(&op.poll(), result->mutable_poll());
+          err = result->poll().errno_();
+          break;
+        case ::posix_server::Operation::kSend:
+          status = Send(&op.send(), result->mutable_send());
+          err = result->send().errno_();
+          break;
+        case ::posix_server::Operation::kSendTo:
+          status = SendTo(&op.send_to(), result->mutable_send_to());
+          err = result->send_to().errno_();
+          break;
+        case ::posix_server::Operation::kSetNonblocking:
+          status = SetNonblocking(&op.set_nonblocking(),
+                                  result->mutable_set_nonblocking());
+          err = result->set_nonblocking().errno_();
+          break;
+        case ::posix_server::Operation::kSetSockOpt:
+          status = SetSockOpt(&op.set_sock_opt(),
+                              result->mutable_set_sock_opt());
+          err = result->set_sock_opt().errno_();
+          break;
+        case ::posix_server::Operation::kSocket:
+          status = Socket(&op.socket(), result->mutable_socket());
+          err = result->socket().errno_();
+          break;
+        case ::posix_server::Operation::kShutdown:
+          status = Shutdown(&op.shutdown(),
+                            result->mutable_shutdown());
+          err = result->shutdown().errno_();
+          break;
+        case ::posix_server::Operation::kRecv:
+          status = Recv(&op.recv(), result->mutable_recv());
+          err = result->recv().errno_();
+          break;
+        default:
+          return ::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                "Unknown Operation");
+      }
+      if (!status.ok()) {
+        return status;
+      }
+      if (err != 0 && request->stop_on_error()) {
+        break;
+      }
+    }
+    return ::grpc::Status::OK;
+  }
+};
+
+// SocketQueues runs operations on sockets. Operations on the same socket run
+// one at a time in the order they were scheduled, while operations on
+// different sockets run concurrently, so a blocking Recv or Poll only holds up
+// later operations on the same socket.
+class SocketQueues {
+ public:
+  // Run schedules op to run after all previously scheduled operations on fd.
+  // Operations that aren't tied to a single socket use a negative fd, and
+  // start right away.
+  void Run(int fd, std::function<void()> op) {
+    if (fd < 0) {
+      std::thread(std::move(op)).detach();
+      return;
+    }
+    absl::MutexLock lock(&mu_);
+    auto &queue = queues_[fd];
+    queue.push_back(std::move(op));
+    if (queue.size() == 1) {
+      // Nothing is running on fd, start a thread to drain its queue. It exits
+      // once the queue is empty, so idle sockets don't hold threads.
+      std::thread(&SocketQueues::Drain, this, fd).detach();
+    }
+  }
+
+ private:
+  void Drain(int fd) {
+    for (;;) {
+      std::function<void()> op;
+      {
+        absl::MutexLock lock(&mu_);
+        op = std::move(queues_[fd].front());
+      }
+      op();
+      absl::MutexLock lock(&mu_);
+      auto it = queues_.find(fd);
+      it->second.pop_front();
+      if (it->second.empty()) {
+        queues_.erase(it);
+        return;
+      }
+    }
+  }
+
+  absl::Mutex mu_;
+  // Pending operations for each socket. The operation at the front of a queue
+  // is the one running.
+  std::unordered_map<int, std::deque<std::function<void()>>> queues_
+      ABSL_GUARDED_BY(mu_);
+};
+
+// StreamReactor handles a bidirectional stream of requests on sockets, running
+// handler on each request and writing back its response before reading the
+// next request.
+template <typename Request, typename Response>
+class StreamReactor : public ::grpc::ServerBidiReactor<Request, Response> {
+ public:
+  using Handler = ::grpc::Status (PosixHandlers::*)(const Request *,
+                                                     Response *);
+
+  StreamReactor(PosixHandlers *handlers, SocketQueues *queues,
+                Handler handler)
+      : handlers_(handlers), queues_(queues), handler_(handler) {
+    this->StartRead(&request_);
+  }
+
+  void OnReadDone(bool ok) override {
+    if (!ok) {
+      // The client is done sending requests.
+      this->Finish(::grpc::Status::OK);
+      return;
+    }
+    queues_->Run(request_.sockfd(), [this] {
+      response_.Clear();
+      auto status = (handlers_->*handler_)(&request_, &response_);
+      if (!status.ok()) {
+        this->Finish(status);
+        return;
+      }
+      this->StartWrite(&response_);
+    });
+  }
+
+  void OnWriteDone(bool ok) override {
+    if (!ok) {
+      this->Finish(::grpc::Status::OK);
+      return;
+    }
+    this->StartRead(&request_);
+  }
+
+  void OnDone() override { delete this; }
+
+ private:
+  PosixHandlers *handlers_;
+  SocketQueues *queues_;
+  Handler handler_;
+  Request request_;
+  Response response_;
+};
+
+// PosixImpl is a callback service that runs handlers on SocketQueues, so that
+// gRPC threads never block in syscalls and the DUT can drive many sockets
+// concurrently.
+class PosixImpl final : public posix_server::Posix::CallbackService {
+ public:
+  ::grpc::ServerUnaryReactor *Accept(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::AcceptRequest *request,
+      ::posix_server::AcceptResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Accept,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Bind(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::BindRequest *request,
+      ::posix_server::BindResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Bind, request,
+                    response);
+  }
+
+  ::grpc::ServerUnaryReactor *Close(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::CloseRequest *request,
+      ::posix_server::CloseResponse *response) override {
+    return Dispatch(context, request->fd(), &PosixHandlers::Close, request,
+                    response);
+  }
+
+  ::grpc::ServerUnaryReactor *Connect(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::ConnectRequest *request,
+      ::posix_server::ConnectResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Connect,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *GetSockName(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::GetSockNameRequest *request,
+      ::posix_server::GetSockNameResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::GetSockName,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *GetSockOpt(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::GetSockOptRequest *request,
+      ::posix_server::GetSockOptResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::GetSockOpt,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Listen(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::ListenRequest *request,
+      ::posix_server::ListenResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Listen,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Poll(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::PollRequest *request,
+      ::posix_server::PollResponse *response) override {
+    // Poll may wait on several sockets, so it isn't ordered with operations
+    // on any of them.
+    return Dispatch(context, -1, &PosixHandlers::Poll, request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Send(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::SendRequest *request,
+      ::posix_server::SendResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Send, request,
+                    response);
+  }
+
+  ::grpc::ServerUnaryReactor *SendTo(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::SendToRequest *request,
+      ::posix_server::SendToResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::SendTo,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *SetNonblocking(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::SetNonblockingRequest *request,
+      ::posix_server::SetNonblockingResponse *response) override {
+    return Dispatch(context, request->fd(), &PosixHandlers::SetNonblocking,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *SetSockOpt(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::SetSockOptRequest *request,
+      ::posix_server::SetSockOptResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::SetSockOpt,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Socket(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::SocketRequest *request,
+      ::posix_server::SocketResponse *response) override {
+    return Dispatch(context, -1, &PosixHandlers::Socket, request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Shutdown(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::ShutdownRequest *request,
+      ::posix_server::ShutdownResponse *response) override {
+    return Dispatch(context, request->fd(), &PosixHandlers::Shutdown, request,
+                    response);
+  }
+
+  ::grpc::ServerUnaryReactor *Recv(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::RecvRequest *request,
+      ::posix_server::RecvResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Recv, request,
+                    response);
+  }
+
+  ::grpc::ServerUnaryReactor *Transfer(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::TransferRequest *request,
+      ::posix_server::TransferResponse *response) override {
+    return Dispatch(context, request->sockfd(), &PosixHandlers::Transfer,
+                    request, response);
+  }
+
+  ::grpc::ServerUnaryReactor *Execute(
+      ::grpc::CallbackServerContext *context,
+      const ::posix_server::ExecuteRequest *request,
+      ::posix_server::ExecuteResponse *response) override {
+    // A batch may span several sockets, and is ordered with respect to itself
+    // only.
+    return Dispatch(context, -1, &PosixHandlers::Execute, request, response);
+  }
+
+  ::grpc::ServerBidiReactor<::posix_server::SendRequest,
+                            ::posix_server::SendResponse> *
+  SendStream(::grpc::CallbackServerContext *context) override {
+    return new StreamReactor<::posix_server::SendRequest,
+                             ::posix_server::SendResponse>(
+        &handlers_, &queues_, &PosixHandlers::Send);
+  }
+
+  ::grpc::ServerBidiReactor<::posix_server::RecvRequest,
+                            ::posix_server::RecvResponse> *
+  RecvStream(::grpc::CallbackServerContext *context) override {
+    return new StreamReactor<::posix_server::RecvRequest,
+                             ::posix_server::RecvResponse>(
+        &handlers_, &queues_, &PosixHandlers::Recv);
+  }
+
+ private:
+  // Dispatch runs handler on the queue of fd, and finishes the RPC with its
+  // status once it returns.
+  template <typename Request, typename Response>
+  ::grpc::ServerUnaryReactor *Dispatch(
+      ::grpc::CallbackServerContext *context, int fd,
+      ::grpc::Status (PosixHandlers::*handler)(const Request *, Response *),
+      const Request *request, Response *response) {
+    ::grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+    queues_.Run(fd, [this, reactor, handler, request, response] {
+      reactor->Finish((handlers_.*handler)(request, response));
+    });
+    return reactor;
+  }
+
+  PosixHandlers handlers_;
+  SocketQueues queues_;
 };
 
 // Parse command line options. Returns a pointer to the first argument beyond
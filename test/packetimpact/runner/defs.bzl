@@ -198,6 +198,9 @@ ALL_TESTS = [
     PacketimpactTestInfo(
         name = "udp_any_addr_recv_unicast",
     ),
+    PacketimpactTestInfo(
+        name = "udp_send_recv_batch",
+    ),
     PacketimpactTestInfo(
         name = "udp_icmp_error_propagation",
     ),
@@ -297,6 +300,9 @@ ALL_TESTS = [
         name = "tcp_rack",
         expect_netstack_failure = True,
     ),
+    PacketimpactTestInfo(
+        name = "tcp_bulk_transfer",
+    ),
     PacketimpactTestInfo(
         name = "tcp_info",
     ),
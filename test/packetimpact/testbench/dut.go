@@ -787,3 +787,223 @@ func (dut *DUT) ShutdownWithErrno(ctx context.Context, t *testing.T, fd, how int
 	}
 	return resp.GetRet(), unix.Errno(resp.GetErrno_())
 }
+
+// TCPInfoSnapshot is a TCP_INFO snapshot taken during a Transfer.
+type TCPInfoSnapshot struct {
+	// Elapsed is the time since the start of the transfer.
+	Elapsed time.Duration
+	// Bytes is the number of bytes transferred when the snapshot was taken.
+	Bytes int64
+	// Info is the TCP_INFO of the socket. Fields that the DUT doesn't report
+	// are zero.
+	Info linux.TCPInfo
+}
+
+// TransferResult is the result of a Transfer on the DUT.
+type TransferResult struct {
+	// Bytes is the number of bytes transferred.
+	Bytes int64
+	// Elapsed is the duration of the transfer.
+	Elapsed time.Duration
+	// Snapshots are taken at the start and end of the transfer, and at the
+	// requested interval in between. There are none if the socket doesn't
+	// support TCP_INFO.
+	Snapshots []TCPInfoSnapshot
+}
+
+// Transfer sends or receives req.Bytes bytes on the DUT as fast as possible and
+// causes a fatal test failure if it doesn't succeed. Fewer bytes are
+// transferred if the peer closes the connection first. If more control over
+// the timeout or error handling is needed, use TransferWithErrno.
+func (dut *DUT) Transfer(t *testing.T, req *pb.TransferRequest) TransferResult {
+	t.Helper()
+
+	ret, result, err := dut.TransferWithErrno(context.Background(), t, req)
+	if ret != 0 {
+		t.Fatalf("failed to transfer after %d bytes: %s", result.Bytes, err)
+	}
+	return result
+}
+
+// TransferWithErrno sends or receives req.Bytes bytes on the DUT as fast as
+// possible.
+func (dut *DUT) TransferWithErrno(ctx context.Context, t *testing.T, req *pb.TransferRequest) (int32, TransferResult, error) {
+	t.Helper()
+
+	resp, err := dut.posixServer.Transfer(ctx, req)
+	if err != nil {
+		t.Fatalf("failed to call Transfer: %s", err)
+	}
+	result := TransferResult{
+		Bytes:   resp.GetBytes(),
+		Elapsed: time.Duration(resp.GetElapsedNanos()),
+	}
+	for _, snapshot := range resp.GetSnapshots() {
+		// The DUT's struct tcp_info may be smaller or larger than ours,
+		// depending on its kernel version.
+		infoBytes := make([]byte, linux.SizeOfTCPInfo)
+		copy(infoBytes, snapshot.GetTcpInfo())
+		s := TCPInfoSnapshot{
+			Elapsed: time.Duration(snapshot.GetElapsedNanos()),
+			Bytes:   snapshot.GetBytes(),
+		}
+		bin.Unmarshal(infoBytes, hostarch.ByteOrder, &s.Info)
+		result.Snapshots = append(result.Snapshots, s)
+	}
+	return resp.GetRet(), result, unix.Errno(resp.GetErrno_())
+}
+
+// SendOp returns an Operation for Execute that calls send on the DUT.
+func SendOp(sockfd int32, buf []byte, flags int32) *pb.Operation {
+	return &pb.Operation{Op: &pb.Operation_Send{Send: &pb.SendRequest{
+		Sockfd: sockfd,
+		Buf:    buf,
+		Flags:  flags,
+	}}}
+}
+
+// RecvOp returns an Operation for Execute that calls recv on the DUT.
+func RecvOp(sockfd, len, flags int32) *pb.Operation {
+	return &pb.Operation{Op: &pb.Operation_Recv{Recv: &pb.RecvRequest{
+		Sockfd: sockfd,
+		Len:    len,
+		Flags:  flags,
+	}}}
+}
+
+// OperationErrno returns the errno set by the operation that produced result,
+// or nil if it succeeded.
+func OperationErrno(result *pb.OperationResult) error {
+	m := result.ProtoReflect()
+	field := m.WhichOneof(m.Descriptor().Oneofs().ByName("result"))
+	if field == nil {
+		return nil
+	}
+	resp, ok := m.Get(field).Message().Interface().(interface{ GetErrno_() int32 })
+	if !ok || resp.GetErrno_() == 0 {
+		return nil
+	}
+	return unix.Errno(resp.GetErrno_())
+}
+
+// Execute runs ops on the DUT, in order, in a single round trip, and causes a
+// fatal test failure if any of them doesn't succeed. If more control over the
+// timeout or error handling is needed, use ExecuteWithErrno.
+func (dut *DUT) Execute(t *testing.T, ops ...*pb.Operation) []*pb.OperationResult {
+	t.Helper()
+
+	results := dut.ExecuteWithErrno(context.Background(), t, true /* stopOnError */, ops...)
+	if n := len(results); n > 0 {
+		if err := OperationErrno(results[n-1]); err != nil {
+			t.Fatalf("failed to execute operation %d (%s): %s", n-1, ops[n-1], err)
+		}
+	}
+	return results
+}
+
+// ExecuteWithErrno runs ops on the DUT, in order, in a single round trip. If
+// stopOnError is set, it stops after the first operation that fails, and only
+// the results of the operations that ran are returned. Use OperationErrno to
+// check the result of each operation.
+func (dut *DUT) ExecuteWithErrno(ctx context.Context, t *testing.T, stopOnError bool, ops ...*pb.Operation) []*pb.OperationResult {
+	t.Helper()
+
+	req := &pb.ExecuteRequest{
+		Ops:         ops,
+		StopOnError: stopOnError,
+	}
+	resp, err := dut.posixServer.Execute(ctx, req)
+	if err != nil {
+		t.Fatalf("failed to call Execute: %s", err)
+	}
+	return resp.GetResults()
+}
+
+// SendStream calls send on the DUT for each buffer in bufs, pipelining the
+// calls over a single stream instead of waiting for each one to complete, and
+// returns the total number of bytes sent. It causes a fatal test failure if
+// any send doesn't succeed.
+func (dut *DUT) SendStream(t *testing.T, sockfd int32, bufs [][]byte, flags int32) int {
+	t.Helper()
+
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+	stream, err := dut.posixServer.SendStream(ctx)
+	if err != nil {
+		t.Fatalf("failed to call SendStream: %s", err)
+	}
+	sendErr := make(chan error, 1)
+	go func() {
+		for _, buf := range bufs {
+			req := &pb.SendRequest{
+				Sockfd: sockfd,
+				Buf:    buf,
+				Flags:  flags,
+			}
+			if err := stream.Send(req); err != nil {
+				// The server's error, if any, is returned by Recv.
+				sendErr <- nil
+				return
+			}
+		}
+		sendErr <- stream.CloseSend()
+	}()
+
+	sent := 0
+	for i := range bufs {
+		resp, err := stream.Recv()
+		if err != nil {
+			t.Fatalf("failed to receive SendStream response %d: %s", i, err)
+		}
+		if resp.GetRet() == -1 {
+			t.Fatalf("failed to send buffer %d: %s", i, unix.Errno(resp.GetErrno_()))
+		}
+		sent += int(resp.GetRet())
+	}
+	if err := <-sendErr; err != nil {
+		t.Fatalf("failed to close SendStream: %s", err)
+	}
+	return sent
+}
+
+// RecvStream calls recv on the DUT over a single stream, with up to chunk
+// bytes per call, until n bytes have been received, and returns them. It
+// causes a fatal test failure if any recv doesn't succeed or the connection is
+// closed first.
+func (dut *DUT) RecvStream(t *testing.T, sockfd int32, n int, chunk, flags int32) []byte {
+	t.Helper()
+
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+	stream, err := dut.posixServer.RecvStream(ctx)
+	if err != nil {
+		t.Fatalf("failed to call RecvStream: %s", err)
+	}
+
+	buf := make([]byte, 0, n)
+	for len(buf) < n {
+		req := &pb.RecvRequest{
+			Sockfd: sockfd,
+			Len:    min(chunk, int32(n-len(buf))),
+			Flags:  flags,
+		}
+		if err := stream.Send(req); err != nil {
+			t.Fatalf("failed to send RecvStream request: %s", err)
+		}
+		resp, err := stream.Recv()
+		if err != nil {
+			t.Fatalf("failed to receive RecvStream response: %s", err)
+		}
+		switch resp.GetRet() {
+		case -1:
+			t.Fatalf("failed to recv after %d bytes: %s", len(buf), unix.Errno(resp.GetErrno_()))
+		case 0:
+			t.Fatalf("connection closed after %d of %d bytes", len(buf), n)
+		}
+		buf = append(buf, resp.GetBuf()...)
+	}
+	if err := stream.CloseSend(); err != nil {
+		t.Fatalf("failed to close RecvStream: %s", err)
+	}
+	return buf
+}
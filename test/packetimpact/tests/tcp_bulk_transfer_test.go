@@ -0,0 +1,103 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package tcp_bulk_transfer_test
+
+import (
+	"flag"
+	"testing"
+	"time"
+
+	"golang.org/x/sys/unix"
+	"gvisor.dev/gvisor/pkg/abi/linux"
+	"gvisor.dev/gvisor/pkg/tcpip/header"
+	pb "gvisor.dev/gvisor/test/packetimpact/proto/posix_server_go_proto"
+	"gvisor.dev/gvisor/test/packetimpact/testbench"
+)
+
+func init() {
+	testbench.Initialize(flag.CommandLine)
+}
+
+const (
+	numSegments = 8
+	segmentSize = 1000
+)
+
+// TestTCPBulkTransfer checks that Transfer moves the requested number of bytes
+// and reports TCP_INFO snapshots along the way.
+func TestTCPBulkTransfer(t *testing.T) {
+	dut := testbench.NewDUT(t)
+	listenFD, remotePort := dut.CreateListener(t, unix.SOCK_STREAM, unix.IPPROTO_TCP, 1)
+	defer dut.Close(t, listenFD)
+	conn := dut.Net.NewTCPIPv4(t, testbench.TCP{DstPort: &remotePort}, testbench.TCP{SrcPort: &remotePort})
+	defer conn.Close(t)
+	conn.Connect(t)
+	acceptFD, _ := dut.Accept(t, listenFD)
+	defer dut.Close(t, acceptFD)
+
+	checkSnapshots := func(t *testing.T, result testbench.TransferResult, wantSnapshots int) {
+		t.Helper()
+		if got, want := result.Bytes, int64(numSegments*segmentSize); got != want {
+			t.Errorf("got %d bytes transferred, want = %d", got, want)
+		}
+		if got := len(result.Snapshots); got != wantSnapshots {
+			t.Fatalf("got %d snapshots, want = %d", got, wantSnapshots)
+		}
+		for i, snapshot := range result.Snapshots {
+			if got, want := uint32(snapshot.Info.State), linux.TCP_ESTABLISHED; got != want {
+				t.Errorf("got snapshot %d state = %d, want = %d", i, got, want)
+			}
+			if i > 0 && snapshot.Bytes < result.Snapshots[i-1].Bytes {
+				t.Errorf("snapshot %d went back from %d to %d bytes", i, result.Snapshots[i-1].Bytes, snapshot.Bytes)
+			}
+		}
+		if first, last := result.Snapshots[0], result.Snapshots[wantSnapshots-1]; first.Bytes != 0 || last.Bytes != result.Bytes {
+			t.Errorf("got snapshots from %d to %d bytes, want from 0 to %d", first.Bytes, last.Bytes, result.Bytes)
+		}
+	}
+
+	t.Run("Recv", func(t *testing.T) {
+		for i := 0; i < numSegments; i++ {
+			conn.Send(t, testbench.TCP{Flags: testbench.TCPFlags(header.TCPFlagAck)}, &testbench.Payload{Bytes: testbench.GenerateRandomPayload(t, segmentSize)})
+			if _, err := conn.Expect(t, testbench.TCP{Flags: testbench.TCPFlags(header.TCPFlagAck)}, time.Second); err != nil {
+				t.Fatalf("expected an ACK for segment %d: %s", i, err)
+			}
+		}
+		// The data is already queued, so each recv returns a full chunk and
+		// there is one snapshot halfway through.
+		result := dut.Transfer(t, &pb.TransferRequest{
+			Sockfd:                acceptFD,
+			Direction:             pb.TransferRequest_RECV,
+			Bytes:                 numSegments * segmentSize,
+			ChunkSize:             segmentSize,
+			SnapshotIntervalBytes: numSegments * segmentSize / 2,
+		})
+		checkSnapshots(t, result, 3)
+	})
+
+	t.Run("Send", func(t *testing.T) {
+		// The data fits in the send buffer, so the transfer completes
+		// without waiting for ACKs.
+		result := dut.Transfer(t, &pb.TransferRequest{
+			Sockfd:    acceptFD,
+			Direction: pb.TransferRequest_SEND,
+			Bytes:     numSegments * segmentSize,
+		})
+		checkSnapshots(t, result, 2)
+		if _, err := conn.ExpectData(t, &testbench.TCP{}, nil, time.Second); err != nil {
+			t.Errorf("expected data from the DUT: %s", err)
+		}
+	})
+}
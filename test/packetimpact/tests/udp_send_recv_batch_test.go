@@ -0,0 +1,112 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package udp_send_recv_batch_test
+
+import (
+	"context"
+	"flag"
+	"testing"
+	"time"
+
+	"github.com/google/go-cmp/cmp"
+	"golang.org/x/sys/unix"
+	pb "gvisor.dev/gvisor/test/packetimpact/proto/posix_server_go_proto"
+	"gvisor.dev/gvisor/test/packetimpact/testbench"
+)
+
+func init() {
+	testbench.Initialize(flag.CommandLine)
+}
+
+const (
+	numDatagrams = 16
+	payloadSize  = 100
+)
+
+// TestUDPSendRecvBatch checks that batched and streamed DUT operations are
+// executed in order.
+func TestUDPSendRecvBatch(t *testing.T) {
+	dut := testbench.NewDUT(t)
+	boundFD, remotePort := dut.CreateBoundSocket(t, unix.SOCK_DGRAM, unix.IPPROTO_UDP, dut.Net.RemoteIPv4)
+	defer dut.Close(t, boundFD)
+	conn := dut.Net.NewUDPIPv4(t, testbench.UDP{DstPort: &remotePort}, testbench.UDP{SrcPort: &remotePort})
+	defer conn.Close(t)
+	dut.Connect(t, boundFD, conn.LocalAddr(t))
+
+	payloads := make([][]byte, numDatagrams)
+	for i := range payloads {
+		payloads[i] = testbench.GenerateRandomPayload(t, payloadSize)
+	}
+	expectPayloads := func(t *testing.T) {
+		t.Helper()
+		for i, payload := range payloads {
+			if _, err := conn.ExpectData(t, testbench.UDP{}, testbench.Payload{Bytes: payload}, time.Second); err != nil {
+				t.Fatalf("expected datagram %d: %s", i, err)
+			}
+		}
+	}
+
+	t.Run("Execute", func(t *testing.T) {
+		var ops []*pb.Operation
+		for _, payload := range payloads {
+			ops = append(ops, testbench.SendOp(boundFD, payload, 0))
+		}
+		results := dut.Execute(t, ops...)
+		for i, result := range results {
+			if got, want := result.GetSend().GetRet(), int32(payloadSize); got != want {
+				t.Errorf("got send %d = %d, want = %d", i, got, want)
+			}
+		}
+		expectPayloads(t)
+	})
+
+	t.Run("ExecuteStopOnError", func(t *testing.T) {
+		// Nothing has been sent to the DUT, so the non-blocking recv fails
+		// and the send after it must not run.
+		ops := []*pb.Operation{
+			testbench.RecvOp(boundFD, payloadSize, unix.MSG_DONTWAIT),
+			testbench.SendOp(boundFD, payloads[0], 0),
+		}
+		results := dut.ExecuteWithErrno(context.Background(), t, true /* stopOnError */, ops...)
+		if got, want := len(results), 1; got != want {
+			t.Fatalf("got %d results, want = %d", got, want)
+		}
+		if got, want := testbench.OperationErrno(results[0]), unix.EAGAIN; got != want {
+			t.Errorf("got recv errno = %v, want = %s", got, want)
+		}
+		if got, err := conn.Expect(t, testbench.UDP{}, time.Second); err == nil {
+			t.Errorf("got unexpected datagram after the failed operation: %s", got)
+		}
+	})
+
+	t.Run("SendStream", func(t *testing.T) {
+		if got, want := dut.SendStream(t, boundFD, payloads, 0), numDatagrams*payloadSize; got != want {
+			t.Errorf("got SendStream(...) = %d, want = %d", got, want)
+		}
+		expectPayloads(t)
+	})
+
+	t.Run("RecvStream", func(t *testing.T) {
+		var want []byte
+		for _, payload := range payloads {
+			conn.Send(t, testbench.UDP{}, &testbench.Payload{Bytes: payload})
+			want = append(want, payload...)
+		}
+		got := dut.RecvStream(t, boundFD, len(want), payloadSize, 0)
+		if diff := cmp.Diff(want, got); diff != "" {
+			t.Errorf("received payloads do not match sent payloads, diff (-want, +got):\n%s", diff)
+		}
+	})
+}
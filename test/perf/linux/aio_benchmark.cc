@@ -0,0 +1,132 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <linux/aio_abi.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks run the same batches of reads and writes as the
+// BM_IOUringReadv and BM_IOUringWritev benchmarks in io_uring_benchmark.cc,
+// through the native AIO syscalls used by libaio, so that the two can be
+// compared.
+
+// Queue depths swept by the benchmarks, as in io_uring_benchmark.cc.
+constexpr int kMinBatch = 1;
+constexpr int kMaxBatch = 64;
+
+// AIOContext is an AIO context with room for a batch of requests, which is
+// destroyed with the AIOContext.
+class AIOContext {
+ public:
+  explicit AIOContext(int nr) {
+    TEST_PCHECK(syscall(__NR_io_setup, nr, &ctx_) == 0);
+  }
+
+  ~AIOContext() { TEST_PCHECK(syscall(__NR_io_destroy, ctx_) == 0); }
+
+  aio_context_t get() const { return ctx_; }
+
+ private:
+  aio_context_t ctx_ = 0;
+};
+
+// RW runs batches of size-byte reads or writes against a temporary file. Each
+// request in the batch uses its own buffer and file offset.
+void RW(benchmark::State& state, bool write) {
+  const int size = state.range(0);
+  const int batch = state.range(1);
+
+  const std::string contents(static_cast<size_t>(size) * batch, 0);
+  auto path = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFileWith(
+      GetAbsoluteTestTmpdir(), contents, TempPath::kDefaultFileMode));
+  FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  AIOContext ctx(batch);
+
+  std::vector<char> buf(contents.size());
+  std::vector<struct iocb> cbs(batch);
+  std::vector<struct iocb*> cbps(batch);
+  for (int i = 0; i < batch; i++) {
+    memset(&cbs[i], 0, sizeof(cbs[i]));
+    cbs[i].aio_data = i;
+    cbs[i].aio_lio_opcode = write ? IOCB_CMD_PWRITE : IOCB_CMD_PREAD;
+    cbs[i].aio_fildes = fd.get();
+    cbs[i].aio_buf =
+        reinterpret_cast<uint64_t>(buf.data() + static_cast<size_t>(i) * size);
+    cbs[i].aio_nbytes = size;
+    cbs[i].aio_offset = static_cast<int64_t>(i) * size;
+    cbps[i] = &cbs[i];
+  }
+
+  std::vector<struct io_event> events(batch);
+  for (auto _ : state) {
+    TEST_PCHECK(syscall(__NR_io_submit, ctx.get(), batch, cbps.data()) ==
+                batch);
+    int reaped = 0;
+    while (reaped < batch) {
+      const long n =
+          RetryEINTR(syscall)(__NR_io_getevents, ctx.get(), batch - reaped,
+                              batch - reaped, events.data() + reaped, nullptr);
+      TEST_PCHECK(n > 0);
+      reaped += n;
+    }
+    for (const struct io_event& ev : events) {
+      if (ev.res < 0) {
+        state.SkipWithError(
+            absl::StrCat("AIO request failed: ", strerror(-ev.res)).c_str());
+        return;
+      }
+    }
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(contents.size()) *
+                          static_cast<int64_t>(state.iterations()));
+  state.SetItemsProcessed(static_cast<int64_t>(batch) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+void BM_AIORead(benchmark::State& state) { RW(state, false); }
+
+BENCHMARK(BM_AIORead)
+    ->Ranges({{1, 1 << 20}, {kMinBatch, kMaxBatch}})
+    ->UseRealTime();
+
+void BM_AIOWrite(benchmark::State& state) { RW(state, true); }
+
+BENCHMARK(BM_AIOWrite)
+    ->Ranges({{1, 1 << 20}, {kMinBatch, kMaxBatch}})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
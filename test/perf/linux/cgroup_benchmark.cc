@@ -0,0 +1,334 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/cgroup_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/linux_capability_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks run workloads inside a cgroup2 cgroup with cpu.max and
+// memory.max limits, to compare the cost of enforcement (or, where limits are
+// not enforced, of accounting) against running unconstrained. The calling
+// process itself is moved into the cgroup for the duration of the benchmark.
+
+// BenchCgroup is a child cgroup on a private cgroup2 mount that the calling
+// process is moved into on creation and out of on destruction.
+class BenchCgroup {
+ public:
+  // Creates the cgroup with the given cpu.max and memory.max values, or
+  // returns ENOTSUP if a controller needed for them is unavailable.
+  static PosixErrorOr<std::unique_ptr<BenchCgroup>> Create(
+      const std::string& cpu_max, const std::string& memory_max) {
+    ASSIGN_OR_RETURN_ERRNO(auto entries, ProcPIDCgroupEntries(getpid()));
+    auto it = entries.find("");
+    if (it == entries.end()) {
+      return PosixError(ENOTSUP, "not in a cgroup2 hierarchy");
+    }
+
+    ASSIGN_OR_RETURN_ERRNO(TempPath dir, TempPath::CreateDir());
+    std::unique_ptr<BenchCgroup> cg(new BenchCgroup(std::move(dir)));
+    ASSIGN_OR_RETURN_ERRNO(Cgroup root, cg->mounter_.MountCgroup2fs());
+    cg->orig_.emplace(
+        Cgroup::RootCgroup(JoinPath(root.Path(), it->second.path)));
+
+    ASSIGN_OR_RETURN_ERRNO(std::string controllers,
+                           GetContents(root.Relpath("cgroup.controllers")));
+    std::vector<absl::string_view> available = absl::StrSplit(
+        controllers, absl::ByAnyChar(" \n"), absl::SkipEmpty());
+    for (const char* ctrl : {"cpu", "memory"}) {
+      if (std::find(available.begin(), available.end(), ctrl) ==
+          available.end()) {
+        return PosixError(ENOTSUP, absl::StrCat(ctrl, " controller missing"));
+      }
+      RETURN_IF_ERRNO(root.WriteControlFile("cgroup.subtree_control",
+                                            absl::StrCat("+", ctrl)));
+    }
+
+    ASSIGN_OR_RETURN_ERRNO(Cgroup child, root.CreateChild("bench"));
+    cg->cg_.emplace(std::move(child));
+    RETURN_IF_ERRNO(cg->cg_->WriteControlFile("cpu.max", cpu_max));
+    RETURN_IF_ERRNO(cg->cg_->WriteControlFile("memory.max", memory_max));
+    RETURN_IF_ERRNO(cg->cg_->Enter(getpid()));
+    cg->entered_ = true;
+    return cg;
+  }
+
+  ~BenchCgroup() {
+    if (entered_) {
+      TEST_CHECK_NO_ERRNO(orig_->Enter(getpid()));
+    }
+    if (cg_) {
+      TEST_CHECK_NO_ERRNO(cg_->Delete());
+    }
+  }
+
+  const Cgroup& cgroup() const { return *cg_; }
+
+  // Returns the value of key in a flat-keyed control file such as cpu.stat,
+  // or 0 if it is not present.
+  int64_t StatField(absl::string_view file, absl::string_view key) const {
+    std::string contents =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(GetContents(cg_->Relpath(file)));
+    for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+      std::pair<absl::string_view, absl::string_view> kv =
+          absl::StrSplit(line, absl::MaxSplits(' ', 1));
+      int64_t value;
+      if (kv.first == key && absl::SimpleAtoi(kv.second, &value)) {
+        return value;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  explicit BenchCgroup(TempPath dir) : mounter_(std::move(dir)) {}
+
+  Mounter mounter_;
+  std::optional<Cgroup> orig_;
+  std::optional<Cgroup> cg_;
+  bool entered_ = false;
+};
+
+// SetUp creates the benchmark's cgroup, or skips the benchmark and returns
+// nullptr if that is not possible.
+std::unique_ptr<BenchCgroup> SetUp(benchmark::State& state,
+                                   const std::string& cpu_max,
+                                   const std::string& memory_max) {
+  if (!TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_SYS_ADMIN))) {
+    state.SkipWithError("CAP_SYS_ADMIN required");
+    return nullptr;
+  }
+  auto cg = BenchCgroup::Create(cpu_max, memory_max);
+  if (!cg.ok()) {
+    state.SkipWithError(cg.error().ToString().c_str());
+    return nullptr;
+  }
+  return std::move(cg).ValueOrDie();
+}
+
+constexpr int64_t kCPUPeriodUsec = 100000;
+
+// Spin burns CPU for a fixed amount of work.
+void Spin() {
+  uint64_t x = 1;
+  for (int i = 0; i < 100000; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  benchmark::DoNotOptimize(x);
+}
+
+// BM_CgroupCPU measures the throughput of a CPU-bound loop under a cpu.max
+// quota of quota_pct percent of one CPU, or with no quota when quota_pct is
+// 0. With a quota of 100%, a single thread is never throttled, so any loss
+// is the cost of accounting alone.
+void BM_CgroupCPU(benchmark::State& state) {
+  const int quota_pct = state.range(0);
+  const std::string cpu_max =
+      quota_pct == 0 ? "max"
+                     : absl::StrCat(kCPUPeriodUsec * quota_pct / 100, " ",
+                                    kCPUPeriodUsec);
+  std::unique_ptr<BenchCgroup> cg = SetUp(state, cpu_max, "max");
+  if (cg == nullptr) {
+    return;
+  }
+
+  const int64_t throttled = cg->StatField("cpu.stat", "nr_throttled");
+  for (auto _ : state) {
+    Spin();
+  }
+  state.counters["nr_throttled"] =
+      cg->StatField("cpu.stat", "nr_throttled") - throttled;
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CgroupCPU)
+    ->Arg(0)
+    ->Arg(100)
+    ->Arg(50)
+    ->Arg(10)
+    ->ArgName("quota_pct")
+    ->UseRealTime();
+
+// BM_CgroupMemoryCharge measures faulting in and freeing an anonymous working
+// set under a memory.max limit of limit_mb, or with no limit when limit_mb is
+// 0. The limit is always above the working set, so that nothing is reclaimed
+// and the difference is the cost of charging pages to the cgroup.
+void BM_CgroupMemoryCharge(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const int64_t limit_mb = state.range(1);
+  std::unique_ptr<BenchCgroup> cg = SetUp(
+      state, "max", limit_mb == 0 ? "max" : absl::StrCat(limit_mb << 20));
+  if (cg == nullptr) {
+    return;
+  }
+
+  for (auto _ : state) {
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_PCHECK(addr != MAP_FAILED);
+    char* p = static_cast<char*>(addr);
+    for (size_t off = 0; off < size; off += kPageSize) {
+      p[off] = 1;
+    }
+    TEST_PCHECK(munmap(addr, size) == 0);
+  }
+  state.SetItemsProcessed(state.iterations() * (size / kPageSize));
+}
+
+BENCHMARK(BM_CgroupMemoryCharge)
+    ->ArgsProduct({{16 << 20, 64 << 20}, {0, 256}})
+    ->ArgNames({"size", "limit_mb"})
+    ->UseRealTime();
+
+// BM_CgroupPageCacheReclaim measures sequential reads of a file larger than
+// memory.max, so that every read must reclaim page cache charged to the
+// cgroup. Per-read latency is reported to expose reclaim stalls. With
+// limit_mb of 0 the file stays cached and no reclaim happens.
+//
+// Anonymous memory cannot be reclaimed without swap, so the file must not be
+// on tmpfs: exceeding the limit would invoke the OOM killer instead.
+void BM_CgroupPageCacheReclaim(benchmark::State& state) {
+  constexpr size_t kFileSize = 256 << 20;
+  constexpr size_t kChunk = 1 << 20;
+  const int64_t limit_mb = state.range(0);
+
+  const TempPath file = TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  if (!IsRunningOnGvisor() &&
+      TEST_CHECK_NO_ERRNO_AND_VALUE(IsTmpfs(file.path()))) {
+    state.SkipWithError("test directory is on tmpfs");
+    return;
+  }
+  FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDWR));
+  std::vector<char> buf(kChunk, 'a');
+  for (size_t off = 0; off < kFileSize; off += kChunk) {
+    TEST_PCHECK(PwriteFd(fd.get(), buf.data(), kChunk, off) == kChunk);
+  }
+  TEST_PCHECK(fdatasync(fd.get()) == 0);
+  // Drop the pages charged to the original cgroup, so that they are charged
+  // to the benchmark's cgroup when read back.
+  TEST_PCHECK(posix_fadvise(fd.get(), 0, 0, POSIX_FADV_DONTNEED) == 0);
+
+  std::unique_ptr<BenchCgroup> cg = SetUp(
+      state, "max", limit_mb == 0 ? "max" : absl::StrCat(limit_mb << 20));
+  if (cg == nullptr) {
+    return;
+  }
+
+  {
+    LatencyRecorder latency(
+        state, absl::StrCat("BM_CgroupPageCacheReclaim/", limit_mb));
+    size_t off = 0;
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      TEST_PCHECK(PreadFd(fd.get(), buf.data(), kChunk, off) == kChunk);
+      off = (off + kChunk) % kFileSize;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kChunk);
+}
+
+BENCHMARK(BM_CgroupPageCacheReclaim)
+    ->Arg(0)
+    ->Arg(64)
+    ->ArgName("limit_mb")
+    ->UseRealTime();
+
+const char* const kStatFiles[] = {"cpu.stat", "memory.stat",
+                                  "memory.current"};
+
+// BM_CgroupStatRead measures reading a cgroup statistics file from an open
+// descriptor, as a monitoring agent polling at high frequency would, with
+// procs idle processes in the cgroup alongside the benchmark.
+void BM_CgroupStatRead(benchmark::State& state) {
+  const char* file = kStatFiles[state.range(0)];
+  const int procs = state.range(1);
+  state.SetLabel(file);
+  std::unique_ptr<BenchCgroup> cg = SetUp(state, "max", "max");
+  if (cg == nullptr) {
+    return;
+  }
+  auto fd = Open(cg->cgroup().Relpath(file), O_RDONLY);
+  if (!fd.ok()) {
+    state.SkipWithError("stat file not supported");
+    return;
+  }
+
+  // Children inherit the benchmark's cgroup.
+  std::vector<pid_t> pids;
+  for (int i = 0; i < procs; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      while (true) {
+        pause();
+      }
+    }
+    TEST_PCHECK(pid > 0);
+    pids.push_back(pid);
+  }
+
+  char buf[4096];
+  for (auto _ : state) {
+    TEST_PCHECK(PreadFd(fd.ValueOrDie().get(), buf, sizeof(buf), 0) > 0);
+  }
+
+  for (pid_t pid : pids) {
+    kill(pid, SIGKILL);
+  }
+  for (pid_t pid : pids) {
+    int status;
+    RetryEINTR(waitpid)(pid, &status, 0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CgroupStatRead)
+    ->ArgsProduct({{0, 1, 2}, {0, 64, 256}})
+    ->ArgNames({"file", "procs"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,104 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Benchmarks for the packet construction helpers used by raw socket tests,
+// which run in the test process rather than the sandbox.
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/udp.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+void BM_RandomizeBuffer(benchmark::State& state) {
+  std::vector<char> buf(state.range(0));
+  for (auto _ : state) {
+    RandomizeBuffer(buf.data(), buf.size());
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+BENCHMARK(BM_RandomizeBuffer)->Range(64, 1 << 20);
+
+void BM_IPChecksum(benchmark::State& state) {
+  struct iphdr ip = {};
+  ip.ihl = sizeof(ip) / 4;
+  ip.version = 4;
+  ip.ttl = 64;
+  ip.protocol = IPPROTO_UDP;
+  ip.saddr = htonl(INADDR_LOOPBACK);
+  ip.daddr = htonl(INADDR_LOOPBACK);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ip);
+    benchmark::DoNotOptimize(IPChecksum(ip));
+  }
+}
+
+BENCHMARK(BM_IPChecksum);
+
+void BM_UDPChecksum(benchmark::State& state) {
+  std::vector<char> payload(state.range(0));
+  RandomizeBuffer(payload.data(), payload.size());
+
+  struct iphdr ip = {};
+  ip.saddr = htonl(INADDR_LOOPBACK);
+  ip.daddr = htonl(INADDR_LOOPBACK);
+  struct udphdr udp = {};
+  udp.source = htons(1234);
+  udp.dest = htons(5678);
+  udp.len = htons(sizeof(udp) + payload.size());
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        UDPChecksum(ip, udp, payload.data(), payload.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+// Payloads of odd size take the unaligned tail path.
+BENCHMARK(BM_UDPChecksum)->Range(64, 64 << 10)->Arg(1471);
+
+void BM_ICMPChecksum(benchmark::State& state) {
+  std::vector<char> payload(state.range(0));
+  RandomizeBuffer(payload.data(), payload.size());
+
+  struct icmphdr icmp = {};
+  icmp.type = ICMP_ECHO;
+  icmp.un.echo.id = htons(1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ICMPChecksum(icmp, payload.data(), payload.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+BENCHMARK(BM_ICMPChecksum)->Range(0, 64 << 10);
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
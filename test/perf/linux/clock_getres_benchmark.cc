@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "gtest/gtest.h"
 #include "benchmark/benchmark.h"
@@ -24,15 +26,34 @@ namespace {
 
 // clock_getres(1) is very nearly a no-op syscall, but it does require copying
 // out to a userspace struct. It thus provides a nice small copy-out benchmark.
+//
+// The system call is made directly, since libc may serve clock_getres(2) from
+// the VDSO.
 void BM_ClockGetRes(benchmark::State& state) {
   struct timespec ts;
   for (auto _ : state) {
-    clock_getres(CLOCK_MONOTONIC, &ts);
+    syscall(SYS_clock_getres, CLOCK_MONOTONIC, &ts);
   }
 }
 
 BENCHMARK(BM_ClockGetRes);
 
+// BM_VDSOClockGetRes measures clock_getres(2) as called through libc, which
+// resolves it via the VDSO where one is exported.
+void BM_VDSOClockGetRes(benchmark::State& state) {
+  const clockid_t clock = state.range(0);
+  struct timespec ts;
+  for (auto _ : state) {
+    clock_getres(clock, &ts);
+  }
+}
+
+BENCHMARK(BM_VDSOClockGetRes)
+    ->Arg(CLOCK_MONOTONIC)
+    ->Arg(CLOCK_REALTIME)
+    ->Arg(CLOCK_MONOTONIC_COARSE)
+    ->Arg(CLOCK_REALTIME_COARSE);
+
 }  // namespace
 
 }  // namespace testing
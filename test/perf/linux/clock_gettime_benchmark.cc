@@ -13,12 +13,21 @@
 // limitations under the License.
 
 #include <pthread.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
 #include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "benchmark/benchmark.h"
+#include "test/util/test_util.h"
+#include "test/util/vdso_util.h"
 
 namespace gvisor {
 namespace testing {
@@ -52,7 +61,253 @@ void BM_VDSOClockGettime(benchmark::State& state) {
   }
 }
 
-BENCHMARK(BM_VDSOClockGettime)->Arg(CLOCK_MONOTONIC)->Arg(CLOCK_REALTIME);
+BENCHMARK(BM_VDSOClockGettime)
+    ->Arg(CLOCK_MONOTONIC)
+    ->Arg(CLOCK_REALTIME)
+    ->Arg(CLOCK_MONOTONIC_COARSE)
+    ->Arg(CLOCK_REALTIME_COARSE)
+    ->Arg(CLOCK_TAI);
+
+void BM_VDSOTime(benchmark::State& state) {
+  absl::Time start = absl::Now();
+
+  // Don't benchmark the calibration phase.
+  while (absl::Now() < start + absl::Milliseconds(2100)) {
+    benchmark::DoNotOptimize(time(nullptr));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(time(nullptr));
+  }
+}
+
+BENCHMARK(BM_VDSOTime);
+
+void BM_VDSOGettimeofday(benchmark::State& state) {
+  struct timeval tv;
+  absl::Time start = absl::Now();
+
+  // Don't benchmark the calibration phase.
+  while (absl::Now() < start + absl::Milliseconds(2100)) {
+    gettimeofday(&tv, nullptr);
+  }
+
+  for (auto _ : state) {
+    gettimeofday(&tv, nullptr);
+  }
+}
+
+BENCHMARK(BM_VDSOGettimeofday);
+
+// LatencyHistogram records latencies in power-of-two buckets and reports them
+// as benchmark counters.
+class LatencyHistogram {
+ public:
+  void Record(int64_t ns) {
+    ns = std::max<int64_t>(ns, 0);
+    buckets_[ns == 0 ? 0 : 64 - __builtin_clzll(ns)]++;
+    max_ns_ = std::max(max_ns_, ns);
+    count_++;
+  }
+
+  // Report sets the p99_ns counter to the 99th percentile latency, rounded up
+  // to a power of two, and the max_ns counter to the maximum latency. Both are
+  // averaged across threads.
+  void Report(benchmark::State& state) const {
+    uint64_t p99_ns = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); i++) {
+      seen += buckets_[i];
+      if (seen * 100 >= count_ * 99) {
+        p99_ns = i == 0 ? 0 : uint64_t{1} << std::min<size_t>(i, 63);
+        break;
+      }
+    }
+
+    state.counters["p99_ns"] =
+        benchmark::Counter(p99_ns, benchmark::Counter::kAvgThreads);
+    state.counters["max_ns"] =
+        benchmark::Counter(max_ns_, benchmark::Counter::kAvgThreads);
+  }
+
+ private:
+  // buckets_[i] counts latencies in [2^(i-1), 2^i) ns.
+  std::vector<uint64_t> buckets_ = std::vector<uint64_t>(65);
+  int64_t max_ns_ = 0;
+  uint64_t count_ = 0;
+};
+
+// BM_VDSOClockGettimeContended measures the tail latency of clock_gettime(2)
+// with many threads reading the clock at once.
+//
+// The sentry updates the VDSO parameter page about once per second, so each
+// run lasts long enough to span several updates. The latency of each call is
+// taken as the difference between consecutive readings.
+void BM_VDSOClockGettimeContended(benchmark::State& state) {
+  struct timespec tp;
+  absl::Time start = absl::Now();
+
+  // Don't benchmark the calibration phase.
+  while (absl::Now() < start + absl::Milliseconds(2100)) {
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+  }
+
+  LatencyHistogram latency;
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  int64_t last = absl::ToInt64Nanoseconds(absl::DurationFromTimespec(tp));
+  for (auto _ : state) {
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    int64_t now = absl::ToInt64Nanoseconds(absl::DurationFromTimespec(tp));
+    latency.Record(now - last);
+    last = now;
+  }
+  latency.Report(state);
+}
+
+BENCHMARK(BM_VDSOClockGettimeContended)
+    ->ThreadRange(1, 128)
+    ->MinTime(5)
+    ->UseRealTime();
+
+using ClockGettimeFn = int (*)(clockid_t, struct timespec*);
+
+int SyscallClockGettime(clockid_t clock, struct timespec* tp) {
+  return syscall(SYS_clock_gettime, clock, tp);
+}
+
+// Ways BM_ClockGettimeSweep calls clock_gettime(2).
+enum ClockGettimeMethod {
+  // A raw system call.
+  kClockGettimeSyscall,
+
+  // libc's clock_gettime(), which uses the VDSO where possible.
+  kClockGettimeLibc,
+
+  // The VDSO's clock_gettime, called directly.
+  kClockGettimeVDSO,
+};
+
+// BM_ClockGettimeSweep measures clock_gettime(2) for one clock and calling
+// method per run, reporting ns/op and the per-thread p99 and maximum latency.
+//
+// Only one in every kSampleInterval calls is timed individually, so the
+// timing adds little to ns/op.
+void BM_ClockGettimeSweep(benchmark::State& state) {
+  constexpr uint64_t kSampleInterval = 16;
+  const clockid_t clock = state.range(0);
+
+  ClockGettimeFn fn = nullptr;
+  switch (state.range(1)) {
+    case kClockGettimeSyscall:
+      fn = SyscallClockGettime;
+      break;
+    case kClockGettimeLibc:
+      fn = clock_gettime;
+      break;
+    case kClockGettimeVDSO:
+#if defined(__x86_64__)
+      fn = reinterpret_cast<ClockGettimeFn>(
+          VDSOSymbol("__vdso_clock_gettime"));
+#elif defined(__aarch64__)
+      fn = reinterpret_cast<ClockGettimeFn>(
+          VDSOSymbol("__kernel_clock_gettime"));
+#endif
+      break;
+  }
+  if (fn == nullptr) {
+    state.SkipWithError("clock_gettime is not available by this method");
+    return;
+  }
+
+  struct timespec tp;
+  absl::Time start = absl::Now();
+
+  // Don't benchmark the calibration phase.
+  while (absl::Now() < start + absl::Milliseconds(2100)) {
+    fn(clock, &tp);
+  }
+
+  LatencyHistogram latency;
+  uint64_t calls = 0;
+  for (auto _ : state) {
+    if (++calls % kSampleInterval != 0) {
+      fn(clock, &tp);
+      continue;
+    }
+    int64_t before = absl::GetCurrentTimeNanos();
+    fn(clock, &tp);
+    latency.Record(absl::GetCurrentTimeNanos() - before);
+  }
+  latency.Report(state);
+}
+
+void ClockGettimeSweepArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"clock", "method"});
+  for (clockid_t clock :
+       {CLOCK_REALTIME, CLOCK_MONOTONIC, CLOCK_BOOTTIME, CLOCK_REALTIME_COARSE,
+        CLOCK_MONOTONIC_COARSE, CLOCK_MONOTONIC_RAW, CLOCK_TAI,
+        CLOCK_PROCESS_CPUTIME_ID, CLOCK_THREAD_CPUTIME_ID}) {
+    for (int method :
+         {kClockGettimeSyscall, kClockGettimeLibc, kClockGettimeVDSO}) {
+      bench->Args({clock, method});
+    }
+  }
+}
+
+BENCHMARK(BM_ClockGettimeSweep)
+    ->Apply(ClockGettimeSweepArgs)
+    ->ThreadRange(1, NumCPUs())
+    ->UseRealTime();
+
+#ifdef __x86_64__
+
+// Cycle counter read sequences that the VDSO may be configured to use.
+enum CycleClockSequence {
+  kLFenceRDTSC,
+  kMFenceRDTSC,
+  kRDTSCP,
+  kRDTSC,
+};
+
+inline uint64_t ReadCycleClock(CycleClockSequence seq) {
+  uint32_t lo, hi, aux;
+  switch (seq) {
+    case kLFenceRDTSC:
+      asm volatile("lfence; rdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+      break;
+    case kMFenceRDTSC:
+      asm volatile("mfence; rdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+      break;
+    case kRDTSCP:
+      asm volatile("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux) : : "memory");
+      break;
+    case kRDTSC:
+      asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+      break;
+  }
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+// BM_CycleClockRead measures the cost of each cycle counter read sequence
+// independent of the rest of clock_gettime.
+void BM_CycleClockRead(benchmark::State& state) {
+  const CycleClockSequence seq =
+      static_cast<CycleClockSequence>(state.range(0));
+  uint64_t last = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(last);
+    last = ReadCycleClock(seq);
+  }
+}
+
+BENCHMARK(BM_CycleClockRead)
+    ->ArgName("seq")
+    ->Arg(kLFenceRDTSC)
+    ->Arg(kMFenceRDTSC)
+    ->Arg(kRDTSCP)
+    ->Arg(kRDTSC);
+
+#endif  // __x86_64__
 
 }  // namespace
 
@@ -0,0 +1,101 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/cleanup.h"
+#include "test/util/logging.h"
+#include "test/util/multiprocess_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_ColdStart measures the startup time of dynamically linked programs,
+// which is dominated by the dynamic loader's openat, mmap and mprotect calls
+// for each shared library: the time from ForkAndExec until main runs in a
+// program linked with the given number of shared libraries (in addition to
+// libc), as reported back through a pipe.
+//
+// With bind_now, LD_BIND_NOW=1 makes the loader resolve all symbols at
+// startup, as for binaries linked with -z now, rather than lazily on first
+// call. Prelinking isn't measured, since current loaders ignore it.
+
+// WaitForSuccess waits for the child pid and checks that it exited with 0.
+void WaitForSuccess(pid_t pid) {
+  int status;
+  TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+  TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+double Seconds(const struct timespec& ts) {
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void BM_ColdStart(benchmark::State& state) {
+  const int libs = state.range(0);
+  const bool bind_now = state.range(1);
+  const std::string path =
+      RunfilePath(absl::StrCat("test/perf/linux/coldstart_workload_", libs));
+  const ExecveArray envv =
+      bind_now ? ExecveArray{"LD_BIND_NOW=1"} : ExecveArray{};
+
+  for (auto _ : state) {
+    // Only the write end is inherited by the workload.
+    int fds[2];
+    TEST_PCHECK(pipe(fds) == 0);
+    TEST_PCHECK(fcntl(fds[0], F_SETFD, FD_CLOEXEC) == 0);
+    const ExecveArray argv = {path, std::to_string(fds[1])};
+
+    struct timespec start, end;
+    TEST_PCHECK(clock_gettime(CLOCK_MONOTONIC, &start) == 0);
+    pid_t child;
+    int execve_errno;
+    Cleanup kill = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        ForkAndExec(path, argv, envv, &child, &execve_errno));
+    TEST_CHECK(execve_errno == 0);
+    TEST_PCHECK(close(fds[1]) == 0);
+    char c;
+    TEST_PCHECK(ReadFd(fds[0], &c, 1) == 1);
+    TEST_PCHECK(clock_gettime(CLOCK_MONOTONIC, &end) == 0);
+    state.SetIterationTime(Seconds(end) - Seconds(start));
+
+    TEST_PCHECK(close(fds[0]) == 0);
+    WaitForSuccess(child);
+    kill.Release();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ColdStart)
+    ->ArgsProduct({{0, 10, 50, 200}, {0, 1}})
+    ->ArgNames({"libs", "bind_now"})
+    ->UseManualTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,31 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// coldstart_lib is built as libcoldstart_<COLDSTART_LIB>.so; see
+// coldstart_lib.h. COLDSTART_PREV is COLDSTART_LIB - 1, since the
+// preprocessor can't compute it.
+
+#include "test/perf/linux/coldstart_lib.h"
+
+#if COLDSTART_LIB > 1
+extern "C" int COLDSTART_FN(COLDSTART_PREV)();
+#endif
+
+extern "C" int COLDSTART_FN(COLDSTART_LIB)() {
+#if COLDSTART_LIB > 1
+  return COLDSTART_FN(COLDSTART_PREV)() + 1;
+#else
+  return 1;
+#endif
+}
@@ -0,0 +1,25 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GVISOR_TEST_PERF_LINUX_COLDSTART_LIB_H_
+#define GVISOR_TEST_PERF_LINUX_COLDSTART_LIB_H_
+
+// libcoldstart_<n>.so defines COLDSTART_FN(n), which calls
+// COLDSTART_FN(n - 1) in libcoldstart_<n - 1>.so and returns n, so that a
+// program that calls COLDSTART_FN(n) needs n shared libraries.
+#define COLDSTART_CAT2(a, b) a##b
+#define COLDSTART_CAT(a, b) COLDSTART_CAT2(a, b)
+#define COLDSTART_FN(n) COLDSTART_CAT(coldstart_, n)
+
+#endif  // GVISOR_TEST_PERF_LINUX_COLDSTART_LIB_H_
@@ -0,0 +1,43 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// coldstart_workload is exec'd by coldstart_benchmark, linked with
+// COLDSTART_LIBS shared libraries. It writes a byte to the file descriptor
+// given as its only argument as soon as main runs, and then calls into the
+// libraries.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "test/perf/linux/coldstart_lib.h"
+
+#if COLDSTART_LIBS > 0
+extern "C" int COLDSTART_FN(COLDSTART_LIBS)();
+#endif
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    return 1;
+  }
+  const char c = 0;
+  if (write(atoi(argv[1]), &c, 1) != 1) {
+    return 1;
+  }
+#if COLDSTART_LIBS > 0
+  if (COLDSTART_FN(COLDSTART_LIBS)() != COLDSTART_LIBS) {
+    return 1;
+  }
+#endif
+  return 0;
+}
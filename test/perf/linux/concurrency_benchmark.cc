@@ -0,0 +1,229 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure how aggregate throughput of CPU-bound work scales
+// with the number of threads or processes doing it, up to the number of CPUs.
+// Ideally, N workers get N times the work of one done in the same time; the
+// "efficiency" counter is the fraction of that ideal which was achieved, so
+// anything that serializes workers (e.g. handing off between task goroutines
+// in the sentry) shows up as efficiency dropping as workers are added.
+//
+// Workers can also make a cheap syscall periodically, since a sentry
+// bottleneck is more likely to be in the syscall path than in application
+// code that runs without involving the sentry.
+
+// Number of iterations of Work in a unit of work, which takes a few
+// milliseconds.
+constexpr uint64_t kIterationsPerUnit = 1 << 20;
+
+// Number of units of work done by each worker per benchmark iteration.
+constexpr int kUnitsPerIteration = 10;
+
+// Work runs one unit of CPU-bound work, making syscalls_per_unit getpid
+// syscalls spread over it.
+void Work(int syscalls_per_unit) {
+  const uint64_t syscall_every =
+      syscalls_per_unit == 0 ? kIterationsPerUnit + 1
+                             : kIterationsPerUnit / syscalls_per_unit;
+  uint64_t x = 88172645463325252ULL;
+  for (uint64_t i = 1; i <= kIterationsPerUnit; i++) {
+    // xorshift64, which can't be optimized away or vectorized.
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    if (i % syscall_every == 0) {
+      syscall(SYS_getpid);
+    }
+  }
+  benchmark::DoNotOptimize(x);
+}
+
+// UnitDuration returns how long a unit of work takes when it runs alone.
+absl::Duration UnitDuration(int syscalls_per_unit) {
+  absl::Duration best = absl::InfiniteDuration();
+  for (int i = 0; i < 20; i++) {
+    const absl::Time start = absl::Now();
+    Work(syscalls_per_unit);
+    best = std::min(best, absl::Now() - start);
+  }
+  return best;
+}
+
+void WriteByte(int fd) {
+  char c = 0;
+  TEST_PCHECK(RetryEINTR(write)(fd, &c, 1) == 1);
+}
+
+// ReadByte returns false on EOF.
+bool ReadByte(int fd) {
+  char c;
+  int n = RetryEINTR(read)(fd, &c, 1);
+  TEST_PCHECK(n >= 0);
+  return n == 1;
+}
+
+// WorkerLoop does kUnitsPerIteration units of work each time a byte is read
+// from go, then writes a byte to done. It returns when go is closed.
+void WorkerLoop(int go, int done, int syscalls_per_unit) {
+  while (ReadByte(go)) {
+    for (int i = 0; i < kUnitsPerIteration; i++) {
+      Work(syscalls_per_unit);
+    }
+    WriteByte(done);
+  }
+}
+
+// Workers runs WorkerLoop in threads of this process or in child processes.
+class Workers {
+ public:
+  Workers(int n, bool processes, int syscalls_per_unit) {
+    int fds[2];
+    TEST_PCHECK(pipe(fds) == 0);
+    done_read_ = FileDescriptor(fds[0]);
+    done_write_ = FileDescriptor(fds[1]);
+    for (int i = 0; i < n; i++) {
+      TEST_PCHECK(pipe(fds) == 0);
+      const int go = fds[0];
+      go_.emplace_back(fds[1]);
+      const int done = done_write_.get();
+      if (processes) {
+        pid_t pid = fork();
+        TEST_PCHECK(pid >= 0);
+        if (pid == 0) {
+          // Don't keep the write ends of the go pipes open, or closing them
+          // in the parent wouldn't stop workers.
+          go_.clear();
+          WorkerLoop(go, done, syscalls_per_unit);
+          _exit(0);
+        }
+        TEST_PCHECK(close(go) == 0);
+        pids_.push_back(pid);
+      } else {
+        threads_.push_back(std::make_unique<ScopedThread>([=] {
+          WorkerLoop(go, done, syscalls_per_unit);
+          TEST_PCHECK(close(go) == 0);
+        }));
+      }
+    }
+  }
+
+  ~Workers() {
+    // Closing the go pipes makes workers return.
+    go_.clear();
+    threads_.clear();
+    for (pid_t pid : pids_) {
+      int status;
+      TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+      TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+  }
+
+  // Run has every worker do one iteration, and returns once all are done.
+  void Run() {
+    for (const FileDescriptor& go : go_) {
+      WriteByte(go.get());
+    }
+    for (size_t i = 0; i < go_.size(); i++) {
+      TEST_CHECK(ReadByte(done_read_.get()));
+    }
+  }
+
+ private:
+  // Write ends of the pipes each worker reads from.
+  std::vector<FileDescriptor> go_;
+  // All workers write to the same pipe when done.
+  FileDescriptor done_read_;
+  FileDescriptor done_write_;
+  std::vector<std::unique_ptr<ScopedThread>> threads_;
+  std::vector<pid_t> pids_;
+};
+
+void CPUBoundScaling(benchmark::State& state, bool processes) {
+  const int workers = state.range(0);
+  const int syscalls_per_unit = state.range(1);
+  const absl::Duration unit = UnitDuration(syscalls_per_unit);
+
+  Workers w(workers, processes, syscalls_per_unit);
+  // Warm up, so that workers have started before measuring.
+  w.Run();
+
+  absl::Duration total = absl::ZeroDuration();
+  for (auto _ : state) {
+    const absl::Time start = absl::Now();
+    w.Run();
+    const absl::Duration elapsed = absl::Now() - start;
+    state.SetIterationTime(absl::ToDoubleSeconds(elapsed));
+    total += elapsed;
+  }
+
+  const int64_t units = state.iterations() * workers * kUnitsPerIteration;
+  state.SetItemsProcessed(units);
+  state.counters["efficiency"] =
+      benchmark::Counter(absl::FDivDuration(unit * units, total));
+}
+
+void BM_CPUBoundThreads(benchmark::State& state) {
+  CPUBoundScaling(state, /*processes=*/false);
+}
+
+void BM_CPUBoundProcesses(benchmark::State& state) {
+  CPUBoundScaling(state, /*processes=*/true);
+}
+
+void ScalingArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"workers", "syscalls_per_unit"});
+  const int cpus = NumCPUs();
+  std::vector<int> workers;
+  for (int n = 1; n < cpus; n *= 2) {
+    workers.push_back(n);
+  }
+  workers.push_back(cpus);
+  for (int syscalls_per_unit : {0, 100}) {
+    for (int n : workers) {
+      bench->Args({n, syscalls_per_unit});
+    }
+  }
+}
+
+BENCHMARK(BM_CPUBoundThreads)->Apply(ScalingArgs)->UseManualTime();
+
+BENCHMARK(BM_CPUBoundProcesses)->Apply(ScalingArgs)->UseManualTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
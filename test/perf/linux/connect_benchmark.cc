@@ -0,0 +1,214 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure connection churn, as done by short-lived HTTP
+// clients: each iteration connects to a persistent listener, accepts the
+// connection and closes both ends, with the client closing first.
+//
+// Unless SO_LINGER with a zero timeout makes the close send an RST, the
+// client end of each TCP connection stays in TIME-WAIT and holds on to its
+// ephemeral port. Once all ephemeral ports are held, connect fails with
+// EADDRNOTAVAIL; such failures are counted rather than fatal, so that port
+// exhaustion shows up in the results. See socket_generic_stress.cc for the
+// corresponding correctness tests.
+
+enum SocketKind {
+  kTCPv4,
+  kTCPv6,
+  kUnix,
+};
+
+// Listener is a listening socket shared by all runs of a benchmark for a
+// socket kind, so that only client ports churn.
+struct Listener {
+  FileDescriptor fd;
+  sockaddr_storage addr = {};
+  socklen_t addrlen = 0;
+};
+
+Listener* NewListener(SocketKind kind) {
+  Listener* l = new Listener();
+  int family;
+  switch (kind) {
+    case kTCPv4: {
+      family = AF_INET;
+      auto* addr = reinterpret_cast<sockaddr_in*>(&l->addr);
+      addr->sin_family = AF_INET;
+      addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      l->addrlen = sizeof(*addr);
+      break;
+    }
+    case kTCPv6: {
+      family = AF_INET6;
+      auto* addr = reinterpret_cast<sockaddr_in6*>(&l->addr);
+      addr->sin6_family = AF_INET6;
+      addr->sin6_addr = in6addr_loopback;
+      l->addrlen = sizeof(*addr);
+      break;
+    }
+    case kUnix: {
+      family = AF_UNIX;
+      // Autobind to an abstract address.
+      auto* addr = reinterpret_cast<sockaddr_un*>(&l->addr);
+      addr->sun_family = AF_UNIX;
+      l->addrlen = sizeof(sa_family_t);
+      break;
+    }
+  }
+  l->fd = TEST_CHECK_NO_ERRNO_AND_VALUE(Socket(family, SOCK_STREAM, 0));
+  TEST_PCHECK(bind(l->fd.get(), AsSockAddr(&l->addr), l->addrlen) == 0);
+  l->addrlen = sizeof(l->addr);
+  TEST_PCHECK(getsockname(l->fd.get(), AsSockAddr(&l->addr), &l->addrlen) ==
+              0);
+  TEST_PCHECK(listen(l->fd.get(), SOMAXCONN) == 0);
+  return l;
+}
+
+Listener* GetListener(SocketKind kind) {
+  static Listener* listeners[] = {nullptr, nullptr, nullptr};
+  if (listeners[kind] == nullptr) {
+    listeners[kind] = NewListener(kind);
+  }
+  return listeners[kind];
+}
+
+// CountTimeWait returns the number of TCP sockets in TIME-WAIT, or -1 if
+// /proc/net/tcp{,6} can't be read.
+int CountTimeWait() {
+  int count = 0;
+  for (const char* path : {"/proc/net/tcp", "/proc/net/tcp6"}) {
+    PosixErrorOr<std::string> contents = GetContents(path);
+    if (!contents.ok()) {
+      return -1;
+    }
+    // The fourth column, "st", is the state. TCP_TIME_WAIT is 6.
+    for (absl::string_view line :
+         absl::StrSplit(contents.ValueOrDie(), '\n', absl::SkipEmpty())) {
+      std::vector<absl::string_view> fields =
+          absl::StrSplit(line, ' ', absl::SkipEmpty());
+      if (fields.size() > 3 && fields[3] == "06") {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+// EphemeralPorts returns the number of ports in the ephemeral port range, or
+// -1 if it can't be read.
+int EphemeralPorts() {
+  PosixErrorOr<std::string> contents =
+      GetContents("/proc/sys/net/ipv4/ip_local_port_range");
+  if (!contents.ok()) {
+    return -1;
+  }
+  std::vector<absl::string_view> fields = absl::StrSplit(
+      absl::StripAsciiWhitespace(contents.ValueOrDie()), absl::ByAnyChar(" \t"),
+      absl::SkipEmpty());
+  int min, max;
+  if (fields.size() != 2 || !absl::SimpleAtoi(fields[0], &min) ||
+      !absl::SimpleAtoi(fields[1], &max)) {
+    return -1;
+  }
+  return max - min + 1;
+}
+
+void BM_ConnectChurn(benchmark::State& state) {
+  const SocketKind kind = static_cast<SocketKind>(state.range(0));
+  const bool linger = state.range(1);
+  const bool reuseaddr = state.range(2);
+  Listener* l = GetListener(kind);
+
+  int failures = 0;
+  for (auto _ : state) {
+    FileDescriptor client = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        Socket(l->addr.ss_family, SOCK_STREAM, 0));
+    if (linger) {
+      struct linger opt = {};
+      opt.l_onoff = 1;
+      TEST_PCHECK(setsockopt(client.get(), SOL_SOCKET, SO_LINGER, &opt,
+                             sizeof(opt)) == 0);
+    }
+    if (reuseaddr) {
+      TEST_PCHECK(setsockopt(client.get(), SOL_SOCKET, SO_REUSEADDR,
+                             &kSockOptOn, sizeof(kSockOptOn)) == 0);
+    }
+    if (RetryEINTR(connect)(client.get(), AsSockAddr(&l->addr), l->addrlen) !=
+        0) {
+      TEST_PCHECK(errno == EADDRNOTAVAIL || errno == EADDRINUSE);
+      failures++;
+      continue;
+    }
+    const int server = RetryEINTR(accept)(l->fd.get(), nullptr, nullptr);
+    TEST_PCHECK(server >= 0);
+    // Close the client first, so that it is the end left in TIME-WAIT.
+    client.reset();
+    TEST_PCHECK(close(server) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() - failures);
+  state.counters["connect_failures"] = failures;
+  if (kind != kUnix) {
+    state.counters["time_wait"] = CountTimeWait();
+    state.counters["ephemeral_ports"] = EphemeralPorts();
+  }
+}
+
+void ChurnArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"kind", "linger", "reuseaddr"});
+  for (SocketKind kind : {kTCPv4, kTCPv6}) {
+    for (int linger : {0, 1}) {
+      for (int reuseaddr : {0, 1}) {
+        bench->Args({kind, linger, reuseaddr});
+      }
+    }
+  }
+  // SO_LINGER and SO_REUSEADDR have no effect on unix sockets.
+  bench->Args({kUnix, 0, 0});
+}
+
+BENCHMARK(BM_ConnectChurn)->Apply(ChurnArgs)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,197 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "test/util/fs_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_CoreDump measures the time from a fatal SIGSEGV to a crashing process
+// with the given amount of resident anonymous memory being reaped, which
+// includes writing its core dump, and the size of the core dump, for
+// different /proc/[pid]/coredump_filter settings. dump:0 disables core dumps
+// with RLIMIT_CORE, as a baseline for the cost of tearing down the process.
+//
+// Each crash happens in a temporary working directory, and core files written
+// there are measured by the core_bytes counter and removed after each crash.
+// Cases that dump core are skipped if core_pattern would make them write core
+// files elsewhere, which could fill the disk with cores of up to 8GiB. dumped
+// is the fraction of crashes reported as having dumped core by wait(2).
+
+constexpr int64_t kMiB = 1 << 20;
+constexpr char kCoredumpFilter[] = "/proc/self/coredump_filter";
+constexpr char kCorePattern[] = "/proc/sys/kernel/core_pattern";
+
+// Coredump filters: the default dumps anonymous and ELF header mappings,
+// while none only dumps the headers.
+constexpr int kFilterNone = 0;
+constexpr int kFilterDefault = 0x33;
+
+struct timespec Now() {
+  struct timespec ts;
+  TEST_PCHECK(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+  return ts;
+}
+
+double Seconds(const struct timespec& start, const struct timespec& end) {
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// CoreFilesAreRemoved returns true if core dumps are piped to a program, or
+// written to the crashing process' working directory, where CoreBytes removes
+// them.
+bool CoreFilesAreRemoved() {
+  auto pattern = GetContents(kCorePattern);
+  if (!pattern.ok()) {
+    // gVisor doesn't write core files.
+    return true;
+  }
+  const absl::string_view p =
+      absl::StripTrailingAsciiWhitespace(pattern.ValueOrDie());
+  return absl::StartsWith(p, "|") || !absl::StrContains(p, "/");
+}
+
+// CoreBytes returns the size of the files in dir, which only holds core files,
+// and removes them.
+int64_t CoreBytes(const std::string& dir) {
+  int64_t bytes = 0;
+  for (const std::string& name :
+       TEST_CHECK_NO_ERRNO_AND_VALUE(ListDir(dir, true))) {
+    const std::string path = JoinPath(dir, name);
+    struct stat st;
+    TEST_PCHECK(stat(path.c_str(), &st) == 0);
+    bytes += st.st_size;
+    TEST_PCHECK(unlink(path.c_str()) == 0);
+  }
+  return bytes;
+}
+
+void BM_CoreDump(benchmark::State& state) {
+  const int64_t size = state.range(0);
+  const bool dump = state.range(1);
+  const int filter = state.range(2);
+
+  if (dump && !CoreFilesAreRemoved()) {
+    state.SkipWithError("core_pattern writes core files outside of the "
+                        "working directory");
+    return;
+  }
+
+  const int64_t available = sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
+  if (size > available / 2) {
+    state.SkipWithError("not enough memory available");
+    return;
+  }
+
+  // coredump_filter is inherited by children.
+  int orig_filter;
+  TEST_CHECK(absl::SimpleHexAtoi(
+      TEST_CHECK_NO_ERRNO_AND_VALUE(GetContents(kCoredumpFilter)),
+      &orig_filter));
+  TEST_CHECK_NO_ERRNO(SetContents(kCoredumpFilter, absl::StrCat(filter)));
+
+  const TempPath dir = TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+  const std::string dir_path = dir.path();
+  int64_t dumped = 0, core_bytes = 0;
+  for (auto _ : state) {
+    int fds[2];
+    TEST_PCHECK(pipe(fds) == 0);
+    const pid_t pid = fork();
+    if (pid == 0) {
+      TEST_PCHECK(close(fds[0]) == 0);
+      const struct rlimit rl = {dump ? RLIM_INFINITY : 0,
+                                dump ? RLIM_INFINITY : 0};
+      TEST_PCHECK(setrlimit(RLIMIT_CORE, &rl) == 0);
+      TEST_PCHECK(chdir(dir_path.c_str()) == 0);
+      void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      TEST_PCHECK(addr != MAP_FAILED);
+      for (int64_t off = 0; off < size; off += kPageSize) {
+        static_cast<volatile char*>(addr)[off] = 1;
+      }
+      // Tell the parent that memory is resident, then wait to be killed.
+      TEST_PCHECK(close(fds[1]) == 0);
+      while (true) {
+        pause();
+      }
+    }
+    TEST_PCHECK(pid > 0);
+    TEST_PCHECK(close(fds[1]) == 0);
+    char c;
+    TEST_PCHECK(RetryEINTR(read)(fds[0], &c, 1) == 0);
+    TEST_PCHECK(close(fds[0]) == 0);
+
+    const struct timespec start = Now();
+    TEST_PCHECK(kill(pid, SIGSEGV) == 0);
+    int status;
+    TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+    state.SetIterationTime(Seconds(start, Now()));
+
+    TEST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+    if (WCOREDUMP(status)) {
+      dumped++;
+    }
+    core_bytes += CoreBytes(dir_path);
+  }
+
+  TEST_CHECK_NO_ERRNO(SetContents(kCoredumpFilter, absl::StrCat(orig_filter)));
+
+  state.counters["dumped"] =
+      benchmark::Counter(dumped, benchmark::Counter::kAvgIterations);
+  state.counters["core_bytes"] =
+      benchmark::Counter(core_bytes, benchmark::Counter::kAvgIterations,
+                         benchmark::Counter::kIs1024);
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+void CoreDumpArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"size", "dump", "filter"});
+  for (int64_t size : {128 * kMiB, 1024 * kMiB, 8192 * kMiB}) {
+    bench->Args({size, 0, kFilterDefault});
+    bench->Args({size, 1, kFilterNone});
+    bench->Args({size, 1, kFilterDefault});
+  }
+}
+
+BENCHMARK(BM_CoreDump)->Apply(CoreDumpArgs)->UseManualTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -14,6 +14,8 @@
 
 #include <fcntl.h>
 #include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include <memory>
@@ -50,6 +52,159 @@ void BM_Dup(benchmark::State& state) {
 
 BENCHMARK(BM_Dup)->Range(1, 1 << 15)->UseRealTime();
 
+#ifndef CLOSE_RANGE_CLOEXEC
+#define CLOSE_RANGE_CLOEXEC (1U << 2)
+#endif
+
+#ifndef SYS_close_range
+#if defined(__x86_64__) || defined(__aarch64__)
+#define SYS_close_range 436
+#else
+#error "Unknown architecture"
+#endif
+#endif  // SYS_close_range
+
+int CloseRange(unsigned int first, unsigned int last, unsigned int flags) {
+  return syscall(SYS_close_range, first, last, flags);
+}
+
+// The fds populating the table start at kBase, above those the test runtime
+// itself uses.
+constexpr int kBase = 1024;
+
+rlim_t NofileHardLimit() {
+  struct rlimit rl;
+  TEST_PCHECK(getrlimit(RLIMIT_NOFILE, &rl) == 0);
+  return rl.rlim_max;
+}
+
+// RaiseNofile raises the RLIMIT_NOFILE soft limit to at least needed. It
+// returns false, after skipping the benchmark, if the hard limit is lower.
+bool RaiseNofile(benchmark::State& state, rlim_t needed) {
+  struct rlimit rl;
+  TEST_PCHECK(getrlimit(RLIMIT_NOFILE, &rl) == 0);
+  if (rl.rlim_cur >= needed) {
+    return true;
+  }
+  if (rl.rlim_max < needed) {
+    state.SkipWithError("RLIMIT_NOFILE too low");
+    return false;
+  }
+  rl.rlim_cur = needed;
+  TEST_PCHECK(setrlimit(RLIMIT_NOFILE, &rl) == 0);
+  return true;
+}
+
+// Fill installs count duplicates of stderr at fds [kBase, kBase + count).
+void Fill(int count) {
+  for (int i = 0; i < count; i++) {
+    TEST_PCHECK(dup2(2, kBase + i) == kBase + i);
+  }
+}
+
+void Drain(int count) {
+  if (count > 0) {
+    TEST_PCHECK(CloseRange(kBase, kBase + count - 1, 0) == 0);
+  }
+}
+
+// BM_DupThreads measures dup/close churn by several threads sharing one fd
+// table, which already holds a number of open fds.
+void BM_DupThreads(benchmark::State& state) {
+  const int held = state.range(0);
+  const rlim_t needed = kBase + held + 1024;
+
+  // Every thread must agree on whether to skip; only thread 0 sets up the
+  // shared table while the others wait for the loop to start.
+  if (NofileHardLimit() < needed) {
+    state.SkipWithError("RLIMIT_NOFILE too low");
+  } else if (state.thread_index() == 0) {
+    TEST_CHECK(RaiseNofile(state, needed));
+    Fill(held);
+  }
+
+  for (auto _ : state) {
+    int fd = dup(2);
+    TEST_PCHECK(fd >= 0);
+    TEST_PCHECK(close(fd) == 0);
+  }
+
+  if (state.thread_index() == 0 && NofileHardLimit() >= needed) {
+    Drain(held);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DupThreads)
+    ->Arg(0)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Arg(500000)
+    ->ArgName("held")
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+// BM_CloseRange measures closing, or marking close-on-exec, a large block of
+// fds with close_range(2), as process spawners do before exec.
+void BM_CloseRange(benchmark::State& state) {
+  const int count = state.range(0);
+  const bool cloexec = state.range(1);
+  if (!RaiseNofile(state, kBase + count)) {
+    return;
+  }
+  if (CloseRange(~0U, ~0U, 0) < 0 && errno == ENOSYS) {
+    state.SkipWithError("close_range not supported");
+    return;
+  }
+
+  const unsigned int last = kBase + count - 1;
+  if (cloexec) {
+    Fill(count);
+    for (auto _ : state) {
+      TEST_PCHECK(CloseRange(kBase, last, CLOSE_RANGE_CLOEXEC) == 0);
+    }
+    Drain(count);
+  } else {
+    for (auto _ : state) {
+      state.PauseTiming();
+      Fill(count);
+      state.ResumeTiming();
+      TEST_PCHECK(CloseRange(kBase, last, 0) == 0);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_CloseRange)
+    ->ArgsProduct({{1000, 10000, 100000}, {0, 1}})
+    ->ArgNames({"fds", "cloexec"})
+    ->UseRealTime();
+
+// BM_DupFDMin measures fcntl(F_DUPFD) with a high minimum fd, which must
+// search the table from that point and may grow it. The largest minimum
+// requires RLIMIT_NOFILE of about 1M.
+void BM_DupFDMin(benchmark::State& state) {
+  const int min = state.range(0);
+  if (!RaiseNofile(state, min + 1024)) {
+    return;
+  }
+
+  for (auto _ : state) {
+    int fd = fcntl(2, F_DUPFD, min);
+    TEST_PCHECK(fd >= min);
+    TEST_PCHECK(close(fd) == 0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DupFDMin)
+    ->Arg(0)
+    ->Arg(1 << 10)
+    ->Arg(1 << 17)
+    ->Arg(1000000)
+    ->ArgName("min")
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace gvisor
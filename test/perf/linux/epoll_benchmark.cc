@@ -13,18 +13,27 @@
 // limitations under the License.
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 
+#include <atomic>
+#include <cerrno>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "test/util/benchmark_latency.h"
 #include "test/util/epoll_util.h"
 #include "test/util/eventfd_util.h"
 #include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
 #include "test/util/posix_error.h"
 #include "test/util/test_util.h"
+#include "test/util/thread_util.h"
 
 namespace gvisor {
 namespace testing {
@@ -79,6 +88,190 @@ void BM_EpollAllEvents(benchmark::State& state) {
 
 BENCHMARK(BM_EpollAllEvents)->Range(2, 1024);
 
+constexpr uint64_t kOne = 1;
+
+// Signal increments the eventfd fd.
+void Signal(int fd) {
+  TEST_PCHECK(WriteFd(fd, &kOne, sizeof(kOne)) == sizeof(kOne));
+}
+
+// Consume blocks until the eventfd fd is readable and resets it.
+void Consume(int fd) {
+  uint64_t val;
+  TEST_PCHECK(ReadFd(fd, &val, sizeof(val)) == sizeof(val));
+}
+
+// BM_EpollWakeup measures the round trip to a thread blocked in epoll_wait:
+// the benchmark signals an eventfd the waiter's epoll instance watches, and
+// the waiter answers on a second eventfd.
+void BM_EpollWakeup(benchmark::State& state) {
+  const bool edge = state.range(0);
+  auto epollfd = ASSERT_NO_ERRNO_AND_VALUE(NewEpollFD());
+  auto event = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+  auto reply = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+  ASSERT_NO_ERRNO(RegisterEpollFD(epollfd.get(), event.get(),
+                                  EPOLLIN | (edge ? EPOLLET : 0), 0));
+
+  std::atomic<bool> done(false);
+  ScopedThread waiter([&] {
+    struct epoll_event ev;
+    while (true) {
+      TEST_PCHECK(epoll_wait(epollfd.get(), &ev, 1, -1) == 1);
+      Consume(event.get());
+      if (done.load()) {
+        return;
+      }
+      Signal(reply.get());
+    }
+  });
+
+  {
+    LatencyRecorder latency(
+        state, absl::StrCat("BM_EpollWakeup/", edge ? "edge" : "level"));
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      Signal(event.get());
+      Consume(reply.get());
+    }
+  }
+
+  done.store(true);
+  Signal(event.get());
+}
+
+BENCHMARK(BM_EpollWakeup)->Arg(0)->Arg(1)->ArgName("edge")->UseRealTime();
+
+// BM_EpollPerThread has every benchmark thread signal and collect an event on
+// its own epoll instance, so the threads share nothing but the kernel.
+void BM_EpollPerThread(benchmark::State& state) {
+  auto epollfd = ASSERT_NO_ERRNO_AND_VALUE(NewEpollFD());
+  auto event = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+  ASSERT_NO_ERRNO(RegisterEpollFD(epollfd.get(), event.get(), EPOLLIN, 0));
+
+  LatencyRecorder latency(state, "BM_EpollPerThread");
+  struct epoll_event ev;
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    Signal(event.get());
+    TEST_PCHECK(epoll_wait(epollfd.get(), &ev, 1, 0) == 1);
+    Consume(event.get());
+  }
+}
+
+BENCHMARK(BM_EpollPerThread)->ThreadRange(1, 64)->UseRealTime();
+
+// BM_EpollSharedWakeup measures the round trip to one of several threads,
+// each blocked in epoll_wait on its own epoll instance, that all watch the
+// same eventfd. With EPOLLEXCLUSIVE only one of them (or a few) should be
+// woken per event; without it every waiter races for the event.
+void BM_EpollSharedWakeup(benchmark::State& state) {
+  const int waiters = state.range(0);
+  const bool exclusive = state.range(1);
+  auto event = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD(0, EFD_NONBLOCK));
+  auto reply = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+  // stop is never consumed, so it wakes every waiter once done is set.
+  auto stop = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+
+  std::vector<FileDescriptor> epollfds;
+  for (int i = 0; i < waiters; i++) {
+    epollfds.push_back(ASSERT_NO_ERRNO_AND_VALUE(NewEpollFD()));
+    ASSERT_NO_ERRNO(RegisterEpollFD(epollfds[i].get(), event.get(),
+                                    EPOLLIN | (exclusive ? EPOLLEXCLUSIVE : 0),
+                                    0));
+    ASSERT_NO_ERRNO(RegisterEpollFD(epollfds[i].get(), stop.get(), EPOLLIN, 1));
+  }
+
+  std::atomic<bool> done(false);
+  std::vector<std::unique_ptr<ScopedThread>> threads;
+  for (int i = 0; i < waiters; i++) {
+    const int epollfd = epollfds[i].get();
+    threads.push_back(std::make_unique<ScopedThread>([&, epollfd] {
+      struct epoll_event evs[2];
+      while (true) {
+        TEST_PCHECK(epoll_wait(epollfd, evs, 2, -1) > 0);
+        if (done.load()) {
+          return;
+        }
+        // Only one waiter wins the event; the rest find it consumed.
+        uint64_t val;
+        if (ReadFd(event.get(), &val, sizeof(val)) == sizeof(val)) {
+          Signal(reply.get());
+        } else {
+          TEST_PCHECK(errno == EAGAIN);
+        }
+      }
+    }));
+  }
+
+  {
+    LatencyRecorder latency(
+        state, absl::StrCat("BM_EpollSharedWakeup/waiters:", waiters,
+                            "/exclusive:", exclusive));
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      Signal(event.get());
+      Consume(reply.get());
+    }
+  }
+
+  done.store(true);
+  Signal(stop.get());
+  threads.clear();
+}
+
+BENCHMARK(BM_EpollSharedWakeup)
+    ->ArgsProduct({{1, 4, 16, 64}, {0, 1}})
+    ->ArgNames({"waiters", "exclusive"})
+    ->UseRealTime();
+
+// BM_EpollSparseReady measures epoll_wait on an instance with many
+// registered fds of which only a few are ready, as in an event loop serving
+// many mostly idle connections.
+void BM_EpollSparseReady(benchmark::State& state) {
+  const int nfds = state.range(0);
+  const int ready = state.range(1);
+
+  // Leave headroom for the fds the test runtime itself uses.
+  const rlim_t needed = nfds + 128;
+  struct rlimit rl;
+  ASSERT_THAT(getrlimit(RLIMIT_NOFILE, &rl), SyscallSucceeds());
+  if (rl.rlim_cur < needed) {
+    if (rl.rlim_max < needed) {
+      state.SkipWithError("RLIMIT_NOFILE too low");
+      return;
+    }
+    rl.rlim_cur = needed;
+    ASSERT_THAT(setrlimit(RLIMIT_NOFILE, &rl), SyscallSucceeds());
+  }
+
+  auto epollfd = ASSERT_NO_ERRNO_AND_VALUE(NewEpollFD());
+  std::vector<FileDescriptor> eventfds;
+  eventfds.reserve(nfds);
+  for (int i = 0; i < nfds; i++) {
+    eventfds.push_back(ASSERT_NO_ERRNO_AND_VALUE(NewEventFD()));
+    ASSERT_NO_ERRNO(
+        RegisterEpollFD(epollfd.get(), eventfds[i].get(), EPOLLIN, i));
+  }
+  // Spread the ready fds evenly over the registration order.
+  for (int i = 0; i < ready; i++) {
+    Signal(eventfds[static_cast<int64_t>(i) * nfds / ready].get());
+  }
+
+  std::vector<struct epoll_event> result(ready + 1);
+  LatencyRecorder latency(state, absl::StrCat("BM_EpollSparseReady/fds:", nfds,
+                                              "/ready:", ready));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    TEST_CHECK(epoll_wait(epollfd.get(), result.data(), result.size(), 0) ==
+               ready);
+  }
+}
+
+BENCHMARK(BM_EpollSparseReady)
+    ->ArgsProduct({{1000, 10000, 100000}, {1, 64}})
+    ->ArgNames({"fds", "ready"})
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
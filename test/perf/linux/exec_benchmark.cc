@@ -0,0 +1,155 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/cleanup.h"
+#include "test/util/logging.h"
+#include "test/util/multiprocess_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// Each benchmark spawns a trivial program and waits for it to exit, from each
+// of several threads in parallel. Items per second are spawns per second. The
+// first argument selects a statically (0) or dynamically (1) linked program;
+// the latter also includes the cost of the dynamic loader.
+
+constexpr char kStaticWorkload[] = "test/perf/linux/exec_workload_static";
+constexpr char kDynamicWorkload[] = "test/perf/linux/exec_workload_dynamic";
+
+std::string WorkloadPath(const benchmark::State& state) {
+  return RunfilePath(state.range(0) ? kDynamicWorkload : kStaticWorkload);
+}
+
+// WaitForSuccess waits for the child pid and checks that it exited with 0.
+void WaitForSuccess(pid_t pid) {
+  int status;
+  TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+  TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+void Configure(benchmark::internal::Benchmark* b) {
+  b->Arg(0)->Arg(1)->ArgName("dynamic")->ThreadRange(1, 16)->UseRealTime();
+}
+
+// BM_ForkExec uses ForkAndExec, that is fork(2) followed by execve(2).
+void BM_ForkExec(benchmark::State& state) {
+  const std::string path = WorkloadPath(state);
+  const ExecveArray argv = {path};
+  const ExecveArray envv;
+
+  for (auto _ : state) {
+    pid_t child;
+    int execve_errno;
+    Cleanup kill = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        ForkAndExec(path, argv, envv, &child, &execve_errno));
+    TEST_CHECK(execve_errno == 0);
+    WaitForSuccess(child);
+    kill.Release();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ForkExec)->Apply(Configure);
+
+// BM_VforkExec uses vfork(2) followed by execve(2).
+void BM_VforkExec(benchmark::State& state) {
+  const std::string path = WorkloadPath(state);
+  const ExecveArray argv = {path};
+  const ExecveArray envv;
+
+  for (auto _ : state) {
+    pid_t child = vfork();
+    if (child == 0) {
+      execve(path.c_str(), argv.get(), envv.get());
+      _exit(127);
+    }
+    TEST_PCHECK(child > 0);
+    WaitForSuccess(child);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_VforkExec)->Apply(Configure);
+
+struct CloneExecArgs {
+  const char* path;
+  char* const* argv;
+  char* const* envv;
+};
+
+int CloneExecChild(void* arg) {
+  const CloneExecArgs* args = static_cast<CloneExecArgs*>(arg);
+  execve(args->path, args->argv, args->envv);
+  _exit(127);
+}
+
+// BM_CloneVforkExec uses clone(2) with CLONE_VM | CLONE_VFORK and a small
+// separate stack, as posix_spawn implementations do, followed by execve(2).
+void BM_CloneVforkExec(benchmark::State& state) {
+  const std::string path = WorkloadPath(state);
+  const ExecveArray argv = {path};
+  const ExecveArray envv;
+  CloneExecArgs args = {path.c_str(), argv.get(), envv.get()};
+  std::vector<char> stack(64 << 10);
+
+  for (auto _ : state) {
+    pid_t child = clone(CloneExecChild, stack.data() + stack.size(),
+                        CLONE_VM | CLONE_VFORK | SIGCHLD, &args);
+    TEST_PCHECK(child > 0);
+    WaitForSuccess(child);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CloneVforkExec)->Apply(Configure);
+
+// BM_PosixSpawn uses posix_spawn(3).
+void BM_PosixSpawn(benchmark::State& state) {
+  const std::string path = WorkloadPath(state);
+  const ExecveArray argv = {path};
+  const ExecveArray envv;
+
+  for (auto _ : state) {
+    pid_t child;
+    TEST_CHECK(posix_spawn(&child, path.c_str(), nullptr, nullptr, argv.get(),
+                           envv.get()) == 0);
+    WaitForSuccess(child);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PosixSpawn)->Apply(Configure);
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,183 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/memory_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure page faults on file-backed mappings, as used by
+// databases and by the dynamic loader, on files in the test's temporary
+// directory (gofer-backed, or an overlay, depending on the test variant) or
+// in /dev/shm (tmpfs). mapping_benchmark covers anonymous mappings.
+//
+// The file's contents are cached after the first iteration, so these measure
+// the cost of establishing mappings of cached pages rather than of I/O.
+
+enum Filesystem {
+  kTestTmpdir,
+  kDevShm,
+};
+
+// Size of the mapped file.
+constexpr int kPages = 4096;
+const size_t kFileSize = kPages * kPageSize;
+
+// CreateFile returns a file of kFileSize bytes of non-zero data, so that
+// pages aren't backed by holes, on fs.
+TempPath CreateFile(Filesystem fs) {
+  TempPath path = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      fs == kDevShm ? TempPath::CreateFileIn("/dev/shm")
+                    : TempPath::CreateFile());
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_WRONLY));
+  const std::string chunk(1 << 20, 'a');
+  for (size_t off = 0; off < kFileSize; off += chunk.size()) {
+    TEST_CHECK(WriteFd(fd.get(), chunk.data(), chunk.size()) ==
+               static_cast<ssize_t>(chunk.size()));
+  }
+  return path;
+}
+
+// PageOrder returns the order in which pages are touched.
+std::vector<int> PageOrder(bool random) {
+  std::vector<int> order(kPages);
+  std::iota(order.begin(), order.end(), 0);
+  if (random) {
+    std::shuffle(order.begin(), order.end(), std::mt19937(0));
+  }
+  return order;
+}
+
+// Touch reads or writes one byte of each page of addr in order.
+void Touch(char* addr, const std::vector<int>& order, bool write) {
+  for (int page : order) {
+    volatile char* c = addr + page * kPageSize;
+    if (write) {
+      *c = 42;
+    } else {
+      benchmark::DoNotOptimize(*c);
+    }
+  }
+}
+
+// Map, touch, then unmap every page of the file. Writes to MAP_PRIVATE
+// mappings copy the page.
+void BM_FileMapTouchUnmap(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const bool shared = state.range(1);
+  const bool random = state.range(2);
+  const bool write = state.range(3);
+
+  const TempPath path = CreateFile(fs);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  const std::vector<int> order = PageOrder(random);
+
+  for (auto _ : state) {
+    void* addr = mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE,
+                      shared ? MAP_SHARED : MAP_PRIVATE, fd.get(), 0);
+    TEST_PCHECK(addr != MAP_FAILED);
+    Touch(reinterpret_cast<char*>(addr), order, write);
+    TEST_PCHECK(munmap(addr, kFileSize) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kPages);
+}
+
+BENCHMARK(BM_FileMapTouchUnmap)
+    ->ArgsProduct({{kTestTmpdir, kDevShm}, {0, 1}, {0, 1}, {0, 1}})
+    ->ArgNames({"fs", "shared", "random", "write"})
+    ->UseRealTime();
+
+// Touch every page of an existing mapping after discarding it with
+// MADV_DONTNEED, which is cheaper than remapping it but still faults on each
+// page.
+void BM_FileRefaultAfterDontneed(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const bool shared = state.range(1);
+
+  const TempPath path = CreateFile(fs);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  const Mapping m = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      Mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE,
+           shared ? MAP_SHARED : MAP_PRIVATE, fd.get(), 0));
+  const std::vector<int> order = PageOrder(false);
+  Touch(static_cast<char*>(m.ptr()), order, false);
+
+  for (auto _ : state) {
+    TEST_PCHECK(madvise(m.ptr(), kFileSize, MADV_DONTNEED) == 0);
+    Touch(static_cast<char*>(m.ptr()), order, false);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kPages);
+}
+
+BENCHMARK(BM_FileRefaultAfterDontneed)
+    ->ArgsProduct({{kTestTmpdir, kDevShm}, {0, 1}})
+    ->ArgNames({"fs", "shared"})
+    ->UseRealTime();
+
+// Dirty the given number of pages of a MAP_SHARED mapping, then write them
+// back with msync(MS_SYNC).
+void BM_FileMsync(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const int dirty = state.range(1);
+
+  const TempPath path = CreateFile(fs);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  const Mapping m = TEST_CHECK_NO_ERRNO_AND_VALUE(Mmap(
+      nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0));
+  std::vector<int> order = PageOrder(true);
+  order.resize(dirty);
+
+  for (auto _ : state) {
+    Touch(static_cast<char*>(m.ptr()), order, true);
+    TEST_PCHECK(msync(m.ptr(), kFileSize, MS_SYNC) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() * dirty);
+}
+
+BENCHMARK(BM_FileMsync)
+    ->ArgsProduct({{kTestTmpdir, kDevShm}, {1, 16, 256, kPages}})
+    ->ArgNames({"fs", "dirty"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -12,16 +12,29 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/sysinfo.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/barrier.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "benchmark/benchmark.h"
 #include "test/util/cleanup.h"
 #include "test/util/file_descriptor.h"
 #include "test/util/logging.h"
+#include "test/util/memory_util.h"
 #include "test/util/test_util.h"
 #include "test/util/thread_util.h"
 
@@ -293,6 +306,140 @@ void BM_ThreadSwitch(benchmark::State& state) {
 
 BENCHMARK(BM_ThreadSwitch)->Setup(SwitchSetup)->Range(2, 16)->UseRealTime();
 
+// With many threads, the Sentry touches the state of many contexts shared
+// with the platform, e.g. the Systrap thread contexts, which makes it
+// sensitive to TLB misses.
+BENCHMARK(BM_ThreadSwitch)
+    ->Setup(SwitchSetup)
+    ->Arg(128)
+    ->Arg(256)
+    ->UseRealTime();
+
+const char* CPUDistanceName(CPUDistance distance) {
+  switch (distance) {
+    case CPUDistance::kSameCore:
+      return "same_core";
+    case CPUDistance::kSamePackage:
+      return "same_package";
+    case CPUDistance::kCrossPackage:
+      return "cross_package";
+  }
+  return "unknown";
+}
+
+// Pins the calling thread to the first CPU of a pair at the distance given by
+// state.range(0), storing the second in *peer. Returns nullptr and skips the
+// benchmark if there is no such pair.
+std::unique_ptr<Cleanup> PinForSwitch(benchmark::State& state, int* peer) {
+  const CPUDistance distance = static_cast<CPUDistance>(state.range(0));
+  auto pair = CPUPairAtDistance(distance);
+  if (!pair.ok()) {
+    state.SkipWithError(pair.error().ToString().c_str());
+    return nullptr;
+  }
+  auto pin = ScopedPinCurrentThread(SingleCPUSet(pair.ValueOrDie().first));
+  if (!pin.ok()) {
+    state.SkipWithError(pin.error().ToString().c_str());
+    return nullptr;
+  }
+  state.SetLabel(CPUDistanceName(distance));
+  *peer = pair.ValueOrDie().second;
+  return std::make_unique<Cleanup>(std::move(pin).ValueOrDie());
+}
+
+constexpr int kCPUDistances[] = {
+    static_cast<int>(CPUDistance::kSameCore),
+    static_cast<int>(CPUDistance::kSamePackage),
+    static_cast<int>(CPUDistance::kCrossPackage),
+};
+
+// Like BM_ThreadSwitch with two threads, but pinned to a pair of CPUs at the
+// topological distance given by the argument, so that the result reflects the
+// cost of cross-CPU wakeups at that distance rather than scheduler placement.
+void BM_ThreadSwitchPinned(benchmark::State& state) {
+  int peer;
+  auto unpin = PinForSwitch(state, &peer);
+  if (unpin == nullptr) {
+    return;
+  }
+
+  int ping[2], pong[2];
+  ASSERT_THAT(pipe(ping), SyscallSucceeds());
+  ASSERT_THAT(pipe(pong), SyscallSucceeds());
+  FileDescriptor ping_read(ping[0]), ping_write(ping[1]);
+  FileDescriptor pong_read(pong[0]), pong_write(pong[1]);
+
+  {
+    ScopedThread t(SingleCPUSet(peer), [&] {
+      SwitchChild(ping_read.get(), pong_write.get());
+    });
+
+    char buf = 'a';
+    for (auto _ : state) {
+      ASSERT_THAT(WriteFd(ping_write.get(), &buf, 1),
+                  SyscallSucceedsWithValue(1));
+      ASSERT_THAT(ReadFd(pong_read.get(), &buf, 1),
+                  SyscallSucceedsWithValue(1));
+    }
+
+    // Closing the write end makes the peer exit its loop.
+    ping_write.reset();
+  }
+}
+
+BENCHMARK(BM_ThreadSwitchPinned)
+    ->Setup(SwitchSetup)
+    ->ArgsProduct({{std::begin(kCPUDistances), std::end(kCPUDistances)}})
+    ->ArgNames({"distance"})
+    ->UseRealTime();
+
+// Equivalent to BM_ThreadSwitchPinned using a process instead of a thread.
+void BM_ProcessSwitchPinned(benchmark::State& state) {
+  int peer;
+  auto unpin = PinForSwitch(state, &peer);
+  if (unpin == nullptr) {
+    return;
+  }
+
+  int ping[2], pong[2];
+  ASSERT_THAT(pipe(ping), SyscallSucceeds());
+  ASSERT_THAT(pipe(pong), SyscallSucceeds());
+  FileDescriptor ping_read(ping[0]), ping_write(ping[1]);
+  FileDescriptor pong_read(pong[0]), pong_write(pong[1]);
+
+  const cpu_set_t peer_set = SingleCPUSet(peer);
+  pid_t child = fork();
+  if (child == 0) {
+    TEST_PCHECK(sched_setaffinity(0, sizeof(peer_set), &peer_set) == 0);
+    ping_write.reset();
+    pong_read.reset();
+    SwitchChild(ping_read.get(), pong_write.get());
+    _exit(0);
+  }
+  ASSERT_THAT(child, SyscallSucceeds());
+  ping_read.reset();
+  pong_write.reset();
+
+  char buf = 'a';
+  for (auto _ : state) {
+    ASSERT_THAT(WriteFd(ping_write.get(), &buf, 1),
+                SyscallSucceedsWithValue(1));
+    ASSERT_THAT(ReadFd(pong_read.get(), &buf, 1), SyscallSucceedsWithValue(1));
+  }
+
+  ping_write.reset();
+  int status;
+  EXPECT_THAT(RetryEINTR(waitpid)(child, &status, 0), SyscallSucceeds());
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+BENCHMARK(BM_ProcessSwitchPinned)
+    ->Setup(SwitchSetup)
+    ->ArgsProduct({{std::begin(kCPUDistances), std::end(kCPUDistances)}})
+    ->ArgNames({"distance"})
+    ->UseRealTime();
+
 void BM_ThreadStart(benchmark::State& state) {
   const int num_threads = state.range(0);
 
@@ -352,6 +499,149 @@ void BM_ProcessLifecycle(benchmark::State& state) {
 
 BENCHMARK(BM_ProcessLifecycle)->Range(1, 512)->UseRealTime();
 
+#ifndef MADV_WIPEONFORK
+#define MADV_WIPEONFORK 18
+#endif
+
+// Who writes to the forked memory in BM_ForkCOW.
+enum class COWWriter {
+  kChild = 0,
+  kParent = 1,
+};
+
+// Advice applied to the forked memory in BM_ForkCOW.
+constexpr int kCOWAdvice[] = {MADV_NORMAL, MADV_DONTFORK, MADV_WIPEONFORK};
+
+// Writes to one byte of every page of [data, data+size).
+void DirtyPages(char* data, size_t size) {
+  for (size_t off = 0; off < size; off += kPageSize) {
+    data[off]++;
+  }
+}
+
+// BM_ForkCOW measures the copy-on-write faults that follow fork, as seen by
+// preforking servers and snapshotting databases. The parent touches
+// state.range(0) bytes of anonymous memory and forks; then either the child
+// or the parent (state.range(1), see COWWriter) writes to every page while
+// the other process is still alive, so that every write faults. The memory is
+// advised with kCOWAdvice[state.range(2)] first: MADV_DONTFORK leaves it out
+// of the child, and MADV_WIPEONFORK gives the child zero-filled pages instead
+// of copies.
+//
+// Each iteration is a complete fork + write + exit + wait; the fork latency
+// and the fault throughput are reported separately as counters.
+void BM_ForkCOW(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const COWWriter writer = static_cast<COWWriter>(state.range(1));
+  const int advice = kCOWAdvice[state.range(2)];
+
+  // The parent and the child may each hold a full copy.
+  struct sysinfo info;
+  TEST_PCHECK(sysinfo(&info) == 0);
+  if (size > static_cast<uint64_t>(info.freeram) * info.mem_unit / 4) {
+    state.SkipWithError("not enough free memory");
+    return;
+  }
+
+  auto m_or = MmapAnon(size, PROT_READ | PROT_WRITE, MAP_PRIVATE);
+  if (!m_or.ok()) {
+    state.SkipWithError(m_or.error().ToString().c_str());
+    return;
+  }
+  Mapping m = std::move(m_or).ValueOrDie();
+  if (advice != MADV_NORMAL && madvise(m.ptr(), size, advice) != 0) {
+    state.SkipWithError(absl::StrCat("madvise(", advice,
+                                     ") failed: ", strerror(errno))
+                            .c_str());
+    return;
+  }
+  char* const data = static_cast<char*>(m.ptr());
+  // Touch every page, so that the memory isn't backed by the zero page.
+  DirtyPages(data, size);
+
+  int64_t fork_ns = 0;
+  int64_t write_ns = 0;
+  for (auto _ : state) {
+    // The child reports how long its writes took on done, and waits for the
+    // parent's writes by reading EOF from release.
+    int done[2], release[2];
+    ASSERT_THAT(pipe(done), SyscallSucceeds());
+    ASSERT_THAT(pipe(release), SyscallSucceeds());
+    FileDescriptor done_read(done[0]), done_write(done[1]);
+    FileDescriptor release_read(release[0]), release_write(release[1]);
+
+    const absl::Time start = absl::Now();
+    const pid_t child = fork();
+    if (child == 0) {
+      done_read.reset();
+      release_write.reset();
+      int64_t ns = 0;
+      if (writer == COWWriter::kChild) {
+        // Wiped pages are zero-filled in the child.
+        TEST_CHECK(advice != MADV_WIPEONFORK || data[0] == 0);
+        const absl::Time write_start = absl::Now();
+        DirtyPages(data, size);
+        ns = absl::ToInt64Nanoseconds(absl::Now() - write_start);
+      }
+      TEST_CHECK(WriteFd(done_write.get(), &ns, sizeof(ns)) == sizeof(ns));
+      char c;
+      TEST_CHECK(ReadFd(release_read.get(), &c, 1) == 0);
+      _exit(0);
+    }
+    fork_ns += absl::ToInt64Nanoseconds(absl::Now() - start);
+    ASSERT_THAT(child, SyscallSucceeds());
+    done_write.reset();
+    release_read.reset();
+
+    int64_t ns;
+    ASSERT_THAT(ReadFd(done_read.get(), &ns, sizeof(ns)),
+                SyscallSucceedsWithValue(sizeof(ns)));
+    if (writer == COWWriter::kParent) {
+      const absl::Time write_start = absl::Now();
+      DirtyPages(data, size);
+      ns = absl::ToInt64Nanoseconds(absl::Now() - write_start);
+    }
+    write_ns += ns;
+
+    release_write.reset();
+    int status;
+    ASSERT_THAT(RetryEINTR(waitpid)(child, &status, 0),
+                SyscallSucceedsWithValue(child));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+  }
+
+  const double pages =
+      static_cast<double>(state.iterations()) * (size / kPageSize);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+  state.counters["fork_us"] = static_cast<double>(fork_ns) / 1e3 /
+                              static_cast<double>(state.iterations());
+  state.counters["faults_per_second"] =
+      write_ns > 0 ? pages / (static_cast<double>(write_ns) / 1e9) : 0;
+}
+
+void COWArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"size", "writer", "advice"});
+  for (int64_t size = 64 << 20; size <= int64_t{16} << 30; size *= 4) {
+    for (const COWWriter writer : {COWWriter::kChild, COWWriter::kParent}) {
+      for (size_t advice = 0; advice < std::size(kCOWAdvice); advice++) {
+        // Memory left out of the child can't be written by it.
+        if (kCOWAdvice[advice] == MADV_DONTFORK &&
+            writer == COWWriter::kChild) {
+          continue;
+        }
+        b->Args({size, static_cast<int64_t>(writer),
+                 static_cast<int64_t>(advice)});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_ForkCOW)
+    ->Apply(COWArguments)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
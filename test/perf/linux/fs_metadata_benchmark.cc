@@ -0,0 +1,222 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks exercise the metadata operations that dominate build
+// tools: path walks, stats, renames and create/unlink churn. Run them on
+// both gofer- and overlay-backed filesystems to compare the two.
+
+// DeepPath returns top/d/d/.../d with depth components.
+std::string DeepPath(const std::string& top, int depth) {
+  std::string path = top;
+  for (int i = 0; i < depth; i++) {
+    path = JoinPath(path, "d");
+  }
+  return path;
+}
+
+// BM_PathWalk opens a directory depth levels down with O_PATH, so that the
+// cost is dominated by path resolution.
+void BM_PathWalk(benchmark::State& state) {
+  const int depth = state.range(0);
+  const TempPath top = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+  const std::string path = DeepPath(top.path(), depth);
+  ASSERT_NO_ERRNO(RecursivelyCreateDir(path));
+
+  for (auto _ : state) {
+    int fd = open(path.c_str(), O_PATH);
+    TEST_CHECK(fd >= 0);
+    TEST_CHECK(close(fd) == 0);
+  }
+}
+
+BENCHMARK(BM_PathWalk)->RangeMultiplier(4)->Range(1, 64)->UseRealTime();
+
+// WideDir returns a directory containing files named 0 to files-1. The
+// directories are created once per process and reused by every run of the
+// benchmark, since populating one is far slower than the benchmark itself.
+const std::string& WideDir(int files) {
+  static auto* dirs = new std::map<int, TempPath>();
+  auto it = dirs->find(files);
+  if (it == dirs->end()) {
+    TempPath dir = TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+    for (int i = 0; i < files; i++) {
+      int fd = open(JoinPath(dir.path(), absl::StrCat(i)).c_str(),
+                    O_CREAT | O_EXCL | O_WRONLY, 0644);
+      TEST_CHECK(fd >= 0);
+      TEST_CHECK(close(fd) == 0);
+    }
+    it = dirs->emplace(files, std::move(dir)).first;
+  }
+  return it->second.path();
+}
+
+// BM_StatxWide calls statx on each file of a directory of the given size in
+// turn. Small directories stay hot in the dentry cache; directories larger
+// than the cache force every lookup to revalidate or refetch a cold dentry.
+void BM_StatxWide(benchmark::State& state) {
+  const int files = state.range(0);
+  const std::string& dir = WideDir(files);
+  const FileDescriptor dirfd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(dir, O_RDONLY | O_DIRECTORY));
+
+  std::vector<std::string> names;
+  names.reserve(files);
+  for (int i = 0; i < files; i++) {
+    names.push_back(absl::StrCat(i));
+  }
+
+  struct statx stx;
+  int i = 0;
+  for (auto _ : state) {
+    TEST_CHECK(statx(dirfd.get(), names[i].c_str(), 0,
+                     STATX_BASIC_STATS, &stx) == 0);
+    if (++i == files) {
+      i = 0;
+    }
+  }
+}
+
+BENCHMARK(BM_StatxWide)->Arg(64)->Arg(1 << 12)->Arg(1 << 14)->UseRealTime();
+
+// BM_Rename moves a file back and forth, between two directories (1) or
+// within one directory (0).
+void BM_Rename(benchmark::State& state) {
+  const bool cross = state.range(0);
+  const TempPath top = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+  const TempPath a =
+      ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDirIn(top.path()));
+  const TempPath b =
+      ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDirIn(top.path()));
+
+  const std::string from = JoinPath(a.path(), "f");
+  const std::string to = JoinPath(cross ? b.path() : a.path(), "g");
+  ASSERT_NO_ERRNO(Open(from, O_CREAT | O_WRONLY, 0644));
+
+  bool there = false;
+  for (auto _ : state) {
+    if (there) {
+      TEST_CHECK(rename(to.c_str(), from.c_str()) == 0);
+    } else {
+      TEST_CHECK(rename(from.c_str(), to.c_str()) == 0);
+    }
+    there = !there;
+  }
+
+  // Leave the file where the directory destructors can find it.
+  if (there) {
+    TEST_CHECK(rename(to.c_str(), from.c_str()) == 0);
+  }
+  ASSERT_NO_ERRNO(Unlink(from));
+}
+
+BENCHMARK(BM_Rename)->Arg(0)->Arg(1)->ArgName("cross")->UseRealTime();
+
+// Directory shared by all threads of BM_CreateUnlink when shared is set.
+TempPath* churn_dir;
+
+// BM_CreateUnlink creates and unlinks a file per iteration from every
+// benchmark thread, either in one shared directory (1) or in a directory per
+// thread (0).
+void BM_CreateUnlink(benchmark::State& state) {
+  const bool shared = state.range(0);
+  if (shared && state.thread_index() == 0) {
+    churn_dir =
+        new TempPath(TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateDir()));
+  }
+
+  TempPath own;
+  if (!shared) {
+    own = TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+  }
+
+  // The first iteration synchronizes all threads, so churn_dir is valid
+  // inside the loop.
+  std::string path;
+  for (auto _ : state) {
+    if (path.empty()) {
+      path = JoinPath(shared ? churn_dir->path() : own.path(),
+                      absl::StrCat("f", state.thread_index()));
+    }
+    int fd = open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+    TEST_CHECK(fd >= 0);
+    TEST_CHECK(close(fd) == 0);
+    TEST_CHECK(unlink(path.c_str()) == 0);
+  }
+
+  if (shared && state.thread_index() == 0) {
+    delete churn_dir;
+    churn_dir = nullptr;
+  }
+}
+
+BENCHMARK(BM_CreateUnlink)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("shared")
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// BM_OpenPathRootfs opens the test binary, which lives on the root
+// filesystem (an overlay in sandboxes started with --overlay), with O_PATH.
+// The path is resolved from the root (0) or relative to its parent directory
+// (1).
+void BM_OpenPathRootfs(benchmark::State& state) {
+  const bool relative = state.range(0);
+  const std::string exe = ASSERT_NO_ERRNO_AND_VALUE(ProcessExePath(getpid()));
+  const FileDescriptor parent = ASSERT_NO_ERRNO_AND_VALUE(
+      Open(std::string(Dirname(exe)), O_PATH | O_DIRECTORY));
+  const std::string name(Basename(exe));
+
+  const int dirfd = relative ? parent.get() : AT_FDCWD;
+  const char* path = relative ? name.c_str() : exe.c_str();
+  for (auto _ : state) {
+    int fd = openat(dirfd, path, O_PATH);
+    TEST_CHECK(fd >= 0);
+    TEST_CHECK(close(fd) == 0);
+  }
+}
+
+BENCHMARK(BM_OpenPathRootfs)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("relative")
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
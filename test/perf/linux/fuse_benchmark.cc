@@ -0,0 +1,485 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <linux/fuse.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "test/util/eventfd_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/fuse_util.h"
+#include "test/util/linux_capability_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks mount a FUSE filesystem served by a minimal daemon running
+// on threads of the benchmark process, and measure the client side. The
+// filesystem contains a single regular file whose contents are never
+// checked, so the daemon's own work is negligible and the results are
+// dominated by the FUSE round trip.
+
+constexpr char kFileName[] = "file";
+constexpr uint64_t kFileNodeID = 2;
+constexpr uint64_t kFileSize = 1 << 30;
+
+// The largest read or write the daemon accepts.
+constexpr int kMaxIO = 1 << 20;
+
+// FUSE_MAX_PAGES raises the per-request limit from 32 pages to this.
+constexpr int kMaxPages = kMaxIO / 4096;
+
+// The contents of every read reply. It is page aligned so that splicing a
+// reply takes as few pipe buffers as possible.
+alignas(4096) const char reply_data[kMaxIO] = {};
+
+struct FuseServerOptions {
+  // The number of daemon threads, all reading requests from the same
+  // /dev/fuse fd.
+  int threads = 1;
+
+  // Negotiate FUSE_MAX_PAGES, so that a request can carry up to kMaxIO bytes
+  // instead of 128KB.
+  bool max_pages = false;
+
+  // Reply to reads by splicing the reply from a pipe into /dev/fuse instead
+  // of writing it.
+  bool splice = false;
+};
+
+class FuseServer {
+ public:
+  // Create mounts a FUSE filesystem served by a new FuseServer.
+  static PosixErrorOr<std::unique_ptr<FuseServer>> Create(
+      FuseServerOptions opts) {
+    ASSIGN_OR_RETURN_ERRNO(bool have_cap, HaveCapability(CAP_SYS_ADMIN));
+    if (!have_cap) {
+      return PosixError(EPERM, "mounting FUSE requires CAP_SYS_ADMIN");
+    }
+    std::unique_ptr<FuseServer> server(new FuseServer(opts));
+    ASSIGN_OR_RETURN_ERRNO(server->dev_,
+                           Open("/dev/fuse", O_RDWR | O_NONBLOCK));
+    ASSIGN_OR_RETURN_ERRNO(server->stop_, NewEventFD());
+    ASSIGN_OR_RETURN_ERRNO(server->mount_point_, TempPath::CreateDir());
+    server->file_path_ = JoinPath(server->mount_point_.path(), kFileName);
+    const std::string mount_opts = absl::StrFormat(
+        "fd=%d,user_id=0,group_id=0,rootmode=40000", server->dev_.get());
+    if (mount("fuse", server->mount_point_.path().c_str(), "fuse",
+              MS_NODEV | MS_NOSUID, mount_opts.c_str()) < 0) {
+      return PosixError(errno, "mount");
+    }
+    server->mounted_ = true;
+    for (int i = 0; i < opts.threads; i++) {
+      server->threads_.push_back(
+          std::make_unique<ScopedThread>([s = server.get()] { s->Serve(); }));
+    }
+    return server;
+  }
+
+  ~FuseServer() {
+    if (mounted_) {
+      TEST_PCHECK(umount2(mount_point_.path().c_str(), 0) == 0);
+    }
+    uint64_t val = 1;
+    if (stop_.get() >= 0) {
+      TEST_PCHECK(WriteFd(stop_.get(), &val, sizeof(val)) == sizeof(val));
+    }
+    threads_.clear();
+  }
+
+  // FilePath returns the path to the file served by the daemon.
+  const std::string& FilePath() const { return file_path_; }
+
+  // SpliceFailed returns true if a reply couldn't be spliced and was written
+  // instead.
+  bool SpliceFailed() const { return splice_failed_.load(); }
+
+ private:
+  explicit FuseServer(FuseServerOptions opts) : opts_(opts) {}
+
+  // SplicePipe is a daemon thread's pipe for splicing replies.
+  struct SplicePipe {
+    FileDescriptor r;
+    FileDescriptor w;
+    // The pipe's capacity. Larger replies are written instead.
+    int size = 0;
+  };
+
+  // Serve handles requests until the filesystem is unmounted.
+  void Serve() {
+    SplicePipe pipe;
+    if (opts_.splice) {
+      int fds[2];
+      TEST_PCHECK(::pipe(fds) == 0);
+      pipe.r = FileDescriptor(fds[0]);
+      pipe.w = FileDescriptor(fds[1]);
+      // Make room for the largest reply if allowed. pipe-max-size is
+      // usually 1MB, one buffer short of it.
+      pipe.size = fcntl(pipe.w.get(), F_SETPIPE_SZ, 2 * kMaxIO);
+      if (pipe.size < 0) {
+        pipe.size = fcntl(pipe.w.get(), F_SETPIPE_SZ, kMaxIO);
+      }
+      TEST_PCHECK(pipe.size > 0);
+    }
+
+    // The buffer must hold the largest write request, including its headers.
+    std::vector<uint64_t> buf((kMaxIO + 2 * kPageSize) / sizeof(uint64_t));
+    while (true) {
+      int n = read(dev_.get(), buf.data(), buf.size() * sizeof(uint64_t));
+      if (n < 0) {
+        if (errno == EAGAIN) {
+          // Wait until there is a request or the server is shut down.
+          struct pollfd pfds[2] = {{dev_.get(), POLLIN, 0},
+                                   {stop_.get(), POLLIN, 0}};
+          TEST_PCHECK(RetryEINTR(poll)(pfds, 2, -1) > 0);
+          if (pfds[1].revents) {
+            return;
+          }
+          continue;
+        }
+        // The connection is gone once the filesystem is unmounted.
+        TEST_PCHECK(errno == ENODEV || errno == ECONNABORTED ||
+                    errno == EINTR);
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      TEST_CHECK(n >= static_cast<int>(sizeof(fuse_in_header)));
+      Handle(reinterpret_cast<const fuse_in_header*>(buf.data()), pipe);
+    }
+  }
+
+  void Handle(const fuse_in_header* in, const SplicePipe& pipe) {
+    const void* payload = in + 1;
+    switch (in->opcode) {
+      case FUSE_INIT: {
+        fuse_init_out out = {};
+        out.major = FUSE_KERNEL_VERSION;
+        out.minor = FUSE_KERNEL_MINOR_VERSION;
+        out.max_write = kMaxIO;
+        out.flags = FUSE_BIG_WRITES;
+        if (opts_.max_pages) {
+          out.flags |= FUSE_MAX_PAGES;
+          out.max_pages = kMaxPages;
+        }
+        Reply(in, 0, &out, sizeof(out));
+        return;
+      }
+      case FUSE_LOOKUP: {
+        if (strcmp(static_cast<const char*>(payload), kFileName) != 0) {
+          Reply(in, ENOENT);
+          return;
+        }
+        fuse_entry_out out =
+            DefaultEntryOut(S_IFREG | 0644, kFileNodeID, kFileSize);
+        Reply(in, 0, &out, sizeof(out));
+        return;
+      }
+      case FUSE_GETATTR: {
+        fuse_attr_out out = {};
+        out.attr = in->nodeid == kFileNodeID
+                       ? DefaultFuseAttr(S_IFREG | 0644, kFileNodeID, kFileSize)
+                       : DefaultFuseAttr(S_IFDIR | 0755, FUSE_ROOT_ID);
+        Reply(in, 0, &out, sizeof(out));
+        return;
+      }
+      case FUSE_OPEN:
+      case FUSE_OPENDIR: {
+        // Direct I/O makes every read and write a request to the daemon.
+        fuse_open_out out = {};
+        out.fh = 1;
+        out.open_flags = FOPEN_DIRECT_IO;
+        Reply(in, 0, &out, sizeof(out));
+        return;
+      }
+      case FUSE_READ: {
+        const fuse_read_in* read_in = static_cast<const fuse_read_in*>(payload);
+        const uint32_t size = std::min<uint64_t>(
+            std::min<uint32_t>(read_in->size, kMaxIO),
+            kFileSize - std::min(read_in->offset, kFileSize));
+        if (opts_.splice && SpliceReply(in, size, pipe)) {
+          return;
+        }
+        Reply(in, 0, reply_data, size);
+        return;
+      }
+      case FUSE_WRITE: {
+        const fuse_write_in* write_in =
+            static_cast<const fuse_write_in*>(payload);
+        fuse_write_out out = {};
+        out.size = write_in->size;
+        Reply(in, 0, &out, sizeof(out));
+        return;
+      }
+      case FUSE_FLUSH:
+      case FUSE_RELEASE:
+      case FUSE_RELEASEDIR:
+      case FUSE_FSYNC:
+      case FUSE_DESTROY:
+        Reply(in, 0);
+        return;
+      case FUSE_FORGET:
+      case FUSE_BATCH_FORGET:
+      case FUSE_INTERRUPT:
+        // These have no reply.
+        return;
+      default:
+        Reply(in, ENOSYS);
+        return;
+    }
+  }
+
+  void Reply(const fuse_in_header* in, int error, const void* payload = nullptr,
+             size_t len = 0) {
+    fuse_out_header out = {};
+    out.len = sizeof(out) + len;
+    out.error = -error;
+    out.unique = in->unique;
+    struct iovec iov[2] = {{&out, sizeof(out)},
+                           {const_cast<void*>(payload), len}};
+    int n = RetryEINTR(writev)(dev_.get(), iov, len ? 2 : 1);
+    // The request may have been interrupted, or the connection aborted.
+    TEST_PCHECK(n == static_cast<int>(out.len) || errno == ENOENT ||
+                errno == ENODEV || errno == ECONNABORTED);
+  }
+
+  // SpliceReply replies to a read with size bytes of data by vmsplicing it
+  // into a pipe and splicing the pipe into /dev/fuse, the way libfuse does
+  // when built with splice support. It returns false if the reply must be
+  // written instead.
+  bool SpliceReply(const fuse_in_header* in, uint32_t size,
+                   const SplicePipe& pipe) {
+    fuse_out_header out = {};
+    out.len = sizeof(out) + size;
+    out.unique = in->unique;
+    // Each page of the reply and the header take one pipe buffer.
+    if (1 + (size + kPageSize - 1) / kPageSize > pipe.size / kPageSize) {
+      return false;
+    }
+
+    // vmsplice may queue the reply in several pieces.
+    uint32_t queued = 0;
+    while (queued < out.len) {
+      struct iovec iov[2];
+      int iovcnt = 0;
+      if (queued < sizeof(out)) {
+        iov[iovcnt++] = {reinterpret_cast<char*>(&out) + queued,
+                         sizeof(out) - queued};
+        iov[iovcnt++] = {const_cast<char*>(reply_data), size};
+      } else {
+        iov[iovcnt++] = {const_cast<char*>(reply_data) + queued -
+                             sizeof(out),
+                         out.len - queued};
+      }
+      int n = vmsplice(pipe.w.get(), iov, iovcnt, 0);
+      if (n < 0) {
+        TEST_CHECK(queued == 0);
+        splice_failed_.store(true);
+        return false;
+      }
+      queued += n;
+    }
+
+    int n = splice(pipe.r.get(), nullptr, dev_.get(), nullptr, out.len, 0);
+    if (n == static_cast<int>(out.len)) {
+      return true;
+    }
+    // Drain what is left of the reply from the pipe. If the request was
+    // interrupted or the connection aborted, there is nothing more to do;
+    // otherwise fall back to writing the reply.
+    const int err = errno;
+    std::vector<char> discard(out.len - std::max(n, 0));
+    TEST_CHECK(ReadFd(pipe.r.get(), discard.data(), discard.size()) ==
+               static_cast<int>(discard.size()));
+    if (n < 0 && (err == ENOENT || err == ENODEV || err == ECONNABORTED)) {
+      return true;
+    }
+    TEST_CHECK(n < 0);
+    splice_failed_.store(true);
+    return false;
+  }
+
+  const FuseServerOptions opts_;
+  FileDescriptor dev_;
+  FileDescriptor stop_;
+  TempPath mount_point_;
+  std::string file_path_;
+  bool mounted_ = false;
+  std::vector<std::unique_ptr<ScopedThread>> threads_;
+  std::atomic<bool> splice_failed_{false};
+};
+
+// The server shared by the threads of the running benchmark, and a
+// descriptor for its file. Thread 0 creates and destroys both.
+FuseServer* fuse_server;
+int fuse_file = -1;
+
+// SetUp is called by every benchmark thread before the benchmark loop. Only
+// thread 0 creates the server; if that fails it skips the benchmark, and the
+// other threads must check Ready() once the loop has started.
+void SetUp(benchmark::State& state, FuseServerOptions opts, int flags) {
+  if (state.thread_index() != 0) {
+    return;
+  }
+  PosixErrorOr<std::unique_ptr<FuseServer>> server = FuseServer::Create(opts);
+  if (!server.ok()) {
+    state.SkipWithError(server.error().ToString().c_str());
+    return;
+  }
+  fuse_server = server.ValueOrDie().release();
+  if (flags >= 0) {
+    fuse_file = open(fuse_server->FilePath().c_str(), flags);
+    TEST_PCHECK(fuse_file >= 0);
+  }
+}
+
+bool Ready(benchmark::State& state) {
+  if (fuse_server == nullptr) {
+    state.SkipWithError("FUSE server setup failed");
+    return false;
+  }
+  return true;
+}
+
+void TearDown(benchmark::State& state) {
+  if (state.thread_index() != 0 || fuse_server == nullptr) {
+    return;
+  }
+  if (fuse_file >= 0) {
+    TEST_PCHECK(close(fuse_file) == 0);
+    fuse_file = -1;
+  }
+  if (fuse_server->SpliceFailed()) {
+    state.SkipWithError("splicing replies into /dev/fuse is unsupported");
+  }
+  delete fuse_server;
+  fuse_server = nullptr;
+}
+
+// BM_FuseStat stats the file. Entries and attributes are never cached, so
+// each stat is a LOOKUP and possibly a GETATTR request.
+void BM_FuseStat(benchmark::State& state) {
+  FuseServerOptions opts;
+  opts.threads = state.range(0);
+  SetUp(state, opts, -1);
+
+  for (auto _ : state) {
+    if (!Ready(state)) {
+      break;
+    }
+    struct stat st;
+    TEST_PCHECK(stat(fuse_server->FilePath().c_str(), &st) == 0);
+  }
+
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FuseStat)
+    ->Arg(1)
+    ->Arg(4)
+    ->ArgName("daemon_threads")
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+
+// BM_FuseRead reads the file at offset 0 with direct I/O. Reads larger than
+// the per-request limit are split into several READ requests.
+void BM_FuseRead(benchmark::State& state) {
+  const int size = state.range(0);
+  FuseServerOptions opts;
+  opts.threads = state.range(1);
+  opts.max_pages = state.range(2);
+  opts.splice = state.range(3);
+  SetUp(state, opts, O_RDONLY);
+
+  std::vector<char> buf(size);
+  for (auto _ : state) {
+    if (!Ready(state)) {
+      break;
+    }
+    TEST_CHECK(PreadFd(fuse_file, buf.data(), buf.size(), 0) == size);
+  }
+
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_FuseRead)
+    ->ArgsProduct({{4 << 10, 128 << 10, 1 << 20}, {1, 4}, {0, 1}, {0, 1}})
+    ->ArgNames({"size", "daemon_threads", "max_pages", "splice"})
+    ->Threads(1)
+    ->Threads(4)
+    ->UseRealTime();
+
+// BM_FuseWrite is BM_FuseRead for writes.
+void BM_FuseWrite(benchmark::State& state) {
+  const int size = state.range(0);
+  FuseServerOptions opts;
+  opts.threads = state.range(1);
+  opts.max_pages = state.range(2);
+  SetUp(state, opts, O_WRONLY);
+
+  std::vector<char> buf(size);
+  for (auto _ : state) {
+    if (!Ready(state)) {
+      break;
+    }
+    TEST_CHECK(PwriteFd(fuse_file, buf.data(), buf.size(), 0) == size);
+  }
+
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_FuseWrite)
+    ->ArgsProduct({{4 << 10, 128 << 10, 1 << 20}, {1, 4}, {0, 1}})
+    ->ArgNames({"size", "daemon_threads", "max_pages"})
+    ->Threads(1)
+    ->Threads(4)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -13,20 +13,32 @@
 // limitations under the License.
 
 #include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include <atomic>
 #include <cerrno>
+#include <climits>
 #include <cstdint>
 #include <cstdlib>
 #include <ctime>
+#include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "benchmark/benchmark.h"
 #include "test/util/logging.h"
+#include "test/util/memory_util.h"
+#include "test/util/posix_error.h"
 #include "test/util/thread_util.h"
 
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449
+#endif
+
 namespace gvisor {
 namespace testing {
 
@@ -192,6 +204,216 @@ BENCHMARK(BM_FutexRoundtripDelayed)
     ->Arg(50)
     ->Arg(100);
 
+// FutexBroadcast is the mechanism used to wake all waiters of a
+// BroadcastLatency benchmark.
+enum class FutexBroadcast {
+  // FUTEX_WAKE of every waiter at once.
+  kWake,
+  // FUTEX_CMP_REQUEUE of all but one waiter onto a second futex, as condition
+  // variable broadcasts do to avoid a thundering herd on the mutex. Each
+  // woken waiter then hands off to the next with FUTEX_WAKE on that futex.
+  kRequeue,
+};
+
+// BroadcastLatency measures the time from waking a futex with many waiters
+// blocked on it until every waiter has returned from FUTEX_WAIT.
+void BroadcastLatency(benchmark::State& state, FutexBroadcast how) {
+  const int waiters = state.range(0);
+  std::atomic<int32_t> gen(0);
+  std::atomic<int32_t> mutex(0);
+  std::atomic<int> arrived(0);
+  std::atomic<int> woken(0);
+  std::atomic<bool> done(false);
+
+  std::vector<std::unique_ptr<ScopedThread>> threads;
+  for (int i = 0; i < waiters; i++) {
+    threads.push_back(std::make_unique<ScopedThread>([&] {
+      int32_t seen = 0;
+      while (true) {
+        arrived.fetch_add(1, std::memory_order_acq_rel);
+        while (gen.load(std::memory_order_acquire) == seen) {
+          FutexWait(&gen, seen);
+        }
+        seen = gen.load(std::memory_order_acquire);
+        if (done.load(std::memory_order_acquire)) {
+          return;
+        }
+        woken.fetch_add(1, std::memory_order_acq_rel);
+        if (how == FutexBroadcast::kRequeue) {
+          FutexWake(&mutex, 1);
+        }
+      }
+    }));
+  }
+
+  auto wait_arrived = [&] {
+    while (arrived.load(std::memory_order_acquire) < waiters) {
+      sched_yield();
+    }
+    // Give the last waiters time to block in the kernel, so the wakeup
+    // doesn't race with their FUTEX_WAIT.
+    absl::SleepFor(absl::Microseconds(100));
+    arrived.store(0, std::memory_order_release);
+  };
+
+  for (auto _ : state) {
+    wait_arrived();
+
+    const int64_t start = GetCurrentMonotonicTimeNanos();
+    const int32_t val = gen.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (how == FutexBroadcast::kWake) {
+      FutexWake(&gen, INT_MAX);
+    } else {
+      TEST_PCHECK(syscall(SYS_futex, &gen, FUTEX_CMP_REQUEUE_PRIVATE, 1,
+                          INT_MAX, &mutex, val) >= 0);
+    }
+    while (woken.load(std::memory_order_acquire) < waiters) {
+      sched_yield();
+    }
+    const int64_t end = GetCurrentMonotonicTimeNanos();
+    state.SetIterationTime(static_cast<double>(end - start) / 1e9);
+    woken.store(0, std::memory_order_release);
+  }
+
+  wait_arrived();
+  done.store(true, std::memory_order_release);
+  gen.fetch_add(1, std::memory_order_acq_rel);
+  FutexWake(&gen, INT_MAX);
+}
+
+void BM_FutexWakeBroadcast(benchmark::State& state) {
+  BroadcastLatency(state, FutexBroadcast::kWake);
+}
+
+BENCHMARK(BM_FutexWakeBroadcast)
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->UseManualTime();
+
+void BM_FutexCmpRequeueBroadcast(benchmark::State& state) {
+  BroadcastLatency(state, FutexBroadcast::kRequeue);
+}
+
+BENCHMARK(BM_FutexCmpRequeueBroadcast)
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->UseManualTime();
+
+// A futex-based mutex shared by all threads of BM_FutexMutex. The value is 0
+// when unlocked, 1 when locked and 2 when locked with possible waiters.
+std::atomic<int32_t> futex_mutex(0);
+
+// BM_FutexMutex measures lock handoff of a plain futex mutex across the
+// benchmark threads. Compare with BM_FutexMutexPI.
+void BM_FutexMutex(benchmark::State& state) {
+  for (auto _ : state) {
+    int32_t c = 0;
+    if (!futex_mutex.compare_exchange_strong(c, 1,
+                                             std::memory_order_acquire)) {
+      if (c != 2) {
+        c = futex_mutex.exchange(2, std::memory_order_acquire);
+      }
+      while (c != 0) {
+        FutexWait(&futex_mutex, 2);
+        c = futex_mutex.exchange(2, std::memory_order_acquire);
+      }
+    }
+    if (futex_mutex.fetch_sub(1, std::memory_order_release) != 1) {
+      futex_mutex.store(0, std::memory_order_release);
+      FutexWake(&futex_mutex, 1);
+    }
+  }
+}
+
+BENCHMARK(BM_FutexMutex)->ThreadRange(1, 32)->UseRealTime();
+
+// A priority-inheritance futex shared by all threads of BM_FutexMutexPI. The
+// value is the owner's TID, with FUTEX_WAITERS set by the kernel if there
+// are waiters.
+std::atomic<int32_t> futex_pi(0);
+
+// BM_FutexMutexPI measures lock handoff of a FUTEX_LOCK_PI mutex, as used by
+// PTHREAD_PRIO_INHERIT mutexes, across the benchmark threads.
+void BM_FutexMutexPI(benchmark::State& state) {
+  const int32_t tid = syscall(SYS_gettid);
+  for (auto _ : state) {
+    int32_t c = 0;
+    if (!futex_pi.compare_exchange_strong(c, tid, std::memory_order_acquire)) {
+      TEST_PCHECK(syscall(SYS_futex, &futex_pi, FUTEX_LOCK_PI_PRIVATE, 0,
+                          nullptr) == 0);
+    }
+    c = tid;
+    if (!futex_pi.compare_exchange_strong(c, 0, std::memory_order_release)) {
+      TEST_PCHECK(syscall(SYS_futex, &futex_pi, FUTEX_UNLOCK_PI_PRIVATE) == 0);
+    }
+  }
+}
+
+BENCHMARK(BM_FutexMutexPI)->ThreadRange(1, 32)->UseRealTime();
+
+// BM_FutexWakeNopShared is BM_FutexWakeNop on a futex in a MAP_SHARED
+// mapping, with the private flag (1) or without it (0). Shared futexes are
+// keyed by the backing memory rather than the address, which is more
+// expensive to look up. Each benchmark thread uses its own futex.
+void BM_FutexWakeNopShared(benchmark::State& state) {
+  const bool priv = state.range(0);
+  Mapping m = ASSERT_NO_ERRNO_AND_VALUE(
+      MmapAnon(kPageSize, PROT_READ | PROT_WRITE, MAP_SHARED));
+  auto* v = reinterpret_cast<std::atomic<int32_t>*>(m.ptr());
+  const int op = priv ? FUTEX_WAKE_PRIVATE : FUTEX_WAKE;
+
+  for (auto _ : state) {
+    TEST_PCHECK(syscall(SYS_futex, v, op, 1) == 0);
+  }
+}
+
+BENCHMARK(BM_FutexWakeNopShared)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("private")
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// FutexWaitv mirrors struct futex_waitv, which older UAPI headers lack.
+struct FutexWaitv {
+  uint64_t val;
+  uint64_t uaddr;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+// FUTEX_32 | FUTEX_PRIVATE_FLAG in futex_waitv flags.
+constexpr uint32_t kFutexWaitvPrivate32 = 2 | FUTEX_PRIVATE_FLAG;
+
+// BM_FutexWaitvNop uses futex_waitv(2) on n futexes where the last one's
+// value has changed, so the syscall queues on every futex and then returns
+// without waiting.
+void BM_FutexWaitvNop(benchmark::State& state) {
+  const int n = state.range(0);
+  std::vector<std::atomic<int32_t>> vs(n);
+  std::vector<FutexWaitv> waiters(n);
+  for (int i = 0; i < n; i++) {
+    vs[i].store(0);
+    waiters[i].uaddr = reinterpret_cast<uintptr_t>(&vs[i]);
+    waiters[i].flags = kFutexWaitvPrivate32;
+  }
+  waiters[n - 1].val = 1;
+
+  if (syscall(SYS_futex_waitv, waiters.data(), n, 0, nullptr, 0) != -1 ||
+      errno != EAGAIN) {
+    state.SkipWithError("futex_waitv unsupported");
+    return;
+  }
+
+  for (auto _ : state) {
+    TEST_PCHECK(syscall(SYS_futex_waitv, waiters.data(), n, 0, nullptr, 0) ==
+                    -1 &&
+                errno == EAGAIN);
+  }
+}
+
+BENCHMARK(BM_FutexWaitvNop)->Arg(1)->Arg(8)->Arg(128);
+
 }  // namespace
 
 }  // namespace testing
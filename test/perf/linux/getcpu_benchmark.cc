@@ -0,0 +1,51 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+void BM_Getcpu(benchmark::State& state) {
+  unsigned cpu, node;
+  for (auto _ : state) {
+    syscall(SYS_getcpu, &cpu, &node, nullptr);
+  }
+}
+
+BENCHMARK(BM_Getcpu);
+
+// BM_VDSOGetcpu calls getcpu through libc, which uses the VDSO (or rseq, if
+// available) rather than making a system call.
+void BM_VDSOGetcpu(benchmark::State& state) {
+  unsigned cpu, node;
+  for (auto _ : state) {
+    getcpu(&cpu, &node);
+    benchmark::DoNotOptimize(cpu);
+  }
+}
+
+BENCHMARK(BM_VDSOGetcpu);
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -12,16 +12,30 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "benchmark/benchmark.h"
 #include "test/util/file_descriptor.h"
 #include "test/util/fs_util.h"
+#include "test/util/logging.h"
 #include "test/util/temp_path.h"
 #include "test/util/test_util.h"
+#include "test/util/thread_util.h"
 
 #ifndef SYS_getdents64
 #if defined(__x86_64__)
@@ -42,6 +56,15 @@ namespace {
 
 constexpr int kBufferSize = 65536;
 
+// New Linux dirent format.
+struct linux_dirent64 {
+  uint64_t d_ino;           // Inode number
+  int64_t d_off;            // Offset to next linux_dirent64
+  unsigned short d_reclen;  // NOLINT, Length of this linux_dirent64
+  unsigned char d_type;     // NOLINT, File type
+  char d_name[0];           // Filename (null-terminated)
+};
+
 PosixErrorOr<TempPath> CreateDirectory(int count,
                                        std::vector<std::string>* files) {
   ASSIGN_OR_RETURN_ERRNO(TempPath dir, TempPath::CreateDir());
@@ -145,6 +168,170 @@ void BM_GetdentsNewFD(benchmark::State& state) {
 
 BENCHMARK(BM_GetdentsNewFD)->Range(1, 1 << 12)->UseRealTime();
 
+// The benchmarks below list directories of up to 1M entries, as mail spools,
+// caches and artifact stores hold.
+
+// LargeDirectory is a directory of count files, which are unlinked one by one
+// on destruction for the reason given in BM_GetdentsSameFD.
+struct LargeDirectory {
+  explicit LargeDirectory(int count)
+      : dir(TEST_CHECK_NO_ERRNO_AND_VALUE(CreateDirectory(count, &files))) {}
+
+  ~LargeDirectory() { TEST_CHECK_NO_ERRNO(CleanupDirectory(dir, &files)); }
+
+  // Declared first, since creating dir fills it.
+  std::vector<std::string> files;
+  TempPath dir;
+};
+
+// Directory shared by the benchmarks below. It is kept between runs with the
+// same number of files, since creating it dominates otherwise.
+std::unique_ptr<LargeDirectory> large_dir;
+
+void LargeDirectorySetup(const benchmark::State& state) {
+  const int count = state.range(0);
+  if (large_dir == nullptr ||
+      static_cast<int>(large_dir->files.size()) != count) {
+    large_dir.reset();
+    large_dir = std::make_unique<LargeDirectory>(count);
+  }
+}
+
+constexpr int64_t kLargeCounts[] = {1 << 14, 1 << 17, 1 << 20};
+
+// BM_GetdentsLarge reads all entries of a large directory with getdents64
+// buffers of state.range(1) bytes. Reported times are per entry.
+void BM_GetdentsLarge(benchmark::State& state) {
+  const int count = state.range(0);
+  const int size = state.range(1);
+  FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(
+      Open(large_dir->dir.path(), O_RDONLY | O_DIRECTORY));
+  std::vector<char> buffer(size);
+
+  while (state.KeepRunningBatch(count)) {
+    ASSERT_THAT(lseek(fd.get(), 0, SEEK_SET), SyscallSucceeds());
+
+    int ret;
+    do {
+      ASSERT_THAT(
+          ret = syscall(SYS_getdents64, fd.get(), buffer.data(), size),
+          SyscallSucceeds());
+    } while (ret > 0);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_GetdentsLarge)
+    ->Setup(LargeDirectorySetup)
+    ->ArgsProduct({{std::begin(kLargeCounts), std::end(kLargeCounts)},
+                   {4096, kBufferSize, 1 << 20}})
+    ->ArgNames({"files", "buffer"})
+    ->UseRealTime();
+
+// BM_GetdentsResume lists a large directory with readdir, saving its position
+// with telldir and resuming from it with seekdir every state.range(1)
+// entries, as paginated scanners do. seekdir discards the entries buffered by
+// readdir, so every resumption seeks the directory and reads it again.
+//
+// Seeking a directory may cost time linear in the offset, making a listing
+// quadratic, so this stops at 128K entries.
+void BM_GetdentsResume(benchmark::State& state) {
+  const int count = state.range(0);
+  const int chunk = state.range(1);
+  DIR* const dir = opendir(large_dir->dir.path().c_str());
+  ASSERT_NE(dir, nullptr);
+
+  while (state.KeepRunningBatch(count)) {
+    rewinddir(dir);
+    int seen = 0;
+    while (readdir(dir) != nullptr) {
+      if (++seen % chunk == 0) {
+        seekdir(dir, telldir(dir));
+      }
+    }
+    // Including "." and "..".
+    TEST_CHECK(seen == count + 2);
+  }
+
+  closedir(dir);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_GetdentsResume)
+    ->Setup(LargeDirectorySetup)
+    ->ArgsProduct({{1 << 14, 1 << 17}, {64, 1024}})
+    ->ArgNames({"files", "chunk"})
+    ->UseRealTime();
+
+// BM_GetdentsConcurrentModify reads all entries of a large directory while
+// another thread keeps creating and unlinking other files in it. Entries that
+// exist throughout a listing must be returned exactly once; the "errors"
+// counter is the average number per listing that were missed or duplicated.
+// The "churn" counter is the rate of creates and unlinks.
+void BM_GetdentsConcurrentModify(benchmark::State& state) {
+  constexpr char kChurnPrefix[] = "churn";
+  const int count = state.range(0);
+  FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(
+      Open(large_dir->dir.path(), O_RDONLY | O_DIRECTORY));
+  std::vector<char> buffer(kBufferSize);
+
+  std::atomic<bool> done(false);
+  std::atomic<int64_t> churned(0);
+  ScopedThread churn([&] {
+    const FileDescriptor dfd = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        Open(large_dir->dir.path(), O_RDONLY | O_DIRECTORY));
+    for (uint64_t i = 0; !done.load(); i++) {
+      const std::string name = absl::StrCat(kChurnPrefix, i % 1024);
+      TEST_CHECK_NO_ERRNO(MknodAt(dfd, name, S_IFREG | 0644, 0));
+      TEST_CHECK_NO_ERRNO(UnlinkAt(dfd, name, 0));
+      churned += 2;
+    }
+  });
+
+  int64_t errors = 0;
+  int64_t listings = 0;
+  while (state.KeepRunningBatch(count)) {
+    ASSERT_THAT(lseek(fd.get(), 0, SEEK_SET), SyscallSucceeds());
+
+    int64_t stable = 0;
+    int ret;
+    do {
+      ASSERT_THAT(ret = syscall(SYS_getdents64, fd.get(), buffer.data(),
+                                buffer.size()),
+                  SyscallSucceeds());
+      for (int off = 0; off < ret;) {
+        const struct linux_dirent64* d =
+            reinterpret_cast<const struct linux_dirent64*>(buffer.data() +
+                                                           off);
+        const absl::string_view name(d->d_name);
+        if (name != "." && name != ".." &&
+            !absl::StartsWith(name, kChurnPrefix)) {
+          stable++;
+        }
+        off += d->d_reclen;
+      }
+    } while (ret > 0);
+    errors += std::abs(stable - count);
+    listings++;
+  }
+
+  done.store(true);
+  churn.Join();
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["errors"] =
+      listings > 0 ? static_cast<double>(errors) / listings : 0;
+  state.counters["churn"] = benchmark::Counter(static_cast<double>(churned),
+                                               benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_GetdentsConcurrentModify)
+    ->Setup(LargeDirectorySetup)
+    ->ArgsProduct({{std::begin(kLargeCounts), std::end(kLargeCounts)}})
+    ->ArgNames({"files"})
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
@@ -17,6 +17,7 @@
 
 #include "gtest/gtest.h"
 #include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
 
 namespace gvisor {
 namespace testing {
@@ -31,6 +32,30 @@ void BM_Getpid(benchmark::State& state) {
 
 BENCHMARK(BM_Getpid);
 
+// The same from many threads, each of which has its own platform context.
+BENCHMARK(BM_Getpid)->ThreadRange(64, 1024)->UseRealTime();
+
+void BM_GetpidLatency(benchmark::State& state) {
+  LatencyRecorder latency(state, "BM_GetpidLatency");
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    syscall(SYS_getpid);
+  }
+}
+
+BENCHMARK(BM_GetpidLatency);
+
+// BM_Getppid runs a system call that is always handled by the Sentry from
+// many threads at once. Under systrap, this keeps many stub threads spinning
+// concurrently, and so it exposes contention on the spinning queue.
+void BM_Getppid(benchmark::State& state) {
+  for (auto _ : state) {
+    syscall(SYS_getppid);
+  }
+}
+
+BENCHMARK(BM_Getppid)->ThreadRange(1, 256)->UseRealTime();
+
 #ifdef __x86_64__
 
 #define SYSNO_STR1(x) #x
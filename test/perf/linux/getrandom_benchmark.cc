@@ -0,0 +1,83 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the kernel's random number source, as used for
+// nonces and keys by TLS libraries, through getrandom(2) and by reading
+// /dev/urandom. Both are run from many threads at once to show whether the
+// source is a point of contention.
+
+// Fill fills buf with random bytes from getrandom(2), or from fd if urandom is
+// set, continuing after short reads.
+void Fill(char* buf, size_t size, bool urandom, int fd) {
+  for (size_t done = 0; done < size;) {
+    const ssize_t n =
+        urandom ? ReadFd(fd, buf + done, size - done)
+                : RetryEINTR(syscall)(SYS_getrandom, buf + done, size - done,
+                                      0);
+    TEST_PCHECK(n > 0);
+    done += n;
+  }
+}
+
+void BM_Getrandom(benchmark::State& state) {
+  const size_t size = state.range(0);
+  std::vector<char> buf(size);
+  for (auto _ : state) {
+    Fill(buf.data(), size, false, -1);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_Getrandom)
+    ->Range(16, 1 << 20)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+void BM_DevUrandom(benchmark::State& state) {
+  const size_t size = state.range(0);
+  std::vector<char> buf(size);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open("/dev/urandom", O_RDONLY));
+  for (auto _ : state) {
+    Fill(buf.data(), size, true, fd.get());
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_DevUrandom)
+    ->Range(16, 1 << 20)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,379 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// This benchmark approximates a static file web server such as nginx, to
+// give one number for the combined overhead of the syscalls it makes: an
+// epoll-based HTTP/1.1 server thread serves files from the test's temporary
+// directory with sendfile(2), and each benchmark thread is a client that
+// sends GET requests on its own keep-alive connection over loopback.
+//
+// Each iteration is one request and response, so items_per_second is the
+// request rate, and the latency percentiles are reported as for the other
+// benchmarks using LatencyRecorder.
+
+// Sizes of the files served by the server, which are also their paths (e.g.
+// "/1024").
+constexpr int kFileSizes[] = {1 << 10, 16 << 10, 256 << 10, 1 << 20};
+
+// Connection is the state of one client connection to the server.
+struct Connection {
+  FileDescriptor fd;
+
+  // Received bytes that don't yet form a complete request.
+  std::string in;
+
+  // The unsent part of the current response header.
+  std::string header;
+
+  // The current response body, sent from file_fd between file_off and
+  // file_end after the header. file_fd is -1 when there is no body to send.
+  int file_fd = -1;
+  off_t file_off = 0;
+  off_t file_end = 0;
+
+  // True if the connection is registered for EPOLLOUT.
+  bool want_out = false;
+};
+
+// HTTPServer is a single-threaded epoll event loop, like an nginx worker
+// process, serving files over HTTP/1.1 with keep-alive. It only knows enough
+// HTTP/1.1 for the requests this benchmark sends.
+class HTTPServer {
+ public:
+  HTTPServer();
+
+  const sockaddr_in& addr() const { return addr_; }
+
+ private:
+  struct File {
+    FileDescriptor fd;
+    off_t size;
+  };
+
+  void Run();
+  void Accept();
+
+  // Handle processes readiness events for c. It returns false if c should be
+  // closed.
+  bool Handle(Connection* c);
+
+  // Respond starts a response for a complete request with the given
+  // request line.
+  void Respond(Connection* c, absl::string_view request_line);
+
+  // Flush sends as much of c's response as it can, and returns false on
+  // error.
+  bool Flush(Connection* c);
+
+  absl::flat_hash_map<std::string, File> files_;
+  FileDescriptor listener_;
+  FileDescriptor epoll_;
+  sockaddr_in addr_ = {};
+};
+
+HTTPServer::HTTPServer() {
+  // The files are unlinked once opened, since they are served from their
+  // file descriptors.
+  for (int size : kFileSizes) {
+    const TempPath path = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        TempPath::CreateFileWith(GetAbsoluteTestTmpdir(),
+                                 std::string(size, 'a'),
+                                 TempPath::kDefaultFileMode));
+    files_["/" + std::to_string(size)] = File{
+        TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDONLY)), size};
+  }
+
+  listener_ = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      Socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+  addr_.sin_family = AF_INET;
+  addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  TEST_PCHECK(bind(listener_.get(), AsSockAddr(&addr_), sizeof(addr_)) == 0);
+  socklen_t addrlen = sizeof(addr_);
+  TEST_PCHECK(getsockname(listener_.get(), AsSockAddr(&addr_), &addrlen) ==
+              0);
+  TEST_PCHECK(listen(listener_.get(), SOMAXCONN) == 0);
+
+  epoll_ = FileDescriptor(epoll_create1(EPOLL_CLOEXEC));
+  TEST_PCHECK(epoll_.get() >= 0);
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.ptr = nullptr;
+  TEST_PCHECK(epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, listener_.get(), &ev) ==
+              0);
+
+  // The server runs for the rest of the process.
+  new ScopedThread([this] { Run(); });
+}
+
+void HTTPServer::Run() {
+  constexpr int kMaxEvents = 64;
+  struct epoll_event events[kMaxEvents];
+  while (true) {
+    const int n =
+        RetryEINTR(epoll_wait)(epoll_.get(), events, kMaxEvents, -1);
+    TEST_PCHECK(n > 0);
+    for (int i = 0; i < n; i++) {
+      if (events[i].data.ptr == nullptr) {
+        Accept();
+        continue;
+      }
+      auto* c = static_cast<Connection*>(events[i].data.ptr);
+      if (!Handle(c)) {
+        // Closing the file descriptor removes it from the epoll set.
+        delete c;
+      }
+    }
+  }
+}
+
+void HTTPServer::Accept() {
+  while (true) {
+    const int fd =
+        accept4(listener_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      TEST_PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+      return;
+    }
+    TEST_PCHECK(setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &kSockOptOn,
+                           sizeof(kSockOptOn)) == 0);
+    auto* c = new Connection();
+    c->fd = FileDescriptor(fd);
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = c;
+    TEST_PCHECK(epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, fd, &ev) == 0);
+  }
+}
+
+bool HTTPServer::Handle(Connection* c) {
+  if (!Flush(c)) {
+    return false;
+  }
+
+  bool eof = false;
+  char buf[4096];
+  while (true) {
+    const ssize_t n = read(c->fd.get(), buf, sizeof(buf));
+    if (n == 0) {
+      eof = true;
+      break;
+    }
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      // e.g. ECONNRESET.
+      return false;
+    }
+    c->in.append(buf, n);
+  }
+
+  // Requests are processed in order; a pipelined request waits until the
+  // response to the previous one is sent.
+  while (c->header.empty() && c->file_fd < 0) {
+    const size_t end = c->in.find("\r\n\r\n");
+    if (end == std::string::npos) {
+      break;
+    }
+    Respond(c, absl::string_view(c->in).substr(0, c->in.find("\r\n")));
+    c->in.erase(0, end + 4);
+    if (!Flush(c)) {
+      return false;
+    }
+  }
+  if (eof) {
+    return false;
+  }
+
+  const bool want_out = !c->header.empty() || c->file_fd >= 0;
+  if (want_out != c->want_out) {
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | (want_out ? EPOLLOUT : 0);
+    ev.data.ptr = c;
+    TEST_PCHECK(epoll_ctl(epoll_.get(), EPOLL_CTL_MOD, c->fd.get(), &ev) == 0);
+    c->want_out = want_out;
+  }
+  return true;
+}
+
+void HTTPServer::Respond(Connection* c, absl::string_view request_line) {
+  // e.g. "GET /1024 HTTP/1.1".
+  absl::string_view path;
+  if (absl::ConsumePrefix(&request_line, "GET ")) {
+    path = request_line.substr(0, request_line.find(' '));
+  }
+  auto it = files_.find(path);
+  if (it == files_.end()) {
+    c->header = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    return;
+  }
+  c->header = absl::StrCat(
+      "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+      "Content-Length: ",
+      it->second.size, "\r\n\r\n");
+  c->file_fd = it->second.fd.get();
+  c->file_off = 0;
+  c->file_end = it->second.size;
+}
+
+bool HTTPServer::Flush(Connection* c) {
+  while (!c->header.empty()) {
+    // MSG_MORE lets the header share a segment with the start of the body,
+    // as nginx does with TCP_CORK.
+    const ssize_t n = send(c->fd.get(), c->header.data(), c->header.size(),
+                           c->file_fd >= 0 ? MSG_MORE : 0);
+    if (n < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    c->header.erase(0, n);
+  }
+  while (c->file_fd >= 0) {
+    const ssize_t n = sendfile(c->fd.get(), c->file_fd, &c->file_off,
+                               c->file_end - c->file_off);
+    if (n < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (c->file_off == c->file_end) {
+      c->file_fd = -1;
+    }
+  }
+  return true;
+}
+
+HTTPServer* GetServer() {
+  static HTTPServer* const server = new HTTPServer();
+  return server;
+}
+
+// ReadResponse reads one response from fd into buf, and returns the length of
+// its body.
+size_t ReadResponse(int fd, std::vector<char>* buf) {
+  // Read up to the end of the header, which may include part of the body.
+  size_t len = 0;
+  size_t header_end;
+  while (true) {
+    const ssize_t n =
+        RetryEINTR(read)(fd, buf->data() + len, buf->size() - len);
+    TEST_PCHECK(n > 0);
+    len += n;
+    const absl::string_view received(buf->data(), len);
+    header_end = received.find("\r\n\r\n");
+    if (header_end != absl::string_view::npos) {
+      header_end += 4;
+      break;
+    }
+    TEST_CHECK(len < buf->size());
+  }
+
+  const absl::string_view header(buf->data(), header_end);
+  TEST_CHECK_MSG(absl::StartsWith(header, "HTTP/1.1 200 "),
+                 std::string(header).c_str());
+  constexpr absl::string_view kContentLength = "\r\nContent-Length: ";
+  const size_t pos = header.find(kContentLength);
+  TEST_CHECK(pos != absl::string_view::npos);
+  absl::string_view value = header.substr(pos + kContentLength.size());
+  value = value.substr(0, value.find("\r\n"));
+  size_t content_length;
+  TEST_CHECK(absl::SimpleAtoi(value, &content_length));
+
+  // Read the rest of the body.
+  size_t remaining = content_length - (len - header_end);
+  while (remaining > 0) {
+    const ssize_t n = RetryEINTR(read)(
+        fd, buf->data(), std::min(remaining, buf->size()));
+    TEST_PCHECK(n > 0);
+    remaining -= n;
+  }
+  return content_length;
+}
+
+void BM_HTTP(benchmark::State& state) {
+  const int size = state.range(0);
+  const HTTPServer* server = GetServer();
+
+  FileDescriptor fd = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      Socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+  TEST_PCHECK(setsockopt(fd.get(), IPPROTO_TCP, TCP_NODELAY, &kSockOptOn,
+                         sizeof(kSockOptOn)) == 0);
+  TEST_PCHECK(RetryEINTR(connect)(fd.get(), AsSockAddr(&server->addr()),
+                                  sizeof(server->addr())) == 0);
+
+  const std::string request =
+      absl::StrCat("GET /", size,
+                   " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: "
+                   "http_benchmark\r\nAccept: */*\r\n\r\n");
+  std::vector<char> buf(64 << 10);
+  {
+    LatencyRecorder latency(state, absl::StrCat("BM_HTTP/", size));
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      TEST_PCHECK(WriteFd(fd.get(), request.data(), request.size()) ==
+                  static_cast<ssize_t>(request.size()));
+      TEST_CHECK(ReadResponse(fd.get(), &buf) == static_cast<size_t>(size));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+void HTTPArgs(benchmark::internal::Benchmark* bench) {
+  for (int size : kFileSizes) {
+    bench->Arg(size);
+  }
+}
+
+// Each thread is one keep-alive connection.
+BENCHMARK(BM_HTTP)->Apply(HTTPArgs)->ThreadRange(1, 64)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,210 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/capability_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure ICMP on loopback, as sent at high rates by health
+// checkers and network probes: echo round trips through ping sockets, and
+// packet delivery between raw sockets. state.range(0) is the ICMP payload
+// size; 56 is ping's default.
+
+// Largest packet sent, including headers.
+constexpr size_t kMaxPacket = 2048;
+
+sockaddr_in LoopbackAddr() {
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return addr;
+}
+
+// SetRecvTimeout makes receives on fd fail after a second, so that a lost
+// packet fails the benchmark instead of hanging it.
+void SetRecvTimeout(int fd) {
+  struct timeval tv = {};
+  tv.tv_sec = 1;
+  TEST_PCHECK(setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0);
+}
+
+// OpenOrSkip returns a socket of the given type, or skips the benchmark and
+// returns an invalid FileDescriptor if the socket can't be created.
+FileDescriptor OpenOrSkip(benchmark::State& state, int type, int protocol) {
+  auto fd = Socket(AF_INET, type, protocol);
+  if (!fd.ok()) {
+    state.SkipWithError(fd.error().ToString().c_str());
+    return FileDescriptor();
+  }
+  return std::move(fd).ValueOrDie();
+}
+
+// BM_PingEcho measures the round trip of an echo request sent with a ping
+// socket (SOCK_DGRAM, IPPROTO_ICMP), which the stack answers itself.
+//
+// Creating ping sockets requires the caller's group to be in
+// net.ipv4.ping_group_range; the benchmark is skipped otherwise.
+void BM_PingEcho(benchmark::State& state) {
+  const int size = state.range(0);
+  FileDescriptor fd = OpenOrSkip(state, SOCK_DGRAM, IPPROTO_ICMP);
+  if (fd.get() < 0) {
+    return;
+  }
+  const sockaddr_in addr = LoopbackAddr();
+  TEST_PCHECK(connect(fd.get(), reinterpret_cast<const sockaddr*>(&addr),
+                      sizeof(addr)) == 0);
+  SetRecvTimeout(fd.get());
+
+  // Ping sockets fill in the identifier and checksum.
+  std::vector<char> request(sizeof(icmphdr) + size);
+  RandomizeBuffer(request.data() + sizeof(icmphdr), size);
+  icmphdr* const hdr = reinterpret_cast<icmphdr*>(request.data());
+  memset(hdr, 0, sizeof(*hdr));
+  hdr->type = ICMP_ECHO;
+  std::vector<char> reply(kMaxPacket);
+
+  uint16_t seq = 0;
+  for (auto _ : state) {
+    hdr->un.echo.sequence = htons(++seq);
+    TEST_PCHECK(send(fd.get(), request.data(), request.size(), 0) ==
+                static_cast<ssize_t>(request.size()));
+    const ssize_t n = recv(fd.get(), reply.data(), reply.size(), 0);
+    TEST_PCHECK(n == static_cast<ssize_t>(request.size()));
+    const icmphdr* const got = reinterpret_cast<const icmphdr*>(reply.data());
+    TEST_CHECK(got->type == ICMP_ECHOREPLY);
+    TEST_CHECK(got->un.echo.sequence == hdr->un.echo.sequence);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PingEcho)->Arg(56)->Arg(1400)->ArgName("size")->UseRealTime();
+
+// BM_RawICMP measures sending ICMP packets from one raw socket and receiving
+// them on another. With state.range(1) set, the sender builds the IP header
+// itself (IP_HDRINCL).
+//
+// The packets are echo replies, which the stack doesn't answer, so each
+// iteration delivers exactly one packet to the receiver; it is recognized by
+// its identifier and sequence number among any other ICMP traffic.
+void BM_RawICMP(benchmark::State& state) {
+  const int size = state.range(0);
+  const bool hdrincl = state.range(1);
+  if (!TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_NET_RAW))) {
+    state.SkipWithError("CAP_NET_RAW required");
+    return;
+  }
+  FileDescriptor sender = OpenOrSkip(state, SOCK_RAW, IPPROTO_ICMP);
+  if (sender.get() < 0) {
+    return;
+  }
+  FileDescriptor receiver = OpenOrSkip(state, SOCK_RAW, IPPROTO_ICMP);
+  if (receiver.get() < 0) {
+    return;
+  }
+  if (hdrincl) {
+    constexpr int kOne = 1;
+    TEST_PCHECK(setsockopt(sender.get(), IPPROTO_IP, IP_HDRINCL, &kOne,
+                           sizeof(kOne)) == 0);
+  }
+  SetRecvTimeout(receiver.get());
+  const sockaddr_in addr = LoopbackAddr();
+
+  const size_t ip_len = hdrincl ? sizeof(iphdr) : 0;
+  std::vector<char> packet(ip_len + sizeof(icmphdr) + size);
+  char* const payload = packet.data() + ip_len + sizeof(icmphdr);
+  RandomizeBuffer(payload, size);
+  icmphdr icmp = {};
+  icmp.type = ICMP_ECHOREPLY;
+  icmp.un.echo.id = htons(getpid() & 0xffff);
+  iphdr ip = {};
+  ip.ihl = sizeof(iphdr) / 4;
+  ip.version = 4;
+  ip.tot_len = htons(packet.size());
+  ip.ttl = 64;
+  ip.protocol = IPPROTO_ICMP;
+  ip.saddr = addr.sin_addr.s_addr;
+  ip.daddr = addr.sin_addr.s_addr;
+  ip.check = IPChecksum(ip);
+  if (hdrincl) {
+    memcpy(packet.data(), &ip, sizeof(ip));
+  }
+  std::vector<char> buf(kMaxPacket);
+
+  uint16_t seq = 0;
+  for (auto _ : state) {
+    icmp.un.echo.sequence = htons(++seq);
+    icmp.checksum = 0;
+    icmp.checksum = ICMPChecksum(icmp, payload, size);
+    memcpy(packet.data() + ip_len, &icmp, sizeof(icmp));
+    TEST_PCHECK(sendto(sender.get(), packet.data(), packet.size(), 0,
+                       reinterpret_cast<const sockaddr*>(&addr),
+                       sizeof(addr)) == static_cast<ssize_t>(packet.size()));
+
+    // IPv4 raw sockets always receive the IP header.
+    while (true) {
+      const ssize_t n = recv(receiver.get(), buf.data(), buf.size(), 0);
+      TEST_PCHECK(n >= 0);
+      const iphdr* const got_ip = reinterpret_cast<const iphdr*>(buf.data());
+      const size_t off = got_ip->ihl * 4;
+      if (static_cast<size_t>(n) < off + sizeof(icmphdr)) {
+        continue;
+      }
+      const icmphdr* const got =
+          reinterpret_cast<const icmphdr*>(buf.data() + off);
+      if (got->type == icmp.type && got->un.echo.id == icmp.un.echo.id &&
+          got->un.echo.sequence == icmp.un.echo.sequence) {
+        TEST_CHECK(n == static_cast<ssize_t>(off + sizeof(icmphdr) + size));
+        break;
+      }
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          (sizeof(icmphdr) + size));
+}
+
+BENCHMARK(BM_RawICMP)
+    ->ArgsProduct({{56, 1400}, {0, 1}})
+    ->ArgNames({"size", "hdrincl"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,198 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure inotify as used by file watchers, which watch
+// every directory of a source tree and are flooded with events when a build
+// writes many files at once.
+
+// WatchedDirs is a set of empty directories, shared by all benchmarks that
+// want the same number of them since creating many directories is slow.
+struct WatchedDirs {
+  TempPath root;
+  std::vector<std::string> dirs;
+};
+
+const WatchedDirs& GetWatchedDirs(int n) {
+  static std::map<int, WatchedDirs*> cache;
+  WatchedDirs*& d = cache[n];
+  if (d == nullptr) {
+    d = new WatchedDirs{TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateDir())};
+    for (int i = 0; i < n; i++) {
+      d->dirs.push_back(JoinPath(d->root.path(), absl::StrCat(i)));
+      TEST_PCHECK(mkdir(d->dirs.back().c_str(), 0755) == 0);
+    }
+  }
+  return *d;
+}
+
+// Watch returns an inotify instance watching every directory in dirs for
+// files being created and deleted, or an error if the watch limit is hit.
+PosixErrorOr<FileDescriptor> Watch(const WatchedDirs& dirs, int flags) {
+  const int ifd = inotify_init1(flags);
+  if (ifd < 0) {
+    return PosixError(errno, "inotify_init1");
+  }
+  FileDescriptor fd(ifd);
+  for (const std::string& dir : dirs.dirs) {
+    if (inotify_add_watch(fd.get(), dir.c_str(), IN_CREATE | IN_DELETE) < 0) {
+      return PosixError(errno, absl::StrCat("inotify_add_watch ", dir));
+    }
+  }
+  return fd;
+}
+
+// Drain reads all queued events from the non-blocking inotify fd, and returns
+// the number of events, counting queue overflows in *overflows.
+int64_t Drain(int fd, int64_t* overflows) {
+  // Big enough for many events with short names at once.
+  char buf[64 << 10];
+  int64_t events = 0;
+  while (true) {
+    const ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0) {
+      TEST_PCHECK(errno == EAGAIN);
+      return events;
+    }
+    for (ssize_t off = 0; off < n;) {
+      const struct inotify_event* ev =
+          reinterpret_cast<const struct inotify_event*>(buf + off);
+      if (ev->mask & IN_Q_OVERFLOW) {
+        (*overflows)++;
+      }
+      events++;
+      off += sizeof(*ev) + ev->len;
+    }
+  }
+}
+
+// BM_InotifyStorm creates and deletes files spread over every watched
+// directory, reading events after each batch. Batches larger than
+// /proc/sys/fs/inotify/max_queued_events overflow the queue, which shows up
+// in the "overflows" counter; events are then lost, so items_per_second is
+// counted in events read.
+void BM_InotifyStorm(benchmark::State& state) {
+  const int watches = state.range(0);
+  const int batch = state.range(1);
+  const WatchedDirs& dirs = GetWatchedDirs(watches);
+  PosixErrorOr<FileDescriptor> fd = Watch(dirs, IN_NONBLOCK);
+  if (!fd.ok()) {
+    state.SkipWithError(absl::StrCat("failed to add ", watches,
+                                     " watches: ", fd.error().ToString())
+                            .c_str());
+    return;
+  }
+
+  int64_t events = 0;
+  int64_t overflows = 0;
+  int next = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < batch; i++) {
+      const std::string path =
+          JoinPath(dirs.dirs[next++ % watches], absl::StrCat("f", i));
+      const int file = open(path.c_str(), O_CREAT | O_WRONLY, 0644);
+      TEST_PCHECK(file >= 0);
+      TEST_PCHECK(close(file) == 0);
+      TEST_PCHECK(unlink(path.c_str()) == 0);
+    }
+    events += Drain(fd.ValueOrDie().get(), &overflows);
+  }
+
+  state.SetItemsProcessed(events);
+  state.counters["overflows"] = overflows;
+  state.counters["files"] =
+      benchmark::Counter(state.iterations() * batch,
+                         benchmark::Counter::kIsRate);
+}
+
+void StormArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"watches", "batch"});
+  for (int watches : {1, 100, 10000}) {
+    // The default max_queued_events is 16384, and each file generates two
+    // events.
+    for (int batch : {100, 20000}) {
+      bench->Args({watches, batch});
+    }
+  }
+}
+
+BENCHMARK(BM_InotifyStorm)->Apply(StormArgs)->UseRealTime();
+
+// BM_InotifyLatency measures the time from creating a file until a blocking
+// read of the inotify fd returns its event.
+void BM_InotifyLatency(benchmark::State& state) {
+  const int watches = state.range(0);
+  const WatchedDirs& dirs = GetWatchedDirs(watches);
+  PosixErrorOr<FileDescriptor> fd = Watch(dirs, 0);
+  if (!fd.ok()) {
+    state.SkipWithError(absl::StrCat("failed to add ", watches,
+                                     " watches: ", fd.error().ToString())
+                            .c_str());
+    return;
+  }
+
+  // Use the last directory, in case the sentry walks watches in order.
+  const std::string path = JoinPath(dirs.dirs.back(), "f");
+  char buf[sizeof(struct inotify_event) + NAME_MAX + 1];
+  for (auto _ : state) {
+    const int file = open(path.c_str(), O_CREAT | O_WRONLY, 0644);
+    TEST_PCHECK(file >= 0);
+    TEST_PCHECK(read(fd.ValueOrDie().get(), buf, sizeof(buf)) > 0);
+
+    // Don't time the deletion and its event.
+    state.PauseTiming();
+    TEST_PCHECK(close(file) == 0);
+    TEST_PCHECK(unlink(path.c_str()) == 0);
+    TEST_PCHECK(read(fd.ValueOrDie().get(), buf, sizeof(buf)) > 0);
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK(BM_InotifyLatency)
+    ->ArgName("watches")
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(10000)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,201 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/io_uring_util.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// Submission queue depths swept by the batch benchmarks.
+constexpr int kMinBatch = 1;
+constexpr int kMaxBatch = 64;
+
+// kMaxSpins bounds how long the SQPOLL benchmark polls the completion queue
+// before blocking in io_uring_enter(2).
+constexpr int kMaxSpins = 1 << 10;
+
+// CreateRing returns a ring with the given number of entries and setup flags,
+// or reports the failure through state and returns nullptr if io_uring (or
+// the requested flags) is unavailable.
+std::unique_ptr<IOUringRing> CreateRing(benchmark::State& state,
+                                        unsigned int entries,
+                                        uint32_t flags = 0) {
+  auto ring_or = IOUringRing::Create(entries, flags);
+  if (!ring_or.ok()) {
+    state.SkipWithError(ring_or.error().ToString().c_str());
+    return nullptr;
+  }
+  return std::move(ring_or.ValueOrDie());
+}
+
+// CheckCqes returns false and reports the failure through state if any of the
+// completions failed.
+bool CheckCqes(benchmark::State& state, const std::vector<IOUringCqe>& cqes) {
+  for (const IOUringCqe& cqe : cqes) {
+    if (cqe.res < 0) {
+      state.SkipWithError(
+          absl::StrCat("io_uring completion failed: ", strerror(-cqe.res))
+              .c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void BM_IOUringNop(benchmark::State& state) {
+  const int batch = state.range(0);
+
+  std::unique_ptr<IOUringRing> ring = CreateRing(state, batch);
+  if (!ring) {
+    return;
+  }
+
+  std::vector<IOUringCqe> cqes(batch);
+  for (auto _ : state) {
+    for (int i = 0; i < batch; i++) {
+      TEST_CHECK(ring->PrepareNop(i) != nullptr);
+    }
+    TEST_CHECK(TEST_CHECK_NO_ERRNO_AND_VALUE(ring->SubmitAndWait(batch)) ==
+               batch);
+    TEST_CHECK(ring->Reap(cqes.data(), batch) == batch);
+    if (!CheckCqes(state, cqes)) {
+      return;
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(batch) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_IOUringNop)->RangeMultiplier(2)->Range(kMinBatch, kMaxBatch);
+
+// BM_IOUringNopSQPoll is BM_IOUringNop with a kernel thread polling the
+// submission queue, so the steady state requires no io_uring_enter(2) calls.
+void BM_IOUringNopSQPoll(benchmark::State& state) {
+  const int batch = state.range(0);
+
+  std::unique_ptr<IOUringRing> ring =
+      CreateRing(state, batch, IORING_SETUP_SQPOLL);
+  if (!ring) {
+    return;
+  }
+
+  std::vector<IOUringCqe> cqes(batch);
+  for (auto _ : state) {
+    for (int i = 0; i < batch; i++) {
+      TEST_CHECK(ring->PrepareNop(i) != nullptr);
+    }
+    TEST_CHECK(TEST_CHECK_NO_ERRNO_AND_VALUE(ring->Submit()) == batch);
+
+    int reaped = 0;
+    for (int spins = 0; reaped < batch && spins < kMaxSpins; spins++) {
+      reaped += ring->Reap(cqes.data() + reaped, batch - reaped);
+    }
+    TEST_CHECK_NO_ERRNO(
+        ring->WaitAndReap(cqes.data() + reaped, batch - reaped));
+    if (!CheckCqes(state, cqes)) {
+      return;
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(batch) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_IOUringNopSQPoll)
+    ->RangeMultiplier(2)
+    ->Range(kMinBatch, kMaxBatch)
+    ->UseRealTime();
+
+// RW runs batches of size-byte READV or WRITEV operations against a
+// temporary file. Each SQE in the batch uses its own buffer and file offset.
+void RW(benchmark::State& state, bool write) {
+  const int size = state.range(0);
+  const int batch = state.range(1);
+
+  const std::string contents(static_cast<size_t>(size) * batch, 0);
+  auto path = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFileWith(
+      GetAbsoluteTestTmpdir(), contents, TempPath::kDefaultFileMode));
+  FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+
+  std::unique_ptr<IOUringRing> ring = CreateRing(state, batch);
+  if (!ring) {
+    return;
+  }
+
+  std::vector<char> buf(contents.size());
+  std::vector<struct iovec> iovs(batch);
+  for (int i = 0; i < batch; i++) {
+    iovs[i].iov_base = buf.data() + static_cast<size_t>(i) * size;
+    iovs[i].iov_len = size;
+  }
+
+  std::vector<IOUringCqe> cqes(batch);
+  for (auto _ : state) {
+    for (int i = 0; i < batch; i++) {
+      uint64_t off = static_cast<uint64_t>(i) * size;
+      IOUringSqe* sqe = write
+                            ? ring->PrepareWrite(fd.get(), &iovs[i], 1, off, i)
+                            : ring->PrepareRead(fd.get(), &iovs[i], 1, off, i);
+      TEST_CHECK(sqe != nullptr);
+    }
+    TEST_CHECK(TEST_CHECK_NO_ERRNO_AND_VALUE(ring->SubmitAndWait(batch)) ==
+               batch);
+    TEST_CHECK(ring->Reap(cqes.data(), batch) == batch);
+    if (!CheckCqes(state, cqes)) {
+      return;
+    }
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(contents.size()) *
+                          static_cast<int64_t>(state.iterations()));
+  state.SetItemsProcessed(static_cast<int64_t>(batch) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+void BM_IOUringReadv(benchmark::State& state) { RW(state, false); }
+
+BENCHMARK(BM_IOUringReadv)
+    ->Ranges({{1, 1 << 20}, {kMinBatch, kMaxBatch}})
+    ->UseRealTime();
+
+void BM_IOUringWritev(benchmark::State& state) { RW(state, true); }
+
+BENCHMARK(BM_IOUringWritev)
+    ->Ranges({{1, 1 << 20}, {kMinBatch, kMaxBatch}})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
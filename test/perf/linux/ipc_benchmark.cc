@@ -0,0 +1,260 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <mqueue.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/sem.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the POSIX message queue and SysV message queue and
+// semaphore IPC used by legacy applications: round trips between two
+// processes, and semaphore contention between many.
+
+// WaitForChild waits for pid to exit successfully.
+void WaitForChild(pid_t pid) {
+  int status;
+  TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+  TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+// BM_MqPingPong bounces a message between two processes through a pair of
+// POSIX message queues. Each iteration is one round trip.
+void BM_MqPingPong(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const std::string ping_name = absl::StrCat("/ipc_benchmark_ping_", getpid());
+  const std::string pong_name = absl::StrCat("/ipc_benchmark_pong_", getpid());
+  struct mq_attr attr = {};
+  attr.mq_maxmsg = 1;
+  attr.mq_msgsize = size;
+  const mqd_t ping =
+      mq_open(ping_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600, &attr);
+  TEST_PCHECK(ping != static_cast<mqd_t>(-1));
+  const mqd_t pong =
+      mq_open(pong_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600, &attr);
+  TEST_PCHECK(pong != static_cast<mqd_t>(-1));
+  TEST_PCHECK(mq_unlink(ping_name.c_str()) == 0);
+  TEST_PCHECK(mq_unlink(pong_name.c_str()) == 0);
+
+  std::vector<char> buf(size);
+  const pid_t pid = fork();
+  TEST_PCHECK(pid >= 0);
+  if (pid == 0) {
+    // An empty message means stop.
+    while (true) {
+      const ssize_t n = mq_receive(ping, buf.data(), size, nullptr);
+      TEST_PCHECK(n >= 0);
+      if (n == 0) {
+        _exit(0);
+      }
+      TEST_PCHECK(mq_send(pong, buf.data(), n, 0) == 0);
+    }
+  }
+
+  for (auto _ : state) {
+    TEST_PCHECK(mq_send(ping, buf.data(), size, 0) == 0);
+    TEST_PCHECK(mq_receive(pong, buf.data(), size, nullptr) ==
+                static_cast<ssize_t>(size));
+  }
+
+  TEST_PCHECK(mq_send(ping, buf.data(), 0, 0) == 0);
+  WaitForChild(pid);
+  TEST_PCHECK(mq_close(ping) == 0);
+  TEST_PCHECK(mq_close(pong) == 0);
+
+  state.SetBytesProcessed(state.iterations() * size * 2);
+}
+
+// The default /proc/sys/fs/mqueue/msgsize_max is 8192.
+BENCHMARK(BM_MqPingPong)->Range(16, 8192)->UseRealTime();
+
+// SysV message types used by the ping-pong benchmark.
+constexpr long kPing = 1;
+constexpr long kPong = 2;
+constexpr long kStop = 3;
+
+// Message is a SysV message with up to kMaxMsgSize bytes of text.
+constexpr size_t kMaxMsgSize = 8192;
+struct Message {
+  long mtype;
+  char mtext[kMaxMsgSize];
+};
+
+// ScopedMsgQueue is a private SysV message queue, removed on destruction.
+class ScopedMsgQueue {
+ public:
+  ScopedMsgQueue() {
+    id_ = msgget(IPC_PRIVATE, 0600);
+    TEST_PCHECK(id_ >= 0);
+  }
+  ~ScopedMsgQueue() { TEST_PCHECK(msgctl(id_, IPC_RMID, nullptr) == 0); }
+  int get() const { return id_; }
+
+ private:
+  int id_;
+};
+
+// BM_MsgPingPong bounces a message between two processes through a SysV
+// message queue, using the message type to tell the directions apart. Each
+// iteration is one round trip.
+void BM_MsgPingPong(benchmark::State& state) {
+  const size_t size = state.range(0);
+  ScopedMsgQueue q;
+  Message msg = {};
+
+  const pid_t pid = fork();
+  TEST_PCHECK(pid >= 0);
+  if (pid == 0) {
+    while (true) {
+      // Take a kPing or kStop, but not a kPong that the parent hasn't
+      // received yet.
+      const ssize_t n = RetryEINTR(msgrcv)(q.get(), &msg, kMaxMsgSize, kPong,
+                                           MSG_EXCEPT);
+      TEST_PCHECK(n >= 0);
+      if (msg.mtype == kStop) {
+        _exit(0);
+      }
+      msg.mtype = kPong;
+      TEST_PCHECK(RetryEINTR(msgsnd)(q.get(), &msg, n, 0) == 0);
+    }
+  }
+
+  for (auto _ : state) {
+    msg.mtype = kPing;
+    TEST_PCHECK(RetryEINTR(msgsnd)(q.get(), &msg, size, 0) == 0);
+    TEST_PCHECK(RetryEINTR(msgrcv)(q.get(), &msg, kMaxMsgSize, kPong, 0) ==
+                static_cast<ssize_t>(size));
+  }
+
+  msg.mtype = kStop;
+  TEST_PCHECK(RetryEINTR(msgsnd)(q.get(), &msg, 0, 0) == 0);
+  WaitForChild(pid);
+
+  state.SetBytesProcessed(state.iterations() * size * 2);
+}
+
+// The default /proc/sys/kernel/msgmax is 8192.
+BENCHMARK(BM_MsgPingPong)->Range(16, kMaxMsgSize)->UseRealTime();
+
+// BM_MsgSendRecv sends a message to a SysV message queue and receives it
+// without another process involved, which measures the queue itself.
+void BM_MsgSendRecv(benchmark::State& state) {
+  const size_t size = state.range(0);
+  ScopedMsgQueue q;
+  Message msg = {};
+  msg.mtype = kPing;
+
+  for (auto _ : state) {
+    TEST_PCHECK(msgsnd(q.get(), &msg, size, 0) == 0);
+    TEST_PCHECK(msgrcv(q.get(), &msg, kMaxMsgSize, 0, 0) ==
+                static_cast<ssize_t>(size));
+  }
+
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_MsgSendRecv)->Range(16, kMaxMsgSize);
+
+// Number of times each process takes and releases the semaphore per
+// benchmark iteration.
+constexpr int kSemopsPerIteration = 100;
+
+// BM_SemopContention has processes take and release a SysV semaphore used
+// as a mutex, each acquisition waiting for the others to release it.
+void BM_SemopContention(benchmark::State& state) {
+  const int procs = state.range(0);
+  const int sem = semget(IPC_PRIVATE, 1, 0600);
+  TEST_PCHECK(sem >= 0);
+  TEST_PCHECK(semctl(sem, 0, SETVAL, 1) == 0);
+
+  // Each byte written to go is read by one of the processes, which then takes
+  // and releases the semaphore kSemopsPerIteration times and writes a byte to
+  // done.
+  int fds[2];
+  TEST_PCHECK(pipe(fds) == 0);
+  FileDescriptor go_read(fds[0]);
+  FileDescriptor go_write(fds[1]);
+  TEST_PCHECK(pipe(fds) == 0);
+  FileDescriptor done_read(fds[0]);
+  FileDescriptor done_write(fds[1]);
+  std::vector<pid_t> pids;
+  for (int i = 0; i < procs; i++) {
+    const pid_t pid = fork();
+    TEST_PCHECK(pid >= 0);
+    if (pid == 0) {
+      go_write.reset();
+      struct sembuf take = {0, -1, 0};
+      struct sembuf release = {0, 1, 0};
+      char c;
+      while (ReadFd(go_read.get(), &c, 1) == 1) {
+        for (int j = 0; j < kSemopsPerIteration; j++) {
+          TEST_PCHECK(RetryEINTR(semop)(sem, &take, 1) == 0);
+          TEST_PCHECK(RetryEINTR(semop)(sem, &release, 1) == 0);
+        }
+        TEST_PCHECK(WriteFd(done_write.get(), &c, 1) == 1);
+      }
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+  go_read.reset();
+  done_write.reset();
+
+  const std::vector<char> go(procs);
+  std::vector<char> done(procs);
+  for (auto _ : state) {
+    TEST_PCHECK(WriteFd(go_write.get(), go.data(), procs) == procs);
+    for (int n = 0; n < procs;) {
+      const ssize_t r = ReadFd(done_read.get(), done.data(), procs - n);
+      TEST_PCHECK(r > 0);
+      n += r;
+    }
+  }
+
+  // Closing go makes the processes exit.
+  go_write.reset();
+  for (pid_t pid : pids) {
+    WaitForChild(pid);
+  }
+  TEST_PCHECK(semctl(sem, 0, IPC_RMID) == 0);
+
+  // Each acquisition and release is counted as one item.
+  state.SetItemsProcessed(state.iterations() * procs * kSemopsPerIteration *
+                          2);
+}
+
+BENCHMARK(BM_SemopContention)->Range(1, 64)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
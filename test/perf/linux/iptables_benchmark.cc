@@ -0,0 +1,366 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <linux/capability.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/iptables.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/linux_capability_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure how loopback TCP and UDP performance degrades with
+// the number of iptables rules every packet is evaluated against, as on a
+// node where kube-proxy installs rules per service.
+//
+// The rules are inserted at the head of the OUTPUT chain, which all loopback
+// traffic traverses. Each matches a distinct destination address that the
+// benchmarks never use, so every packet is checked against every rule before
+// reaching the chain's original rules.
+
+constexpr size_t kStandardEntrySize =
+    sizeof(struct ipt_entry) + sizeof(struct ipt_standard_target);
+
+const char* const kTables[] = {"filter", "nat"};
+
+// ScopedRules inserts rules into a table and restores the original table on
+// destruction.
+class ScopedRules {
+ public:
+  // Inserts count non-matching rules at the head of table's OUTPUT chain.
+  static PosixErrorOr<std::unique_ptr<ScopedRules>> Create(const char* table,
+                                                          int count) {
+    int s = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (s < 0) {
+      return PosixError(errno, "socket(SOCK_RAW)");
+    }
+    std::unique_ptr<ScopedRules> rules(new ScopedRules(FileDescriptor(s)));
+
+    snprintf(rules->info_.name, XT_TABLE_MAXNAMELEN, "%s", table);
+    socklen_t info_size = sizeof(rules->info_);
+    RETURN_ERROR_IF_SYSCALL_FAIL(getsockopt(s, SOL_IP, IPT_SO_GET_INFO,
+                                            &rules->info_, &info_size));
+    const struct ipt_getinfo& info = rules->info_;
+
+    socklen_t entries_size = sizeof(struct ipt_get_entries) + info.size;
+    rules->orig_.resize(entries_size);
+    struct ipt_get_entries* orig =
+        reinterpret_cast<struct ipt_get_entries*>(rules->orig_.data());
+    snprintf(orig->name, XT_TABLE_MAXNAMELEN, "%s", table);
+    orig->size = info.size;
+    RETURN_ERROR_IF_SYSCALL_FAIL(
+        getsockopt(s, SOL_IP, IPT_SO_GET_ENTRIES, orig, &entries_size));
+
+    // Place the new rules at the start of the OUTPUT chain. Chains after it
+    // move back by the size of the new rules.
+    const unsigned int at = info.hook_entry[NF_IP_LOCAL_OUT];
+    const size_t shift = count * kStandardEntrySize;
+    std::vector<char> buf(sizeof(struct ipt_replace) + info.size + shift);
+    struct ipt_replace* repl =
+        reinterpret_cast<struct ipt_replace*>(buf.data());
+    snprintf(repl->name, sizeof(repl->name), "%s", table);
+    repl->valid_hooks = info.valid_hooks;
+    repl->num_entries = info.num_entries + count;
+    repl->size = info.size + shift;
+    for (int h = 0; h < NF_IP_NUMHOOKS; h++) {
+      if (info.valid_hooks & (1 << h)) {
+        repl->hook_entry[h] =
+            info.hook_entry[h] + (info.hook_entry[h] > at ? shift : 0);
+        repl->underflow[h] =
+            info.underflow[h] + (info.underflow[h] >= at ? shift : 0);
+      }
+    }
+    std::vector<struct xt_counters> counters(info.num_entries);
+    repl->num_counters = info.num_entries;
+    repl->counters = counters.data();
+
+    char* dst = reinterpret_cast<char*>(repl->entries);
+    const char* src = reinterpret_cast<const char*>(orig->entrytable);
+    memcpy(dst, src, at);
+    for (int i = 0; i < count; i++) {
+      struct ipt_entry* e = reinterpret_cast<struct ipt_entry*>(
+          dst + at + i * kStandardEntrySize);
+      // 10.99.0.0/16, never used by the benchmarks.
+      e->ip.dst.s_addr = htonl(0x0a630000 + i);
+      e->ip.dmsk.s_addr = htonl(0xffffffff);
+      e->target_offset = sizeof(struct ipt_entry);
+      e->next_offset = kStandardEntrySize;
+      struct ipt_standard_target* t =
+          reinterpret_cast<struct ipt_standard_target*>(e->elems);
+      t->target.u.user.target_size = sizeof(*t);
+      t->verdict = -NF_ACCEPT - 1;
+    }
+    memcpy(dst + at + shift, src + at, info.size - at);
+
+    RETURN_ERROR_IF_SYSCALL_FAIL(
+        setsockopt(s, SOL_IP, IPT_SO_SET_REPLACE, buf.data(), buf.size()));
+    rules->count_ = count;
+    return rules;
+  }
+
+  ~ScopedRules() {
+    if (count_ < 0) {
+      return;
+    }
+    const struct ipt_getinfo& info = info_;
+    const struct ipt_get_entries* orig =
+        reinterpret_cast<const struct ipt_get_entries*>(orig_.data());
+    std::vector<char> buf(sizeof(struct ipt_replace) + info.size);
+    struct ipt_replace* repl =
+        reinterpret_cast<struct ipt_replace*>(buf.data());
+    snprintf(repl->name, sizeof(repl->name), "%s", info.name);
+    repl->valid_hooks = info.valid_hooks;
+    repl->num_entries = info.num_entries;
+    repl->size = info.size;
+    memcpy(repl->hook_entry, info.hook_entry, sizeof(info.hook_entry));
+    memcpy(repl->underflow, info.underflow, sizeof(info.underflow));
+    std::vector<struct xt_counters> counters(info.num_entries + count_);
+    repl->num_counters = info.num_entries + count_;
+    repl->counters = counters.data();
+    memcpy(repl->entries, orig->entrytable, info.size);
+    TEST_PCHECK(setsockopt(s_.get(), SOL_IP, IPT_SO_SET_REPLACE, buf.data(),
+                           buf.size()) == 0);
+  }
+
+ private:
+  explicit ScopedRules(FileDescriptor s) : s_(std::move(s)) {}
+
+  FileDescriptor s_;
+  struct ipt_getinfo info_ = {};
+  std::vector<char> orig_;
+  int count_ = -1;
+};
+
+// SetUp installs the benchmark's rules, or skips the benchmark and returns
+// nullptr if that is not possible.
+std::unique_ptr<ScopedRules> SetUp(benchmark::State& state) {
+  const char* table = kTables[state.range(0)];
+  const int count = state.range(1);
+  state.SetLabel(table);
+  if (!TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_NET_ADMIN)) ||
+      !TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_NET_RAW))) {
+    state.SkipWithError("CAP_NET_ADMIN and CAP_NET_RAW required");
+    return nullptr;
+  }
+  auto rules = ScopedRules::Create(table, count);
+  if (!rules.ok()) {
+    // gVisor limits the size of the ruleset that can be set at once.
+    state.SkipWithError(rules.error().ToString().c_str());
+    return nullptr;
+  }
+  return std::move(rules).ValueOrDie();
+}
+
+// ReadFull reads exactly n bytes from fd. It returns false on EOF.
+bool ReadFull(int fd, char* buf, size_t n) {
+  while (n > 0) {
+    int ret = RetryEINTR(read)(fd, buf, n);
+    TEST_PCHECK(ret >= 0);
+    if (ret == 0) {
+      return false;
+    }
+    buf += ret;
+    n -= ret;
+  }
+  return true;
+}
+
+// WriteFull writes exactly n bytes to fd.
+void WriteFull(int fd, const char* buf, size_t n) {
+  while (n > 0) {
+    int ret = RetryEINTR(write)(fd, buf, n);
+    TEST_PCHECK(ret > 0);
+    buf += ret;
+    n -= ret;
+  }
+}
+
+void Args(benchmark::internal::Benchmark* bm) {
+  bm->ArgsProduct({{0, 1}, {0, 100, 1000, 10000}})
+      ->ArgNames({"table", "rules"})
+      ->UseRealTime();
+}
+
+// BM_IPTablesTCPRR measures the round trip of a one-byte request echoed back
+// over an established TCP connection.
+void BM_IPTablesTCPRR(benchmark::State& state) {
+  std::unique_ptr<ScopedRules> rules = SetUp(state);
+  if (rules == nullptr) {
+    return;
+  }
+  auto pair = TEST_CHECK_NO_ERRNO_AND_VALUE(TCPAcceptBindSocketPairCreator(
+      AF_INET, SOCK_STREAM, 0, /*dual_stack=*/false)());
+  const int client = pair->first_fd();
+  const int server = pair->second_fd();
+  TEST_PCHECK(setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &kSockOptOn,
+                         sizeof(kSockOptOn)) == 0);
+  TEST_PCHECK(setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &kSockOptOn,
+                         sizeof(kSockOptOn)) == 0);
+
+  ScopedThread echo([server] {
+    char c;
+    while (ReadFull(server, &c, 1)) {
+      WriteFull(server, &c, 1);
+    }
+  });
+
+  {
+    LatencyRecorder latency(
+        state, absl::StrCat("BM_IPTablesTCPRR/", kTables[state.range(0)], "/",
+                            state.range(1)));
+    char c = 0;
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      WriteFull(client, &c, 1);
+      TEST_CHECK(ReadFull(client, &c, 1));
+    }
+  }
+
+  TEST_PCHECK(shutdown(client, SHUT_WR) == 0);
+  echo.Join();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_IPTablesTCPRR)->Apply(Args);
+
+// BM_IPTablesTCPConnect measures connecting and closing a TCP connection.
+// NAT rules are only evaluated for the first packet of a connection, so this
+// is where the nat table's cost shows.
+void BM_IPTablesTCPConnect(benchmark::State& state) {
+  std::unique_ptr<ScopedRules> rules = SetUp(state);
+  if (rules == nullptr) {
+    return;
+  }
+  const Creator<SocketPair> creator =
+      TCPAcceptBindPersistentListenerSocketPairCreator(AF_INET, SOCK_STREAM, 0,
+                                                       /*dual_stack=*/false);
+
+  for (auto _ : state) {
+    auto pair = TEST_CHECK_NO_ERRNO_AND_VALUE(creator());
+    // Close with an RST so that no TIME-WAIT state exhausts the ephemeral
+    // ports.
+    struct linger l = {};
+    l.l_onoff = 1;
+    TEST_PCHECK(setsockopt(pair->first_fd(), SOL_SOCKET, SO_LINGER, &l,
+                           sizeof(l)) == 0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_IPTablesTCPConnect)->Apply(Args);
+
+// BM_IPTablesTCPStream measures bulk TCP throughput to a draining thread.
+void BM_IPTablesTCPStream(benchmark::State& state) {
+  std::unique_ptr<ScopedRules> rules = SetUp(state);
+  if (rules == nullptr) {
+    return;
+  }
+  auto pair = TEST_CHECK_NO_ERRNO_AND_VALUE(TCPAcceptBindSocketPairCreator(
+      AF_INET, SOCK_STREAM, 0, /*dual_stack=*/false)());
+  const int client = pair->first_fd();
+  const int server = pair->second_fd();
+
+  ScopedThread drain([server] {
+    std::vector<char> buf(1 << 20);
+    while (RetryEINTR(read)(server, buf.data(), buf.size()) > 0) {
+    }
+  });
+
+  constexpr size_t kSize = 64 << 10;
+  std::vector<char> buf(kSize);
+  for (auto _ : state) {
+    WriteFull(client, buf.data(), kSize);
+  }
+
+  TEST_PCHECK(shutdown(client, SHUT_WR) == 0);
+  drain.Join();
+  state.SetBytesProcessed(state.iterations() * kSize);
+}
+
+BENCHMARK(BM_IPTablesTCPStream)->Apply(Args);
+
+// BM_IPTablesUDPRR measures the round trip of a small datagram echoed back.
+void BM_IPTablesUDPRR(benchmark::State& state) {
+  std::unique_ptr<ScopedRules> rules = SetUp(state);
+  if (rules == nullptr) {
+    return;
+  }
+  auto pair = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      UDPBidirectionalBindSocketPairCreator(AF_INET, SOCK_DGRAM, 0,
+                                            /*dual_stack=*/false)());
+  const int client = pair->first_fd();
+  const int server = pair->second_fd();
+
+  // A zero-length datagram tells the echo thread to stop.
+  ScopedThread echo([server] {
+    char buf[64];
+    while (true) {
+      int n = RetryEINTR(recv)(server, buf, sizeof(buf), 0);
+      TEST_PCHECK(n >= 0);
+      if (n == 0) {
+        return;
+      }
+      TEST_PCHECK(RetryEINTR(send)(server, buf, n, 0) == n);
+    }
+  });
+
+  {
+    LatencyRecorder latency(
+        state, absl::StrCat("BM_IPTablesUDPRR/", kTables[state.range(0)], "/",
+                            state.range(1)));
+    char buf[64] = {};
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      TEST_PCHECK(RetryEINTR(send)(client, buf, sizeof(buf), 0) ==
+                  sizeof(buf));
+      TEST_PCHECK(RetryEINTR(recv)(client, buf, sizeof(buf), 0) ==
+                  sizeof(buf));
+    }
+  }
+
+  TEST_PCHECK(RetryEINTR(send)(client, nullptr, 0, 0) == 0);
+  echo.Join();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_IPTablesUDPRR)->Apply(Args);
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,116 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_Kcov measures the syscall rate of a fuzzer-like loop with kcov
+// coverage collection disabled, and enabled in KCOV_TRACE_PC mode with
+// coverage areas of different sizes. As syzkaller does, the area's count of
+// PCs is reset before each iteration, and the average number of PCs
+// collected per iteration is reported as pcs.
+//
+// Coverage is only collected by a sentry built with coverage
+// instrumentation, e.g. with bazel coverage; without it,
+// /sys/kernel/debug/kcov doesn't exist and the benchmark is skipped.
+
+constexpr char kKcovPath[] = "/sys/kernel/debug/kcov";
+constexpr unsigned long KCOV_INIT_TRACE = 0x80086301;
+constexpr unsigned long KCOV_ENABLE = 0x6364;
+constexpr unsigned long KCOV_DISABLE = 0x6365;
+constexpr unsigned long KCOV_TRACE_PC = 0;
+
+// Syscalls made per iteration: a one byte write to a pipe and a read from it,
+// which exercises the VFS and pipe code paths.
+constexpr int kSyscallsPerIteration = 2;
+
+void BM_Kcov(benchmark::State& state) {
+  // Size of the coverage area in PCs, or 0 to leave kcov disabled.
+  const int64_t size = state.range(0);
+
+  int fds[2];
+  TEST_PCHECK(pipe(fds) == 0);
+  const FileDescriptor rfd(fds[0]);
+  const FileDescriptor wfd(fds[1]);
+
+  FileDescriptor kcov;
+  uint64_t* area = nullptr;
+  if (size > 0) {
+    PosixErrorOr<FileDescriptor> fd = Open(kKcovPath, O_RDWR);
+    if (!fd.ok()) {
+      state.SkipWithError("kcov not available");
+      return;
+    }
+    kcov = std::move(fd).ValueOrDie();
+    TEST_PCHECK(ioctl(kcov.get(), KCOV_INIT_TRACE, size) == 0);
+    void* addr = mmap(nullptr, size * sizeof(uint64_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, kcov.get(), 0);
+    TEST_PCHECK(addr != MAP_FAILED);
+    area = static_cast<uint64_t*>(addr);
+    TEST_PCHECK(ioctl(kcov.get(), KCOV_ENABLE, KCOV_TRACE_PC) == 0);
+  }
+
+  int64_t pcs = 0;
+  char c = 'a';
+  for (auto _ : state) {
+    if (area != nullptr) {
+      __atomic_store_n(&area[0], 0, __ATOMIC_RELAXED);
+    }
+    TEST_PCHECK(WriteFd(wfd.get(), &c, 1) == 1);
+    TEST_PCHECK(ReadFd(rfd.get(), &c, 1) == 1);
+    if (area != nullptr) {
+      pcs += __atomic_load_n(&area[0], __ATOMIC_RELAXED);
+    }
+  }
+
+  if (area != nullptr) {
+    TEST_PCHECK(ioctl(kcov.get(), KCOV_DISABLE, 0) == 0);
+    TEST_PCHECK(munmap(area, size * sizeof(uint64_t)) == 0);
+  }
+
+  state.counters["pcs"] =
+      benchmark::Counter(pcs, benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * kSyscallsPerIteration);
+}
+
+BENCHMARK(BM_Kcov)
+    ->Arg(0)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->ArgName("size")
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,241 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure file lock contention, as generated by SQLite and
+// build tools: workers repeatedly take and release an exclusive lock on the
+// same file, and the time each acquisition waits is recorded.
+//
+// Each worker opens the file itself, so that flock and OFD locks held by
+// different workers conflict. POSIX record locks are owned by the process,
+// so they only conflict between workers that are separate processes.
+
+enum LockKind {
+  // flock(LOCK_EX) on the whole file.
+  kFlock,
+
+  // F_SETLKW on a byte range that no other worker locks, which never waits
+  // but still goes through the lock manager with other workers' locks held.
+  kPosixDisjoint,
+
+  // F_SETLKW on a byte range that overlaps the ranges of the previous and
+  // next workers.
+  kPosixOverlapping,
+
+  // F_OFD_SETLKW on the same byte range as every other worker.
+  kOFD,
+};
+
+// Length of the byte range locked by each worker for record locks.
+constexpr off_t kRangeLen = 4096;
+
+// Number of acquisitions made by each worker per benchmark iteration.
+constexpr int kLocksPerIteration = 100;
+
+void Lock(int fd, LockKind kind, int worker, bool lock) {
+  struct flock fl = {};
+  fl.l_type = lock ? F_WRLCK : F_UNLCK;
+  fl.l_whence = SEEK_SET;
+  switch (kind) {
+    case kFlock:
+      TEST_PCHECK(RetryEINTR(flock)(fd, lock ? LOCK_EX : LOCK_UN) == 0);
+      return;
+    case kPosixDisjoint:
+      fl.l_start = worker * kRangeLen;
+      fl.l_len = kRangeLen;
+      TEST_PCHECK(RetryEINTR(fcntl)(fd, F_SETLKW, &fl) == 0);
+      return;
+    case kPosixOverlapping:
+      // Ranges are two units long and start one unit apart.
+      fl.l_start = worker * kRangeLen;
+      fl.l_len = 2 * kRangeLen;
+      TEST_PCHECK(RetryEINTR(fcntl)(fd, F_SETLKW, &fl) == 0);
+      return;
+    case kOFD:
+      fl.l_start = 0;
+      fl.l_len = kRangeLen;
+      TEST_PCHECK(RetryEINTR(fcntl)(fd, F_OFD_SETLKW, &fl) == 0);
+      return;
+  }
+}
+
+// Result is sent by a worker after each iteration.
+struct Result {
+  // Total and longest time spent waiting to acquire the lock.
+  int64_t wait_ns;
+  int64_t max_wait_ns;
+};
+
+void WriteFull(int fd, const void* buf, size_t len) {
+  TEST_PCHECK(WriteFd(fd, buf, len) == static_cast<ssize_t>(len));
+}
+
+// WorkerLoop does kLocksPerIteration acquisitions each time a byte is read
+// from go, then writes a Result to done. It returns when go is closed.
+void WorkerLoop(const std::string& path, LockKind kind, int worker, int go,
+                int done) {
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path, O_RDWR));
+  char c;
+  while (ReadFd(go, &c, 1) == 1) {
+    Result r = {};
+    for (int i = 0; i < kLocksPerIteration; i++) {
+      const absl::Time start = absl::Now();
+      Lock(fd.get(), kind, worker, true);
+      const int64_t wait = absl::ToInt64Nanoseconds(absl::Now() - start);
+      r.wait_ns += wait;
+      r.max_wait_ns = std::max(r.max_wait_ns, wait);
+      Lock(fd.get(), kind, worker, false);
+    }
+    WriteFull(done, &r, sizeof(r));
+  }
+}
+
+// Workers runs WorkerLoop in threads of this process or in child processes.
+class Workers {
+ public:
+  Workers(const std::string& path, LockKind kind, int n, bool processes) {
+    int fds[2];
+    TEST_PCHECK(pipe(fds) == 0);
+    done_read_ = FileDescriptor(fds[0]);
+    done_write_ = FileDescriptor(fds[1]);
+    for (int i = 0; i < n; i++) {
+      TEST_PCHECK(pipe(fds) == 0);
+      const int go = fds[0];
+      go_.emplace_back(fds[1]);
+      const int done = done_write_.get();
+      if (processes) {
+        pid_t pid = fork();
+        TEST_PCHECK(pid >= 0);
+        if (pid == 0) {
+          // Don't keep the write ends of the go pipes open, or closing them
+          // in the parent wouldn't stop workers.
+          go_.clear();
+          WorkerLoop(path, kind, i, go, done);
+          _exit(0);
+        }
+        TEST_PCHECK(close(go) == 0);
+        pids_.push_back(pid);
+      } else {
+        threads_.push_back(std::make_unique<ScopedThread>([=] {
+          WorkerLoop(path, kind, i, go, done);
+          TEST_PCHECK(close(go) == 0);
+        }));
+      }
+    }
+  }
+
+  ~Workers() {
+    // Closing the go pipes makes workers return.
+    go_.clear();
+    threads_.clear();
+    for (pid_t pid : pids_) {
+      int status;
+      TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+      TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+  }
+
+  // Run has every worker do one iteration, and returns their combined
+  // Result once all are done.
+  Result Run() {
+    char c = 0;
+    for (const FileDescriptor& go : go_) {
+      WriteFull(go.get(), &c, 1);
+    }
+    Result total = {};
+    for (size_t i = 0; i < go_.size(); i++) {
+      Result r;
+      TEST_CHECK(ReadFd(done_read_.get(), &r, sizeof(r)) == sizeof(r));
+      total.wait_ns += r.wait_ns;
+      total.max_wait_ns = std::max(total.max_wait_ns, r.max_wait_ns);
+    }
+    return total;
+  }
+
+ private:
+  // Write ends of the pipes each worker reads from.
+  std::vector<FileDescriptor> go_;
+  // All workers write to the same pipe when done.
+  FileDescriptor done_read_;
+  FileDescriptor done_write_;
+  std::vector<std::unique_ptr<ScopedThread>> threads_;
+  std::vector<pid_t> pids_;
+};
+
+void BM_LockContention(benchmark::State& state) {
+  const LockKind kind = static_cast<LockKind>(state.range(0));
+  const int workers = state.range(1);
+  const bool processes = state.range(2);
+  const TempPath file = TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+
+  Workers w(file.path(), kind, workers, processes);
+  int64_t wait_ns = 0;
+  int64_t max_wait_ns = 0;
+  for (auto _ : state) {
+    const Result r = w.Run();
+    wait_ns += r.wait_ns;
+    max_wait_ns = std::max(max_wait_ns, r.max_wait_ns);
+  }
+
+  const int64_t locks = state.iterations() * workers * kLocksPerIteration;
+  state.SetItemsProcessed(locks);
+  state.counters["mean_wait_ns"] = static_cast<double>(wait_ns) / locks;
+  state.counters["max_wait_ns"] = max_wait_ns;
+}
+
+void ContentionArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"kind", "workers", "processes"});
+  for (int workers : {1, 2, 4, 8, 16}) {
+    for (LockKind kind : {kFlock, kOFD}) {
+      bench->Args({kind, workers, 0});
+      bench->Args({kind, workers, 1});
+    }
+    // Record locks held by threads of one process never conflict.
+    bench->Args({kPosixDisjoint, workers, 1});
+    bench->Args({kPosixOverlapping, workers, 1});
+  }
+}
+
+BENCHMARK(BM_LockContention)->Apply(ContentionArgs)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
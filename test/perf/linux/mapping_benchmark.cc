@@ -14,13 +14,28 @@
 
 #include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/barrier.h"
+#include "absl/types/optional.h"
 #include "benchmark/benchmark.h"
+#include "test/util/fs_util.h"
 #include "test/util/logging.h"
 #include "test/util/memory_util.h"
 #include "test/util/posix_error.h"
+#include "test/util/proc_util.h"
 #include "test/util/test_util.h"
 
 namespace gvisor {
@@ -157,6 +172,452 @@ void BM_PageFault(benchmark::State& state) {
 
 BENCHMARK(BM_PageFault)->UseRealTime();
 
+// Touch writes to every stride bytes in [addr, addr+bytes), by default to
+// every page.
+void Touch(void* addr, size_t bytes, size_t stride = kPageSize) {
+  char* c = reinterpret_cast<char*>(addr);
+  char* end = c + bytes;
+  while (c < end) {
+    *c = 42;
+    c += stride;
+  }
+}
+
+// Grow a mapping from one page to the given number of pages by doubling it
+// with mremap, touching the new half after each step. This is the pattern
+// allocators use to implement realloc of large blocks.
+void BM_MremapGrow(benchmark::State& state) {
+  // Final number of pages.
+  const int pages = state.range(0);
+
+  for (auto _ : state) {
+    size_t len = kPageSize;
+    void* addr = mmap(0, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_CHECK_MSG(addr != MAP_FAILED, "mmap failed");
+    Touch(addr, len);
+
+    while (len < pages * kPageSize) {
+      void* new_addr = mremap(addr, len, 2 * len, MREMAP_MAYMOVE);
+      TEST_CHECK_MSG(new_addr != MAP_FAILED, "mremap failed");
+      Touch(reinterpret_cast<char*>(new_addr) + len, len);
+      addr = new_addr;
+      len *= 2;
+    }
+
+    int ret = munmap(addr, len);
+    TEST_CHECK_MSG(ret == 0, "munmap failed");
+  }
+
+  state.SetBytesProcessed(kPageSize * pages * state.iterations());
+}
+
+BENCHMARK(BM_MremapGrow)->Range(16, 1 << 16)->UseRealTime();
+
+// Touch pages, then release them with madvise. The first argument is the
+// number of pages; the second selects MADV_DONTNEED (0) or MADV_FREE (1).
+void BM_MadviseReclaim(benchmark::State& state) {
+  const int pages = state.range(0);
+  const int advice = state.range(1) ? MADV_FREE : MADV_DONTNEED;
+
+  Mapping m = ASSERT_NO_ERRNO_AND_VALUE(MmapAnon(
+      pages * kPageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE));
+  if (madvise(m.ptr(), m.len(), advice) != 0) {
+    state.SkipWithError(errno == EINVAL ? "madvise advice unsupported"
+                                        : "madvise failed");
+    return;
+  }
+
+  for (auto _ : state) {
+    Touch(m.ptr(), m.len());
+    int ret = madvise(m.ptr(), m.len(), advice);
+    TEST_CHECK_MSG(ret == 0, "madvise failed");
+  }
+
+  state.SetBytesProcessed(kPageSize * pages * state.iterations());
+}
+
+BENCHMARK(BM_MadviseReclaim)
+    ->ArgsProduct({{1, 64, 1 << 12, 1 << 16}, {0, 1}})
+    ->ArgNames({"pages", "free"})
+    ->UseRealTime();
+
+// Map pages with MAP_POPULATE, touch and unmap them. Compare with
+// BM_MapTouchUnmap, which takes a fault for every page instead.
+void BM_MapPopulateTouchUnmap(benchmark::State& state) {
+  // Number of pages to map.
+  const int pages = state.range(0);
+
+  for (auto _ : state) {
+    void* addr = mmap(0, pages * kPageSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    TEST_CHECK_MSG(addr != MAP_FAILED, "mmap failed");
+
+    Touch(addr, pages * kPageSize);
+
+    int ret = munmap(addr, pages * kPageSize);
+    TEST_CHECK_MSG(ret == 0, "munmap failed");
+  }
+
+  state.SetBytesProcessed(kPageSize * pages * state.iterations());
+}
+
+BENCHMARK(BM_MapPopulateTouchUnmap)->Range(1, 1 << 17)->UseRealTime();
+
+constexpr size_t kHugePageSize = 2 << 20;
+
+// Map a 2MB-aligned region, advise it with MADV_HUGEPAGE (1) or
+// MADV_NOHUGEPAGE (0), then touch every small page in it and unmap it.
+void BM_HugePageTouch(benchmark::State& state) {
+  // Size of the region in huge pages.
+  const int huge_pages = state.range(0);
+  const int advice = state.range(1) ? MADV_HUGEPAGE : MADV_NOHUGEPAGE;
+  if (IsTHPDisabled()) {
+    state.SkipWithError("transparent huge pages are disabled");
+    return;
+  }
+
+  const size_t len = huge_pages * kHugePageSize;
+  for (auto _ : state) {
+    // Over-allocate so that an aligned region of len bytes fits, and unmap
+    // the ends.
+    void* raw = mmap(0, len + kHugePageSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_CHECK_MSG(raw != MAP_FAILED, "mmap failed");
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned =
+        (start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    if (aligned > start) {
+      TEST_CHECK_MSG(munmap(raw, aligned - start) == 0, "munmap failed");
+    }
+    const uintptr_t end = start + len + kHugePageSize;
+    if (end > aligned + len) {
+      TEST_CHECK_MSG(munmap(reinterpret_cast<void*>(aligned + len),
+                            end - (aligned + len)) == 0,
+                     "munmap failed");
+    }
+    void* addr = reinterpret_cast<void*>(aligned);
+
+    TEST_CHECK_MSG(madvise(addr, len, advice) == 0, "madvise failed");
+    Touch(addr, len);
+
+    TEST_CHECK_MSG(munmap(addr, len) == 0, "munmap failed");
+  }
+
+  state.SetBytesProcessed(len * state.iterations());
+}
+
+BENCHMARK(BM_HugePageTouch)
+    ->ArgsProduct({{1, 16, 128}, {0, 1}})
+    ->ArgNames({"huge_pages", "hugepage"})
+    ->UseRealTime();
+
+// Map, touch, then unmap pages from several threads concurrently. All
+// threads share one address space, so this measures contention on the
+// memory manager's locks.
+void BM_MapTouchUnmapThreads(benchmark::State& state) {
+  // Number of pages to map per iteration.
+  const int pages = state.range(0);
+
+  for (auto _ : state) {
+    void* addr = mmap(0, pages * kPageSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_CHECK_MSG(addr != MAP_FAILED, "mmap failed");
+
+    Touch(addr, pages * kPageSize);
+
+    int ret = munmap(addr, pages * kPageSize);
+    TEST_CHECK_MSG(ret == 0, "munmap failed");
+  }
+
+  state.SetBytesProcessed(kPageSize * pages * state.iterations());
+}
+
+BENCHMARK(BM_MapTouchUnmapThreads)
+    ->Arg(1)
+    ->Arg(64)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+// The allocator trace benchmarks below replay the address space operations
+// that malloc implementations issue for every C and C++ workload, driven by a
+// fixed pseudo-random sequence so that runs are comparable.
+
+// CountVMAs returns the number of VMAs in the calling process.
+size_t CountVMAs() {
+  const std::string maps =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(GetContents("/proc/self/maps"));
+  return std::count(maps.begin(), maps.end(), '\n');
+}
+
+// BM_Brk moves the program break up and down by random amounts of up to 64
+// pages, touching the first new page after each increment, as the main arena
+// of glibc malloc does. The break is kept within 64MB of where it started.
+//
+// The loop doesn't allocate, so no one else moves the break while it runs.
+void BM_Brk(benchmark::State& state) {
+  constexpr uintptr_t kMaxHeap = 64 << 20;
+  const uintptr_t base = reinterpret_cast<uintptr_t>(sbrk(0));
+  uintptr_t cur = base;
+  std::mt19937 rng(0);
+
+  for (auto _ : state) {
+    const uintptr_t delta = (rng() % 64 + 1) * kPageSize;
+    const bool grow = cur == base || (cur + delta - base <= kMaxHeap &&
+                                      rng() % 3 != 0);
+    const uintptr_t next =
+        grow ? cur + delta : cur - std::min(delta, cur - base);
+    TEST_CHECK(syscall(SYS_brk, next) == static_cast<long>(next));
+    if (grow) {
+      *reinterpret_cast<volatile char*>(cur) = 42;
+    }
+    cur = next;
+  }
+
+  TEST_CHECK(syscall(SYS_brk, base) == static_cast<long>(base));
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Brk)->UseRealTime();
+
+// Barrier for the threads of BM_AllocatorTrace to wait for VMAs to be
+// counted before they unmap their memory.
+absl::Barrier* trace_barrier;
+
+void AllocatorTraceSetup(const benchmark::State& state) {
+  trace_barrier = new absl::Barrier(state.threads());
+}
+
+// BM_AllocatorTrace replays, in every benchmark thread, a random mix of:
+//
+// - growing and shrinking a heap within a reserved PROT_NONE region with
+//   mprotect, and madvise(MADV_DONTNEED) when shrinking, as glibc's per-thread
+//   arenas do;
+// - mapping 16KB to 4MB blocks with a PROT_NONE guard page below them, as
+//   large allocations and thread stacks are, and touching their first page;
+// - unmapping a random block once 64 are live.
+//
+// All threads share one address space, so this exposes contention in the
+// memory manager as well as the cost of each operation. Each iteration is one
+// operation; the number of VMAs left when the loop ends is reported.
+void BM_AllocatorTrace(benchmark::State& state) {
+  constexpr size_t kArenaSize = 64 << 20;
+  constexpr size_t kMaxLive = 64;
+
+  char* const arena = static_cast<char*>(
+      mmap(nullptr, kArenaSize, PROT_NONE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+  TEST_CHECK_MSG(arena != MAP_FAILED, "mmap failed");
+  size_t heap = 0;
+
+  struct Block {
+    char* addr;
+    size_t len;
+  };
+  std::vector<Block> live;
+  live.reserve(kMaxLive + 1);
+  std::mt19937 rng(state.thread_index());
+
+  auto unmap_random = [&] {
+    const size_t i = rng() % live.size();
+    TEST_CHECK_MSG(munmap(live[i].addr, live[i].len) == 0, "munmap failed");
+    live[i] = live.back();
+    live.pop_back();
+  };
+
+  for (auto _ : state) {
+    switch (rng() % 4) {
+      case 0: {
+        // Grow the heap by up to 32 pages.
+        const size_t inc =
+            std::min<size_t>((rng() % 32 + 1) * kPageSize, kArenaSize - heap);
+        if (inc > 0) {
+          TEST_CHECK_MSG(
+              mprotect(arena + heap, inc, PROT_READ | PROT_WRITE) == 0,
+              "mprotect failed");
+          arena[heap] = 42;
+          heap += inc;
+        }
+        break;
+      }
+      case 1: {
+        // Trim up to half of the heap.
+        const size_t dec = (rng() % (heap / kPageSize / 2 + 1)) * kPageSize;
+        if (dec > 0) {
+          heap -= dec;
+          TEST_CHECK_MSG(madvise(arena + heap, dec, MADV_DONTNEED) == 0,
+                         "madvise failed");
+          TEST_CHECK_MSG(mprotect(arena + heap, dec, PROT_NONE) == 0,
+                         "mprotect failed");
+        }
+        break;
+      }
+      default: {
+        // Map a block of 4 to 1024 pages (16KB to 4MB), log-uniformly.
+        const size_t len = (size_t{4} << (rng() % 9)) * kPageSize + kPageSize;
+        char* const addr = static_cast<char*>(
+            mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        TEST_CHECK_MSG(addr != MAP_FAILED, "mmap failed");
+        TEST_CHECK_MSG(mprotect(addr, kPageSize, PROT_NONE) == 0,
+                       "mprotect failed");
+        addr[kPageSize] = 42;
+        live.push_back({addr, len});
+        if (live.size() > kMaxLive) {
+          unmap_random();
+        }
+        break;
+      }
+    }
+  }
+
+  if (state.thread_index() == 0) {
+    state.counters["vmas"] = CountVMAs();
+  }
+  if (trace_barrier->Block()) {
+    delete trace_barrier;
+  }
+
+  while (!live.empty()) {
+    unmap_random();
+  }
+  TEST_CHECK_MSG(munmap(arena, kArenaSize) == 0, "munmap failed");
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_AllocatorTrace)
+    ->Setup(AllocatorTraceSetup)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+// The benchmarks below measure populating or inspecting whole ranges at once,
+// as services that pin their working set at startup do, over ranges from 1MB
+// to 32GB. Throughput is reported in bytes of range per second.
+
+// MapRange maps size bytes of anonymous memory, of which the benchmark will
+// make up to resident bytes resident, which must fit in half of free memory.
+// It returns nullopt and skips the benchmark on failure.
+absl::optional<Mapping> MapRange(benchmark::State& state, size_t size,
+                                 size_t resident) {
+  struct sysinfo info;
+  TEST_PCHECK(sysinfo(&info) == 0);
+  if (resident > static_cast<uint64_t>(info.freeram) * info.mem_unit / 2) {
+    state.SkipWithError("not enough free memory");
+    return absl::nullopt;
+  }
+  auto m = MmapAnon(size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE);
+  if (!m.ok()) {
+    state.SkipWithError(m.error().ToString().c_str());
+    return absl::nullopt;
+  }
+  return std::move(m).ValueOrDie();
+}
+
+// BM_MlockMunlock locks a range, which faults in every page, then unlocks
+// it. The range is emptied with MADV_DONTNEED, untimed, before each iteration
+// so that every mlock populates it again.
+//
+// Locking more than RLIMIT_MEMLOCK requires CAP_IPC_LOCK; the benchmark is
+// skipped if mlock fails.
+void BM_MlockMunlock(benchmark::State& state) {
+  const size_t size = state.range(0);
+  absl::optional<Mapping> m = MapRange(state, size, size);
+  if (!m) {
+    return;
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    TEST_PCHECK(madvise(m->ptr(), size, MADV_DONTNEED) == 0);
+    state.ResumeTiming();
+
+    if (mlock(m->ptr(), size) != 0) {
+      state.SkipWithError(
+          absl::StrCat("mlock failed: ", strerror(errno)).c_str());
+      return;
+    }
+    TEST_PCHECK(munlock(m->ptr(), size) == 0);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(size) * state.iterations());
+}
+
+BENCHMARK(BM_MlockMunlock)
+    ->RangeMultiplier(8)
+    ->Range(1 << 20, int64_t{32} << 30)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// BM_MadvisePopulate prefaults a range with MADV_POPULATE_WRITE (1) or
+// MADV_POPULATE_READ (0), emptying it with MADV_DONTNEED, untimed, before
+// each iteration. Reading anonymous memory maps the zero page, so the read
+// variant doesn't allocate memory.
+void BM_MadvisePopulate(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const bool write = state.range(1);
+  const int advice = write ? MADV_POPULATE_WRITE : MADV_POPULATE_READ;
+  absl::optional<Mapping> m = MapRange(state, size, write ? size : 0);
+  if (!m) {
+    return;
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    TEST_PCHECK(madvise(m->ptr(), size, MADV_DONTNEED) == 0);
+    state.ResumeTiming();
+
+    if (madvise(m->ptr(), size, advice) != 0) {
+      state.SkipWithError(
+          absl::StrCat("madvise failed: ", strerror(errno)).c_str());
+      return;
+    }
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(size) * state.iterations());
+}
+
+BENCHMARK(BM_MadvisePopulate)
+    ->ArgsProduct({benchmark::CreateRange(1 << 20, int64_t{32} << 30, 8),
+                   {0, 1}})
+    ->ArgNames({"size", "write"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// BM_Mincore queries the residency of a sparse range in which one page in
+// state.range(1) has been touched, as caches checking what is still resident
+// do.
+void BM_Mincore(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const size_t stride = state.range(1) * kPageSize;
+  absl::optional<Mapping> m =
+      MapRange(state, size, size / state.range(1));
+  if (!m) {
+    return;
+  }
+  Touch(m->ptr(), size, stride);
+
+  std::vector<unsigned char> vec(size / kPageSize);
+  for (auto _ : state) {
+    TEST_PCHECK(mincore(m->ptr(), size, vec.data()) == 0);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(size) * state.iterations());
+}
+
+BENCHMARK(BM_Mincore)
+    ->ArgsProduct({benchmark::CreateRange(1 << 20, int64_t{32} << 30, 8),
+                   {1, 512}})
+    ->ArgNames({"size", "stride_pages"})
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
@@ -0,0 +1,162 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "benchmark/benchmark.h"
+#include "test/util/logging.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// Commands from include/uapi/linux/membarrier.h, which may be missing from
+// older headers.
+enum membarrier_cmd {
+  MEMBARRIER_CMD_QUERY = 0,
+  MEMBARRIER_CMD_GLOBAL = (1 << 0),
+  MEMBARRIER_CMD_GLOBAL_EXPEDITED = (1 << 1),
+  MEMBARRIER_CMD_REGISTER_GLOBAL_EXPEDITED = (1 << 2),
+  MEMBARRIER_CMD_PRIVATE_EXPEDITED = (1 << 3),
+  MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED = (1 << 4),
+};
+
+int membarrier(int cmd, int flags) {
+  return syscall(SYS_membarrier, cmd, flags);
+}
+
+// SupportedMembarrierCommands returns the bitmask of supported commands, or 0
+// if membarrier isn't supported at all.
+int SupportedMembarrierCommands() {
+  int cmds = membarrier(MEMBARRIER_CMD_QUERY, 0);
+  if (cmds < 0) {
+    TEST_PCHECK(errno == ENOSYS);
+    return 0;
+  }
+  return cmds;
+}
+
+// BackgroundThreads runs threads of the benchmark process while membarrier is
+// called, since these are the threads that the barrier must reach. Busy
+// threads spin, so they are running on a CPU when the barrier is issued and
+// must be interrupted. Idle threads are blocked, which expedited barriers are
+// expected to skip.
+class BackgroundThreads {
+ public:
+  BackgroundThreads(int n, bool busy) {
+    for (int i = 0; i < n; i++) {
+      threads_.push_back(std::make_unique<ScopedThread>([this, busy] {
+        if (busy) {
+          uint64_t spins = 0;
+          while (!stop_.load(std::memory_order_relaxed)) {
+            // Keep running application code, as a reader of an RCU-style
+            // data structure would.
+            benchmark::DoNotOptimize(spins++);
+          }
+        } else {
+          done_.WaitForNotification();
+        }
+      }));
+    }
+  }
+
+  ~BackgroundThreads() {
+    stop_.store(true, std::memory_order_relaxed);
+    done_.Notify();
+    threads_.clear();
+  }
+
+ private:
+  std::atomic<bool> stop_{false};
+  absl::Notification done_;
+  std::vector<std::unique_ptr<ScopedThread>> threads_;
+};
+
+// MembarrierLatency measures the latency of membarrier(cmd) with
+// state.range(0) other threads in the process, busy if state.range(1) is
+// non-zero.
+//
+// RCU-style reclaimers (liburcu, folly hazard pointers, the JVM) issue these
+// barriers from their write side, so their cost as the number of application
+// threads grows bounds how fast memory can be reclaimed. Each platform
+// implements the cross-thread barrier differently, e.g. systrap has to
+// interrupt each running stub thread while KVM may use vCPU interrupts.
+//
+// Once there are more busy threads than CPUs, real time also includes the
+// time the calling thread waits for a CPU, so CPU time is the better measure.
+void MembarrierLatency(benchmark::State& state, int cmd, int register_cmd) {
+  const int required = cmd | register_cmd;
+  if ((SupportedMembarrierCommands() & required) != required) {
+    state.SkipWithError("membarrier command not supported");
+    return;
+  }
+  if (register_cmd != 0) {
+    // Registration only needs to happen once per process, but is cheap
+    // enough to repeat for each run.
+    TEST_PCHECK(membarrier(register_cmd, 0) == 0);
+  }
+
+  BackgroundThreads threads(state.range(0), state.range(1));
+  for (auto _ : state) {
+    TEST_PCHECK(membarrier(cmd, 0) == 0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_MembarrierGlobal(benchmark::State& state) {
+  MembarrierLatency(state, MEMBARRIER_CMD_GLOBAL, 0);
+}
+
+// MEMBARRIER_CMD_GLOBAL waits for an RCU grace period on Linux, so it is
+// expected to be orders of magnitude slower than the expedited commands.
+BENCHMARK(BM_MembarrierGlobal)
+    ->ArgsProduct({{0, 1, 4, 16, 64, 256}, {0, 1}})
+    ->ArgNames({"threads", "busy"})
+    ->UseRealTime();
+
+void BM_MembarrierGlobalExpedited(benchmark::State& state) {
+  MembarrierLatency(state, MEMBARRIER_CMD_GLOBAL_EXPEDITED,
+                    MEMBARRIER_CMD_REGISTER_GLOBAL_EXPEDITED);
+}
+
+BENCHMARK(BM_MembarrierGlobalExpedited)
+    ->ArgsProduct({{0, 1, 4, 16, 64, 256}, {0, 1}})
+    ->ArgNames({"threads", "busy"})
+    ->UseRealTime();
+
+void BM_MembarrierPrivateExpedited(benchmark::State& state) {
+  MembarrierLatency(state, MEMBARRIER_CMD_PRIVATE_EXPEDITED,
+                    MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED);
+}
+
+BENCHMARK(BM_MembarrierPrivateExpedited)
+    ->ArgsProduct({{0, 1, 4, 16, 64, 256}, {0, 1}})
+    ->ArgNames({"threads", "busy"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,313 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <sched.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/capability_util.h"
+#include "test/util/cleanup.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/mount_util.h"
+#include "test/util/multiprocess_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the namespace and mount operations that nested
+// sandboxes (e.g. buildkit and bubblewrap) perform for each step, with mount
+// tables of increasing size, since operations that copy or walk the mount
+// table get slower as it grows.
+//
+// All mounts are made in a private mount namespace, so that they don't
+// propagate to the rest of the system when run natively.
+
+// Namespace types, as passed in the benchmarks' ns argument.
+enum NamespaceType {
+  kNone,
+  kMnt,
+  kUts,
+  kIpc,
+  kNet,
+  kPid,
+  kUser,
+  kCgroup,
+  kNumNamespaceTypes,
+};
+
+struct Namespace {
+  const char* name;
+  int flag;
+};
+
+// kNamespaces is indexed by NamespaceType.
+constexpr Namespace kNamespaces[kNumNamespaceTypes] = {
+    {"none", 0},
+    {"mnt", CLONE_NEWNS},
+    {"uts", CLONE_NEWUTS},
+    {"ipc", CLONE_NEWIPC},
+    {"net", CLONE_NEWNET},
+    {"pid", CLONE_NEWPID},
+    {"user", CLONE_NEWUSER},
+    {"cgroup", CLONE_NEWCGROUP},
+};
+
+// PrivateMounts moves the calling thread to a new mount namespace from which
+// no mounts propagate to the original one. The benchmarks in this file don't
+// use extra threads, so this is only needed once.
+void PrivateMounts() {
+  static const bool done = [] {
+    TEST_PCHECK(unshare(CLONE_NEWNS) == 0);
+    TEST_PCHECK(mount("", "/", "", MS_REC | MS_PRIVATE, "") == 0);
+    return true;
+  }();
+  (void)done;
+}
+
+// Scratch is a tmpfs mounted on a temporary directory, with more tmpfs
+// mounts on its subdirectories to grow the mount table.
+class Scratch {
+ public:
+  explicit Scratch(int mounts)
+      : dir_(TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateDir())),
+        mount_(TEST_CHECK_NO_ERRNO_AND_VALUE(
+            Mount("", dir_.path(), "tmpfs", 0, "mode=0700", 0))) {
+    TEST_PCHECK(mkdir(Path("mounts").c_str(), 0700) == 0);
+    for (int i = 0; i < mounts; i++) {
+      const std::string path = Path(absl::StrCat("mounts/", i));
+      TEST_PCHECK(mkdir(path.c_str(), 0700) == 0);
+      mounts_.push_back(
+          TEST_CHECK_NO_ERRNO_AND_VALUE(Mount("", path, "tmpfs", 0, "", 0)));
+    }
+  }
+
+  // Path returns the path of name in the scratch tmpfs.
+  std::string Path(const std::string& name) const {
+    return JoinPath(dir_.path(), name);
+  }
+
+  // Mkdir creates the directory name in the scratch tmpfs and returns its
+  // path.
+  std::string Mkdir(const std::string& name) const {
+    const std::string path = Path(name);
+    TEST_PCHECK(mkdir(path.c_str(), 0700) == 0);
+    return path;
+  }
+
+ private:
+  // Members are destroyed in reverse order, so that mounts_ are unmounted
+  // before mount_, which is unmounted before dir_ is removed.
+  TempPath dir_;
+  Cleanup mount_;
+  std::vector<Cleanup> mounts_;
+};
+
+// CheckCapabilities returns false, after skipping the benchmark, if the
+// capabilities needed to create namespaces and mounts are missing.
+bool CheckCapabilities(benchmark::State& state) {
+  if (!TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_SYS_ADMIN)) ||
+      !TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_SYS_CHROOT))) {
+    state.SkipWithError("CAP_SYS_ADMIN and CAP_SYS_CHROOT required");
+    return false;
+  }
+  PrivateMounts();
+  return true;
+}
+
+// BM_Unshare measures a child process that creates a namespace of the given
+// type with unshare(2) and exits, which also destroys the namespace. Some
+// types can only be unshared once per process, hence a new process per
+// iteration; ns:none measures the cost of the process alone.
+void BM_Unshare(benchmark::State& state) {
+  const Namespace ns = kNamespaces[state.range(0)];
+  const int mounts = state.range(1);
+  if (!CheckCapabilities(state)) {
+    return;
+  }
+  state.SetLabel(ns.name);
+  const Scratch scratch(mounts);
+
+  const int flag = ns.flag;
+  const auto child = [flag] {
+    if (flag != 0) {
+      TEST_PCHECK(unshare(flag) == 0);
+    }
+  };
+  for (auto _ : state) {
+    TEST_CHECK(TEST_CHECK_NO_ERRNO_AND_VALUE(InForkedProcess(child)) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void UnshareArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"ns", "mounts"});
+  for (int i = kNone; i < kNumNamespaceTypes; i++) {
+    if (i == kMnt) {
+      // Only a new mount namespace copies the mount table.
+      for (int mounts : {0, 100, 1000}) {
+        bench->Args({i, mounts});
+      }
+    } else {
+      bench->Args({i, 0});
+    }
+  }
+}
+
+BENCHMARK(BM_Unshare)->Apply(UnshareArgs)->UseRealTime();
+
+// BM_Setns measures a round trip of setns(2) into a namespace of the given
+// type and back.
+void BM_Setns(benchmark::State& state) {
+  const Namespace ns = kNamespaces[state.range(0)];
+  if (!CheckCapabilities(state)) {
+    return;
+  }
+  state.SetLabel(ns.name);
+
+  const std::string path = absl::StrCat("/proc/thread-self/ns/", ns.name);
+  const FileDescriptor orig =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path, O_RDONLY));
+  TEST_PCHECK(unshare(ns.flag) == 0);
+  const FileDescriptor other =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path, O_RDONLY));
+  TEST_PCHECK(setns(orig.get(), ns.flag) == 0);
+
+  for (auto _ : state) {
+    TEST_PCHECK(setns(other.get(), ns.flag) == 0);
+    TEST_PCHECK(setns(orig.get(), ns.flag) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// PID and user namespaces can't be entered by a multithreaded process, and a
+// PID namespace only applies to children.
+BENCHMARK(BM_Setns)
+    ->Arg(kMnt)
+    ->Arg(kUts)
+    ->Arg(kIpc)
+    ->Arg(kNet)
+    ->Arg(kCgroup)
+    ->ArgName("ns")
+    ->UseRealTime();
+
+enum MountKind {
+  kTmpfs,
+  kBind,
+  kOverlay,
+};
+
+// BM_Mount measures mounting then unmounting a filesystem of the given kind.
+void BM_Mount(benchmark::State& state) {
+  const MountKind kind = static_cast<MountKind>(state.range(0));
+  const int mounts = state.range(1);
+  if (!CheckCapabilities(state)) {
+    return;
+  }
+  const Scratch scratch(mounts);
+
+  const std::string target = scratch.Mkdir("target");
+  std::string source, fstype, data;
+  uint64_t flags = 0;
+  switch (kind) {
+    case kTmpfs:
+      fstype = "tmpfs";
+      break;
+    case kBind:
+      source = scratch.Mkdir("source");
+      flags = MS_BIND;
+      break;
+    case kOverlay:
+      fstype = "overlay";
+      data = absl::StrCat("lowerdir=", scratch.Mkdir("lower"),
+                          ",upperdir=", scratch.Mkdir("upper"),
+                          ",workdir=", scratch.Mkdir("work"));
+      break;
+  }
+
+  for (auto _ : state) {
+    // The returned Cleanup unmounts once it goes out of scope.
+    const Cleanup mount = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        Mount(source, target, fstype, flags, data, 0));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Mount)
+    ->ArgsProduct({{kTmpfs, kBind, kOverlay}, {0, 100, 1000}})
+    ->ArgNames({"kind", "mounts"})
+    ->UseRealTime();
+
+// BM_PivotRoot measures a child process that switches to a new root as
+// container runtimes do: it creates a mount namespace, makes a tmpfs its root
+// with pivot_root(2) and detaches the old root. Compare with
+// BM_Unshare/ns:1, which only creates the mount namespace.
+void BM_PivotRoot(benchmark::State& state) {
+  const int mounts = state.range(0);
+  if (!CheckCapabilities(state)) {
+    return;
+  }
+  const Scratch scratch(mounts);
+
+  // As in the pivot_root tests, the child first chroots into the scratch
+  // tmpfs, so that its root is a mount point.
+  const std::string root = scratch.Path("");
+  const std::string new_root = scratch.Mkdir("new");
+  const Cleanup new_root_mount = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      Mount("", new_root, "tmpfs", 0, "mode=0700", 0));
+  TEST_PCHECK(mkdir(JoinPath(new_root, "old").c_str(), 0700) == 0);
+
+  const auto child = [&] {
+    TEST_PCHECK(unshare(CLONE_NEWNS) == 0);
+    TEST_PCHECK(chroot(root.c_str()) == 0);
+    TEST_PCHECK(syscall(__NR_pivot_root, "/new", "/new/old") == 0);
+    TEST_PCHECK(chdir("/") == 0);
+    TEST_PCHECK(umount2("/old", MNT_DETACH) == 0);
+  };
+  for (auto _ : state) {
+    TEST_CHECK(TEST_CHECK_NO_ERRNO_AND_VALUE(InForkedProcess(child)) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PivotRoot)
+    ->Arg(0)
+    ->Arg(100)
+    ->Arg(1000)
+    ->ArgName("mounts")
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
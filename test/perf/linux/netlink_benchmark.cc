@@ -0,0 +1,205 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/if_tun.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/socket_netlink_route_util.h"
+#include "test/syscalls/linux/socket_netlink_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/linux_capability_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks time rtnetlink dumps, the way service-mesh agents poll
+// the network configuration, as the number of objects dumped grows. A dump's
+// response is a multipart message read a page at a time; quadratic behavior
+// in producing it shows up as time per object growing with the count.
+
+constexpr uint32_t kSeq = 1;
+
+// The nth address of a block starting at base, in network byte order.
+struct in_addr NthAddr(uint32_t base, int n) {
+  return {.s_addr = htonl(base + n)};
+}
+
+constexpr uint32_t kRouteBase = 0x0a020000;  // 10.2.0.0
+constexpr uint32_t kAddrBase = 0x0a030000;   // 10.3.0.0
+
+// Dump sends an NLM_F_DUMP request of the given type, whose payload is a Msg
+// for the requested family, and reports the size of the response.
+template <typename Msg>
+void Dump(const FileDescriptor& fd, uint16_t type, size_t* messages,
+          size_t* bytes) {
+  struct {
+    struct nlmsghdr hdr;
+    Msg msg;
+  } req = {};
+  req.hdr.nlmsg_len = sizeof(req);
+  req.hdr.nlmsg_type = type;
+  req.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.hdr.nlmsg_seq = kSeq;
+
+  *messages = 0;
+  *bytes = 0;
+  TEST_CHECK_NO_ERRNO(NetlinkRequestResponse(
+      fd, &req, sizeof(req),
+      [&](const struct nlmsghdr* hdr) {
+        ++*messages;
+        *bytes += hdr->nlmsg_len;
+      },
+      /*expect_nlmsgerr=*/false));
+}
+
+// RunDump times dumps of the given type and reports the size of a response.
+template <typename Msg>
+void RunDump(benchmark::State& state, uint16_t type) {
+  FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(NetlinkBoundSocket(NETLINK_ROUTE));
+  size_t messages = 0;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    Dump<Msg>(fd, type, &messages, &bytes);
+  }
+  state.counters["messages"] = messages;
+  state.counters["response_bytes"] = bytes;
+  state.SetItemsProcessed(state.iterations() * messages);
+}
+
+bool HaveNetAdmin(benchmark::State& state) {
+  if (!TEST_CHECK_NO_ERRNO_AND_VALUE(HaveCapability(CAP_NET_ADMIN))) {
+    state.SkipWithError("CAP_NET_ADMIN required");
+    return false;
+  }
+  return true;
+}
+
+// BM_NetlinkDumpRoutes dumps the routing tables with a number of extra /32
+// routes through loopback installed.
+void BM_NetlinkDumpRoutes(benchmark::State& state) {
+  const int routes = state.range(0);
+  if (!HaveNetAdmin(state)) {
+    return;
+  }
+  const Link lo = TEST_CHECK_NO_ERRNO_AND_VALUE(LoopbackLink());
+  for (int i = 0; i < routes; i++) {
+    struct in_addr dst = NthAddr(kRouteBase, i);
+    TEST_CHECK_NO_ERRNO(
+        AddUnicastRoute(lo.index, AF_INET, 32, &dst, sizeof(dst)));
+  }
+
+  RunDump<struct rtmsg>(state, RTM_GETROUTE);
+
+  for (int i = 0; i < routes; i++) {
+    struct in_addr dst = NthAddr(kRouteBase, i);
+    TEST_CHECK_NO_ERRNO(
+        DelUnicastRoute(lo.index, AF_INET, 32, &dst, sizeof(dst)));
+  }
+}
+
+BENCHMARK(BM_NetlinkDumpRoutes)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->ArgName("routes")
+    ->UseRealTime();
+
+// BM_NetlinkDumpAddrs dumps interface addresses with a number of extra
+// addresses assigned to loopback.
+void BM_NetlinkDumpAddrs(benchmark::State& state) {
+  const int addrs = state.range(0);
+  if (!HaveNetAdmin(state)) {
+    return;
+  }
+  const Link lo = TEST_CHECK_NO_ERRNO_AND_VALUE(LoopbackLink());
+  FileDescriptor nlsk =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(NetlinkBoundSocket(NETLINK_ROUTE));
+  for (int i = 0; i < addrs; i++) {
+    struct in_addr addr = NthAddr(kAddrBase, i);
+    TEST_CHECK_NO_ERRNO(
+        LinkAddLocalAddr(nlsk, lo.index, AF_INET, 32, &addr, sizeof(addr)));
+  }
+
+  RunDump<struct ifaddrmsg>(state, RTM_GETADDR);
+
+  for (int i = 0; i < addrs; i++) {
+    struct in_addr addr = NthAddr(kAddrBase, i);
+    TEST_CHECK_NO_ERRNO(
+        LinkDelLocalAddr(nlsk, lo.index, AF_INET, 32, &addr, sizeof(addr)));
+  }
+}
+
+BENCHMARK(BM_NetlinkDumpAddrs)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->ArgName("addrs")
+    ->UseRealTime();
+
+// BM_NetlinkDumpLinks dumps interfaces with a number of TAP devices created.
+// The devices go away when their fds are closed.
+void BM_NetlinkDumpLinks(benchmark::State& state) {
+  const int taps = state.range(0);
+  if (!HaveNetAdmin(state)) {
+    return;
+  }
+  std::vector<FileDescriptor> fds;
+  for (int i = 0; i < taps; i++) {
+    FileDescriptor fd =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(Open("/dev/net/tun", O_RDWR));
+    struct ifreq ifr = {};
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, absl::StrCat("nlbench", i).c_str(), IFNAMSIZ - 1);
+    TEST_PCHECK(ioctl(fd.get(), TUNSETIFF, &ifr) == 0);
+    fds.push_back(std::move(fd));
+  }
+
+  RunDump<struct ifinfomsg>(state, RTM_GETLINK);
+}
+
+BENCHMARK(BM_NetlinkDumpLinks)
+    ->Arg(0)
+    ->Arg(16)
+    ->Arg(128)
+    ->ArgName("taps")
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
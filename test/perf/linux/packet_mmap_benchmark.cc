@@ -0,0 +1,328 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/ip_socket_test_util.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/capability_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks receive packets sent over loopback by a second AF_PACKET
+// socket, either with recvfrom(2) or through a PACKET_RX_RING, as a packet
+// capture tool would.
+
+enum Mode {
+  kRecvfrom = 0,
+  kRingV2 = 1,
+  kRingV3 = 2,
+};
+
+const char* ModeName(int mode) {
+  switch (mode) {
+    case kRecvfrom:
+      return "recvfrom";
+    case kRingV2:
+      return "tpacket_v2";
+    case kRingV3:
+      return "tpacket_v3";
+  }
+  return "unknown";
+}
+
+// The largest packet sent; frames must hold it plus the tpacket headers.
+constexpr int kMaxPacket = 9000;
+constexpr uint32_t kFrameSize = 16384;
+constexpr uint32_t kBlockSize = 1 << 20;
+constexpr uint32_t kBlocks = 16;
+
+// Receiver is an AF_PACKET socket bound to loopback, optionally with a
+// mapped RX ring.
+class Receiver {
+ public:
+  // Creates a receiver in the given mode. For kRingV3, blocks are retired
+  // after retire_ms even if not full. Returns an error with EINVAL if the
+  // ring version is not supported.
+  static PosixErrorOr<std::unique_ptr<Receiver>> Create(
+      int mode, const sockaddr_ll& addr, int retire_ms) {
+    int fd = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (fd < 0) {
+      return PosixError(errno, "socket(AF_PACKET)");
+    }
+    std::unique_ptr<Receiver> r(new Receiver(mode, FileDescriptor(fd)));
+
+    // Each packet sent on loopback is seen both leaving and arriving; only
+    // count it once where the option is supported.
+    int one = 1;
+    setsockopt(fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one));
+
+    if (mode != kRecvfrom) {
+      int version = mode == kRingV2 ? TPACKET_V2 : TPACKET_V3;
+      RETURN_ERROR_IF_SYSCALL_FAIL(setsockopt(fd, SOL_PACKET, PACKET_VERSION,
+                                              &version, sizeof(version)));
+      if (mode == kRingV2) {
+        tpacket_req req = {
+            .tp_block_size = kBlockSize,
+            .tp_block_nr = kBlocks,
+            .tp_frame_size = kFrameSize,
+            .tp_frame_nr = kBlockSize / kFrameSize * kBlocks,
+        };
+        RETURN_ERROR_IF_SYSCALL_FAIL(
+            setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)));
+      } else {
+        tpacket_req3 req = {
+            .tp_block_size = kBlockSize,
+            .tp_block_nr = kBlocks,
+            .tp_frame_size = kFrameSize,
+            .tp_frame_nr = kBlockSize / kFrameSize * kBlocks,
+            .tp_retire_blk_tov = static_cast<unsigned int>(retire_ms),
+        };
+        RETURN_ERROR_IF_SYSCALL_FAIL(
+            setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)));
+      }
+      void* ring = mmap(nullptr, kBlockSize * kBlocks, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+      if (ring == MAP_FAILED) {
+        return PosixError(errno, "mmap(PACKET_RX_RING)");
+      }
+      r->ring_ = static_cast<char*>(ring);
+    }
+    RETURN_ERROR_IF_SYSCALL_FAIL(
+        bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)));
+    return r;
+  }
+
+  ~Receiver() {
+    if (ring_ != nullptr) {
+      TEST_PCHECK(munmap(ring_, kBlockSize * kBlocks) == 0);
+    }
+  }
+
+  // Receives one packet, blocking until one is available, and returns its
+  // length.
+  size_t Receive() {
+    while (true) {
+      size_t len;
+      if (TryReceive(&len)) {
+        return len;
+      }
+      struct pollfd pfd = {.fd = fd_.get(), .events = POLLIN};
+      TEST_PCHECK(RetryEINTR(poll)(&pfd, 1, -1) == 1);
+    }
+  }
+
+ private:
+  Receiver(int mode, FileDescriptor fd) : mode_(mode), fd_(std::move(fd)) {}
+
+  bool TryReceive(size_t* len) {
+    switch (mode_) {
+      case kRecvfrom: {
+        int n = recvfrom(fd_.get(), buf_, sizeof(buf_), MSG_DONTWAIT, nullptr,
+                         nullptr);
+        if (n < 0) {
+          TEST_PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+          return false;
+        }
+        *len = n;
+        return true;
+      }
+      case kRingV2: {
+        constexpr uint32_t kFrames = kBlockSize / kFrameSize * kBlocks;
+        auto* hdr = reinterpret_cast<volatile tpacket2_hdr*>(
+            ring_ + static_cast<size_t>(frame_) * kFrameSize);
+        if (!(hdr->tp_status & TP_STATUS_USER)) {
+          return false;
+        }
+        *len = hdr->tp_len;
+        hdr->tp_status = TP_STATUS_KERNEL;
+        frame_ = (frame_ + 1) % kFrames;
+        return true;
+      }
+      case kRingV3: {
+        auto* block = reinterpret_cast<volatile tpacket_block_desc*>(
+            ring_ + static_cast<size_t>(block_) * kBlockSize);
+        if (!(block->hdr.bh1.block_status & TP_STATUS_USER)) {
+          return false;
+        }
+        if (pkt_ == nullptr) {
+          pkt_ = reinterpret_cast<char*>(const_cast<tpacket_block_desc*>(
+                     block)) +
+                 block->hdr.bh1.offset_to_first_pkt;
+          remaining_ = block->hdr.bh1.num_pkts;
+        }
+        if (remaining_ == 0) {
+          // An empty block retired by the timer.
+          block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+          pkt_ = nullptr;
+          block_ = (block_ + 1) % kBlocks;
+          return false;
+        }
+        auto* hdr = reinterpret_cast<tpacket3_hdr*>(pkt_);
+        *len = hdr->tp_len;
+        pkt_ += hdr->tp_next_offset;
+        if (--remaining_ == 0) {
+          block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+          pkt_ = nullptr;
+          block_ = (block_ + 1) % kBlocks;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const int mode_;
+  FileDescriptor fd_;
+  char* ring_ = nullptr;
+
+  // kRecvfrom state.
+  char buf_[kMaxPacket];
+
+  // kRingV2 state.
+  uint32_t frame_ = 0;
+
+  // kRingV3 state.
+  uint32_t block_ = 0;
+  char* pkt_ = nullptr;
+  uint32_t remaining_ = 0;
+};
+
+// SetUp skips the benchmark and returns nullptr if packet sockets or the
+// requested ring are unavailable.
+std::unique_ptr<Receiver> SetUp(benchmark::State& state, int mode,
+                                sockaddr_ll* addr, int retire_ms) {
+  if (!TEST_CHECK_NO_ERRNO_AND_VALUE(
+          HavePacketSocketCapability(SOCK_DGRAM, ETH_P_IP))) {
+    state.SkipWithError("packet sockets not available");
+    return nullptr;
+  }
+  *addr = {
+      .sll_family = AF_PACKET,
+      .sll_protocol = htons(ETH_P_IP),
+      .sll_ifindex = TEST_CHECK_NO_ERRNO_AND_VALUE(GetLoopbackIndex()),
+      .sll_halen = ETH_ALEN,
+  };
+  auto r = Receiver::Create(mode, *addr, retire_ms);
+  if (!r.ok() && r.error().errno_value() == EINVAL) {
+    state.SkipWithError("ring version not supported");
+    return nullptr;
+  }
+  return std::move(r).ValueOrDie();
+}
+
+// BM_PacketRxThroughput receives packets as fast as a sender thread can
+// flood them.
+void BM_PacketRxThroughput(benchmark::State& state) {
+  const int mode = state.range(0);
+  const int size = state.range(1);
+  sockaddr_ll addr;
+  std::unique_ptr<Receiver> receiver =
+      SetUp(state, mode, &addr, /*retire_ms=*/1);
+  if (receiver == nullptr) {
+    return;
+  }
+  state.SetLabel(ModeName(mode));
+
+  FileDescriptor tx(socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP)));
+  TEST_PCHECK(tx.get() >= 0);
+  std::atomic<bool> done(false);
+  ScopedThread sender([&] {
+    std::vector<char> buf(size);
+    while (!done.load(std::memory_order_relaxed)) {
+      int n = sendto(tx.get(), buf.data(), buf.size(), 0,
+                     reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+      // The receiver may be overrun.
+      TEST_PCHECK(n == size || errno == ENOBUFS);
+    }
+  });
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    bytes += receiver->Receive();
+  }
+  done.store(true);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_PacketRxThroughput)
+    ->ArgsProduct({{kRecvfrom, kRingV2, kRingV3}, {64, 1500, kMaxPacket}})
+    ->ArgNames({"mode", "size"})
+    ->UseRealTime();
+
+// BM_PacketRxLatency measures the time from sending a single packet until
+// it can be received. For TPACKET_V3 this includes waiting for the partly
+// filled block to be retired.
+void BM_PacketRxLatency(benchmark::State& state) {
+  const int mode = state.range(0);
+  const int retire_ms = state.range(1);
+  sockaddr_ll addr;
+  std::unique_ptr<Receiver> receiver = SetUp(state, mode, &addr, retire_ms);
+  if (receiver == nullptr) {
+    return;
+  }
+
+  FileDescriptor tx(socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP)));
+  TEST_PCHECK(tx.get() >= 0);
+  char buf[64] = {};
+  LatencyRecorder latency(state, absl::StrCat("BM_PacketRxLatency/",
+                                              ModeName(mode), "/retire_ms:",
+                                              retire_ms));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    TEST_PCHECK(sendto(tx.get(), buf, sizeof(buf), 0,
+                       reinterpret_cast<const sockaddr*>(&addr),
+                       sizeof(addr)) == sizeof(buf));
+    receiver->Receive();
+  }
+}
+
+BENCHMARK(BM_PacketRxLatency)
+    ->Args({kRecvfrom, 0})
+    ->Args({kRingV2, 0})
+    ->Args({kRingV3, 1})
+    ->Args({kRingV3, 8})
+    ->ArgNames({"mode", "retire_ms"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -12,11 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fcntl.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "benchmark/benchmark.h"
@@ -60,6 +66,189 @@ void BM_Pipe(benchmark::State& state) {
 
 BENCHMARK(BM_Pipe)->Range(1, 1 << 20)->UseRealTime();
 
+// BM_PipePairs runs one writer/reader pair per benchmark thread, each on its
+// own pipe. The pipes are independent, so aggregate throughput should scale
+// with the number of pairs unless pipes share locks.
+void BM_PipePairs(benchmark::State& state) {
+  int fds[2];
+  TEST_CHECK(pipe(fds) == 0);
+
+  const int size = state.range(0);
+  std::vector<char> wbuf(size);
+  std::vector<char> rbuf(size);
+  RandomizeBuffer(wbuf.data(), size);
+
+  ScopedThread t([&] {
+    auto const fd = fds[1];
+    for (benchmark::IterationCount i = 0; i < state.max_iterations; i++) {
+      TEST_CHECK(WriteFd(fd, wbuf.data(), wbuf.size()) == size);
+    }
+  });
+
+  for (auto _ : state) {
+    TEST_CHECK(ReadFd(fds[0], rbuf.data(), rbuf.size()) == size);
+  }
+
+  t.Join();
+
+  close(fds[0]);
+  close(fds[1]);
+
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_PipePairs)
+    ->Arg(4 << 10)
+    ->Arg(64 << 10)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+// BM_PipeReaders measures a single writer feeding many readers that share one
+// pipe, like a worker pool reading jobs from a pipe. Writes are at most
+// PIPE_BUF bytes so that each one is read whole by a single reader.
+void BM_PipeReaders(benchmark::State& state) {
+  int fds[2];
+  TEST_CHECK(pipe(fds) == 0);
+
+  const int size = state.range(0);
+  const int readers = state.range(1);
+  std::vector<char> wbuf(size);
+  RandomizeBuffer(wbuf.data(), size);
+
+  // Readers stop at EOF, once the writer closes its end.
+  std::atomic<int64_t> read_bytes = 0;
+  std::vector<std::unique_ptr<ScopedThread>> threads;
+  for (int i = 0; i < readers; i++) {
+    threads.push_back(std::make_unique<ScopedThread>([&] {
+      std::vector<char> rbuf(size);
+      int64_t total = 0;
+      while (true) {
+        int n = ReadFd(fds[0], rbuf.data(), rbuf.size());
+        TEST_PCHECK(n >= 0);
+        if (n == 0) {
+          break;
+        }
+        total += n;
+      }
+      read_bytes += total;
+    }));
+  }
+
+  for (auto _ : state) {
+    TEST_CHECK(WriteFd(fds[1], wbuf.data(), wbuf.size()) == size);
+  }
+
+  close(fds[1]);
+  for (auto& t : threads) {
+    t->Join();
+  }
+  close(fds[0]);
+
+  const int64_t written = static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations());
+  TEST_CHECK(read_bytes == written);
+  state.SetBytesProcessed(written);
+}
+
+BENCHMARK(BM_PipeReaders)
+    ->ArgNames({"size", "readers"})
+    ->ArgsProduct({{64, PIPE_BUF}, {1, 2, 4, 8, 16, 32}})
+    ->UseRealTime();
+
+// BM_PipeSize is BM_Pipe on a pipe enlarged with F_SETPIPE_SZ, so that large
+// writes need fewer wakeups of the reader.
+void BM_PipeSize(benchmark::State& state) {
+  int fds[2];
+  TEST_CHECK(pipe(fds) == 0);
+
+  const int size = state.range(0);
+  const int pipe_size = state.range(1);
+  if (fcntl(fds[1], F_SETPIPE_SZ, pipe_size) < 0) {
+    // Pipes can't be made larger than /proc/sys/fs/pipe-max-size without
+    // CAP_SYS_RESOURCE.
+    close(fds[0]);
+    close(fds[1]);
+    state.SkipWithError("F_SETPIPE_SZ failed");
+    return;
+  }
+  std::vector<char> wbuf(size);
+  std::vector<char> rbuf(size);
+  RandomizeBuffer(wbuf.data(), size);
+
+  ScopedThread t([&] {
+    auto const fd = fds[1];
+    for (benchmark::IterationCount i = 0; i < state.max_iterations; i++) {
+      TEST_CHECK(WriteFd(fd, wbuf.data(), wbuf.size()) == size);
+    }
+  });
+
+  for (auto _ : state) {
+    TEST_CHECK(ReadFd(fds[0], rbuf.data(), rbuf.size()) == size);
+  }
+
+  t.Join();
+
+  close(fds[0]);
+  close(fds[1]);
+
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_PipeSize)
+    ->ArgNames({"size", "pipe_size"})
+    ->ArgsProduct({{64 << 10, 256 << 10, 1 << 20}, {64 << 10, 1 << 20}})
+    ->UseRealTime();
+
+// BM_PipeLatency measures the round trip of a small write: the message is
+// written to one pipe, echoed back by another thread through a second pipe,
+// and read back. Time per iteration is the round-trip latency.
+void BM_PipeLatency(benchmark::State& state) {
+  int ping[2], pong[2];
+  TEST_CHECK(pipe(ping) == 0);
+  TEST_CHECK(pipe(pong) == 0);
+
+  const int size = state.range(0);
+  std::vector<char> wbuf(size);
+  std::vector<char> rbuf(size);
+  RandomizeBuffer(wbuf.data(), size);
+
+  // The echo thread stops at EOF on ping.
+  ScopedThread t([&] {
+    std::vector<char> buf(size);
+    while (true) {
+      int n = ReadFd(ping[0], buf.data(), buf.size());
+      TEST_PCHECK(n >= 0);
+      if (n == 0) {
+        break;
+      }
+      TEST_CHECK(WriteFd(pong[1], buf.data(), n) == n);
+    }
+  });
+
+  for (auto _ : state) {
+    TEST_CHECK(WriteFd(ping[1], wbuf.data(), wbuf.size()) == size);
+    TEST_CHECK(ReadFd(pong[0], rbuf.data(), rbuf.size()) == size);
+  }
+
+  close(ping[1]);
+  t.Join();
+  close(ping[0]);
+  close(pong[0]);
+  close(pong[1]);
+
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_PipeLatency)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(512)
+    ->Arg(PIPE_BUF)
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
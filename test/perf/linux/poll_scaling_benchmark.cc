@@ -0,0 +1,194 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/epoll_util.h"
+#include "test/util/eventfd_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// The benchmarks below all wait, with a zero timeout, on a large set of
+// eventfds of which only a fraction are ready. This is the shape of an event
+// loop serving many mostly idle connections, and shows where the per-fd cost
+// of each readiness mechanism dominates.
+
+constexpr uint64_t kOne = 1;
+
+// ReadySet is a set of eventfds with a given number of them readable.
+struct ReadySet {
+  std::vector<FileDescriptor> fds;
+  int max_fd = -1;
+  int ready = 0;
+};
+
+// NewReadySet creates nfds eventfds and makes ready_permille thousandths of
+// them, but at least one, readable. The ready fds are spread evenly over the
+// set. It returns false, after skipping the benchmark, if RLIMIT_NOFILE
+// cannot accommodate the set.
+bool NewReadySet(benchmark::State& state, int nfds, int ready_permille,
+                 ReadySet* set) {
+  // Leave headroom for the fds the test runtime itself uses.
+  const rlim_t needed = nfds + 128;
+  struct rlimit rl;
+  TEST_PCHECK(getrlimit(RLIMIT_NOFILE, &rl) == 0);
+  if (rl.rlim_cur < needed) {
+    if (rl.rlim_max < needed) {
+      state.SkipWithError("RLIMIT_NOFILE too low");
+      return false;
+    }
+    rl.rlim_cur = needed;
+    TEST_PCHECK(setrlimit(RLIMIT_NOFILE, &rl) == 0);
+  }
+
+  set->fds.reserve(nfds);
+  for (int i = 0; i < nfds; i++) {
+    set->fds.push_back(TEST_CHECK_NO_ERRNO_AND_VALUE(NewEventFD()));
+    set->max_fd = std::max(set->max_fd, set->fds.back().get());
+  }
+  set->ready = std::max<int64_t>(
+      1, static_cast<int64_t>(nfds) * ready_permille / 1000);
+  for (int i = 0; i < set->ready; i++) {
+    const int fd = set->fds[static_cast<int64_t>(i) * nfds / set->ready].get();
+    TEST_PCHECK(WriteFd(fd, &kOne, sizeof(kOne)) == sizeof(kOne));
+  }
+  return true;
+}
+
+std::vector<struct pollfd> PollFDs(const ReadySet& set) {
+  std::vector<struct pollfd> pfds;
+  pfds.reserve(set.fds.size());
+  for (const auto& fd : set.fds) {
+    pfds.push_back({.fd = fd.get(), .events = POLLIN});
+  }
+  return pfds;
+}
+
+// SetItems reports the rate at which registered fds are checked, which stays
+// flat for mechanisms whose cost is independent of the set size.
+void SetItems(benchmark::State& state, const ReadySet& set) {
+  state.SetItemsProcessed(state.iterations() * set.fds.size());
+  state.counters["ready"] = set.ready;
+}
+
+void BM_PollScaling(benchmark::State& state) {
+  ReadySet set;
+  if (!NewReadySet(state, state.range(0), state.range(1), &set)) {
+    return;
+  }
+  std::vector<struct pollfd> pfds = PollFDs(set);
+
+  for (auto _ : state) {
+    TEST_CHECK(poll(pfds.data(), pfds.size(), 0) == set.ready);
+  }
+  SetItems(state, set);
+}
+
+void BM_PpollScaling(benchmark::State& state) {
+  ReadySet set;
+  if (!NewReadySet(state, state.range(0), state.range(1), &set)) {
+    return;
+  }
+  std::vector<struct pollfd> pfds = PollFDs(set);
+  struct timespec timeout = {};
+  sigset_t mask;
+  sigemptyset(&mask);
+
+  for (auto _ : state) {
+    TEST_CHECK(ppoll(pfds.data(), pfds.size(), &timeout, &mask) == set.ready);
+  }
+  SetItems(state, set);
+}
+
+// BM_PselectScaling uses fd sets sized to the largest fd rather than
+// FD_SETSIZE, as servers that select(2) on more than 1024 fds must.
+void BM_PselectScaling(benchmark::State& state) {
+  ReadySet set;
+  if (!NewReadySet(state, state.range(0), state.range(1), &set)) {
+    return;
+  }
+  constexpr int kBitsPerWord = 8 * sizeof(fd_mask);
+  const int nfds = set.max_fd + 1;
+  std::vector<fd_mask> want((nfds + kBitsPerWord - 1) / kBitsPerWord);
+  for (const auto& fd : set.fds) {
+    want[fd.get() / kBitsPerWord] |= fd_mask{1} << (fd.get() % kBitsPerWord);
+  }
+  std::vector<fd_mask> readfds(want.size());
+  const size_t bytes = want.size() * sizeof(fd_mask);
+  struct timespec timeout = {};
+  sigset_t mask;
+  sigemptyset(&mask);
+
+  for (auto _ : state) {
+    // select(2) overwrites its input set, so callers rebuild it every time.
+    memcpy(readfds.data(), want.data(), bytes);
+    TEST_CHECK(pselect(nfds, reinterpret_cast<fd_set*>(readfds.data()),
+                       /*writefds=*/nullptr, /*exceptfds=*/nullptr, &timeout,
+                       &mask) == set.ready);
+  }
+  SetItems(state, set);
+}
+
+void BM_EpollScaling(benchmark::State& state) {
+  ReadySet set;
+  if (!NewReadySet(state, state.range(0), state.range(1), &set)) {
+    return;
+  }
+  auto epollfd = TEST_CHECK_NO_ERRNO_AND_VALUE(NewEpollFD());
+  for (const auto& fd : set.fds) {
+    TEST_CHECK_NO_ERRNO(
+        RegisterEpollFD(epollfd.get(), fd.get(), EPOLLIN, fd.get()));
+  }
+  std::vector<struct epoll_event> events(set.ready);
+
+  for (auto _ : state) {
+    TEST_CHECK(epoll_wait(epollfd.get(), events.data(), events.size(), 0) ==
+               set.ready);
+  }
+  SetItems(state, set);
+}
+
+void Args(benchmark::internal::Benchmark* bm) {
+  bm->ArgsProduct({{1024, 4096, 16384, 65536}, {1, 10, 1000}})
+      ->ArgNames({"fds", "ready_permille"});
+}
+
+BENCHMARK(BM_PollScaling)->Apply(Args);
+BENCHMARK(BM_PpollScaling)->Apply(Args);
+BENCHMARK(BM_PselectScaling)->Apply(Args);
+BENCHMARK(BM_EpollScaling)->Apply(Args);
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
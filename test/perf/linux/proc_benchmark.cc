@@ -0,0 +1,284 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/cgroup_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/fs_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/proc_util.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks model a monitoring agent that periodically scrapes procfs:
+// each read opens the file, reads it to the end and closes it, so the cost of
+// generating the contents dominates.
+
+// FragmentAddressSpace creates about count extra VMAs in the calling process,
+// by changing the protection of every other page of one mapping so that no
+// two neighbours merge. It only uses async-signal-safe calls, so that it can
+// run in a forked child, and returns false on failure.
+bool FragmentAddressSpace(int count) {
+  if (count == 0) {
+    return true;
+  }
+  const size_t page = kPageSize;
+  void* addr = mmap(nullptr, count * page, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  char* base = static_cast<char*>(addr);
+  for (int i = 1; i < count; i += 2) {
+    if (mprotect(base + i * page, page, PROT_READ) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Children is a set of idle child processes to be inspected through procfs.
+class Children {
+ public:
+  // Forks count children, each of which fragments its address space into
+  // about mappings VMAs before waiting to be killed.
+  Children(int count, int mappings) {
+    int pipefds[2];
+    TEST_PCHECK(pipe(pipefds) == 0);
+    for (int i = 0; i < count; i++) {
+      pid_t pid = fork();
+      if (pid == 0) {
+        close(pipefds[0]);
+        char ok = FragmentAddressSpace(mappings);
+        if (write(pipefds[1], &ok, 1) != 1) {
+          _exit(1);
+        }
+        while (true) {
+          pause();
+        }
+      }
+      TEST_PCHECK(pid > 0);
+      pids_.push_back(pid);
+    }
+    close(pipefds[1]);
+    for (int i = 0; i < count; i++) {
+      char ok;
+      TEST_PCHECK(ReadFd(pipefds[0], &ok, 1) == 1);
+      TEST_CHECK(ok);
+    }
+    close(pipefds[0]);
+  }
+
+  ~Children() {
+    for (pid_t pid : pids_) {
+      kill(pid, SIGKILL);
+    }
+    for (pid_t pid : pids_) {
+      int status;
+      RetryEINTR(waitpid)(pid, &status, 0);
+    }
+  }
+
+  const std::vector<pid_t>& pids() const { return pids_; }
+
+ private:
+  std::vector<pid_t> pids_;
+};
+
+// Reads path to the end and returns the number of bytes read.
+size_t ReadProcFile(const std::string& path) {
+  std::string contents = TEST_CHECK_NO_ERRNO_AND_VALUE(GetContents(path));
+  return contents.size();
+}
+
+const char* const kPIDFiles[] = {"stat", "status", "smaps", "cgroup"};
+
+// BM_ProcPIDRead reads one /proc/[pid] file of each of a number of processes
+// in turn, as an agent scraping every process on a node does.
+void BM_ProcPIDRead(benchmark::State& state) {
+  const std::string file = kPIDFiles[state.range(0)];
+  const int procs = state.range(1);
+  const int mappings = state.range(2);
+  state.SetLabel(file);
+
+  Children children(procs, mappings);
+  std::vector<std::string> paths;
+  for (pid_t pid : children.pids()) {
+    paths.push_back(absl::StrCat("/proc/", pid, "/", file));
+  }
+
+  // Check that the files parse as expected before timing them.
+  if (file == "smaps") {
+    auto entries =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(ReadProcSmaps(children.pids()[0]));
+    TEST_CHECK(entries.size() >= static_cast<size_t>(mappings));
+  } else if (file == "cgroup") {
+    TEST_CHECK_NO_ERRNO(ProcPIDCgroupEntries(children.pids()[0]));
+  }
+
+  size_t bytes = 0;
+  size_t next = 0;
+  for (auto _ : state) {
+    bytes += ReadProcFile(paths[next]);
+    if (++next == paths.size()) {
+      next = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_ProcPIDRead)
+    ->ArgsProduct({{0, 1, 2, 3}, {1, 64, 256}, {0}})
+    ->ArgsProduct({{2}, {1, 64}, {1024, 16384}})
+    ->ArgNames({"file", "procs", "mappings"})
+    ->UseRealTime();
+
+// BM_ProcMapsParse parses /proc/[pid]/maps of a process with about mappings
+// VMAs, building a vector of ProcMapsEntry with ParseProcMaps (streaming 0)
+// or visiting each entry in place with VisitProcMaps (streaming 1). The file
+// is read once up front so that only parsing is timed.
+void BM_ProcMapsParse(benchmark::State& state) {
+  const bool streaming = state.range(0);
+  const int mappings = state.range(1);
+  Children children(1, mappings);
+  const std::string contents = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      GetContents(absl::StrCat("/proc/", children.pids()[0], "/maps")));
+
+  size_t entries = 0;
+  for (auto _ : state) {
+    if (streaming) {
+      uint64_t sum = 0;
+      TEST_CHECK_NO_ERRNO(VisitProcMaps(contents, [&](const ProcMapsView& e) {
+        sum += e.end - e.start;
+        entries++;
+      }));
+      benchmark::DoNotOptimize(sum);
+    } else {
+      auto parsed = TEST_CHECK_NO_ERRNO_AND_VALUE(ParseProcMaps(contents));
+      entries += parsed.size();
+      benchmark::DoNotOptimize(parsed);
+    }
+  }
+  state.SetItemsProcessed(entries);
+  state.SetBytesProcessed(state.iterations() * contents.size());
+}
+
+BENCHMARK(BM_ProcMapsParse)
+    ->ArgsProduct({{0, 1}, {1024, 16384, 60000}})
+    ->ArgNames({"streaming", "mappings"});
+
+// BM_ProcSmapsParse is BM_ProcMapsParse for /proc/[pid]/smaps, with
+// ParseProcSmaps and VisitProcSmaps.
+void BM_ProcSmapsParse(benchmark::State& state) {
+  const bool streaming = state.range(0);
+  const int mappings = state.range(1);
+  Children children(1, mappings);
+  const std::string contents = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      GetContents(absl::StrCat("/proc/", children.pids()[0], "/smaps")));
+
+  size_t entries = 0;
+  for (auto _ : state) {
+    if (streaming) {
+      size_t rss_kb = 0;
+      TEST_CHECK_NO_ERRNO(
+          VisitProcSmaps(contents, [&](const ProcSmapsView& e) {
+            rss_kb += e.rss_kb;
+            entries++;
+          }));
+      benchmark::DoNotOptimize(rss_kb);
+    } else {
+      auto parsed = TEST_CHECK_NO_ERRNO_AND_VALUE(ParseProcSmaps(contents));
+      entries += parsed.size();
+      benchmark::DoNotOptimize(parsed);
+    }
+  }
+  state.SetItemsProcessed(entries);
+  state.SetBytesProcessed(state.iterations() * contents.size());
+}
+
+BENCHMARK(BM_ProcSmapsParse)
+    ->ArgsProduct({{0, 1}, {1024, 16384, 60000}})
+    ->ArgNames({"streaming", "mappings"});
+
+// BM_ProcNetTCP reads /proc/net/tcp with a number of listening sockets open.
+void BM_ProcNetTCP(benchmark::State& state) {
+  const int sockets = state.range(0);
+
+  // Leave headroom for the fds the test runtime itself uses.
+  const rlim_t needed = sockets + 128;
+  struct rlimit rl;
+  TEST_PCHECK(getrlimit(RLIMIT_NOFILE, &rl) == 0);
+  if (rl.rlim_cur < needed) {
+    if (rl.rlim_max < needed) {
+      state.SkipWithError("RLIMIT_NOFILE too low");
+      return;
+    }
+    rl.rlim_cur = needed;
+    TEST_PCHECK(setrlimit(RLIMIT_NOFILE, &rl) == 0);
+  }
+
+  std::vector<FileDescriptor> fds;
+  fds.reserve(sockets);
+  for (int i = 0; i < sockets; i++) {
+    FileDescriptor fd(socket(AF_INET, SOCK_STREAM, 0));
+    TEST_PCHECK(fd.get() >= 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_PCHECK(bind(fd.get(), reinterpret_cast<struct sockaddr*>(&addr),
+                     sizeof(addr)) == 0);
+    TEST_PCHECK(listen(fd.get(), 1) == 0);
+    fds.push_back(std::move(fd));
+  }
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    bytes += ReadProcFile("/proc/net/tcp");
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_ProcNetTCP)
+    ->Arg(0)
+    ->Arg(1024)
+    ->Arg(16384)
+    ->ArgName("sockets")
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
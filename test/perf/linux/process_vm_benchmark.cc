@@ -0,0 +1,148 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/logging.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the bandwidth of process_vm_readv and
+// process_vm_writev, as used in bulk by profilers and crash dumpers, across
+// transfer sizes, numbers of iovecs on either side, and concurrent callers.
+
+// The largest transfer.
+constexpr size_t kMaxBytes = 256 << 20;
+
+// Remote is a child process whose memory is read and written. It has
+// kMaxBytes of memory at the same address as Remote::mem in this process,
+// since it is mapped before fork.
+struct Remote {
+  pid_t pid;
+  char* mem;
+};
+
+Remote* NewRemote() {
+  void* mem = mmap(nullptr, kMaxBytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  TEST_PCHECK(mem != MAP_FAILED);
+  memset(mem, 'a', kMaxBytes);
+  const pid_t pid = fork();
+  TEST_PCHECK(pid >= 0);
+  if (pid == 0) {
+    // Don't outlive the benchmark.
+    TEST_PCHECK(prctl(PR_SET_PDEATHSIG, SIGKILL) == 0);
+    while (true) {
+      pause();
+    }
+  }
+  return new Remote{pid, static_cast<char*>(mem)};
+}
+
+// GetRemote returns the Remote shared by all benchmarks, creating it on first
+// use by any thread.
+Remote* GetRemote() {
+  static Remote* remote = NewRemote();
+  return remote;
+}
+
+// SplitIovecs returns n iovecs covering the bytes at base.
+std::vector<struct iovec> SplitIovecs(char* base, size_t bytes, size_t n) {
+  std::vector<struct iovec> iovs(n);
+  const size_t len = bytes / n;
+  for (size_t i = 0; i < n; i++) {
+    iovs[i].iov_base = base + i * len;
+    iovs[i].iov_len = (i == n - 1) ? bytes - i * len : len;
+  }
+  return iovs;
+}
+
+void ProcessVM(benchmark::State& state, bool write) {
+  const size_t bytes = state.range(0);
+  const size_t local_iovecs = state.range(1);
+  const size_t remote_iovecs = state.range(2);
+  Remote* remote = GetRemote();
+
+  // Each thread transfers to or from its own part of the remote memory.
+  const size_t remote_off = (state.thread_index() * bytes) % kMaxBytes;
+  const size_t len = std::min(bytes, kMaxBytes - remote_off);
+  std::vector<char> buf(len, 'b');
+  std::vector<struct iovec> local = SplitIovecs(buf.data(), len, local_iovecs);
+  std::vector<struct iovec> rem =
+      SplitIovecs(remote->mem + remote_off, len, remote_iovecs);
+
+  for (auto _ : state) {
+    const ssize_t n =
+        write ? process_vm_writev(remote->pid, local.data(), local.size(),
+                                  rem.data(), rem.size(), 0)
+              : process_vm_readv(remote->pid, local.data(), local.size(),
+                                 rem.data(), rem.size(), 0);
+    TEST_PCHECK(n == static_cast<ssize_t>(len));
+  }
+
+  state.SetBytesProcessed(state.iterations() * len);
+}
+
+void BM_ProcessVMReadv(benchmark::State& state) { ProcessVM(state, false); }
+
+void BM_ProcessVMWritev(benchmark::State& state) { ProcessVM(state, true); }
+
+void SizeArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"bytes", "local_iovecs", "remote_iovecs"});
+  for (size_t bytes = 4 << 10; bytes <= kMaxBytes; bytes *= 16) {
+    bench->Args({static_cast<int64_t>(bytes), 1, 1});
+    // A fragmented side gets the maximum number of iovecs.
+    bench->Args({static_cast<int64_t>(bytes), IOV_MAX, 1});
+    bench->Args({static_cast<int64_t>(bytes), 1, IOV_MAX});
+    bench->Args({static_cast<int64_t>(bytes), IOV_MAX, IOV_MAX});
+  }
+}
+
+BENCHMARK(BM_ProcessVMReadv)->Apply(SizeArgs)->UseRealTime();
+
+BENCHMARK(BM_ProcessVMWritev)->Apply(SizeArgs)->UseRealTime();
+
+// Concurrent transfers of 1MB between the same pair of processes.
+BENCHMARK(BM_ProcessVMReadv)
+    ->ArgNames({"bytes", "local_iovecs", "remote_iovecs"})
+    ->Args({1 << 20, 1, 1})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK(BM_ProcessVMWritev)
+    ->ArgNames({"bytes", "local_iovecs", "remote_iovecs"})
+    ->Args({1 << 20, 1, 1})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
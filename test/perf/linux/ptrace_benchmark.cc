@@ -0,0 +1,226 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <signal.h>
+#include <stddef.h>
+#include <sys/prctl.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/logging.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the cost of being traced: the syscall throughput
+// of a tracee under the various ways a tracer can intercept syscalls, and
+// the bandwidth with which a tracer can read tracee memory.
+
+// PTRACE_SYSEMU isn't defined by all libcs.
+#ifndef PTRACE_SYSEMU
+#define PTRACE_SYSEMU 31
+#endif
+
+// Tracee is a child process traced by the calling thread. It runs fn after
+// stopping with SIGSTOP, and is killed when the Tracee is destroyed.
+class Tracee {
+ public:
+  explicit Tracee(std::function<void()> fn) {
+    pid_ = fork();
+    TEST_PCHECK(pid_ >= 0);
+    if (pid_ == 0) {
+      TEST_PCHECK(ptrace(PTRACE_TRACEME, 0, 0, 0) == 0);
+      TEST_PCHECK(raise(SIGSTOP) == 0);
+      fn();
+      _exit(0);
+    }
+    int status;
+    TEST_PCHECK(RetryEINTR(waitpid)(pid_, &status, 0) == pid_);
+    TEST_CHECK(WIFSTOPPED(status) && WSTOPSIG(status) == SIGSTOP);
+  }
+
+  ~Tracee() {
+    TEST_PCHECK(kill(pid_, SIGKILL) == 0);
+    int status;
+    TEST_PCHECK(RetryEINTR(waitpid)(pid_, &status, 0) == pid_);
+  }
+
+  pid_t pid() const { return pid_; }
+
+  // Resume resumes the tracee with the given ptrace request, and waits for
+  // it to stop again. It returns the wait status.
+  int Resume(int request) {
+    TEST_PCHECK(ptrace(static_cast<__ptrace_request>(request), pid_, 0, 0) ==
+                0);
+    int status;
+    TEST_PCHECK(RetryEINTR(waitpid)(pid_, &status, 0) == pid_);
+    TEST_CHECK(WIFSTOPPED(status));
+    return status;
+  }
+
+ private:
+  pid_t pid_;
+};
+
+void GetpidForever() {
+  while (true) {
+    syscall(SYS_getpid);
+  }
+}
+
+enum TraceMode {
+  // PTRACE_SYSCALL, which stops at both syscall entry and exit.
+  kSyscall,
+
+  // PTRACE_CONT with PTRACE_O_TRACESECCOMP and a filter that only returns
+  // SECCOMP_RET_TRACE for getpid, which stops once at syscall entry.
+  kTraceSeccomp,
+
+  // PTRACE_SYSEMU, which stops once at syscall entry and skips the syscall,
+  // as done by tracers that emulate syscalls themselves.
+  kSysemu,
+};
+
+// InstallTraceGetpidFilter installs a seccomp filter that returns
+// SECCOMP_RET_TRACE for getpid and allows all other syscalls.
+void InstallTraceGetpidFilter() {
+  struct sock_filter filter[] = {
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, SYS_getpid, 0, 1),
+      BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRACE),
+      BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+  };
+  struct sock_fprog prog;
+  prog.len = sizeof(filter) / sizeof(filter[0]);
+  prog.filter = filter;
+  TEST_PCHECK(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0);
+  TEST_PCHECK(syscall(__NR_seccomp, SECCOMP_SET_MODE_FILTER, 0, &prog) == 0);
+}
+
+// BM_TracedGetpid measures the rate at which a tracee makes getpid calls,
+// with the tracer resuming it from each stop without doing anything else.
+void BM_TracedGetpid(benchmark::State& state) {
+  const TraceMode mode = static_cast<TraceMode>(state.range(0));
+  Tracee tracee([mode] {
+    if (mode == kTraceSeccomp) {
+      InstallTraceGetpidFilter();
+    }
+    GetpidForever();
+  });
+
+  long options = PTRACE_O_EXITKILL;
+  if (mode == kTraceSeccomp) {
+    options |= PTRACE_O_TRACESECCOMP;
+  }
+  TEST_PCHECK(ptrace(PTRACE_SETOPTIONS, tracee.pid(), 0, options) == 0);
+
+  for (auto _ : state) {
+    switch (mode) {
+      case kSyscall:
+        // Entry and exit.
+        tracee.Resume(PTRACE_SYSCALL);
+        tracee.Resume(PTRACE_SYSCALL);
+        break;
+      case kTraceSeccomp: {
+        const int status = tracee.Resume(PTRACE_CONT);
+        TEST_CHECK(status >> 8 == (SIGTRAP | (PTRACE_EVENT_SECCOMP << 8)));
+        break;
+      }
+      case kSysemu:
+        tracee.Resume(PTRACE_SYSEMU);
+        break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_TracedGetpid)
+    ->ArgName("mode")
+    ->Arg(kSyscall)
+    ->Arg(kTraceSeccomp)
+    ->Arg(kSysemu)
+    ->UseRealTime();
+
+// Tracee memory read by the memory benchmarks. It is allocated before fork,
+// so it has the same address in the tracee.
+std::vector<char>* TraceeMemory(size_t size) {
+  static std::vector<char>* mem = nullptr;
+  if (mem == nullptr || mem->size() < size) {
+    delete mem;
+    mem = new std::vector<char>(size, 'a');
+  }
+  return mem;
+}
+
+// BM_PtracePeekData reads tracee memory a word at a time, as debuggers and
+// strace do without process_vm_readv.
+void BM_PtracePeekData(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const char* addr = TraceeMemory(size)->data();
+  Tracee tracee([] { pause(); });
+
+  for (auto _ : state) {
+    for (size_t off = 0; off < size; off += sizeof(long)) {
+      errno = 0;
+      long word = ptrace(PTRACE_PEEKDATA, tracee.pid(), addr + off, 0);
+      TEST_PCHECK(errno == 0);
+      benchmark::DoNotOptimize(word);
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_PtracePeekData)->Range(4 << 10, 1 << 20)->UseRealTime();
+
+// BM_ProcessVMReadv reads the same tracee memory as BM_PtracePeekData with a
+// single process_vm_readv.
+void BM_ProcessVMReadv(benchmark::State& state) {
+  const size_t size = state.range(0);
+  char* addr = TraceeMemory(size)->data();
+  Tracee tracee([] { pause(); });
+  std::vector<char> buf(size);
+
+  for (auto _ : state) {
+    struct iovec local = {buf.data(), size};
+    struct iovec remote = {addr, size};
+    TEST_PCHECK(process_vm_readv(tracee.pid(), &local, 1, &remote, 1, 0) ==
+                static_cast<ssize_t>(size));
+  }
+
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_ProcessVMReadv)->Range(4 << 10, 1 << 20)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
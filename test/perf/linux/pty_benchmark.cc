@@ -0,0 +1,172 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/pty_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure throughput through a pty, as used by interactive
+// shells and log streaming through exec sessions, so that the cost of line
+// discipline processing is visible.
+//
+// Data written to the master is input, processed according to ICANON and
+// ECHO and read from the replica. Data written to the replica is output,
+// processed according to OPOST and read from the master.
+
+enum Direction {
+  kMasterToReplica,
+  kReplicaToMaster,
+};
+
+// Bytes written per write(2) call; this is the size of the line discipline's
+// queues.
+constexpr size_t kWriteSize = 4096;
+
+// Length of each line written, including the newline.
+constexpr size_t kLineLen = 64;
+
+// Bytes read per benchmark iteration.
+constexpr int64_t kBytesPerIteration = 64 << 10;
+
+// Byte written to the replica to stop the echo drainer. It is never part of
+// the data, and passes through output processing unchanged.
+constexpr char kStop = '\x01';
+
+// SetMode configures the pty through its replica. Canonical mode is the
+// default for a new pty, with ICANON and OPOST/ONLCR; raw mode is as set by
+// cfmakeraw(3), as done by terminal emulators and ssh.
+void SetMode(int replica, bool canonical, bool echo) {
+  struct termios t;
+  TEST_PCHECK(tcgetattr(replica, &t) == 0);
+  if (!canonical) {
+    cfmakeraw(&t);
+  }
+  if (echo) {
+    t.c_lflag |= ECHO;
+  } else {
+    t.c_lflag &= ~ECHO;
+  }
+  TEST_PCHECK(tcsetattr(replica, TCSANOW, &t) == 0);
+}
+
+void BM_Pty(benchmark::State& state) {
+  const Direction dir = static_cast<Direction>(state.range(0));
+  const bool canonical = state.range(1);
+  const bool echo = state.range(2);
+
+  FileDescriptor master =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open("/dev/ptmx", O_RDWR));
+  FileDescriptor replica = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      OpenReplica(master, O_RDWR | O_NOCTTY));
+  SetMode(replica.get(), canonical, echo);
+
+  const int wfd = dir == kMasterToReplica ? master.get() : replica.get();
+  const int rfd = dir == kMasterToReplica ? replica.get() : master.get();
+
+  // Echoed input is queued for reading from the master, and must be drained
+  // so that the queue doesn't fill up.
+  std::unique_ptr<ScopedThread> drainer;
+  if (echo && dir == kMasterToReplica) {
+    drainer = std::make_unique<ScopedThread>([&] {
+      std::vector<char> buf(kWriteSize);
+      while (true) {
+        const ssize_t n = ReadFd(master.get(), buf.data(), buf.size());
+        TEST_PCHECK(n > 0);
+        // Input may still be echoed after kStop is written.
+        if (std::find(buf.begin(), buf.begin() + n, kStop) !=
+            buf.begin() + n) {
+          return;
+        }
+      }
+    });
+  }
+
+  // The writer is a separate process, so that it can be killed while blocked
+  // in write(2) once the benchmark is done.
+  std::string data;
+  while (data.size() < kWriteSize) {
+    data += std::string(kLineLen - 1, 'a') + "\n";
+  }
+  const pid_t pid = fork();
+  TEST_PCHECK(pid >= 0);
+  if (pid == 0) {
+    while (true) {
+      TEST_PCHECK(WriteFd(wfd, data.data(), data.size()) ==
+                  static_cast<ssize_t>(data.size()));
+    }
+  }
+
+  std::vector<char> buf(kWriteSize * 2);
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    // In canonical mode, each read(2) of the replica returns at most one
+    // line.
+    for (int64_t n = 0; n < kBytesPerIteration;) {
+      const ssize_t r = ReadFd(rfd, buf.data(), buf.size());
+      TEST_PCHECK(r > 0);
+      n += r;
+      bytes += r;
+    }
+  }
+
+  TEST_PCHECK(kill(pid, SIGKILL) == 0);
+  int status;
+  TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+  TEST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+  if (drainer) {
+    TEST_PCHECK(WriteFd(replica.get(), &kStop, 1) == 1);
+    drainer->Join();
+  }
+
+  state.SetBytesProcessed(bytes);
+}
+
+void PtyArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"dir", "canonical", "echo"});
+  for (int canonical : {0, 1}) {
+    for (int echo : {0, 1}) {
+      bench->Args({kMasterToReplica, canonical, echo});
+    }
+    // ECHO only applies to input.
+    bench->Args({kReplicaToMaster, canonical, 0});
+  }
+}
+
+BENCHMARK(BM_Pty)->Apply(PtyArgs)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -18,21 +18,34 @@
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "absl/flags/flag.h"
+#include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
 #include "test/util/file_descriptor.h"
 #include "test/util/logging.h"
 #include "test/util/temp_path.h"
 #include "test/util/test_util.h"
 
+ABSL_FLAG(uint64_t, randread_file_size, 1ULL << 30,
+          "Size of the file read from at random positions. Set it larger "
+          "than the sentry's page cache to measure uncached reads.");
+
 namespace gvisor {
 namespace testing {
 
 namespace {
 
-// Create a 1GB file that will be read from at random positions. This should
-// invalid any performance gains from caching.
-const uint64_t kFileSize = 1ULL << 30;
+// The file read from at random positions is --randread_file_size bytes, 1GB
+// by default. This should invalid any performance gains from caching.
+uint64_t FileSize() { return absl::GetFlag(FLAGS_randread_file_size); }
 
 // How many bytes to write at once to initialize the file used to read from.
 const uint32_t kWriteSize = 65536;
@@ -70,7 +83,7 @@ GlobalState& GetGlobalState() {
       // The actual file size is the maximum random seek range (kFileSize) + the
       // maximum read size so we can read that number of bytes at the end of the
       // file.
-      new GlobalState(CreateFile(kFileSize + kMaxRead));
+      new GlobalState(CreateFile(FileSize() + kMaxRead));
   return *state;
 }
 
@@ -85,7 +98,7 @@ void BM_RandRead(benchmark::State& state) {
   unsigned int seed = 1;
   for (auto _ : state) {
     TEST_CHECK(PreadFd(fd.get(), buf.data(), buf.size(),
-                       rand_r(&seed) % (kFileSize - buf.size())) == size);
+                       rand_r(&seed) % (FileSize() - buf.size())) == size);
   }
 
   state.SetBytesProcessed(static_cast<int64_t>(size) *
@@ -94,6 +107,150 @@ void BM_RandRead(benchmark::State& state) {
 
 BENCHMARK(BM_RandRead)->Range(1, kMaxRead)->UseRealTime();
 
+// RandomOffset returns a random offset in the file aligned to align.
+uint64_t RandomOffset(absl::InsecureBitGen& gen, uint64_t align) {
+  return absl::Uniform<uint64_t>(gen, 0, FileSize() / align) * align;
+}
+
+// Block sizes for the fio-like benchmarks below.
+void BlockSizes(benchmark::internal::Benchmark* b) {
+  b->Arg(4 << 10)->Arg(64 << 10)->ArgName("bs");
+}
+
+// BM_RandReadThreads issues random block-aligned preads from every benchmark
+// thread on its own file descriptor. Reads are synchronous, so the number of
+// threads is the I/O queue depth. Items per second are IOPS.
+void BM_RandReadThreads(benchmark::State& state) {
+  const int size = state.range(0);
+
+  GlobalState& global_state = GetGlobalState();
+  FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(global_state.tmpfile.path(), O_RDONLY));
+  std::vector<char> buf(size);
+
+  absl::InsecureBitGen gen;
+  LatencyRecorder latency(state, absl::StrCat("BM_RandReadThreads/", size));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    TEST_CHECK(PreadFd(fd.get(), buf.data(), buf.size(),
+                       RandomOffset(gen, size)) == size);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RandReadThreads)
+    ->Apply(BlockSizes)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+// BM_RandReadV2 is BM_RandReadThreads using preadv2 with the given flags:
+// none (0), RWF_NOWAIT (1) or RWF_HIPRI (2). With RWF_NOWAIT, reads that
+// would block fail with EAGAIN and are counted in the "eagain" counter
+// instead of as I/Os.
+void BM_RandReadV2(benchmark::State& state) {
+  const int size = state.range(0);
+  int flags = 0;
+  switch (state.range(1)) {
+    case 1:
+      flags = RWF_NOWAIT;
+      break;
+    case 2:
+      flags = RWF_HIPRI;
+      break;
+  }
+
+  GlobalState& global_state = GetGlobalState();
+  FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(global_state.tmpfile.path(), O_RDONLY));
+  std::vector<char> buf(size);
+  struct iovec iov = {buf.data(), buf.size()};
+
+  absl::InsecureBitGen gen;
+  if (preadv2(fd.get(), &iov, 1, 0, flags) < 0 && errno != EAGAIN) {
+    state.SkipWithError(
+        absl::StrCat("preadv2 flags unsupported: ", strerror(errno)).c_str());
+    return;
+  }
+
+  int64_t eagain = 0;
+  LatencyRecorder latency(state, absl::StrCat("BM_RandReadV2/", size, "/",
+                                              state.range(1)));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    int n = preadv2(fd.get(), &iov, 1, RandomOffset(gen, size), flags);
+    if (n < 0 && errno == EAGAIN && (flags & RWF_NOWAIT)) {
+      eagain++;
+      continue;
+    }
+    TEST_CHECK(n == size);
+  }
+
+  state.SetItemsProcessed(state.iterations() - eagain);
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          (state.iterations() - eagain));
+  state.counters["eagain"] = benchmark::Counter(eagain);
+}
+
+BENCHMARK(BM_RandReadV2)
+    ->ArgsProduct({{4 << 10, 64 << 10}, {0, 1, 2}})
+    ->ArgNames({"bs", "flags"})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// BM_RandReadDirect is BM_RandReadThreads with O_DIRECT. The buffer and
+// offsets are aligned to the second argument, 512 bytes (the traditional
+// sector size) or 4096 bytes (the page size). Reads with an alignment the
+// backing device rejects fail with EINVAL, and the benchmark is skipped.
+void BM_RandReadDirect(benchmark::State& state) {
+  const int size = state.range(0);
+  const int align = state.range(1);
+
+  GlobalState& global_state = GetGlobalState();
+  int raw = open(global_state.tmpfile.path().c_str(), O_RDONLY | O_DIRECT);
+  if (raw < 0) {
+    state.SkipWithError(
+        absl::StrCat("O_DIRECT unsupported: ", strerror(errno)).c_str());
+    return;
+  }
+  FileDescriptor fd(raw);
+
+  // Offset the buffer by align from a page boundary, so that it is aligned
+  // to align but no more.
+  void* mem;
+  TEST_CHECK(posix_memalign(&mem, 2 * kPageSize, size + kPageSize) == 0);
+  char* buf = static_cast<char*>(mem) + (align % kPageSize);
+
+  absl::InsecureBitGen gen;
+  if (pread(fd.get(), buf, size, align) != size) {
+    state.SkipWithError(
+        absl::StrCat("O_DIRECT read failed: ", strerror(errno)).c_str());
+    free(mem);
+    return;
+  }
+
+  LatencyRecorder latency(state, absl::StrCat("BM_RandReadDirect/", size,
+                                              "/", align));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    TEST_CHECK(PreadFd(fd.get(), buf, size, RandomOffset(gen, align)) ==
+               size);
+  }
+  free(mem);
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RandReadDirect)
+    ->ArgsProduct({{4 << 10, 64 << 10}, {512, 4096}})
+    ->ArgNames({"bs", "align"})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
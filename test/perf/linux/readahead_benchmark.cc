@@ -0,0 +1,158 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_ReadHinted measures reading a file in the test's temporary directory
+// (host-backed) sequentially or randomly, with and without the access
+// pattern hints given by posix_fadvise(2) and readahead(2), to tell whether
+// the hints make reads cheaper, e.g. by reducing gofer round-trips.
+//
+// Before each iteration, the file is reopened and dropped from the page cache
+// with POSIX_FADV_DONTNEED, so that natively each iteration reads from a cold
+// cache. Where POSIX_FADV_DONTNEED is ignored the file stays cached, and the
+// results with and without hints only differ by the cost of the hints.
+
+enum Pattern {
+  kSequential,
+  kRandom,
+};
+
+enum Hint {
+  kNoHint,
+  kFadvSequential,
+  kFadvWillneed,
+  kReadahead,
+  kFadvRandom,
+};
+
+constexpr int64_t kFileSize = 64 << 20;
+
+// Size of each read: sequential reads use large buffers, as streaming
+// readers do, while random reads are page sized, as in databases.
+constexpr int64_t kSequentialReadSize = 64 << 10;
+constexpr int64_t kRandomReadSize = 4 << 10;
+
+// Number of random reads per iteration, covering a quarter of the file.
+constexpr int kRandomReads = kFileSize / kRandomReadSize / 4;
+
+void BM_ReadHinted(benchmark::State& state) {
+  const Pattern pattern = static_cast<Pattern>(state.range(0));
+  const Hint hint = static_cast<Hint>(state.range(1));
+
+  const TempPath path = TEST_CHECK_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  {
+    const FileDescriptor fd =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_WRONLY));
+    const std::string chunk(1 << 20, 'a');
+    for (int64_t off = 0; off < kFileSize; off += chunk.size()) {
+      TEST_CHECK(WriteFd(fd.get(), chunk.data(), chunk.size()) ==
+                 static_cast<ssize_t>(chunk.size()));
+    }
+    TEST_PCHECK(fsync(fd.get()) == 0);
+  }
+
+  std::vector<int64_t> offsets;
+  if (pattern == kRandom) {
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int64_t> page(
+        0, kFileSize / kRandomReadSize - 1);
+    for (int i = 0; i < kRandomReads; i++) {
+      offsets.push_back(page(rng) * kRandomReadSize);
+    }
+  }
+  const int64_t read_size =
+      pattern == kSequential ? kSequentialReadSize : kRandomReadSize;
+  std::vector<char> buf(read_size);
+
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    FileDescriptor fd =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDONLY));
+    TEST_CHECK(posix_fadvise(fd.get(), 0, 0, POSIX_FADV_DONTNEED) == 0);
+    state.ResumeTiming();
+
+    // The hint is part of the timed region, as it is of a reader's.
+    switch (hint) {
+      case kNoHint:
+        break;
+      case kFadvSequential:
+        TEST_CHECK(posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL) == 0);
+        break;
+      case kFadvWillneed:
+        TEST_CHECK(posix_fadvise(fd.get(), 0, 0, POSIX_FADV_WILLNEED) == 0);
+        break;
+      case kReadahead:
+        TEST_PCHECK(readahead(fd.get(), 0, kFileSize) == 0);
+        break;
+      case kFadvRandom:
+        TEST_CHECK(posix_fadvise(fd.get(), 0, 0, POSIX_FADV_RANDOM) == 0);
+        break;
+    }
+
+    if (pattern == kSequential) {
+      for (int64_t off = 0; off < kFileSize; off += read_size) {
+        TEST_CHECK(ReadFd(fd.get(), buf.data(), read_size) == read_size);
+      }
+    } else {
+      for (const int64_t off : offsets) {
+        TEST_CHECK(PreadFd(fd.get(), buf.data(), read_size, off) ==
+                   read_size);
+      }
+    }
+    bytes += pattern == kSequential ? kFileSize : kRandomReads * read_size;
+
+    state.PauseTiming();
+    fd.reset();
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_ReadHinted)
+    ->Args({kSequential, kNoHint})
+    ->Args({kSequential, kFadvSequential})
+    ->Args({kSequential, kFadvWillneed})
+    ->Args({kSequential, kReadahead})
+    ->Args({kRandom, kNoHint})
+    ->Args({kRandom, kFadvRandom})
+    ->Args({kRandom, kFadvWillneed})
+    ->ArgNames({"pattern", "hint"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,189 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/epoll_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+// A flag for waitid().
+#ifndef P_PIDFD
+#define P_PIDFD static_cast<idtype_t>(3)
+#endif
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_Reap measures how fast an init-like process reaps children that exit at
+// the same time: each iteration forks children that block until a pipe is
+// closed, then closes it and reaps them all. Only the reaping is timed, and
+// the reported latencies are the times between consecutive reaps.
+//
+// Children are reaped with wait4(-1), waitid(P_ALL), or, as pidfd-based
+// supervisors do, by waiting for their pidfds with epoll and reaping each with
+// waitid(P_PIDFD). Long-lived children that aren't reaped ("others") make the
+// child list longer, to expose reaping that scans all children.
+
+enum Method {
+  kWait4,
+  kWaitid,
+  kPidfd,
+};
+
+struct timespec Now() {
+  struct timespec ts;
+  TEST_PCHECK(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+  return ts;
+}
+
+uint64_t Nanoseconds(const struct timespec& start, const struct timespec& end) {
+  return static_cast<uint64_t>(end.tv_sec - start.tv_sec) * 1000000000 +
+         end.tv_nsec - start.tv_nsec;
+}
+
+// Spawn forks n children that exit once all write ends of the pipe fds are
+// closed, and returns their pids.
+std::vector<pid_t> Spawn(int n, const int fds[2]) {
+  std::vector<pid_t> pids;
+  for (int i = 0; i < n; i++) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[1]);
+      char c;
+      read(fds[0], &c, 1);
+      _exit(0);
+    }
+    TEST_PCHECK(pid > 0);
+    pids.push_back(pid);
+  }
+  return pids;
+}
+
+// CheckExited checks that a reaped child exited normally.
+void CheckExited(const siginfo_t& info) {
+  TEST_CHECK(info.si_code == CLD_EXITED && info.si_status == 0);
+}
+
+void BM_Reap(benchmark::State& state) {
+  const Method method = static_cast<Method>(state.range(0));
+  const int children = state.range(1);
+  const int others = state.range(2);
+
+  // Start the long-lived children first, so that the reaped children are the
+  // most recent.
+  int others_fds[2];
+  TEST_PCHECK(pipe(others_fds) == 0);
+  const std::vector<pid_t> other_pids = Spawn(others, others_fds);
+  TEST_PCHECK(close(others_fds[0]) == 0);
+
+  LatencyRecorder latency(state, "BM_Reap");
+  std::vector<epoll_event> events(children);
+  for (auto _ : state) {
+    int fds[2];
+    TEST_PCHECK(pipe(fds) == 0);
+    const std::vector<pid_t> pids = Spawn(children, fds);
+    TEST_PCHECK(close(fds[0]) == 0);
+
+    FileDescriptor epfd;
+    if (method == kPidfd) {
+      epfd = TEST_CHECK_NO_ERRNO_AND_VALUE(NewEpollFD());
+      for (const pid_t pid : pids) {
+        const int pidfd = syscall(SYS_pidfd_open, pid, 0);
+        TEST_PCHECK(pidfd >= 0);
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = pidfd;
+        TEST_PCHECK(epoll_ctl(epfd.get(), EPOLL_CTL_ADD, pidfd, &ev) == 0);
+      }
+    }
+
+    const struct timespec start = Now();
+    struct timespec last = start;
+    TEST_PCHECK(close(fds[1]) == 0);
+    for (int reaped = 0; reaped < children;) {
+      siginfo_t info = {};
+      int ready = 1;
+      switch (method) {
+        case kWait4: {
+          int status;
+          TEST_PCHECK(RetryEINTR(wait4)(-1, &status, 0, nullptr) > 0);
+          TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+          break;
+        }
+        case kWaitid:
+          TEST_PCHECK(RetryEINTR(waitid)(P_ALL, 0, &info, WEXITED) == 0);
+          CheckExited(info);
+          break;
+        case kPidfd:
+          ready = RetryEINTR(epoll_wait)(epfd.get(), events.data(),
+                                         events.size(), -1);
+          TEST_PCHECK(ready > 0);
+          for (int i = 0; i < ready; i++) {
+            const int pidfd = events[i].data.fd;
+            TEST_PCHECK(RetryEINTR(waitid)(P_PIDFD, pidfd, &info, WEXITED) ==
+                        0);
+            CheckExited(info);
+            TEST_PCHECK(close(pidfd) == 0);
+          }
+          break;
+      }
+      // A batch of children reaped after one epoll_wait is accounted for
+      // evenly.
+      const struct timespec now = Now();
+      for (int i = 0; i < ready; i++) {
+        latency.Record(Nanoseconds(last, now) / ready);
+      }
+      last = now;
+      reaped += ready;
+    }
+    state.SetIterationTime(Nanoseconds(start, last) / 1e9);
+  }
+
+  TEST_PCHECK(close(others_fds[1]) == 0);
+  for (const pid_t pid : other_pids) {
+    int status;
+    TEST_PCHECK(RetryEINTR(waitpid)(pid, &status, 0) == pid);
+  }
+
+  state.SetItemsProcessed(state.iterations() * children);
+}
+
+BENCHMARK(BM_Reap)
+    ->ArgsProduct({{kWait4, kWaitid, kPidfd}, {128, 2048}, {0, 2048}})
+    ->ArgNames({"method", "children", "others"})
+    ->UseManualTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,232 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure how evenly and how fast connections (TCP) or
+// datagram flows (UDP) are distributed across a group of SO_REUSEPORT sockets
+// bound to one loopback port, as used by multi-worker servers and proxies.
+// Each listener has its own thread, and every benchmark thread is a client
+// that uses a new socket, and therefore a new 4-tuple, per iteration.
+//
+// Besides the latency of each iteration, they report the rate handled by
+// each listener as listener<i>, and the imbalance as the ratio of the
+// busiest listener's count to the mean, which is 1 for a perfect spread.
+
+// ReuseportGroup is a group of SO_REUSEPORT sockets on one loopback port,
+// each with a thread that handles what it receives. Stream listeners accept
+// connections and immediately close them; datagram sockets echo each
+// datagram back to its sender.
+class ReuseportGroup {
+ public:
+  ReuseportGroup(int family, int type, int sockets) : type_(type) {
+    addr_.ss_family = family;
+    if (family == AF_INET) {
+      reinterpret_cast<sockaddr_in*>(&addr_)->sin_addr.s_addr =
+          htonl(INADDR_LOOPBACK);
+      addrlen_ = sizeof(sockaddr_in);
+    } else {
+      reinterpret_cast<sockaddr_in6*>(&addr_)->sin6_addr = in6addr_loopback;
+      addrlen_ = sizeof(sockaddr_in6);
+    }
+    for (int i = 0; i < sockets; i++) {
+      FileDescriptor fd = TEST_CHECK_NO_ERRNO_AND_VALUE(
+          Socket(family, type | SOCK_NONBLOCK, 0));
+      TEST_PCHECK(setsockopt(fd.get(), SOL_SOCKET, SO_REUSEPORT, &kSockOptOn,
+                             sizeof(kSockOptOn)) == 0);
+      TEST_PCHECK(bind(fd.get(), AsSockAddr(&addr_), addrlen_) == 0);
+      if (i == 0) {
+        // Let the first socket pick the port the rest join.
+        socklen_t addrlen = addrlen_;
+        TEST_PCHECK(getsockname(fd.get(), AsSockAddr(&addr_), &addrlen) == 0);
+      }
+      if (type == SOCK_STREAM) {
+        TEST_PCHECK(listen(fd.get(), SOMAXCONN) == 0);
+      }
+      sockets_.push_back(std::move(fd));
+    }
+    counts_ = std::make_unique<std::atomic<int64_t>[]>(sockets);
+    for (int i = 0; i < sockets; i++) {
+      counts_[i].store(0);
+      const int fd = sockets_[i].get();
+      threads_.push_back(
+          std::make_unique<ScopedThread>([this, i, fd] { Serve(i, fd); }));
+    }
+  }
+
+  ~ReuseportGroup() {
+    done_.store(true);
+    threads_.clear();
+  }
+
+  const sockaddr_storage& addr() const { return addr_; }
+  socklen_t addrlen() const { return addrlen_; }
+
+  // Report sets the per-listener and imbalance counters of state.
+  void Report(benchmark::State& state) const {
+    const int n = sockets_.size();
+    int64_t total = 0, busiest = 0;
+    for (int i = 0; i < n; i++) {
+      const int64_t count = counts_[i].load();
+      state.counters[absl::StrCat("listener", i)] =
+          benchmark::Counter(count, benchmark::Counter::kIsRate);
+      total += count;
+      busiest = std::max(busiest, count);
+    }
+    if (total > 0) {
+      state.counters["imbalance"] = static_cast<double>(busiest) * n / total;
+    }
+  }
+
+ private:
+  // Serve polls with a timeout so that it notices done_ without needing a
+  // final connection or datagram to every socket.
+  void Serve(int i, int fd) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    while (!done_.load()) {
+      int n = RetryEINTR(poll)(&pfd, 1, 10);
+      TEST_PCHECK(n >= 0);
+      if (n == 0) {
+        continue;
+      }
+      if (type_ == SOCK_STREAM) {
+        int conn = accept4(fd, nullptr, nullptr, 0);
+        if (conn < 0) {
+          TEST_PCHECK(errno == EAGAIN || errno == ECONNABORTED);
+          continue;
+        }
+        counts_[i].fetch_add(1);
+        TEST_PCHECK(close(conn) == 0);
+      } else {
+        char c;
+        sockaddr_storage from;
+        socklen_t fromlen = sizeof(from);
+        if (RetryEINTR(recvfrom)(fd, &c, 1, 0, AsSockAddr(&from), &fromlen) <
+            0) {
+          TEST_PCHECK(errno == EAGAIN);
+          continue;
+        }
+        counts_[i].fetch_add(1);
+        TEST_PCHECK(RetryEINTR(sendto)(fd, &c, 1, 0, AsSockAddr(&from),
+                                       fromlen) == 1);
+      }
+    }
+  }
+
+  const int type_;
+  sockaddr_storage addr_ = {};
+  socklen_t addrlen_;
+  std::vector<FileDescriptor> sockets_;
+
+  // counts_ is the number of connections accepted or datagrams received by
+  // each socket. Each is incremented before the client is answered, so the
+  // counts are complete once all clients are done.
+  std::unique_ptr<std::atomic<int64_t>[]> counts_;
+
+  std::atomic<bool> done_{false};
+  std::vector<std::unique_ptr<ScopedThread>> threads_;
+};
+
+ReuseportGroup* group;
+
+// BM_Reuseport measures connections (TCP) or request/response exchanges of
+// one byte (UDP) against a group of SO_REUSEPORT sockets.
+void BM_Reuseport(benchmark::State& state) {
+  const int type = state.range(0);
+  const int family = state.range(1) ? AF_INET6 : AF_INET;
+  const int listeners = state.range(2);
+
+  if (state.thread_index() == 0) {
+    group = new ReuseportGroup(family, type, listeners);
+  }
+
+  LatencyRecorder latency(state, "BM_Reuseport");
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    FileDescriptor fd =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(Socket(family, type, 0));
+    TEST_PCHECK(RetryEINTR(connect)(fd.get(), AsSockAddr(&group->addr()),
+                                    group->addrlen()) == 0);
+    char c = 'a';
+    if (type == SOCK_STREAM) {
+      TEST_PCHECK(RetryEINTR(read)(fd.get(), &c, 1) == 0);
+      // Don't leave TIME-WAIT state behind, which would exhaust the
+      // ephemeral ports.
+      struct linger l = {};
+      l.l_onoff = 1;
+      TEST_PCHECK(setsockopt(fd.get(), SOL_SOCKET, SO_LINGER, &l,
+                             sizeof(l)) == 0);
+    } else {
+      TEST_PCHECK(RetryEINTR(write)(fd.get(), &c, 1) == 1);
+      TEST_PCHECK(RetryEINTR(read)(fd.get(), &c, 1) == 1);
+    }
+  }
+
+  if (state.thread_index() == 0) {
+    group->Report(state);
+    delete group;
+    group = nullptr;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void ReuseportArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"type", "ipv6", "listeners"});
+  for (int type : {SOCK_STREAM, SOCK_DGRAM}) {
+    for (int ipv6 : {0, 1}) {
+      for (int listeners : {2, 4, 8}) {
+        bench->Args({type, ipv6, listeners});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_Reuseport)
+    ->Apply(ReuseportArgs)
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
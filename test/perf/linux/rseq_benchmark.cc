@@ -0,0 +1,134 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/rseq/test.h"
+#include "test/util/cleanup.h"
+#include "test/util/logging.h"
+#include "test/util/multiprocess_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// Each benchmark runs the standalone rseq_benchmark binary, whose threads all
+// increment counters at the same time. Items per second are increments per
+// second across all threads. The argument is the number of threads; once
+// there are more threads than CPUs, threads are preempted in the middle of
+// critical sections, which shows up as aborts.
+//
+// The counting is done in a standalone binary because each thread may only
+// register one struct rseq, and libc may register its own.
+
+// NOTE(b/326665974): The standalone binary needs clone() in
+// rseq/start_arm64.S.
+#if defined(__x86_64__)
+
+constexpr char kRseqBenchmarkBinary[] =
+    "test/syscalls/linux/rseq/rseq_benchmark";
+
+// Number of increments done by each thread in each run of the binary.
+constexpr uint64_t kIncrementsPerThread = 1 << 20;
+
+struct RunResult {
+  uint64_t elapsed_ns;
+  uint64_t aborts;
+};
+
+// RunBinary runs rseq_benchmark once and returns what it reported.
+RunResult RunBinary(const std::string& path, const char* mode, int threads) {
+  int fds[2];
+  TEST_PCHECK(pipe2(fds, O_CLOEXEC) == 0);
+  const ExecveArray argv = {path, mode, absl::StrCat(threads),
+                            absl::StrCat(kIncrementsPerThread)};
+  pid_t child;
+  int execve_errno;
+  Cleanup kill = TEST_CHECK_NO_ERRNO_AND_VALUE(ForkAndExec(
+      path, argv, {}, [&] { TEST_PCHECK(dup2(fds[1], STDOUT_FILENO) >= 0); },
+      &child, &execve_errno));
+  TEST_CHECK(execve_errno == 0);
+  TEST_PCHECK(close(fds[1]) == 0);
+
+  std::string out;
+  char buf[64];
+  ssize_t n;
+  while ((n = RetryEINTR(read)(fds[0], buf, sizeof(buf))) > 0) {
+    out.append(buf, n);
+  }
+  TEST_PCHECK(n == 0);
+  TEST_PCHECK(close(fds[0]) == 0);
+
+  int status;
+  TEST_PCHECK(RetryEINTR(waitpid)(child, &status, 0) == child);
+  kill.Release();
+  TEST_CHECK_MSG(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+                 "rseq_benchmark failed");
+
+  RunResult result;
+  TEST_CHECK(sscanf(out.c_str(), "%" SCNu64 " %" SCNu64, &result.elapsed_ns,
+                    &result.aborts) == 2);
+  return result;
+}
+
+void BM_PerCPUCounter(benchmark::State& state, const char* mode) {
+  const std::string path = RunfilePath(kRseqBenchmarkBinary);
+  const int threads = state.range(0);
+
+  uint64_t aborts = 0;
+  for (auto _ : state) {
+    RunResult result = RunBinary(path, mode, threads);
+    state.SetIterationTime(static_cast<double>(result.elapsed_ns) / 1e9);
+    aborts += result.aborts;
+  }
+
+  const uint64_t increments =
+      state.iterations() * threads * kIncrementsPerThread;
+  state.SetItemsProcessed(increments);
+  state.counters["aborts"] = benchmark::Counter(aborts);
+  state.counters["aborts_per_million"] =
+      benchmark::Counter(static_cast<double>(aborts) * 1e6 / increments);
+}
+
+// Increments with rseq critical sections, on the counter of the current CPU.
+BENCHMARK_CAPTURE(BM_PerCPUCounter, Rseq, kRseqBenchmarkModeRseq)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseManualTime();
+
+// Increments with atomic instructions, on a single shared counter.
+BENCHMARK_CAPTURE(BM_PerCPUCounter, Atomic, kRseqBenchmarkModeAtomic)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseManualTime();
+
+#endif  // defined(__x86_64__)
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,89 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <sys/mman.h>
+#include <sys/sysinfo.h>
+
+#include <cstdint>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/memory_util.h"
+#include "test/util/save_util.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_SaveRestore measures a co-operative save cycle of a process with
+// state.range(0) bytes of dirty anonymous memory, as seen by the process: the
+// time from entering MaybeSave until the restored (or resumed) process
+// returns from it.
+//
+// It only does something in the save/restore and save/resume variants.
+void BM_SaveRestore(benchmark::State& state) {
+  if (!IsRunningWithSaveRestore()) {
+    state.SkipWithError("not running with save/restore");
+    return;
+  }
+
+  const size_t size = state.range(0);
+  struct sysinfo info;
+  TEST_PCHECK(sysinfo(&info) == 0);
+  if (size > static_cast<uint64_t>(info.freeram) * info.mem_unit / 2) {
+    state.SkipWithError("not enough free memory");
+    return;
+  }
+
+  auto m_or = MmapAnon(size, PROT_READ | PROT_WRITE, MAP_PRIVATE);
+  if (!m_or.ok()) {
+    state.SkipWithError(m_or.error().ToString().c_str());
+    return;
+  }
+  Mapping m = std::move(m_or).ValueOrDie();
+
+  // Random data, so that compression of the checkpoint image does not hide
+  // the cost of its size.
+  char* const data = static_cast<char*>(m.ptr());
+  RandomizeBuffer(data, size);
+
+  const SaveStats before = GetSaveStats();
+  for (auto _ : state) {
+    // Dirty every page again, in case the checkpoint is incremental.
+    state.PauseTiming();
+    for (size_t off = 0; off < size; off += kPageSize) {
+      data[off]++;
+    }
+    state.ResumeTiming();
+
+    MaybeSave();
+  }
+
+  const SaveStats after = GetSaveStats();
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+  state.counters["saves"] = after.count - before.count;
+}
+
+BENCHMARK(BM_SaveRestore)
+    ->RangeMultiplier(4)
+    ->Range(1 << 20, int64_t{16} << 30)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -13,10 +13,27 @@
 // limitations under the License.
 
 #include <sched.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/eventfd_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
 #include "test/util/test_util.h"
+#include "test/util/thread_util.h"
 
 namespace gvisor {
 namespace testing {
@@ -31,6 +48,170 @@ void BM_Sched_yield(benchmark::State& state) {
 
 BENCHMARK(BM_Sched_yield)->ThreadRange(1, 2000)->UseRealTime();
 
+// AllowedCPUs returns the CPUs in the calling thread's affinity mask.
+std::vector<int> AllowedCPUs() {
+  cpu_set_t mask;
+  TEST_PCHECK(sched_getaffinity(/*pid=*/0, sizeof(mask), &mask) == 0);
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &mask)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// PinTo restricts the calling thread to cpu.
+bool PinTo(int cpu) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  return sched_setaffinity(/*pid=*/0, sizeof(mask), &mask) == 0;
+}
+
+// Progress is a per-thread counter, padded to avoid false sharing.
+struct alignas(64) Progress {
+  std::atomic<uint64_t> count{0};
+};
+
+// Work does a small fixed amount of CPU work.
+void Work() {
+  uint64_t x = 0;
+  for (int i = 0; i < 256; i++) {
+    benchmark::DoNotOptimize(x += i);
+  }
+}
+
+// BM_SchedFairness runs oversub runnable threads per allowed CPU for 10ms per
+// iteration. Each thread repeatedly does a small unit of work, optionally
+// followed by sched_yield. With pin set, thread i is pinned to the i-th
+// allowed CPU (modulo their number) with sched_setaffinity, so threads only
+// compete with those on the same CPU.
+//
+// The "fairness" counter is Jain's fairness index of the units of work done by
+// each thread: 1 when every thread made equal progress, down to 1/threads
+// when one thread made all of it. "min_share" is the progress of the slowest
+// thread relative to the mean, which shows starvation directly.
+void BM_SchedFairness(benchmark::State& state) {
+  const int oversub = state.range(0);
+  const bool yield = state.range(1);
+  const bool pin = state.range(2);
+
+  const std::vector<int> cpus = AllowedCPUs();
+  const int nthreads = oversub * cpus.size();
+  std::vector<Progress> progress(nthreads);
+  std::atomic<bool> stop(false);
+  std::atomic<int> pin_failures(0);
+
+  std::vector<std::unique_ptr<ScopedThread>> threads;
+  for (int i = 0; i < nthreads; i++) {
+    threads.push_back(std::make_unique<ScopedThread>([&, i] {
+      if (pin && !PinTo(cpus[i % cpus.size()])) {
+        pin_failures++;
+      }
+      while (!stop.load(std::memory_order_relaxed)) {
+        Work();
+        if (yield) {
+          sched_yield();
+        }
+        progress[i].count.fetch_add(1, std::memory_order_relaxed);
+      }
+    }));
+  }
+
+  for (auto _ : state) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+
+  stop.store(true);
+  threads.clear();
+  if (pin_failures.load() > 0) {
+    state.SkipWithError("sched_setaffinity failed");
+    return;
+  }
+
+  double sum = 0, sum_sq = 0;
+  uint64_t min = UINT64_MAX;
+  for (const Progress& p : progress) {
+    const uint64_t n = p.count.load();
+    sum += n;
+    sum_sq += static_cast<double>(n) * n;
+    min = std::min(min, n);
+  }
+  state.SetItemsProcessed(sum);
+  state.counters["threads"] = nthreads;
+  state.counters["fairness"] = sum_sq > 0 ? sum * sum / (nthreads * sum_sq) : 0;
+  state.counters["min_share"] = sum > 0 ? min * nthreads / sum : 0;
+}
+
+BENCHMARK(BM_SchedFairness)
+    ->ArgsProduct({{1, 2, 4, 16}, {0, 1}, {0, 1}})
+    ->ArgNames({"oversub", "yield", "pin"})
+    ->UseRealTime();
+
+// MonotonicNanos returns the current CLOCK_MONOTONIC time in nanoseconds.
+int64_t MonotonicNanos() {
+  struct timespec ts;
+  TEST_PCHECK(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// BM_WakeToRun wakes a thread blocked in an eventfd read while the given
+// number of busy threads per allowed CPU compete for the CPUs. The latency
+// percentiles are the time from the write to the woken thread running.
+void BM_WakeToRun(benchmark::State& state) {
+  const int spinners = state.range(0) * AllowedCPUs().size();
+
+  FileDescriptor wake =
+      ASSERT_NO_ERRNO_AND_VALUE(NewEventFD(0, EFD_SEMAPHORE));
+  FileDescriptor done =
+      ASSERT_NO_ERRNO_AND_VALUE(NewEventFD(0, EFD_SEMAPHORE));
+  std::atomic<bool> stop(false);
+  std::atomic<int64_t> woken_at(0);
+
+  std::vector<std::unique_ptr<ScopedThread>> threads;
+  for (int i = 0; i < spinners; i++) {
+    threads.push_back(std::make_unique<ScopedThread>([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        Work();
+      }
+    }));
+  }
+  ScopedThread waiter([&] {
+    while (true) {
+      uint64_t val;
+      TEST_CHECK(ReadFd(wake.get(), &val, sizeof(val)) == sizeof(val));
+      if (stop.load()) {
+        return;
+      }
+      woken_at.store(MonotonicNanos());
+      val = 1;
+      TEST_CHECK(WriteFd(done.get(), &val, sizeof(val)) == sizeof(val));
+    }
+  });
+
+  LatencyRecorder latency(state, absl::StrCat("BM_WakeToRun/", spinners));
+  for (auto _ : state) {
+    uint64_t val = 1;
+    const int64_t start = MonotonicNanos();
+    TEST_CHECK(WriteFd(wake.get(), &val, sizeof(val)) == sizeof(val));
+    TEST_CHECK(ReadFd(done.get(), &val, sizeof(val)) == sizeof(val));
+    latency.Record(woken_at.load() - start);
+  }
+
+  stop.store(true);
+  uint64_t val = 1;
+  TEST_CHECK(WriteFd(wake.get(), &val, sizeof(val)) == sizeof(val));
+}
+
+BENCHMARK(BM_WakeToRun)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->ArgName("spinners_per_cpu")
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
@@ -0,0 +1,263 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the cost of application seccomp filters, which
+// gVisor evaluates with its own BPF interpreter on every syscall, by timing
+// getpid with filters of increasing size installed.
+//
+// Filters can't be removed once installed, so each run installs them in a
+// child process, which times batches of getpid when asked to by the parent.
+
+#if defined(__x86_64__)
+constexpr uint32_t kAuditArch = AUDIT_ARCH_X86_64;
+#elif defined(__aarch64__)
+constexpr uint32_t kAuditArch = AUDIT_ARCH_AARCH64;
+#endif
+
+// Rules match syscall numbers starting here, which no syscall has, so that
+// getpid falls through every rule of a filter.
+constexpr uint32_t kFirstRuleSysno = 1000;
+
+// Number of getpid calls timed per benchmark iteration.
+constexpr int kCallsPerIteration = 1000;
+
+enum Layout {
+  // No filter is installed.
+  kNone,
+
+  // A single filter compares the syscall number against each rule in turn,
+  // as filters generated from a list of syscalls (e.g. Docker's default
+  // profile) do.
+  kLinear,
+
+  // A single filter does a binary search over the rules, as optimizing
+  // filter compilers (e.g. libseccomp with SCMP_FLTATR_CTL_OPTIMIZE=2) do.
+  kTree,
+
+  // The given number of filters with kStackedRules linear rules each are
+  // installed, as when nested sandboxes each add their own filter.
+  kStacked,
+};
+
+// Number of rules in each filter for kStacked.
+constexpr int kStackedRules = 10;
+
+// Prologue returns the instructions that kill the process if the syscall isn't
+// from kAuditArch, and then load the syscall number.
+std::vector<sock_filter> Prologue() {
+  return {
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, arch)),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, kAuditArch, 1, 0),
+      BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+  };
+}
+
+// LinearFilter returns a filter that returns ENOSYS for each of rules syscall
+// numbers from kFirstRuleSysno, checked one after the other.
+std::vector<sock_filter> LinearFilter(int rules) {
+  std::vector<sock_filter> f = Prologue();
+  for (int i = 0; i < rules; i++) {
+    f.push_back(
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, kFirstRuleSysno + i, 0, 1));
+    f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | ENOSYS));
+  }
+  f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+  return f;
+}
+
+// AppendTree appends a binary search over the syscall numbers [lo, hi) to f.
+// Each leaf returns ENOSYS for its number, or allows any other syscall.
+void AppendTree(std::vector<sock_filter>* f, uint32_t lo, uint32_t hi) {
+  if (hi - lo == 1) {
+    f->push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, lo, 0, 1));
+    f->push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | ENOSYS));
+    f->push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+    return;
+  }
+  // Conditional jumps only have 8-bit offsets, so reach the upper half with
+  // an unconditional jump, which has a 32-bit one:
+  //
+  //   if (A >= mid) goto upper
+  //   goto lower  (i.e. skip the next instruction)
+  //   upper: ja upper_tree
+  //   lower_tree...
+  //   upper_tree...
+  const uint32_t mid = lo + (hi - lo) / 2;
+  f->push_back(BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, mid, 0, 1));
+  const size_t ja = f->size();
+  f->push_back(BPF_STMT(BPF_JMP | BPF_JA, 0));
+  AppendTree(f, lo, mid);
+  (*f)[ja].k = f->size() - ja - 1;
+  AppendTree(f, mid, hi);
+}
+
+// TreeFilter returns a filter equivalent to LinearFilter(rules) that does a
+// binary search over the rules.
+std::vector<sock_filter> TreeFilter(int rules) {
+  std::vector<sock_filter> f = Prologue();
+  if (rules == 0) {
+    f.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+    return f;
+  }
+  AppendTree(&f, kFirstRuleSysno, kFirstRuleSysno + rules);
+  return f;
+}
+
+void InstallFilter(std::vector<sock_filter> filter) {
+  TEST_CHECK(filter.size() <= BPF_MAXINSNS);
+  struct sock_fprog prog;
+  prog.len = filter.size();
+  prog.filter = filter.data();
+  TEST_PCHECK(syscall(__NR_seccomp, SECCOMP_SET_MODE_FILTER, 0, &prog) == 0);
+}
+
+void InstallFilters(Layout layout, int size) {
+  TEST_PCHECK(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0);
+  switch (layout) {
+    case kNone:
+      break;
+    case kLinear:
+      InstallFilter(LinearFilter(size));
+      break;
+    case kTree:
+      InstallFilter(TreeFilter(size));
+      break;
+    case kStacked:
+      for (int i = 0; i < size; i++) {
+        InstallFilter(LinearFilter(kStackedRules));
+      }
+      break;
+  }
+}
+
+// FilteredChild is a child process with filters installed, which times
+// kCallsPerIteration getpid calls when asked to.
+class FilteredChild {
+ public:
+  FilteredChild(Layout layout, int size) {
+    int fds[2];
+    TEST_PCHECK(pipe(fds) == 0);
+    FileDescriptor go_read(fds[0]);
+    go_ = FileDescriptor(fds[1]);
+    TEST_PCHECK(pipe(fds) == 0);
+    elapsed_ = FileDescriptor(fds[0]);
+    FileDescriptor elapsed_write(fds[1]);
+
+    pid_ = fork();
+    TEST_PCHECK(pid_ >= 0);
+    if (pid_ == 0) {
+      go_.reset();
+      elapsed_.reset();
+      InstallFilters(layout, size);
+      char c;
+      while (ReadFd(go_read.get(), &c, 1) == 1) {
+        const absl::Time start = absl::Now();
+        for (int i = 0; i < kCallsPerIteration; i++) {
+          syscall(SYS_getpid);
+        }
+        const int64_t ns = absl::ToInt64Nanoseconds(absl::Now() - start);
+        TEST_CHECK(WriteFd(elapsed_write.get(), &ns, sizeof(ns)) ==
+                   sizeof(ns));
+      }
+      _exit(0);
+    }
+  }
+
+  ~FilteredChild() {
+    // Closing go makes the child exit.
+    go_.reset();
+    int status;
+    TEST_PCHECK(RetryEINTR(waitpid)(pid_, &status, 0) == pid_);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  // Run returns the time the child took for kCallsPerIteration getpid calls.
+  absl::Duration Run() {
+    char c = 0;
+    TEST_CHECK(WriteFd(go_.get(), &c, 1) == 1);
+    int64_t ns;
+    TEST_CHECK(ReadFd(elapsed_.get(), &ns, sizeof(ns)) == sizeof(ns));
+    return absl::Nanoseconds(ns);
+  }
+
+ private:
+  pid_t pid_;
+  FileDescriptor go_;
+  FileDescriptor elapsed_;
+};
+
+void BM_SeccompGetpid(benchmark::State& state) {
+  const Layout layout = static_cast<Layout>(state.range(0));
+  const int size = state.range(1);
+  FilteredChild child(layout, size);
+
+  for (auto _ : state) {
+    state.SetIterationTime(absl::ToDoubleSeconds(child.Run()));
+  }
+
+  state.SetItemsProcessed(state.iterations() * kCallsPerIteration);
+}
+
+void SeccompArgs(benchmark::internal::Benchmark* bench) {
+  // size is the number of rules, except for kStacked, where it is the
+  // number of filters.
+  bench->ArgNames({"layout", "size"});
+  //
+  // Note that gVisor may answer getpid without entering the sentry when no
+  // filter is installed, so the cost of the filters alone is relative to
+  // the smallest filter, which only checks the architecture.
+  bench->Args({kNone, 0});
+  for (Layout layout : {kLinear, kTree}) {
+    for (int rules : {0, 10, 50, 100, 250, 500}) {
+      bench->Args({layout, rules});
+    }
+  }
+  for (int filters : {1, 2, 4, 8, 16}) {
+    bench->Args({kStacked, filters});
+  }
+}
+
+BENCHMARK(BM_SeccompGetpid)->Apply(SeccompArgs)->UseManualTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,216 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <linux/memfd.h>
+#include <sys/ipc.h>
+#include <sys/mman.h>
+#include <sys/shm.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/cleanup.h"
+#include "test/util/eventfd_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/memory_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks cover the primitives of a shared-memory data plane: rings
+// in memfd or SysV shared memory mapped by several processes, with eventfds
+// used to signal between them.
+
+int MemfdCreate(const char* name, unsigned int flags) {
+  return syscall(__NR_memfd_create, name, flags);
+}
+
+constexpr uint64_t kPing = 1;
+constexpr uint64_t kStop = 2;
+
+// Pong answers each ping on ping with a ping on pong, until it reads kStop.
+// It only makes async-signal-safe calls, so it can run in a forked child.
+void Pong(int ping, int pong) {
+  while (true) {
+    uint64_t val;
+    TEST_PCHECK(read(ping, &val, sizeof(val)) == sizeof(val));
+    if (val == kStop) {
+      return;
+    }
+    TEST_PCHECK(write(pong, &kPing, sizeof(kPing)) == sizeof(kPing));
+  }
+}
+
+// BM_EventfdPingPong measures the round trip through a pair of eventfds to a
+// peer blocked in read(2), in another thread or another process.
+void BM_EventfdPingPong(benchmark::State& state) {
+  const bool process = state.range(0);
+  auto ping = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+  auto pong = ASSERT_NO_ERRNO_AND_VALUE(NewEventFD());
+
+  std::unique_ptr<ScopedThread> thread;
+  pid_t child = -1;
+  if (process) {
+    child = fork();
+    if (child == 0) {
+      Pong(ping.get(), pong.get());
+      _exit(0);
+    }
+    ASSERT_THAT(child, SyscallSucceeds());
+  } else {
+    thread = std::make_unique<ScopedThread>(
+        [&] { Pong(ping.get(), pong.get()); });
+  }
+
+  {
+    LatencyRecorder latency(
+        state, absl::StrCat("BM_EventfdPingPong/",
+                            process ? "process" : "thread"));
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      TEST_PCHECK(WriteFd(ping.get(), &kPing, sizeof(kPing)) == sizeof(kPing));
+      uint64_t val;
+      TEST_PCHECK(ReadFd(pong.get(), &val, sizeof(val)) == sizeof(val));
+    }
+  }
+
+  ASSERT_THAT(WriteFd(ping.get(), &kStop, sizeof(kStop)),
+              SyscallSucceedsWithValue(sizeof(kStop)));
+  if (process) {
+    int status;
+    ASSERT_THAT(RetryEINTR(waitpid)(child, &status, 0),
+                SyscallSucceedsWithValue(child));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+}
+
+BENCHMARK(BM_EventfdPingPong)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("process")
+    ->UseRealTime();
+
+// BM_MemfdSetup measures creating, sizing and mapping a memfd-backed region,
+// then tearing it down again.
+void BM_MemfdSetup(benchmark::State& state) {
+  const size_t size = state.range(0);
+
+  for (auto _ : state) {
+    FileDescriptor fd(MemfdCreate("ring", MFD_CLOEXEC));
+    TEST_PCHECK(fd.get() >= 0);
+    TEST_PCHECK(ftruncate(fd.get(), size) == 0);
+    Mapping m = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        Mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0));
+  }
+}
+
+BENCHMARK(BM_MemfdSetup)->Range(kPageSize, 64 << 20)->UseRealTime();
+
+// Touch reads or writes one byte of each page of [addr, addr+size).
+void Touch(char* addr, size_t size, bool write) {
+  for (size_t off = 0; off < size; off += kPageSize) {
+    if (write) {
+      addr[off] = 1;
+    } else {
+      benchmark::DoNotOptimize(*static_cast<volatile char*>(addr + off));
+    }
+  }
+}
+
+// BM_SharedFault measures the page faults taken by mapping a memfd whose
+// pages were already populated by another process, as each new peer of a
+// shared ring does.
+void BM_SharedFault(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const bool write = state.range(1);
+
+  FileDescriptor fd(MemfdCreate("ring", MFD_CLOEXEC));
+  ASSERT_THAT(fd.get(), SyscallSucceeds());
+  ASSERT_THAT(ftruncate(fd.get(), size), SyscallSucceeds());
+
+  // Populate the pages from a child, so that this process has never touched
+  // them.
+  pid_t child = fork();
+  if (child == 0) {
+    void* addr = MmapSafe(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                          fd.get(), 0);
+    if (addr == MAP_FAILED) {
+      _exit(1);
+    }
+    Touch(static_cast<char*>(addr), size, /*write=*/true);
+    _exit(0);
+  }
+  ASSERT_THAT(child, SyscallSucceeds());
+  int status;
+  ASSERT_THAT(RetryEINTR(waitpid)(child, &status, 0),
+              SyscallSucceedsWithValue(child));
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  for (auto _ : state) {
+    Mapping m = TEST_CHECK_NO_ERRNO_AND_VALUE(
+        Mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0));
+    Touch(static_cast<char*>(m.ptr()), size, write);
+  }
+  state.SetItemsProcessed(state.iterations() * (size / kPageSize));
+}
+
+BENCHMARK(BM_SharedFault)
+    ->ArgsProduct({{1 << 20, 16 << 20, 256 << 20}, {0, 1}})
+    ->ArgNames({"size", "write"})
+    ->UseRealTime();
+
+// BM_ShmAttach measures attaching and detaching a SysV shared memory segment,
+// optionally touching every page while attached.
+void BM_ShmAttach(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const bool touch = state.range(1);
+
+  const int id = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+  ASSERT_THAT(id, SyscallSucceeds());
+  auto cleanup = Cleanup([id] { shmctl(id, IPC_RMID, nullptr); });
+
+  for (auto _ : state) {
+    void* addr = shmat(id, nullptr, 0);
+    TEST_PCHECK(addr != reinterpret_cast<void*>(-1));
+    if (touch) {
+      Touch(static_cast<char*>(addr), size, /*write=*/true);
+    }
+    TEST_PCHECK(shmdt(addr) == 0);
+  }
+}
+
+BENCHMARK(BM_ShmAttach)
+    ->ArgsProduct(
+        {{static_cast<int64_t>(kPageSize), 1 << 20, 64 << 20}, {0, 1}})
+    ->ArgNames({"size", "touch"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -14,17 +14,235 @@
 
 #include <signal.h>
 #include <string.h>
+#include <sys/signalfd.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "benchmark/benchmark.h"
+#include "test/util/cleanup.h"
+#include "test/util/file_descriptor.h"
 #include "test/util/logging.h"
+#include "test/util/signal_util.h"
 #include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+#include "test/util/timer_util.h"
 
 namespace gvisor {
 namespace testing {
 
 namespace {
 
+// The number of signals handled by CountingHandler.
+volatile sig_atomic_t signals_handled = 0;
+
+void CountingHandler(int sig, siginfo_t* si, void* ctx) { signals_handled++; }
+
+// InstallCountingHandler installs CountingHandler for sig with the given
+// extra flags, and returns a cleanup that restores the previous handler.
+Cleanup InstallCountingHandler(int sig, int flags = 0) {
+  struct sigaction sa = {};
+  sigemptyset(&sa.sa_mask);
+  sa.sa_sigaction = CountingHandler;
+  sa.sa_flags = SA_SIGINFO | flags;
+  return TEST_CHECK_NO_ERRNO_AND_VALUE(ScopedSigaction(sig, sa));
+}
+
+// BM_TgkillSelf sends SIGURG to the calling thread, which is how the Go
+// runtime preempts goroutines. The signal is delivered on return from tgkill,
+// so each iteration includes handler entry and rt_sigreturn.
+void BM_TgkillSelf(benchmark::State& state) {
+  Cleanup restore = InstallCountingHandler(SIGURG);
+  const pid_t pid = getpid();
+  const pid_t tid = gettid();
+
+  signals_handled = 0;
+  for (auto _ : state) {
+    TEST_PCHECK(tgkill(pid, tid, SIGURG) == 0);
+  }
+  TEST_CHECK(signals_handled == static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_TgkillSelf)->UseRealTime();
+
+// BM_TgkillSelfNodefer is BM_TgkillSelf with SA_NODEFER, so that the handler
+// runs with the same signal mask that rt_sigreturn restores.
+void BM_TgkillSelfNodefer(benchmark::State& state) {
+  Cleanup restore = InstallCountingHandler(SIGURG, SA_NODEFER);
+  const pid_t pid = getpid();
+  const pid_t tid = gettid();
+
+  signals_handled = 0;
+  for (auto _ : state) {
+    TEST_PCHECK(tgkill(pid, tid, SIGURG) == 0);
+  }
+  TEST_CHECK(signals_handled == static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_TgkillSelfNodefer)->UseRealTime();
+
+// BM_TgkillPingPong bounces a signal between two threads, each waiting in
+// sigsuspend for the other's signal. Each iteration is one round trip.
+void BM_TgkillPingPong(benchmark::State& state) {
+  Cleanup restore_ping = InstallCountingHandler(SIGUSR1);
+  Cleanup restore_pong = InstallCountingHandler(SIGUSR2);
+  const pid_t pid = getpid();
+  const pid_t main_tid = gettid();
+
+  // Both signals stay blocked except in sigsuspend, so that a signal sent
+  // before its target is waiting stays pending instead of being lost.
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  sigaddset(&set, SIGUSR2);
+  Cleanup restore_mask =
+      ASSERT_NO_ERRNO_AND_VALUE(ScopedSignalMask(SIG_BLOCK, set));
+  sigset_t wait_ping, wait_pong;
+  TEST_PCHECK(sigprocmask(SIG_SETMASK, nullptr, &wait_ping) == 0);
+  wait_pong = wait_ping;
+  sigdelset(&wait_ping, SIGUSR1);
+  sigdelset(&wait_pong, SIGUSR2);
+
+  std::atomic<pid_t> peer_tid(0);
+  std::atomic<bool> done(false);
+  ScopedThread peer([&] {
+    peer_tid.store(gettid());
+    while (true) {
+      sigsuspend(&wait_ping);
+      if (done.load()) {
+        return;
+      }
+      TEST_PCHECK(tgkill(pid, main_tid, SIGUSR2) == 0);
+    }
+  });
+  while (peer_tid.load() == 0) {
+    sched_yield();
+  }
+
+  for (auto _ : state) {
+    TEST_PCHECK(tgkill(pid, peer_tid.load(), SIGUSR1) == 0);
+    sigsuspend(&wait_pong);
+  }
+
+  done.store(true);
+  TEST_PCHECK(tgkill(pid, peer_tid.load(), SIGUSR1) == 0);
+}
+
+BENCHMARK(BM_TgkillPingPong)->UseRealTime();
+
+// BM_SigqueueRT queues batch real-time signals, each with a value, while the
+// signal is blocked and then unblocks it to deliver them all.
+void BM_SigqueueRT(benchmark::State& state) {
+  const int batch = state.range(0);
+  const int sig = SIGRTMIN;
+  Cleanup restore = InstallCountingHandler(sig);
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, sig);
+  const pid_t pid = getpid();
+
+  signals_handled = 0;
+  for (auto _ : state) {
+    TEST_PCHECK(sigprocmask(SIG_BLOCK, &set, nullptr) == 0);
+    for (int i = 0; i < batch; i++) {
+      union sigval value;
+      value.sival_int = i;
+      TEST_PCHECK(sigqueue(pid, sig, value) == 0);
+    }
+    TEST_PCHECK(sigprocmask(SIG_UNBLOCK, &set, nullptr) == 0);
+  }
+  TEST_CHECK(signals_handled == batch * state.iterations());
+
+  state.SetItemsProcessed(batch * state.iterations());
+}
+
+BENCHMARK(BM_SigqueueRT)->Arg(1)->Arg(16)->UseRealTime();
+
+// BM_SignalfdRead sends a blocked signal to the calling thread and consumes
+// it by reading a signalfd, without running a handler.
+void BM_SignalfdRead(benchmark::State& state) {
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  Cleanup restore_mask =
+      ASSERT_NO_ERRNO_AND_VALUE(ScopedSignalMask(SIG_BLOCK, set));
+  FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(NewSignalFD(&set));
+  const pid_t pid = getpid();
+  const pid_t tid = gettid();
+
+  struct signalfd_siginfo info;
+  for (auto _ : state) {
+    TEST_PCHECK(tgkill(pid, tid, SIGUSR1) == 0);
+    TEST_CHECK(ReadFd(fd.get(), &info, sizeof(info)) == sizeof(info));
+  }
+}
+
+BENCHMARK(BM_SignalfdRead)->UseRealTime();
+
+// BM_SigaltstackHandler is BM_TgkillSelf with the handler running on an
+// alternate signal stack (1) or the thread's stack (0).
+void BM_SigaltstackHandler(benchmark::State& state) {
+  const bool onstack = state.range(0);
+
+  std::vector<char> stack(1 << 16);
+  stack_t ss = {}, old_ss;
+  ss.ss_sp = stack.data();
+  ss.ss_size = stack.size();
+  TEST_PCHECK(sigaltstack(&ss, &old_ss) == 0);
+  Cleanup restore = InstallCountingHandler(SIGUSR1, onstack ? SA_ONSTACK : 0);
+  const pid_t pid = getpid();
+  const pid_t tid = gettid();
+
+  for (auto _ : state) {
+    TEST_PCHECK(tgkill(pid, tid, SIGUSR1) == 0);
+  }
+
+  TEST_PCHECK(sigaltstack(&old_ss, nullptr) == 0);
+}
+
+BENCHMARK(BM_SigaltstackHandler)->Arg(0)->Arg(1)->UseRealTime();
+
+// Spin does a fixed amount of CPU work.
+void Spin() {
+  uint64_t x = 0;
+  for (int i = 0; i < (1 << 14); i++) {
+    benchmark::DoNotOptimize(x += i);
+  }
+}
+
+// BM_SigprofOverhead does a fixed amount of CPU work per iteration while an
+// ITIMER_PROF timer fires SIGPROF every interval microseconds, as a sampling
+// profiler would. An interval of 0 disables the timer, so the difference
+// from that run is the profiling overhead.
+void BM_SigprofOverhead(benchmark::State& state) {
+  const int interval = state.range(0);
+  Cleanup restore = InstallCountingHandler(SIGPROF, SA_RESTART);
+  struct itimerval itv = {};
+  itv.it_interval.tv_usec = interval;
+  itv.it_value.tv_usec = interval;
+  Cleanup restore_timer =
+      ASSERT_NO_ERRNO_AND_VALUE(ScopedItimer(ITIMER_PROF, itv));
+
+  signals_handled = 0;
+  for (auto _ : state) {
+    Spin();
+  }
+
+  state.counters["signals"] =
+      benchmark::Counter(signals_handled, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_SigprofOverhead)
+    ->Arg(0)
+    ->Arg(10000)
+    ->Arg(1000)
+    ->Arg(100)
+    ->UseRealTime();
+
 #ifdef __x86_64__
 
 void FixupHandler(int sig, siginfo_t* si, void* void_ctx) {
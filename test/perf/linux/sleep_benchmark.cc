@@ -17,8 +17,12 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <cstdint>
+
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
 #include "test/util/logging.h"
 
 namespace gvisor {
@@ -54,6 +58,43 @@ BENCHMARK(BM_Sleep)
     ->Arg(50 * 1000 * 1000)  // 50ms
     ->UseRealTime();
 
+// Sleep until deadlines 'param' nanoseconds apart with clock_nanosleep and
+// TIMER_ABSTIME, as a frame-paced loop would. The latency percentiles are the
+// overshoot of each wake-up past its deadline.
+void BM_SleepAbsolute(benchmark::State& state) {
+  const int64_t period = state.range(0);
+
+  LatencyRecorder latency(state, absl::StrCat("BM_SleepAbsolute/", period));
+  struct timespec now;
+  TEST_CHECK(clock_gettime(CLOCK_MONOTONIC, &now) == 0);
+  int64_t deadline = now.tv_sec * 1000000000LL + now.tv_nsec;
+  for (auto _ : state) {
+    deadline += period;
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000LL;
+    ts.tv_nsec = deadline % 1000000000LL;
+    int ret;
+    do {
+      ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    } while (ret == EINTR);
+    TEST_CHECK(ret == 0);
+
+    TEST_CHECK(clock_gettime(CLOCK_MONOTONIC, &now) == 0);
+    const int64_t woke = now.tv_sec * 1000000000LL + now.tv_nsec;
+    latency.Record(woke - deadline);
+    // Don't try to catch up on missed deadlines.
+    if (woke - deadline > period) {
+      deadline = woke;
+    }
+  }
+}
+
+BENCHMARK(BM_SleepAbsolute)
+    ->Arg(100 * 1000)        // 100us
+    ->Arg(1000 * 1000)       // 1ms
+    ->Arg(10 * 1000 * 1000)  // 10ms
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
@@ -0,0 +1,263 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure the operations used by VM image and database
+// tooling to create, inspect and copy large sparse files: fallocate(2),
+// including FALLOC_FL_PUNCH_HOLE, iterating over the extents of a file with
+// SEEK_DATA and SEEK_HOLE, and copying with copy_file_range(2), sendfile(2)
+// or read(2) and write(2). Files are in the test's temporary directory
+// (gofer-backed, or an overlay, depending on the test variant) or in
+// /dev/shm (tmpfs).
+
+enum Filesystem {
+  kTestTmpdir,
+  kDevShm,
+};
+
+constexpr int64_t kMiB = 1 << 20;
+
+// Size of the files punched, iterated over and copied.
+constexpr int64_t kFileSize = 64 * kMiB;
+
+// Size of the chunks written when creating files, and copied at a time.
+constexpr int64_t kChunkSize = kMiB;
+
+TempPath NewFile(Filesystem fs) {
+  return TEST_CHECK_NO_ERRNO_AND_VALUE(fs == kDevShm
+                                           ? TempPath::CreateFileIn("/dev/shm")
+                                           : TempPath::CreateFile());
+}
+
+// WriteExtents writes len bytes of non-zero data every stride bytes of fd,
+// up to kFileSize, which is also its final size.
+void WriteExtents(int fd, int64_t len, int64_t stride) {
+  const std::string data(len, 'a');
+  for (int64_t off = 0; off < kFileSize; off += stride) {
+    TEST_CHECK(PwriteFd(fd, data.data(), len, off) == len);
+  }
+  TEST_PCHECK(ftruncate(fd, kFileSize) == 0);
+}
+
+// BM_Fallocate measures allocating a file of the given size with
+// fallocate(2), then truncating it back to empty.
+void BM_Fallocate(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const int64_t size = state.range(1);
+
+  const TempPath path = NewFile(fs);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  if (fallocate(fd.get(), 0, 0, size) < 0) {
+    TEST_PCHECK(errno == EOPNOTSUPP);
+    state.SkipWithError("fallocate not supported");
+    return;
+  }
+
+  for (auto _ : state) {
+    TEST_PCHECK(ftruncate(fd.get(), 0) == 0);
+    TEST_PCHECK(fallocate(fd.get(), 0, 0, size) == 0);
+  }
+
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_Fallocate)
+    ->ArgsProduct({{kTestTmpdir, kDevShm}, {kMiB, 16 * kMiB, 256 * kMiB}})
+    ->ArgNames({"fs", "size"})
+    ->UseRealTime();
+
+// BM_PunchHole measures punching holes of the given size at every other
+// hole-sized chunk of a fully written file, as done to discard the freed
+// blocks of a disk image. The file is rewritten between iterations.
+void BM_PunchHole(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const int64_t hole = state.range(1);
+
+  const TempPath path = NewFile(fs);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  WriteExtents(fd.get(), kChunkSize, kChunkSize);
+  constexpr int kMode = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+  if (fallocate(fd.get(), kMode, 0, hole) < 0) {
+    TEST_PCHECK(errno == EOPNOTSUPP);
+    state.SkipWithError("FALLOC_FL_PUNCH_HOLE not supported");
+    return;
+  }
+
+  int64_t holes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    WriteExtents(fd.get(), kChunkSize, kChunkSize);
+    state.ResumeTiming();
+    for (int64_t off = 0; off < kFileSize; off += 2 * hole) {
+      TEST_PCHECK(fallocate(fd.get(), kMode, off, hole) == 0);
+      holes++;
+    }
+  }
+
+  state.SetItemsProcessed(holes);
+}
+
+BENCHMARK(BM_PunchHole)
+    ->ArgsProduct({{kTestTmpdir, kDevShm}, {4 << 10, 64 << 10, kMiB}})
+    ->ArgNames({"fs", "hole"})
+    ->UseRealTime();
+
+// BM_SeekDataHole measures iterating over all data extents of a sparse file
+// with SEEK_DATA and SEEK_HOLE, as done by sparse-aware copy tools, for files
+// of increasing fragmentation. The number of extents found is reported as
+// extents; it is 1 on filesystems that report the whole file as data.
+void BM_SeekDataHole(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const int64_t extents = state.range(1);
+
+  const TempPath path = NewFile(fs);
+  const FileDescriptor fd =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path.path(), O_RDWR));
+  // Each extent is 4KiB of data, followed by a hole to the next one.
+  WriteExtents(fd.get(), 4 << 10, kFileSize / extents);
+  if (lseek(fd.get(), 0, SEEK_DATA) < 0) {
+    TEST_PCHECK(errno == EINVAL);
+    state.SkipWithError("SEEK_DATA not supported");
+    return;
+  }
+
+  int64_t found = 0;
+  for (auto _ : state) {
+    found = 0;
+    off_t off = 0;
+    while ((off = lseek(fd.get(), off, SEEK_DATA)) >= 0) {
+      off = lseek(fd.get(), off, SEEK_HOLE);
+      TEST_PCHECK(off >= 0);
+      found++;
+    }
+    TEST_PCHECK(errno == ENXIO);
+  }
+
+  state.counters["extents"] = found;
+  state.SetItemsProcessed(state.iterations() * found);
+}
+
+BENCHMARK(BM_SeekDataHole)
+    ->ArgsProduct({{kTestTmpdir, kDevShm}, {16, 256, 4096}})
+    ->ArgNames({"fs", "extents"})
+    ->UseRealTime();
+
+enum CopyMethod {
+  kReadWrite,
+  kSendfile,
+  kCopyFileRange,
+};
+
+// Copy copies kFileSize bytes from src to dst using method.
+void Copy(CopyMethod method, int src, int dst) {
+  std::vector<char> buf;
+  if (method == kReadWrite) {
+    buf.resize(kChunkSize);
+  }
+  for (int64_t off = 0; off < kFileSize;) {
+    const int64_t len = std::min(kChunkSize, kFileSize - off);
+    ssize_t n = 0;
+    switch (method) {
+      case kReadWrite:
+        n = PreadFd(src, buf.data(), len, off);
+        TEST_PCHECK(n > 0);
+        TEST_PCHECK(PwriteFd(dst, buf.data(), n, off) == n);
+        off += n;
+        break;
+      case kSendfile: {
+        // sendfile only reads at an offset, the write is at dst's offset.
+        off_t src_off = off;
+        n = sendfile(dst, src, &src_off, len);
+        TEST_PCHECK(n > 0);
+        off = src_off;
+        break;
+      }
+      case kCopyFileRange: {
+        loff_t src_off = off, dst_off = off;
+        n = syscall(SYS_copy_file_range, src, &src_off, dst, &dst_off, len, 0);
+        TEST_PCHECK(n > 0);
+        off = src_off;
+        break;
+      }
+    }
+  }
+}
+
+// BM_Copy measures copying a file, either fully written or sparse with 4KiB
+// of data every MiB, into an empty file.
+void BM_Copy(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const CopyMethod method = static_cast<CopyMethod>(state.range(1));
+  const bool sparse = state.range(2);
+
+  const TempPath src_path = NewFile(fs);
+  const TempPath dst_path = NewFile(fs);
+  const FileDescriptor src =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(src_path.path(), O_RDWR));
+  const FileDescriptor dst =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Open(dst_path.path(), O_RDWR));
+  WriteExtents(src.get(), sparse ? 4 << 10 : kChunkSize, kChunkSize);
+  if (method == kCopyFileRange &&
+      syscall(SYS_copy_file_range, src.get(), nullptr, dst.get(), nullptr, 0,
+              0) < 0) {
+    TEST_PCHECK(errno == ENOSYS);
+    state.SkipWithError("copy_file_range not supported");
+    return;
+  }
+
+  for (auto _ : state) {
+    TEST_PCHECK(ftruncate(dst.get(), 0) == 0);
+    TEST_PCHECK(lseek(dst.get(), 0, SEEK_SET) == 0);
+    Copy(method, src.get(), dst.get());
+  }
+
+  state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+
+BENCHMARK(BM_Copy)
+    ->ArgsProduct({{kTestTmpdir, kDevShm},
+                   {kReadWrite, kSendfile, kCopyFileRange},
+                   {0, 1}})
+    ->ArgNames({"fs", "method", "sparse"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
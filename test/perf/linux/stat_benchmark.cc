@@ -12,14 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
 #include "test/util/fs_util.h"
+#include "test/util/logging.h"
 #include "test/util/temp_path.h"
 #include "test/util/test_util.h"
 
@@ -56,6 +64,116 @@ void BM_Stat(benchmark::State& state) {
 
 BENCHMARK(BM_Stat)->Range(1, 100)->UseRealTime();
 
+// The benchmarks below model interpreters and dynamic loaders probing search
+// paths (PYTHONPATH, LD_LIBRARY_PATH, node_modules) for names that mostly
+// don't exist. The search directories are in the test's temporary directory
+// (gofer-backed, or an overlay, depending on the test variant) or in /dev/shm
+// (tmpfs), as selected by an argument.
+enum Filesystem {
+  kTestTmpdir,
+  kDevShm,
+};
+
+// Operation probing for a name.
+enum Probe {
+  kStat,
+  kOpen,
+};
+
+// CreateNestedDir creates depth nested directories in a new directory on fs,
+// returning the new directory and the innermost path.
+std::pair<TempPath, std::string> CreateNestedDir(Filesystem fs, int depth) {
+  TempPath top = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      fs == kDevShm ? TempPath::CreateDirIn("/dev/shm")
+                    : TempPath::CreateDir());
+  std::string path = top.path();
+  while (depth-- > 0) {
+    // The top directory's destructor cleans up the whole tree.
+    path = JoinPath(path, absl::StrCat(depth));
+    TEST_CHECK_NO_ERRNO(Mkdir(path, 0755));
+  }
+  return {std::move(top), path};
+}
+
+// ProbeFails checks that probing path fails with ENOENT.
+void ProbeFails(Probe probe, const char* path) {
+  if (probe == kStat) {
+    struct stat st;
+    TEST_CHECK(stat(path, &st) == -1 && errno == ENOENT);
+  } else {
+    TEST_CHECK(open(path, O_RDONLY) == -1 && errno == ENOENT);
+  }
+}
+
+// BM_StatMissing probes for a missing name in a directory at the given depth.
+// Compare with BM_Stat at the same depth for the cost of ENOENT relative to
+// success. The name is the same in every iteration (1), which the dentry
+// cache may remember as negative, or different every time (0), which it can't.
+void BM_StatMissing(benchmark::State& state) {
+  const int depth = state.range(0);
+  const Filesystem fs = static_cast<Filesystem>(state.range(1));
+  const Probe probe = static_cast<Probe>(state.range(2));
+  const bool same = state.range(3);
+  const auto [top, dir] = CreateNestedDir(fs, depth);
+
+  const std::string missing = JoinPath(dir, "missing");
+  uint64_t i = 0;
+  for (auto _ : state) {
+    if (same) {
+      ProbeFails(probe, missing.c_str());
+    } else {
+      ProbeFails(probe, absl::StrCat(missing, i++).c_str());
+    }
+  }
+}
+
+BENCHMARK(BM_StatMissing)
+    ->ArgsProduct({{1, 8, 64}, {kTestTmpdir, kDevShm}, {kStat, kOpen}, {0, 1}})
+    ->ArgNames({"depth", "fs", "open", "same"})
+    ->UseRealTime();
+
+// BM_SearchPath looks a module up along a search path of state.range(0)
+// directories, each 4 deep, and finds it only in the last one, as an
+// interpreter importing a module from the end of its path does. Each
+// iteration is one lookup, so it costs state.range(0) - 1 failed probes and
+// one successful one.
+void BM_SearchPath(benchmark::State& state) {
+  constexpr int kDepth = 4;
+  const int dirs = state.range(0);
+  const Filesystem fs = static_cast<Filesystem>(state.range(1));
+  const Probe probe = static_cast<Probe>(state.range(2));
+
+  std::vector<TempPath> tops;
+  std::vector<std::string> candidates;
+  for (int i = 0; i < dirs; i++) {
+    auto [top, dir] = CreateNestedDir(fs, kDepth);
+    tops.push_back(std::move(top));
+    candidates.push_back(JoinPath(dir, "module.py"));
+  }
+  TEST_CHECK_NO_ERRNO(CreateWithContents(candidates.back(), "", 0644));
+
+  for (auto _ : state) {
+    for (int i = 0; i < dirs - 1; i++) {
+      ProbeFails(probe, candidates[i].c_str());
+    }
+    if (probe == kStat) {
+      struct stat st;
+      TEST_CHECK(stat(candidates.back().c_str(), &st) == 0);
+    } else {
+      const int fd = open(candidates.back().c_str(), O_RDONLY);
+      TEST_CHECK(fd >= 0);
+      close(fd);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SearchPath)
+    ->ArgsProduct({{1, 4, 16, 64}, {kTestTmpdir, kDevShm}, {kStat, kOpen}})
+    ->ArgNames({"dirs", "fs", "open"})
+    ->UseRealTime();
+
 }  // namespace
 
 }  // namespace testing
@@ -0,0 +1,159 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks model the commit path of a write-ahead log: each
+// iteration appends a batch of records and then makes them durable. Items
+// per second are commits per second. Run them on gofer, directfs and overlay
+// backed filesystems to compare the cost of durability on each.
+
+// The size of one log record.
+constexpr int kRecordSize = 4096;
+
+// The size of a log segment. Appends wrap around to the start of the file
+// once they reach it, like a recycled segment.
+constexpr uint64_t kSegmentSize = 64 << 20;
+
+// How each commit is made durable.
+enum class SyncMode {
+  kNone = 0,
+  kFsync = 1,
+  kFdatasync = 2,
+  kSyncFileRange = 3,
+};
+
+// Log appends records to a file opened with the given flags.
+class Log {
+ public:
+  Log(const std::string& path, int flags)
+      : fd_(TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path, O_WRONLY | flags))),
+        buf_(kRecordSize) {
+    RandomizeBuffer(buf_.data(), buf_.size());
+  }
+
+  // Append writes records records and returns the offset of the first one.
+  uint64_t Append(int records) {
+    if (offset_ + records * kRecordSize > kSegmentSize) {
+      offset_ = 0;
+    }
+    const uint64_t start = offset_;
+    for (int i = 0; i < records; i++) {
+      TEST_CHECK(PwriteFd(fd_.get(), buf_.data(), buf_.size(), offset_) ==
+                 kRecordSize);
+      offset_ += kRecordSize;
+    }
+    return start;
+  }
+
+  int fd() const { return fd_.get(); }
+
+ private:
+  FileDescriptor fd_;
+  std::vector<char> buf_;
+  uint64_t offset_ = 0;
+};
+
+// BM_WriteSync appends batch records and then syncs them with the given
+// SyncMode. kSyncFileRange waits for writeback of just the appended range,
+// which does not flush metadata or the device cache, so it is the cheapest
+// (and weakest) option.
+void BM_WriteSync(benchmark::State& state) {
+  const int batch = state.range(0);
+  const SyncMode mode = static_cast<SyncMode>(state.range(1));
+
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  Log log(file.path(), 0);
+
+  LatencyRecorder latency(
+      state, absl::StrCat("BM_WriteSync/", batch, "/", state.range(1)));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    const uint64_t offset = log.Append(batch);
+    switch (mode) {
+      case SyncMode::kNone:
+        break;
+      case SyncMode::kFsync:
+        TEST_PCHECK(fsync(log.fd()) == 0);
+        break;
+      case SyncMode::kFdatasync:
+        TEST_PCHECK(fdatasync(log.fd()) == 0);
+        break;
+      case SyncMode::kSyncFileRange:
+        TEST_PCHECK(sync_file_range(log.fd(), offset, batch * kRecordSize,
+                                    SYNC_FILE_RANGE_WAIT_BEFORE |
+                                        SYNC_FILE_RANGE_WRITE |
+                                        SYNC_FILE_RANGE_WAIT_AFTER) == 0);
+        break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(batch) * kRecordSize *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_WriteSync)
+    ->ArgsProduct({{1, 8, 64}, {0, 1, 2, 3}})
+    ->ArgNames({"batch", "sync"})
+    ->UseRealTime();
+
+// BM_WriteOpenSync appends batch records to a file opened with O_DSYNC
+// (false) or O_SYNC (true), so that every write is durable when it returns.
+void BM_WriteOpenSync(benchmark::State& state) {
+  const int batch = state.range(0);
+  const bool osync = state.range(1);
+
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  Log log(file.path(), osync ? O_SYNC : O_DSYNC);
+
+  LatencyRecorder latency(
+      state, absl::StrCat("BM_WriteOpenSync/", batch, "/", osync));
+  for (auto _ : state) {
+    LatencyRecorder::Iteration it(latency);
+    log.Append(batch);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(batch) * kRecordSize *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_WriteOpenSync)
+    ->ArgsProduct({{1, 8, 64}, {0, 1}})
+    ->ArgNames({"batch", "osync"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
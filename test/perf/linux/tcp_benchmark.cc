@@ -0,0 +1,263 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks mirror netperf's TCP_RR and TCP_CRR tests over loopback.
+
+// ReadFull reads exactly n bytes from fd. It returns false on EOF.
+bool ReadFull(int fd, char* buf, size_t n) {
+  while (n > 0) {
+    int ret = RetryEINTR(read)(fd, buf, n);
+    TEST_PCHECK(ret >= 0);
+    if (ret == 0) {
+      return false;
+    }
+    buf += ret;
+    n -= ret;
+  }
+  return true;
+}
+
+// WriteFull writes exactly n bytes to fd.
+void WriteFull(int fd, const char* buf, size_t n) {
+  while (n > 0) {
+    int ret = RetryEINTR(write)(fd, buf, n);
+    TEST_PCHECK(ret > 0);
+    buf += ret;
+    n -= ret;
+  }
+}
+
+void SetNoDelay(int fd) {
+  TEST_PCHECK(setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &kSockOptOn,
+                         sizeof(kSockOptOn)) == 0);
+}
+
+// CloseWithReset closes fd with an RST rather than a FIN, so that the
+// connection leaves no TIME-WAIT state behind. Benchmarks that open a
+// connection per iteration would otherwise exhaust the ephemeral ports.
+void CloseWithReset(int fd) {
+  struct linger l = {};
+  l.l_onoff = 1;
+  TEST_PCHECK(setsockopt(fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l)) == 0);
+  TEST_PCHECK(close(fd) == 0);
+}
+
+// BM_TCPRR measures the round-trip latency of a size-byte request echoed
+// back by a server thread. Each benchmark thread is an independent flow with
+// its own connection and server thread.
+void BM_TCPRR(benchmark::State& state) {
+  const int size = state.range(0);
+  auto pair = ASSERT_NO_ERRNO_AND_VALUE(
+      TCPAcceptBindSocketPairCreator(AF_INET, SOCK_STREAM, 0,
+                                     /*dual_stack=*/false)());
+  const int client = pair->first_fd();
+  const int server = pair->second_fd();
+  SetNoDelay(client);
+  SetNoDelay(server);
+
+  ScopedThread echo([server, size] {
+    std::vector<char> buf(size);
+    while (ReadFull(server, buf.data(), size)) {
+      WriteFull(server, buf.data(), size);
+    }
+  });
+
+  std::vector<char> buf(size);
+  RandomizeBuffer(buf.data(), size);
+  {
+    LatencyRecorder latency(state, absl::StrCat("BM_TCPRR/", size));
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      WriteFull(client, buf.data(), size);
+      TEST_CHECK(ReadFull(client, buf.data(), size));
+    }
+  }
+
+  TEST_PCHECK(shutdown(client, SHUT_WR) == 0);
+  echo.Join();
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_TCPRR)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(16 << 10)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// BM_TCPCRR measures a full connect, request, response and close per
+// iteration.
+void BM_TCPCRR(benchmark::State& state) {
+  const int size = state.range(0);
+  // Reuse one listener for the whole process rather than binding a new one
+  // every time the benchmark is run.
+  static const Creator<SocketPair>* const creator = new Creator<SocketPair>(
+      TCPAcceptBindPersistentListenerSocketPairCreator(AF_INET, SOCK_STREAM, 0,
+                                                       /*dual_stack=*/false));
+
+  std::vector<char> buf(size);
+  RandomizeBuffer(buf.data(), size);
+  {
+    LatencyRecorder latency(state, absl::StrCat("BM_TCPCRR/", size));
+    for (auto _ : state) {
+      LatencyRecorder::Iteration it(latency);
+      auto pair = TEST_CHECK_NO_ERRNO_AND_VALUE((*creator)());
+      WriteFull(pair->first_fd(), buf.data(), size);
+      TEST_CHECK(ReadFull(pair->second_fd(), buf.data(), size));
+      WriteFull(pair->second_fd(), buf.data(), size);
+      TEST_CHECK(ReadFull(pair->first_fd(), buf.data(), size));
+      TEST_PCHECK(close(pair->release_second_fd()) == 0);
+      CloseWithReset(pair->release_first_fd());
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_TCPCRR)->Arg(1)->Arg(1024)->UseRealTime();
+
+// ReuseportServer is a group of SO_REUSEPORT listeners on one loopback port,
+// each with a thread that accepts connections and immediately closes them.
+class ReuseportServer {
+ public:
+  explicit ReuseportServer(int listeners) {
+    addr_.sin_family = AF_INET;
+    addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int i = 0; i < listeners; i++) {
+      FileDescriptor fd = TEST_CHECK_NO_ERRNO_AND_VALUE(
+          Socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0));
+      TEST_PCHECK(setsockopt(fd.get(), SOL_SOCKET, SO_REUSEPORT, &kSockOptOn,
+                             sizeof(kSockOptOn)) == 0);
+      TEST_PCHECK(bind(fd.get(), AsSockAddr(&addr_), sizeof(addr_)) == 0);
+      if (i == 0) {
+        // Let the first listener pick the port the rest join.
+        socklen_t addrlen = sizeof(addr_);
+        TEST_PCHECK(getsockname(fd.get(), AsSockAddr(&addr_), &addrlen) == 0);
+      }
+      TEST_PCHECK(listen(fd.get(), SOMAXCONN) == 0);
+      listeners_.push_back(std::move(fd));
+    }
+    for (const FileDescriptor& fd : listeners_) {
+      const int listener = fd.get();
+      threads_.push_back(std::make_unique<ScopedThread>(
+          [this, listener] { Accept(listener); }));
+    }
+  }
+
+  ~ReuseportServer() {
+    done_.store(true);
+    threads_.clear();
+  }
+
+  const sockaddr_in& addr() const { return addr_; }
+
+ private:
+  // Accept polls with a timeout so that it notices done_ without needing a
+  // final connection to every listener.
+  void Accept(int listener) {
+    struct pollfd pfd = {listener, POLLIN, 0};
+    while (!done_.load()) {
+      int n = RetryEINTR(poll)(&pfd, 1, 10);
+      TEST_PCHECK(n >= 0);
+      if (n == 0) {
+        continue;
+      }
+      int fd = accept4(listener, nullptr, nullptr, 0);
+      if (fd < 0) {
+        // Another thread may have raced us to the connection.
+        TEST_PCHECK(errno == EAGAIN || errno == ECONNABORTED);
+        continue;
+      }
+      TEST_PCHECK(close(fd) == 0);
+    }
+  }
+
+  sockaddr_in addr_ = {};
+  std::vector<FileDescriptor> listeners_;
+  std::atomic<bool> done_{false};
+  std::vector<std::unique_ptr<ScopedThread>> threads_;
+};
+
+ReuseportServer* reuseport_server;
+
+// BM_TCPAcceptReuseport measures the connection rate against a port served
+// by several SO_REUSEPORT listeners. Every benchmark thread is a client that
+// connects, waits for the server to accept and close the connection, and
+// closes its end.
+void BM_TCPAcceptReuseport(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    reuseport_server = new ReuseportServer(state.range(0));
+  }
+
+  for (auto _ : state) {
+    FileDescriptor fd =
+        TEST_CHECK_NO_ERRNO_AND_VALUE(Socket(AF_INET, SOCK_STREAM, 0));
+    const sockaddr_in& addr = reuseport_server->addr();
+    TEST_PCHECK(RetryEINTR(connect)(fd.get(), AsSockAddr(&addr),
+                                    sizeof(addr)) == 0);
+    char c;
+    TEST_PCHECK(RetryEINTR(read)(fd.get(), &c, 1) == 0);
+    CloseWithReset(fd.release());
+  }
+
+  if (state.thread_index() == 0) {
+    delete reuseport_server;
+    reuseport_server = nullptr;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_TCPAcceptReuseport)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->ArgName("listeners")
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,227 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/benchmark_latency.h"
+#include "test/util/cleanup.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/signal_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+#include "test/util/timer_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// The periodic benchmarks below report the wake-up jitter of each expiration
+// as latency percentiles: the time from when the timer was due to expire to
+// when the benchmark observed it. For frame-paced workloads the tail of that
+// distribution matters more than the mean.
+
+// MonotonicNanos returns the current CLOCK_MONOTONIC time in nanoseconds.
+int64_t MonotonicNanos() {
+  struct timespec ts;
+  TEST_PCHECK(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Periodic arms a timer to fire every period nanoseconds, starting one period
+// from now, and returns the time of the first expiration.
+struct itimerspec Periodic(int64_t period, int64_t* first) {
+  *first = MonotonicNanos() + period;
+  struct itimerspec its = {};
+  its.it_interval.tv_nsec = period;
+  its.it_value.tv_sec = *first / 1000000000LL;
+  its.it_value.tv_nsec = *first % 1000000000LL;
+  return its;
+}
+
+// Jitter tracks the expected expiration times of a periodic timer.
+class Jitter {
+ public:
+  Jitter(LatencyRecorder& latency, int64_t first, int64_t period)
+      : latency_(latency), next_(first), period_(period) {}
+
+  // Expired records that the timer expired expirations times, the last of
+  // which was observed now.
+  void Expired(uint64_t expirations) {
+    const int64_t due = next_ + (expirations - 1) * period_;
+    latency_.Record(MonotonicNanos() - due);
+    next_ = due + period_;
+    total_ += expirations;
+    overruns_ += expirations - 1;
+  }
+
+  void Report(benchmark::State& state) {
+    state.SetItemsProcessed(total_);
+    state.counters["overruns"] = overruns_;
+  }
+
+ private:
+  LatencyRecorder& latency_;
+  int64_t next_;
+  const int64_t period_;
+  uint64_t total_ = 0;
+  uint64_t overruns_ = 0;
+};
+
+// Periods of 1ms, 250us and 100us, that is 1kHz to 10kHz.
+void Periods(benchmark::internal::Benchmark* b) {
+  b->Arg(1000000)->Arg(250000)->Arg(100000)->ArgName("period_ns");
+}
+
+// BM_TimerfdPeriodic reads a periodic timerfd, one expiration per iteration.
+void BM_TimerfdPeriodic(benchmark::State& state) {
+  const int64_t period = state.range(0);
+  const FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(
+      TimerfdCreate(CLOCK_MONOTONIC, /*flags=*/0));
+
+  LatencyRecorder latency(state, absl::StrCat("BM_TimerfdPeriodic/", period));
+  int64_t first;
+  const struct itimerspec its = Periodic(period, &first);
+  TEST_PCHECK(timerfd_settime(fd.get(), TFD_TIMER_ABSTIME, &its, nullptr) ==
+              0);
+  Jitter jitter(latency, first, period);
+  for (auto _ : state) {
+    uint64_t expirations;
+    TEST_CHECK(ReadFd(fd.get(), &expirations, sizeof(expirations)) ==
+               sizeof(expirations));
+    jitter.Expired(expirations);
+  }
+  jitter.Report(state);
+}
+
+BENCHMARK(BM_TimerfdPeriodic)->Apply(Periods)->UseRealTime();
+
+// BM_TimerfdSettime arms a timerfd far in the future and disarms it again.
+void BM_TimerfdSettime(benchmark::State& state) {
+  const FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(
+      TimerfdCreate(CLOCK_MONOTONIC, /*flags=*/0));
+  struct itimerspec arm = {};
+  arm.it_value.tv_sec = 3600;
+  const struct itimerspec disarm = {};
+
+  for (auto _ : state) {
+    TEST_PCHECK(timerfd_settime(fd.get(), 0, &arm, nullptr) == 0);
+    TEST_PCHECK(timerfd_settime(fd.get(), 0, &disarm, nullptr) == 0);
+  }
+}
+
+BENCHMARK(BM_TimerfdSettime)->UseRealTime();
+
+// BM_TimerSignalThread is BM_TimerfdPeriodic with a POSIX timer that signals
+// the calling thread with SIGEV_THREAD_ID, consumed with sigwaitinfo.
+void BM_TimerSignalThread(benchmark::State& state) {
+  const int64_t period = state.range(0);
+  const int sig = SIGRTMIN;
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, sig);
+  const Cleanup restore_mask =
+      ASSERT_NO_ERRNO_AND_VALUE(ScopedSignalMask(SIG_BLOCK, set));
+
+  struct sigevent sev = {};
+  sev.sigev_notify = SIGEV_THREAD_ID;
+  sev.sigev_signo = sig;
+  sev.sigev_notify_thread_id = gettid();
+  const IntervalTimer timer =
+      ASSERT_NO_ERRNO_AND_VALUE(TimerCreate(CLOCK_MONOTONIC, sev));
+
+  LatencyRecorder latency(state,
+                          absl::StrCat("BM_TimerSignalThread/", period));
+  int64_t first;
+  ASSERT_NO_ERRNO(timer.Set(TIMER_ABSTIME, Periodic(period, &first)));
+  Jitter jitter(latency, first, period);
+  for (auto _ : state) {
+    siginfo_t info;
+    TEST_CHECK(RetryEINTR(sigwaitinfo)(&set, &info) == sig);
+    // si_overrun counts the expirations that were merged into this signal.
+    jitter.Expired(info.si_overrun + 1);
+  }
+  jitter.Report(state);
+}
+
+BENCHMARK(BM_TimerSignalThread)->Apply(Periods)->UseRealTime();
+
+// BM_TimerfdManyArmed is BM_TimerfdPeriodic at 1kHz while a number of other
+// POSIX timers are armed with staggered 1ms periods. The other timers use
+// SIGEV_NONE, so they cost only timer bookkeeping and not signal delivery.
+void BM_TimerfdManyArmed(benchmark::State& state) {
+  const int timers = state.range(0);
+  constexpr int64_t kPeriod = 1000000;
+
+  struct sigevent sev = {};
+  sev.sigev_notify = SIGEV_NONE;
+  std::vector<IntervalTimer> others;
+  others.reserve(timers);
+  for (int i = 0; i < timers; i++) {
+    PosixErrorOr<IntervalTimer> timer = TimerCreate(CLOCK_MONOTONIC, sev);
+    if (!timer.ok()) {
+      // Each POSIX timer counts against RLIMIT_SIGPENDING.
+      state.SkipWithError(
+          absl::StrCat("timer_create: ", timer.error().ToString()).c_str());
+      return;
+    }
+    struct itimerspec its = {};
+    its.it_interval.tv_nsec = kPeriod;
+    its.it_value.tv_nsec = 1 + (kPeriod * i) / timers;
+    ASSERT_NO_ERRNO(timer.ValueOrDie().Set(0, its));
+    others.push_back(std::move(timer.ValueOrDie()));
+  }
+
+  const FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(
+      TimerfdCreate(CLOCK_MONOTONIC, /*flags=*/0));
+  LatencyRecorder latency(state,
+                          absl::StrCat("BM_TimerfdManyArmed/", timers));
+  int64_t first;
+  const struct itimerspec its = Periodic(kPeriod, &first);
+  TEST_PCHECK(timerfd_settime(fd.get(), TFD_TIMER_ABSTIME, &its, nullptr) ==
+              0);
+  Jitter jitter(latency, first, kPeriod);
+  for (auto _ : state) {
+    uint64_t expirations;
+    TEST_CHECK(ReadFd(fd.get(), &expirations, sizeof(expirations)) ==
+               sizeof(expirations));
+    jitter.Expired(expirations);
+  }
+  jitter.Report(state);
+}
+
+BENCHMARK(BM_TimerfdManyArmed)
+    ->Arg(0)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->ArgName("timers")
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
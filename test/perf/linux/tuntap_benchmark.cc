@@ -0,0 +1,369 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/if_ether.h>
+#include <linux/if_tun.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/socket_netlink_route_util.h"
+#include "test/syscalls/linux/socket_netlink_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/linux_capability_util.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks move frames through a TAP device the way a userspace VPN
+// endpoint does: each benchmark thread owns one queue of the device, and
+// either injects frames addressed to the local stack or reads the frames the
+// stack sends out.
+
+constexpr char kTapName[] = "tapbench0";
+constexpr uint16_t kPort = 5001;
+
+#define kTapAddr htonl(0x0a000001)      /* 10.0.0.1 */
+#define kPeerAddr htonl(0x0a000002)     /* 10.0.0.2 */
+#define kBroadcastAddr htonl(0x0a0000ff) /* 10.0.0.255 */
+
+constexpr uint8_t kTapMac[ETH_ALEN] = {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA};
+constexpr uint8_t kPeerMac[ETH_ALEN] = {0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB};
+
+// struct virtio_net_hdr, whose header linux/virtio_net.h is not valid C++.
+// Its size is the default TUNSETVNETHDRSZ.
+struct VirtioNetHdr {
+  uint8_t flags;
+  uint8_t gso_type;
+  uint16_t hdr_len;
+  uint16_t gso_size;
+  uint16_t csum_start;
+  uint16_t csum_offset;
+};
+
+// Large enough for any frame read from the device.
+constexpr size_t kMaxFrame = 65536;
+
+// Tap is a TAP device with one fd per queue. The device is destroyed when
+// the last queue is closed.
+class Tap {
+ public:
+  // Creates the device with the given number of queues. IFF_MULTI_QUEUE is
+  // requested if queues > 1, and IFF_VNET_HDR if vnet is set; both fail with
+  // EINVAL where unsupported.
+  static PosixErrorOr<std::unique_ptr<Tap>> Create(int queues, bool vnet) {
+    if (!IsRunningOnGvisor()) {
+      ASSIGN_OR_RETURN_ERRNO(bool have_cap, HaveCapability(CAP_NET_ADMIN));
+      if (!have_cap) {
+        return PosixError(EPERM, "CAP_NET_ADMIN required");
+      }
+    }
+    std::unique_ptr<Tap> tap(new Tap(vnet));
+    for (int i = 0; i < queues; i++) {
+      // Writes never block, and readers poll all queues.
+      ASSIGN_OR_RETURN_ERRNO(FileDescriptor fd,
+                             Open("/dev/net/tun", O_RDWR | O_NONBLOCK));
+      struct ifreq ifr = {};
+      ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+      if (queues > 1) {
+        ifr.ifr_flags |= IFF_MULTI_QUEUE;
+      }
+      if (vnet) {
+        ifr.ifr_flags |= IFF_VNET_HDR;
+      }
+      strncpy(ifr.ifr_name, kTapName, IFNAMSIZ);
+      RETURN_ERROR_IF_SYSCALL_FAIL(ioctl(fd.get(), TUNSETIFF, &ifr));
+      tap->queues_.push_back(std::move(fd));
+    }
+
+    ASSIGN_OR_RETURN_ERRNO(std::vector<Link> links, DumpLinks());
+    const Link* link = nullptr;
+    for (const auto& l : links) {
+      if (l.name == kTapName) {
+        link = &l;
+      }
+    }
+    if (link == nullptr) {
+      return PosixError(ENOENT, "TAP interface not found");
+    }
+    ASSIGN_OR_RETURN_ERRNO(FileDescriptor nlsk,
+                           NetlinkBoundSocket(NETLINK_ROUTE));
+    const struct in_addr addr = {.s_addr = kTapAddr};
+    RETURN_IF_ERRNO(LinkAddLocalAddr(nlsk, link->index, AF_INET,
+                                     /*prefixlen=*/24, &addr, sizeof(addr)));
+    // gVisor always creates interfaces up, and does not support changing
+    // their MAC address.
+    if (IsRunningOnGvisor()) {
+      if (link->address.size() != ETH_ALEN) {
+        return PosixError(EINVAL, "TAP interface has no MAC address");
+      }
+      memcpy(tap->mac_, link->address.data(), ETH_ALEN);
+    } else {
+      RETURN_IF_ERRNO(LinkSetMacAddr(link->index, kTapMac, sizeof(kTapMac)));
+      RETURN_IF_ERRNO(LinkChangeFlags(link->index, IFF_UP, IFF_UP));
+      memcpy(tap->mac_, kTapMac, ETH_ALEN);
+    }
+    return tap;
+  }
+
+  int queue(int i) const { return queues_[i].get(); }
+  int queues() const { return queues_.size(); }
+  const uint8_t* mac() const { return mac_; }
+
+  // Returns the length of the header preceding each frame.
+  size_t header_len() const { return vnet_ ? sizeof(VirtioNetHdr) : 0; }
+
+ private:
+  explicit Tap(bool vnet) : vnet_(vnet) {}
+
+  const bool vnet_;
+  std::vector<FileDescriptor> queues_;
+  uint8_t mac_[ETH_ALEN];
+};
+
+// Frame returns an Ethernet frame of the given size, preceded by a virtio-net
+// header if the device uses one, carrying a UDP datagram from the peer to
+// kPort on the local stack.
+std::vector<char> Frame(const Tap& tap, size_t size) {
+  std::vector<char> buf(tap.header_len() + size);
+  // A zeroed VirtioNetHdr is VIRTIO_NET_HDR_GSO_NONE without checksum
+  // offload.
+  char* p = buf.data() + tap.header_len();
+
+  struct ethhdr* eth = reinterpret_cast<struct ethhdr*>(p);
+  memcpy(eth->h_dest, tap.mac(), ETH_ALEN);
+  memcpy(eth->h_source, kPeerMac, ETH_ALEN);
+  eth->h_proto = htons(ETH_P_IP);
+
+  struct iphdr* ip = reinterpret_cast<struct iphdr*>(eth + 1);
+  ip->ihl = 5;
+  ip->version = 4;
+  ip->tot_len = htons(size - sizeof(*eth));
+  ip->frag_off = htons(IP_DF);
+  ip->ttl = 64;
+  ip->protocol = IPPROTO_UDP;
+  ip->saddr = kPeerAddr;
+  ip->daddr = kTapAddr;
+  ip->check = IPChecksum(*ip);
+
+  // A zero UDP checksum means none was computed.
+  struct udphdr* udp = reinterpret_cast<struct udphdr*>(ip + 1);
+  udp->source = htons(kPort);
+  udp->dest = htons(kPort);
+  udp->len = htons(size - sizeof(*eth) - sizeof(*ip));
+  return buf;
+}
+
+constexpr size_t kMinFrame =
+    sizeof(struct ethhdr) + sizeof(struct iphdr) + sizeof(struct udphdr);
+
+// The device and sink shared by the threads of the running benchmark.
+// Thread 0 creates and destroys them.
+Tap* tap;
+
+// SetUp is called by every benchmark thread before the benchmark loop. Only
+// thread 0 creates the device, with one queue per thread; if that fails it
+// skips the benchmark, and the other threads must check Ready() once the
+// loop has started.
+void SetUp(benchmark::State& state, bool vnet) {
+  if (state.thread_index() != 0) {
+    return;
+  }
+  PosixErrorOr<std::unique_ptr<Tap>> t = Tap::Create(state.threads(), vnet);
+  if (!t.ok()) {
+    state.SkipWithError(t.error().ToString().c_str());
+    return;
+  }
+  tap = t.ValueOrDie().release();
+}
+
+bool Ready(benchmark::State& state) {
+  if (tap == nullptr) {
+    state.SkipWithError("TAP device setup failed");
+    return false;
+  }
+  return true;
+}
+
+void TearDown(benchmark::State& state) {
+  if (state.thread_index() != 0) {
+    return;
+  }
+  delete tap;
+  tap = nullptr;
+}
+
+// BM_TapWrite injects frames into the stack, each thread through its own
+// queue. The frames are delivered to a bound UDP socket that is never read,
+// so once its buffer fills they are dropped after UDP demultiplexing.
+void BM_TapWrite(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const bool vnet = state.range(1);
+  SetUp(state, vnet);
+
+  FileDescriptor sink;
+  if (state.thread_index() == 0 && tap != nullptr) {
+    sink = FileDescriptor(socket(AF_INET, SOCK_DGRAM, 0));
+    TEST_PCHECK(sink.get() >= 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(kPort),
+        .sin_addr = {.s_addr = kTapAddr},
+    };
+    TEST_PCHECK(bind(sink.get(), reinterpret_cast<struct sockaddr*>(&addr),
+                     sizeof(addr)) == 0);
+  }
+
+  std::vector<char> frame;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    if (!Ready(state)) {
+      break;
+    }
+    if (frame.empty()) {
+      frame = Frame(*tap, size);
+    }
+    const int fd = tap->queue(state.thread_index());
+    TEST_PCHECK(write(fd, frame.data(), frame.size()) ==
+                static_cast<ssize_t>(frame.size()));
+    bytes += size;
+  }
+
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_TapWrite)
+    ->ArgsProduct({{64, 512, 1514}, {0, 1}})
+    ->ArgNames({"size", "vnet"})
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+
+// BM_TapRead reads frames that sender threads transmit through the device,
+// as UDP broadcasts so that no neighbour resolution is needed. The device
+// spreads flows over its queues by hash, so each thread reads whichever queue
+// is ready rather than only its own.
+void BM_TapRead(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const bool vnet = state.range(1);
+  SetUp(state, vnet);
+
+  // Thread 0 starts one sender per queue, each with its own source port.
+  std::atomic<bool> done(false);
+  std::vector<std::unique_ptr<ScopedThread>> senders;
+  if (state.thread_index() == 0 && tap != nullptr) {
+    for (int i = 0; i < tap->queues(); i++) {
+      senders.push_back(std::make_unique<ScopedThread>([&done, size] {
+        FileDescriptor s(socket(AF_INET, SOCK_DGRAM, 0));
+        TEST_PCHECK(s.get() >= 0);
+        int one = 1;
+        TEST_PCHECK(setsockopt(s.get(), SOL_SOCKET, SO_BROADCAST, &one,
+                               sizeof(one)) == 0);
+        struct sockaddr_in src = {
+            .sin_family = AF_INET,
+            .sin_addr = {.s_addr = kTapAddr},
+        };
+        TEST_PCHECK(bind(s.get(), reinterpret_cast<struct sockaddr*>(&src),
+                         sizeof(src)) == 0);
+        struct sockaddr_in dst = {
+            .sin_family = AF_INET,
+            .sin_port = htons(kPort),
+            .sin_addr = {.s_addr = kBroadcastAddr},
+        };
+        std::vector<char> payload(size - kMinFrame);
+        while (!done.load(std::memory_order_relaxed)) {
+          int n = sendto(s.get(), payload.data(), payload.size(), 0,
+                         reinterpret_cast<struct sockaddr*>(&dst),
+                         sizeof(dst));
+          // The device queue may be full.
+          TEST_PCHECK(n >= 0 || errno == ENOBUFS || errno == EAGAIN);
+        }
+      }));
+    }
+  }
+
+  std::vector<char> buf(kMaxFrame);
+  std::vector<struct pollfd> pfds;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    if (!Ready(state)) {
+      break;
+    }
+    if (pfds.empty()) {
+      for (int i = 0; i < tap->queues(); i++) {
+        pfds.push_back({.fd = tap->queue(i), .events = POLLIN});
+      }
+    }
+    while (true) {
+      TEST_PCHECK(RetryEINTR(poll)(pfds.data(), pfds.size(), -1) > 0);
+      ssize_t n = -1;
+      for (const auto& pfd : pfds) {
+        if (pfd.revents & POLLIN) {
+          // Another thread may have taken the frame.
+          n = read(pfd.fd, buf.data(), buf.size());
+          if (n >= 0) {
+            break;
+          }
+          TEST_PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+      }
+      if (n >= 0) {
+        bytes += n - tap->header_len();
+        break;
+      }
+    }
+  }
+
+  done.store(true);
+  senders.clear();
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_TapRead)
+    ->ArgsProduct({{64, 512, 1514}, {0, 1}})
+    ->ArgNames({"size", "vnet"})
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
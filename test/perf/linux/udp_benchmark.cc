@@ -0,0 +1,446 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/ip_socket_test_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/posix_error.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// kSegmentSize is a typical QUIC datagram size, and the segment size used by
+// the GSO and GRO benchmarks.
+constexpr int kSegmentSize = 1400;
+
+// kMaxGSOSegments keeps a GSO send under the 64KB UDP payload limit.
+constexpr int kMaxGSOSegments = 44;
+
+// kBufSize is the socket buffer size requested on both ends, so that the
+// receiver can absorb bursts from the sender.
+constexpr int kBufSize = 4 << 20;
+
+// MMsgBuffers is a batch of mmsghdrs, each with its own size-byte buffer.
+class MMsgBuffers {
+ public:
+  MMsgBuffers(int batch, int size)
+      : buf_(static_cast<size_t>(batch) * size), iovs_(batch), msgs_(batch) {
+    RandomizeBuffer(buf_.data(), buf_.size());
+    for (int i = 0; i < batch; i++) {
+      iovs_[i].iov_base = buf_.data() + static_cast<size_t>(i) * size;
+      iovs_[i].iov_len = size;
+      msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+      msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  struct mmsghdr* msgs() { return msgs_.data(); }
+  unsigned int batch() const { return msgs_.size(); }
+
+ private:
+  std::vector<char> buf_;
+  std::vector<struct iovec> iovs_;
+  std::vector<struct mmsghdr> msgs_;
+};
+
+// NewPair returns a pair of connected UDP loopback sockets with enlarged
+// buffers. The receiving end (second) times out after 10ms so that helper
+// threads can notice when a benchmark is done.
+std::unique_ptr<SocketPair> NewPair() {
+  auto pair = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      UDPBidirectionalBindSocketPairCreator(AF_INET, SOCK_DGRAM, 0,
+                                            /*dual_stack=*/false)());
+  // Failure leaves the default sizes, which is still correct.
+  setsockopt(pair->first_fd(), SOL_SOCKET, SO_SNDBUF, &kBufSize,
+             sizeof(kBufSize));
+  setsockopt(pair->second_fd(), SOL_SOCKET, SO_RCVBUF, &kBufSize,
+             sizeof(kBufSize));
+  struct timeval tv = {};
+  tv.tv_usec = 10000;
+  TEST_PCHECK(setsockopt(pair->second_fd(), SOL_SOCKET, SO_RCVTIMEO, &tv,
+                         sizeof(tv)) == 0);
+  return pair;
+}
+
+// Drain receives and discards datagrams from fd until done is set.
+void Drain(int fd, const std::atomic<bool>& done) {
+  MMsgBuffers bufs(64, 64 << 10);
+  while (!done.load()) {
+    int n = recvmmsg(fd, bufs.msgs(), bufs.batch(), MSG_WAITFORONE, nullptr);
+    TEST_PCHECK(n >= 0 || errno == EAGAIN || errno == EINTR);
+  }
+}
+
+// BM_UDPSendmmsg measures the cost of sending batches of size-byte datagrams
+// with a single sendmmsg(2).
+void BM_UDPSendmmsg(benchmark::State& state) {
+  const int size = state.range(0);
+  const int batch = state.range(1);
+  std::unique_ptr<SocketPair> pair = NewPair();
+
+  std::atomic<bool> done(false);
+  ScopedThread drain([&] { Drain(pair->second_fd(), done); });
+
+  MMsgBuffers bufs(batch, size);
+  int64_t sent = 0;
+  for (auto _ : state) {
+    int n = sendmmsg(pair->first_fd(), bufs.msgs(), batch, 0);
+    TEST_PCHECK(n > 0 || errno == EINTR);
+    if (n > 0) {
+      sent += n;
+    }
+  }
+
+  done.store(true);
+  drain.Join();
+
+  state.SetItemsProcessed(sent);
+  state.SetBytesProcessed(sent * size);
+}
+
+BENCHMARK(BM_UDPSendmmsg)
+    ->ArgsProduct({{64, kSegmentSize}, {1, 4, 16, 64}})
+    ->ArgNames({"size", "batch"})
+    ->UseRealTime();
+
+// BM_UDPRecvmmsg measures the cost of receiving up to batch size-byte
+// datagrams per recvmmsg(2) while another thread floods the socket.
+void BM_UDPRecvmmsg(benchmark::State& state) {
+  const int size = state.range(0);
+  const int batch = state.range(1);
+  std::unique_ptr<SocketPair> pair = NewPair();
+
+  std::atomic<bool> done(false);
+  ScopedThread flood([&] {
+    MMsgBuffers bufs(64, size);
+    while (!done.load()) {
+      int n = sendmmsg(pair->first_fd(), bufs.msgs(), bufs.batch(), 0);
+      TEST_PCHECK(n > 0 || errno == EINTR);
+    }
+  });
+
+  MMsgBuffers bufs(batch, size);
+  int64_t received = 0;
+  for (auto _ : state) {
+    int n = recvmmsg(pair->second_fd(), bufs.msgs(), batch, MSG_WAITFORONE,
+                     nullptr);
+    TEST_PCHECK(n > 0 || errno == EAGAIN || errno == EINTR);
+    if (n > 0) {
+      received += n;
+    }
+  }
+
+  done.store(true);
+  flood.Join();
+
+  state.SetItemsProcessed(received);
+  state.SetBytesProcessed(received * size);
+}
+
+BENCHMARK(BM_UDPRecvmmsg)
+    ->ArgsProduct({{64, kSegmentSize}, {1, 4, 16, 64}})
+    ->ArgNames({"size", "batch"})
+    ->UseRealTime();
+
+// EnableGSO sets the UDP_SEGMENT size on fd. It returns false and reports
+// the failure through state if UDP GSO is not supported.
+bool EnableGSO(benchmark::State& state, int fd) {
+  if (setsockopt(fd, SOL_UDP, UDP_SEGMENT, &kSegmentSize,
+                 sizeof(kSegmentSize)) < 0) {
+    state.SkipWithError(
+        absl::StrCat("UDP_SEGMENT unsupported: ", strerror(errno)).c_str());
+    return false;
+  }
+  return true;
+}
+
+// BM_UDPSendGSO sends segments * kSegmentSize bytes per send(2) with
+// UDP_SEGMENT, which the stack splits into kSegmentSize datagrams. Compare
+// with BM_UDPSendmmsg/size:1400 at the same batch size.
+void BM_UDPSendGSO(benchmark::State& state) {
+  const int segments = state.range(0);
+  std::unique_ptr<SocketPair> pair = NewPair();
+  if (!EnableGSO(state, pair->first_fd())) {
+    return;
+  }
+
+  std::atomic<bool> done(false);
+  ScopedThread drain([&] { Drain(pair->second_fd(), done); });
+
+  std::vector<char> buf(segments * kSegmentSize);
+  RandomizeBuffer(buf.data(), buf.size());
+  for (auto _ : state) {
+    int n = send(pair->first_fd(), buf.data(), buf.size(), 0);
+    TEST_PCHECK(n == static_cast<int>(buf.size()) || errno == EINTR);
+  }
+
+  done.store(true);
+  drain.Join();
+
+  state.SetItemsProcessed(static_cast<int64_t>(segments) * state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(buf.size()) *
+                          state.iterations());
+}
+
+BENCHMARK(BM_UDPSendGSO)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(kMaxGSOSegments)
+    ->ArgName("segments")
+    ->UseRealTime();
+
+// BM_UDPRecvGRO receives with UDP_GRO enabled while another thread floods
+// the socket with GSO sends of segments * kSegmentSize bytes. Coalesced
+// datagrams arrive as one payload of up to 64KB per recvmsg(2). Compare with
+// BM_UDPRecvmmsg/size:1400.
+void BM_UDPRecvGRO(benchmark::State& state) {
+  const int segments = state.range(0);
+  std::unique_ptr<SocketPair> pair = NewPair();
+  if (!EnableGSO(state, pair->first_fd())) {
+    return;
+  }
+  if (setsockopt(pair->second_fd(), SOL_UDP, UDP_GRO, &kSockOptOn,
+                 sizeof(kSockOptOn)) < 0) {
+    state.SkipWithError(
+        absl::StrCat("UDP_GRO unsupported: ", strerror(errno)).c_str());
+    return;
+  }
+
+  std::atomic<bool> done(false);
+  ScopedThread flood([&] {
+    std::vector<char> buf(segments * kSegmentSize);
+    RandomizeBuffer(buf.data(), buf.size());
+    while (!done.load()) {
+      int n = send(pair->first_fd(), buf.data(), buf.size(), 0);
+      TEST_PCHECK(n > 0 || errno == EINTR);
+    }
+  });
+
+  std::vector<char> buf(64 << 10);
+  // Room for the UDP_GRO control message carrying the segment size.
+  char control[CMSG_SPACE(sizeof(uint16_t))];
+  int64_t received = 0;
+  for (auto _ : state) {
+    struct iovec iov = {buf.data(), buf.size()};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    int n = recvmsg(pair->second_fd(), &msg, 0);
+    TEST_PCHECK(n > 0 || errno == EAGAIN || errno == EINTR);
+    if (n > 0) {
+      received += n;
+    }
+  }
+
+  done.store(true);
+  flood.Join();
+
+  state.SetItemsProcessed(received / kSegmentSize);
+  state.SetBytesProcessed(received);
+}
+
+BENCHMARK(BM_UDPRecvGRO)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(kMaxGSOSegments)
+    ->ArgName("segments")
+    ->UseRealTime();
+
+// Receiver is one of the sockets joined to the multicast group in
+// BM_UDPMulticastFanout, with a thread that drains it.
+struct Receiver {
+  FileDescriptor fd;
+  std::atomic<int64_t> received{0};
+  std::unique_ptr<ScopedThread> drain;
+};
+
+// JoinGroup binds fd to the group's port, with SO_REUSEADDR so that every
+// receiver can share it, and joins the group on the loopback interface.
+void JoinGroup(int fd, const TestAddress& group, int ifindex) {
+  TEST_PCHECK(setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &kSockOptOn,
+                         sizeof(kSockOptOn)) == 0);
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &kBufSize, sizeof(kBufSize));
+  TEST_PCHECK(bind(fd, AsSockAddr(&group.addr), group.addr_len) == 0);
+  if (group.family() == AF_INET) {
+    ip_mreqn mreq = {};
+    mreq.imr_multiaddr =
+        reinterpret_cast<const sockaddr_in*>(&group.addr)->sin_addr;
+    mreq.imr_ifindex = ifindex;
+    TEST_PCHECK(setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq,
+                           sizeof(mreq)) == 0);
+  } else {
+    ipv6_mreq mreq = {};
+    mreq.ipv6mr_multiaddr =
+        reinterpret_cast<const sockaddr_in6*>(&group.addr)->sin6_addr;
+    mreq.ipv6mr_interface = ifindex;
+    TEST_PCHECK(setsockopt(fd, IPPROTO_IPV6, IPV6_ADD_MEMBERSHIP, &mreq,
+                           sizeof(mreq)) == 0);
+  }
+}
+
+// BM_UDPMulticastFanout sends batches of 16 size-byte datagrams to a
+// multicast group on loopback joined by state.range(1) receiving sockets,
+// each drained by its own thread. Every datagram is delivered to every
+// receiver, so the cost of cloning packets for delivery grows with the
+// number of receivers. state.range(2) selects IPv4 (4) or IPv6 (6).
+//
+// Besides the send rate, it reports the rate at which each receiver gets
+// datagrams and the fraction of deliveries that were dropped.
+void BM_UDPMulticastFanout(benchmark::State& state) {
+  constexpr int kBatch = 16;
+  const int size = state.range(0);
+  const int receivers = state.range(1);
+  const int family = state.range(2) == 4 ? AF_INET : AF_INET6;
+  const int ifindex = TEST_CHECK_NO_ERRNO_AND_VALUE(GetLoopbackIndex());
+
+  FileDescriptor sender =
+      TEST_CHECK_NO_ERRNO_AND_VALUE(Socket(family, SOCK_DGRAM, 0));
+  setsockopt(sender.get(), SOL_SOCKET, SO_SNDBUF, &kBufSize, sizeof(kBufSize));
+  int ret;
+  if (family == AF_INET) {
+    ip_mreqn mreq = {};
+    mreq.imr_ifindex = ifindex;
+    ret = setsockopt(sender.get(), IPPROTO_IP, IP_MULTICAST_IF, &mreq,
+                     sizeof(mreq));
+  } else {
+    ret = setsockopt(sender.get(), IPPROTO_IPV6, IPV6_MULTICAST_IF, &ifindex,
+                     sizeof(ifindex));
+  }
+  if (ret < 0) {
+    state.SkipWithError(
+        absl::StrCat("multicast on loopback unsupported: ", strerror(errno))
+            .c_str());
+    return;
+  }
+
+  // The first receiver picks the port; the others share it.
+  TestAddress group = family == AF_INET ? V4Multicast() : V6Multicast();
+  std::vector<std::unique_ptr<Receiver>> rx;
+  for (int i = 0; i < receivers; i++) {
+    auto r = std::make_unique<Receiver>();
+    r->fd = TEST_CHECK_NO_ERRNO_AND_VALUE(Socket(family, SOCK_DGRAM, 0));
+    JoinGroup(r->fd.get(), group, ifindex);
+    if (i == 0) {
+      sockaddr_storage bound;
+      socklen_t len = sizeof(bound);
+      TEST_PCHECK(getsockname(r->fd.get(), AsSockAddr(&bound), &len) == 0);
+      const uint16_t port =
+          TEST_CHECK_NO_ERRNO_AND_VALUE(AddrPort(family, bound));
+      TEST_CHECK_NO_ERRNO(SetAddrPort(family, &group.addr, port));
+    }
+    struct timeval tv = {};
+    tv.tv_usec = 10000;
+    TEST_PCHECK(setsockopt(r->fd.get(), SOL_SOCKET, SO_RCVTIMEO, &tv,
+                           sizeof(tv)) == 0);
+    rx.push_back(std::move(r));
+  }
+
+  // Connecting routes the group, which fails if the host has no route for
+  // it, e.g. without IPv6.
+  if (connect(sender.get(), AsSockAddr(&group.addr), group.addr_len) < 0) {
+    state.SkipWithError(
+        absl::StrCat("connect to group failed: ", strerror(errno)).c_str());
+    return;
+  }
+
+  // Drain threads keep receiving after the benchmark is done, until their
+  // socket is empty, so that datagrams still queued aren't counted as lost.
+  std::atomic<bool> done(false);
+  for (auto& r : rx) {
+    Receiver* const raw = r.get();
+    r->drain = std::make_unique<ScopedThread>([raw, &done] {
+      MMsgBuffers bufs(64, 64 << 10);
+      while (true) {
+        int n = recvmmsg(raw->fd.get(), bufs.msgs(), bufs.batch(),
+                         MSG_WAITFORONE, nullptr);
+        if (n > 0) {
+          raw->received += n;
+        } else {
+          TEST_PCHECK(errno == EAGAIN || errno == EINTR);
+          if (errno == EAGAIN && done.load()) {
+            break;
+          }
+        }
+      }
+    });
+  }
+
+  MMsgBuffers bufs(kBatch, size);
+  int64_t sent = 0;
+  for (auto _ : state) {
+    int n = sendmmsg(sender.get(), bufs.msgs(), kBatch, 0);
+    TEST_PCHECK(n > 0 || errno == EINTR || errno == ENOBUFS);
+    if (n > 0) {
+      sent += n;
+    }
+  }
+
+  done.store(true);
+  int64_t received = 0;
+  for (auto& r : rx) {
+    r->drain->Join();
+    received += r->received.load();
+  }
+
+  state.SetItemsProcessed(sent);
+  state.SetBytesProcessed(sent * size);
+  state.counters["per_receiver"] = benchmark::Counter(
+      static_cast<double>(received) / receivers, benchmark::Counter::kIsRate);
+  state.counters["loss"] =
+      sent > 0 ? 1 - static_cast<double>(received) / (sent * receivers) : 0;
+}
+
+BENCHMARK(BM_UDPMulticastFanout)
+    ->ArgsProduct({{64, kSegmentSize}, {1, 2, 4, 8, 16, 32}, {4, 6}})
+    ->ArgNames({"size", "receivers", "ip"})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
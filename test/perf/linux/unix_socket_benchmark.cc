@@ -0,0 +1,189 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/syscalls/linux/unix_domain_socket_test_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/socket_util.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// BM_UnixThroughput writes messages of the given size to one end of an
+// AF_UNIX socketpair of the given type (SOCK_STREAM = 1, SOCK_DGRAM = 2 or
+// SOCK_SEQPACKET = 5) while another thread drains the other end.
+void BM_UnixThroughput(benchmark::State& state) {
+  const int type = state.range(0);
+  const int size = state.range(1);
+  std::unique_ptr<SocketPair> sockets =
+      ASSERT_NO_ERRNO_AND_VALUE(UnixDomainSocketPair(type).Create());
+
+  ScopedThread drain([&] {
+    std::vector<char> buf(type == SOCK_STREAM ? 1 << 16 : size);
+    while (true) {
+      int n = RetryEINTR(recv)(sockets->second_fd(), buf.data(), buf.size(), 0);
+      TEST_PCHECK(n >= 0);
+      if (n == 0) {
+        return;
+      }
+    }
+  });
+
+  std::vector<char> buf(size);
+  RandomizeBuffer(buf.data(), buf.size());
+  for (auto _ : state) {
+    TEST_CHECK(WriteFd(sockets->first_fd(), buf.data(), buf.size()) == size);
+  }
+
+  // Message-oriented sockets don't signal EOF on shutdown to the peer, so
+  // end the drain thread with an empty message instead.
+  if (type == SOCK_STREAM) {
+    TEST_PCHECK(shutdown(sockets->first_fd(), SHUT_WR) == 0);
+  } else {
+    TEST_PCHECK(send(sockets->first_fd(), nullptr, 0, 0) == 0);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(size) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_UnixThroughput)
+    ->ArgsProduct({{SOCK_STREAM, SOCK_DGRAM, SOCK_SEQPACKET},
+                   {64, 1024, 16 << 10, 64 << 10}})
+    ->ArgNames({"type", "size"})
+    ->UseRealTime();
+
+// BM_UnixSCMRights passes the given number of fds in one SCM_RIGHTS message
+// over a SOCK_STREAM socketpair, receives them and closes the received copies.
+// Items per second are fds passed per second.
+void BM_UnixSCMRights(benchmark::State& state) {
+  const int nfds = state.range(0);
+  std::unique_ptr<SocketPair> sockets =
+      ASSERT_NO_ERRNO_AND_VALUE(UnixDomainSocketPair(SOCK_STREAM).Create());
+
+  std::vector<FileDescriptor> files;
+  std::vector<int> fds;
+  for (int i = 0; i < nfds; i++) {
+    files.push_back(ASSERT_NO_ERRNO_AND_VALUE(Open("/dev/null", O_RDONLY)));
+    fds.push_back(files.back().get());
+  }
+
+  std::vector<char> control(CMSG_SPACE(nfds * sizeof(int)));
+  char byte = 0;
+  for (auto _ : state) {
+    struct iovec iov = {&byte, sizeof(byte)};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    memcpy(CMSG_DATA(cmsg), fds.data(), nfds * sizeof(int));
+    TEST_CHECK(RetryEINTR(sendmsg)(sockets->first_fd(), &msg, 0) == 1);
+
+    msg.msg_controllen = control.size();
+    TEST_CHECK(RetryEINTR(recvmsg)(sockets->second_fd(), &msg, 0) == 1);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    TEST_CHECK(cmsg != nullptr && cmsg->cmsg_type == SCM_RIGHTS &&
+               cmsg->cmsg_len == CMSG_LEN(nfds * sizeof(int)));
+    const int* received = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+    for (int i = 0; i < nfds; i++) {
+      TEST_PCHECK(close(received[i]) == 0);
+    }
+  }
+
+  state.SetItemsProcessed(nfds * state.iterations());
+}
+
+// SCM_MAX_FD in Linux is 253.
+BENCHMARK(BM_UnixSCMRights)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(253)
+    ->ArgName("fds")
+    ->UseRealTime();
+
+// BM_UnixSCMCredentials sends and receives 64 byte messages over a
+// SOCK_STREAM socketpair, either plainly (0) or with explicit SCM_CREDENTIALS
+// sent and SO_PASSCRED set on the receiver (1).
+void BM_UnixSCMCredentials(benchmark::State& state) {
+  const bool creds = state.range(0);
+  std::unique_ptr<SocketPair> sockets =
+      ASSERT_NO_ERRNO_AND_VALUE(UnixDomainSocketPair(SOCK_STREAM).Create());
+  if (creds) {
+    SetSoPassCred(sockets->second_fd());
+  }
+
+  struct ucred ucred = {};
+  ucred.pid = getpid();
+  ucred.uid = getuid();
+  ucred.gid = getgid();
+  char control[CMSG_SPACE(sizeof(ucred))];
+  char buf[64] = {};
+  for (auto _ : state) {
+    struct iovec iov = {buf, sizeof(buf)};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (creds) {
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+      cmsg->cmsg_len = CMSG_LEN(sizeof(ucred));
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_CREDENTIALS;
+      memcpy(CMSG_DATA(cmsg), &ucred, sizeof(ucred));
+    }
+    TEST_CHECK(RetryEINTR(sendmsg)(sockets->first_fd(), &msg, 0) ==
+               sizeof(buf));
+
+    msg.msg_controllen = creds ? sizeof(control) : 0;
+    TEST_CHECK(RetryEINTR(recvmsg)(sockets->second_fd(), &msg, 0) ==
+               sizeof(buf));
+    if (creds) {
+      struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+      TEST_CHECK(cmsg != nullptr && cmsg->cmsg_type == SCM_CREDENTIALS);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_UnixSCMCredentials)->Arg(0)->Arg(1)->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -15,10 +15,17 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "benchmark/benchmark.h"
+#include "test/util/cleanup.h"
+#include "test/util/file_descriptor.h"
 #include "test/util/logging.h"
 #include "test/util/temp_path.h"
 #include "test/util/test_util.h"
@@ -46,17 +53,132 @@ void BM_Write(benchmark::State& state) {
 
 BENCHMARK(BM_Write)->Range(1, 1 << 26)->UseRealTime();
 
-void BM_Append(benchmark::State& state) {
-  auto file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
-  auto fd = ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_WRONLY | O_APPEND));
+// The append benchmarks below model loggers: many threads or processes
+// appending records of state.range(0) bytes to one O_APPEND file, which is
+// in the test's temporary directory (gofer-backed, or an overlay, depending
+// on the test variant) or in /dev/shm (tmpfs), as selected by
+// state.range(1). Every append must update the shared end of file.
+enum Filesystem {
+  kTestTmpdir,
+  kDevShm,
+};
 
-  const char data = 'a';
+// The appended file is truncated when a writer has appended this many bytes
+// to it, so that long runs don't fill the filesystem.
+constexpr int64_t kMaxAppended = 64 << 20;
+
+TempPath CreateAppendFile(Filesystem fs) {
+  return TEST_CHECK_NO_ERRNO_AND_VALUE(
+      fs == kDevShm ? TempPath::CreateFileIn("/dev/shm")
+                    : TempPath::CreateFile());
+}
+
+// Appender appends records of a fixed size to a file through its own file
+// descriptor.
+class Appender {
+ public:
+  Appender(const std::string& path, int size)
+      : fd_(TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path, O_WRONLY | O_APPEND))),
+        buf_(size, 'a') {}
+
+  void Append() {
+    TEST_CHECK(WriteFd(fd_.get(), buf_.data(), buf_.size()) ==
+               static_cast<ssize_t>(buf_.size()));
+    if ((appended_ += buf_.size()) >= kMaxAppended) {
+      TEST_PCHECK(ftruncate(fd_.get(), 0) == 0);
+      appended_ = 0;
+    }
+  }
+
+ private:
+  const FileDescriptor fd_;
+  const std::vector<char> buf_;
+  int64_t appended_ = 0;
+};
+
+// File appended to by all threads of BM_Append.
+TempPath* append_file;
+
+void AppendSetup(const benchmark::State& state) {
+  append_file =
+      new TempPath(CreateAppendFile(static_cast<Filesystem>(state.range(1))));
+}
+
+void AppendTeardown(const benchmark::State& state) {
+  delete append_file;
+  append_file = nullptr;
+}
+
+// BM_Append appends from every benchmark thread, each with its own file
+// descriptor.
+void BM_Append(benchmark::State& state) {
+  const int size = state.range(0);
+  Appender appender(append_file->path(), size);
   for (auto _ : state) {
-    TEST_CHECK(WriteFd(fd.get(), &data, 1) == 1);
+    appender.Append();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(size) * state.iterations());
+}
+
+BENCHMARK(BM_Append)
+    ->Setup(AppendSetup)
+    ->Teardown(AppendTeardown)
+    ->ArgsProduct({{1, 128, 4096}, {kTestTmpdir, kDevShm}})
+    ->ArgNames({"size", "fs"})
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+// BM_AppendProcesses is BM_Append with state.range(2) processes instead of
+// threads, which don't share a file descriptor table or address space.
+void BM_AppendProcesses(benchmark::State& state) {
+  const int size = state.range(0);
+  const TempPath file =
+      CreateAppendFile(static_cast<Filesystem>(state.range(1)));
+  const int processes = state.range(2);
+
+  std::vector<pid_t> children;
+  auto child_cleanup = Cleanup([&] {
+    for (const pid_t child : children) {
+      int status;
+      EXPECT_THAT(RetryEINTR(waitpid)(child, &status, 0), SyscallSucceeds());
+      EXPECT_TRUE(WIFEXITED(status));
+      EXPECT_EQ(0, WEXITSTATUS(status));
+    }
+    ASSERT_FALSE(state.KeepRunning());
+  });
+
+  // Split the iterations between the children, as in BM_CPUBoundSymmetric.
+  for (int i = 0; i < processes; i++) {
+    benchmark::IterationCount cur =
+        (state.max_iterations + (processes - 1)) / processes;
+    if ((state.iterations() + cur) >= state.max_iterations) {
+      cur = state.max_iterations - state.iterations();
+    }
+    pid_t child = fork();
+    if (child == 0) {
+      Appender appender(file.path(), size);
+      for (benchmark::IterationCount j = 0; j < cur; j++) {
+        appender.Append();
+      }
+      _exit(0);
+    }
+    ASSERT_THAT(child, SyscallSucceeds());
+    if (cur > 0) {
+      ASSERT_TRUE(state.KeepRunningBatch(cur));
+    }
+    children.push_back(child);
   }
+
+  state.SetItemsProcessed(state.max_iterations);
+  state.SetBytesProcessed(static_cast<int64_t>(size) * state.max_iterations);
 }
 
-BENCHMARK(BM_Append);
+BENCHMARK(BM_AppendProcesses)
+    ->ArgsProduct({{1, 128, 4096}, {kTestTmpdir, kDevShm}, {2, 8, 32}})
+    ->ArgNames({"size", "fs", "processes"})
+    ->UseRealTime();
 
 }  // namespace
 
@@ -0,0 +1,139 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/xattr.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// These benchmarks measure extended attribute operations, as done in bulk by
+// container image tools and file labeling, on files in the test's temporary
+// directory (gofer-backed, or an overlay, depending on the test variant) or
+// in /dev/shm (tmpfs).
+
+enum Filesystem {
+  kTestTmpdir,
+  kDevShm,
+};
+
+enum Op {
+  kGet,
+  kSet,
+  kList,
+  kRemove,
+};
+
+// Name of the attribute used by every benchmark.
+constexpr char kName[] = "user.benchmark";
+
+// Files returns n files on fs, which are removed when the returned vector is
+// destroyed.
+std::vector<TempPath> Files(Filesystem fs, int n) {
+  std::vector<TempPath> files;
+  for (int i = 0; i < n; i++) {
+    files.push_back(TEST_CHECK_NO_ERRNO_AND_VALUE(
+        fs == kDevShm ? TempPath::CreateFileIn("/dev/shm")
+                      : TempPath::CreateFile()));
+  }
+  return files;
+}
+
+void BM_Xattr(benchmark::State& state) {
+  const Filesystem fs = static_cast<Filesystem>(state.range(0));
+  const Op op = static_cast<Op>(state.range(1));
+  const size_t size = state.range(2);
+  const int nfiles = state.range(3);
+  const std::vector<TempPath> files = Files(fs, nfiles);
+  const std::string value(size, 'a');
+
+  // Every op starts from files that have the attribute, so kSet replaces it.
+  for (const TempPath& file : files) {
+    if (setxattr(file.path().c_str(), kName, value.data(), value.size(), 0) <
+        0) {
+      // e.g. ENOTSUP if the filesystem doesn't support user xattrs, or
+      // E2BIG/ENOSPC if it limits their size.
+      state.SkipWithError(
+          absl::StrCat("setxattr failed: ", strerror(errno)).c_str());
+      return;
+    }
+  }
+
+  std::vector<char> buf(std::max(size, static_cast<size_t>(XATTR_LIST_MAX)));
+  int i = 0;
+  for (auto _ : state) {
+    const char* path = files[i++ % nfiles].path().c_str();
+    switch (op) {
+      case kGet:
+        TEST_PCHECK(getxattr(path, kName, buf.data(), buf.size()) ==
+                    static_cast<ssize_t>(size));
+        break;
+      case kSet:
+        TEST_PCHECK(setxattr(path, kName, value.data(), value.size(), 0) ==
+                    0);
+        break;
+      case kList:
+        TEST_PCHECK(listxattr(path, buf.data(), buf.size()) >= 0);
+        break;
+      case kRemove:
+        TEST_PCHECK(removexattr(path, kName) == 0);
+        // Don't time putting the attribute back.
+        state.PauseTiming();
+        TEST_PCHECK(setxattr(path, kName, value.data(), value.size(), 0) ==
+                    0);
+        state.ResumeTiming();
+        break;
+    }
+  }
+
+  if (op == kGet || op == kSet) {
+    state.SetBytesProcessed(state.iterations() * size);
+  }
+}
+
+void XattrArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"fs", "op", "size", "files"});
+  for (Filesystem fs : {kTestTmpdir, kDevShm}) {
+    for (Op op : {kGet, kSet, kList, kRemove}) {
+      for (int size : {16, 1 << 10, 64 << 10}) {
+        // A single file stays in every cache; many files may not.
+        for (int files : {1, 1000}) {
+          bench->Args({fs, op, size, files});
+        }
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_Xattr)->Apply(XattrArgs);
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
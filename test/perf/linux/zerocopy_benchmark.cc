@@ -0,0 +1,318 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/logging.h"
+#include "test/util/temp_path.h"
+#include "test/util/test_util.h"
+#include "test/util/thread_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// Transfer sizes range from a page to 64MB.
+constexpr int kMinSize = 1 << 12;
+constexpr int kMaxSize = 64 << 20;
+
+// kChunkSize is the buffer size used by the read/write loops, and the pipe
+// capacity requested for the splice variants.
+constexpr int kChunkSize = 1 << 20;
+
+// Sink is a connected stream socket whose peer is drained by a background
+// thread, so writers are never blocked on a full socket buffer for long.
+class Sink {
+ public:
+  Sink() : fd_(MakeSocketPair()), drain_([this] { Drain(); }) {}
+
+  ~Sink() {
+    TEST_CHECK(shutdown(fd_.get(), SHUT_WR) == 0);
+    drain_.Join();
+  }
+
+  int fd() const { return fd_.get(); }
+
+ private:
+  FileDescriptor MakeSocketPair() {
+    int fds[2];
+    TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    peer_ = FileDescriptor(fds[1]);
+    return FileDescriptor(fds[0]);
+  }
+
+  void Drain() {
+    std::vector<char> buf(kChunkSize);
+    while (true) {
+      int n = ReadFd(peer_.get(), buf.data(), buf.size());
+      TEST_CHECK(n >= 0);
+      if (n == 0) {
+        return;
+      }
+    }
+  }
+
+  FileDescriptor peer_;
+  FileDescriptor fd_;
+  ScopedThread drain_;
+};
+
+// Pipe is a pipe with its capacity raised to kChunkSize where possible.
+struct Pipe {
+  Pipe() {
+    int fds[2];
+    TEST_CHECK(pipe(fds) == 0);
+    r = FileDescriptor(fds[0]);
+    w = FileDescriptor(fds[1]);
+    // Failure leaves the default capacity, which is still correct.
+    fcntl(w.get(), F_SETPIPE_SZ, kChunkSize);
+  }
+
+  FileDescriptor r;
+  FileDescriptor w;
+};
+
+// WriteAll writes n bytes from buf to fd.
+void WriteAll(int fd, const char* buf, size_t n) {
+  while (n > 0) {
+    int ret = WriteFd(fd, buf, n);
+    TEST_CHECK(ret > 0);
+    buf += ret;
+    n -= ret;
+  }
+}
+
+// SpliceAll moves n bytes from in to out, one of which must be a pipe.
+void SpliceAll(int in, loff_t* in_off, int out, size_t n) {
+  while (n > 0) {
+    int ret = splice(in, in_off, out, nullptr, n, SPLICE_F_MOVE);
+    TEST_CHECK(ret > 0);
+    n -= ret;
+  }
+}
+
+FileDescriptor SourceFile(TempPath* path, int size) {
+  *path = TEST_CHECK_NO_ERRNO_AND_VALUE(
+      TempPath::CreateFileWith(GetAbsoluteTestTmpdir(), std::string(size, 'a'),
+                               TempPath::kDefaultFileMode));
+  return TEST_CHECK_NO_ERRNO_AND_VALUE(Open(path->path(), O_RDONLY));
+}
+
+void SetBytes(benchmark::State& state, int64_t per_iteration) {
+  state.SetBytesProcessed(per_iteration *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// BM_FileToSocketReadWrite is the baseline for BM_FileToSocketSendfile and
+// BM_FileToSocketSplice: each chunk is copied out of the file into a user
+// buffer and back into the socket.
+void BM_FileToSocketReadWrite(benchmark::State& state) {
+  const int size = state.range(0);
+  TempPath path;
+  FileDescriptor file = SourceFile(&path, size);
+  Sink sink;
+
+  std::vector<char> buf(kChunkSize);
+  for (auto _ : state) {
+    for (int off = 0; off < size;) {
+      int n = PreadFd(file.get(), buf.data(), std::min(kChunkSize, size - off),
+                      off);
+      TEST_CHECK(n > 0);
+      WriteAll(sink.fd(), buf.data(), n);
+      off += n;
+    }
+  }
+
+  SetBytes(state, size);
+}
+
+BENCHMARK(BM_FileToSocketReadWrite)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+void BM_FileToSocketSendfile(benchmark::State& state) {
+  const int size = state.range(0);
+  TempPath path;
+  FileDescriptor file = SourceFile(&path, size);
+  Sink sink;
+
+  for (auto _ : state) {
+    off_t off = 0;
+    while (off < size) {
+      TEST_CHECK(sendfile(sink.fd(), file.get(), &off, size - off) > 0);
+    }
+  }
+
+  SetBytes(state, size);
+}
+
+BENCHMARK(BM_FileToSocketSendfile)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+// BM_FileToSocketSplice moves the file into the socket through a pipe, as
+// web servers without sendfile(2) support for their socket type do.
+void BM_FileToSocketSplice(benchmark::State& state) {
+  const int size = state.range(0);
+  TempPath path;
+  FileDescriptor file = SourceFile(&path, size);
+  Sink sink;
+  Pipe p;
+
+  for (auto _ : state) {
+    loff_t off = 0;
+    while (off < size) {
+      int n = splice(file.get(), &off, p.w.get(), nullptr, size - off,
+                     SPLICE_F_MOVE);
+      TEST_CHECK(n > 0);
+      SpliceAll(p.r.get(), nullptr, sink.fd(), n);
+    }
+  }
+
+  SetBytes(state, size);
+}
+
+BENCHMARK(BM_FileToSocketSplice)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+// BM_BufferToSocketWrite is the baseline for BM_BufferToSocketVmsplice.
+void BM_BufferToSocketWrite(benchmark::State& state) {
+  const int size = state.range(0);
+  Sink sink;
+
+  std::vector<char> buf(size);
+  RandomizeBuffer(buf.data(), size);
+  for (auto _ : state) {
+    WriteAll(sink.fd(), buf.data(), size);
+  }
+
+  SetBytes(state, size);
+}
+
+BENCHMARK(BM_BufferToSocketWrite)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+// BM_BufferToSocketVmsplice maps a user buffer into a pipe with vmsplice(2)
+// and splices the pipe into the socket.
+void BM_BufferToSocketVmsplice(benchmark::State& state) {
+  const int size = state.range(0);
+  Sink sink;
+  Pipe p;
+
+  std::vector<char> buf(size);
+  RandomizeBuffer(buf.data(), size);
+  for (auto _ : state) {
+    for (int off = 0; off < size;) {
+      struct iovec iov;
+      iov.iov_base = buf.data() + off;
+      iov.iov_len = std::min(kChunkSize, size - off);
+      int n = vmsplice(p.w.get(), &iov, 1, 0);
+      TEST_CHECK(n > 0);
+      SpliceAll(p.r.get(), nullptr, sink.fd(), n);
+      off += n;
+    }
+  }
+
+  SetBytes(state, size);
+}
+
+BENCHMARK(BM_BufferToSocketVmsplice)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+// BM_PipeFanoutReadWrite is the baseline for BM_PipeFanoutTee: data arriving
+// on a pipe is copied out once and written to two sockets.
+void BM_PipeFanoutReadWrite(benchmark::State& state) {
+  const int size = state.range(0);
+  Sink sink1, sink2;
+  Pipe in;
+
+  std::vector<char> src(kChunkSize);
+  RandomizeBuffer(src.data(), src.size());
+  std::vector<char> buf(kChunkSize);
+  for (auto _ : state) {
+    for (int off = 0; off < size;) {
+      int chunk = std::min(kChunkSize, size - off);
+      int n = WriteFd(in.w.get(), src.data(), chunk);
+      TEST_CHECK(n > 0);
+      TEST_CHECK(ReadFd(in.r.get(), buf.data(), n) == n);
+      WriteAll(sink1.fd(), buf.data(), n);
+      WriteAll(sink2.fd(), buf.data(), n);
+      off += n;
+    }
+  }
+
+  SetBytes(state, 2 * static_cast<int64_t>(size));
+}
+
+BENCHMARK(BM_PipeFanoutReadWrite)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+// BM_PipeFanoutTee duplicates the pipe contents into a second pipe with
+// tee(2) and splices each pipe into its own socket.
+void BM_PipeFanoutTee(benchmark::State& state) {
+  const int size = state.range(0);
+  Sink sink1, sink2;
+  Pipe in, dup;
+
+  std::vector<char> src(kChunkSize);
+  RandomizeBuffer(src.data(), src.size());
+  for (auto _ : state) {
+    for (int off = 0; off < size;) {
+      int chunk = std::min(kChunkSize, size - off);
+      int n = WriteFd(in.w.get(), src.data(), chunk);
+      TEST_CHECK(n > 0);
+      // Both pipes have the same capacity and dup is empty, so tee
+      // duplicates everything just written.
+      TEST_CHECK(tee(in.r.get(), dup.w.get(), n, 0) == n);
+      SpliceAll(in.r.get(), nullptr, sink1.fd(), n);
+      SpliceAll(dup.r.get(), nullptr, sink2.fd(), n);
+      off += n;
+    }
+  }
+
+  SetBytes(state, 2 * static_cast<int64_t>(size));
+}
+
+BENCHMARK(BM_PipeFanoutTee)
+    ->RangeMultiplier(8)
+    ->Range(kMinSize, kMaxSize)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -52,6 +52,7 @@ import (
 var (
 	debug              = flag.Bool("debug", false, "enable debug logs")
 	oneSandbox         = flag.Bool("one-sandbox", false, "run all test cases in one sandbox")
+	oneSandboxParallel = flag.Int("one-sandbox-parallelism", 1, "with --one-sandbox, run up to this many test cases at once, each in a forked process within the sandbox; the test binary must use //test/util:test_main")
 	strace             = flag.Bool("strace", false, "enable strace logs")
 	platform           = flag.String("platform", "ptrace", "platform to run on")
 	platformSupport    = flag.String("platform-support", "", "String passed to the test as GVISOR_PLATFORM_SUPPORT environment variable. Used to determine which syscall tests are expected to work with the current platform.")
@@ -255,17 +256,19 @@ func runTestCaseNative(testBin string, tc *gtest.TestCase, args []string, t *tes
 	}
 }
 
-func deleteIfEmptyCheckpointDir(dir string) (bool, error) {
+// deleteIfEmptyCheckpointDir returns the size of the checkpoint image in dir,
+// and deletes dir if the image is empty.
+func deleteIfEmptyCheckpointDir(dir string) (int64, bool, error) {
 	fName := filepath.Join(dir, checkpointFile)
 	fi, err := os.Stat(fName)
 	if err != nil {
-		return false, fmt.Errorf("stat error: %v", err)
+		return 0, false, fmt.Errorf("stat error: %v", err)
 	}
 	if fi.Size() > 0 {
-		return false, nil
+		return fi.Size(), false, nil
 	}
 	os.RemoveAll(dir)
-	return true, nil
+	return 0, true, nil
 }
 
 func printCheckpointDir(dir string) {
@@ -436,6 +439,11 @@ func runRunsc(tc *gtest.TestCase, spec *specs.Spec) error {
 	} else {
 		args = append(args, "-mount-cgroup-v2=false")
 	}
+	// Benchmarks collect sentry profiles through /proc/gvisor/profile when
+	// TEST_SENTRY_PROFILES is set; see test/util/test_util_impl.cc.
+	if os.Getenv("TEST_SENTRY_PROFILES") != "" {
+		args = append(args, "-profile", "-profile-app-trigger")
+	}
 
 	testLogDir := ""
 	runscLogDir := ""
@@ -624,6 +632,16 @@ func runRunsc(tc *gtest.TestCase, spec *specs.Spec) error {
 		}
 
 		// Restore the sandbox with the previous state file.
+		var (
+			checkpoints int
+			imageTotal  int64
+			imageMax    int64
+		)
+		defer func() {
+			if checkpoints > 0 {
+				log.Infof("%s: %d checkpoints, image size total %d bytes, max %d bytes", name, checkpoints, imageTotal, imageMax)
+			}
+		}()
 		for i := 1; ; i++ {
 			if signalled.Load() {
 				return fmt.Errorf("timeout")
@@ -631,13 +649,19 @@ func runRunsc(tc *gtest.TestCase, spec *specs.Spec) error {
 			currentRestoreDir := currentSaveDir
 			// Check if the latest state file is valid. If the file
 			// is empty, delete it and exit the loop.
-			isEmpty, err := deleteIfEmptyCheckpointDir(currentRestoreDir)
+			imageSize, isEmpty, err := deleteIfEmptyCheckpointDir(currentRestoreDir)
 			if err != nil {
 				return err
 			}
 			if isEmpty {
 				break
 			}
+			checkpoints++
+			imageTotal += imageSize
+			if imageSize > imageMax {
+				imageMax = imageSize
+			}
+			log.Infof("%s: checkpoint %d image is %d bytes", name, i, imageSize)
 
 			// Delete the existing sandbox.
 			if err := deleteSandbox(saveArgs, id); err != nil {
@@ -1149,6 +1173,9 @@ func main() {
 				Name: fmt.Sprintf("%s_%s", tc.Suite, tc.Name),
 				F: func(t *testing.T) {
 					args := gtest.BuildTestArgs(indices, testCases)
+					if *oneSandboxParallel > 1 {
+						args = append(args, fmt.Sprintf("--test_parallelism=%d", *oneSandboxParallel))
+					}
 					if *platform == "native" {
 						// Run the test case on host.
 						runTestCaseNative(testBin, &tc, args, t)
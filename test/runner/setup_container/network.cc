@@ -0,0 +1,155 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/runner/setup_container/network.h"
+
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "test/syscalls/linux/socket_netlink_util.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/posix_error.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// RequestBatch builds a buffer of rtnetlink requests that are sent with a
+// single sendmsg, each asking for an ack.
+class RequestBatch {
+ public:
+  // Add appends a request of the given type whose payload is the len bytes at
+  // msg.
+  void Add(uint16_t type, uint16_t flags, const void* msg, size_t len) {
+    last_ = buf_.size();
+    buf_.resize(last_ + NLMSG_SPACE(len));
+    struct nlmsghdr* hdr = last();
+    hdr->nlmsg_len = buf_.size() - last_;
+    hdr->nlmsg_type = type;
+    hdr->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+    hdr->nlmsg_seq = ++count_;
+    memcpy(NLMSG_DATA(hdr), msg, len);
+  }
+
+  // AddAttr appends an attribute to the last request.
+  void AddAttr(uint16_t type, const void* data, size_t len) {
+    const size_t off = buf_.size();
+    buf_.resize(off + RTA_SPACE(len));
+    struct rtattr* rta = reinterpret_cast<struct rtattr*>(&buf_[off]);
+    rta->rta_type = type;
+    rta->rta_len = RTA_LENGTH(len);
+    memcpy(RTA_DATA(rta), data, len);
+    last()->nlmsg_len = buf_.size() - last_;
+  }
+
+  // Send sends all requests and waits for their acks. Requests that fail
+  // with EEXIST are ignored; otherwise the first error is returned.
+  PosixError Send(const FileDescriptor& fd) {
+    RETURN_IF_ERRNO(NetlinkRequest(fd, buf_.data(), buf_.size()));
+
+    // The kernel acks each request separately, in order.
+    uint32_t acked = 0;
+    PosixError first = NoError();
+    while (acked < count_) {
+      RETURN_IF_ERRNO(NetlinkResponse(
+          fd,
+          [&](const struct nlmsghdr* hdr) {
+            if (hdr->nlmsg_type != NLMSG_ERROR || hdr->nlmsg_seq == 0 ||
+                hdr->nlmsg_seq > count_) {
+              return;
+            }
+            acked++;
+            const struct nlmsgerr* msg =
+                reinterpret_cast<const struct nlmsgerr*>(NLMSG_DATA(hdr));
+            if (msg->error != 0 && msg->error != -EEXIST && first.ok()) {
+              first = PosixError(-msg->error,
+                                 absl::StrCat("rtnetlink request ",
+                                              hdr->nlmsg_seq, " of ", count_,
+                                              " (type ", msg->msg.nlmsg_type,
+                                              ") failed"));
+            }
+          },
+          /*expect_nlmsgerr=*/false));
+    }
+    return first;
+  }
+
+ private:
+  struct nlmsghdr* last() {
+    return reinterpret_cast<struct nlmsghdr*>(&buf_[last_]);
+  }
+
+  std::vector<char> buf_;
+  size_t last_ = 0;
+  uint32_t count_ = 0;
+};
+
+}  // namespace
+
+PosixErrorOr<absl::Duration> ConfigureLoopback(const LoopbackConfig& config) {
+  const absl::Time start = absl::Now();
+
+  // if_nametoindex only needs an ioctl, unlike dumping links over netlink.
+  const int index = if_nametoindex("lo");
+  if (index == 0) {
+    return PosixError(errno, "if_nametoindex(lo)");
+  }
+  ASSIGN_OR_RETURN_ERRNO(FileDescriptor fd, NetlinkBoundSocket(NETLINK_ROUTE));
+
+  RequestBatch batch;
+
+  struct ifinfomsg ifinfo = {};
+  ifinfo.ifi_index = index;
+  ifinfo.ifi_flags = IFF_UP;
+  ifinfo.ifi_change = IFF_UP;
+  batch.Add(RTM_NEWLINK, 0, &ifinfo, sizeof(ifinfo));
+
+  for (const IPPrefix& addr : config.addresses) {
+    struct ifaddrmsg ifaddr = {};
+    ifaddr.ifa_family = addr.family;
+    ifaddr.ifa_prefixlen = addr.prefixlen;
+    ifaddr.ifa_index = index;
+    batch.Add(RTM_NEWADDR, NLM_F_CREATE, &ifaddr, sizeof(ifaddr));
+    batch.AddAttr(IFA_LOCAL, addr.addr.data(), addr.addr.size());
+  }
+
+  for (const IPPrefix& route : config.routes) {
+    struct rtmsg rt = {};
+    rt.rtm_family = route.family;
+    rt.rtm_dst_len = route.prefixlen;
+    rt.rtm_table = RT_TABLE_MAIN;
+    rt.rtm_protocol = RTPROT_BOOT;
+    rt.rtm_scope = RT_SCOPE_LINK;
+    rt.rtm_type = RTN_UNICAST;
+    batch.Add(RTM_NEWROUTE, NLM_F_CREATE, &rt, sizeof(rt));
+    batch.AddAttr(RTA_DST, route.addr.data(), route.addr.size());
+    batch.AddAttr(RTA_OIF, &index, sizeof(index));
+  }
+
+  RETURN_IF_ERRNO(batch.Send(fd));
+  return absl::Now() - start;
+}
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,62 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GVISOR_TEST_RUNNER_SETUP_CONTAINER_NETWORK_H_
+#define GVISOR_TEST_RUNNER_SETUP_CONTAINER_NETWORK_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "test/util/posix_error.h"
+
+namespace gvisor {
+namespace testing {
+
+// IPPrefix is an address or subnet, e.g. 10.0.0.1/8.
+struct IPPrefix {
+  // family is AF_INET or AF_INET6.
+  int family;
+
+  // addr is the address in network byte order, i.e. a struct in_addr or
+  // in6_addr.
+  std::string addr;
+
+  int prefixlen;
+};
+
+// LoopbackConfig describes how to configure the loopback interface.
+struct LoopbackConfig {
+  // addresses are added to the interface, in addition to the ones that the
+  // kernel assigns when it is brought up. Addresses that already exist are
+  // not an error.
+  std::vector<IPPrefix> addresses;
+
+  // routes are subnets routed through the interface. Routes that already
+  // exist are not an error.
+  std::vector<IPPrefix> routes;
+};
+
+// ConfigureLoopback brings up the loopback interface, then adds the addresses
+// and routes of config.
+//
+// All changes are sent to the kernel as a single batch of rtnetlink requests,
+// and the acks are read back together, so that the cost doesn't grow with a
+// round trip per change. Returns the time it took.
+PosixErrorOr<absl::Duration> ConfigureLoopback(const LoopbackConfig& config);
+
+}  // namespace testing
+}  // namespace gvisor
+
+#endif  // GVISOR_TEST_RUNNER_SETUP_CONTAINER_NETWORK_H_
@@ -13,13 +13,14 @@
 // limitations under the License.
 
 #include <linux/capability.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 
-#include "test/syscalls/linux/socket_netlink_util.h"
+#include <iostream>
+
+#include "absl/time/time.h"
+#include "test/runner/setup_container/network.h"
 #include "test/util/capability_util.h"
 #include "test/util/posix_error.h"
-#include "test/util/socket_util.h"
 
 namespace gvisor {
 namespace testing {
@@ -32,25 +33,13 @@ PosixError SetupContainer() {
     return have_net_admin.error();
   }
   if (have_net_admin.ValueOrDie()) {
-    PosixErrorOr<FileDescriptor> sockfd = Socket(AF_INET, SOCK_DGRAM, 0);
-    if (!sockfd.ok()) {
-      std::cerr << "Cannot open socket." << std::endl;
-      return sockfd.error();
-    }
-    int sock = sockfd.ValueOrDie().get();
-    struct ifreq ifr = {};
-    strncpy(ifr.ifr_name, "lo", IFNAMSIZ);
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) == -1) {
-      std::cerr << "Cannot get 'lo' flags: " << strerror(errno) << std::endl;
-      return PosixError(errno);
-    }
-    if ((ifr.ifr_flags & IFF_UP) == 0) {
-      ifr.ifr_flags |= IFF_UP;
-      if (ioctl(sock, SIOCSIFFLAGS, &ifr) == -1) {
-        std::cerr << "Cannot set 'lo' as UP: " << strerror(errno) << std::endl;
-        return PosixError(errno);
-      }
+    const PosixErrorOr<absl::Duration> elapsed =
+        ConfigureLoopback(LoopbackConfig{});
+    if (!elapsed.ok()) {
+      std::cerr << "Cannot configure 'lo': " << elapsed.error() << std::endl;
+      return elapsed.error();
     }
+    std::cerr << "Network set up in " << elapsed.ValueOrDie() << std::endl;
   } else {
     std::cerr
         << "Capability CAP_NET_ADMIN not granted, so cannot bring up "
@@ -103,6 +103,24 @@ TEST(ClockGettime, RealtimeWorks) {
   EXPECT_THAT(clock_gettime(CLOCK_REALTIME, &tp), SyscallSucceeds());
 }
 
+// CLOCK_TAI is CLOCK_REALTIME plus a whole number of (leap) seconds, which is
+// zero unless the offset has been set on the host.
+TEST(ClockGettime, TAIIsRealtimePlusLeapSeconds) {
+  struct timespec tp;
+  ASSERT_THAT(clock_gettime(CLOCK_REALTIME, &tp), SyscallSucceeds());
+  const absl::Time before = absl::TimeFromTimespec(tp);
+  ASSERT_THAT(clock_gettime(CLOCK_TAI, &tp), SyscallSucceeds());
+  const absl::Time tai = absl::TimeFromTimespec(tp);
+  ASSERT_THAT(clock_gettime(CLOCK_REALTIME, &tp), SyscallSucceeds());
+  const absl::Time after = absl::TimeFromTimespec(tp);
+
+  const absl::Duration offset =
+      absl::Seconds(absl::ToInt64Seconds(tai - before));
+  EXPECT_GE(offset, absl::ZeroDuration());
+  EXPECT_GE(tai - offset, before);
+  EXPECT_LE(tai - offset, after);
+}
+
 class MonotonicClockTest : public ::testing::TestWithParam<clockid_t> {};
 
 TEST_P(MonotonicClockTest, IsMonotonic) {
@@ -12,12 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include "gtest/gtest.h"
+#include "test/util/logging.h"
+#include "test/util/multiprocess_util.h"
 #include "test/util/test_util.h"
+#include "test/util/vdso_util.h"
 
 namespace gvisor {
 namespace testing {
@@ -57,6 +63,78 @@ TEST(GetrandomTest, IsRandom) {
   EXPECT_TRUE(SomeByteIsNonZero(random_bytes, n));
 }
 
+// The VDSO's getrandom, as described in Linux's getrandom_vdso(3).
+using VDSOGetrandomFn = ssize_t (*)(void* buf, size_t len, unsigned int flags,
+                                    void* opaque_state, size_t opaque_len);
+
+// Returned by VDSOGetrandomFn when queried for how to allocate states.
+struct VDSOGetrandomParams {
+  uint32_t size_of_opaque_state;
+  uint32_t mmap_prot;
+  uint32_t mmap_flags;
+  uint32_t reserved[13];
+};
+
+VDSOGetrandomFn VDSOGetrandom() {
+#if defined(__x86_64__)
+  return reinterpret_cast<VDSOGetrandomFn>(VDSOSymbol("__vdso_getrandom"));
+#elif defined(__aarch64__)
+  return reinterpret_cast<VDSOGetrandomFn>(VDSOSymbol("__kernel_getrandom"));
+#else
+  return nullptr;
+#endif
+}
+
+TEST(GetrandomTest, VDSO) {
+  const VDSOGetrandomFn vgetrandom = VDSOGetrandom();
+  // The VDSO getrandom was added in Linux 6.11.
+  SKIP_IF(!IsRunningOnGvisor() && vgetrandom == nullptr);
+  ASSERT_NE(vgetrandom, nullptr);
+
+  VDSOGetrandomParams params = {};
+  ASSERT_EQ(vgetrandom(nullptr, 0, 0, &params, ~0UL), 0);
+  const size_t size = params.size_of_opaque_state;
+  void* state = mmap(nullptr, size, params.mmap_prot, params.mmap_flags, -1, 0);
+  ASSERT_NE(state, MAP_FAILED);
+
+  // Sizes that are and aren't multiples of the ChaCha20 block size, and
+  // larger than the state's buffered output.
+  for (size_t len : {1, 16, 64, 100, 1000}) {
+    SCOPED_TRACE(len);
+    char a[1000];
+    char b[1000];
+    ASSERT_EQ(vgetrandom(a, len, 0, state, size), len);
+    ASSERT_EQ(vgetrandom(b, len, 0, state, size), len);
+    if (len >= 16) {
+      EXPECT_TRUE(SomeByteIsNonZero(a, len));
+      EXPECT_NE(memcmp(a, b, len), 0);
+    }
+  }
+
+  // The child of fork must not generate the same bytes as the parent from
+  // its copy of the state.
+  int fds[2];
+  ASSERT_THAT(pipe(fds), SyscallSucceeds());
+  const auto rest = [&] {
+    char child[32];
+    TEST_CHECK(vgetrandom(child, sizeof(child), 0, state, size) ==
+               sizeof(child));
+    TEST_PCHECK(WriteFd(fds[1], child, sizeof(child)) == sizeof(child));
+  };
+  EXPECT_THAT(InForkedProcess(rest), IsPosixErrorOkAndHolds(0));
+  char parent[32];
+  char child[32];
+  ASSERT_EQ(vgetrandom(parent, sizeof(parent), 0, state, size),
+            sizeof(parent));
+  ASSERT_THAT(ReadFd(fds[0], child, sizeof(child)),
+              SyscallSucceedsWithValue(sizeof(child)));
+  EXPECT_NE(memcmp(parent, child, sizeof(parent)), 0);
+
+  EXPECT_THAT(close(fds[0]), SyscallSucceeds());
+  EXPECT_THAT(close(fds[1]), SyscallSucceeds());
+  EXPECT_THAT(munmap(state, size), SyscallSucceeds());
+}
+
 }  // namespace
 
 }  // namespace testing
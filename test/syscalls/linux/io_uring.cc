@@ -1213,6 +1213,72 @@ TEST(IOUringTest, READVWithInvalidSqeFieldValue) {
   io_uring->store_cq_head(cq_head + 1);
 }
 
+// Testing that IOUringRing submits a batch of NOPs with a single
+// io_uring_enter(2) and reaps all of their completions.
+TEST(IOUringRingTest, BatchedNop) {
+  SKIP_IF(!IOUringAvailable());
+
+  constexpr int kBatch = 8;
+  std::unique_ptr<IOUringRing> ring =
+      ASSERT_NO_ERRNO_AND_VALUE(IOUringRing::Create(kBatch));
+
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < kBatch; i++) {
+      ASSERT_NE(ring->PrepareNop(i), nullptr);
+    }
+    ASSERT_EQ(ring->Prepared(), kBatch);
+    // The SQ is full until the prepared entries are consumed.
+    ASSERT_EQ(ring->PrepareNop(kBatch), nullptr);
+
+    ASSERT_THAT(ring->SubmitAndWait(kBatch), IsPosixErrorOkAndHolds(kBatch));
+    ASSERT_EQ(ring->Prepared(), 0);
+
+    IOUringCqe cqes[kBatch];
+    ASSERT_EQ(ring->Reap(cqes, kBatch), kBatch);
+    for (int i = 0; i < kBatch; i++) {
+      EXPECT_EQ(cqes[i].res, 0);
+      EXPECT_EQ(cqes[i].user_data, i);
+    }
+    EXPECT_EQ(ring->Reap(cqes, kBatch), 0);
+  }
+}
+
+// Testing that IOUringRing reads a file with a batch of READV operations.
+TEST(IOUringRingTest, BatchedRead) {
+  SKIP_IF(!IOUringAvailable());
+
+  constexpr int kBatch = 4;
+  constexpr int kChunk = 16;
+  std::string contents;
+  for (int i = 0; i < kBatch; i++) {
+    contents.append(kChunk, 'a' + i);
+  }
+  TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFileWith(
+      GetAbsoluteTestTmpdir(), contents, TempPath::kDefaultFileMode));
+  FileDescriptor fd = ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+
+  std::unique_ptr<IOUringRing> ring =
+      ASSERT_NO_ERRNO_AND_VALUE(IOUringRing::Create(kBatch));
+
+  char buf[kBatch][kChunk];
+  struct iovec iovs[kBatch];
+  for (int i = 0; i < kBatch; i++) {
+    iovs[i].iov_base = buf[i];
+    iovs[i].iov_len = kChunk;
+    ASSERT_NE(ring->PrepareRead(fd.get(), &iovs[i], 1, i * kChunk, i),
+              nullptr);
+  }
+  ASSERT_THAT(ring->Submit(), IsPosixErrorOkAndHolds(kBatch));
+
+  IOUringCqe cqes[kBatch];
+  ASSERT_NO_ERRNO(ring->WaitAndReap(cqes, kBatch));
+  for (int i = 0; i < kBatch; i++) {
+    ASSERT_EQ(cqes[i].res, kChunk);
+    int idx = cqes[i].user_data;
+    EXPECT_EQ(std::string(buf[idx], kChunk), std::string(kChunk, 'a' + idx));
+  }
+}
+
 }  // namespace
 
 }  // namespace testing
@@ -593,6 +593,46 @@ TEST_F(MMapTest, MprotectProtNone) {
   EXPECT_THAT(InForkedProcess(rest), IsPosixErrorOkAndHolds(0));
 }
 
+#ifndef MAP_DROPPABLE
+#define MAP_DROPPABLE 0x08
+#endif
+
+// The child of fork sees a MAP_DROPPABLE mapping zero-filled, and its writes
+// aren't seen by the parent.
+TEST_F(MMapTest, DroppableWipedOnFork) {
+  const uintptr_t failed = reinterpret_cast<uintptr_t>(MAP_FAILED);
+  uintptr_t addr = Map(0, kPageSize, PROT_READ | PROT_WRITE,
+                       MAP_DROPPABLE | MAP_ANONYMOUS, -1, 0);
+  // MAP_DROPPABLE was added in Linux 6.11.
+  SKIP_IF(!IsRunningOnGvisor() && addr == failed && errno == EINVAL);
+  ASSERT_NE(addr, failed);
+
+  volatile char* p = reinterpret_cast<volatile char*>(addr);
+  *p = 1;
+  const auto rest = [&] {
+    TEST_CHECK(*p == 0);
+    *p = 2;
+  };
+  EXPECT_THAT(InForkedProcess(rest), IsPosixErrorOkAndHolds(0));
+  EXPECT_EQ(*p, 1);
+}
+
+// MAP_DROPPABLE can't be combined with another mapping type or a file.
+TEST_F(MMapTest, DroppableInvalid) {
+  EXPECT_THAT(Map(0, kPageSize, PROT_READ | PROT_WRITE,
+                  MAP_DROPPABLE | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0),
+              SyscallFailsWithErrno(EINVAL));
+  EXPECT_THAT(Map(0, kPageSize, PROT_READ | PROT_WRITE,
+                  MAP_DROPPABLE | MAP_SHARED | MAP_ANONYMOUS, -1, 0),
+              SyscallFailsWithErrno(EINVAL));
+
+  const FileDescriptor dev_zero =
+      ASSERT_NO_ERRNO_AND_VALUE(Open("/dev/zero", O_RDWR));
+  EXPECT_THAT(Map(0, kPageSize, PROT_READ | PROT_WRITE, MAP_DROPPABLE,
+                  dev_zero.get(), 0),
+              SyscallFailsWithErrno(EINVAL));
+}
+
 // Verify that calling mprotect with an absurdly huge length fails.
 TEST_F(MMapTest, MprotectHugeLength) {
   uintptr_t addr;
@@ -0,0 +1,288 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/syscalls/linux/rseq/critical.h"
+#include "test/syscalls/linux/rseq/syscalls.h"
+#include "test/syscalls/linux/rseq/test.h"
+#include "test/syscalls/linux/rseq/types.h"
+#include "test/syscalls/linux/rseq/uapi.h"
+
+// Standalone per-CPU counter benchmark.
+//
+// Usage: rseq_benchmark <mode> <threads> <increments>
+//
+// Each of <threads> threads increments a counter <increments> times. In
+// kRseqBenchmarkModeRseq mode, threads increment the counter of the CPU they
+// run on with the rseq_percpu_inc critical section, which is restarted when
+// the thread is preempted, migrated or interrupted by a signal. In
+// kRseqBenchmarkModeAtomic mode, threads increment a single shared counter
+// with an atomic read-modify-write, which is what per-CPU counters avoid.
+//
+// Once all threads are done, the elapsed time in nanoseconds and the total
+// number of aborted critical sections are written to stdout as
+// "<elapsed_ns> <aborts>\n".
+//
+// Like the rseq test binary, this must not depend on libc, which may register
+// rseq itself.
+
+namespace gvisor {
+namespace testing {
+
+extern "C" int main(int argc, char** argv, char** envp);
+
+// Standalone initialization before calling main().
+extern "C" void __init(uintptr_t* sp) {
+  int argc = sp[0];
+  char** argv = reinterpret_cast<char**>(&sp[1]);
+  char** envp = &argv[argc + 1];
+
+  // Call main() and exit.
+  sys_exit_group(main(argc, argv, envp));
+
+  // sys_exit_group does not return
+}
+
+int strcmp(const char* s1, const char* s2) {
+  const unsigned char* p1 = reinterpret_cast<const unsigned char*>(s1);
+  const unsigned char* p2 = reinterpret_cast<const unsigned char*>(s2);
+
+  while (*p1 == *p2) {
+    if (!*p1) {
+      return 0;
+    }
+    ++p1;
+    ++p2;
+  }
+  return static_cast<int>(*p1) - static_cast<int>(*p2);
+}
+
+// Parses a decimal number. Returns false if s isn't a positive number.
+bool ParsePositive(const char* s, uint64_t* out) {
+  uint64_t v = 0;
+  if (!*s) {
+    return false;
+  }
+  for (; *s; ++s) {
+    if (*s < '0' || *s > '9') {
+      return false;
+    }
+    v = v * 10 + (*s - '0');
+  }
+  *out = v;
+  return v > 0;
+}
+
+// Formats v in decimal, ending at end. Returns the start of the formatted
+// number.
+char* FormatUint(uint64_t v, char* end) {
+  do {
+    *--end = '0' + v % 10;
+    v /= 10;
+  } while (v);
+  return end;
+}
+
+uint64_t MonotonicNanos() {
+  struct kernel_timespec ts = {};
+  sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+constexpr uint64_t kMaxThreads = 1024;
+constexpr size_t kStackSize = 256 << 10;  // 256 KB
+
+// Per-CPU counters are 64 bytes apart, see rseq_percpu_inc.
+constexpr size_t kCounterStride = 64 / sizeof(uint64_t);
+
+// Maximum size of the CPU mask returned by sched_getaffinity, enough for 4096
+// CPUs.
+constexpr size_t kMaxCPUMaskBytes = 512;
+
+struct Thread {
+  struct rseq r;
+  bool rseq_mode;
+  uint64_t increments;
+  uint64_t* counters;
+  uint64_t aborts;
+  bool failed;
+  uint32_t child_cleartid;
+};
+
+// State shared by all threads.
+uint32_t ready;
+bool start;
+uint64_t shared_counter;
+
+int ThreadMain(void* arg) {
+  Thread* t = static_cast<Thread*>(arg);
+
+  struct rseq_cs cs = {};
+  if (t->rseq_mode) {
+    // Each thread must register its own struct rseq.
+    int ret = sys_rseq(&t->r, sizeof(t->r), 0, kRseqSignature);
+    if (sys_errno(ret) != 0) {
+      t->failed = true;
+      __atomic_add_fetch(&ready, 1, __ATOMIC_RELEASE);
+      return 1;
+    }
+    cs.start_ip = reinterpret_cast<uint64_t>(&rseq_percpu_inc_start);
+    cs.post_commit_offset =
+        reinterpret_cast<uint64_t>(&rseq_percpu_inc_post_commit) -
+        reinterpret_cast<uint64_t>(&rseq_percpu_inc_start);
+    cs.abort_ip = reinterpret_cast<uint64_t>(&rseq_percpu_inc_abort);
+  }
+
+  __atomic_add_fetch(&ready, 1, __ATOMIC_RELEASE);
+  while (!__atomic_load_n(&start, __ATOMIC_ACQUIRE)) {
+  }
+
+  uint64_t aborts = 0;
+  if (t->rseq_mode) {
+    for (uint64_t i = 0; i < t->increments; i++) {
+      aborts += rseq_percpu_inc(&t->r, &cs, t->counters);
+    }
+    // Don't leave a pointer to cs, which is about to go out of scope.
+    __atomic_store_n(&t->r.rseq_cs, nullptr, __ATOMIC_RELAXED);
+  } else {
+    for (uint64_t i = 0; i < t->increments; i++) {
+      __atomic_add_fetch(&shared_counter, 1, __ATOMIC_RELAXED);
+    }
+  }
+  t->aborts = aborts;
+  return 0;
+}
+
+void* Mmap(size_t length) {
+  uintptr_t addr = sys_mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (sys_errno(addr) != 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<void*>(addr);
+}
+
+int Run(bool rseq_mode, uint64_t nthreads, uint64_t increments) {
+  // CPU numbers reported in rseq are less than the number of bits in the
+  // kernel's CPU mask.
+  uint8_t mask[kMaxCPUMaskBytes];
+  uintptr_t mask_bytes = sys_sched_getaffinity(0, sizeof(mask), mask);
+  if (sys_errno(mask_bytes) != 0) {
+    return 1;
+  }
+  const uint64_t ncpus = mask_bytes * 8;
+  uint64_t* counters = static_cast<uint64_t*>(
+      Mmap(ncpus * kCounterStride * sizeof(uint64_t)));
+  Thread* threads = static_cast<Thread*>(Mmap(nthreads * sizeof(Thread)));
+  if (counters == nullptr || threads == nullptr) {
+    return 1;
+  }
+
+  for (uint64_t i = 0; i < nthreads; i++) {
+    Thread* t = &threads[i];
+    t->rseq_mode = rseq_mode;
+    t->increments = increments;
+    t->counters = counters;
+    t->r.cpu_id = kRseqCPUIDUninitialized;
+
+    char* stack = static_cast<char*>(Mmap(kStackSize));
+    if (stack == nullptr) {
+      return 1;
+    }
+    int tid =
+        clone(ThreadMain, reinterpret_cast<uintptr_t>(stack + kStackSize),
+              CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD |
+                  CLONE_CHILD_CLEARTID | CLONE_CHILD_SETTID,
+              t, &t->child_cleartid);
+    if (sys_errno(tid) != 0) {
+      return 1;
+    }
+  }
+
+  // Start all threads at once, so that they contend for the whole run.
+  while (__atomic_load_n(&ready, __ATOMIC_ACQUIRE) != nthreads) {
+  }
+  const uint64_t begin = MonotonicNanos();
+  __atomic_store_n(&start, true, __ATOMIC_RELEASE);
+
+  for (uint64_t i = 0; i < nthreads; i++) {
+    uint32_t* cleartid = &threads[i].child_cleartid;
+    while (true) {
+      uint32_t cur = __atomic_load_n(cleartid, __ATOMIC_ACQUIRE);
+      if (cur == 0) {
+        break;
+      }
+      auto ret = sys_futex(cleartid, FUTEX_WAIT, cur, nullptr);
+      if (ret != 0 && sys_errno(ret) != EAGAIN && sys_errno(ret) != EINTR) {
+        return 1;
+      }
+    }
+  }
+  const uint64_t elapsed = MonotonicNanos() - begin;
+
+  // Check that no increment was lost.
+  uint64_t total = shared_counter;
+  uint64_t aborts = 0;
+  for (uint64_t i = 0; i < ncpus; i++) {
+    total += counters[i * kCounterStride];
+  }
+  for (uint64_t i = 0; i < nthreads; i++) {
+    if (threads[i].failed) {
+      return 1;
+    }
+    aborts += threads[i].aborts;
+  }
+  if (total != nthreads * increments) {
+    return 1;
+  }
+
+  char buf[64];
+  char* end = buf + sizeof(buf);
+  *--end = '\n';
+  char* p = FormatUint(aborts, end);
+  *--p = ' ';
+  p = FormatUint(elapsed, p);
+  if (sys_errno(sys_write(1, p, end - p)) != 0) {
+    return 1;
+  }
+  return 0;
+}
+
+// Exit codes:
+//  0 - Pass
+//  1 - Fail
+//  2 - Invalid arguments
+extern "C" int main(int argc, char** argv, char** envp) {
+  if (argc != 4) {
+    // Usage: rseq_benchmark <mode> <threads> <increments>
+    return 2;
+  }
+
+  bool rseq_mode;
+  if (strcmp(argv[1], kRseqBenchmarkModeRseq) == 0) {
+    rseq_mode = true;
+  } else if (strcmp(argv[1], kRseqBenchmarkModeAtomic) == 0) {
+    rseq_mode = false;
+  } else {
+    return 2;
+  }
+  uint64_t nthreads, increments;
+  if (!ParsePositive(argv[2], &nthreads) || nthreads > kMaxThreads ||
+      !ParsePositive(argv[3], &increments)) {
+    return 2;
+  }
+  return Run(rseq_mode, nthreads, increments);
+}
+
+}  // namespace testing
+}  // namespace gvisor
@@ -49,10 +49,6 @@ int strcmp(const char* s1, const char* s2) {
   return static_cast<int>(*p1) - static_cast<int>(*p2);
 }
 
-int sys_rseq(struct rseq* rseq, uint32_t rseq_len, int flags, uint32_t sig) {
-  return raw_syscall(kRseqSyscall, rseq, rseq_len, flags, sig);
-}
-
 // RSeqRegistration represents a registered struct rseq, which is unregistered
 // when the RSeqRegistration is destroyed.
 class RSeqRegistration {
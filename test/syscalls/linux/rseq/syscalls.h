@@ -16,20 +16,27 @@
 #define GVISOR_TEST_SYSCALLS_LINUX_RSEQ_SYSCALLS_H_
 
 #include "test/syscalls/linux/rseq/types.h"
+#include "test/syscalls/linux/rseq/uapi.h"
 
 // Syscall numbers.
 #if defined(__x86_64__)
+constexpr int kClockGettime = 228;
 constexpr int kExitGroup = 231;
 constexpr int kFutex = 202;
 constexpr int kGetpid = 39;
 constexpr int kMembarrier = 324;
 constexpr int kMmap = 9;
+constexpr int kSchedGetaffinity = 204;
+constexpr int kWrite = 1;
 #elif defined(__aarch64__)
+constexpr int kClockGettime = 113;
 constexpr int kExitGroup = 94;
 constexpr int kFutex = 98;
 constexpr int kGetpid = 172;
 constexpr int kMembarrier = 283;
 constexpr int kMmap = 222;
+constexpr int kSchedGetaffinity = 123;
+constexpr int kWrite = 64;
 #else
 #error "Unknown architecture"
 #endif
@@ -76,6 +83,19 @@ extern "C" int clone(int (*fn)(void*), uintptr_t stack, int flags, void* arg,
 #define CLONE_CHILD_CLEARTID 0x00200000
 #define CLONE_CHILD_SETTID 0x01000000
 
+struct kernel_timespec {
+  int64_t tv_sec;
+  int64_t tv_nsec;
+};
+
+static inline uintptr_t sys_clock_gettime(int clock,
+                                          struct kernel_timespec* ts) {
+  return raw_syscall(kClockGettime, clock, ts);
+}
+
+// clocks:
+#define CLOCK_MONOTONIC 1
+
 static inline void sys_exit_group(int status) {
   raw_syscall(kExitGroup, status);
 }
@@ -112,6 +132,20 @@ static inline uintptr_t sys_mmap(void* addr, size_t length, int prot, int flags,
 #define MAP_ANONYMOUS 0x20
 #define MAP_STACK 0x020000
 
+static inline int sys_rseq(struct rseq* rseq, uint32_t rseq_len, int flags,
+                           uint32_t sig) {
+  return raw_syscall(kRseqSyscall, rseq, rseq_len, flags, sig);
+}
+
+static inline uintptr_t sys_sched_getaffinity(int pid, size_t len,
+                                              uint8_t* mask) {
+  return raw_syscall(kSchedGetaffinity, pid, len, mask);
+}
+
+static inline uintptr_t sys_write(int fd, const void* buf, size_t count) {
+  return raw_syscall(kWrite, fd, buf, count);
+}
+
 }  // namespace testing
 }  // namespace gvisor
 
@@ -37,6 +37,10 @@ constexpr char kRseqTestInvalidAbortClearsCS[] = "invalid-abort-clears-cs";
 constexpr char kRseqTestMembarrierResetsCpuIdStart[] =
     "membarrier-resets-cpu-id-start";
 
+// Modes of the rseq_benchmark binary.
+constexpr char kRseqBenchmarkModeRseq[] = "rseq";
+constexpr char kRseqBenchmarkModeAtomic[] = "atomic";
+
 }  // namespace testing
 }  // namespace gvisor
 
@@ -91,6 +91,22 @@ TEST_P(BlockingStreamSocketPairTest, SendMsgTooLarge) {
               SyscallSucceedsWithValue(buffer_size));
 }
 
+TEST_P(BlockingStreamSocketPairTest, BulkTransfer) {
+  auto sockets = ASSERT_NO_ERRNO_AND_VALUE(NewSocketPair());
+  ASSERT_NO_FATAL_FAILURE(
+      BulkTransferTest(sockets->first_fd(), sockets->second_fd(), 16 << 20));
+}
+
+// MSG_ZEROCOPY is only supported by some socket types; the others fall back to
+// copying sends.
+TEST_P(BlockingStreamSocketPairTest, BulkTransferZerocopy) {
+  auto sockets = ASSERT_NO_ERRNO_AND_VALUE(NewSocketPair());
+  BulkTransferOptions opts;
+  opts.zerocopy = true;
+  ASSERT_NO_FATAL_FAILURE(BulkTransferTest(
+      sockets->first_fd(), sockets->second_fd(), 16 << 20, opts));
+}
+
 TEST_P(BlockingStreamSocketPairTest, RecvLessThanBuffer) {
   auto sockets = ASSERT_NO_ERRNO_AND_VALUE(NewSocketPair());
 
@@ -45,5 +45,11 @@ TEST_P(NonBlockingStreamSocketPairTest, SendMsgTooLarge) {
               SyscallSucceedsWithValue(Le(buffer_size)));
 }
 
+TEST_P(NonBlockingStreamSocketPairTest, BulkTransfer) {
+  auto sockets = ASSERT_NO_ERRNO_AND_VALUE(NewSocketPair());
+  ASSERT_NO_FATAL_FAILURE(
+      BulkTransferTest(sockets->first_fd(), sockets->second_fd(), 16 << 20));
+}
+
 }  // namespace testing
 }  // namespace gvisor
@@ -22,22 +22,13 @@
 #include "test/util/file_descriptor.h"
 #include "test/util/posix_error.h"
 #include "test/util/test_util.h"
+#include "test/util/timer_util.h"
 
 namespace gvisor {
 namespace testing {
 
 namespace {
 
-// Wrapper around timerfd_create(2) that returns a FileDescriptor.
-PosixErrorOr<FileDescriptor> TimerfdCreate(int clockid, int flags) {
-  int fd = timerfd_create(clockid, flags);
-  MaybeSave();
-  if (fd < 0) {
-    return PosixError(errno, "timerfd_create failed");
-  }
-  return FileDescriptor(fd);
-}
-
 // In tests that race a timerfd with a sleep, some slack is required because:
 //
 // - Timerfd expirations are asynchronous with respect to nanosleeps.
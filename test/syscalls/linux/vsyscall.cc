@@ -12,10 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <elf.h>
 #include <errno.h>
+#include <sys/auxv.h>
+#include <sys/mman.h>
+#include <sys/time.h>
 #include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
 
 #include "gtest/gtest.h"
+#include "test/util/multiprocess_util.h"
 #include "test/util/proc_util.h"
 #include "test/util/test_util.h"
 
@@ -30,6 +39,34 @@ time_t vsyscall_time(time_t* t) {
   return reinterpret_cast<time_t (*)(time_t*)>(kVsyscallTimeEntry)(t);
 }
 
+int vsyscall_gettimeofday(struct timeval* tv, struct timezone* tz) {
+  constexpr uint64_t kVsyscallGettimeofdayEntry = 0xffffffffff600000;
+  return reinterpret_cast<int (*)(struct timeval*, struct timezone*)>(
+      kVsyscallGettimeofdayEntry)(tv, tz);
+}
+
+// VdsoLength returns the length spanned by the PT_LOAD segments of the VDSO
+// mapped at vdso, rounded up to a page.
+size_t VdsoLength(uintptr_t vdso) {
+  const auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(vdso);
+  const auto* phdrs = reinterpret_cast<const Elf64_Phdr*>(vdso + ehdr->e_phoff);
+  bool found = false;
+  uint64_t start = 0;
+  uint64_t end = 0;
+  for (int i = 0; i < ehdr->e_phnum; i++) {
+    if (phdrs[i].p_type != PT_LOAD) {
+      continue;
+    }
+    if (!found) {
+      start = phdrs[i].p_vaddr;
+      found = true;
+    }
+    end = std::max(end, phdrs[i].p_vaddr + phdrs[i].p_memsz);
+  }
+  const size_t page_size = getpagesize();
+  return (end - start + page_size - 1) / page_size * page_size;
+}
+
 TEST(VsyscallTest, VsyscallAlwaysAvailableOnGvisor) {
   SKIP_IF(!IsRunningOnGvisor());
   // Vsyscall is always advertised by gvisor.
@@ -38,6 +75,25 @@ TEST(VsyscallTest, VsyscallAlwaysAvailableOnGvisor) {
   time_t t;
   EXPECT_THAT(vsyscall_time(&t), SyscallSucceeds());
 }
+
+// Vsyscalls must keep working after the application unmaps the VDSO, even if
+// they were being served by VDSO functions.
+TEST(VsyscallTest, GettimeofdayAfterVdsoUnmap) {
+  SKIP_IF(!ASSERT_NO_ERRNO_AND_VALUE(IsVsyscallEnabled()));
+  const uintptr_t vdso = getauxval(AT_SYSINFO_EHDR);
+  SKIP_IF(vdso == 0);
+  const size_t len = VdsoLength(vdso);
+
+  // The child can't use libc functions that call into the VDSO once it is
+  // unmapped.
+  const auto rest = [&] {
+    TEST_PCHECK(munmap(reinterpret_cast<void*>(vdso), len) == 0);
+    struct timeval tv = {};
+    TEST_CHECK(vsyscall_gettimeofday(&tv, nullptr) == 0);
+    TEST_CHECK(tv.tv_sec > 0);
+  };
+  EXPECT_THAT(InForkedProcess(rest), IsPosixErrorOkAndHolds(0));
+}
 #endif
 
 }  // namespace
@@ -0,0 +1,483 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package trace
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"os"
+	"os/exec"
+	"path/filepath"
+	"regexp"
+	"strconv"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"gvisor.dev/gvisor/pkg/sentry/seccheck"
+	"gvisor.dev/gvisor/pkg/test/testutil"
+	"gvisor.dev/gvisor/test/trace/config"
+)
+
+// storm describes a workload that triggers the same points over and over.
+type storm struct {
+	name   string
+	points []string
+}
+
+var storms = []storm{
+	{
+		name:   "open",
+		points: []string{"syscall/openat/enter", "syscall/read/enter", "syscall/close/enter"},
+	},
+	{
+		name:   "connect",
+		points: []string{"syscall/connect/enter"},
+	},
+	{
+		name:   "execve",
+		points: []string{"sentry/clone", "sentry/execve", "syscall/execve/enter", "sentry/exit_notify_parent"},
+	},
+}
+
+// serverMode describes how the example server is run. Empty args means that
+// tracing is disabled, which is used as the baseline.
+type serverMode struct {
+	name string
+	args []string
+}
+
+var serverModes = []serverMode{
+	{name: "none"},
+	{name: "quiet,workers=1", args: []string{"-q", "-w", "1"}},
+	{name: "quiet,workers=4", args: []string{"-q", "-w", "4"}},
+	{name: "verbose,workers=1", args: []string{"-w", "1"}},
+	{name: "verbose,workers=4", args: []string{"-w", "4"}},
+}
+
+var (
+	elapsedRE = regexp.MustCompile(`elapsed_ns: (\d+)`)
+	closedRE  = regexp.MustCompile(`Connection closed, client \d+, (\d+) events(?: .*, (\d+) events dropped)?`)
+)
+
+// stormServer runs the example server and collects the stats that it prints
+// when a sandbox disconnects.
+type stormServer struct {
+	dir    string
+	path   string
+	cmd    *exec.Cmd
+	closed chan clientStats
+}
+
+type clientStats struct {
+	events  uint64
+	dropped uint64
+}
+
+func newStormServer(args []string) (*stormServer, error) {
+	exe, err := testutil.FindFile("examples/seccheck/server_cc")
+	if err != nil {
+		return nil, err
+	}
+	dir, err := os.MkdirTemp(testutil.TmpDir(), "storm")
+	if err != nil {
+		return nil, err
+	}
+	s := &stormServer{
+		dir:    dir,
+		path:   filepath.Join(dir, "server.sock"),
+		closed: make(chan clientStats, 16),
+	}
+	s.cmd = exec.Command(exe, append(args, s.path)...)
+	out, err := s.cmd.StdoutPipe()
+	if err != nil {
+		os.RemoveAll(dir)
+		return nil, err
+	}
+	if err := s.cmd.Start(); err != nil {
+		os.RemoveAll(dir)
+		return nil, err
+	}
+	go s.scan(out)
+
+	// Wait for the server to start listening.
+	for start := time.Now(); ; time.Sleep(10 * time.Millisecond) {
+		if _, err := os.Stat(s.path); err == nil {
+			return s, nil
+		}
+		if time.Since(start) > 10*time.Second {
+			s.stop()
+			return nil, fmt.Errorf("timeout waiting for server socket %q", s.path)
+		}
+	}
+}
+
+// scan reads the server output, which can be very large in verbose mode, and
+// only keeps the stats of disconnected clients.
+func (s *stormServer) scan(out io.Reader) {
+	scanner := bufio.NewScanner(out)
+	scanner.Buffer(nil, 1<<20)
+	for scanner.Scan() {
+		m := closedRE.FindStringSubmatch(scanner.Text())
+		if m == nil {
+			continue
+		}
+		var stats clientStats
+		stats.events, _ = strconv.ParseUint(m[1], 10, 64)
+		if len(m[2]) > 0 {
+			stats.dropped, _ = strconv.ParseUint(m[2], 10, 64)
+		}
+		s.closed <- stats
+	}
+	// Drain the rest of the output to not block the server.
+	_, _ = io.Copy(io.Discard, out)
+}
+
+// waitClient waits for the next sandbox to disconnect.
+func (s *stormServer) waitClient() (clientStats, error) {
+	select {
+	case stats := <-s.closed:
+		return stats, nil
+	case <-time.After(time.Minute):
+		return clientStats{}, fmt.Errorf("timeout waiting for sandbox to disconnect")
+	}
+}
+
+func (s *stormServer) stop() {
+	_ = s.cmd.Process.Kill()
+	_ = s.cmd.Wait()
+	_ = os.RemoveAll(s.dir)
+}
+
+// writeStormConfig creates a pod init config file that enables the storm's
+// points and sends them to endpoint.
+func writeStormConfig(st storm, endpoint string) (string, error) {
+	builder := config.Builder{}
+	for _, name := range st.points {
+		builder.AddPoint(seccheck.PointConfig{
+			Name:          name,
+			ContextFields: []string{"container_id", "time"},
+		})
+	}
+	builder.AddSink(seccheck.SinkConfig{
+		Name: "remote",
+		Config: map[string]any{
+			"endpoint": endpoint,
+		},
+	})
+	cfgFile, err := os.CreateTemp(testutil.TmpDir(), "config")
+	if err != nil {
+		return "", err
+	}
+	defer cfgFile.Close()
+	if err := builder.WriteInitConfig(cfgFile); err != nil {
+		return "", err
+	}
+	return cfgFile.Name(), nil
+}
+
+// runStorm runs the storm in a new sandbox and returns the time the storm
+// took inside the sandbox.
+func runStorm(runsc, cfgFile, workload, name string, iterations int) (time.Duration, error) {
+	args := []string{"--rootless", "--network=none", "--TESTONLY-unsafe-nonroot"}
+	if len(cfgFile) > 0 {
+		args = append(args, "--pod-init-config", cfgFile)
+	}
+	args = append(args, "do", workload, name, strconv.Itoa(iterations))
+	out, err := exec.Command(runsc, args...).CombinedOutput()
+	if err != nil {
+		return 0, fmt.Errorf("runsc do: %v, output: %s", err, out)
+	}
+	m := elapsedRE.FindSubmatch(out)
+	if m == nil {
+		return 0, fmt.Errorf("storm output missing elapsed time: %s", out)
+	}
+	ns, err := strconv.ParseInt(string(m[1]), 10, 64)
+	if err != nil {
+		return 0, err
+	}
+	return time.Duration(ns), nil
+}
+
+// BenchmarkStorm measures the overhead of tracing on workloads that generate
+// a high volume of points, and how many points per second the example server
+// can ingest. Each storm is run in one or more concurrent sandboxes, first
+// without tracing as a baseline, then with the example server in different
+// modes. Besides ns/op, which is the time taken by the storm inside the
+// sandbox, the following metrics are reported:
+//
+//   - slowdown: ns/op compared to the baseline with the same number of
+//     sandboxes.
+//   - events/sec: points delivered to the server per second of storm.
+//   - dropped: points that sandboxes failed to deliver.
+func BenchmarkStorm(b *testing.B) {
+	runsc, err := testutil.FindFile("runsc/runsc")
+	if err != nil {
+		b.Fatal(err)
+	}
+	workload, err := testutil.FindFile("test/trace/workload/storm")
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	for _, st := range storms {
+		b.Run(st.name, func(b *testing.B) {
+			for _, sandboxes := range []int{1, 4} {
+				b.Run(fmt.Sprintf("sandboxes=%d", sandboxes), func(b *testing.B) {
+					// Set by the baseline, which runs first.
+					var baseline float64
+					for _, mode := range serverModes {
+						b.Run(mode.name, func(b *testing.B) {
+							perOp := benchmarkStorm(b, runsc, workload, st, mode, sandboxes)
+							if mode.args == nil {
+								baseline = perOp
+							} else if baseline > 0 {
+								b.ReportMetric(perOp/baseline, "slowdown")
+							}
+						})
+					}
+				})
+			}
+		})
+	}
+}
+
+// benchmarkStorm runs one configuration of BenchmarkStorm and returns the time
+// per iteration in nanoseconds.
+func benchmarkStorm(b *testing.B, runsc, workload string, st storm, mode serverMode, sandboxes int) float64 {
+	var cfgFile string
+	var server *stormServer
+	if mode.args != nil {
+		var err error
+		server, err = newStormServer(mode.args)
+		if err != nil {
+			b.Fatalf("starting server: %v", err)
+		}
+		defer server.stop()
+		cfgFile, err = writeStormConfig(st, server.path)
+		if err != nil {
+			b.Fatalf("writing config: %v", err)
+		}
+		defer os.Remove(cfgFile)
+	}
+
+	b.ResetTimer()
+	var (
+		wg      sync.WaitGroup
+		mu      sync.Mutex
+		elapsed time.Duration
+		errs    []error
+	)
+	for i := 0; i < sandboxes; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			d, err := runStorm(runsc, cfgFile, workload, st.name, b.N)
+			mu.Lock()
+			defer mu.Unlock()
+			if err != nil {
+				errs = append(errs, err)
+			}
+			// Sandboxes run concurrently, the slowest one determines the
+			// duration of the storm.
+			if d > elapsed {
+				elapsed = d
+			}
+		}()
+	}
+	wg.Wait()
+	b.StopTimer()
+	if len(errs) > 0 {
+		b.Fatal(errs)
+	}
+
+	perOp := float64(elapsed.Nanoseconds()) / float64(b.N)
+	b.ReportMetric(perOp, "ns/op")
+	if server != nil {
+		var total clientStats
+		for i := 0; i < sandboxes; i++ {
+			stats, err := server.waitClient()
+			if err != nil {
+				b.Fatal(err)
+			}
+			total.events += stats.events
+			total.dropped += stats.dropped
+		}
+		b.ReportMetric(float64(total.events)/elapsed.Seconds(), "events/sec")
+		b.ReportMetric(float64(total.dropped), "dropped")
+	}
+	return perOp
+}
+
+// pointRoutine pairs a point with a workload.cc routine that triggers it.
+type pointRoutine struct {
+	point   string
+	routine string
+}
+
+// pointRoutines is the coverage matrix of BenchmarkPointOverhead. It only
+// lists points that exist on all architectures, triggered by routines that
+// support stress mode.
+var pointRoutines = []pointRoutine{
+	{point: "syscall/socket/enter", routine: "Socket"},
+	{point: "syscall/listen/enter", routine: "Socket"},
+	{point: "syscall/connect/enter", routine: "Socket"},
+	{point: "syscall/bind/enter", routine: "Bind"},
+	{point: "syscall/accept/enter", routine: "Accept"},
+	{point: "syscall/accept4/enter", routine: "Accept4"},
+	{point: "syscall/openat/enter", routine: "ReadWrite"},
+	{point: "syscall/read/enter", routine: "ReadWrite"},
+	{point: "syscall/write/enter", routine: "ReadWrite"},
+	{point: "syscall/pread64/enter", routine: "ReadWrite"},
+	{point: "syscall/pwrite64/enter", routine: "ReadWrite"},
+	{point: "syscall/readv/enter", routine: "ReadWrite"},
+	{point: "syscall/writev/enter", routine: "ReadWrite"},
+	{point: "syscall/close/enter", routine: "Pipe2"},
+	{point: "syscall/pipe2/enter", routine: "Pipe2"},
+	{point: "syscall/dup/enter", routine: "Dup"},
+	{point: "syscall/dup3/enter", routine: "Dup3"},
+	{point: "syscall/fcntl/enter", routine: "Fcntl"},
+	{point: "syscall/eventfd2/enter", routine: "Eventfd2"},
+	{point: "syscall/signalfd4/enter", routine: "Signalfd4"},
+	{point: "syscall/timerfd_create/enter", routine: "TimerfdCreate"},
+	{point: "syscall/timerfd_settime/enter", routine: "TimerfdSettime"},
+	{point: "syscall/timerfd_gettime/enter", routine: "TimerfdGettime"},
+	{point: "syscall/inotify_init1/enter", routine: "InotifyInit1"},
+	{point: "syscall/inotify_add_watch/enter", routine: "InotifyAddWatch"},
+	{point: "syscall/inotify_rm_watch/enter", routine: "InotifyRmWatch"},
+	{point: "syscall/prlimit64/enter", routine: "Prlimit64"},
+	{point: "syscall/setuid/enter", routine: "Setuid"},
+	{point: "syscall/setgid/enter", routine: "Setgid"},
+	{point: "syscall/setresuid/enter", routine: "Setresuid"},
+	{point: "syscall/setresgid/enter", routine: "Setresgid"},
+	{point: "syscall/clone/enter", routine: "Clone"},
+	{point: "sentry/clone", routine: "Clone"},
+	{point: "sentry/exit_notify_parent", routine: "Clone"},
+	{point: "syscall/execveat/enter", routine: "ForkExecveat"},
+	{point: "sentry/execve", routine: "ForkExecveat"},
+}
+
+// routineRE matches the time per call that workload.cc prints in stress mode.
+var routineRE = regexp.MustCompile(`(?m)^pid \d+: (\w+): (\d+) calls, (\d+) ns/call$`)
+
+// runRoutine runs a workload.cc routine repeat times in a new sandbox, and
+// returns the number of calls and the average time per call inside the
+// sandbox.
+func runRoutine(runsc, cfgFile, workload, routine string, repeat int) (uint64, float64, error) {
+	args := []string{"--rootless", "--network=none", "--TESTONLY-unsafe-nonroot"}
+	if len(cfgFile) > 0 {
+		args = append(args, "--pod-init-config", cfgFile)
+	}
+	args = append(args, "do", workload, "--routines="+routine, fmt.Sprintf("--repeat=%d", repeat))
+	out, err := exec.Command(runsc, args...).CombinedOutput()
+	if err != nil {
+		return 0, 0, fmt.Errorf("runsc do: %v, output: %s", err, out)
+	}
+	m := routineRE.FindSubmatch(out)
+	if m == nil || string(m[1]) != routine {
+		return 0, 0, fmt.Errorf("workload output missing time per call: %s", out)
+	}
+	calls, err := strconv.ParseUint(string(m[2]), 10, 64)
+	if err != nil {
+		return 0, 0, err
+	}
+	ns, err := strconv.ParseFloat(string(m[3]), 64)
+	if err != nil {
+		return 0, 0, err
+	}
+	return calls, ns, nil
+}
+
+// BenchmarkPointOverhead measures the cost of each point on its own, to tell
+// which points are cheap enough to leave enabled in production. For each
+// point, the routine that triggers it runs in a tight loop with only that
+// point enabled and sent to the example server in quiet mode, and without
+// tracing as a baseline. Besides ns/op, which is the time per routine call
+// inside the sandbox, the following metrics are reported:
+//
+//   - events/op: points delivered to the server per routine call.
+//   - overhead-ns/event: the extra time per call over the baseline, divided
+//     by events/op.
+//   - slowdown: ns/op compared to the baseline.
+//
+// The benchmark runs each routine at least twice, since workload.cc only
+// reports times in stress mode.
+func BenchmarkPointOverhead(b *testing.B) {
+	runsc, err := testutil.FindFile("runsc/runsc")
+	if err != nil {
+		b.Fatal(err)
+	}
+	workload, err := testutil.FindFile("test/trace/workload/workload")
+	if err != nil {
+		b.Fatal(err)
+	}
+	repeat := max(b.N, 2)
+
+	// Baselines are shared by all points triggered by the same routine.
+	baselines := make(map[string]float64)
+	baseline := func(b *testing.B, routine string) float64 {
+		if ns, ok := baselines[routine]; ok {
+			return ns
+		}
+		_, ns, err := runRoutine(runsc, "", workload, routine, repeat)
+		if err != nil {
+			b.Fatalf("running baseline: %v", err)
+		}
+		baselines[routine] = ns
+		return ns
+	}
+
+	for _, pr := range pointRoutines {
+		name := fmt.Sprintf("%s,routine=%s", strings.ReplaceAll(pr.point, "/", "."), pr.routine)
+		b.Run(name, func(b *testing.B) {
+			base := baseline(b, pr.routine)
+
+			server, err := newStormServer([]string{"-q", "-w", "1"})
+			if err != nil {
+				b.Fatalf("starting server: %v", err)
+			}
+			defer server.stop()
+			cfgFile, err := writeStormConfig(storm{name: pr.routine, points: []string{pr.point}}, server.path)
+			if err != nil {
+				b.Fatalf("writing config: %v", err)
+			}
+			defer os.Remove(cfgFile)
+
+			b.ResetTimer()
+			calls, ns, err := runRoutine(runsc, cfgFile, workload, pr.routine, repeat)
+			b.StopTimer()
+			if err != nil {
+				b.Fatal(err)
+			}
+			stats, err := server.waitClient()
+			if err != nil {
+				b.Fatal(err)
+			}
+			if stats.events == 0 {
+				b.Fatalf("routine %s didn't trigger point %s", pr.routine, pr.point)
+			}
+
+			eventsPerCall := float64(stats.events) / float64(calls)
+			b.ReportMetric(ns, "ns/op")
+			b.ReportMetric(eventsPerCall, "events/op")
+			b.ReportMetric((ns-base)/eventsPerCall, "overhead-ns/event")
+			if base > 0 {
+				b.ReportMetric(ns/base, "slowdown")
+			}
+		})
+	}
+}
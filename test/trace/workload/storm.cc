@@ -0,0 +1,166 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// storm issues a large number of the same syscalls to measure the overhead of
+// trace points in the sandbox. Usage:
+//
+//   storm <open|connect|execve> <iterations>
+//
+// It prints the time taken by the storm, excluding setup, in nanoseconds.
+
+#include <err.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+// stormOpen opens, reads and closes the same file in a loop, which generates
+// three syscall points per iteration.
+void stormOpen(int iterations) {
+  const char* path = "storm.txt";
+  int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  if (fd < 0) {
+    err(1, "open");
+  }
+  constexpr char kContent[] = "0123456789";
+  if (write(fd, kContent, sizeof(kContent)) != sizeof(kContent)) {
+    err(1, "write");
+  }
+  close(fd);
+  auto unlinker = absl::MakeCleanup([path] { unlink(path); });
+
+  for (int i = 0; i < iterations; ++i) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      err(1, "open");
+    }
+    char buf[sizeof(kContent)];
+    if (read(fd, buf, sizeof(buf)) < 0) {
+      err(1, "read");
+    }
+    close(fd);
+  }
+}
+
+// stormConnect connects to a UDS in the abstract namespace in a loop. The
+// connection is accepted and closed by the same thread.
+void stormConnect(int iterations) {
+  auto path = absl::StrCat(std::string("\0", 1), "trace_storm.", getpid(),
+                           absl::GetCurrentTimeNanos());
+
+  struct sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, path.data(), path.size());
+  socklen_t addr_len = offsetof(sockaddr_un, sun_path) + path.size();
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0) {
+    err(1, "socket");
+  }
+  auto server_closer = absl::MakeCleanup([server] { close(server); });
+  if (bind(server, reinterpret_cast<struct sockaddr*>(&addr), addr_len)) {
+    err(1, "bind");
+  }
+  if (listen(server, 5) < 0) {
+    err(1, "listen");
+  }
+
+  for (int i = 0; i < iterations; ++i) {
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client < 0) {
+      err(1, "socket");
+    }
+    if (connect(client, reinterpret_cast<struct sockaddr*>(&addr), addr_len) <
+        0) {
+      err(1, "connect");
+    }
+    int accepted = RetryEINTR(accept)(server, nullptr, nullptr);
+    if (accepted < 0) {
+      err(1, "accept");
+    }
+    close(accepted);
+    close(client);
+  }
+}
+
+// stormExecve forks and re-executes itself in a loop. The child exits right
+// away.
+void stormExecve(int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      err(1, "fork");
+    }
+    if (pid == 0) {
+      char* const argv[] = {const_cast<char*>("storm"),
+                            const_cast<char*>("exit"), nullptr};
+      execv("/proc/self/exe", argv);
+      err(1, "execv");
+    }
+    int status;
+    if (RetryEINTR(waitpid)(pid, &status, 0) < 0) {
+      err(1, "waitpid");
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      errx(1, "child failed with status: %#x", status);
+    }
+  }
+}
+
+}  // namespace testing
+}  // namespace gvisor
+
+int main(int argc, char** argv) {
+  if (argc == 2 && strcmp(argv[1], "exit") == 0) {
+    // Child of stormExecve.
+    return 0;
+  }
+  int iterations;
+  if (argc != 3 || !absl::SimpleAtoi(argv[2], &iterations)) {
+    errx(1, "Usage: storm <open|connect|execve> <iterations>");
+  }
+
+  void (*storm)(int);
+  if (strcmp(argv[1], "open") == 0) {
+    storm = ::gvisor::testing::stormOpen;
+  } else if (strcmp(argv[1], "connect") == 0) {
+    storm = ::gvisor::testing::stormConnect;
+  } else if (strcmp(argv[1], "execve") == 0) {
+    storm = ::gvisor::testing::stormExecve;
+  } else {
+    errx(1, "Invalid storm: %s", argv[1]);
+  }
+
+  absl::Time start = absl::Now();
+  storm(iterations);
+  printf("elapsed_ns: %ld\n", absl::ToInt64Nanoseconds(absl::Now() - start));
+  return 0;
+}
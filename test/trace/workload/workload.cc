@@ -27,16 +27,25 @@
 #include <sys/timerfd.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/cleanup/cleanup.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "test/util/eventfd_util.h"
@@ -47,9 +56,30 @@
 #include "test/util/posix_error.h"
 #include "test/util/test_util.h"
 
+ABSL_FLAG(std::vector<std::string>, routines, {},
+          "Routines to run, e.g. Socket,ReadWrite. Defaults to all routines, "
+          "or all routines that support stress mode when it's enabled.");
+ABSL_FLAG(int, repeat, 1,
+          "Number of times that each thread runs the routines. Setting any of "
+          "--repeat, --threads, --processes or --rate enables stress mode.");
+ABSL_FLAG(int, threads, 1, "Number of threads per process running routines.");
+ABSL_FLAG(int, processes, 1, "Number of processes running routines.");
+ABSL_FLAG(double, rate, 0,
+          "Target number of routine calls per second across all threads and "
+          "processes. Zero means as fast as possible.");
+
 namespace gvisor {
 namespace testing {
 
+// uniqueName returns name with a suffix that is unique to each call, so that
+// routines can run concurrently in stress mode. Names can't be reused even by
+// the same thread, because children forked by other threads may still hold
+// sockets bound to them.
+std::string uniqueName(absl::string_view name) {
+  static std::atomic<uint64_t> counter;
+  return absl::StrCat(name, ".", getpid(), ".", counter.fetch_add(1));
+}
+
 // runForkExecve triggers a ForkAndExec process which results in the execution
 // of an execve() syscall by Sentry. It executes a symlink, which creates an
 // execution point with distinct properties for binary execution paths to
@@ -100,12 +130,13 @@ void runForkExecveat() {
 // Creates a simple UDS in the abstract namespace and send one byte from the
 // client to the server.
 void runSocket() {
-  auto path = absl::StrCat(std::string("\0", 1), "trace_test.", getpid(),
+  auto path = absl::StrCat(std::string("\0", 1), uniqueName("trace_test"),
                            absl::GetCurrentTimeNanos());
 
-  struct sockaddr_un addr;
+  // strncpy(3) can't be used because the path starts with a null byte.
+  struct sockaddr_un addr = {};
   addr.sun_family = AF_UNIX;
-  strncpy(addr.sun_path, path.c_str(), path.size() + 1);
+  memcpy(addr.sun_path, path.data(), path.size());
 
   int parent_sock = socket(AF_UNIX, SOCK_STREAM, 0);
   if (parent_sock < 0) {
@@ -145,7 +176,7 @@ void runSocket() {
     if (bytes != 1) {
       err(1, "write: %d", bytes);
     }
-    exit(0);
+    _exit(0);
 
   } else {
     // Parent.
@@ -167,7 +198,7 @@ void runSocket() {
 }
 
 void runReadWrite() {
-  const std::string path = "read-write.txt";
+  const std::string path = uniqueName("read-write.txt");
   auto fd_or = Open(path, O_RDWR | O_CREAT, 0644);
   if (!fd_or.ok()) {
     err(1, "open(O_CREAT): %s", fd_or.error().ToString().c_str());
@@ -319,13 +350,13 @@ void runChroot() {
   }
 }
 void runDup() {
-  const auto pathname = "trace_test.abc";
+  const auto pathname = uniqueName("trace_test.abc");
   static constexpr mode_t kDefaultDirMode = 0755;
-  int path_or_error = mkdir(pathname, kDefaultDirMode);
+  int path_or_error = mkdir(pathname.c_str(), kDefaultDirMode);
   if (path_or_error != 0) {
     err(1, "mkdir");
   }
-  int fd = open(pathname, O_DIRECTORY | O_RDONLY);
+  int fd = open(pathname.c_str(), O_DIRECTORY | O_RDONLY);
   if (fd < 0) {
     err(1, "open");
   }
@@ -333,21 +364,23 @@ void runDup() {
   if (res < 0) {
     err(1, "dup");
   }
-  rmdir(pathname);
+  close(res);
+  close(fd);
+  rmdir(pathname.c_str());
 }
 
 void runDup2() {
-  const auto pathname = "trace_test.abc";
+  const auto pathname = uniqueName("trace_test.abc");
   static constexpr mode_t kDefaultDirMode = 0755;
-  int path_or_error = mkdir(pathname, kDefaultDirMode);
+  int path_or_error = mkdir(pathname.c_str(), kDefaultDirMode);
   if (path_or_error != 0) {
     err(1, "mkdir");
   }
-  int oldfd = open(pathname, O_DIRECTORY | O_RDONLY);
+  int oldfd = open(pathname.c_str(), O_DIRECTORY | O_RDONLY);
   if (oldfd < 0) {
     err(1, "open");
   }
-  int newfd = open(pathname, O_DIRECTORY | O_RDONLY);
+  int newfd = open(pathname.c_str(), O_DIRECTORY | O_RDONLY);
   if (newfd < 0) {
     err(1, "open");
   }
@@ -355,21 +388,23 @@ void runDup2() {
   if (res != newfd) {
     err(1, "dup2");
   }
-  rmdir(pathname);
+  close(newfd);
+  close(oldfd);
+  rmdir(pathname.c_str());
 }
 
 void runDup3() {
-  const auto pathname = "trace_test.abc";
+  const auto pathname = uniqueName("trace_test.abc");
   static constexpr mode_t kDefaultDirMode = 0755;
-  int path_or_error = mkdir(pathname, kDefaultDirMode);
+  int path_or_error = mkdir(pathname.c_str(), kDefaultDirMode);
   if (path_or_error != 0) {
     err(1, "mkdir");
   }
-  int oldfd = open(pathname, O_DIRECTORY | O_RDONLY);
+  int oldfd = open(pathname.c_str(), O_DIRECTORY | O_RDONLY);
   if (oldfd < 0) {
     err(1, "open");
   }
-  int newfd = open(pathname, O_DIRECTORY | O_RDONLY);
+  int newfd = open(pathname.c_str(), O_DIRECTORY | O_RDONLY);
   if (newfd < 0) {
     err(1, "open");
   }
@@ -377,7 +412,9 @@ void runDup3() {
   if (res != newfd) {
     err(1, "dup3");
   }
-  rmdir(pathname);
+  close(newfd);
+  close(oldfd);
+  rmdir(pathname.c_str());
 }
 
 void runPrlimit64() {
@@ -395,6 +432,7 @@ void runEventfd() {
   if (res < 0) {
     err(1, "eventfd");
   }
+  close(res);
 }
 
 void runEventfd2() {
@@ -402,14 +440,16 @@ void runEventfd2() {
   if (res < 0) {
     err(1, "eventfd2");
   }
+  close(res);
 }
 
 void runBind() {
-  auto path = absl::StrCat(std::string("\0", 1), "trace_test.abc");
+  auto path = absl::StrCat(std::string("\0", 1), uniqueName("trace_test.abc"));
 
-  struct sockaddr_un addr;
+  // strncpy(3) can't be used because the path starts with a null byte.
+  struct sockaddr_un addr = {};
   addr.sun_family = AF_UNIX;
-  strncpy(addr.sun_path, path.c_str(), path.size() + 1);
+  memcpy(addr.sun_path, path.data(), path.size());
 
   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
   if (fd < 0) {
@@ -423,11 +463,12 @@ void runBind() {
 }
 
 void runAccept() {
-  auto path = absl::StrCat(std::string("\0", 1), "trace_test.abc");
+  auto path = absl::StrCat(std::string("\0", 1), uniqueName("trace_test.abc"));
 
-  struct sockaddr_un addr;
+  // strncpy(3) can't be used because the path starts with a null byte.
+  struct sockaddr_un addr = {};
   addr.sun_family = AF_UNIX;
-  strncpy(addr.sun_path, path.c_str(), path.size() + 1);
+  memcpy(addr.sun_path, path.data(), path.size());
 
   int server = socket(AF_UNIX, SOCK_STREAM, 0);
   if (server < 0) {
@@ -462,11 +503,12 @@ void runAccept() {
 }
 
 void runAccept4() {
-  auto path = absl::StrCat(std::string("\0", 1), "trace_test.abc");
+  auto path = absl::StrCat(std::string("\0", 1), uniqueName("trace_test.abc"));
 
-  struct sockaddr_un addr;
+  // strncpy(3) can't be used because the path starts with a null byte.
+  struct sockaddr_un addr = {};
   addr.sun_family = AF_UNIX;
-  strncpy(addr.sun_path, path.c_str(), path.size() + 1);
+  memcpy(addr.sun_path, path.data(), path.size());
 
   int server = socket(AF_UNIX, SOCK_STREAM, 0);
   if (server < 0) {
@@ -507,16 +549,17 @@ void runSignalfd4() {
   if (res < 0) {
     err(1, "signalfd4");
   }
+  close(res);
 }
 
 void runFcntl() {
-  const auto pathname = "trace_test.abc";
+  const auto pathname = uniqueName("trace_test.abc");
   static constexpr mode_t kDefaultDirMode = 0755;
-  int path_or_error = mkdir(pathname, kDefaultDirMode);
+  int path_or_error = mkdir(pathname.c_str(), kDefaultDirMode);
   if (path_or_error != 0) {
     err(1, "mkdir");
   }
-  int fd = open(pathname, O_DIRECTORY | O_RDONLY);
+  int fd = open(pathname.c_str(), O_DIRECTORY | O_RDONLY);
   if (fd < 0) {
     err(1, "open");
   }
@@ -526,7 +569,7 @@ void runFcntl() {
   if (res < 0) {
     err(1, "fcntl");
   }
-  rmdir(pathname);
+  rmdir(pathname.c_str());
 }
 
 void runPipe() {
@@ -595,7 +638,7 @@ void runFork() {
   if (pid < 0) {
     err(1, "fork");
   } else if (pid == 0) {
-    exit(0);
+    _exit(0);
   }
   RetryEINTR(waitpid)(pid, nullptr, 0);
 }
@@ -618,6 +661,7 @@ void runSignalfd() {
   if (res < 0) {
     err(1, "signalfd");
   }
+  close(res);
 }
 #endif
 
@@ -653,9 +697,9 @@ void runInotifyInit1() {
 }
 
 void runInotifyAddWatch() {
-  const auto pathname = "timer_trace_test.abc";
+  const auto pathname = uniqueName("timer_trace_test.abc");
   static constexpr mode_t kDefaultDirMode = 0755;
-  int path_or_error = mkdir(pathname, kDefaultDirMode);
+  int path_or_error = mkdir(pathname.c_str(), kDefaultDirMode);
   if (path_or_error != 0) {
     err(1, "mkdir");
   }
@@ -665,17 +709,17 @@ void runInotifyAddWatch() {
   }
   auto fd_closer = absl::MakeCleanup([fd] { close(fd); });
 
-  int res = inotify_add_watch(fd, pathname, IN_NONBLOCK);
+  int res = inotify_add_watch(fd, pathname.c_str(), IN_NONBLOCK);
   if (res < 0) {
     err(1, "inotify_add_watch");
   }
-  rmdir(pathname);
+  rmdir(pathname.c_str());
 }
 
 void runInotifyRmWatch() {
-  const auto pathname = "timer_trace_test.abc";
+  const auto pathname = uniqueName("timer_trace_test.abc");
   static constexpr mode_t kDefaultDirMode = 0755;
-  int path_or_error = mkdir(pathname, kDefaultDirMode);
+  int path_or_error = mkdir(pathname.c_str(), kDefaultDirMode);
   if (path_or_error != 0) {
     err(1, "mkdir");
   }
@@ -685,7 +729,7 @@ void runInotifyRmWatch() {
   }
   auto fd_closer = absl::MakeCleanup([fd] { close(fd); });
 
-  int wd = inotify_add_watch(fd, pathname, IN_NONBLOCK);
+  int wd = inotify_add_watch(fd, pathname.c_str(), IN_NONBLOCK);
   if (wd < 0) {
     err(1, "inotify_add_watch");
   }
@@ -693,53 +737,218 @@ void runInotifyRmWatch() {
   if (res < 0) {
     err(1, "inotify_rm_watch");
   }
-  rmdir(pathname);
+  rmdir(pathname.c_str());
+}
+
+// Routine is a function that triggers one or more points.
+struct Routine {
+  const char* name;
+  void (*run)();
+  // Set if the routine can be repeated and run concurrently with other
+  // routines. Routines that change process-wide state, like the working or
+  // root directory, can't.
+  bool stress;
+};
+
+// Routines in the order that they run by default.
+const std::vector<Routine>& routines() {
+  static const auto* kRoutines = new std::vector<Routine>{
+      // The symlink used by runForkExecve has a fixed name that is checked by
+      // trace_test.go.
+      {"ForkExecve", runForkExecve, false},
+      {"ForkExecveat", runForkExecveat, true},
+      {"Socket", runSocket, true},
+      {"ReadWrite", runReadWrite, true},
+      {"Chdir", runChdir, false},
+      {"Fchdir", runFchdir, false},
+      {"Setgid", runSetgid, true},
+      {"Setuid", runSetuid, true},
+      // setsid(2) only fails as expected in a process group leader.
+      {"Setsid", runSetsid, false},
+      {"Setresuid", runSetresuid, true},
+      {"Setresgid", runSetresgid, true},
+      {"Dup", runDup, true},
+      {"Dup2", runDup2, true},
+      {"Dup3", runDup3, true},
+      {"Prlimit64", runPrlimit64, true},
+      {"Eventfd", runEventfd, true},
+      {"Eventfd2", runEventfd2, true},
+      {"Bind", runBind, true},
+      {"Accept", runAccept, true},
+      {"Accept4", runAccept4, true},
+      {"Signalfd4", runSignalfd4, true},
+      {"Fcntl", runFcntl, true},
+      {"Pipe", runPipe, true},
+      {"Pipe2", runPipe2, true},
+      {"TimerfdCreate", runTimerfdCreate, true},
+      {"TimerfdSettime", runTimerfdSettime, true},
+      {"TimerfdGettime", runTimerfdGettime, true},
+      {"Clone", runClone, true},
+      {"InotifyInit", runInotifyInit, true},
+      {"InotifyInit1", runInotifyInit1, true},
+      {"InotifyAddWatch", runInotifyAddWatch, true},
+      {"InotifyRmWatch", runInotifyRmWatch, true},
+  // signalfd(2), fork(2), and vfork(2) system calls are not supported in arm
+  // architecture.
+#ifdef __x86_64__
+      {"Signalfd", runSignalfd, true},
+      {"Fork", runFork, true},
+      {"Vfork", runVfork, true},
+#endif
+      // Run chroot at the end since it changes the root for all other tests.
+      {"Chroot", runChroot, false},
+  };
+  return *kRoutines;
+}
+
+// selectRoutines returns the routines selected with --routines.
+std::vector<const Routine*> selectRoutines(bool stress) {
+  std::vector<const Routine*> selected;
+  const std::vector<std::string> names = absl::GetFlag(FLAGS_routines);
+  if (names.empty()) {
+    for (const Routine& routine : routines()) {
+      if (!stress || routine.stress) {
+        selected.push_back(&routine);
+      }
+    }
+    return selected;
+  }
+  for (const std::string& name : names) {
+    auto it = std::find_if(
+        routines().begin(), routines().end(),
+        [&name](const Routine& routine) { return name == routine.name; });
+    if (it == routines().end()) {
+      errx(1, "unknown routine: %s", name.c_str());
+    }
+    if (stress && !it->stress) {
+      errx(1, "routine %s can't be used in stress mode", name.c_str());
+    }
+    selected.push_back(&*it);
+  }
+  return selected;
+}
+
+// RoutineStats accumulates the number of calls and the time spent in a
+// routine.
+struct RoutineStats {
+  uint64_t calls = 0;
+  absl::Duration elapsed;
+};
+
+// stressThread runs all routines repeat times. If interval is not zero, calls
+// are paced to start interval apart.
+void stressThread(const std::vector<const Routine*>& selected, int repeat,
+                  absl::Duration interval, std::vector<RoutineStats>* stats) {
+  absl::Time next = absl::Now();
+  for (int i = 0; i < repeat; ++i) {
+    for (size_t j = 0; j < selected.size(); ++j) {
+      if (interval > absl::ZeroDuration()) {
+        absl::SleepFor(next - absl::Now());
+        next += interval;
+      }
+      absl::Time start = absl::Now();
+      selected[j]->run();
+      (*stats)[j].calls++;
+      (*stats)[j].elapsed += absl::Now() - start;
+    }
+  }
+}
+
+// stressProcess runs the routines in multiple threads and prints how long
+// routines took on average.
+void stressProcess(const std::vector<const Routine*>& selected, int repeat,
+                   int threads, absl::Duration interval) {
+  std::vector<std::vector<RoutineStats>> stats(
+      threads, std::vector<RoutineStats>(selected.size()));
+  absl::Time start = absl::Now();
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back(stressThread, std::cref(selected), repeat, interval,
+                         &stats[i]);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  absl::Duration elapsed = absl::Now() - start;
+
+  uint64_t total = 0;
+  for (size_t j = 0; j < selected.size(); ++j) {
+    RoutineStats sum;
+    for (const auto& thread : stats) {
+      sum.calls += thread[j].calls;
+      sum.elapsed += thread[j].elapsed;
+    }
+    total += sum.calls;
+    printf("pid %d: %s: %lu calls, %ld ns/call\n", getpid(),
+           selected[j]->name, sum.calls,
+           absl::ToInt64Nanoseconds(sum.elapsed / sum.calls));
+  }
+  printf("pid %d: %lu calls in %ld ms (%.0f calls/s)\n", getpid(), total,
+         absl::ToInt64Milliseconds(elapsed),
+         total / absl::ToDoubleSeconds(elapsed));
+}
+
+// stress runs the selected routines repeatedly across multiple threads and
+// processes, to drive trace sessions at a high rate.
+void stress(const std::vector<const Routine*>& selected) {
+  const int repeat = absl::GetFlag(FLAGS_repeat);
+  const int threads = absl::GetFlag(FLAGS_threads);
+  const int processes = absl::GetFlag(FLAGS_processes);
+  const double rate = absl::GetFlag(FLAGS_rate);
+  if (repeat < 1 || threads < 1 || processes < 1 || rate < 0) {
+    errx(1, "--repeat, --threads and --processes must be positive and --rate "
+            "can't be negative");
+  }
+  // Each thread gets an equal share of the rate.
+  absl::Duration interval;
+  if (rate > 0) {
+    interval = absl::Seconds(threads * processes / rate);
+  }
+
+  std::vector<pid_t> children;
+  for (int i = 0; i < processes; ++i) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      err(1, "fork");
+    }
+    if (pid == 0) {
+      stressProcess(selected, repeat, threads, interval);
+      fflush(stdout);
+      _exit(0);
+    }
+    children.push_back(pid);
+  }
+  for (pid_t pid : children) {
+    int status;
+    if (RetryEINTR(waitpid)(pid, &status, 0) < 0) {
+      err(1, "waitpid");
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      errx(1, "stress process %d failed with status: %#x", pid, status);
+    }
+  }
 }
 
 }  // namespace testing
 }  // namespace gvisor
 
+// By default, every routine runs once, which is used by trace_test.go to
+// validate points. Stress mode runs selected routines repeatedly to measure
+// the overhead of points, e.g.:
+//
+//   workload --routines=Socket,ReadWrite --repeat=1000 --threads=4 --rate=5000
 int main(int argc, char** argv) {
-  ::gvisor::testing::runForkExecve();
-  ::gvisor::testing::runForkExecveat();
-  ::gvisor::testing::runSocket();
-  ::gvisor::testing::runReadWrite();
-  ::gvisor::testing::runChdir();
-  ::gvisor::testing::runFchdir();
-  ::gvisor::testing::runSetgid();
-  ::gvisor::testing::runSetuid();
-  ::gvisor::testing::runSetsid();
-  ::gvisor::testing::runSetresuid();
-  ::gvisor::testing::runSetresgid();
-  ::gvisor::testing::runDup();
-  ::gvisor::testing::runDup2();
-  ::gvisor::testing::runDup3();
-  ::gvisor::testing::runPrlimit64();
-  ::gvisor::testing::runEventfd();
-  ::gvisor::testing::runEventfd2();
-  ::gvisor::testing::runBind();
-  ::gvisor::testing::runAccept();
-  ::gvisor::testing::runAccept4();
-  ::gvisor::testing::runSignalfd4();
-  ::gvisor::testing::runFcntl();
-  ::gvisor::testing::runPipe();
-  ::gvisor::testing::runPipe2();
-  ::gvisor::testing::runTimerfdCreate();
-  ::gvisor::testing::runTimerfdSettime();
-  ::gvisor::testing::runTimerfdGettime();
-  ::gvisor::testing::runClone();
-  ::gvisor::testing::runInotifyInit();
-  ::gvisor::testing::runInotifyInit1();
-  ::gvisor::testing::runInotifyAddWatch();
-  ::gvisor::testing::runInotifyRmWatch();
-// signalfd(2), fork(2), and vfork(2) system calls are not supported in arm
-// architecture.
-#ifdef __x86_64__
-  ::gvisor::testing::runSignalfd();
-  ::gvisor::testing::runFork();
-  ::gvisor::testing::runVfork();
-#endif
-  // Run chroot at the end since it changes the root for all other tests.
-  ::gvisor::testing::runChroot();
+  absl::ParseCommandLine(argc, argv);
+  const bool stress =
+      absl::GetFlag(FLAGS_repeat) != 1 || absl::GetFlag(FLAGS_threads) != 1 ||
+      absl::GetFlag(FLAGS_processes) != 1 || absl::GetFlag(FLAGS_rate) != 0;
+  auto selected = ::gvisor::testing::selectRoutines(stress);
+  if (stress) {
+    ::gvisor::testing::stress(selected);
+    return 0;
+  }
+  for (const auto* routine : selected) {
+    routine->run();
+  }
   return 0;
 }
@@ -0,0 +1,116 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/util/benchmark_latency.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+
+namespace gvisor {
+namespace testing {
+
+int LatencyHistogram::BucketIndex(uint64_t v) {
+  if (v < kSubBuckets) {
+    return v;
+  }
+  // e is the index of the most significant bit, and the next kSubBucketBits
+  // bits select the sub-bucket.
+  int e = 63 - __builtin_clzll(v);
+  int sub = (v >> (e - kSubBucketBits)) - kSubBuckets;
+  return (e - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketValue(int i) {
+  if (i < kSubBuckets) {
+    return i;
+  }
+  int e = i / kSubBuckets + kSubBucketBits - 1;
+  uint64_t sub = i % kSubBuckets;
+  return (kSubBuckets + sub) << (e - kSubBucketBits);
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(q * count_));
+  if (rank < 1) {
+    rank = 1;
+  }
+  if (rank > count_) {
+    rank = count_;
+  }
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return BucketValue(i);
+    }
+  }
+  return BucketValue(kBuckets - 1);
+}
+
+LatencyRecorder::~LatencyRecorder() {
+  if (histogram_.Count() == 0) {
+    return;
+  }
+  uint64_t p50 = histogram_.Percentile(0.5);
+  uint64_t p90 = histogram_.Percentile(0.9);
+  uint64_t p99 = histogram_.Percentile(0.99);
+  uint64_t p999 = histogram_.Percentile(0.999);
+
+  state_.counters["p50_ns"] =
+      benchmark::Counter(p50, benchmark::Counter::kAvgThreads);
+  state_.counters["p90_ns"] =
+      benchmark::Counter(p90, benchmark::Counter::kAvgThreads);
+  state_.counters["p99_ns"] =
+      benchmark::Counter(p99, benchmark::Counter::kAvgThreads);
+  state_.counters["p999_ns"] =
+      benchmark::Counter(p999, benchmark::Counter::kAvgThreads);
+
+  WriteJSON(p50, p90, p99, p999);
+}
+
+void LatencyRecorder::WriteJSON(uint64_t p50, uint64_t p90, uint64_t p99,
+                                uint64_t p999) {
+  const char* dir = getenv("TEST_UNDECLARED_OUTPUTS_DIR");
+  if (dir == nullptr) {
+    return;
+  }
+  std::string path = absl::StrCat(dir, "/benchmark_latency.json");
+  // A single write with O_APPEND keeps lines from concurrent threads intact.
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return;
+  }
+  std::string line = absl::StrFormat(
+      "{\"name\":\"%s\",\"threads\":%d,\"thread_index\":%d,"
+      "\"samples\":%d,\"p50_ns\":%d,\"p90_ns\":%d,\"p99_ns\":%d,"
+      "\"p999_ns\":%d}\n",
+      name_, state_.threads(), state_.thread_index(), histogram_.Count(), p50,
+      p90, p99, p999);
+  (void)write(fd, line.data(), line.size());
+  close(fd);
+}
+
+}  // namespace testing
+}  // namespace gvisor
@@ -0,0 +1,131 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GVISOR_TEST_UTIL_BENCHMARK_LATENCY_H_
+#define GVISOR_TEST_UTIL_BENCHMARK_LATENCY_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <array>
+#include <string>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+
+namespace gvisor {
+namespace testing {
+
+// LatencyHistogram is a log-linear histogram of latencies in nanoseconds, in
+// the style of HdrHistogram. Values are bucketed with a relative error of at
+// most 1/32, and recording a value is O(1).
+class LatencyHistogram {
+ public:
+  // Record adds one sample of ns nanoseconds.
+  void Record(uint64_t ns) {
+    counts_[BucketIndex(ns)]++;
+    count_++;
+  }
+
+  // Count returns the number of recorded samples.
+  uint64_t Count() const { return count_; }
+
+  // Percentile returns the lower bound of the bucket that contains the q-th
+  // quantile of recorded samples, where q is in [0, 1]. It returns 0 if no
+  // samples have been recorded.
+  uint64_t Percentile(double q) const;
+
+  // BucketIndex and BucketValue are exposed for testing.
+  static int BucketIndex(uint64_t v);
+  static uint64_t BucketValue(int i);
+
+ private:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  std::array<uint64_t, kBuckets> counts_ = {};
+  uint64_t count_ = 0;
+};
+
+// LatencyRecorder records the latency of each iteration of a benchmark. When
+// it is destroyed, it reports the p50, p90, p99 and p999 latencies as user
+// counters of the benchmark. If the TEST_UNDECLARED_OUTPUTS_DIR environment
+// variable is set, it also appends the percentiles as one JSON object per line
+// to benchmark_latency.json in that directory. Google Benchmark runs a
+// benchmark several times while it picks the number of iterations, so readers
+// should use the line with the most samples for each name and thread count.
+//
+// Usage:
+//
+//   void BM_Foo(benchmark::State& state) {
+//     LatencyRecorder latency(state, "BM_Foo");
+//     for (auto _ : state) {
+//       LatencyRecorder::Iteration it(latency);
+//       ...
+//     }
+//   }
+//
+// In multi-threaded benchmarks, each thread has its own recorder and the
+// reported counters are averages of the per-thread percentiles.
+//
+// Timing each iteration adds two clock_gettime calls to it, so the mean time
+// of a benchmark that opts in isn't comparable with one that doesn't.
+class LatencyRecorder {
+ public:
+  LatencyRecorder(benchmark::State& state, std::string name)
+      : state_(state), name_(std::move(name)) {}
+  ~LatencyRecorder();
+
+  LatencyRecorder(const LatencyRecorder&) = delete;
+  LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+  // Iteration measures the time between its construction and destruction.
+  class Iteration {
+   public:
+    explicit Iteration(LatencyRecorder& recorder) : recorder_(recorder) {
+      clock_gettime(CLOCK_MONOTONIC, &start_);
+    }
+    ~Iteration() {
+      struct timespec end;
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      recorder_.histogram_.Record(
+          static_cast<uint64_t>(end.tv_sec - start_.tv_sec) * 1000000000 +
+          end.tv_nsec - start_.tv_nsec);
+    }
+
+    Iteration(const Iteration&) = delete;
+    Iteration& operator=(const Iteration&) = delete;
+
+   private:
+    LatencyRecorder& recorder_;
+    struct timespec start_;
+  };
+
+  // Record adds a sample of ns nanoseconds measured by the caller, for
+  // benchmarks whose latency of interest isn't the iteration time.
+  void Record(uint64_t ns) { histogram_.Record(ns); }
+
+ private:
+  void WriteJSON(uint64_t p50, uint64_t p90, uint64_t p99, uint64_t p999);
+
+  benchmark::State& state_;
+  const std::string name_;
+  LatencyHistogram histogram_;
+};
+
+}  // namespace testing
+}  // namespace gvisor
+
+#endif  // GVISOR_TEST_UTIL_BENCHMARK_LATENCY_H_
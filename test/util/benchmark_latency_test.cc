@@ -0,0 +1,85 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/util/benchmark_latency.h"
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  for (uint64_t v = 0; v < 64; v++) {
+    EXPECT_EQ(LatencyHistogram::BucketValue(LatencyHistogram::BucketIndex(v)),
+              v);
+  }
+}
+
+TEST(LatencyHistogramTest, BucketRelativeError) {
+  for (uint64_t v = 1; v < (uint64_t{1} << 40); v = v * 3 + 1) {
+    uint64_t lower =
+        LatencyHistogram::BucketValue(LatencyHistogram::BucketIndex(v));
+    EXPECT_LE(lower, v);
+    EXPECT_LE(v - lower, v / 32);
+  }
+  EXPECT_LE(LatencyHistogram::BucketValue(LatencyHistogram::BucketIndex(~0ULL)),
+            ~0ULL);
+}
+
+TEST(LatencyHistogramTest, BucketsAreMonotonic) {
+  int prev = LatencyHistogram::BucketIndex(0);
+  for (uint64_t v = 1; v < 100000; v++) {
+    int idx = LatencyHistogram::BucketIndex(v);
+    EXPECT_GE(idx, prev);
+    prev = idx;
+  }
+}
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram h;
+  EXPECT_EQ(h.Count(), 0);
+  EXPECT_EQ(h.Percentile(0.5), 0);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 1000; v++) {
+    h.Record(v);
+  }
+  EXPECT_EQ(h.Count(), 1000);
+  EXPECT_NEAR(h.Percentile(0.5), 500, 500 / 32);
+  EXPECT_NEAR(h.Percentile(0.9), 900, 900 / 32);
+  EXPECT_NEAR(h.Percentile(0.99), 990, 990 / 32);
+  EXPECT_EQ(h.Percentile(0), 1);
+  EXPECT_NEAR(h.Percentile(1), 1000, 1000 / 32);
+}
+
+TEST(LatencyHistogramTest, Tail) {
+  LatencyHistogram h;
+  for (int i = 0; i < 999; i++) {
+    h.Record(100);
+  }
+  h.Record(1000000);
+  EXPECT_EQ(h.Percentile(0.99), 100);
+  EXPECT_NEAR(h.Percentile(0.9995), 1000000, 1000000 / 32);
+}
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
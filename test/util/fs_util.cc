@@ -24,11 +24,23 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "test/util/cleanup.h"
@@ -267,14 +279,32 @@ PosixErrorOr<std::string> GetContentsFD(int fd) {
 }
 
 PosixError GetContentsFD(int fd, std::string* output) {
+  // Regular files are read in a single pass into a buffer sized from fstat,
+  // plus one byte so that the final read sees EOF without growing it. Other
+  // files, and those in procfs, which report a size of 0, start from a chunk
+  // and grow geometrically.
+  constexpr size_t kMinChunk = 16 * 1024;
+  size_t hint = kMinChunk;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    hint = st.st_size + 1;
+  }
+
+  const size_t start = output->size();
+  size_t len = start;
+  output->resize(start + hint);
+
   // Keep reading until we hit an EOF or an error.
   while (true) {
-    char buf[16 * 1024] = {};  // Read in 16KB chunks.
-    int bytes_read = read(fd, buf, sizeof(buf));
+    if (len == output->size()) {
+      output->resize(len + std::max(kMinChunk, len - start));
+    }
+    ssize_t bytes_read = read(fd, &(*output)[len], output->size() - len);
     if (bytes_read < 0) {
       if (errno == EINTR) {
         continue;
       }
+      output->resize(len);
       return PosixError(errno, "GetContentsFD read failure.");
     }
 
@@ -282,11 +312,42 @@ PosixError GetContentsFD(int fd, std::string* output) {
       break;  // EOF.
     }
 
-    output->append(buf, bytes_read);
+    len += bytes_read;
+  }
+  output->resize(len);
+  return NoError();
+}
+
+PosixError VisitContentsFD(
+    int fd, const std::function<void(absl::string_view)>& visitor,
+    size_t chunk_size) {
+  std::unique_ptr<char[]> buf(new char[chunk_size]);
+  while (true) {
+    ssize_t bytes_read = read(fd, buf.get(), chunk_size);
+    if (bytes_read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return PosixError(errno, "VisitContentsFD read failure.");
+    }
+
+    if (bytes_read == 0) {
+      break;  // EOF.
+    }
+
+    visitor(absl::string_view(buf.get(), bytes_read));
   }
   return NoError();
 }
 
+PosixError VisitContents(
+    absl::string_view path,
+    const std::function<void(absl::string_view)>& visitor,
+    size_t chunk_size) {
+  ASSIGN_OR_RETURN_ERRNO(auto fd, Open(std::string(path), O_RDONLY));
+  return VisitContentsFD(fd.get(), visitor, chunk_size);
+}
+
 PosixErrorOr<std::string> ReadLink(absl::string_view path) {
   char buf[PATH_MAX + 1] = {};
   int ret = readlink(std::string(path).c_str(), buf, PATH_MAX);
@@ -453,24 +514,245 @@ PosixError RecursivelyDelete(absl::string_view path, int* undeleted_dirs,
                   });
 }
 
+namespace {
+
+// ParallelTreeWalker scans a directory tree from a pool of threads that grows,
+// up to a limit, as directories are found.
+class ParallelTreeWalker {
+ public:
+  // on_entry is called for each entry of each directory while the directory
+  // is open, and returns true if the entry is a directory to descend into.
+  // on_dir is called with the path of each directory, including the root,
+  // once every entry below it has been visited.
+  using EntryFn =
+      std::function<bool(int dirfd, const char* name, bool is_dir)>;
+  using DirFn = std::function<void(const std::string& path)>;
+
+  ParallelTreeWalker(int parallelism, EntryFn on_entry, DirFn on_dir)
+      : parallelism_(std::max(parallelism, 1)),
+        on_entry_(std::move(on_entry)),
+        on_dir_(std::move(on_dir)) {}
+
+  // Walks the tree rooted at path and returns the first error encountered.
+  PosixError Run(absl::string_view path) {
+    queue_.push_back(new Dir{std::string(path), nullptr, 1});
+    Work();
+    // Work only returns once there is nothing left to do, so no more threads
+    // will be started.
+    for (std::thread& t : threads_) {
+      t.join();
+    }
+    return error_;
+  }
+
+ private:
+  struct Dir {
+    std::string path;
+    Dir* parent;
+    // The number of subdirectories not yet finished, plus one until this
+    // directory has been scanned.
+    std::atomic<int> pending;
+  };
+
+  bool HasWorkOrDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !queue_.empty() || busy_ == 0;
+  }
+
+  void Work() {
+    while (true) {
+      Dir* dir;
+      {
+        absl::MutexLock l(&mu_);
+        idle_++;
+        mu_.Await(absl::Condition(this, &ParallelTreeWalker::HasWorkOrDone));
+        idle_--;
+        if (queue_.empty()) {
+          return;
+        }
+        dir = queue_.front();
+        queue_.pop_front();
+        busy_++;
+      }
+      Scan(dir);
+      absl::MutexLock l(&mu_);
+      busy_--;
+    }
+  }
+
+  void Scan(Dir* dir) {
+    int fd = open(dir->path.c_str(),
+                  O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    DIR* d = fd < 0 ? nullptr : fdopendir(fd);
+    if (d == nullptr) {
+      RecordError(PosixError(errno, absl::StrCat("open ", dir->path)));
+      if (fd >= 0) {
+        close(fd);
+      }
+      Finish(dir);
+      return;
+    }
+    while (true) {
+      errno = 0;
+      struct dirent* dp = readdir(d);
+      if (dp == nullptr) {
+        if (errno != 0) {
+          RecordError(PosixError(errno, absl::StrCat("readdir ", dir->path)));
+        }
+        break;
+      }
+      if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0) {
+        continue;
+      }
+      bool is_dir = dp->d_type == DT_DIR;
+      if (dp->d_type == DT_UNKNOWN) {
+        struct stat st;
+        if (fstatat(fd, dp->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0) {
+          RecordError(PosixError(
+              errno, absl::StrCat("fstatat ", dir->path, "/", dp->d_name)));
+          continue;
+        }
+        is_dir = S_ISDIR(st.st_mode);
+      }
+      if (on_entry_(fd, dp->d_name, is_dir) && is_dir) {
+        dir->pending++;
+        Push(new Dir{JoinPath(dir->path, dp->d_name), dir, 1});
+      }
+    }
+    closedir(d);
+    Finish(dir);
+  }
+
+  void Push(Dir* dir) {
+    absl::MutexLock l(&mu_);
+    queue_.push_back(dir);
+    if (idle_ == 0 && static_cast<int>(threads_.size()) + 1 < parallelism_) {
+      threads_.emplace_back([this] { Work(); });
+    }
+  }
+
+  // Drops dir's own pending count, and finishes it and any ancestors that
+  // have nothing left pending.
+  void Finish(Dir* dir) {
+    while (dir != nullptr && --dir->pending == 0) {
+      on_dir_(dir->path);
+      Dir* parent = dir->parent;
+      delete dir;
+      dir = parent;
+    }
+  }
+
+  void RecordError(PosixError error) {
+    absl::MutexLock l(&mu_);
+    if (error_.ok()) {
+      error_ = std::move(error);
+    }
+  }
+
+  const int parallelism_;
+  const EntryFn on_entry_;
+  const DirFn on_dir_;
+
+  absl::Mutex mu_;
+  std::deque<Dir*> queue_ ABSL_GUARDED_BY(mu_);
+  // The number of threads scanning a directory.
+  int busy_ ABSL_GUARDED_BY(mu_) = 0;
+  // The number of threads waiting for a directory to scan.
+  int idle_ ABSL_GUARDED_BY(mu_) = 0;
+  // Threads other than the one calling Run.
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mu_);
+  PosixError error_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+PosixError ParallelWalkTree(
+    absl::string_view path, int parallelism,
+    const std::function<void(int dirfd, absl::string_view name,
+                             const struct stat&)>& cb) {
+  absl::Mutex mu;
+  PosixError error;
+  ParallelTreeWalker walker(
+      parallelism,
+      [&](int dirfd, const char* name, bool is_dir) {
+        struct stat st;
+        if (fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW) < 0) {
+          absl::MutexLock l(&mu);
+          if (error.ok()) {
+            error = PosixError(errno, absl::StrCat("fstatat ", name));
+          }
+          return false;
+        }
+        cb(dirfd, name, st);
+        return is_dir;
+      },
+      [](const std::string&) {});
+  RETURN_IF_ERRNO(walker.Run(path));
+  absl::MutexLock l(&mu);
+  return error;
+}
+
+PosixError ParallelRecursivelyDelete(absl::string_view path, int parallelism,
+                                     int* undeleted_dirs,
+                                     int* undeleted_files) {
+  ASSIGN_OR_RETURN_ERRNO(bool exists, Exists(path));
+  if (!exists) {
+    return PosixError(ENOENT, absl::StrCat(path, " does not exist"));
+  }
+
+  ASSIGN_OR_RETURN_ERRNO(bool dir, IsDirectory(path));
+  if (!dir) {
+    auto status = Delete(path);
+    if (!status.ok() && undeleted_files) {
+      (*undeleted_files)++;
+    }
+    return status;
+  }
+
+  std::atomic<int> dirs(0);
+  std::atomic<int> files(0);
+  ParallelTreeWalker walker(
+      parallelism,
+      [&](int dirfd, const char* name, bool is_dir) {
+        if (is_dir) {
+          return true;
+        }
+        if (unlinkat(dirfd, name, 0) < 0) {
+          files++;
+        }
+        return false;
+      },
+      [&](const std::string& dir_path) {
+        if (rmdir(dir_path.c_str()) < 0) {
+          dirs++;
+        }
+      });
+  PosixError status = walker.Run(path);
+  if (undeleted_dirs) {
+    *undeleted_dirs += dirs;
+  }
+  if (undeleted_files) {
+    *undeleted_files += files;
+  }
+  return status;
+}
+
 PosixError RecursivelyCreateDir(absl::string_view path) {
   if (path.empty() || path == "/") {
     return PosixError(EINVAL, "Cannot create root!");
   }
 
-  // Does it already exist, if so we're done.
-  ASSIGN_OR_RETURN_ERRNO(bool exists, Exists(path));
-  if (exists) {
+  // Try the common case of an existing parent first, so that creating a
+  // directory only walks up the tree when it has to.
+  const std::string path_str(path);
+  if (mkdir(path_str.c_str(), 0755) == 0 || errno == EEXIST) {
     return NoError();
   }
-
-  // Do we need to create directories under us?
-  auto dirname = Dirname(path);
-  ASSIGN_OR_RETURN_ERRNO(exists, Exists(dirname));
-  if (!exists) {
-    RETURN_IF_ERRNO(RecursivelyCreateDir(dirname));
+  if (errno != ENOENT) {
+    return PosixError(errno, absl::StrFormat("mkdir \"%s\" mode %#o", path,
+                                             0755));
   }
 
+  RETURN_IF_ERRNO(RecursivelyCreateDir(Dirname(path)));
   return Mkdir(path);
 }
 
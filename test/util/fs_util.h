@@ -128,13 +128,27 @@ PosixError GetContents(absl::string_view path, std::string* output);
 // Attempts to read the entire contents of the file or returns an error.
 PosixErrorOr<std::string> GetContents(absl::string_view path);
 
-// Attempts to read the entire contents of the provided fd into the provided
-// string or returns an error.
+// Attempts to read the entire contents of the provided fd, appending them to
+// the provided string, or returns an error. Regular files are read directly
+// into the string, sized from fstat.
 PosixError GetContentsFD(int fd, std::string* output);
 
 // Attempts to read the entire contents of the provided fd or returns an error.
 PosixErrorOr<std::string> GetContentsFD(int fd);
 
+// Reads the provided fd until EOF, passing each chunk of at most chunk_size
+// bytes to visitor as it is read, or returns an error. Chunks are not aligned
+// to lines or records, and each view is only valid during the call.
+PosixError VisitContentsFD(
+    int fd, const std::function<void(absl::string_view)>& visitor,
+    size_t chunk_size = 64 * 1024);
+
+// Like VisitContentsFD, but opens the file at path.
+PosixError VisitContents(
+    absl::string_view path,
+    const std::function<void(absl::string_view)>& visitor,
+    size_t chunk_size = 64 * 1024);
+
 // Executes the readlink(2) system call or returns an error.
 PosixErrorOr<std::string> ReadLink(absl::string_view path);
 
@@ -149,6 +163,17 @@ PosixError WalkTree(
     absl::string_view path, bool recursive,
     const std::function<void(absl::string_view, const struct stat&)>& cb);
 
+// ParallelWalkTree is like a recursive WalkTree, but scans directories
+// concurrently from up to parallelism threads, each of which holds at most one
+// directory open at a time. cb is called concurrently, and with the entry's
+// open parent directory and name rather than its path. Every entry below path
+// is visited, in no particular order; path itself is not. Symlinks are not
+// followed.
+PosixError ParallelWalkTree(
+    absl::string_view path, int parallelism,
+    const std::function<void(int dirfd, absl::string_view name,
+                             const struct stat&)>& cb);
+
 // Returns the base filenames for all files under a given absolute path. If
 // skipdots is true the returned vector will not contain "." or "..". This
 // method does not walk the tree recursively it only returns the elements
@@ -174,6 +199,15 @@ PosixError EventuallyDirContains(absl::string_view path,
 PosixError RecursivelyDelete(absl::string_view path, int* undeleted_dirs,
                              int* undeleted_files);
 
+// Like RecursivelyDelete, but unlinks each directory's entries relative to
+// the open directory and deletes independent subtrees concurrently from up to
+// parallelism threads, each of which holds at most one directory open at a
+// time. Threads are only started once there is more than one directory to
+// scan, so small trees are deleted on the calling thread.
+PosixError ParallelRecursivelyDelete(absl::string_view path, int parallelism,
+                                     int* undeleted_dirs,
+                                     int* undeleted_files);
+
 // Recursively create the directory provided or return an error.
 PosixError RecursivelyCreateDir(absl::string_view path);
 
@@ -15,11 +15,20 @@
 #include "test/util/fs_util.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <string>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "test/util/file_descriptor.h"
+#include "test/util/memory_util.h"
 #include "test/util/posix_error.h"
 #include "test/util/temp_path.h"
 #include "test/util/test_util.h"
@@ -99,6 +108,195 @@ TEST(FsUtilTest, RecursivelyCreateAndDeletePartial) {
   ASSERT_THAT(Exists(JoinPath(Dirname(sub_path), "file")),
               IsPosixErrorOkAndHolds(true));
 }
+// Returns size bytes of filler that does not repeat at chunk or page size.
+std::string Pattern(size_t size) {
+  std::string s(size, 0);
+  for (size_t i = 0; i < size; i++) {
+    s[i] = 'a' + (i * 7 + i / 26) % 26;
+  }
+  return s;
+}
+
+TEST(FsUtilTest, GetContentsFDLargeFile) {
+  const std::string want = Pattern((1 << 20) + 3);
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(
+      TempPath::CreateFileWith(GetAbsoluteTestTmpdir(), want, 0644));
+  const FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+  EXPECT_THAT(GetContentsFD(fd.get()), IsPosixErrorOkAndHolds(want));
+}
+
+TEST(FsUtilTest, GetContentsFDAppends) {
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(
+      TempPath::CreateFileWith(GetAbsoluteTestTmpdir(), "world", 0644));
+  const FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+  std::string contents = "hello ";
+  ASSERT_NO_ERRNO(GetContentsFD(fd.get(), &contents));
+  EXPECT_EQ(contents, "hello world");
+}
+
+TEST(FsUtilTest, GetContentsFDFromCurrentOffset) {
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(
+      TempPath::CreateFileWith(GetAbsoluteTestTmpdir(), "hello world", 0644));
+  const FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+  ASSERT_EQ(lseek(fd.get(), 6, SEEK_SET), 6);
+  EXPECT_THAT(GetContentsFD(fd.get()), IsPosixErrorOkAndHolds("world"));
+}
+
+TEST(FsUtilTest, GetContentsFDPipe) {
+  // Larger than the initial chunk, but small enough to fit in a pipe.
+  const std::string want = Pattern(40 * 1024);
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const FileDescriptor rfd(fds[0]);
+  FileDescriptor wfd(fds[1]);
+  ASSERT_EQ(WriteFd(wfd.get(), want.data(), want.size()), want.size());
+  wfd.reset();
+  EXPECT_THAT(GetContentsFD(rfd.get()), IsPosixErrorOkAndHolds(want));
+}
+
+TEST(FsUtilTest, GetContentsFDZeroSizeFile) {
+  // procfs files report a size of 0 despite having contents.
+  const std::string contents =
+      ASSERT_NO_ERRNO_AND_VALUE(GetContents("/proc/self/status"));
+  EXPECT_THAT(contents, ::testing::HasSubstr("Name:"));
+}
+
+TEST(FsUtilTest, VisitContentsFDChunks) {
+  constexpr size_t kChunk = 4096;
+  const std::string want = Pattern(10 * kChunk + 5);
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(
+      TempPath::CreateFileWith(GetAbsoluteTestTmpdir(), want, 0644));
+  const FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+  std::string got;
+  ASSERT_NO_ERRNO(VisitContentsFD(
+      fd.get(),
+      [&](absl::string_view chunk) {
+        EXPECT_LE(chunk.size(), kChunk);
+        got.append(chunk.data(), chunk.size());
+      },
+      kChunk));
+  EXPECT_EQ(got, want);
+}
+
+TEST(FsUtilTest, MmapContents) {
+  const std::string want = Pattern(3 * kPageSize + 5);
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(
+      TempPath::CreateFileWith(GetAbsoluteTestTmpdir(), want, 0644));
+  const FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+  const Mapping m = ASSERT_NO_ERRNO_AND_VALUE(MmapContents(fd.get()));
+  EXPECT_EQ(m.view(), want);
+}
+
+TEST(FsUtilTest, MmapContentsEmpty) {
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  const FileDescriptor fd =
+      ASSERT_NO_ERRNO_AND_VALUE(Open(file.path(), O_RDONLY));
+  const Mapping m = ASSERT_NO_ERRNO_AND_VALUE(MmapContents(fd.get()));
+  EXPECT_TRUE(m.view().empty());
+}
+
+TEST(FsUtilTest, MmapContentsPipe) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const FileDescriptor rfd(fds[0]);
+  const FileDescriptor wfd(fds[1]);
+  EXPECT_THAT(MmapContents(rfd.get()), PosixErrorIs(EINVAL));
+}
+
+// Creates depth levels of fanout subdirectories under path, each holding
+// that many regular files, and returns the number of entries created.
+int CreateTree(const std::string& path, int depth, int fanout, int files) {
+  int entries = 0;
+  for (int i = 0; i < files; i++) {
+    EXPECT_NO_ERRNO(CreateWithContents(JoinPath(path, absl::StrCat("f", i)),
+                                       "contents"));
+    entries++;
+  }
+  if (depth == 0) {
+    return entries;
+  }
+  for (int i = 0; i < fanout; i++) {
+    const std::string dir = JoinPath(path, absl::StrCat("d", i));
+    EXPECT_NO_ERRNO(Mkdir(dir));
+    entries += 1 + CreateTree(dir, depth - 1, fanout, files);
+  }
+  return entries;
+}
+
+TEST(FsUtilTest, ParallelWalkTree) {
+  const TempPath root = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+  const int want = CreateTree(root.path(), 3, 4, 5);
+  ASSERT_THAT(symlink("d0", JoinPath(root.path(), "link").c_str()),
+              SyscallSucceeds());
+
+  std::atomic<int> entries(0);
+  std::atomic<int> dirs(0);
+  ASSERT_NO_ERRNO(ParallelWalkTree(
+      root.path(), 4,
+      [&](int dirfd, absl::string_view name, const struct stat& st) {
+        EXPECT_GE(dirfd, 0);
+        entries++;
+        if (S_ISDIR(st.st_mode)) {
+          dirs++;
+        }
+      }));
+  // The symlink is visited but not followed.
+  EXPECT_EQ(entries, want + 1);
+  EXPECT_EQ(dirs, 4 + 4 * 4 + 4 * 4 * 4);
+}
+
+TEST(FsUtilTest, ParallelWalkTreeNotDirectory) {
+  const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  EXPECT_THAT(ParallelWalkTree(file.path(), 4,
+                               [](int, absl::string_view, const struct stat&) {
+                               }),
+              PosixErrorIs(ENOTDIR));
+}
+
+TEST(FsUtilTest, ParallelRecursivelyDelete) {
+  for (int parallelism : {1, 8}) {
+    SCOPED_TRACE(absl::StrCat("parallelism ", parallelism));
+    const std::string path = NewTempAbsPath();
+    ASSERT_NO_ERRNO(Mkdir(path));
+    CreateTree(path, 3, 4, 5);
+
+    int undeleted_dirs = 0;
+    int undeleted_files = 0;
+    ASSERT_NO_ERRNO(ParallelRecursivelyDelete(path, parallelism,
+                                              &undeleted_dirs,
+                                              &undeleted_files));
+    EXPECT_EQ(undeleted_dirs, 0);
+    EXPECT_EQ(undeleted_files, 0);
+    EXPECT_THAT(Exists(path), IsPosixErrorOkAndHolds(false));
+  }
+}
+
+TEST(FsUtilTest, ParallelRecursivelyDeleteFile) {
+  const std::string path = NewTempAbsPath();
+  ASSERT_NO_ERRNO(CreateWithContents(path, "contents"));
+  ASSERT_NO_ERRNO(ParallelRecursivelyDelete(path, 8, nullptr, nullptr));
+  EXPECT_THAT(Exists(path), IsPosixErrorOkAndHolds(false));
+}
+
+TEST(FsUtilTest, ParallelRecursivelyDeleteNonexistent) {
+  EXPECT_THAT(
+      ParallelRecursivelyDelete(NewTempAbsPath(), 8, nullptr, nullptr),
+      PosixErrorIs(ENOENT));
+}
+
+TEST(FsUtilTest, RecursivelyCreateDirExisting) {
+  const TempPath root = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+  ASSERT_NO_ERRNO(RecursivelyCreateDir(root.path()));
+  const std::string path = JoinPath(root.path(), "a/b");
+  ASSERT_NO_ERRNO(RecursivelyCreateDir(path));
+  EXPECT_THAT(IsDirectory(path), IsPosixErrorOkAndHolds(true));
+}
+
 }  // namespace
 
 }  // namespace testing
@@ -14,14 +14,18 @@
 
 #include "test/util/io_uring_util.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
 #include <memory>
 
 namespace gvisor {
 namespace testing {
 
 PosixErrorOr<std::unique_ptr<IOUring>> IOUring::InitIOUring(
-    unsigned int entries, IOUringParams &params) {
-  PosixErrorOr<FileDescriptor> fd = NewIOUringFD(entries, params);
+    unsigned int entries, IOUringParams &params, uint32_t flags) {
+  PosixErrorOr<FileDescriptor> fd = NewIOUringFD(entries, params, flags);
   if (!fd.ok()) {
     return fd.error();
   }
@@ -60,6 +64,8 @@ IOUring::IOUring(FileDescriptor &&fd, unsigned int entries,
       reinterpret_cast<char *>(cq_ptr_) + params.cq_off.overflow);
   sq_dropped_ptr_ = reinterpret_cast<uint32_t *>(
       reinterpret_cast<char *>(sq_ptr_) + params.sq_off.dropped);
+  sq_flags_ptr_ = reinterpret_cast<uint32_t *>(
+      reinterpret_cast<char *>(sq_ptr_) + params.sq_off.flags);
 
   sq_mask_ = *(reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(sq_ptr_) +
                                             params.sq_off.ring_mask));
@@ -89,6 +95,10 @@ uint32_t IOUring::load_sq_dropped() {
   return io_uring_atomic_read(sq_dropped_ptr_);
 }
 
+uint32_t IOUring::load_sq_flags() {
+  return io_uring_atomic_read(sq_flags_ptr_);
+}
+
 void IOUring::store_cq_head(uint32_t cq_head_val) {
   io_uring_atomic_write(cq_head_ptr_, cq_head_val);
 }
@@ -112,5 +122,127 @@ uint32_t IOUring::get_sq_mask() { return sq_mask_; }
 
 unsigned *IOUring::get_sq_array() { return sq_array_; }
 
+IOUringRing::IOUringRing(std::unique_ptr<IOUring> ring,
+                         const IOUringParams &params)
+    : ring_(std::move(ring)), params_(params) {
+  cq_mask_ = params_.cq_entries - 1;
+  sqe_head_ = ring_->load_sq_tail();
+  sqe_tail_ = sqe_head_;
+}
+
+PosixErrorOr<std::unique_ptr<IOUringRing>> IOUringRing::Create(
+    unsigned int entries, uint32_t flags) {
+  IOUringParams params;
+  PosixErrorOr<std::unique_ptr<IOUring>> ring =
+      IOUring::InitIOUring(entries, params, flags);
+  if (!ring.ok()) {
+    return ring.error();
+  }
+
+  return std::make_unique<IOUringRing>(std::move(ring.ValueOrDie()), params);
+}
+
+IOUringSqe *IOUringRing::GetSqe() {
+  if (sqe_tail_ - ring_->load_sq_head() >= params_.sq_entries) {
+    return nullptr;
+  }
+
+  uint32_t index = sqe_tail_ & ring_->get_sq_mask();
+  IOUringSqe *sqe = &ring_->get_sqes()[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring_->get_sq_array()[index] = index;
+  sqe_tail_++;
+  return sqe;
+}
+
+IOUringSqe *IOUringRing::PrepareNop(uint64_t user_data) {
+  IOUringSqe *sqe = GetSqe();
+  if (sqe != nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = user_data;
+  }
+  return sqe;
+}
+
+IOUringSqe *IOUringRing::PrepareRW(uint8_t opcode, int fd,
+                                   const struct iovec *iov,
+                                   unsigned int nr_vecs, uint64_t offset,
+                                   uint64_t user_data) {
+  IOUringSqe *sqe = GetSqe();
+  if (sqe != nullptr) {
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = nr_vecs;
+    sqe->user_data = user_data;
+  }
+  return sqe;
+}
+
+IOUringSqe *IOUringRing::PrepareRead(int fd, const struct iovec *iov,
+                                     unsigned int nr_vecs, uint64_t offset,
+                                     uint64_t user_data) {
+  return PrepareRW(IORING_OP_READV, fd, iov, nr_vecs, offset, user_data);
+}
+
+IOUringSqe *IOUringRing::PrepareWrite(int fd, const struct iovec *iov,
+                                      unsigned int nr_vecs, uint64_t offset,
+                                      uint64_t user_data) {
+  return PrepareRW(IORING_OP_WRITEV, fd, iov, nr_vecs, offset, user_data);
+}
+
+PosixErrorOr<int> IOUringRing::SubmitAndWait(unsigned int wait_nr) {
+  unsigned int submitted = Prepared();
+  if (submitted > 0) {
+    ring_->store_sq_tail(sqe_tail_);
+    sqe_head_ = sqe_tail_;
+  }
+
+  unsigned int to_submit = submitted;
+  unsigned int flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+  if (params_.flags & IORING_SETUP_SQPOLL) {
+    to_submit = 0;
+    // The tail store above must be ordered before the flags load, otherwise
+    // the kernel thread may go idle without ever seeing the new entries.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring_->load_sq_flags() & IORING_SQ_NEED_WAKEUP) {
+      flags |= IORING_ENTER_SQ_WAKEUP;
+    }
+  }
+  if (to_submit == 0 && flags == 0) {
+    return submitted;
+  }
+
+  int ret = ring_->Enter(to_submit, wait_nr, flags, nullptr);
+  if (ret < 0) {
+    return PosixError(errno, "io_uring_enter");
+  }
+  return (params_.flags & IORING_SETUP_SQPOLL) ? submitted : ret;
+}
+
+int IOUringRing::Reap(IOUringCqe *cqes, unsigned int max) {
+  uint32_t head = ring_->load_cq_head();
+  uint32_t tail = ring_->load_cq_tail();
+  uint32_t n = std::min(tail - head, max);
+
+  IOUringCqe *ring_cqes = ring_->get_cqes();
+  for (uint32_t i = 0; i < n; i++) {
+    cqes[i] = ring_cqes[(head + i) & cq_mask_];
+  }
+  ring_->store_cq_head(head + n);
+  return n;
+}
+
+PosixError IOUringRing::WaitAndReap(IOUringCqe *cqes, unsigned int nr) {
+  unsigned int reaped = Reap(cqes, nr);
+  while (reaped < nr) {
+    PosixErrorOr<int> ret = SubmitAndWait(nr - reaped);
+    RETURN_IF_ERRNO(ret);
+    reaped += Reap(cqes + reaped, nr - reaped);
+  }
+  return NoError();
+}
+
 }  // namespace testing
 }  // namespace gvisor
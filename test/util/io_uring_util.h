@@ -18,10 +18,12 @@
 #include <linux/fs.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 
 #include <atomic>
 #include <cerrno>
 #include <cstdint>
+#include <memory>
 
 #include "test/util/file_descriptor.h"
 #include "test/util/posix_error.h"
@@ -39,6 +41,10 @@ namespace testing {
 
 // io_uring_enter(2) flags
 #define IORING_ENTER_GETEVENTS (1U << 0)
+#define IORING_ENTER_SQ_WAKEUP (1U << 1)
+
+// sq_ring->flags
+#define IORING_SQ_NEED_WAKEUP (1U << 0)
 
 #define IORING_FEAT_SINGLE_MMAP (1U << 0)
 
@@ -49,6 +55,7 @@ namespace testing {
 // IO_URING operation codes.
 #define IORING_OP_NOP 0
 #define IORING_OP_READV 1
+#define IORING_OP_WRITEV 2
 
 #define BLOCK_SZ kPageSize
 
@@ -165,7 +172,7 @@ class IOUring {
   ~IOUring();
 
   static PosixErrorOr<std::unique_ptr<IOUring>> InitIOUring(
-      unsigned int entries, IOUringParams &params);
+      unsigned int entries, IOUringParams &params, uint32_t flags = 0);
 
   uint32_t load_cq_head();
   uint32_t load_cq_tail();
@@ -173,6 +180,7 @@ class IOUring {
   uint32_t load_sq_tail();
   uint32_t load_cq_overflow();
   uint32_t load_sq_dropped();
+  uint32_t load_sq_flags();
   void store_cq_head(uint32_t cq_head_val);
   void store_sq_tail(uint32_t sq_tail_val);
   int Enter(unsigned int to_submit, unsigned int min_complete,
@@ -199,11 +207,81 @@ class IOUring {
   uint32_t *sq_tail_ptr_ = nullptr;
   uint32_t *cq_overflow_ptr_ = nullptr;
   uint32_t *sq_dropped_ptr_ = nullptr;
+  uint32_t *sq_flags_ptr_ = nullptr;
   void *sq_ptr_ = nullptr;
   void *cq_ptr_ = nullptr;
   void *sqe_ptr_ = nullptr;
 };
 
+// IOUringRing is a higher-level wrapper around IOUring that tracks SQ and CQ
+// indices itself. SQEs are prepared in batches, published and submitted
+// together with a single io_uring_enter(2), and completions are reaped in
+// bulk.
+//
+// IOUringRing is not thread-safe.
+class IOUringRing {
+ public:
+  IOUringRing(std::unique_ptr<IOUring> ring, const IOUringParams &params);
+
+  // Create returns a ring with the given number of SQ entries and setup flags.
+  static PosixErrorOr<std::unique_ptr<IOUringRing>> Create(
+      unsigned int entries, uint32_t flags = 0);
+
+  // GetSqe returns the next free SQE, zeroed, or nullptr if every SQ entry is
+  // either prepared or not yet consumed by the kernel. The SQE is not visible
+  // to the kernel until the next Submit or SubmitAndWait.
+  IOUringSqe *GetSqe();
+
+  // PrepareNop, PrepareRead and PrepareWrite fill in the next free SQE with a
+  // NOP, READV or WRITEV operation. They return nullptr if the SQ is full.
+  // iov must remain valid until the corresponding completion is reaped.
+  IOUringSqe *PrepareNop(uint64_t user_data);
+  IOUringSqe *PrepareRead(int fd, const struct iovec *iov, unsigned int nr_vecs,
+                          uint64_t offset, uint64_t user_data);
+  IOUringSqe *PrepareWrite(int fd, const struct iovec *iov,
+                           unsigned int nr_vecs, uint64_t offset,
+                           uint64_t user_data);
+
+  // Prepared returns the number of SQEs prepared since the last submission.
+  unsigned int Prepared() const { return sqe_tail_ - sqe_head_; }
+
+  // Submit publishes all prepared SQEs and submits them without waiting for
+  // completions. It returns the number of SQEs submitted.
+  PosixErrorOr<int> Submit() { return SubmitAndWait(0); }
+
+  // SubmitAndWait publishes all prepared SQEs and, with a single
+  // io_uring_enter(2), submits them and waits until at least wait_nr
+  // completions are available. With IORING_SETUP_SQPOLL the kernel thread
+  // consumes the SQ on its own, and io_uring_enter(2) is only used to wake it
+  // or to wait. It returns the number of SQEs submitted.
+  PosixErrorOr<int> SubmitAndWait(unsigned int wait_nr);
+
+  // Reap copies up to max available CQEs into cqes, consumes them and returns
+  // the number copied. It never blocks.
+  int Reap(IOUringCqe *cqes, unsigned int max);
+
+  // WaitAndReap reaps exactly nr CQEs into cqes, waiting for completions as
+  // needed.
+  PosixError WaitAndReap(IOUringCqe *cqes, unsigned int nr);
+
+  const IOUringParams &params() const { return params_; }
+  IOUring *ring() { return ring_.get(); }
+
+ private:
+  IOUringSqe *PrepareRW(uint8_t opcode, int fd, const struct iovec *iov,
+                        unsigned int nr_vecs, uint64_t offset,
+                        uint64_t user_data);
+
+  std::unique_ptr<IOUring> ring_;
+  IOUringParams params_;
+  uint32_t cq_mask_;
+
+  // sqe_head_ is the SQ tail last published to the kernel, and sqe_tail_ is
+  // the local tail including prepared SQEs.
+  uint32_t sqe_head_;
+  uint32_t sqe_tail_;
+};
+
 // This is a wrapper for the io_uring_setup(2) system call.
 inline int IOUringSetup(uint32_t entries, IOUringParams *params) {
   return syscall(__NR_io_uring_setup, entries, params);
@@ -216,10 +294,12 @@ inline int IOUringEnter(unsigned int fd, unsigned int to_submit,
   return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, sig);
 }
 
-// Returns a new iouringfd with the given number of entries.
+// Returns a new iouringfd with the given number of entries and setup flags.
 inline PosixErrorOr<FileDescriptor> NewIOUringFD(uint32_t entries,
-                                                 IOUringParams &params) {
+                                                 IOUringParams &params,
+                                                 uint32_t flags = 0) {
   memset(&params, 0, sizeof(params));
+  params.flags = flags;
   int fd = IOUringSetup(entries, &params);
   MaybeSave();
   if (fd < 0) {
@@ -15,10 +15,18 @@
 #include "test/util/logging.h"
 
 #include <errno.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+
 namespace gvisor {
 namespace testing {
 
@@ -66,10 +74,198 @@ int WriteNumber(int fd, uint32_t val) {
   return Write(fd, s, size);
 }
 
+// LogBuffer is a ring buffer of messages written by one thread and read by
+// whoever holds draining.
+struct LogBuffer {
+  // Size of data, which must be a power of 2.
+  static constexpr uint64_t kSize = 64 << 10;
+
+  // head is the total number of bytes appended, and tail the total number of
+  // bytes written to stderr; both only grow.
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> tail;
+
+  // dropped is the number of message bytes dropped because data was full.
+  std::atomic<uint64_t> dropped;
+
+  // draining is set while the buffer is being written to stderr.
+  std::atomic<bool> draining;
+
+  // owned is set while the buffer belongs to a thread. Buffers of exited
+  // threads are reused by new threads.
+  std::atomic<bool> owned;
+
+  // appending is set by the owning thread while it appends, to detect
+  // reentrant calls from signal handlers.
+  bool appending;
+
+  LogBuffer* next;
+  char data[kSize];
+};
+
+// buffers is a list of all LogBuffers. Buffers are never removed.
+std::atomic<LogBuffer*> buffers;
+
+// direct is set when messages are written to stderr directly, in forked
+// children.
+std::atomic<bool> direct;
+
+pthread_once_t start_once = PTHREAD_ONCE_INIT;
+pthread_key_t buffer_key;
+
+// Interval at which the flushing thread writes buffers to stderr.
+constexpr long kFlushIntervalNanos = 10 * 1000 * 1000;
+
+thread_local LogBuffer* thread_buffer;
+
+// Drain writes the contents of buf to stderr if no other thread is doing so,
+// and returns whether it did.
+bool Drain(LogBuffer* buf) {
+  if (buf->draining.exchange(true, std::memory_order_acquire)) {
+    return false;
+  }
+  const uint64_t tail = buf->tail.load(std::memory_order_relaxed);
+  const uint64_t head = buf->head.load(std::memory_order_acquire);
+  if (head != tail) {
+    const uint64_t start = tail % LogBuffer::kSize;
+    const uint64_t end = head % LogBuffer::kSize;
+    if (start < end) {
+      Write(2, buf->data + start, end - start);
+    } else {
+      Write(2, buf->data + start, LogBuffer::kSize - start);
+      Write(2, buf->data, end);
+    }
+    buf->tail.store(head, std::memory_order_release);
+  }
+  if (const uint64_t dropped = buf->dropped.exchange(0)) {
+    constexpr char kDropped[] = " log bytes dropped\n";
+    WriteNumber(2, dropped);
+    Write(2, kDropped, sizeof(kDropped) - 1);
+  }
+  buf->draining.store(false, std::memory_order_release);
+  return true;
+}
+
+void* FlushThread(void*) {
+  while (true) {
+    const struct timespec ts = {0, kFlushIntervalNanos};
+    nanosleep(&ts, nullptr);
+    // Skip buffers that are being drained by FlushTestLog.
+    for (LogBuffer* b = buffers.load(); b != nullptr; b = b->next) {
+      Drain(b);
+    }
+  }
+  return nullptr;
+}
+
+void ReleaseBuffer(void* buf) {
+  LogBuffer* const b = static_cast<LogBuffer*>(buf);
+  Drain(b);
+  b->owned.store(false, std::memory_order_release);
+}
+
+void ForkChild() {
+  // Messages in the buffers are the parent's, which its flushing thread
+  // writes, and the child has no flushing thread.
+  direct.store(true);
+  for (LogBuffer* b = buffers.load(); b != nullptr; b = b->next) {
+    b->tail.store(b->head.load());
+    b->dropped.store(0);
+    b->draining.store(false);
+  }
+}
+
+void Start() {
+  pthread_key_create(&buffer_key, ReleaseBuffer);
+  pthread_atfork(nullptr, nullptr, ForkChild);
+  atexit(FlushTestLog);
+  pthread_t thread;
+  if (pthread_create(&thread, nullptr, FlushThread, nullptr) != 0) {
+    direct.store(true);
+    return;
+  }
+  pthread_detach(thread);
+}
+
+// ThreadBuffer returns the calling thread's buffer, or nullptr if none could
+// be allocated.
+LogBuffer* ThreadBuffer() {
+  if (thread_buffer != nullptr) {
+    return thread_buffer;
+  }
+  LogBuffer* buf = nullptr;
+  for (LogBuffer* b = buffers.load(); b != nullptr; b = b->next) {
+    bool owned = false;
+    if (b->owned.compare_exchange_strong(owned, true)) {
+      buf = b;
+      break;
+    }
+  }
+  if (buf == nullptr) {
+    void* addr = mmap(nullptr, sizeof(LogBuffer), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+      return nullptr;
+    }
+    // Anonymous memory is zeroed, as the initial state of a buffer is.
+    buf = static_cast<LogBuffer*>(addr);
+    buf->owned.store(true);
+    LogBuffer* next = buffers.load();
+    do {
+      buf->next = next;
+    } while (!buffers.compare_exchange_weak(next, buf));
+  }
+  pthread_setspecific(buffer_key, buf);
+  thread_buffer = buf;
+  return buf;
+}
+
 }  // namespace
 
+void TestLog(const char* msg, size_t msg_size) {
+  pthread_once(&start_once, Start);
+  LogBuffer* const buf = direct.load() ? nullptr : ThreadBuffer();
+  if (buf == nullptr || buf->appending) {
+    Write(2, msg, msg_size);
+    Write(2, "\n", 1);
+    return;
+  }
+  buf->appending = true;
+  const uint64_t size = msg_size + 1;
+  const uint64_t head = buf->head.load(std::memory_order_relaxed);
+  const uint64_t tail = buf->tail.load(std::memory_order_acquire);
+  if (size > LogBuffer::kSize - (head - tail)) {
+    buf->dropped.fetch_add(size);
+  } else {
+    const uint64_t start = head % LogBuffer::kSize;
+    const size_t first = std::min<uint64_t>(msg_size, LogBuffer::kSize - start);
+    memcpy(buf->data + start, msg, first);
+    memcpy(buf->data, msg + first, msg_size - first);
+    buf->data[(head + msg_size) % LogBuffer::kSize] = '\n';
+    buf->head.store(head + size, std::memory_order_release);
+  }
+  buf->appending = false;
+}
+
+void FlushTestLog() {
+  for (LogBuffer* b = buffers.load(); b != nullptr; b = b->next) {
+    while (!Drain(b)) {
+      sched_yield();
+    }
+  }
+}
+
 void CheckFailure(const char* cond, size_t cond_size, const char* msg,
                   size_t msg_size, int errno_value) {
+  // Write out pending messages first, as they likely lead to the failure. A
+  // buffer can be in the middle of being drained by the flushing thread, or
+  // by code interrupted by this call, so wait for it only briefly.
+  for (LogBuffer* b = buffers.load(); b != nullptr; b = b->next) {
+    for (int i = 0; i < 100 && !Drain(b); i++) {
+      sched_yield();
+    }
+  }
+
   constexpr char kCheckFailure[] = "Check failed: ";
   Write(2, kCheckFailure, sizeof(kCheckFailure) - 1);
   Write(2, cond, cond_size);
@@ -25,6 +25,29 @@ namespace testing {
 void CheckFailure(const char* cond, size_t cond_size, const char* msg,
                   size_t msg_size, int errno_value);
 
+// TestLog appends msg and a newline to a buffer owned by the calling thread,
+// which is written to stderr asynchronously by a flushing thread, so that
+// threads logging at a high rate don't contend on writes to stderr. Each
+// message is written in one piece, and messages from one thread are written
+// in order. Messages that don't fit in a full buffer are dropped, and the
+// number of dropped bytes is logged instead.
+//
+// The buffers are flushed by CheckFailure, at exit, and by FlushTestLog. In a
+// child forked after the flushing thread was started, or when called from a
+// signal handler that interrupted TestLog, messages are written to stderr
+// directly.
+//
+// TestLog is async-signal-safe, except for the first call in a process, which
+// starts the flushing thread, and the first call in each thread.
+void TestLog(const char* msg, size_t msg_size);
+
+// FlushTestLog writes the contents of all TestLog buffers to stderr, and
+// returns once all messages logged before the call have been written.
+void FlushTestLog();
+
+// Logs msg, which must be a string literal, with TestLog.
+#define TEST_LOG(msg) ::gvisor::testing::TestLog(msg, sizeof(msg) - 1)
+
 // If cond is false, aborts the current process.
 //
 // This macro is async-signal-safe.
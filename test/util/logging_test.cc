@@ -0,0 +1,107 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/util/logging.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(TestLogTest, FlushWritesAllThreadsInOrder) {
+  constexpr int kThreads = 8;
+  constexpr int kMessages = 500;
+
+  ::testing::internal::CaptureStderr();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < kMessages; i++) {
+        const std::string msg = absl::StrCat(t, " ", i);
+        TestLog(msg.data(), msg.size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  FlushTestLog();
+  const std::string output = ::testing::internal::GetCapturedStderr();
+
+  // Each thread's messages fit in its buffer, so none are dropped.
+  std::vector<int> next(kThreads, 0);
+  for (absl::string_view line : absl::StrSplit(output, '\n')) {
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields = absl::StrSplit(line, ' ');
+    ASSERT_EQ(fields.size(), 2) << line;
+    int t, i;
+    ASSERT_TRUE(absl::SimpleAtoi(fields[0], &t)) << line;
+    ASSERT_TRUE(absl::SimpleAtoi(fields[1], &i)) << line;
+    ASSERT_LT(t, kThreads);
+    EXPECT_EQ(i, next[t]);
+    next[t] = i + 1;
+  }
+  for (int t = 0; t < kThreads; t++) {
+    EXPECT_EQ(next[t], kMessages);
+  }
+}
+
+TEST(TestLogTest, MessageLargerThanBufferIsDropped) {
+  const std::string msg(1 << 20, 'a');
+
+  ::testing::internal::CaptureStderr();
+  TestLog(msg.data(), msg.size());
+  FlushTestLog();
+  const std::string output = ::testing::internal::GetCapturedStderr();
+
+  EXPECT_EQ(output, absl::StrCat(msg.size() + 1, " log bytes dropped\n"));
+}
+
+TEST(TestLogTest, CheckFailureFlushes) {
+  EXPECT_DEATH(
+      {
+        TEST_LOG("before failure");
+        TEST_CHECK(false);
+      },
+      "before failure\nCheck failed: false");
+}
+
+TEST(TestLogTest, MacroAppendsNewline) {
+  ::testing::internal::CaptureStderr();
+  TEST_LOG("hello");
+  TEST_LOG("world");
+  FlushTestLog();
+  EXPECT_THAT(::testing::internal::GetCapturedStderr(),
+              HasSubstr("hello\nworld\n"));
+}
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
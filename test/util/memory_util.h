@@ -19,6 +19,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 
@@ -132,6 +133,24 @@ inline PosixErrorOr<Mapping> MmapAnon(size_t length, int prot, int flags) {
   return Mmap(nullptr, length, prot, flags | MAP_ANONYMOUS, -1, 0);
 }
 
+// Maps the contents of the regular file fd read-only, so that they can be
+// viewed through Mapping::view() without copying. The size is taken from
+// fstat, so files that report a size of 0, such as those in procfs, map as
+// empty; read those with GetContentsFD instead.
+inline PosixErrorOr<Mapping> MmapContents(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    return PosixError(errno, "fstat");
+  }
+  if (!S_ISREG(st.st_mode)) {
+    return PosixError(EINVAL, "MmapContents requires a regular file");
+  }
+  if (st.st_size == 0) {
+    return Mapping();
+  }
+  return Mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+}
+
 // Wrapper for mremap that returns a PosixErrorOr<>, since the return type of
 // void* isn't directly compatible with SyscallSucceeds.
 inline PosixErrorOr<void*> Mremap(void* old_address, size_t old_size,
@@ -18,13 +18,14 @@
 #include <unistd.h>
 
 #include <cerrno>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "test/util/posix_error.h"
@@ -40,45 +41,26 @@ PosixErrorOr<std::vector<ProcMountsEntry>> ProcSelfMountsEntries() {
 
 PosixErrorOr<std::vector<ProcMountsEntry>> ProcSelfMountsEntriesFrom(
     const std::string& content) {
-  std::vector<ProcMountsEntry> entries;
-  std::vector<std::string> lines =
-      absl::StrSplit(content, absl::ByChar('\n'), absl::AllowEmpty());
-  std::cerr << "<contents of /proc/self/mounts>" << std::endl;
-  for (const std::string& line : lines) {
-    std::cerr << line << std::endl;
-    if (line.empty()) {
-      continue;
-    }
+  std::cerr << "<contents of /proc/self/mounts>" << std::endl
+            << content << "<end of /proc/self/mounts>" << std::endl;
 
-    // Parse a single entry from /proc/self/mounts.
-    //
-    // Example entries:
-    //
-    // sysfs /sys sysfs rw,nosuid,nodev,noexec,relatime 0 0
-    // proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0
-    //  ^     ^    ^                ^                  ^ ^
-    //  0     1    2                3                  4 5
-
-    ProcMountsEntry entry;
-    std::vector<std::string> fields =
-        absl::StrSplit(line, absl::ByChar(' '), absl::AllowEmpty());
-    if (fields.size() != 6) {
-      return PosixError(
-          EINVAL, absl::StrFormat("Not enough tokens, got %d, content: <<%s>>",
-                                  fields.size(), content));
+  std::vector<ProcMountsEntry> entries;
+  ProcMountsReader reader(content);
+  ProcMountsView view;
+  while (true) {
+    ASSIGN_OR_RETURN_ERRNO(bool ok, reader.Next(&view));
+    if (!ok) {
+      break;
     }
-
-    entry.spec = fields[0];
-    entry.mount_point = fields[1];
-    entry.fstype = fields[2];
-    entry.mount_opts = fields[3];
-    ASSIGN_OR_RETURN_ERRNO(entry.dump, Atoi<uint32_t>(fields[4]));
-    ASSIGN_OR_RETURN_ERRNO(entry.fsck, Atoi<uint32_t>(fields[5]));
-
-    entries.push_back(entry);
+    entries.push_back(ProcMountsEntry{
+        .spec = std::string(view.spec),
+        .mount_point = std::string(view.mount_point),
+        .fstype = std::string(view.fstype),
+        .mount_opts = std::string(view.mount_opts),
+        .dump = view.dump,
+        .fsck = view.fsck,
+    });
   }
-  std::cerr << "<end of /proc/self/mounts>" << std::endl;
-
   return entries;
 }
 
@@ -90,73 +72,167 @@ PosixErrorOr<std::vector<ProcMountInfoEntry>> ProcSelfMountInfoEntries() {
 
 PosixErrorOr<std::vector<ProcMountInfoEntry>> ProcSelfMountInfoEntriesFrom(
     const std::string& content) {
+  std::cerr << "<contents of /proc/self/mountinfo>" << std::endl
+            << content << "<end of /proc/self/mountinfo>" << std::endl;
+
   std::vector<ProcMountInfoEntry> entries;
-  std::vector<std::string> lines =
-      absl::StrSplit(content, absl::ByChar('\n'), absl::AllowEmpty());
-  std::cerr << "<contents of /proc/self/mountinfo>" << std::endl;
-  for (const std::string& line : lines) {
-    std::cerr << line << std::endl;
-    if (line.empty()) {
-      continue;
+  ProcMountInfoReader reader(content);
+  ProcMountInfoView view;
+  while (true) {
+    ASSIGN_OR_RETURN_ERRNO(bool ok, reader.Next(&view));
+    if (!ok) {
+      break;
     }
+    entries.push_back(ProcMountInfoEntry{
+        .id = view.id,
+        .parent_id = view.parent_id,
+        .major = view.major,
+        .minor = view.minor,
+        .root = std::string(view.root),
+        .mount_point = std::string(view.mount_point),
+        .mount_opts = std::string(view.mount_opts),
+        .optional = std::string(view.optional),
+        .fstype = std::string(view.fstype),
+        .mount_source = std::string(view.mount_source),
+        .super_opts = std::string(view.super_opts),
+    });
+  }
+  return entries;
+}
 
-    // Parse a single entry from /proc/self/mountinfo.
-    //
-    // Example entries:
-    //
-    // 22 28 0:20 / /sys rw,relatime shared:7 - sysfs sysfs rw
-    // 23 28 0:21 / /proc rw,relatime shared:14 - proc proc rw
-    // ^  ^    ^  ^   ^        ^         ^      ^  ^    ^   ^
-    // 0  1    2  3   4        5         6      7  8    9   10
-
-    ProcMountInfoEntry entry;
-    std::vector<std::string> fields =
-        absl::StrSplit(line, absl::ByChar(' '), absl::AllowEmpty());
-    if (fields.size() < 10 || fields.size() > 13) {
-      return PosixError(
-          EINVAL,
-          absl::StrFormat("Unexpected number of tokens, got %d, line: <<%s>>",
-                          fields.size(), line));
-    }
+namespace {
 
-    ASSIGN_OR_RETURN_ERRNO(entry.id, Atoi<uint64_t>(fields[0]));
-    ASSIGN_OR_RETURN_ERRNO(entry.parent_id, Atoi<uint64_t>(fields[1]));
+// NextLine removes the first non-empty line from *rest and stores it in
+// *line. It returns false if *rest has no more non-empty lines.
+bool NextLine(absl::string_view* rest, absl::string_view* line) {
+  while (!rest->empty()) {
+    const size_t end = rest->find('\n');
+    if (end == absl::string_view::npos) {
+      *line = *rest;
+      *rest = absl::string_view();
+    } else {
+      *line = rest->substr(0, end);
+      rest->remove_prefix(end + 1);
+    }
+    if (!line->empty()) {
+      return true;
+    }
+  }
+  return false;
+}
 
-    std::vector<std::string> devs =
-        absl::StrSplit(fields[2], absl::ByChar(':'));
-    if (devs.size() != 2) {
-      return PosixError(
-          EINVAL,
-          absl::StrFormat(
-              "Failed to parse dev number field %s: too many tokens, got %d",
-              fields[2], devs.size()));
+// SplitFields splits line on spaces, keeping empty fields, and stores the
+// first fields.size() fields in fields. It returns the number of fields in
+// line, which may be more than it stored.
+size_t SplitFields(absl::string_view line,
+                   absl::Span<absl::string_view> fields) {
+  size_t n = 0;
+  while (true) {
+    const size_t end = line.find(' ');
+    if (n < fields.size()) {
+      fields[n] = line.substr(0, end);
     }
-    ASSIGN_OR_RETURN_ERRNO(entry.major, Atoi<dev_t>(devs[0]));
-    ASSIGN_OR_RETURN_ERRNO(entry.minor, Atoi<dev_t>(devs[1]));
-
-    entry.root = fields[3];
-    entry.mount_point = fields[4];
-    entry.mount_opts = fields[5];
-
-    // The optional field (fields[6]) may or may not be present and can have up
-    // to 3 elements. We know based on the total number of tokens.
-    int off = -1;
-    if (fields.size() > 10) {
-      int num_optional_tags = fields.size() - 10;
-      entry.optional = absl::StrJoin(
-          absl::MakeSpan(fields).subspan(6, num_optional_tags), " ");
-      off += num_optional_tags;
+    n++;
+    if (end == absl::string_view::npos) {
+      return n;
     }
-    // Field 7 is the optional field terminator char '-'.
-    entry.fstype = fields[8 + off];
-    entry.mount_source = fields[9 + off];
-    entry.super_opts = fields[10 + off];
+    line.remove_prefix(end + 1);
+  }
+}
+
+}  // namespace
 
-    entries.push_back(entry);
+PosixErrorOr<bool> ProcMountsReader::Next(ProcMountsView* entry) {
+  absl::string_view line;
+  if (!NextLine(&rest_, &line)) {
+    return false;
   }
-  std::cerr << "<end of /proc/self/mountinfo>" << std::endl;
 
-  return entries;
+  // Parse a single entry from /proc/self/mounts.
+  //
+  // Example entries:
+  //
+  // sysfs /sys sysfs rw,nosuid,nodev,noexec,relatime 0 0
+  // proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0
+  //  ^     ^    ^                ^                  ^ ^
+  //  0     1    2                3                  4 5
+  absl::string_view fields[6];
+  const size_t n = SplitFields(line, absl::MakeSpan(fields));
+  if (n != 6) {
+    return PosixError(
+        EINVAL,
+        absl::StrFormat("Unexpected number of tokens, got %d, line: <<%s>>", n,
+                        line));
+  }
+
+  entry->spec = fields[0];
+  entry->mount_point = fields[1];
+  entry->fstype = fields[2];
+  entry->mount_opts = fields[3];
+  ASSIGN_OR_RETURN_ERRNO(entry->dump, Atoi<uint32_t>(fields[4]));
+  ASSIGN_OR_RETURN_ERRNO(entry->fsck, Atoi<uint32_t>(fields[5]));
+  return true;
+}
+
+PosixErrorOr<bool> ProcMountInfoReader::Next(ProcMountInfoView* entry) {
+  absl::string_view line;
+  if (!NextLine(&rest_, &line)) {
+    return false;
+  }
+
+  // Parse a single entry from /proc/self/mountinfo.
+  //
+  // Example entries:
+  //
+  // 22 28 0:20 / /sys rw,relatime shared:7 - sysfs sysfs rw
+  // 23 28 0:21 / /proc rw,relatime shared:14 - proc proc rw
+  // ^  ^    ^  ^   ^        ^         ^      ^  ^    ^   ^
+  // 0  1    2  3   4        5         6      7  8    9   10
+  absl::string_view fields[13];
+  const size_t n = SplitFields(line, absl::MakeSpan(fields));
+  if (n < 10 || n > 13) {
+    return PosixError(
+        EINVAL,
+        absl::StrFormat("Unexpected number of tokens, got %d, line: <<%s>>", n,
+                        line));
+  }
+
+  ASSIGN_OR_RETURN_ERRNO(entry->id, Atoi<uint64_t>(fields[0]));
+  ASSIGN_OR_RETURN_ERRNO(entry->parent_id, Atoi<uint64_t>(fields[1]));
+
+  const size_t colon = fields[2].find(':');
+  if (colon == absl::string_view::npos ||
+      fields[2].find(':', colon + 1) != absl::string_view::npos) {
+    return PosixError(
+        EINVAL, absl::StrFormat("Failed to parse dev number field %s",
+                                fields[2]));
+  }
+  ASSIGN_OR_RETURN_ERRNO(entry->major,
+                         Atoi<dev_t>(fields[2].substr(0, colon)));
+  ASSIGN_OR_RETURN_ERRNO(entry->minor,
+                         Atoi<dev_t>(fields[2].substr(colon + 1)));
+
+  entry->root = fields[3];
+  entry->mount_point = fields[4];
+  entry->mount_opts = fields[5];
+
+  // The optional field (fields[6]) may or may not be present and can have up
+  // to 3 elements. We know based on the total number of tokens. The elements
+  // are adjacent in line, so they are returned as one view.
+  int off = -1;
+  entry->optional = absl::string_view();
+  if (n > 10) {
+    const int num_optional_tags = n - 10;
+    const absl::string_view& last = fields[5 + num_optional_tags];
+    entry->optional = absl::string_view(
+        fields[6].data(), last.data() + last.size() - fields[6].data());
+    off += num_optional_tags;
+  }
+  // Field 7 is the optional field terminator char '-'.
+  entry->fstype = fields[8 + off];
+  entry->mount_source = fields[9 + off];
+  entry->super_opts = fields[10 + off];
+  return true;
 }
 
 absl::flat_hash_map<std::string, std::string> ParseMountOptions(
@@ -183,27 +259,50 @@ absl::flat_hash_map<std::string, std::string> ParseMountOptions(
   return entries;
 }
 
+std::optional<absl::string_view> FindMountOption(absl::string_view mopts,
+                                                 absl::string_view key) {
+  while (true) {
+    const size_t end = mopts.find(',');
+    const absl::string_view token = mopts.substr(0, end);
+    if (absl::StartsWith(token, key)) {
+      if (token.size() == key.size()) {
+        return absl::string_view();
+      }
+      if (token[key.size()] == '=') {
+        return token.substr(key.size() + 1);
+      }
+    }
+    if (end == absl::string_view::npos) {
+      return std::nullopt;
+    }
+    mopts.remove_prefix(end + 1);
+  }
+}
+
 PosixErrorOr<absl::flat_hash_map<std::string, std::vector<MountOptional>>>
 MountOptionals() {
   absl::flat_hash_map<std::string, std::vector<MountOptional>> optionals;
-  ASSIGN_OR_RETURN_ERRNO(std::vector<ProcMountInfoEntry> mounts,
-                         ProcSelfMountInfoEntries());
-  for (const auto& e : mounts) {
+  std::string content;
+  RETURN_IF_ERRNO(GetContents("/proc/self/mountinfo", &content));
+  ProcMountInfoReader reader(content);
+  ProcMountInfoView e;
+  while (true) {
+    ASSIGN_OR_RETURN_ERRNO(bool ok, reader.Next(&e));
+    if (!ok) {
+      break;
+    }
     MountOptional opt;
     opt.shared = 0;
     opt.master = 0;
     opt.propagate_from = 0;
-    std::vector<std::string_view> tags = absl::StrSplit(e.optional, ' ');
+    std::vector<absl::string_view> tags = absl::StrSplit(e.optional, ' ');
 
-    for (std::string_view tag : tags) {
-      PosixError err = ParseOptionalTag(tag, &opt);
+    for (absl::string_view tag : tags) {
+      PosixError err =
+          ParseOptionalTag(std::string_view(tag.data(), tag.size()), &opt);
       if (!err.ok()) return err;
     }
-    if (optionals.contains(e.mount_point)) {
-      optionals[e.mount_point].push_back(opt);
-    } else {
-      optionals[e.mount_point] = {opt};
-    }
+    optionals[std::string(e.mount_point)].push_back(opt);
   }
   return optionals;
 }
@@ -19,12 +19,14 @@
 #include <sys/mount.h>
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "test/util/cleanup.h"
 #include "test/util/posix_error.h"
 #include "test/util/test_util.h"
@@ -88,6 +90,70 @@ PosixErrorOr<std::vector<ProcMountInfoEntry>> ProcSelfMountInfoEntries();
 PosixErrorOr<std::vector<ProcMountInfoEntry>> ProcSelfMountInfoEntriesFrom(
     const std::string&);
 
+// ProcMountsView and ProcMountInfoView are like ProcMountsEntry and
+// ProcMountInfoEntry, but their fields refer to the content they were parsed
+// from, which must outlive them.
+struct ProcMountsView {
+  absl::string_view spec;
+  absl::string_view mount_point;
+  absl::string_view fstype;
+  absl::string_view mount_opts;
+  uint32_t dump;
+  uint32_t fsck;
+};
+
+struct ProcMountInfoView {
+  uint64_t id;
+  uint64_t parent_id;
+  dev_t major;
+  dev_t minor;
+  absl::string_view root;
+  absl::string_view mount_point;
+  absl::string_view mount_opts;
+  absl::string_view optional;
+  absl::string_view fstype;
+  absl::string_view mount_source;
+  absl::string_view super_opts;
+};
+
+// ProcMountsReader and ProcMountInfoReader parse the content of
+// /proc/[pid]/mounts and /proc/[pid]/mountinfo one entry at a time, without
+// copying fields or logging the content, for callers that scan large mount
+// tables. Mount options can be looked up with FindMountOption.
+//
+// Usage:
+//
+//   std::string content;
+//   ASSERT_NO_ERRNO(GetContents("/proc/self/mountinfo", &content));
+//   ProcMountInfoReader reader(content);
+//   ProcMountInfoView e;
+//   while (ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e))) {
+//     ...
+//   }
+class ProcMountsReader {
+ public:
+  explicit ProcMountsReader(absl::string_view content) : rest_(content) {}
+
+  // Next parses the next entry into *entry and returns true, or returns false
+  // if there are no more entries.
+  PosixErrorOr<bool> Next(ProcMountsView* entry);
+
+ private:
+  absl::string_view rest_;
+};
+
+class ProcMountInfoReader {
+ public:
+  explicit ProcMountInfoReader(absl::string_view content) : rest_(content) {}
+
+  // Next parses the next entry into *entry and returns true, or returns false
+  // if there are no more entries.
+  PosixErrorOr<bool> Next(ProcMountInfoView* entry);
+
+ private:
+  absl::string_view rest_;
+};
+
 // Interprets the input string mopts as a comma separated list of mount
 // options. A mount option can either be just a value, or a key=value pair. For
 // example, the string "rw,relatime,fd=7" will be parsed into a map like { "rw":
@@ -95,6 +161,13 @@ PosixErrorOr<std::vector<ProcMountInfoEntry>> ProcSelfMountInfoEntriesFrom(
 absl::flat_hash_map<std::string, std::string> ParseMountOptions(
     std::string mopts);
 
+// FindMountOption returns the value of the option key in the comma separated
+// list mopts, which is empty for an option without a value, or std::nullopt
+// if mopts doesn't contain key. Unlike ParseMountOptions, it only decodes
+// options up to key.
+std::optional<absl::string_view> FindMountOption(absl::string_view mopts,
+                                                 absl::string_view key);
+
 struct MountOptional {
   int shared;
   int master;
@@ -14,8 +14,11 @@
 
 #include "test/util/mount_util.h"
 
+#include <optional>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "test/util/posix_error.h"
 #include "test/util/test_util.h"
 
 namespace gvisor {
@@ -48,6 +51,77 @@ TEST(ParseMounts, MountInfo) {
   EXPECT_EQ(entries.size(), 3);
 }
 
+TEST(ParseMounts, MountsReader) {
+  ProcMountsReader reader(
+      R"proc(sysfs /sys sysfs rw,nosuid,nodev,noexec,relatime 0 0
+
+ /mnt tmpfs rw,noexec 0 1)proc");
+  ProcMountsView e;
+  ASSERT_TRUE(ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e)));
+  EXPECT_EQ(e.spec, "sysfs");
+  EXPECT_EQ(e.mount_point, "/sys");
+  EXPECT_EQ(e.fstype, "sysfs");
+  EXPECT_EQ(e.mount_opts, "rw,nosuid,nodev,noexec,relatime");
+  ASSERT_TRUE(ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e)));
+  EXPECT_EQ(e.spec, "");
+  EXPECT_EQ(e.mount_point, "/mnt");
+  EXPECT_EQ(e.dump, 0);
+  EXPECT_EQ(e.fsck, 1);
+  EXPECT_FALSE(ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e)));
+}
+
+TEST(ParseMounts, MountsReaderInvalid) {
+  ProcMountsReader reader("sysfs /sys sysfs rw 0\n");
+  ProcMountsView e;
+  EXPECT_THAT(reader.Next(&e), PosixErrorIs(EINVAL, ::testing::_));
+}
+
+TEST(ParseMounts, MountInfoReader) {
+  ProcMountInfoReader reader(
+      R"proc(23 28 0:21 / /proc rw,relatime shared:14 master:20 - proc proc rw
+2007 8844 0:278 / /mnt rw,noexec - tmpfs  rw,mode=123
+)proc");
+  ProcMountInfoView e;
+  ASSERT_TRUE(ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e)));
+  EXPECT_EQ(e.id, 23);
+  EXPECT_EQ(e.parent_id, 28);
+  EXPECT_EQ(e.major, 0);
+  EXPECT_EQ(e.minor, 21);
+  EXPECT_EQ(e.root, "/");
+  EXPECT_EQ(e.mount_point, "/proc");
+  EXPECT_EQ(e.mount_opts, "rw,relatime");
+  EXPECT_EQ(e.optional, "shared:14 master:20");
+  EXPECT_EQ(e.fstype, "proc");
+  EXPECT_EQ(e.mount_source, "proc");
+  EXPECT_EQ(e.super_opts, "rw");
+  ASSERT_TRUE(ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e)));
+  EXPECT_EQ(e.id, 2007);
+  EXPECT_EQ(e.optional, "");
+  EXPECT_EQ(e.fstype, "tmpfs");
+  EXPECT_EQ(e.mount_source, "");
+  EXPECT_EQ(e.super_opts, "rw,mode=123");
+  EXPECT_FALSE(ASSERT_NO_ERRNO_AND_VALUE(reader.Next(&e)));
+}
+
+TEST(ParseMounts, MountInfoReaderInvalid) {
+  ProcMountInfoView e;
+  ProcMountInfoReader too_few("22 28 0:20 / /sys rw - sysfs\n");
+  EXPECT_THAT(too_few.Next(&e), PosixErrorIs(EINVAL, ::testing::_));
+  ProcMountInfoReader bad_dev("22 28 0:20:1 / /sys rw - sysfs sysfs rw\n");
+  EXPECT_THAT(bad_dev.Next(&e), PosixErrorIs(EINVAL, ::testing::_));
+}
+
+TEST(ParseMounts, FindMountOption) {
+  constexpr char kOpts[] = "rw,mode=123,uid=0,modest";
+  EXPECT_EQ(FindMountOption(kOpts, "rw"), "");
+  EXPECT_EQ(FindMountOption(kOpts, "mode"), "123");
+  EXPECT_EQ(FindMountOption(kOpts, "uid"), "0");
+  EXPECT_EQ(FindMountOption(kOpts, "modest"), "");
+  EXPECT_EQ(FindMountOption(kOpts, "mod"), std::nullopt);
+  EXPECT_EQ(FindMountOption(kOpts, "gid"), std::nullopt);
+  EXPECT_EQ(FindMountOption("", "rw"), std::nullopt);
+}
+
 }  // namespace
 
 }  // namespace testing
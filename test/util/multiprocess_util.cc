@@ -20,14 +20,22 @@
 #include <signal.h>
 #include <sys/prctl.h>
 #include <sys/socket.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "test/util/cleanup.h"
 #include "test/util/file_descriptor.h"
 #include "test/util/logging.h"
@@ -57,11 +65,17 @@ PosixErrorOr<Cleanup> ForkAndExecHelper(const std::function<void()>& exec_fn,
     return PosixError(errno, "dup stdout");
   }
   int parent_stderr = dup(STDERR_FILENO);
-  if (parent_stdout < 0) {
+  if (parent_stderr < 0) {
+    close(parent_stdout);
     return PosixError(errno, "dup stderr");
   }
 
   pid_t pid = fork();
+  if (pid != 0) {
+    // The copies are only needed by the child.
+    close(parent_stdout);
+    close(parent_stderr);
+  }
   if (pid < 0) {
     return PosixError(errno, "fork failed");
   } else if (pid == 0) {
@@ -179,6 +193,204 @@ PosixErrorOr<int> InForkedProcess(const std::function<void()>& fn) {
   return status;
 }
 
+namespace {
+
+// ForkedProcessPool request header, followed by size bytes of argument.
+struct PoolRequest {
+  uint32_t index;
+  uint32_t size;
+  uint32_t isolated;
+};
+
+// Reads exactly n bytes from fd, returning false on EOF or error. It is
+// async-signal-safe.
+bool ReadAll(int fd, void* buf, size_t n) {
+  char* p = static_cast<char*>(buf);
+  while (n > 0) {
+    ssize_t ret = read(fd, p, n);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    p += ret;
+    n -= ret;
+  }
+  return true;
+}
+
+// Writes exactly n bytes to the socket fd, returning false on error. It is
+// async-signal-safe, and does not raise SIGPIPE if the peer has exited.
+bool SendAll(int fd, const void* buf, size_t n) {
+  const char* p = static_cast<const char*>(buf);
+  while (n > 0) {
+    ssize_t ret = send(fd, p, n, MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      return false;
+    }
+    p += ret;
+    n -= ret;
+  }
+  return true;
+}
+
+}  // namespace
+
+constexpr size_t ForkedProcessPool::kMaxArgSize;
+
+ForkedProcessPool::ForkedProcessPool(std::vector<Fn> fns)
+    : fns_(std::move(fns)), arg_buf_(kMaxArgSize) {}
+
+PosixErrorOr<std::unique_ptr<ForkedProcessPool>> ForkedProcessPool::Create(
+    int size, std::vector<Fn> fns) {
+  if (size <= 0) {
+    return PosixError(EINVAL, "ForkedProcessPool needs at least one helper");
+  }
+  std::unique_ptr<ForkedProcessPool> pool(
+      new ForkedProcessPool(std::move(fns)));
+  absl::MutexLock l(&pool->mu_);
+  pool->helpers_.resize(size);
+  for (Helper& h : pool->helpers_) {
+    RETURN_IF_ERRNO(pool->Spawn(&h));
+  }
+  return pool;
+}
+
+ForkedProcessPool::~ForkedProcessPool() {
+  absl::MutexLock l(&mu_);
+  for (Helper& h : helpers_) {
+    if (h.pid > 0) {
+      kill(h.pid, SIGKILL);
+      RetryEINTR(waitpid)(h.pid, nullptr, 0);
+    }
+    if (h.fd >= 0) {
+      close(h.fd);
+    }
+  }
+}
+
+PosixErrorOr<int> ForkedProcessPool::Run(size_t index, absl::string_view arg) {
+  return Dispatch(index, arg, /*isolated=*/false);
+}
+
+PosixErrorOr<int> ForkedProcessPool::RunIsolated(size_t index,
+                                                 absl::string_view arg) {
+  return Dispatch(index, arg, /*isolated=*/true);
+}
+
+bool ForkedProcessPool::HasIdleHelper() const {
+  return std::any_of(helpers_.begin(), helpers_.end(),
+                     [](const Helper& h) { return !h.busy; });
+}
+
+PosixErrorOr<int> ForkedProcessPool::Dispatch(size_t index,
+                                              absl::string_view arg,
+                                              bool isolated) {
+  if (index >= fns_.size()) {
+    return PosixError(EINVAL, absl::StrCat("no function ", index));
+  }
+  if (arg.size() > kMaxArgSize) {
+    return PosixError(EINVAL, absl::StrCat("argument of ", arg.size(),
+                                           " bytes exceeds kMaxArgSize"));
+  }
+
+  // Helpers are never added or removed after Create, so h remains valid.
+  Helper* h;
+  int fd;
+  {
+    absl::MutexLock l(&mu_);
+    mu_.Await(absl::Condition(this, &ForkedProcessPool::HasIdleHelper));
+    h = &*std::find_if(helpers_.begin(), helpers_.end(),
+                       [](const Helper& h) { return !h.busy; });
+    h->busy = true;
+    fd = h->fd;
+  }
+
+  PoolRequest req = {static_cast<uint32_t>(index),
+                     static_cast<uint32_t>(arg.size()), isolated};
+  int32_t status;
+  bool ok = SendAll(fd, &req, sizeof(req)) &&
+            SendAll(fd, arg.data(), arg.size()) &&
+            ReadAll(fd, &status, sizeof(status));
+
+  absl::MutexLock l(&mu_);
+  h->busy = false;
+  if (ok) {
+    return status;
+  }
+  // The helper exited, either as requested or because the function did.
+  ASSIGN_OR_RETURN_ERRNO(status, Reap(h));
+  RETURN_IF_ERRNO(Spawn(h));
+  return status;
+}
+
+PosixError ForkedProcessPool::Spawn(Helper* h) {
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) {
+    return PosixError(errno, "socketpair failed");
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Close the pool's end of every other helper's socket, so that each
+    // helper sees EOF as soon as the pool closes it.
+    close(sv[0]);
+    for (const Helper& other : helpers_) {
+      if (other.fd >= 0) {
+        close(other.fd);
+      }
+    }
+    Serve(sv[1]);
+  }
+  MaybeSave();
+  close(sv[1]);
+  if (pid < 0) {
+    close(sv[0]);
+    return PosixError(errno, "fork failed");
+  }
+  h->pid = pid;
+  h->fd = sv[0];
+  return NoError();
+}
+
+PosixErrorOr<int> ForkedProcessPool::Reap(Helper* h) {
+  close(h->fd);
+  h->fd = -1;
+  int status;
+  pid_t pid = h->pid;
+  h->pid = -1;
+  if (RetryEINTR(waitpid)(pid, &status, 0) < 0) {
+    return PosixError(errno, "waitpid failed");
+  }
+  return status;
+}
+
+void ForkedProcessPool::Serve(int fd) {
+  while (true) {
+    PoolRequest req;
+    if (!ReadAll(fd, &req, sizeof(req))) {
+      // The pool has been destroyed.
+      _exit(0);
+    }
+    TEST_CHECK(req.index < fns_.size() && req.size <= kMaxArgSize);
+    TEST_CHECK(ReadAll(fd, arg_buf_.data(), req.size));
+    fns_[req.index](absl::string_view(arg_buf_.data(), req.size));
+    TEST_CHECK_MSG(!::testing::Test::HasFailure(),
+                   "EXPECT*/ASSERT* failed. These are not async-signal-safe "
+                   "and must not be called from fn.");
+    if (req.isolated) {
+      _exit(0);
+    }
+    const int32_t status = 0;
+    if (!SendAll(fd, &status, sizeof(status))) {
+      _exit(0);
+    }
+  }
+}
+
 PosixErrorOr<int> InForkedUserMountNamespace(
     const std::function<void()>& parent, const std::function<void()>& child) {
   std::string umap_str = absl::StrFormat("0 %lu 1", geteuid());
@@ -19,11 +19,14 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "test/util/cleanup.h"
 #include "test/util/posix_error.h"
 
@@ -128,6 +131,82 @@ inline PosixErrorOr<Cleanup> ForkAndExecveat(int32_t dirfd,
 // Use TEST_CHECK variants instead.
 PosixErrorOr<int> InForkedProcess(const std::function<void()>& fn);
 
+// ForkedProcessPool runs functions in a set of pre-forked helper processes, to
+// amortize the cost of fork across many calls that would otherwise each use
+// InForkedProcess.
+//
+// Functions cannot be sent to another process, so the pool is created with
+// every function it can run, before the helpers are forked. Each call picks a
+// function by index and passes it an argument of up to kMaxArgSize bytes,
+// which the caller serializes. The same restrictions as InForkedProcess apply:
+// functions must be async-signal-safe, and use TEST_CHECK rather than
+// ASSERT/EXPECT.
+//
+// A helper runs many calls in turn, so state changed by one call (such as
+// credentials or namespaces) is seen by later calls to the same helper. Use
+// RunIsolated for calls that must not share state; the helper exits after the
+// call and is replaced.
+//
+// Run and RunIsolated may be called concurrently from multiple threads, up to
+// the number of helpers.
+class ForkedProcessPool {
+ public:
+  using Fn = std::function<void(absl::string_view arg)>;
+
+  static constexpr size_t kMaxArgSize = 4096;
+
+  // Forks size helpers, each of which can run any of fns.
+  static PosixErrorOr<std::unique_ptr<ForkedProcessPool>> Create(
+      int size, std::vector<Fn> fns);
+
+  // Kills and reaps all helpers.
+  ~ForkedProcessPool();
+
+  ForkedProcessPool(const ForkedProcessPool&) = delete;
+  ForkedProcessPool& operator=(const ForkedProcessPool&) = delete;
+
+  // Calls fns[index](arg) in a helper. Returns 0 if it returns normally, and
+  // otherwise the helper's wait status, as InForkedProcess does. A helper that
+  // exits is replaced.
+  PosixErrorOr<int> Run(size_t index, absl::string_view arg = "");
+
+  // Like Run, but the helper exits after the call and is replaced.
+  PosixErrorOr<int> RunIsolated(size_t index, absl::string_view arg = "");
+
+ private:
+  struct Helper {
+    pid_t pid = -1;
+    // The pool's end of a socket pair connected to the helper.
+    int fd = -1;
+    bool busy = false;
+  };
+
+  explicit ForkedProcessPool(std::vector<Fn> fns);
+
+  PosixErrorOr<int> Dispatch(size_t index, absl::string_view arg,
+                             bool isolated);
+
+  // Forks a helper into h.
+  PosixError Spawn(Helper* h) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reaps h's exited process and returns its wait status.
+  PosixErrorOr<int> Reap(Helper* h) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // The loop run by a helper process. Never returns.
+  [[noreturn]] void Serve(int fd);
+
+  bool HasIdleHelper() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::vector<Fn> fns_;
+
+  // The helper's copy of this buffer receives arguments, so that it need not
+  // allocate.
+  std::vector<char> arg_buf_;
+
+  absl::Mutex mu_;
+  std::vector<Helper> helpers_ ABSL_GUARDED_BY(mu_);
+};
+
 // Sets up a new user and mount namespace in a forked subprocess using unshare,
 // then runs the parent function in the parent subprocess. Once that returns, it
 // runs the child function in the child process and returns the exit status of
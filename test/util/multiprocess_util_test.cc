@@ -0,0 +1,138 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "test/util/multiprocess_util.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+// Helper-side state shared between calls to the same helper.
+int counter = 0;
+
+enum PoolFn {
+  kNop,
+  kIncrement,
+  kCheckCounter,
+  kExit,
+  kCheckArg,
+};
+
+PosixErrorOr<std::unique_ptr<ForkedProcessPool>> NewPool(int size) {
+  std::vector<ForkedProcessPool::Fn> fns = {
+      [](absl::string_view) {},
+      [](absl::string_view) { counter++; },
+      [](absl::string_view arg) {
+        TEST_CHECK(counter == arg[0] - '0');
+      },
+      [](absl::string_view arg) { _exit(arg[0] - '0'); },
+      [](absl::string_view arg) {
+        TEST_CHECK(arg.size() == ForkedProcessPool::kMaxArgSize);
+        for (char c : arg) {
+          TEST_CHECK(c == 'x');
+        }
+      },
+  };
+  return ForkedProcessPool::Create(size, std::move(fns));
+}
+
+TEST(ForkedProcessPoolTest, Nop) {
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(1));
+  for (int i = 0; i < 100; i++) {
+    EXPECT_THAT(pool->Run(kNop), IsPosixErrorOkAndHolds(0));
+  }
+}
+
+TEST(ForkedProcessPoolTest, StatePersists) {
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(1));
+  EXPECT_THAT(pool->Run(kIncrement), IsPosixErrorOkAndHolds(0));
+  EXPECT_THAT(pool->Run(kIncrement), IsPosixErrorOkAndHolds(0));
+  EXPECT_THAT(pool->Run(kCheckCounter, "2"), IsPosixErrorOkAndHolds(0));
+  // The parent's state is unaffected.
+  EXPECT_EQ(counter, 0);
+}
+
+TEST(ForkedProcessPoolTest, RunIsolated) {
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(1));
+  EXPECT_THAT(pool->RunIsolated(kIncrement), IsPosixErrorOkAndHolds(0));
+  EXPECT_THAT(pool->Run(kCheckCounter, "0"), IsPosixErrorOkAndHolds(0));
+}
+
+TEST(ForkedProcessPoolTest, ExitStatus) {
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(1));
+  EXPECT_THAT(pool->Run(kIncrement), IsPosixErrorOkAndHolds(0));
+  auto status = pool->Run(kExit, "3");
+  ASSERT_NO_ERRNO(status);
+  EXPECT_TRUE(WIFEXITED(status.ValueOrDie()));
+  EXPECT_EQ(WEXITSTATUS(status.ValueOrDie()), 3);
+  // The replacement helper starts from the parent's state.
+  EXPECT_THAT(pool->Run(kCheckCounter, "0"), IsPosixErrorOkAndHolds(0));
+}
+
+TEST(ForkedProcessPoolTest, CheckFailure) {
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(1));
+  auto status = pool->Run(kCheckCounter, "1");
+  ASSERT_NO_ERRNO(status);
+  EXPECT_NE(status.ValueOrDie(), 0);
+  EXPECT_THAT(pool->Run(kNop), IsPosixErrorOkAndHolds(0));
+}
+
+TEST(ForkedProcessPoolTest, Arg) {
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(1));
+  std::string arg(ForkedProcessPool::kMaxArgSize, 'x');
+  EXPECT_THAT(pool->Run(kCheckArg, arg), IsPosixErrorOkAndHolds(0));
+  arg.push_back('x');
+  EXPECT_THAT(pool->Run(kCheckArg, arg), PosixErrorIs(EINVAL));
+  EXPECT_THAT(pool->Run(kCheckArg + 1), PosixErrorIs(EINVAL));
+}
+
+TEST(ForkedProcessPoolTest, Concurrent) {
+  constexpr int kThreads = 8;
+  auto pool = ASSERT_NO_ERRNO_AND_VALUE(NewPool(kThreads / 2));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([&pool, i] {
+      for (int j = 0; j < 50; j++) {
+        if (j % 10 == i % 10) {
+          EXPECT_THAT(pool->RunIsolated(kIncrement),
+                      IsPosixErrorOkAndHolds(0));
+        } else {
+          EXPECT_THAT(pool->Run(kNop), IsPosixErrorOkAndHolds(0));
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
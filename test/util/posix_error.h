@@ -15,6 +15,7 @@
 #ifndef GVISOR_TEST_UTIL_POSIX_ERROR_H_
 #define GVISOR_TEST_UTIL_POSIX_ERROR_H_
 
+#include <cstring>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -27,22 +28,37 @@ namespace gvisor {
 namespace testing {
 
 // PosixError must be async-signal-safe.
+//
+// Successful calls return a PosixError (or a PosixErrorOr, which copies its
+// PosixError on error()) on every call, so construction and copying only touch
+// the used part of the message buffer.
 class ABSL_MUST_USE_RESULT PosixError {
  public:
-  PosixError() {}
+  PosixError() { msg_[0] = '\0'; }
 
-  explicit PosixError(int errno_value) : errno_(errno_value) {}
+  explicit PosixError(int errno_value) : errno_(errno_value) {
+    msg_[0] = '\0';
+  }
 
-  PosixError(int errno_value, std::string_view msg) : errno_(errno_value) {
+  PosixError(int errno_value, std::string_view msg)
+      : errno_(errno_value), msg_len_(msg.size()) {
     // Check that `msg` will fit, leaving room for '\0' at the end.
     TEST_CHECK(msg.size() < sizeof(msg_));
     msg.copy(msg_, msg.size());
+    msg_[msg_len_] = '\0';
   }
 
-  PosixError(PosixError&& other) = default;
-  PosixError& operator=(PosixError&& other) = default;
-  PosixError(const PosixError&) = default;
-  PosixError& operator=(const PosixError&) = default;
+  PosixError(const PosixError& other) { *this = other; }
+  PosixError(PosixError&& other) { *this = other; }
+  PosixError& operator=(PosixError&& other) { return *this = other; }
+  PosixError& operator=(const PosixError& other) {
+    if (this != &other) {
+      errno_ = other.errno_;
+      msg_len_ = other.msg_len_;
+      memcpy(msg_, other.msg_, msg_len_ + 1);
+    }
+    return *this;
+  }
 
   bool ok() const { return errno_ == 0; }
 
@@ -64,8 +80,11 @@ class ABSL_MUST_USE_RESULT PosixError {
 
  private:
   int errno_ = 0;
+  // Length of msg_, excluding the terminating '\0'. Bytes after it are
+  // uninitialized.
+  size_t msg_len_ = 0;
   // std::string is not async-signal-safe. We must use a c string instead.
-  char msg_[1024] = {};
+  char msg_[1024];
 };
 
 template <typename T>
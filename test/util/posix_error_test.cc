@@ -40,6 +40,22 @@ TEST(PosixErrorTest, PosixErrorOrNullptr) {
   EXPECT_NO_ERRNO(err);
 }
 
+TEST(PosixErrorTest, CopyMessage) {
+  PosixError err(EINVAL, "some message");
+  PosixError copy = err;
+  EXPECT_THAT(copy, PosixErrorIs(EINVAL, "some message"));
+
+  // Assigning over a longer message must not leave any of it behind.
+  PosixError shorter(ENOENT, "short");
+  copy = shorter;
+  EXPECT_THAT(copy, PosixErrorIs(ENOENT, "short"));
+  copy = NoError();
+  EXPECT_THAT(copy, PosixErrorIs(0, ""));
+
+  auto err_or = PosixErrorOr<int>(err);
+  EXPECT_THAT(err_or.error(), PosixErrorIs(EINVAL, "some message"));
+}
+
 }  // namespace
 
 }  // namespace testing
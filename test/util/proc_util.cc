@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/macros.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -94,7 +95,6 @@ PosixErrorOr<std::vector<ProcMapsEntry>> ParseProcMaps(
   std::vector<ProcMapsEntry> entries;
   auto lines = absl::StrSplit(contents, '\n', absl::SkipEmpty());
   for (const auto& l : lines) {
-    std::cout << "line: " << l << std::endl;
     ASSIGN_OR_RETURN_ERRNO(auto entry, ParseProcMapsLine(l));
     entries.push_back(entry);
   }
@@ -308,6 +308,229 @@ PosixErrorOr<std::vector<ProcSmapsEntry>> ParseProcSmaps(
   return entries;
 }
 
+namespace {
+
+// Consumes the next line from contents into *line, returning false at the end
+// of contents.
+bool NextLine(absl::string_view* contents, absl::string_view* line) {
+  if (contents->empty()) {
+    return false;
+  }
+  size_t nl = contents->find('\n');
+  if (nl == absl::string_view::npos) {
+    *line = *contents;
+    contents->remove_prefix(contents->size());
+  } else {
+    *line = contents->substr(0, nl);
+    contents->remove_prefix(nl + 1);
+  }
+  return true;
+}
+
+void SkipSpaces(absl::string_view* s) {
+  while (!s->empty() && s->front() == ' ') {
+    s->remove_prefix(1);
+  }
+}
+
+bool ConsumeChar(absl::string_view* s, char c) {
+  if (s->empty() || s->front() != c) {
+    return false;
+  }
+  s->remove_prefix(1);
+  return true;
+}
+
+// Consumes a non-empty run of digits in the given base, which must be 10 or
+// 16, from the front of s.
+bool ConsumeNumber(absl::string_view* s, int base, uint64_t* value) {
+  uint64_t v = 0;
+  size_t i = 0;
+  for (; i < s->size(); i++) {
+    const char c = (*s)[i];
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (base == 16 && c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (base == 16 && c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      break;
+    }
+    v = v * base + digit;
+  }
+  if (i == 0) {
+    return false;
+  }
+  s->remove_prefix(i);
+  *value = v;
+  return true;
+}
+
+// Parses a single line from /proc/<xxx>/maps into *entry, returning false if
+// line is not one.
+bool ParseProcMapsView(absl::string_view line, ProcMapsView* entry) {
+  uint64_t major, minor, inode;
+  if (!ConsumeNumber(&line, 16, &entry->start) || !ConsumeChar(&line, '-') ||
+      !ConsumeNumber(&line, 16, &entry->end)) {
+    return false;
+  }
+  SkipSpaces(&line);
+  if (line.size() < 5 || line[4] != ' ') {
+    return false;
+  }
+  entry->readable = line[0] == 'r';
+  entry->writable = line[1] == 'w';
+  entry->executable = line[2] == 'x';
+  entry->priv = line[3] == 'p';
+  line.remove_prefix(4);
+  SkipSpaces(&line);
+  if (!ConsumeNumber(&line, 16, &entry->offset)) {
+    return false;
+  }
+  SkipSpaces(&line);
+  if (!ConsumeNumber(&line, 16, &major) || !ConsumeChar(&line, ':') ||
+      !ConsumeNumber(&line, 16, &minor)) {
+    return false;
+  }
+  SkipSpaces(&line);
+  if (!ConsumeNumber(&line, 10, &inode) ||
+      (!line.empty() && line.front() != ' ')) {
+    return false;
+  }
+  SkipSpaces(&line);
+  entry->major = major;
+  entry->minor = minor;
+  entry->inode = inode;
+  entry->filename = line;
+  return true;
+}
+
+// kSmapsFields are the fields of ProcSmapsView filled from "<key>: <n> kB"
+// lines, in the order in which Linux emits them. The first kRequiredSmapsFields
+// are required.
+constexpr struct {
+  absl::string_view key;
+  size_t ProcSmapsView::*field;
+} kSmapsFields[] = {
+    {"Size", &ProcSmapsView::size_kb},
+    {"Rss", &ProcSmapsView::rss_kb},
+    {"Shared_Clean", &ProcSmapsView::shared_clean_kb},
+    {"Shared_Dirty", &ProcSmapsView::shared_dirty_kb},
+    {"Private_Clean", &ProcSmapsView::private_clean_kb},
+    {"Private_Dirty", &ProcSmapsView::private_dirty_kb},
+    {"Pss", &ProcSmapsView::pss_kb},
+    {"Referenced", &ProcSmapsView::referenced_kb},
+    {"Anonymous", &ProcSmapsView::anonymous_kb},
+    {"AnonHugePages", &ProcSmapsView::anon_huge_pages_kb},
+    {"Swap", &ProcSmapsView::swap_kb},
+    {"Locked", &ProcSmapsView::locked_kb},
+};
+constexpr size_t kRequiredSmapsFields = 6;
+constexpr uint32_t kRequiredSmapsMask = (1 << kRequiredSmapsFields) - 1;
+constexpr uint32_t kVmFlagsBit = 1 << ABSL_ARRAYSIZE(kSmapsFields);
+
+}  // namespace
+
+PosixError VisitProcMaps(absl::string_view contents,
+                         const std::function<void(const ProcMapsView&)>& fn) {
+  absl::string_view line;
+  while (NextLine(&contents, &line)) {
+    if (line.empty()) {
+      continue;
+    }
+    ProcMapsView entry;
+    if (!ParseProcMapsView(line, &entry)) {
+      return PosixError(EINVAL, absl::StrCat("Invalid line: ", line));
+    }
+    fn(entry);
+  }
+  return NoError();
+}
+
+PosixError VisitProcSmaps(absl::string_view contents,
+                          const std::function<void(const ProcSmapsView&)>& fn) {
+  ProcSmapsView entry;
+  bool have_entry = false;
+  // Bit i is set once kSmapsFields[i] has been seen in the current entry.
+  uint32_t seen = 0;
+
+  auto const finish_entry = [&] {
+    if (have_entry) {
+      if ((seen & kRequiredSmapsMask) != kRequiredSmapsMask) {
+        for (size_t i = 0; i < kRequiredSmapsFields; i++) {
+          if (!(seen & (1 << i))) {
+            return PosixError(EINVAL, absl::StrCat("smaps entry is missing ",
+                                                   kSmapsFields[i].key));
+          }
+        }
+      }
+      fn(entry);
+    }
+    return NoError();
+  };
+
+  absl::string_view line;
+  while (NextLine(&contents, &line)) {
+    if (line.empty()) {
+      continue;
+    }
+    ProcMapsView maps_entry;
+    if (ParseProcMapsView(line, &maps_entry)) {
+      // This marks the beginning of a new /proc/[pid]/smaps entry.
+      RETURN_IF_ERRNO(finish_entry());
+      entry = {};
+      entry.maps_entry = maps_entry;
+      have_entry = true;
+      seen = 0;
+      continue;
+    }
+    if (!have_entry) {
+      return PosixError(
+          EINVAL,
+          absl::StrCat("smaps field line without preceding maps line: ", line));
+    }
+    const size_t colon = line.find(':');
+    if (colon == absl::string_view::npos) {
+      return PosixError(EINVAL,
+                        absl::StrCat("invalid smaps field line: ", line));
+    }
+    const absl::string_view key = line.substr(0, colon);
+    absl::string_view value = line.substr(colon + 1);
+
+    if (key == "VmFlags") {
+      if (seen & kVmFlagsBit) {
+        return PosixError(EINVAL, "duplicate VmFlags line");
+      }
+      seen |= kVmFlagsBit;
+      entry.vm_flags = absl::StripAsciiWhitespace(value);
+      continue;
+    }
+    size_t i = 0;
+    while (i < ABSL_ARRAYSIZE(kSmapsFields) && kSmapsFields[i].key != key) {
+      i++;
+    }
+    if (i == ABSL_ARRAYSIZE(kSmapsFields)) {
+      continue;  // Unknown or unsupported field.
+    }
+    if (seen & (1 << i)) {
+      return PosixError(
+          EINVAL, absl::StrCat("smaps entry has duplicate ", key, " line"));
+    }
+    seen |= 1 << i;
+    SkipSpaces(&value);
+    uint64_t kb;
+    if (!ConsumeNumber(&value, 10, &kb) ||
+        absl::StripAsciiWhitespace(value) != "kB") {
+      return PosixError(EINVAL,
+                        absl::StrCat("invalid smaps field value: ", line));
+    }
+    entry.*(kSmapsFields[i].field) = kb;
+  }
+  return finish_entry();
+}
+
 PosixErrorOr<ProcSmapsEntry> FindUniqueSmapsEntry(
     std::vector<ProcSmapsEntry> const& entries, uintptr_t addr) {
   auto const pred = [&](ProcSmapsEntry const& entry) {
@@ -15,6 +15,7 @@
 #ifndef GVISOR_TEST_UTIL_PROC_UTIL_H_
 #define GVISOR_TEST_UTIL_PROC_UTIL_H_
 
+#include <functional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -99,6 +100,57 @@ PosixErrorOr<std::vector<ProcSmapsEntry>> ReadProcSelfSmaps();
 // Reads and parses /proc/pid/smaps
 PosixErrorOr<std::vector<ProcSmapsEntry>> ReadProcSmaps(pid_t);
 
+// ProcMapsView is a single line of /proc/<xxx>/maps whose filename refers into
+// the contents it was parsed from.
+struct ProcMapsView {
+  uint64_t start;
+  uint64_t end;
+  bool readable;
+  bool writable;
+  bool executable;
+  bool priv;
+  uint64_t offset;
+  int major;
+  int minor;
+  int64_t inode;
+  absl::string_view filename;
+};
+
+// ProcSmapsView is a single /proc/<xxx>/smaps entry whose strings refer into
+// the contents it was parsed from. It holds the commonly used subset of the
+// fields in ProcSmapsEntry; optional fields that are absent are 0.
+struct ProcSmapsView {
+  ProcMapsView maps_entry;
+  size_t size_kb;
+  size_t rss_kb;
+  size_t shared_clean_kb;
+  size_t shared_dirty_kb;
+  size_t private_clean_kb;
+  size_t private_dirty_kb;
+  size_t pss_kb;
+  size_t referenced_kb;
+  size_t anonymous_kb;
+  size_t anon_huge_pages_kb;
+  size_t swap_kb;
+  size_t locked_kb;
+
+  // The space-separated VmFlags mnemonics. See the caution on
+  // ProcSmapsEntry::vm_flags.
+  absl::string_view vm_flags;
+};
+
+// Calls fn for each entry of the given /proc/<xxx>/maps contents in a single
+// pass, without allocating, or returns an error for the first malformed line.
+// Entries passed to fn are only valid for the duration of the call.
+PosixError VisitProcMaps(absl::string_view contents,
+                         const std::function<void(const ProcMapsView&)>& fn);
+
+// Like VisitProcMaps, but for /proc/<xxx>/smaps contents. Unknown fields are
+// ignored; an entry missing one of the fields required in ProcSmapsEntry is an
+// error.
+PosixError VisitProcSmaps(absl::string_view contents,
+                          const std::function<void(const ProcSmapsView&)>& fn);
+
 // Returns the unique entry in entries containing the given address.
 PosixErrorOr<ProcSmapsEntry> FindUniqueSmapsEntry(
     std::vector<ProcSmapsEntry> const&, uintptr_t);
@@ -14,8 +14,14 @@
 
 #include "test/util/proc_util.h"
 
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "test/util/fs_util.h"
+#include "test/util/posix_error.h"
 #include "test/util/test_util.h"
 
 using ::testing::ElementsAreArray;
@@ -125,6 +131,103 @@ TEST(ParseProcMapsLineTest, WithFilenameContainingSpaces) {
   EXPECT_EQ(entry.filename, "/dev/zero (deleted)");
 }
 
+TEST(VisitProcMapsTest, MatchesParseProcMaps) {
+  constexpr absl::string_view kMaps =
+      "00400000-00452000 r-xp 00000000 08:02 173521      /usr/bin/dbus-daemon\n"
+      "2ab4f00b7000-2ab4f00b9000 r-xp 00000000 00:00 0 \n"
+      "7f26b3b12000-7f26b3b13000 rw-s 00000000 00:05 1432484 "
+      "                   /dev/zero (deleted)\n";
+  auto want = ASSERT_NO_ERRNO_AND_VALUE(ParseProcMaps(kMaps));
+  std::vector<ProcMapsView> got;
+  ASSERT_NO_ERRNO(VisitProcMaps(
+      kMaps, [&](const ProcMapsView& entry) { got.push_back(entry); }));
+  ASSERT_EQ(got.size(), want.size());
+  for (size_t i = 0; i < got.size(); i++) {
+    EXPECT_EQ(got[i].start, want[i].start);
+    EXPECT_EQ(got[i].end, want[i].end);
+    EXPECT_EQ(got[i].readable, want[i].readable);
+    EXPECT_EQ(got[i].writable, want[i].writable);
+    EXPECT_EQ(got[i].executable, want[i].executable);
+    EXPECT_EQ(got[i].priv, want[i].priv);
+    EXPECT_EQ(got[i].offset, want[i].offset);
+    EXPECT_EQ(got[i].major, want[i].major);
+    EXPECT_EQ(got[i].minor, want[i].minor);
+    EXPECT_EQ(got[i].inode, want[i].inode);
+    EXPECT_EQ(got[i].filename, want[i].filename);
+  }
+}
+
+TEST(VisitProcMapsTest, InvalidLine) {
+  EXPECT_THAT(
+      VisitProcMaps("00400000-00452000 r-xp 00000000 08:02\n",
+                    [](const ProcMapsView&) {}),
+      PosixErrorIs(EINVAL));
+}
+
+TEST(VisitProcSmapsTest, Correctness) {
+  int count = 0;
+  ASSERT_NO_ERRNO(VisitProcSmaps(
+      "0-10000 rw-s 00000000 00:00 0 "
+      "                   /dev/zero (deleted)\n"
+      "Size:                  0 kB\n"
+      "Rss:                   1 kB\n"
+      "Pss:                   2 kB\n"
+      "Shared_Clean:          3 kB\n"
+      "Shared_Dirty:          4 kB\n"
+      "Private_Clean:         5 kB\n"
+      "Private_Dirty:         6 kB\n"
+      "Referenced:            7 kB\n"
+      "Anonymous:             8 kB\n"
+      "AnonHugePages:         9 kB\n"
+      "Swap:                 12 kB\n"
+      "Locked:               16 kB\n"
+      "FutureUnknownKey:     17 kB\n"
+      "VmFlags: rd wr sh mr mw me ms lo ?? sd \n",
+      [&](const ProcSmapsView& entry) {
+        count++;
+        EXPECT_EQ(entry.maps_entry.filename, "/dev/zero (deleted)");
+        EXPECT_EQ(entry.size_kb, 0);
+        EXPECT_EQ(entry.rss_kb, 1);
+        EXPECT_EQ(entry.pss_kb, 2);
+        EXPECT_EQ(entry.shared_clean_kb, 3);
+        EXPECT_EQ(entry.shared_dirty_kb, 4);
+        EXPECT_EQ(entry.private_clean_kb, 5);
+        EXPECT_EQ(entry.private_dirty_kb, 6);
+        EXPECT_EQ(entry.referenced_kb, 7);
+        EXPECT_EQ(entry.anonymous_kb, 8);
+        EXPECT_EQ(entry.anon_huge_pages_kb, 9);
+        EXPECT_EQ(entry.swap_kb, 12);
+        EXPECT_EQ(entry.locked_kb, 16);
+        EXPECT_EQ(entry.vm_flags, "rd wr sh mr mw me ms lo ?? sd");
+      }));
+  EXPECT_EQ(count, 1);
+}
+
+TEST(VisitProcSmapsTest, MissingRequiredField) {
+  EXPECT_THAT(VisitProcSmaps("0-10000 rw-s 00000000 00:00 0\n"
+                             "Size:                  0 kB\n",
+                             [](const ProcSmapsView&) {}),
+              PosixErrorIs(EINVAL));
+}
+
+TEST(VisitProcSmapsTest, MatchesParseProcSmaps) {
+  const std::string contents =
+      ASSERT_NO_ERRNO_AND_VALUE(GetContents("/proc/self/smaps"));
+  auto want = ASSERT_NO_ERRNO_AND_VALUE(ParseProcSmaps(contents));
+  size_t i = 0;
+  ASSERT_NO_ERRNO(VisitProcSmaps(contents, [&](const ProcSmapsView& entry) {
+    ASSERT_LT(i, want.size());
+    EXPECT_EQ(entry.maps_entry.start, want[i].maps_entry.start);
+    EXPECT_EQ(entry.maps_entry.filename, want[i].maps_entry.filename);
+    EXPECT_EQ(entry.size_kb, want[i].size_kb);
+    EXPECT_EQ(entry.rss_kb, want[i].rss_kb);
+    EXPECT_EQ(entry.private_dirty_kb, want[i].private_dirty_kb);
+    EXPECT_EQ(entry.pss_kb, want[i].pss_kb.value_or(0));
+    i++;
+  }));
+  EXPECT_EQ(i, want.size());
+}
+
 }  // namespace
 
 }  // namespace testing
@@ -16,11 +16,17 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <atomic>
 #include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <string>
 
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 
 namespace gvisor {
@@ -40,14 +46,69 @@ bool SavePresent() {
 
 std::atomic<int> save_disable;
 
+// Save cycle statistics, in nanoseconds. These are atomics rather than a
+// mutex-protected SaveStats because MaybeSave must remain async-signal-safe.
+std::atomic<uint64_t> save_count;
+std::atomic<int64_t> save_total_ns;
+std::atomic<int64_t> save_min_ns{std::numeric_limits<int64_t>::max()};
+std::atomic<int64_t> save_max_ns;
+
+// Returns the wall time in nanoseconds. The monotonic clock is not used
+// because the time for which the sandbox was stopped may not be reflected in
+// it after a restore.
+int64_t WallNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void RecordSave(int64_t ns) {
+  save_count++;
+  save_total_ns += ns;
+  int64_t cur = save_min_ns.load();
+  while (ns < cur && !save_min_ns.compare_exchange_weak(cur, ns)) {
+  }
+  cur = save_max_ns.load();
+  while (ns > cur && !save_max_ns.compare_exchange_weak(cur, ns)) {
+  }
+}
+
 }  // namespace
 
 bool IsRunningWithSaveRestore() { return SavePresent(); }
 
 void MaybeSave() {
   if (SavePresent() && save_disable.load() == 0) {
+    const int orig_errno = errno;
+    const int64_t start = WallNanos();
     internal::DoCooperativeSave();
+    RecordSave(WallNanos() - start);
+    errno = orig_errno;
+  }
+}
+
+SaveStats GetSaveStats() {
+  SaveStats stats;
+  stats.count = save_count.load();
+  if (stats.count == 0) {
+    return stats;
+  }
+  stats.total = absl::Nanoseconds(save_total_ns.load());
+  stats.min = absl::Nanoseconds(save_min_ns.load());
+  stats.max = absl::Nanoseconds(save_max_ns.load());
+  return stats;
+}
+
+std::string SaveStatsSummary() {
+  const SaveStats stats = GetSaveStats();
+  if (stats.count == 0) {
+    return "";
   }
+  return absl::StrCat(stats.count, " save cycles, total ",
+                      absl::FormatDuration(stats.total), ", mean ",
+                      absl::FormatDuration(stats.total / stats.count),
+                      ", min ", absl::FormatDuration(stats.min), ", max ",
+                      absl::FormatDuration(stats.max));
 }
 
 DisableSave::DisableSave() { save_disable++; }
@@ -15,6 +15,11 @@
 #ifndef GVISOR_TEST_UTIL_SAVE_UTIL_H_
 #define GVISOR_TEST_UTIL_SAVE_UTIL_H_
 
+#include <cstdint>
+#include <string>
+
+#include "absl/time/time.h"
+
 namespace gvisor {
 namespace testing {
 
@@ -45,6 +50,26 @@ class DisableSave {
   bool reset_ = false;
 };
 
+// SaveStats summarizes the co-operative save cycles performed by MaybeSave in
+// this process.
+struct SaveStats {
+  uint64_t count = 0;
+
+  // Wall time for which callers of MaybeSave were stopped. This covers the
+  // checkpoint and the restore or resume that follows it, which is the pause
+  // that a workload being migrated observes.
+  absl::Duration total;
+  absl::Duration min;
+  absl::Duration max;
+};
+
+// Returns statistics for the save cycles performed so far.
+SaveStats GetSaveStats();
+
+// Returns a one-line summary of GetSaveStats, or the empty string if no save
+// cycles have been performed.
+std::string SaveStatsSummary();
+
 namespace internal {
 
 // Causes a co-operative save cycle to occur.
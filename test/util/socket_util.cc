@@ -15,19 +15,29 @@
 #include "test/util/socket_util.h"
 
 #include <arpa/inet.h>
+#include <limits.h>
+#include <linux/errqueue.h>
 #include <netinet/in.h>
 #include <poll.h>
 #include <sys/socket.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <stack>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "test/util/file_descriptor.h"
 #include "test/util/posix_error.h"
@@ -591,6 +601,64 @@ std::vector<SocketPairKind> IncludeReversals(std::vector<SocketPairKind> vec) {
 
 SocketPairKind NoOp(SocketPairKind const& base) { return base; }
 
+PosixErrorOr<std::vector<std::unique_ptr<SocketPair>>> CreateSocketPairs(
+    SocketPairKind const& kind, int n, int parallelism) {
+  std::vector<std::unique_ptr<SocketPair>> pairs(n);
+  std::vector<PosixError> errors(n);
+  {
+    // Each thread creates pairs at indices congruent to its own.
+    std::vector<std::unique_ptr<ScopedThread>> threads;
+    const int nthreads = std::max(1, std::min(n, parallelism));
+    for (int t = 0; t < nthreads; t++) {
+      threads.push_back(std::make_unique<ScopedThread>([&, t] {
+        for (int i = t; i < n; i += nthreads) {
+          PosixErrorOr<std::unique_ptr<SocketPair>> pair = kind.Create();
+          if (!pair.ok()) {
+            errors[i] = pair.error();
+            continue;
+          }
+          pairs[i] = std::move(pair).ValueOrDie();
+        }
+      }));
+    }
+  }
+  for (const PosixError& error : errors) {
+    RETURN_IF_ERRNO(error);
+  }
+  return pairs;
+}
+
+Middleware Pooled(int batch) {
+  // Number of threads creating pairs for each refill.
+  constexpr int kParallelism = 8;
+  return [=](SocketPairKind const& base) {
+    struct Pool {
+      absl::Mutex mu;
+      std::deque<std::unique_ptr<SocketPair>> pairs ABSL_GUARDED_BY(mu);
+    };
+    // The pool is shared by all copies of the returned kind, but not with
+    // other kinds.
+    auto pool = std::make_shared<Pool>();
+    return SocketPairKind{
+        absl::StrCat("pooled ", base.description), base.domain, base.type,
+        base.protocol,
+        [base, batch, pool]() -> PosixErrorOr<std::unique_ptr<SocketPair>> {
+          absl::MutexLock lock(&pool->mu);
+          if (pool->pairs.empty()) {
+            ASSIGN_OR_RETURN_ERRNO(
+                std::vector<std::unique_ptr<SocketPair>> pairs,
+                CreateSocketPairs(base, batch, kParallelism));
+            for (auto& pair : pairs) {
+              pool->pairs.push_back(std::move(pair));
+            }
+          }
+          std::unique_ptr<SocketPair> pair = std::move(pool->pairs.front());
+          pool->pairs.pop_front();
+          return pair;
+        }};
+  };
+}
+
 void TransferTest(int fd1, int fd2) {
   char buf1[20];
   RandomizeBuffer(buf1, sizeof(buf1));
@@ -664,6 +732,8 @@ ssize_t SendLargeSendMsg(const std::unique_ptr<SocketPair>& sockets,
     while (total < size) {
       int ret = read(rfd, buf.data(), buf.size());
       if (ret == -1 && errno == EAGAIN) {
+        struct pollfd pfd = {rfd, POLLIN, 0};
+        ASSERT_THAT(RetryEINTR(poll)(&pfd, 1, -1), SyscallSucceeds());
         continue;
       }
       if (ret > 0) {
@@ -688,6 +758,239 @@ ssize_t SendLargeSendMsg(const std::unique_ptr<SocketPair>& sockets,
   return RetryEINTR(sendmsg)(sockets->first_fd(), &msg, 0);
 }
 
+namespace {
+
+constexpr uint64_t kStreamHashPrime1 = 0x9e3779b185ebca87ULL;
+constexpr uint64_t kStreamHashPrime2 = 0xc2b2ae3d27d4eb4fULL;
+
+// How long bulk transfers wait for a socket to become ready.
+constexpr absl::Duration kBulkTransferTimeout = absl::Seconds(60);
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// Waits until one of events is ready on fd, or deadline passes. POLLERR and
+// POLLHUP are always reported, so events may be 0 to wait for the error
+// queue.
+PosixError PollUntil(int fd, short events, absl::Time deadline) {
+  struct pollfd pfd = {fd, events, 0};
+  int timeout_ms = std::max<int64_t>(
+      0, absl::ToInt64Milliseconds(deadline - absl::Now()));
+  int ret = RetryEINTR(poll)(&pfd, 1, timeout_ms);
+  if (ret < 0) {
+    return PosixError(errno, "poll failed");
+  }
+  if (ret == 0) {
+    return PosixError(ETIMEDOUT, absl::StrCat("fd ", fd, " not ready"));
+  }
+  return NoError();
+}
+
+// Reads MSG_ZEROCOPY completions from fd's error queue until the first want
+// sends have completed. *done is the number of sends known to be complete.
+PosixError ReapZerocopy(int fd, uint32_t* done, uint32_t want) {
+  const absl::Time deadline = absl::Now() + kBulkTransferTimeout;
+  while (*done < want) {
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+    struct msghdr msg = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (RetryEINTR(recvmsg)(fd, &msg, MSG_ERRQUEUE) < 0) {
+      if (errno != EAGAIN) {
+        return PosixError(errno, "recvmsg(MSG_ERRQUEUE) failed");
+      }
+      RETURN_IF_ERRNO(PollUntil(fd, 0, deadline));
+      continue;
+    }
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      struct sock_extended_err serr;
+      memcpy(&serr, CMSG_DATA(cmsg), sizeof(serr));
+      if (serr.ee_errno != 0 || serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      // ee_info through ee_data is the inclusive range of completed sends.
+      *done = std::max(*done, serr.ee_data + 1);
+    }
+  }
+  return NoError();
+}
+
+}  // namespace
+
+StreamHash::StreamHash()
+    : lanes_{kStreamHashPrime1 + kStreamHashPrime2, kStreamHashPrime2, 0,
+             0 - kStreamHashPrime1} {}
+
+void StreamHash::Block(const char* block) {
+  for (size_t i = 0; i < kLanes; i++) {
+    uint64_t word;
+    memcpy(&word, block + i * sizeof(word), sizeof(word));
+    lanes_[i] = Rotl64(lanes_[i] + word * kStreamHashPrime2, 31) *
+                kStreamHashPrime1;
+  }
+}
+
+void StreamHash::Update(const char* data, size_t len) {
+  total_ += len;
+  if (pending_len_ > 0) {
+    size_t n = std::min(len, kBlockSize - pending_len_);
+    memcpy(pending_ + pending_len_, data, n);
+    pending_len_ += n;
+    data += n;
+    len -= n;
+    if (pending_len_ < kBlockSize) {
+      return;
+    }
+    Block(pending_);
+    pending_len_ = 0;
+  }
+  for (; len >= kBlockSize; data += kBlockSize, len -= kBlockSize) {
+    Block(data);
+  }
+  memcpy(pending_, data, len);
+  pending_len_ = len;
+}
+
+uint64_t StreamHash::Digest() const {
+  uint64_t h = Rotl64(lanes_[0], 1) + Rotl64(lanes_[1], 7) +
+               Rotl64(lanes_[2], 12) + Rotl64(lanes_[3], 18);
+  h ^= total_ * kStreamHashPrime1;
+  for (size_t i = 0; i < pending_len_; i++) {
+    h = Rotl64(h ^ (static_cast<uint8_t>(pending_[i]) * kStreamHashPrime1),
+               11) *
+        kStreamHashPrime2;
+  }
+  h ^= h >> 33;
+  h *= kStreamHashPrime2;
+  h ^= h >> 29;
+  h *= kStreamHashPrime1;
+  h ^= h >> 32;
+  return h;
+}
+
+PosixErrorOr<uint64_t> SendBulk(int fd, size_t size,
+                                const BulkTransferOptions& opts) {
+  if (opts.iov_count == 0 || opts.iov_count >= IOV_MAX || opts.iov_size == 0) {
+    return PosixError(EINVAL, "invalid BulkTransferOptions");
+  }
+
+  // Each iovec covers its own part of buf, which is sent repeatedly.
+  std::vector<char> buf(opts.iov_count * opts.iov_size);
+  RandomizeBuffer(buf.data(), buf.size());
+
+  int flags = 0;
+  bool zerocopy = false;
+  if (opts.zerocopy && setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &kSockOptOn,
+                                  sizeof(kSockOptOn)) == 0) {
+    zerocopy = true;
+    flags |= MSG_ZEROCOPY;
+  }
+  uint32_t zerocopy_sent = 0;
+  uint32_t zerocopy_done = 0;
+
+  // After a short write, a call may start and end part way into an iovec.
+  std::vector<struct iovec> iovs(opts.iov_count + 1);
+  const absl::Time deadline = absl::Now() + kBulkTransferTimeout;
+  StreamHash hash;
+  size_t sent = 0;
+  size_t off = 0;
+  while (sent < size) {
+    size_t iovlen = 0;
+    for (size_t pos = off, left = std::min(size - sent, buf.size()); left > 0;
+         iovlen++) {
+      size_t len = std::min(opts.iov_size - pos % opts.iov_size, left);
+      iovs[iovlen].iov_base = buf.data() + pos;
+      iovs[iovlen].iov_len = len;
+      pos = (pos + len) % buf.size();
+      left -= len;
+    }
+
+    struct msghdr msg = {};
+    msg.msg_iov = iovs.data();
+    msg.msg_iovlen = iovlen;
+    ssize_t ret = RetryEINTR(sendmsg)(fd, &msg, flags);
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        RETURN_IF_ERRNO(PollUntil(fd, POLLOUT, deadline));
+        continue;
+      }
+      if (errno == ENOBUFS && zerocopy && zerocopy_done < zerocopy_sent) {
+        // Too many sends are pinning memory; wait for one to complete.
+        RETURN_IF_ERRNO(ReapZerocopy(fd, &zerocopy_done, zerocopy_done + 1));
+        continue;
+      }
+      return PosixError(errno, absl::StrCat("sendmsg failed after ", sent,
+                                            " of ", size, " bytes"));
+    }
+    if (zerocopy) {
+      zerocopy_sent++;
+    }
+
+    for (size_t i = 0, left = ret; left > 0; i++) {
+      size_t len = std::min(iovs[i].iov_len, left);
+      hash.Update(static_cast<const char*>(iovs[i].iov_base), len);
+      left -= len;
+    }
+    sent += ret;
+    off = (off + ret) % buf.size();
+  }
+
+  // buf must outlive any send that still references it.
+  if (zerocopy) {
+    RETURN_IF_ERRNO(ReapZerocopy(fd, &zerocopy_done, zerocopy_sent));
+  }
+  return hash.Digest();
+}
+
+PosixErrorOr<uint64_t> RecvBulk(int fd, size_t size) {
+  std::vector<char> buf(std::max<size_t>(1, std::min<size_t>(size, 1 << 18)));
+  const absl::Time deadline = absl::Now() + kBulkTransferTimeout;
+  StreamHash hash;
+  size_t total = 0;
+  while (total < size) {
+    ssize_t ret =
+        RetryEINTR(read)(fd, buf.data(), std::min(buf.size(), size - total));
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        RETURN_IF_ERRNO(PollUntil(fd, POLLIN, deadline));
+        continue;
+      }
+      return PosixError(errno, absl::StrCat("read failed after ", total, " of ",
+                                            size, " bytes"));
+    }
+    if (ret == 0) {
+      return PosixError(EPIPE, absl::StrCat("EOF after ", total, " of ", size,
+                                            " bytes"));
+    }
+    hash.Update(buf.data(), ret);
+    total += ret;
+  }
+  return hash.Digest();
+}
+
+void BulkTransferTest(int fd1, int fd2, size_t size,
+                      const BulkTransferOptions& opts) {
+  // Potentially too many syscalls.
+  const DisableSave ds;
+
+  for (const auto& [wfd, rfd] : {std::pair<int, int>(fd1, fd2),
+                                 std::pair<int, int>(fd2, fd1)}) {
+    PosixErrorOr<uint64_t> received = PosixError(ENODATA);
+    ScopedThread t([&received, rfd = rfd, size] {
+      received = RecvBulk(rfd, size);
+    });
+    const uint64_t sent = ASSERT_NO_ERRNO_AND_VALUE(SendBulk(wfd, size, opts));
+    t.Join();
+    EXPECT_THAT(received, IsPosixErrorOkAndHolds(sent));
+  }
+}
+
 namespace internal {
 PosixErrorOr<int> TryPortAvailable(int port, AddressFamily family,
                                    SocketType type, bool reuse_addr) {
@@ -910,32 +1213,61 @@ TestAddress V6MulticastLinkLocalAllRouters() {
   return V6AddrStr("V6MulticastLinkLocalAllRouters", "ff02::2");
 }
 
-// Checksum computes the internet checksum of a buffer.
-uint16_t Checksum(uint16_t* buf, ssize_t buf_size) {
-  // Add up the 16-bit values in the buffer.
-  uint32_t total = 0;
-  for (unsigned int i = 0; i < buf_size - 1; i += sizeof(*buf)) {
-    total += *buf;
-    buf++;
-  }
+namespace {
 
-  // If buf has an odd size, add the remaining byte.
-  if (buf_size % 2) {
-    total += *(reinterpret_cast<unsigned char*>(buf));
+// ChecksumAdd adds the 16-bit words of buf to the ones' complement sum sum,
+// which may then be passed to ChecksumFinish or to further calls. Only the
+// last buffer added may have an odd length.
+//
+// Ones' complement addition is associative and independent of byte order, so
+// the native 32-bit halves of each 64-bit load are summed into 64-bit
+// accumulators and folded at the end. Four accumulators keep the adds
+// independent.
+uint64_t ChecksumAdd(const void* buf, size_t len, uint64_t sum) {
+  const char* p = static_cast<const char*>(buf);
+  uint64_t acc[4] = {sum, 0, 0, 0};
+  for (; len >= 32; p += 32, len -= 32) {
+    for (int i = 0; i < 4; i++) {
+      uint64_t word;
+      memcpy(&word, p + i * 8, sizeof(word));
+      acc[i] += (word & 0xffffffff) + (word >> 32);
+    }
   }
+  sum = acc[0] + acc[1] + acc[2] + acc[3];
+  for (; len >= 4; p += 4, len -= 4) {
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    sum += word;
+  }
+  if (len >= 2) {
+    uint16_t word;
+    memcpy(&word, p, sizeof(word));
+    sum += word;
+    p += 2;
+    len -= 2;
+  }
+  // If buf has an odd size, pad the remaining byte with zero.
+  if (len) {
+    uint16_t word = 0;
+    memcpy(&word, p, 1);
+    sum += word;
+  }
+  return sum;
+}
 
+// ChecksumFinish folds a sum from ChecksumAdd into the internet checksum.
+uint16_t ChecksumFinish(uint64_t sum) {
   // This carries any bits past the lower 16 until everything fits in 16 bits.
-  while (total >> 16) {
-    uint16_t lower = total & 0xffff;
-    uint16_t upper = total >> 16;
-    total = lower + upper;
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
   }
-
-  return ~total;
+  return ~sum;
 }
 
+}  // namespace
+
 uint16_t IPChecksum(struct iphdr ip) {
-  return Checksum(reinterpret_cast<uint16_t*>(&ip), sizeof(ip));
+  return ChecksumFinish(ChecksumAdd(&ip, sizeof(ip), 0));
 }
 
 // The pseudo-header defined in RFC 768 for calculating the UDP checksum.
@@ -958,15 +1290,10 @@ uint16_t UDPChecksum(struct iphdr iphdr, struct udphdr udphdr,
   phdr.protocol = IPPROTO_UDP;
   phdr.udplen = udphdr.len;
 
-  ssize_t buf_size = sizeof(phdr) + sizeof(udphdr) + payload_len;
-  char* buf = static_cast<char*>(malloc(buf_size));
-  memcpy(buf, &phdr, sizeof(phdr));
-  memcpy(buf + sizeof(phdr), &udphdr, sizeof(udphdr));
-  memcpy(buf + sizeof(phdr) + sizeof(udphdr), payload, payload_len);
-
-  uint16_t csum = Checksum(reinterpret_cast<uint16_t*>(buf), buf_size);
-  free(buf);
-  return csum;
+  // The headers have even sizes, so the payload can be summed in place.
+  uint64_t sum = ChecksumAdd(&phdr, sizeof(phdr), 0);
+  sum = ChecksumAdd(&udphdr, sizeof(udphdr), sum);
+  return ChecksumFinish(ChecksumAdd(payload, payload_len, sum));
 }
 
 // IPv6 pseudo-header for UDP checksum calculation.
@@ -988,27 +1315,15 @@ uint16_t UDPChecksum(struct ip6_hdr iphdr, struct udphdr udphdr,
   phdr.protocol = IPPROTO_UDP;
   phdr.udplen = udphdr.len;
 
-  ssize_t buf_size = sizeof(phdr) + sizeof(udphdr) + payload_len;
-  char* buf = static_cast<char*>(malloc(buf_size));
-  memcpy(buf, &phdr, sizeof(phdr));
-  memcpy(buf + sizeof(phdr), &udphdr, sizeof(udphdr));
-  memcpy(buf + sizeof(phdr) + sizeof(udphdr), payload, payload_len);
-
-  uint16_t csum = Checksum(reinterpret_cast<uint16_t*>(buf), buf_size);
-  free(buf);
-  return csum;
+  uint64_t sum = ChecksumAdd(&phdr, sizeof(phdr), 0);
+  sum = ChecksumAdd(&udphdr, sizeof(udphdr), sum);
+  return ChecksumFinish(ChecksumAdd(payload, payload_len, sum));
 }
 
 uint16_t ICMPChecksum(struct icmphdr icmphdr, const char* payload,
                       ssize_t payload_len) {
-  ssize_t buf_size = sizeof(icmphdr) + payload_len;
-  char* buf = static_cast<char*>(malloc(buf_size));
-  memcpy(buf, &icmphdr, sizeof(icmphdr));
-  memcpy(buf + sizeof(icmphdr), payload, payload_len);
-
-  uint16_t csum = Checksum(reinterpret_cast<uint16_t*>(buf), buf_size);
-  free(buf);
-  return csum;
+  uint64_t sum = ChecksumAdd(&icmphdr, sizeof(icmphdr), 0);
+  return ChecksumFinish(ChecksumAdd(payload, payload_len, sum));
 }
 
 PosixErrorOr<uint16_t> AddrPort(int family, sockaddr_storage const& addr) {
@@ -400,6 +400,24 @@ constexpr int kSockOptOff = 0;
 // NoOp returns the same SocketPairKind that it is passed.
 SocketPairKind NoOp(SocketPairKind const& base);
 
+// CreateSocketPairs creates n socket pairs of the given kind, using up to
+// parallelism threads, e.g. for benchmarks that need many connections. If any
+// creation fails, the first error is returned.
+PosixErrorOr<std::vector<std::unique_ptr<SocketPair>>> CreateSocketPairs(
+    SocketPairKind const& kind, int n, int parallelism);
+
+// Pooled returns a Middleware whose SocketPairKinds hand out socket pairs from
+// a pool, which is refilled with batch pairs created in parallel by
+// CreateSocketPairs whenever it is empty. This amortizes the cost of creating
+// pairs, e.g. the listen/connect/accept of TCP pairs, across parameterized
+// tests.
+//
+// Pairs are only created once the first pair is requested, and are handed
+// out in creation order, so tests get pairs that were created earlier than
+// they would be otherwise; pooling suits kinds whose pairs don't change
+// state when left idle.
+Middleware Pooled(int batch);
+
 // TransferTest tests that data can be send back and fourth between two
 // specified FDs. Note that calls to this function should be wrapped in
 // ASSERT_NO_FATAL_FAILURE().
@@ -444,6 +462,64 @@ ssize_t SendLargeSendMsg(const std::unique_ptr<SocketPair>& sockets,
 // Initializes the given buffer with random data.
 void RandomizeBuffer(char* ptr, size_t len);
 
+// StreamHash is a fast, non-cryptographic 64-bit hash of a byte stream. The
+// result depends only on the bytes hashed, not on how they were split across
+// calls to Update, so the two ends of a stream socket can compare hashes
+// rather than full copies of the data.
+class StreamHash {
+ public:
+  StreamHash();
+
+  void Update(const char* data, size_t len);
+
+  // Returns the hash of all bytes passed to Update so far.
+  uint64_t Digest() const;
+
+ private:
+  static constexpr size_t kBlockSize = 32;
+  static constexpr size_t kLanes = kBlockSize / sizeof(uint64_t);
+
+  void Block(const char* block);
+
+  uint64_t lanes_[kLanes];
+  char pending_[kBlockSize];
+  size_t pending_len_ = 0;
+  uint64_t total_ = 0;
+};
+
+// Options for bulk transfers.
+struct BulkTransferOptions {
+  // Number of iovecs passed to each sendmsg call.
+  size_t iov_count = 64;
+
+  // Size of each iovec.
+  size_t iov_size = 4096;
+
+  // Whether to send with MSG_ZEROCOPY. It is silently disabled if the socket
+  // does not support SO_ZEROCOPY.
+  bool zerocopy = false;
+};
+
+// Sends size bytes of random data on the stream socket fd with sendmsg, and
+// returns their StreamHash. If fd is non-blocking, waits with poll rather than
+// spinning on EAGAIN. With MSG_ZEROCOPY, also waits for the kernel to release
+// the send buffer before returning.
+PosixErrorOr<uint64_t> SendBulk(int fd, size_t size,
+                                const BulkTransferOptions& opts = {});
+
+// Receives exactly size bytes from the stream socket fd, and returns their
+// StreamHash. If fd is non-blocking, waits with poll rather than spinning on
+// EAGAIN.
+PosixErrorOr<uint64_t> RecvBulk(int fd, size_t size);
+
+// BulkTransferTest is TransferTest for large amounts of data. It sends size
+// bytes in each direction between the stream sockets fd1 and fd2, reading on
+// a separate thread, and checks that the hash of the received data matches.
+// Note that calls to this function should be wrapped in
+// ASSERT_NO_FATAL_FAILURE().
+void BulkTransferTest(int fd1, int fd2, size_t size,
+                      const BulkTransferOptions& opts = {});
+
 enum class AddressFamily { kIpv4 = 1, kIpv6 = 2, kDualStack = 3 };
 enum class SocketType { kUdp = 1, kTcp = 2 };
 
@@ -0,0 +1,87 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/util/socket_util.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+SocketPairKind TCPKind() {
+  return SocketPairKind{"TCP", AF_INET, SOCK_STREAM, IPPROTO_TCP,
+                        TCPAcceptBindSocketPairCreator(AF_INET, SOCK_STREAM,
+                                                       IPPROTO_TCP, false)};
+}
+
+TEST(CreateSocketPairsTest, CreatesConnectedPairs) {
+  const std::vector<std::unique_ptr<SocketPair>> pairs =
+      ASSERT_NO_ERRNO_AND_VALUE(CreateSocketPairs(TCPKind(), 32, 8));
+  ASSERT_EQ(pairs.size(), 32);
+  std::set<int> fds;
+  for (const auto& pair : pairs) {
+    fds.insert(pair->first_fd());
+    fds.insert(pair->second_fd());
+    ASSERT_NO_FATAL_FAILURE(TransferTest(pair->first_fd(), pair->second_fd()));
+  }
+  EXPECT_EQ(fds.size(), 64);
+}
+
+TEST(CreateSocketPairsTest, ReturnsError) {
+  const SocketPairKind kind = {
+      "failing", AF_INET, SOCK_STREAM, IPPROTO_TCP,
+      []() -> PosixErrorOr<std::unique_ptr<SocketPair>> {
+        return PosixError(EMFILE, "failing");
+      }};
+  EXPECT_THAT(CreateSocketPairs(kind, 4, 2), PosixErrorIs(EMFILE));
+}
+
+TEST(PooledTest, RefillsInBatches) {
+  auto created = std::make_shared<std::atomic<int>>(0);
+  const SocketPairKind base = TCPKind();
+  const SocketPairKind counted = {
+      base.description, base.domain, base.type, base.protocol,
+      [base, created]() -> PosixErrorOr<std::unique_ptr<SocketPair>> {
+        created->fetch_add(1);
+        return base.Create();
+      }};
+  const SocketPairKind pooled = Pooled(4)(counted);
+
+  // Creating the kind doesn't create pairs.
+  EXPECT_EQ(created->load(), 0);
+
+  for (int i = 0; i < 6; i++) {
+    const std::unique_ptr<SocketPair> pair =
+        ASSERT_NO_ERRNO_AND_VALUE(pooled.Create());
+    ASSERT_NO_FATAL_FAILURE(TransferTest(pair->first_fd(), pair->second_fd()));
+    EXPECT_EQ(created->load(), i < 4 ? 4 : 8);
+  }
+}
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -14,13 +14,24 @@
 
 #include "test/util/temp_path.h"
 
+#include <sys/mount.h>
 #include <unistd.h>
 
 #include <atomic>
+#include <cerrno>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
 
 #include "gtest/gtest.h"
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "test/util/fs_util.h"
@@ -34,11 +45,26 @@ namespace {
 
 std::atomic<uint64_t> global_temp_file_number(1);
 
+// tmpfs_tmpdir is the path of the existing TmpfsTestTmpdir, if any.
+ABSL_CONST_INIT absl::Mutex tmpfs_tmpdir_mu(absl::kConstInit);
+std::string* tmpfs_tmpdir ABSL_GUARDED_BY(tmpfs_tmpdir_mu) = nullptr;
+
+// InTmpfsTestTmpdir returns true if path is in the existing TmpfsTestTmpdir.
+bool InTmpfsTestTmpdir(absl::string_view path) {
+  absl::MutexLock lock(&tmpfs_tmpdir_mu);
+  return tmpfs_tmpdir != nullptr &&
+         absl::StartsWith(path, absl::StrCat(*tmpfs_tmpdir, "/"));
+}
+
+// The number of threads, and so directory fds, used to delete large trees.
+constexpr int kDeleteParallelism = 8;
+
 void TryDeleteRecursively(std::string const& path) {
   if (!path.empty()) {
     int undeleted_dirs = 0;
     int undeleted_files = 0;
-    auto status = RecursivelyDelete(path, &undeleted_dirs, &undeleted_files);
+    auto status = ParallelRecursivelyDelete(path, kDeleteParallelism,
+                                            &undeleted_dirs, &undeleted_files);
     if (undeleted_dirs || undeleted_files || !status.ok()) {
       std::cerr << path << ": failed to delete " << undeleted_dirs
                 << " directories and " << undeleted_files
@@ -63,6 +89,13 @@ std::string NewTempAbsPath() {
 std::string NewTempRelPath() { return NextTempBasename(); }
 
 std::string GetAbsoluteTestTmpdir() {
+  {
+    absl::MutexLock lock(&tmpfs_tmpdir_mu);
+    if (tmpfs_tmpdir != nullptr) {
+      return *tmpfs_tmpdir;
+    }
+  }
+
   // Note that TEST_TMPDIR is guaranteed to be set.
   char* env_tmpdir = getenv("TEST_TMPDIR");
   std::string tmp_dir =
@@ -136,12 +169,24 @@ PosixErrorOr<TempPath> TempPath::CreateDir() {
   return TempPath::CreateDirIn(GetAbsoluteTestTmpdir());
 }
 
-TempPath::~TempPath() { TryDeleteRecursively(path_); }
+TempPath::TempPath(std::string path)
+    : path_(std::move(path)), deferred_(InTmpfsTestTmpdir(path_)) {}
+
+TempPath::~TempPath() {
+  // Paths in a TmpfsTestTmpdir are deleted when it is destroyed.
+  if (!deferred_) {
+    TryDeleteRecursively(path_);
+  }
+}
 
-TempPath::TempPath(TempPath&& orig) { reset(orig.release()); }
+TempPath::TempPath(TempPath&& orig) { *this = std::move(orig); }
 
 TempPath& TempPath::operator=(TempPath&& orig) {
+  // The path may outlive the TmpfsTestTmpdir it was created in, so keep
+  // whether it's deferred rather than checking again.
+  const bool deferred = orig.deferred_;
   reset(orig.release());
+  deferred_ = deferred;
   return *this;
 }
 
@@ -149,14 +194,47 @@ std::string TempPath::reset(std::string newpath) {
   std::string path = path_;
   TryDeleteRecursively(path_);
   path_ = std::move(newpath);
+  deferred_ = InTmpfsTestTmpdir(path_);
   return path;
 }
 
 std::string TempPath::release() {
   std::string path = path_;
   path_ = std::string();
+  deferred_ = false;
   return path;
 }
 
+PosixErrorOr<std::unique_ptr<TmpfsTestTmpdir>> TmpfsTestTmpdir::Create() {
+  const std::string path = NewTempAbsPath();
+  RETURN_IF_ERRNO(Mkdir(path, TempPath::kDefaultDirMode));
+  if (mount("", path.c_str(), "tmpfs", 0, "mode=0777") < 0) {
+    const int err = errno;
+    rmdir(path.c_str());
+    return PosixError(err, absl::StrCat("mount tmpfs on ", path));
+  }
+
+  absl::MutexLock lock(&tmpfs_tmpdir_mu);
+  if (tmpfs_tmpdir != nullptr) {
+    umount2(path.c_str(), MNT_DETACH);
+    rmdir(path.c_str());
+    return PosixError(EEXIST, "a TmpfsTestTmpdir already exists");
+  }
+  tmpfs_tmpdir = new std::string(path);
+  return absl::WrapUnique(new TmpfsTestTmpdir(path));
+}
+
+TmpfsTestTmpdir::~TmpfsTestTmpdir() {
+  {
+    absl::MutexLock lock(&tmpfs_tmpdir_mu);
+    delete tmpfs_tmpdir;
+    tmpfs_tmpdir = nullptr;
+  }
+  if (umount2(path_.c_str(), MNT_DETACH) < 0 || rmdir(path_.c_str()) < 0) {
+    std::cerr << path_ << ": failed to unmount and delete: "
+              << PosixError(errno) << std::endl;
+  }
+}
+
 }  // namespace testing
 }  // namespace gvisor
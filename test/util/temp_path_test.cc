@@ -0,0 +1,111 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/util/temp_path.h"
+
+#include <errno.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "absl/strings/match.h"
+#include "test/util/fs_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+TEST(TempPathTest, DeletedOnDestruction) {
+  std::string path;
+  {
+    const TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+    path = file.path();
+    EXPECT_TRUE(ASSERT_NO_ERRNO_AND_VALUE(Exists(path)));
+  }
+  EXPECT_FALSE(ASSERT_NO_ERRNO_AND_VALUE(Exists(path)));
+}
+
+// NewTmpfsTestTmpdir returns a TmpfsTestTmpdir, or nullptr if mounting a
+// tmpfs isn't permitted.
+std::unique_ptr<TmpfsTestTmpdir> NewTmpfsTestTmpdir() {
+  PosixErrorOr<std::unique_ptr<TmpfsTestTmpdir>> tmpdir =
+      TmpfsTestTmpdir::Create();
+  if (!tmpdir.ok()) {
+    EXPECT_EQ(tmpdir.error().errno_value(), EPERM);
+    return nullptr;
+  }
+  return std::move(tmpdir).ValueOrDie();
+}
+
+TEST(TmpfsTestTmpdirTest, DefersDeletionToUnmount) {
+  const std::string orig_tmpdir = GetAbsoluteTestTmpdir();
+  auto tmpdir = NewTmpfsTestTmpdir();
+  if (tmpdir == nullptr) {
+    GTEST_SKIP() << "mounting tmpfs not permitted";
+  }
+  const std::string tmpfs = tmpdir->path();
+  EXPECT_TRUE(absl::StartsWith(tmpfs, orig_tmpdir));
+  EXPECT_EQ(GetAbsoluteTestTmpdir(), tmpfs);
+
+  // Only one may exist at a time.
+  EXPECT_THAT(TmpfsTestTmpdir::Create(), PosixErrorIs(EEXIST));
+
+  std::string file_path;
+  {
+    TempPath dir = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateDir());
+    const TempPath file =
+        ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFileIn(dir.path()));
+    file_path = file.path();
+    EXPECT_TRUE(absl::StartsWith(file_path, tmpfs));
+
+    // Moved TempPaths keep deferring deletion.
+    const TempPath moved = std::move(dir);
+  }
+  EXPECT_TRUE(ASSERT_NO_ERRNO_AND_VALUE(Exists(file_path)));
+
+  // TempPaths elsewhere are still deleted.
+  std::string other_path;
+  {
+    const TempPath other =
+        ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFileIn(orig_tmpdir));
+    other_path = other.path();
+  }
+  EXPECT_FALSE(ASSERT_NO_ERRNO_AND_VALUE(Exists(other_path)));
+
+  tmpdir.reset();
+  EXPECT_FALSE(ASSERT_NO_ERRNO_AND_VALUE(Exists(tmpfs)));
+  EXPECT_EQ(GetAbsoluteTestTmpdir(), orig_tmpdir);
+}
+
+TEST(TmpfsTestTmpdirTest, ResetDeletes) {
+  auto tmpdir = NewTmpfsTestTmpdir();
+  if (tmpdir == nullptr) {
+    GTEST_SKIP() << "mounting tmpfs not permitted";
+  }
+
+  TempPath file = ASSERT_NO_ERRNO_AND_VALUE(TempPath::CreateFile());
+  const std::string path = file.reset();
+  EXPECT_TRUE(absl::StartsWith(path, tmpdir->path()));
+  EXPECT_FALSE(ASSERT_NO_ERRNO_AND_VALUE(Exists(path)));
+}
+
+}  // namespace
+
+}  // namespace testing
+}  // namespace gvisor
@@ -23,6 +23,7 @@
 #include <sys/utsname.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <ctime>
 #include <iostream>
@@ -44,31 +45,40 @@ namespace testing {
 constexpr char kGvisorNetwork[] = "GVISOR_NETWORK";
 constexpr char kIOUringEnabled[] = "IOURING_ENABLED";
 
-bool IsRunningOnGvisor() { return GvisorPlatform() != Platform::kNative; }
+namespace {
 
-const std::string GvisorPlatform() {
+TestEnvironment ReadTestEnvironment() {
+  TestEnvironment env;
   // Set by runner.go.
-  const char* env = getenv(kTestOnGvisor);
-  if (!env) {
-    return Platform::kNative;
-  }
-  return std::string(env);
+  const char* platform = getenv(kTestOnGvisor);
+  env.platform = platform != nullptr ? platform : Platform::kNative;
+  env.on_gvisor = env.platform != Platform::kNative;
+  const char* runtime = getenv(kGvisorRuntime);
+  env.on_runsc = runtime != nullptr && strcmp(runtime, "runsc") == 0;
+  const char* network = getenv(kGvisorNetwork);
+  env.hostinet = network != nullptr && strcmp(network, "host") == 0;
+  const char* iouring = getenv(kIOUringEnabled);
+  env.iouring_enabled = iouring != nullptr && strcmp(iouring, "TRUE") == 0;
+  return env;
 }
 
-bool IsRunningOnRunsc() {
-  const char* env = getenv(kGvisorRuntime);
-  return env && strcmp(env, "runsc") == 0;
-}
+}  // namespace
 
-bool IsRunningWithHostinet() {
-  const char* env = getenv(kGvisorNetwork);
-  return env && strcmp(env, "host") == 0;
+const TestEnvironment& GetTestEnvironment() {
+  static const TestEnvironment* env =
+      new TestEnvironment(ReadTestEnvironment());
+  return *env;
 }
 
-bool IsIOUringEnabled() {
-  const char* env = getenv(kIOUringEnabled);
-  return env && strcmp(env, "TRUE") == 0;
-}
+bool IsRunningOnGvisor() { return GetTestEnvironment().on_gvisor; }
+
+const std::string GvisorPlatform() { return GetTestEnvironment().platform; }
+
+bool IsRunningOnRunsc() { return GetTestEnvironment().on_runsc; }
+
+bool IsRunningWithHostinet() { return GetTestEnvironment().hostinet; }
+
+bool IsIOUringEnabled() { return GetTestEnvironment().iouring_enabled; }
 
 // Inline cpuid instruction.  Preserve %ebx/%rbx register. In PIC compilations
 // %ebx contains the address of the global offset table. %rbx is occasionally
@@ -191,9 +201,22 @@ PosixErrorOr<uint64_t> Links(const std::string& path) {
 void RandomizeBuffer(char* buffer, size_t len) {
   struct timespec ts = {};
   clock_gettime(CLOCK_MONOTONIC, &ts);
-  uint32_t seed = static_cast<uint32_t>(ts.tv_nsec);
-  for (size_t i = 0; i < len; i++) {
-    buffer[i] = rand_r(&seed) % 255;
+  uint64_t state = static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+
+  // Large payloads are filled in tight loops, so produce 8 bytes per step with
+  // splitmix64 rather than calling rand_r for every byte.
+  auto next = [&state] {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  };
+  while (len > 0) {
+    uint64_t v = next();
+    size_t n = std::min(len, sizeof(v));
+    memcpy(buffer, &v, n);
+    buffer += n;
+    len -= n;
   }
 }
 
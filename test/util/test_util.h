@@ -232,6 +232,24 @@ constexpr char kStarnix[] = "starnix";
 constexpr char kSystrap[] = "systrap";
 }  // namespace Platform
 
+// TestEnvironment describes the environment that tests run in, as set up by
+// the test runner. It doesn't change while tests run, so it is read once, by
+// TestInit, and the functions below are cheap enough to call from hot paths
+// like benchmark loops.
+struct TestEnvironment {
+  // A Platform name.
+  std::string platform;
+
+  bool on_gvisor;
+  bool on_runsc;
+  bool hostinet;
+  bool iouring_enabled;
+};
+
+// GetTestEnvironment returns the test environment, reading it on the first
+// call.
+const TestEnvironment& GetTestEnvironment();
+
 bool IsRunningOnGvisor();
 bool IsRunningOnRunsc();
 const std::string GvisorPlatform();
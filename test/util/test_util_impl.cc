@@ -12,17 +12,93 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "benchmark/benchmark.h"
+#include "test/util/fs_util.h"
 #include "test/util/logging.h"
+#include "test/util/save_util.h"
+#include "test/util/test_util.h"
+
+ABSL_FLAG(int32_t, test_parallelism, 1,
+          "If greater than 1, run each selected test case in its own forked "
+          "process, with up to this many running at once.");
+
+ABSL_FLAG(bool, pmu_counters, false,
+          "Report hardware and scheduler counters per iteration for every "
+          "benchmark, as with --benchmark_perf_counters. Requires a build "
+          "with --config=perf_counters. Counters that can't be opened, e.g. "
+          "in a sandbox without perf_event_open(2), are skipped with a "
+          "warning.");
+
+ABSL_FLAG(bool, stable_benchmarks, false,
+          "Configure benchmarks for repeatable results. Unless set explicitly, "
+          "--benchmark_min_warmup_time defaults to 0.5, "
+          "--benchmark_repetitions to 10, "
+          "--benchmark_enable_random_interleaving to true and --pin_cpus to "
+          "auto. Only aggregates are reported, including the median absolute "
+          "deviation (mad), and benchmarks whose real time coefficient of "
+          "variation exceeds --stable_max_cv are reported as errors. Also "
+          "enabled by setting TEST_STABLE_BENCHMARKS=1 in the environment, "
+          "which the test runner passes through to the test.");
+
+ABSL_FLAG(double, stable_max_cv, 0.05,
+          "With --stable_benchmarks, the largest coefficient of variation of "
+          "the real time of a benchmark's repetitions for which results are "
+          "reported.");
+
+ABSL_FLAG(std::string, pin_cpus, "",
+          "If set, pin benchmarks, including their threads and child "
+          "processes, to these CPUs, as a list of CPUs and ranges such as "
+          "0,2-3, or auto for all allowed CPUs except CPU 0, which typically "
+          "handles most of the host's interrupts.");
+
+ABSL_FLAG(std::string, sentry_profiles, "",
+          "Comma-separated kinds of sentry profile, cpu and/or mutex, to "
+          "collect for each benchmark through /proc/gvisor/profile, which "
+          "requires running in gVisor with -profile -profile-app-trigger. "
+          "Profiles are written to --sentry_profile_dir as "
+          "<benchmark>.<kind>.pprof. Also set by TEST_SENTRY_PROFILES in the "
+          "environment, for which the test runner enables these runsc "
+          "flags.");
+
+ABSL_FLAG(std::string, sentry_profile_dir, "",
+          "Directory in which --sentry_profiles are written. Defaults to "
+          "TEST_UNDECLARED_OUTPUTS_DIR.");
 
 extern bool FLAGS_gtest_list_tests;
 namespace benchmark {
 extern bool FLAGS_benchmark_list_tests;
+extern bool FLAGS_benchmark_enable_random_interleaving;
+extern double FLAGS_benchmark_min_warmup_time;
+extern int32_t FLAGS_benchmark_repetitions;
+extern std::string FLAGS_benchmark_perf_counters;
 }
 
 namespace gvisor {
@@ -30,17 +106,566 @@ namespace testing {
 
 void SetupGvisorDeathTest() {}
 
+namespace {
+
+// Counters reported by --pmu_counters, named as for libpfm's perf_events PMU:
+// cycles, instructions, last-level cache read misses, data TLB read misses
+// and context switches.
+constexpr char kPMUCounters[] =
+    "CYCLES,INSTRUCTIONS,perf::PERF_COUNT_HW_CACHE_LL:READ:MISS,"
+    "perf::PERF_COUNT_HW_CACHE_DTLB:READ:MISS,"
+    "perf::PERF_COUNT_SW_CONTEXT_SWITCHES";
+
+}  // namespace
+
 void TestInit(int* argc, char*** argv) {
   ::testing::InitGoogleTest(argc, *argv);
   benchmark::Initialize(argc, *argv);
   ::absl::ParseCommandLine(*argc, *argv);
 
+  // An explicit --benchmark_perf_counters takes precedence.
+  if (absl::GetFlag(FLAGS_pmu_counters) &&
+      benchmark::FLAGS_benchmark_perf_counters.empty()) {
+    benchmark::FLAGS_benchmark_perf_counters = kPMUCounters;
+  }
+
+  // Flags at their default values are taken to be unset.
+  if (const char* stable = getenv("TEST_STABLE_BENCHMARKS");
+      stable != nullptr && strcmp(stable, "1") == 0) {
+    absl::SetFlag(&FLAGS_stable_benchmarks, true);
+  }
+  if (absl::GetFlag(FLAGS_sentry_profiles).empty()) {
+    if (const char* profiles = getenv("TEST_SENTRY_PROFILES")) {
+      absl::SetFlag(&FLAGS_sentry_profiles, profiles);
+    }
+  }
+  if (absl::GetFlag(FLAGS_sentry_profile_dir).empty()) {
+    if (const char* dir = getenv("TEST_UNDECLARED_OUTPUTS_DIR")) {
+      absl::SetFlag(&FLAGS_sentry_profile_dir, dir);
+    }
+  }
+  if (absl::GetFlag(FLAGS_stable_benchmarks)) {
+    if (benchmark::FLAGS_benchmark_min_warmup_time == 0) {
+      benchmark::FLAGS_benchmark_min_warmup_time = 0.5;
+    }
+    if (benchmark::FLAGS_benchmark_repetitions == 1) {
+      benchmark::FLAGS_benchmark_repetitions = 10;
+    }
+    benchmark::FLAGS_benchmark_enable_random_interleaving = true;
+    if (absl::GetFlag(FLAGS_pin_cpus).empty()) {
+      absl::SetFlag(&FLAGS_pin_cpus, "auto");
+    }
+  }
+
+  // Read the environment before tests start threads that probe it.
+  GetTestEnvironment();
+
   // Always mask SIGPIPE as it's common and tests aren't expected to handle it.
   struct sigaction sa = {};
   sa.sa_handler = SIG_IGN;
   TEST_CHECK(sigaction(SIGPIPE, &sa, nullptr) == 0);
 }
 
+namespace {
+
+// GlobMatch reports whether name matches the gtest filter pattern, in which '*'
+// matches any string and '?' matches any single character.
+bool GlobMatch(absl::string_view pattern, absl::string_view name) {
+  size_t p = 0, n = 0;
+  // Position after the last '*' seen, and the name position it matched up to.
+  size_t star = absl::string_view::npos, star_n = 0;
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      p++;
+      n++;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = ++p;
+      star_n = n;
+    } else if (star != absl::string_view::npos) {
+      p = star;
+      n = ++star_n;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    p++;
+  }
+  return p == pattern.size();
+}
+
+bool MatchesAnyGlob(absl::string_view patterns, absl::string_view name) {
+  for (absl::string_view pattern : absl::StrSplit(patterns, ':')) {
+    if (GlobMatch(pattern, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// MatchesFilter implements --gtest_filter: a ':'-separated list of positive
+// patterns, optionally followed by '-' and a list of negative patterns.
+bool MatchesFilter(absl::string_view filter, absl::string_view name) {
+  absl::string_view positive = filter;
+  absl::string_view negative;
+  size_t dash = filter.find('-');
+  if (dash != absl::string_view::npos) {
+    positive = filter.substr(0, dash);
+    negative = filter.substr(dash + 1);
+  }
+  if (positive.empty()) {
+    positive = "*";
+  }
+  return MatchesAnyGlob(positive, name) && !MatchesAnyGlob(negative, name);
+}
+
+int EnvInt(const char* name, int def) {
+  const char* val = getenv(name);
+  return val != nullptr ? atoi(val) : def;
+}
+
+// SelectedTests returns the full names of the test cases that RUN_ALL_TESTS
+// would run in this shard, in the same order.
+std::vector<std::string> SelectedTests() {
+  const std::string filter = ::testing::GTEST_FLAG(filter);
+  const bool run_disabled = ::testing::GTEST_FLAG(also_run_disabled_tests);
+  const int total_shards = EnvInt("GTEST_TOTAL_SHARDS", 1);
+  const int shard_index = EnvInt("GTEST_SHARD_INDEX", 0);
+
+  std::vector<std::string> names;
+  const ::testing::UnitTest& unit_test = *::testing::UnitTest::GetInstance();
+  int selected = 0;
+  for (int i = 0; i < unit_test.total_test_suite_count(); i++) {
+    const ::testing::TestSuite& suite = *unit_test.GetTestSuite(i);
+    for (int j = 0; j < suite.total_test_count(); j++) {
+      const ::testing::TestInfo& info = *suite.GetTestInfo(j);
+      std::string name = absl::StrCat(suite.name(), ".", info.name());
+      if (!run_disabled && (absl::StartsWith(suite.name(), "DISABLED_") ||
+                            absl::StartsWith(info.name(), "DISABLED_"))) {
+        continue;
+      }
+      if (!MatchesFilter(filter, name)) {
+        continue;
+      }
+      // gtest assigns filtered tests to shards round-robin.
+      if (selected++ % total_shards == shard_index) {
+        names.push_back(std::move(name));
+      }
+    }
+  }
+  return names;
+}
+
+// Prints the save cycles performed by this process, if any, as the last line
+// of its test output.
+void PrintSaveStats() {
+  const std::string summary = SaveStatsSummary();
+  if (!summary.empty()) {
+    printf("[   SAVE   ] %s.\n", summary.c_str());
+    fflush(stdout);
+  }
+}
+
+// Copies the contents of fd to stdout.
+void DumpOutput(int fd) {
+  fflush(stdout);
+  TEST_PCHECK(lseek(fd, 0, SEEK_SET) == 0);
+  char buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) {
+    TEST_PCHECK(write(STDOUT_FILENO, buf, n) == n);
+  }
+  TEST_PCHECK(n == 0);
+}
+
+// RunTestsInParallel runs each selected test case in a forked child, with up
+// to parallelism children at once. Each child's output is buffered and
+// printed when it exits, so that output from different test cases does not
+// interleave. Returns the RUN_ALL_TESTS result for the whole run.
+//
+// Test cases run concurrently must not share host state, such as fixed paths
+// or ports, so this is opt-in.
+int RunTestsInParallel(int parallelism) {
+  const std::vector<std::string> tests = SelectedTests();
+
+  // Tell the test runner that sharding is supported, as gtest would.
+  if (const char* status_file = getenv("TEST_SHARD_STATUS_FILE")) {
+    int fd = open(status_file, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    TEST_PCHECK(fd >= 0);
+    close(fd);
+  }
+
+  struct Child {
+    size_t test;
+    int output_fd;
+  };
+  absl::flat_hash_map<pid_t, Child> running;
+  std::vector<std::string> failed;
+  size_t next = 0;
+
+  printf("[==========] Running %zu tests in up to %d processes.\n",
+         tests.size(), parallelism);
+  while (next < tests.size() || !running.empty()) {
+    while (next < tests.size() &&
+           running.size() < static_cast<size_t>(parallelism)) {
+      int output_fd = memfd_create("test-output", MFD_CLOEXEC);
+      TEST_PCHECK(output_fd >= 0);
+      fflush(stdout);
+      fflush(stderr);
+      pid_t pid = fork();
+      TEST_PCHECK(pid >= 0);
+      if (pid == 0) {
+        TEST_PCHECK(dup2(output_fd, STDOUT_FILENO) == STDOUT_FILENO);
+        TEST_PCHECK(dup2(output_fd, STDERR_FILENO) == STDERR_FILENO);
+        // The child runs exactly one test, so it must not be sharded again,
+        // and must not overwrite the run's XML output.
+        unsetenv("GTEST_TOTAL_SHARDS");
+        unsetenv("GTEST_SHARD_INDEX");
+        unsetenv("TEST_SHARD_STATUS_FILE");
+        ::testing::TestEventListeners& listeners =
+            ::testing::UnitTest::GetInstance()->listeners();
+        delete listeners.Release(listeners.default_xml_generator());
+        ::testing::GTEST_FLAG(filter) = tests[next];
+        int rc = RUN_ALL_TESTS();
+        PrintSaveStats();
+        fflush(stdout);
+        fflush(stderr);
+        _exit(rc);
+      }
+      running[pid] = Child{next++, output_fd};
+    }
+
+    int status;
+    pid_t pid = RetryEINTR(waitpid)(-1, &status, 0);
+    TEST_PCHECK(pid > 0);
+    auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+    const Child child = it->second;
+    running.erase(it);
+    DumpOutput(child.output_fd);
+    close(child.output_fd);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failed.push_back(tests[child.test]);
+    }
+  }
+
+  printf("[==========] %zu tests ran.\n", tests.size());
+  printf("[  PASSED  ] %zu tests.\n", tests.size() - failed.size());
+  if (!failed.empty()) {
+    printf("[  FAILED  ] %zu tests, listed below:\n", failed.size());
+    for (const std::string& name : failed) {
+      printf("[  FAILED  ] %s\n", name.c_str());
+    }
+  }
+  fflush(stdout);
+  return failed.empty() ? 0 : 1;
+}
+
+// PinCPUs pins the calling thread, and so the threads and processes that it
+// creates, as described by --pin_cpus.
+void PinCPUs(const std::string& cpus) {
+  cpu_set_t set;
+  TEST_PCHECK(sched_getaffinity(0, sizeof(set), &set) == 0);
+  if (cpus == "auto") {
+    if (CPU_COUNT(&set) > 1) {
+      CPU_CLR(0, &set);
+    }
+  } else {
+    CPU_ZERO(&set);
+    for (absl::string_view range : absl::StrSplit(cpus, ',')) {
+      std::pair<absl::string_view, absl::string_view> bounds =
+          absl::StrSplit(range, absl::MaxSplits('-', 1));
+      int first = 0, last = 0;
+      bool ok = absl::SimpleAtoi(bounds.first, &first);
+      if (bounds.second.empty()) {
+        last = first;
+      } else {
+        ok = ok && absl::SimpleAtoi(bounds.second, &last);
+      }
+      TEST_CHECK_MSG(ok && first >= 0 && first <= last && last < CPU_SETSIZE,
+                     "invalid --pin_cpus");
+      for (int cpu = first; cpu <= last; cpu++) {
+        CPU_SET(cpu, &set);
+      }
+    }
+  }
+  TEST_PCHECK(sched_setaffinity(0, sizeof(set), &set) == 0);
+  printf("Benchmarks pinned to %s\n", CPUSetToString(set).c_str());
+  fflush(stdout);
+}
+
+double Median(std::vector<double> v) {
+  std::sort(v.begin(), v.end());
+  const size_t n = v.size();
+  return n % 2 == 1 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+// MedianAbsoluteDeviation returns the median of the absolute deviations of v
+// from its median, which unlike the standard deviation isn't dominated by a
+// few outliers.
+double MedianAbsoluteDeviation(const std::vector<double>& v) {
+  const double median = Median(v);
+  std::vector<double> deviations;
+  deviations.reserve(v.size());
+  for (double x : v) {
+    deviations.push_back(std::abs(x - median));
+  }
+  return Median(deviations);
+}
+
+// StableReporter implements --stable_benchmarks on top of another reporter.
+// For each benchmark with repetitions, it reports only the aggregates, adds
+// the median absolute deviation, and replaces them with an error if the
+// repetitions vary by more than --stable_max_cv.
+//
+// Google Benchmark reports the repetitions of a benchmark and then their
+// aggregates in separate calls to ReportRuns, so the repetitions are held
+// until the aggregates arrive.
+class StableReporter : public benchmark::BenchmarkReporter {
+ public:
+  StableReporter(benchmark::BenchmarkReporter* reporter, double max_cv)
+      : reporter_(reporter), max_cv_(max_cv) {}
+
+  bool ReportContext(const Context& context) override {
+    return reporter_->ReportContext(context);
+  }
+
+  void ReportRuns(const std::vector<Run>& report) override;
+
+  void Finalize() override {
+    Flush();
+    reporter_->Finalize();
+  }
+
+  // Unstable returns true if the results of any benchmark were rejected.
+  bool Unstable() const { return unstable_; }
+
+ private:
+  // Flush reports held repetitions that had no aggregates, e.g. because
+  // there was only one.
+  void Flush() {
+    if (!repetitions_.empty()) {
+      reporter_->ReportRuns(repetitions_);
+      repetitions_.clear();
+    }
+  }
+
+  benchmark::BenchmarkReporter* const reporter_;
+  const double max_cv_;
+  std::vector<Run> repetitions_;
+  bool unstable_ = false;
+};
+
+void StableReporter::ReportRuns(const std::vector<Run>& report) {
+  const auto it = std::find_if(report.begin(), report.end(), [](const Run& r) {
+    return r.run_type == Run::RT_Aggregate && r.aggregate_name == "median";
+  });
+  if (it == report.end()) {
+    Flush();
+    repetitions_ = report;
+    return;
+  }
+  const Run& median = *it;
+
+  std::vector<double> real, cpu;
+  for (const Run& run : repetitions_) {
+    if (run.run_type == Run::RT_Iteration &&
+        run.skipped == benchmark::internal::NotSkipped) {
+      real.push_back(run.real_accumulated_time / run.iterations);
+      cpu.push_back(run.cpu_accumulated_time / run.iterations);
+    }
+  }
+  repetitions_.clear();
+  if (real.size() < 2) {
+    reporter_->ReportRuns(report);
+    return;
+  }
+
+  double mean = 0;
+  for (double x : real) {
+    mean += x;
+  }
+  mean /= real.size();
+  double variance = 0;
+  for (double x : real) {
+    variance += (x - mean) * (x - mean);
+  }
+  variance /= real.size() - 1;
+  const double cv = mean > 0 ? std::sqrt(variance) / mean : 0;
+
+  if (cv > max_cv_) {
+    Run error = median;
+    error.aggregate_name = "unstable";
+    error.skipped = benchmark::internal::SkippedWithError;
+    error.skip_message =
+        absl::StrCat("real time coefficient of variation ", cv * 100,
+                     "% exceeds --stable_max_cv=", max_cv_ * 100, "%");
+    unstable_ = true;
+    reporter_->ReportRuns({error});
+    return;
+  }
+
+  // Reporters divide the accumulated times of aggregates by their iteration
+  // count, which is the number of repetitions.
+  std::vector<Run> aggregates = report;
+  Run mad = median;
+  mad.aggregate_name = "mad";
+  mad.real_accumulated_time = MedianAbsoluteDeviation(real) * mad.iterations;
+  mad.cpu_accumulated_time = MedianAbsoluteDeviation(cpu) * mad.iterations;
+  mad.counters.clear();
+  aggregates.push_back(mad);
+  reporter_->ReportRuns(aggregates);
+}
+
+// SentryProfileReporter implements --sentry_profiles on top of another
+// reporter, by collecting a profile of each benchmark through
+// /proc/gvisor/profile.
+//
+// Google Benchmark has no hook around the measured loop of a benchmark, so a
+// profile runs from when the previous benchmark was reported until this one
+// is, which also covers its setup and the runs used to pick its iteration
+// count. With --benchmark_enable_random_interleaving, repetitions of other
+// benchmarks are included too.
+class SentryProfileReporter : public benchmark::BenchmarkReporter {
+ public:
+  SentryProfileReporter(benchmark::BenchmarkReporter* reporter,
+                        std::vector<std::string> kinds, std::string dir)
+      : reporter_(reporter),
+        kinds_(std::move(kinds)),
+        dir_(std::move(dir)),
+        fds_(kinds_.size(), -1) {}
+
+  bool ReportContext(const Context& context) override {
+    const bool ok = reporter_->ReportContext(context);
+    Start();
+    return ok;
+  }
+
+  void ReportRuns(const std::vector<Run>& report) override {
+    // Aggregates of repetitions are reported separately, after them.
+    if (!report.empty() && report[0].run_type == Run::RT_Iteration) {
+      Save(report[0].benchmark_name());
+      Start();
+    }
+    reporter_->ReportRuns(report);
+  }
+
+  void Finalize() override {
+    // Closing the files discards the profiles.
+    for (int& fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    reporter_->Finalize();
+  }
+
+ private:
+  void Start();
+  void Save(const std::string& name);
+
+  benchmark::BenchmarkReporter* const reporter_;
+  std::vector<std::string> kinds_;
+  const std::string dir_;
+
+  // fds_[i] is the /proc/gvisor/profile file collecting a profile of kind
+  // kinds_[i], or -1.
+  std::vector<int> fds_;
+};
+
+void SentryProfileReporter::Start() {
+  for (size_t i = 0; i < kinds_.size(); i++) {
+    const int fd = open("/proc/gvisor/profile", O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+      fprintf(stderr,
+              "Not collecting sentry profiles: /proc/gvisor/profile: %s. "
+              "Run in gVisor with -profile -profile-app-trigger.\n",
+              strerror(errno));
+      kinds_.clear();
+      fds_.clear();
+      return;
+    }
+    const std::string& kind = kinds_[i];
+    if (WriteFd(fd, kind.data(), kind.size()) !=
+        static_cast<ssize_t>(kind.size())) {
+      // e.g. EBUSY if a CPU profile is already being collected.
+      fprintf(stderr, "Failed to start %s profile of the sentry: %s\n",
+              kind.c_str(), strerror(errno));
+      close(fd);
+      continue;
+    }
+    fds_[i] = fd;
+  }
+}
+
+void SentryProfileReporter::Save(const std::string& name) {
+  for (size_t i = 0; i < kinds_.size(); i++) {
+    if (fds_[i] < 0) {
+      continue;
+    }
+    // Reading stops the profile.
+    std::string profile;
+    TEST_CHECK_NO_ERRNO(GetContentsFD(fds_[i], &profile));
+    close(fds_[i]);
+    fds_[i] = -1;
+    std::string file = absl::StrCat(name, ".", kinds_[i], ".pprof");
+    std::replace(file.begin(), file.end(), '/', '_');
+    TEST_CHECK_NO_ERRNO(SetContents(JoinPath(dir_, file), profile));
+  }
+}
+
+// RunBenchmarks runs the selected benchmarks, and returns false if any were
+// rejected by --stable_benchmarks.
+bool RunBenchmarks() {
+  // Record the network stack in the context printed with the results, so
+  // that results of the netstack and hostinet variants of socket benchmarks
+  // can be told apart.
+  const char* network = "native";
+  if (IsRunningOnGvisor()) {
+    network = IsRunningWithHostinet() ? "hostinet" : "netstack";
+  }
+  benchmark::AddCustomContext("network", network);
+
+  const std::string pin_cpus = absl::GetFlag(FLAGS_pin_cpus);
+  if (!pin_cpus.empty()) {
+    PinCPUs(pin_cpus);
+  }
+
+  benchmark::BenchmarkReporter* reporter = nullptr;
+  std::unique_ptr<StableReporter> stable;
+  if (absl::GetFlag(FLAGS_stable_benchmarks)) {
+    stable = std::make_unique<StableReporter>(
+        benchmark::CreateDefaultDisplayReporter(),
+        absl::GetFlag(FLAGS_stable_max_cv));
+    reporter = stable.get();
+  }
+  std::unique_ptr<SentryProfileReporter> profiler;
+  const std::string profiles = absl::GetFlag(FLAGS_sentry_profiles);
+  if (!profiles.empty()) {
+    const std::string dir = absl::GetFlag(FLAGS_sentry_profile_dir);
+    TEST_CHECK_MSG(!dir.empty(),
+                   "--sentry_profiles requires --sentry_profile_dir");
+    std::vector<std::string> kinds = absl::StrSplit(profiles, ',');
+    profiler = std::make_unique<SentryProfileReporter>(
+        reporter != nullptr ? reporter
+                            : benchmark::CreateDefaultDisplayReporter(),
+        std::move(kinds), dir);
+    reporter = profiler.get();
+  }
+
+  if (reporter == nullptr) {
+    benchmark::RunSpecifiedBenchmarks();
+  } else {
+    benchmark::RunSpecifiedBenchmarks(reporter);
+  }
+  return stable == nullptr || !stable->Unstable();
+}
+
+}  // namespace
+
 int RunAllTests() {
   if (::testing::FLAGS_gtest_list_tests) {
     return RUN_ALL_TESTS();
@@ -51,8 +676,12 @@ int RunAllTests() {
   }
 
   // Run selected tests & benchmarks.
-  int rc = RUN_ALL_TESTS();
-  benchmark::RunSpecifiedBenchmarks();
+  const int parallelism = absl::GetFlag(FLAGS_test_parallelism);
+  int rc = parallelism > 1 ? RunTestsInParallel(parallelism) : RUN_ALL_TESTS();
+  if (!RunBenchmarks() && rc == 0) {
+    rc = 1;
+  }
+  PrintSaveStats();
   return rc;
 }
 
@@ -15,6 +15,7 @@
 #include "test/util/test_util.h"
 
 #include <errno.h>
+#include <stdlib.h>
 
 #include <vector>
 
@@ -248,6 +249,17 @@ TEST(GenerateIovecs, WrapsAtIovMax) {
       IovecsListEq(expected));
 }
 
+TEST(TestEnvironmentTest, MatchesProbes) {
+  const TestEnvironment& env = GetTestEnvironment();
+  EXPECT_EQ(&GetTestEnvironment(), &env);
+  EXPECT_EQ(env.platform, GvisorPlatform());
+  EXPECT_EQ(env.on_gvisor, IsRunningOnGvisor());
+  EXPECT_EQ(env.on_gvisor, getenv(kTestOnGvisor) != nullptr);
+  EXPECT_EQ(env.on_runsc, IsRunningOnRunsc());
+  EXPECT_EQ(env.hostinet, IsRunningWithHostinet());
+  EXPECT_EQ(env.iouring_enabled, IsIOUringEnabled());
+}
+
 }  // namespace
 
 }  // namespace testing
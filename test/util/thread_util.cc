@@ -0,0 +1,115 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "test/util/thread_util.h"
+
+#include <sched.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "test/util/cleanup.h"
+#include "test/util/fs_util.h"
+#include "test/util/posix_error.h"
+#include "test/util/test_util.h"
+
+namespace gvisor {
+namespace testing {
+
+namespace {
+
+struct CPUTopology {
+  int cpu;
+  int core;
+  int package;
+};
+
+PosixErrorOr<int> ReadTopologyID(int cpu, absl::string_view name) {
+  ASSIGN_OR_RETURN_ERRNO(
+      std::string contents,
+      GetContents(absl::StrCat("/sys/devices/system/cpu/cpu", cpu,
+                               "/topology/", name)));
+  int id;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(contents), &id)) {
+    return PosixError(EINVAL, absl::StrCat("bad topology ", name, " for cpu ",
+                                           cpu, ": ", contents));
+  }
+  return id;
+}
+
+}  // namespace
+
+PosixErrorOr<std::pair<int, int>> CPUPairAtDistance(CPUDistance distance) {
+  cpu_set_t set;
+  RETURN_ERROR_IF_SYSCALL_FAIL(sched_getaffinity(0, sizeof(set), &set));
+
+  std::vector<CPUTopology> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, &set)) {
+      continue;
+    }
+    ASSIGN_OR_RETURN_ERRNO(int core, ReadTopologyID(cpu, "core_id"));
+    ASSIGN_OR_RETURN_ERRNO(int package,
+                           ReadTopologyID(cpu, "physical_package_id"));
+    cpus.push_back({cpu, core, package});
+  }
+
+  for (size_t i = 0; i < cpus.size(); i++) {
+    for (size_t j = i + 1; j < cpus.size(); j++) {
+      const CPUTopology& a = cpus[i];
+      const CPUTopology& b = cpus[j];
+      bool match = false;
+      switch (distance) {
+        case CPUDistance::kSameCore:
+          match = a.package == b.package && a.core == b.core;
+          break;
+        case CPUDistance::kSamePackage:
+          match = a.package == b.package && a.core != b.core;
+          break;
+        case CPUDistance::kCrossPackage:
+          match = a.package != b.package;
+          break;
+      }
+      if (match) {
+        return std::make_pair(a.cpu, b.cpu);
+      }
+    }
+  }
+  return PosixError(ENOENT, absl::StrCat("no CPU pair at distance ",
+                                         static_cast<int>(distance), " in ",
+                                         CPUSetToString(set)));
+}
+
+cpu_set_t SingleCPUSet(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return set;
+}
+
+PosixErrorOr<Cleanup> ScopedPinCurrentThread(const cpu_set_t& cpus) {
+  cpu_set_t old;
+  RETURN_ERROR_IF_SYSCALL_FAIL(sched_getaffinity(0, sizeof(old), &old));
+  RETURN_ERROR_IF_SYSCALL_FAIL(sched_setaffinity(0, sizeof(cpus), &cpus));
+  return Cleanup([old] {
+    TEST_PCHECK(sched_setaffinity(0, sizeof(old), &old) == 0);
+  });
+}
+
+}  // namespace testing
+}  // namespace gvisor
@@ -16,6 +16,7 @@
 #define GVISOR_TEST_UTIL_THREAD_UTIL_H_
 
 #include <pthread.h>
+#include <sched.h>
 #ifdef __linux__
 #include <sys/syscall.h>
 #endif
@@ -24,7 +25,9 @@
 #include <functional>
 #include <utility>
 
+#include "test/util/cleanup.h"
 #include "test/util/logging.h"
+#include "test/util/posix_error.h"
 
 namespace gvisor {
 namespace testing {
@@ -50,6 +53,22 @@ class ScopedThread {
     CreateThread();
   }
 
+#ifdef __linux__
+  // Constructs a thread that executes f exactly once, pinned to cpus from the
+  // start.
+  ScopedThread(const cpu_set_t& cpus, const std::function<void()>& f) {
+    f_ = [=] {
+      f();
+      return nullptr;
+    };
+    pthread_attr_t attr;
+    TEST_PCHECK(pthread_attr_init(&attr) == 0);
+    TEST_PCHECK(pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) == 0);
+    CreateThread(&attr);
+    TEST_PCHECK(pthread_attr_destroy(&attr) == 0);
+  }
+#endif
+
   ScopedThread(const ScopedThread& other) = delete;
   ScopedThread& operator=(const ScopedThread& other) = delete;
 
@@ -67,9 +86,9 @@ class ScopedThread {
   }
 
  private:
-  void CreateThread() {
+  void CreateThread(const pthread_attr_t* attr = nullptr) {
     TEST_PCHECK_MSG(pthread_create(
-                        &pt_, /* attr = */ nullptr,
+                        &pt_, attr,
                         +[](void* arg) -> void* {
                           return static_cast<ScopedThread*>(arg)->f_();
                         },
@@ -85,6 +104,29 @@ class ScopedThread {
 
 #ifdef __linux__
 inline pid_t gettid() { return syscall(SYS_gettid); }
+
+// CPUDistance is the topological distance between two CPUs, which dominates
+// the cost of communication between threads running on them.
+enum class CPUDistance {
+  // Hardware threads of the same core, sharing its L1 and L2 caches.
+  kSameCore,
+  // Different cores in the same package.
+  kSamePackage,
+  // Cores in different packages.
+  kCrossPackage,
+};
+
+// Returns a pair of distinct CPUs in the calling thread's affinity mask at the
+// given distance, as reported by /sys/devices/system/cpu/cpuN/topology.
+// Returns ENOENT if there is no such pair.
+PosixErrorOr<std::pair<int, int>> CPUPairAtDistance(CPUDistance distance);
+
+// Returns the CPU set containing only cpu.
+cpu_set_t SingleCPUSet(int cpu);
+
+// Pins the calling thread to cpus. The returned Cleanup restores its previous
+// affinity mask.
+PosixErrorOr<Cleanup> ScopedPinCurrentThread(const cpu_set_t& cpus);
 #endif
 
 }  // namespace testing
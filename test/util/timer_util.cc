@@ -14,6 +14,10 @@
 
 #include "test/util/timer_util.h"
 
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
 namespace gvisor {
 namespace testing {
 
@@ -39,6 +43,15 @@ PosixErrorOr<IntervalTimer> TimerCreate(clockid_t clockid,
   return IntervalTimer(timerid);
 }
 
+PosixErrorOr<FileDescriptor> TimerfdCreate(int clockid, int flags) {
+  int fd = timerfd_create(clockid, flags);
+  MaybeSave();
+  if (fd < 0) {
+    return PosixError(errno, "timerfd_create failed");
+  }
+  return FileDescriptor(fd);
+}
+
 #endif  // __linux__
 
 }  // namespace testing
@@ -26,6 +26,7 @@
 #include "gmock/gmock.h"
 #include "absl/time/time.h"
 #include "test/util/cleanup.h"
+#include "test/util/file_descriptor.h"
 #include "test/util/logging.h"
 #include "test/util/posix_error.h"
 #include "test/util/test_util.h"
@@ -161,6 +162,9 @@ class IntervalTimer {
 PosixErrorOr<IntervalTimer> TimerCreate(clockid_t clockid,
                                         const struct sigevent& sev);
 
+// Wrapper around timerfd_create(2) that returns a FileDescriptor.
+PosixErrorOr<FileDescriptor> TimerfdCreate(int clockid, int flags);
+
 #endif  // __linux__
 
 }  // namespace testing
@@ -0,0 +1,83 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/util/vdso_util.h"
+
+#include <elf.h>
+#include <link.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/auxv.h>
+
+namespace gvisor {
+namespace testing {
+
+void* VDSOSymbol(const char* name) {
+  uintptr_t base = getauxval(AT_SYSINFO_EHDR);
+  if (base == 0) {
+    return nullptr;
+  }
+
+  auto ehdr = reinterpret_cast<const ElfW(Ehdr)*>(base);
+  auto phdrs = reinterpret_cast<const ElfW(Phdr)*>(base + ehdr->e_phoff);
+  uintptr_t bias = 0;
+  bool found_load = false;
+  uintptr_t dynamic = 0;
+  for (int i = 0; i < ehdr->e_phnum; i++) {
+    if (phdrs[i].p_type == PT_LOAD && !found_load) {
+      bias = base + phdrs[i].p_offset - phdrs[i].p_vaddr;
+      found_load = true;
+    }
+    if (phdrs[i].p_type == PT_DYNAMIC) {
+      dynamic = phdrs[i].p_vaddr;
+    }
+  }
+  if (!found_load || dynamic == 0) {
+    return nullptr;
+  }
+
+  const ElfW(Sym)* symtab = nullptr;
+  const char* strtab = nullptr;
+  const ElfW(Word)* hash = nullptr;
+  for (auto dyn = reinterpret_cast<const ElfW(Dyn)*>(bias + dynamic);
+       dyn->d_tag != DT_NULL; dyn++) {
+    switch (dyn->d_tag) {
+      case DT_SYMTAB:
+        symtab = reinterpret_cast<const ElfW(Sym)*>(bias + dyn->d_un.d_ptr);
+        break;
+      case DT_STRTAB:
+        strtab = reinterpret_cast<const char*>(bias + dyn->d_un.d_ptr);
+        break;
+      case DT_HASH:
+        hash = reinterpret_cast<const ElfW(Word)*>(bias + dyn->d_un.d_ptr);
+        break;
+    }
+  }
+  if (symtab == nullptr || strtab == nullptr || hash == nullptr) {
+    return nullptr;
+  }
+
+  // The second word of the hash table is the number of symbols.
+  for (ElfW(Word) i = 0; i < hash[1]; i++) {
+    const ElfW(Sym)& sym = symtab[i];
+    if (ELF64_ST_TYPE(sym.st_info) == STT_FUNC && sym.st_shndx != SHN_UNDEF &&
+        strcmp(strtab + sym.st_name, name) == 0) {
+      return reinterpret_cast<void*>(bias + sym.st_value);
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace testing
+}  // namespace gvisor
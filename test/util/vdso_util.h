@@ -0,0 +1,30 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GVISOR_TEST_UTIL_VDSO_UTIL_H_
+#define GVISOR_TEST_UTIL_VDSO_UTIL_H_
+
+namespace gvisor {
+namespace testing {
+
+// VDSOSymbol returns the address of the function name exported by the VDSO,
+// found by walking the VDSO's dynamic symbol table directly rather than going
+// through the dynamic linker, which statically linked tests don't have. It
+// returns nullptr if there is no VDSO or if the VDSO does not export name.
+void* VDSOSymbol(const char* name);
+
+}  // namespace testing
+}  // namespace gvisor
+
+#endif  // GVISOR_TEST_UTIL_VDSO_UTIL_H_
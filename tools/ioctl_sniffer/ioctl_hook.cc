@@ -18,22 +18,32 @@
 #include <asm/ioctl.h>
 #include <dlfcn.h>
 #include <limits.h>
+#include <linux/fcntl.h>
+#include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "tools/ioctl_sniffer/ioctl.pb.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "tools/ioctl_sniffer/sniffer_bridge.h"
 
-using gvisor::Ioctl;
-
 libc_ioctl libc_ioctl_handle = nullptr;
 
 void init_libc_ioctl_handle() {
@@ -48,6 +58,240 @@ void init_libc_ioctl_handle() {
   }
 }
 
+namespace {
+
+// Returns the next definition of the given function, i.e. libc's.
+template <class F>
+F next_function(const char *name) {
+  F fn = reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+  if (!fn) {
+    std::cerr << "Failed to hook " << name << ": " << dlerror() << "\n";
+    exit(1);
+  }
+  return fn;
+}
+
+// Device is a class of devices whose ioctls and mmaps are recorded.
+struct Device {
+  std::string device_class;
+  std::string prefix;
+};
+
+// Returns the devices to record. The sniffer passes them in
+// GVISOR_IOCTL_SNIFFER_DEVICES, as a comma separated list of
+// <class>=<path prefix>. Defaults to Nvidia devices.
+const std::vector<Device> &devices() {
+  static const auto *devices = [] {
+    auto *devices = new std::vector<Device>();
+    const char *env = getenv("GVISOR_IOCTL_SNIFFER_DEVICES");
+    if (env == nullptr) {
+      devices->push_back({"nvidia", "/dev/nvidia"});
+      return devices;
+    }
+    for (absl::string_view entry :
+         absl::StrSplit(env, ',', absl::SkipEmpty())) {
+      std::pair<absl::string_view, absl::string_view> kv =
+          absl::StrSplit(entry, absl::MaxSplits('=', 1));
+      if (kv.first.empty() || kv.second.empty()) {
+        std::cerr << "Invalid ioctl sniffer device: " << entry << "\n";
+        continue;
+      }
+      devices->push_back({std::string(kv.first), std::string(kv.second)});
+    }
+    return devices;
+  }();
+  return *devices;
+}
+
+// DevicePath is the path of a recorded device, along with its class.
+struct DevicePath {
+  std::string path;
+  const std::string *device_class;
+};
+
+// Returns the class of the device at path, or nullptr if it isn't recorded.
+const std::string *device_class(absl::string_view path) {
+  for (const Device &device : devices()) {
+    if (absl::StartsWith(path, device.prefix)) {
+      return &device.device_class;
+    }
+  }
+  return nullptr;
+}
+
+// File descriptors are classified the first time that ioctl(2) or mmap(2) is
+// called on them, so that readlink(2) isn't called for every call. Classes are
+// cached for file descriptors below kMaxCachedFd, higher ones are classified on
+// every call.
+//
+// Each entry holds a class in the low byte and a generation in the high byte.
+// The generation is incremented whenever the file descriptor is closed or
+// reused, so that a classification racing with it is discarded.
+constexpr int kMaxCachedFd = 1 << 16;
+constexpr uint8_t kFdUnknown = 0;
+constexpr uint8_t kFdOther = 1;
+// Classes starting at kFdFirstPath are recorded devices, the path of which is
+// kept in fd_paths[class - kFdFirstPath].
+constexpr uint8_t kFdFirstPath = 2;
+constexpr int kMaxFdPaths = 256 - kFdFirstPath;
+
+std::atomic<uint16_t> fd_classes[kMaxCachedFd];
+
+// Interned device paths. Entries are never removed, so they can be read
+// without locking. fd_paths_mu serializes adding new ones.
+std::atomic<const DevicePath *> fd_paths[kMaxFdPaths];
+std::mutex fd_paths_mu;
+
+// Returns the class for a recorded device path, or kFdUnknown if there are too
+// many distinct paths to cache them.
+uint8_t intern_path(absl::string_view path, const std::string *device_class) {
+  std::lock_guard<std::mutex> lock(fd_paths_mu);
+  for (int i = 0; i < kMaxFdPaths; ++i) {
+    const DevicePath *p = fd_paths[i].load(std::memory_order_acquire);
+    if (p == nullptr) {
+      fd_paths[i].store(new DevicePath{std::string(path), device_class},
+                        std::memory_order_release);
+      return kFdFirstPath + i;
+    }
+    if (p->path == path) {
+      return kFdFirstPath + i;
+    }
+  }
+  return kFdUnknown;
+}
+
+// Marks the file descriptor as unknown, it must be called after a file
+// descriptor is closed or created.
+void invalidate_fd(int fd) {
+  if (fd < 0 || fd >= kMaxCachedFd) {
+    return;
+  }
+  uint16_t old = fd_classes[fd].load(std::memory_order_relaxed);
+  // Bump the generation, even if the class is already unknown, to discard
+  // classifications in progress.
+  while (!fd_classes[fd].compare_exchange_weak(
+      old, static_cast<uint16_t>((old & 0xff00) + 0x100),
+      std::memory_order_relaxed)) {
+  }
+}
+
+// Returns the path of the file descriptor if it's a recorded device, or nullptr
+// otherwise.
+const DevicePath *device_fd_path(int fd) {
+  uint16_t entry = 0;
+  if (fd >= 0 && fd < kMaxCachedFd) {
+    entry = fd_classes[fd].load(std::memory_order_relaxed);
+    uint8_t cls = entry & 0xff;
+    if (cls == kFdOther) {
+      return nullptr;
+    }
+    if (cls >= kFdFirstPath) {
+      return fd_paths[cls - kFdFirstPath].load(std::memory_order_acquire);
+    }
+  }
+
+  char file_name[PATH_MAX + 1];
+  int n = readlink(absl::StrCat("/proc/self/fd/", fd).c_str(), file_name,
+                   sizeof(file_name) - 1);
+  if (n < 0) {
+    // Likely not a valid file descriptor, don't cache it.
+    return nullptr;
+  }
+  file_name[n] = '\0';
+  uint8_t cls = kFdOther;
+  const std::string *dev_class = device_class(file_name);
+  if (dev_class != nullptr) {
+    cls = intern_path(file_name, dev_class);
+  }
+  if (cls != kFdUnknown && fd < kMaxCachedFd) {
+    // Fails if the file descriptor was invalidated since entry was read.
+    fd_classes[fd].compare_exchange_strong(
+        entry, static_cast<uint16_t>((entry & 0xff00) | cls),
+        std::memory_order_relaxed);
+  }
+  if (cls == kFdOther) {
+    return nullptr;
+  }
+  if (cls == kFdUnknown) {
+    // Too many paths to intern them.
+    static thread_local DevicePath uncached;
+    uncached = {file_name, dev_class};
+    return &uncached;
+  }
+  return fd_paths[cls - kFdFirstPath].load(std::memory_order_acquire);
+}
+
+// UVM ioctls don't encode the size of their parameters in the request, so the
+// sniffer passes the sizes of the UVM ioctls supported by nvproxy in
+// GVISOR_IOCTL_SNIFFER_UVM_SIZES, as a comma separated list of
+// <request>=<size>. Returns 0 for unknown requests.
+uint32_t uvm_arg_size(uint64_t request) {
+  static const auto *sizes = [] {
+    auto *sizes = new absl::flat_hash_map<uint64_t, uint32_t>();
+    const char *env = getenv("GVISOR_IOCTL_SNIFFER_UVM_SIZES");
+    if (env == nullptr) {
+      return sizes;
+    }
+    for (absl::string_view entry :
+         absl::StrSplit(env, ',', absl::SkipEmpty())) {
+      std::pair<absl::string_view, absl::string_view> kv =
+          absl::StrSplit(entry, absl::MaxSplits('=', 1));
+      uint64_t nr;
+      uint32_t size;
+      if (!absl::SimpleAtoi(kv.first, &nr) ||
+          !absl::SimpleAtoi(kv.second, &size)) {
+        std::cerr << "Invalid UVM ioctl size: " << entry << "\n";
+        continue;
+      }
+      (*sizes)[nr] = size;
+    }
+    return sizes;
+  }();
+  auto it = sizes->find(request);
+  return it == sizes->end() ? 0 : it->second;
+}
+
+// Returns the mode argument of open(2) calls, which is only passed with some
+// flags.
+mode_t open_mode(int flags, va_list ap) {
+  if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE) {
+    return va_arg(ap, mode_t);
+  }
+  return 0;
+}
+
+uint64_t timespec_ns(const struct timespec &ts) {
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Records an mmap(2) of a device, which returned ret.
+void write_mmap(const DevicePath &dev, void *ret, size_t length, int prot,
+                int flags, off_t offset, const struct timespec &start,
+                const struct timespec &end) {
+  MmapArgs args = {};
+  args.addr = reinterpret_cast<uintptr_t>(ret);
+  args.length = length;
+  args.offset = offset;
+  args.prot = prot;
+  args.flags = flags;
+
+  IoctlRecord record = {};
+  record.fd_path = &dev.path;
+  record.device_class = dev.device_class;
+  record.mmap = true;
+  record.ret = ret == MAP_FAILED ? -1 : 0;
+  record.arg_data = &args;
+  record.arg_size = sizeof(args);
+  record.time_ns = timespec_ns(end);
+  record.latency_ns = record.time_ns - timespec_ns(start);
+
+  int saved_errno = errno;
+  WriteIoctl(record);
+  errno = saved_errno;
+}
+
+}  // namespace
+
 extern "C" {
 
 int ioctl(int fd, uint64_t request, void *argp) {
@@ -55,36 +299,156 @@ int ioctl(int fd, uint64_t request, void *argp) {
     init_libc_ioctl_handle();
   }
 
+  // Check the file name to see if this is the ioctl of a recorded device.
+  // We only want to log and time these ioctls.
+  const DevicePath *dev = device_fd_path(fd);
+  if (dev == nullptr) {
+    return libc_ioctl_handle(fd, request, argp);
+  }
+
   // Forward the ioctl call.
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
   int ret = libc_ioctl_handle(fd, request, argp);
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
 
-  // Check the file name to see if this is an Nvidia ioctl.
-  // We only want to do protobuf logging for these ioctls.
-  char file_name[PATH_MAX + 1];
-  int n = readlink(absl::StrCat("/proc/self/fd/", fd).c_str(), file_name,
-                   sizeof(file_name) - 1);
-  if (n < 0) {
-    return ret;
+  IoctlRecord record = {};
+  record.fd_path = &dev->path;
+  record.device_class = dev->device_class;
+  record.request = request;
+  record.ret = ret;
+  record.arg_data = argp;
+  record.arg_size = dev->path == "/dev/nvidia-uvm" ? uvm_arg_size(request)
+                                                  : _IOC_SIZE(request);
+  record.time_ns = timespec_ns(end);
+  record.latency_ns = record.time_ns - timespec_ns(start);
+
+  // Don't let the sniffer clobber the errno set by the ioctl.
+  int saved_errno = errno;
+  WriteIoctl(record);
+  errno = saved_errno;
+
+  return ret;
+}
+
+// Mappings of recorded devices are timed and recorded like ioctls. Anonymous
+// mappings are passed through without looking at the file descriptor.
+
+void *mmap(void *addr, size_t length, int prot, int flags, int fd,
+           off_t offset) {
+  static auto libc_mmap =
+      next_function<void *(*)(void *, size_t, int, int, int, off_t)>("mmap");
+  const DevicePath *dev =
+      (flags & MAP_ANONYMOUS) != 0 ? nullptr : device_fd_path(fd);
+  if (dev == nullptr) {
+    return libc_mmap(addr, length, prot, flags, fd, offset);
   }
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  void *ret = libc_mmap(addr, length, prot, flags, fd, offset);
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  write_mmap(*dev, ret, length, prot, flags, offset, start, end);
+  return ret;
+}
 
-  file_name[n] = '\0';
-  if (!absl::StartsWith(file_name, "/dev/nvidia")) {
-    return ret;
+void *mmap64(void *addr, size_t length, int prot, int flags, int fd,
+             off64_t offset) {
+  static auto libc_mmap64 =
+      next_function<void *(*)(void *, size_t, int, int, int, off64_t)>(
+          "mmap64");
+  const DevicePath *dev =
+      (flags & MAP_ANONYMOUS) != 0 ? nullptr : device_fd_path(fd);
+  if (dev == nullptr) {
+    return libc_mmap64(addr, length, prot, flags, fd, offset);
   }
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  void *ret = libc_mmap64(addr, length, prot, flags, fd, offset);
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  write_mmap(*dev, ret, length, prot, flags, offset, start, end);
+  return ret;
+}
 
-  // Prepare ioctl proto for logging.
-  Ioctl info;
-  info.set_fd_path(file_name);
-  info.set_request(request);
-  info.set_ret(ret);
+// The following functions are hooked to keep the file descriptor cache used by
+// ioctl and mmap up to date. File descriptors closed with other functions, e.g.
+// close_range(2), are detected when they are reused by open.
 
-  // ioctl calls to uvm don't encode their size in the request.
-  uint32_t arg_size =
-      strcmp(file_name, "/dev/nvidia-uvm") == 0 ? 0 : _IOC_SIZE(request);
-  info.set_arg_data(argp, arg_size);
+int close(int fd) {
+  static auto libc_close = next_function<int (*)(int)>("close");
+  int ret = libc_close(fd);
+  invalidate_fd(fd);
+  return ret;
+}
 
-  WriteIoctlProto(info);
+int dup(int oldfd) {
+  static auto libc_dup = next_function<int (*)(int)>("dup");
+  int ret = libc_dup(oldfd);
+  invalidate_fd(ret);
+  return ret;
+}
+
+int dup2(int oldfd, int newfd) {
+  static auto libc_dup2 = next_function<int (*)(int, int)>("dup2");
+  int ret = libc_dup2(oldfd, newfd);
+  invalidate_fd(newfd);
+  return ret;
+}
+
+int dup3(int oldfd, int newfd, int flags) {
+  static auto libc_dup3 = next_function<int (*)(int, int, int)>("dup3");
+  int ret = libc_dup3(oldfd, newfd, flags);
+  invalidate_fd(newfd);
+  return ret;
+}
+
+int open(const char *path, int flags, ...) {
+  static auto libc_open =
+      next_function<int (*)(const char *, int, ...)>("open");
+  va_list ap;
+  va_start(ap, flags);
+  mode_t mode = open_mode(flags, ap);
+  va_end(ap);
+  int ret = libc_open(path, flags, mode);
+  invalidate_fd(ret);
+  return ret;
+}
+
+int open64(const char *path, int flags, ...) {
+  static auto libc_open64 =
+      next_function<int (*)(const char *, int, ...)>("open64");
+  va_list ap;
+  va_start(ap, flags);
+  mode_t mode = open_mode(flags, ap);
+  va_end(ap);
+  int ret = libc_open64(path, flags, mode);
+  invalidate_fd(ret);
+  return ret;
+}
+
+int openat(int dirfd, const char *path, int flags, ...) {
+  static auto libc_openat =
+      next_function<int (*)(int, const char *, int, ...)>("openat");
+  va_list ap;
+  va_start(ap, flags);
+  mode_t mode = open_mode(flags, ap);
+  va_end(ap);
+  int ret = libc_openat(dirfd, path, flags, mode);
+  invalidate_fd(ret);
+  return ret;
+}
 
+int openat64(int dirfd, const char *path, int flags, ...) {
+  static auto libc_openat64 =
+      next_function<int (*)(int, const char *, int, ...)>("openat64");
+  va_list ap;
+  va_start(ap, flags);
+  mode_t mode = open_mode(flags, ap);
+  va_end(ap);
+  int ret = libc_openat64(dirfd, path, flags, mode);
+  invalidate_fd(ret);
   return ret;
 }
 
@@ -0,0 +1,184 @@
+// Copyright 2024 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package main replays device ioctls recorded by run_sniffer --record.
+package main
+
+import (
+	"flag"
+	"fmt"
+	"os"
+	"time"
+	"unsafe"
+
+	"golang.org/x/sys/unix"
+	"gvisor.dev/gvisor/pkg/log"
+	pb "gvisor.dev/gvisor/tools/ioctl_sniffer/ioctl_go_proto"
+	"gvisor.dev/gvisor/tools/ioctl_sniffer/sniffer"
+)
+
+var (
+	timing  = flag.String("timing", "fast", "May be set to 'fast' to issue ioctls as fast as possible, or 'original' to preserve the time between ioctls when they were recorded.")
+	repeat  = flag.Int("repeat", 1, "Number of times to replay the recording.")
+	verbose = flag.Bool("verbose", false, "If true, print every ioctl that returns differently than when it was recorded.")
+)
+
+// replayer replays ioctls against the devices they were recorded on.
+type replayer struct {
+	fds     map[string]int
+	buf     []byte
+	results *sniffer.Results
+
+	count      int
+	mismatches int
+}
+
+// fd returns a file descriptor for the device at path.
+func (r *replayer) fd(path string) (int, error) {
+	if fd, ok := r.fds[path]; ok {
+		return fd, nil
+	}
+	fd, err := unix.Open(path, unix.O_RDWR|unix.O_CLOEXEC, 0)
+	if err != nil {
+		return -1, fmt.Errorf("failed to open %s: %w", path, err)
+	}
+	r.fds[path] = fd
+	return fd, nil
+}
+
+// replay issues a single ioctl with the argument data it was recorded with.
+func (r *replayer) replay(ioctl *pb.Ioctl) error {
+	fd, err := r.fd(ioctl.GetFdPath())
+	if err != nil {
+		return err
+	}
+
+	var argp uintptr
+	if data := ioctl.GetArgData(); len(data) > 0 {
+		r.buf = append(r.buf[:0], data...)
+		argp = uintptr(unsafe.Pointer(&r.buf[0]))
+	}
+
+	start := time.Now()
+	ret, _, errno := unix.Syscall(unix.SYS_IOCTL, uintptr(fd), uintptr(ioctl.GetRequest()), argp)
+	latency := time.Since(start)
+
+	r.count++
+	if failed := errno != 0; failed != (ioctl.GetRet() < 0) {
+		r.mismatches++
+		if *verbose {
+			log.Infof("ioctl(%s, %#x) returned %d (errno %v), recorded %d", ioctl.GetFdPath(), ioctl.GetRequest(), int64(ret), errno, ioctl.GetRet())
+		}
+	}
+
+	// Report the latency of the replayed ioctl, decoded from the argument
+	// data as returned when it was recorded.
+	replayed := &pb.Ioctl{
+		FdPath:    ioctl.GetFdPath(),
+		Request:   ioctl.GetRequest(),
+		Ret:       ioctl.GetRet(),
+		ArgData:   ioctl.GetArgData(),
+		LatencyNs: uint64(latency.Nanoseconds()),
+	}
+	if !sniffer.IsNvidiaIoctl(ioctl) {
+		replayed.DeviceClass = ioctl.GetDeviceClass()
+		r.results.AddDeviceLatency(replayed)
+	} else if parsed, err := sniffer.ParseIoctlOutput(replayed); err == nil {
+		r.results.AddLatency(parsed)
+	}
+	return nil
+}
+
+// Main is our main function.
+func Main() error {
+	flag.Parse()
+	if len(flag.Args()) != 1 {
+		return fmt.Errorf("usage: replay [flags] <recording>")
+	}
+	if *timing != "fast" && *timing != "original" {
+		return fmt.Errorf("invalid value for --timing: %q", *timing)
+	}
+
+	f, err := os.Open(flag.Arg(0))
+	if err != nil {
+		return fmt.Errorf("failed to open recording: %w", err)
+	}
+	defer f.Close()
+	var ioctls []*pb.Ioctl
+	mmaps := 0
+	if err := sniffer.ReadRecords(f, func(ioctl *pb.Ioctl) error {
+		// Mappings are recorded for analysis, but replaying them wouldn't
+		// recreate the state they were made in.
+		if ioctl.GetMmap() != nil {
+			mmaps++
+			return nil
+		}
+		ioctls = append(ioctls, ioctl)
+		return nil
+	}); err != nil {
+		return fmt.Errorf("failed to read recording: %w", err)
+	}
+	if len(ioctls) == 0 {
+		return fmt.Errorf("recording %s has no ioctls", flag.Arg(0))
+	}
+	if mmaps > 0 {
+		log.Infof("Skipping %d recorded mmaps", mmaps)
+	}
+
+	r := &replayer{
+		fds:     make(map[string]int),
+		results: sniffer.NewResults(),
+	}
+	// Open all devices up front, so that it isn't included in the timing.
+	for _, ioctl := range ioctls {
+		if _, err := r.fd(ioctl.GetFdPath()); err != nil {
+			return err
+		}
+	}
+
+	// The recording holds the time at which each ioctl returned.
+	recordedStart := func(ioctl *pb.Ioctl) time.Duration {
+		return time.Duration(ioctl.GetTimeNs() - ioctl.GetLatencyNs())
+	}
+	first := recordedStart(ioctls[0])
+
+	start := time.Now()
+	for i := 0; i < *repeat; i++ {
+		iterStart := time.Now()
+		for _, ioctl := range ioctls {
+			if *timing == "original" {
+				if wait := recordedStart(ioctl) - first - time.Since(iterStart); wait > 0 {
+					time.Sleep(wait)
+				}
+			}
+			if err := r.replay(ioctl); err != nil {
+				return err
+			}
+		}
+	}
+	elapsed := time.Since(start)
+
+	log.Infof("Replayed %d ioctls in %v (%.0f ioctls/s), %d returned differently than when recorded",
+		r.count, elapsed, float64(r.count)/elapsed.Seconds(), r.mismatches)
+	log.Infof("============== Ioctl latencies ==============")
+	log.Infof("%s", r.results.LatencySummary())
+	return nil
+}
+
+func main() {
+	if err := Main(); err != nil {
+		log.Warningf("%v", err)
+		os.Exit(1)
+	}
+}
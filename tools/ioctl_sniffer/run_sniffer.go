@@ -21,6 +21,7 @@ import (
 	"fmt"
 	"os"
 	"os/exec"
+	"strings"
 
 	"gvisor.dev/gvisor/pkg/log"
 	"gvisor.dev/gvisor/tools/ioctl_sniffer/sniffer"
@@ -30,10 +31,29 @@ import (
 
 var (
 	enforceCompatibility = flag.String("enforce_compatibility", "", "May be set to 'INSTANT' or 'REPORT'. If set, the sniffer will return a non-zero error code if it detects an unsupported ioctl. 'INSTANT' causes the sniffer to exit immediately when this happens. 'REPORT' causes the sniffer to report all unsupported ioctls at the end of execution.")
-	verbose              = flag.Bool("verbose", false, "If true, the sniffer will print all Nvidia ioctls it sees.")
+	verbose              = flag.Bool("verbose", false, "If true, the sniffer will print all device ioctls and mmaps it sees.")
 	addLdPath            = flag.String("add_ld_path", "", "If set, reconfigure the ld cache to include the given directory")
+	latencySummary       = flag.Bool("latency_summary", false, "If true, the sniffer will print the number of calls and the latency histogram of each device ioctl and mmap at the end.")
+	record               = flag.String("record", "", "If set, all ioctls and mmaps of the devices given by --devices are recorded to the given file, which can be replayed with //tools/ioctl_sniffer/replay.")
+	format               = flag.String("format", "binary", "Format used by the hook to send ioctls to the sniffer. May be set to 'binary' or 'proto'. The binary format has a lower overhead.")
+	devices              = flag.String("devices", "nvidia=/dev/nvidia", "Comma separated list of <class>=<path prefix> of the devices whose ioctls and mmaps are recorded, e.g. 'nvidia=/dev/nvidia,tpu=/dev/accel,tpu=/dev/vfio/'. Only ioctls of the 'nvidia' class are checked against nvproxy.")
 )
 
+// hasNvidiaDevices returns true if --devices includes Nvidia devices.
+func hasNvidiaDevices() (bool, error) {
+	found := false
+	for _, entry := range strings.Split(*devices, ",") {
+		class, prefix, ok := strings.Cut(entry, "=")
+		if !ok || class == "" || prefix == "" {
+			return false, fmt.Errorf("invalid value for --devices: %q", *devices)
+		}
+		if class == sniffer.NvidiaDeviceClass {
+			found = true
+		}
+	}
+	return found, nil
+}
+
 //go:embed libioctl_hook.so
 var ioctlHookSharedObject []byte
 
@@ -67,6 +87,10 @@ func Main(ctx context.Context) error {
 		return fmt.Errorf("invalid value for --enforce_compatibility: %q", *enforceCompatibility)
 	}
 
+	if *format != "binary" && *format != "proto" {
+		return fmt.Errorf("invalid value for --format: %q", *format)
+	}
+
 	if *verbose {
 		log.SetLevel(log.Debug)
 	}
@@ -77,9 +101,17 @@ func Main(ctx context.Context) error {
 		}
 	}
 
-	// Init our sniffer
-	if err := sniffer.Init(); err != nil {
-		return fmt.Errorf("failed to init sniffer: %w", err)
+	nvidia, err := hasNvidiaDevices()
+	if err != nil {
+		return err
+	}
+
+	// Init our sniffer. It needs the Nvidia driver, so it's skipped when only
+	// other devices are recorded.
+	if nvidia {
+		if err := sniffer.Init(); err != nil {
+			return fmt.Errorf("failed to init sniffer: %w", err)
+		}
 	}
 
 	hookFile, err := createSharedObject()
@@ -98,6 +130,24 @@ func Main(ctx context.Context) error {
 		return fmt.Errorf("failed to start sniffer server: %w", err)
 	}
 
+	if *record != "" {
+		f, err := os.Create(*record)
+		if err != nil {
+			return fmt.Errorf("failed to create record file: %w", err)
+		}
+		defer f.Close()
+		recorder, err := sniffer.NewRecordWriter(f)
+		if err != nil {
+			return fmt.Errorf("failed to write record file: %w", err)
+		}
+		defer func() {
+			if err := recorder.Flush(); err != nil {
+				log.Warningf("failed to write record file: %v", err)
+			}
+		}()
+		server.Record(recorder)
+	}
+
 	serveCtx, serveCancel := context.WithCancel(ctx)
 	defer serveCancel()
 	go func() {
@@ -116,7 +166,10 @@ func Main(ctx context.Context) error {
 	cmd.Env = append(os.Environ(),
 		fmt.Sprintf("LD_PRELOAD=/proc/%d/fd/%d", os.Getpid(), hookFile.Fd()),
 		fmt.Sprintf("GVISOR_IOCTL_SNIFFER_SOCKET_PATH=%v", server.Addr()),
-		fmt.Sprintf("GVISOR_IOCTL_SNIFFER_ENFORCE_COMPATIBILITY=%s", *enforceCompatibility))
+		fmt.Sprintf("GVISOR_IOCTL_SNIFFER_ENFORCE_COMPATIBILITY=%s", *enforceCompatibility),
+		fmt.Sprintf("GVISOR_IOCTL_SNIFFER_FORMAT=%s", *format),
+		fmt.Sprintf("GVISOR_IOCTL_SNIFFER_DEVICES=%s", *devices),
+		fmt.Sprintf("GVISOR_IOCTL_SNIFFER_UVM_SIZES=%s", sniffer.UVMArgSizes()))
 
 	// Run the command and start reading the output.
 	if err := cmd.Start(); err != nil {
@@ -130,6 +183,10 @@ func Main(ctx context.Context) error {
 
 	// Merge results from each connection.
 	finalResults := server.AllResults()
+	if *latencySummary {
+		log.Infof("============== Ioctl latencies ==============")
+		log.Infof("%s", finalResults.LatencySummary())
+	}
 	if finalResults.HasUnsupportedIoctl() {
 		if *enforceCompatibility != "" {
 			return fmt.Errorf("unsupported ioctls found: %v", finalResults)
@@ -0,0 +1,169 @@
+// Copyright 2024 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package sniffer
+
+import (
+	"fmt"
+	"math/bits"
+	"sort"
+	"strings"
+	"time"
+
+	"gvisor.dev/gvisor/pkg/abi/linux"
+	pb "gvisor.dev/gvisor/tools/ioctl_sniffer/ioctl_go_proto"
+)
+
+// latencyKey identifies the ioctls whose latencies are aggregated together.
+type latencyKey struct {
+	// device is the device class of mmaps and of ioctls that aren't Nvidia
+	// ioctls, which are grouped by ioctl number. It is empty for Nvidia
+	// ioctls, which are grouped by class and subclass.
+	device string
+	mmap   bool
+
+	class    ioctlClass
+	subclass ioctlSubclass
+}
+
+// deviceLatencyKey returns the key of a record that isn't an Nvidia ioctl.
+func deviceLatencyKey(ioctl *pb.Ioctl) latencyKey {
+	key := latencyKey{device: ioctl.GetDeviceClass()}
+	if key.device == "" {
+		key.device = NvidiaDeviceClass
+	}
+	if ioctl.GetMmap() != nil {
+		key.mmap = true
+	} else {
+		key.subclass = ioctlSubclass(linux.IOC_NR(uint32(ioctl.GetRequest())))
+	}
+	return key
+}
+
+func (k latencyKey) String() string {
+	if k.mmap {
+		return fmt.Sprintf("%s mmap", k.device)
+	}
+	if k.device != "" {
+		return fmt.Sprintf("%s ioctl nr=%#x", k.device, k.subclass)
+	}
+	switch k.class {
+	case control:
+		return fmt.Sprintf("%v cmd=%#x", k.class, k.subclass)
+	case alloc:
+		return fmt.Sprintf("%v hClass=%#x", k.class, k.subclass)
+	default:
+		return fmt.Sprintf("%v nr=%#x", k.class, k.subclass)
+	}
+}
+
+// latencyStats counts the calls to an ioctl and how long they took. Bucket i
+// of the histogram counts the calls that took less than 2^i nanoseconds, and
+// at least 2^(i-1) nanoseconds.
+type latencyStats struct {
+	count   uint64
+	totalNs uint64
+	maxNs   uint64
+	buckets [65]uint64
+}
+
+func (s *latencyStats) add(ns uint64) {
+	s.count++
+	s.totalNs += ns
+	s.maxNs = max(s.maxNs, ns)
+	s.buckets[bits.Len64(ns)]++
+}
+
+func (s *latencyStats) merge(other *latencyStats) {
+	s.count += other.count
+	s.totalNs += other.totalNs
+	s.maxNs = max(s.maxNs, other.maxNs)
+	for i, n := range other.buckets {
+		s.buckets[i] += n
+	}
+}
+
+// percentile returns an upper bound of the latency of the given fraction of
+// calls.
+func (s *latencyStats) percentile(p float64) time.Duration {
+	want := uint64(p * float64(s.count))
+	var seen uint64
+	for i, n := range s.buckets {
+		seen += n
+		if n != 0 && seen >= want {
+			return bucketLimit(i)
+		}
+	}
+	return bucketLimit(len(s.buckets) - 1)
+}
+
+// bucketLimit returns the exclusive upper bound of bucket i.
+func bucketLimit(i int) time.Duration {
+	if i >= 63 {
+		return time.Duration(1<<63 - 1)
+	}
+	return time.Duration(1) << i
+}
+
+func (s *latencyStats) String() string {
+	b := new(strings.Builder)
+	fmt.Fprintf(b, "%d calls, total=%v avg=%v p50<%v p99<%v max=%v",
+		s.count, time.Duration(s.totalNs), time.Duration(s.totalNs/s.count),
+		s.percentile(0.5), s.percentile(0.99), time.Duration(s.maxNs))
+	b.WriteString("\n\t\t")
+	for i, n := range s.buckets {
+		if n != 0 {
+			fmt.Fprintf(b, " <%v:%d", bucketLimit(i), n)
+		}
+	}
+	return b.String()
+}
+
+// AddLatency records the latency of an ioctl in the results.
+func (r *Results) AddLatency(ioctl Ioctl) {
+	r.addLatency(latencyKey{class: ioctl.class, subclass: ioctl.subclass}, ioctl.pb.GetLatencyNs())
+}
+
+// AddDeviceLatency records the latency of an mmap, or of an ioctl that isn't
+// an Nvidia ioctl, in the results.
+func (r *Results) AddDeviceLatency(ioctl *pb.Ioctl) {
+	r.addLatency(deviceLatencyKey(ioctl), ioctl.GetLatencyNs())
+}
+
+func (r *Results) addLatency(key latencyKey, ns uint64) {
+	stats, ok := r.latencies[key]
+	if !ok {
+		stats = &latencyStats{}
+		r.latencies[key] = stats
+	}
+	stats.add(ns)
+}
+
+// LatencySummary returns the number of calls and the latency histogram of
+// each ioctl, starting with the ioctls that took the most time overall.
+func (r *Results) LatencySummary() string {
+	keys := make([]latencyKey, 0, len(r.latencies))
+	for key := range r.latencies {
+		keys = append(keys, key)
+	}
+	sort.Slice(keys, func(i, j int) bool {
+		return r.latencies[keys[i]].totalNs > r.latencies[keys[j]].totalNs
+	})
+
+	b := new(strings.Builder)
+	for _, key := range keys {
+		fmt.Fprintf(b, "\t%v: %v\n", key, r.latencies[key])
+	}
+	return b.String()
+}
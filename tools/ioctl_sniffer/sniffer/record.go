@@ -0,0 +1,266 @@
+// Copyright 2024 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package sniffer
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"sync"
+
+	"google.golang.org/protobuf/proto"
+	pb "gvisor.dev/gvisor/tools/ioctl_sniffer/ioctl_go_proto"
+)
+
+// Constants of the binary format, which should match sniffer_bridge.h.
+const (
+	binaryMagic            = 0x314c54434f495647 // "GVIOCTL1"
+	binaryRecordPath       = 1
+	binaryRecordIoctl      = 2
+	binaryRecordMmap       = 3
+	binaryRecordHeaderSize = 40
+	binaryMmapSize         = 32
+)
+
+// decoder decodes ioctls written by the hook. The hook either uses the proto
+// format:
+//   - 8 byte little endian uint64 containing the size of the proto.
+//   - The proto bytes.
+//
+// Or the binary format, which starts with binaryMagic followed by records made
+// of a fixed size header and a payload holding either a path and its device
+// class, the ioctl argument data or the mmap arguments.
+//
+// This should match the formats in sniffer_bridge.h.
+type decoder struct {
+	r   io.Reader
+	buf []byte
+
+	// started is set once the first bytes, which tell the format used by the
+	// hook, have been read.
+	started bool
+
+	// paths maps IDs to paths in the binary format. It is nil if the hook uses
+	// the proto format.
+	paths map[uint16]devicePath
+}
+
+// devicePath is a path defined in the binary format.
+type devicePath struct {
+	path        string
+	deviceClass string
+}
+
+// next reads a single ioctl.
+func (d *decoder) next() (*pb.Ioctl, error) {
+	if d.paths != nil {
+		return d.readBinaryIoctl()
+	}
+
+	// First read in proto size
+	var protoSizeBuf [8]byte
+	if _, err := io.ReadFull(d.r, protoSizeBuf[:]); err != nil {
+		return nil, fmt.Errorf("failed to read proto size: %w", err)
+	}
+	protoSize := binary.LittleEndian.Uint64(protoSizeBuf[:])
+	if !d.started {
+		d.started = true
+		if protoSize == binaryMagic {
+			d.paths = make(map[uint16]devicePath)
+			return d.readBinaryIoctl()
+		}
+	}
+
+	// Read the proto data.
+	if err := d.readPayload(protoSize); err != nil {
+		return nil, fmt.Errorf("failed to read proto data: %w", err)
+	}
+
+	// Unmarshal and parse proto.
+	ioctl := &pb.Ioctl{}
+	if err := proto.Unmarshal(d.buf, ioctl); err != nil {
+		return nil, fmt.Errorf("failed to unmarshal proto: %w", err)
+	}
+
+	return ioctl, nil
+}
+
+// readPayload reads size bytes into d.buf.
+func (d *decoder) readPayload(size uint64) error {
+	// See if we need to reallocate the buffer.
+	if cap(d.buf) < int(size) {
+		d.buf = make([]byte, size)
+	} else {
+		d.buf = d.buf[:size]
+	}
+	if size == 0 {
+		return nil
+	}
+	_, err := io.ReadFull(d.r, d.buf)
+	return err
+}
+
+// readBinaryIoctl reads records in the binary format until it reads an ioctl,
+// and returns it as a proto.
+func (d *decoder) readBinaryIoctl() (*pb.Ioctl, error) {
+	var header [binaryRecordHeaderSize]byte
+	for {
+		if _, err := io.ReadFull(d.r, header[:]); err != nil {
+			return nil, fmt.Errorf("failed to read record header: %w", err)
+		}
+		kind := binary.LittleEndian.Uint16(header[0:])
+		pathID := binary.LittleEndian.Uint16(header[2:])
+		size := binary.LittleEndian.Uint32(header[4:])
+		if err := d.readPayload(uint64(size)); err != nil {
+			return nil, fmt.Errorf("failed to read record data: %w", err)
+		}
+
+		switch kind {
+		case binaryRecordPath:
+			// Recordings made before devices had classes only hold the path.
+			path, deviceClass, _ := bytes.Cut(d.buf, []byte{0})
+			d.paths[pathID] = devicePath{path: string(path), deviceClass: string(deviceClass)}
+		case binaryRecordIoctl, binaryRecordMmap:
+			path, ok := d.paths[pathID]
+			if !ok {
+				return nil, fmt.Errorf("ioctl refers to unknown path %d", pathID)
+			}
+			ioctl := &pb.Ioctl{
+				FdPath:      path.path,
+				DeviceClass: path.deviceClass,
+				Request:     binary.LittleEndian.Uint64(header[8:]),
+				TimeNs:      binary.LittleEndian.Uint64(header[16:]),
+				LatencyNs:   binary.LittleEndian.Uint64(header[24:]),
+				Ret:         int32(binary.LittleEndian.Uint32(header[32:])),
+				Tid:         int32(binary.LittleEndian.Uint32(header[36:])),
+			}
+			if kind == binaryRecordIoctl {
+				ioctl.ArgData = bytes.Clone(d.buf)
+				return ioctl, nil
+			}
+			if len(d.buf) != binaryMmapSize {
+				return nil, fmt.Errorf("mmap record has %d bytes, want %d", len(d.buf), binaryMmapSize)
+			}
+			ioctl.Request = 0
+			ioctl.Mmap = &pb.Mmap{
+				Addr:   binary.LittleEndian.Uint64(d.buf[0:]),
+				Length: binary.LittleEndian.Uint64(d.buf[8:]),
+				Offset: binary.LittleEndian.Uint64(d.buf[16:]),
+				Prot:   int32(binary.LittleEndian.Uint32(d.buf[24:])),
+				Flags:  int32(binary.LittleEndian.Uint32(d.buf[28:])),
+			}
+			return ioctl, nil
+		default:
+			return nil, fmt.Errorf("unknown record kind %d", kind)
+		}
+	}
+}
+
+// RecordWriter writes ioctls in the binary format, so that they can be read
+// back with ReadRecords, e.g. to replay them. It is safe for concurrent use.
+type RecordWriter struct {
+	mu    sync.Mutex
+	w     *bufio.Writer
+	paths map[string]uint16
+}
+
+// NewRecordWriter returns a RecordWriter writing to w.
+func NewRecordWriter(w io.Writer) (*RecordWriter, error) {
+	rw := &RecordWriter{
+		w:     bufio.NewWriter(w),
+		paths: make(map[string]uint16),
+	}
+	if err := binary.Write(rw.w, binary.LittleEndian, uint64(binaryMagic)); err != nil {
+		return nil, err
+	}
+	return rw, nil
+}
+
+// Write writes a single ioctl.
+func (rw *RecordWriter) Write(ioctl *pb.Ioctl) error {
+	rw.mu.Lock()
+	defer rw.mu.Unlock()
+
+	var header [binaryRecordHeaderSize]byte
+	path := ioctl.GetFdPath()
+	id, ok := rw.paths[path]
+	if !ok {
+		if len(rw.paths) > 0xffff {
+			return fmt.Errorf("too many paths")
+		}
+		id = uint16(len(rw.paths))
+		rw.paths[path] = id
+		deviceClass := ioctl.GetDeviceClass()
+		binary.LittleEndian.PutUint16(header[0:], binaryRecordPath)
+		binary.LittleEndian.PutUint16(header[2:], id)
+		binary.LittleEndian.PutUint32(header[4:], uint32(len(path)+1+len(deviceClass)))
+		rw.w.Write(header[:])
+		rw.w.WriteString(path)
+		rw.w.WriteByte(0)
+		rw.w.WriteString(deviceClass)
+		header = [binaryRecordHeaderSize]byte{}
+	}
+
+	kind := uint16(binaryRecordIoctl)
+	data := ioctl.GetArgData()
+	if m := ioctl.GetMmap(); m != nil {
+		kind = binaryRecordMmap
+		data = make([]byte, binaryMmapSize)
+		binary.LittleEndian.PutUint64(data[0:], m.GetAddr())
+		binary.LittleEndian.PutUint64(data[8:], m.GetLength())
+		binary.LittleEndian.PutUint64(data[16:], m.GetOffset())
+		binary.LittleEndian.PutUint32(data[24:], uint32(m.GetProt()))
+		binary.LittleEndian.PutUint32(data[28:], uint32(m.GetFlags()))
+	}
+	binary.LittleEndian.PutUint16(header[0:], kind)
+	binary.LittleEndian.PutUint16(header[2:], id)
+	binary.LittleEndian.PutUint32(header[4:], uint32(len(data)))
+	binary.LittleEndian.PutUint64(header[8:], ioctl.GetRequest())
+	binary.LittleEndian.PutUint64(header[16:], ioctl.GetTimeNs())
+	binary.LittleEndian.PutUint64(header[24:], ioctl.GetLatencyNs())
+	binary.LittleEndian.PutUint32(header[32:], uint32(ioctl.GetRet()))
+	binary.LittleEndian.PutUint32(header[36:], uint32(ioctl.GetTid()))
+	rw.w.Write(header[:])
+	_, err := rw.w.Write(data)
+	return err
+}
+
+// Flush writes any buffered ioctls to the underlying writer.
+func (rw *RecordWriter) Flush() error {
+	rw.mu.Lock()
+	defer rw.mu.Unlock()
+	return rw.w.Flush()
+}
+
+// ReadRecords calls f with each ioctl read from r, in either format, until it
+// reaches the end of r or f returns an error.
+func ReadRecords(r io.Reader, f func(*pb.Ioctl) error) error {
+	d := decoder{r: bufio.NewReader(r)}
+	for {
+		ioctl, err := d.next()
+		if err != nil {
+			if errors.Is(err, io.EOF) {
+				return nil
+			}
+			return err
+		}
+		if err := f(ioctl); err != nil {
+			return err
+		}
+	}
+}
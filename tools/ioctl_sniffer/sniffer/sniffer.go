@@ -21,17 +21,24 @@ import (
 	"fmt"
 	"io"
 	"os"
+	"reflect"
 	"regexp"
+	"sort"
 	"strings"
 
 	"gvisor.dev/gvisor/pkg/abi/linux"
 	"gvisor.dev/gvisor/pkg/abi/nvgpu"
 	"gvisor.dev/gvisor/pkg/log"
+	"gvisor.dev/gvisor/pkg/marshal"
 	"gvisor.dev/gvisor/pkg/sentry/devices/nvproxy"
 	"gvisor.dev/gvisor/pkg/sentry/devices/nvproxy/nvconf"
 	pb "gvisor.dev/gvisor/tools/ioctl_sniffer/ioctl_go_proto"
 )
 
+// NvidiaDeviceClass is the device class of Nvidia devices, the only ones whose
+// ioctls are checked against nvproxy.
+const NvidiaDeviceClass = "nvidia"
+
 var (
 	uvmDevPath    = "/dev/nvidia-uvm"
 	ctlDevPath    = "/dev/nvidiactl"
@@ -75,6 +82,10 @@ type ioctlSubclass uint32
 var (
 	supportedIoctls         [_numClasses]map[uint32]struct{}
 	crashOnUnsupportedIoctl bool
+
+	// uvmArgSizes maps UVM ioctl numbers supported by nvproxy to the size of
+	// their parameters.
+	uvmArgSizes map[uint32]uint32
 )
 
 // Ioctl contains the parsed ioctl protobuf information.
@@ -133,15 +144,18 @@ func (i Ioctl) String() string {
 	panic("unreachable")
 }
 
-// Results contains the list of unsupported ioctls.
+// Results contains the list of unsupported ioctls, and the latency of all
+// ioctls.
 type Results struct {
 	unsupported [_numClasses]map[ioctlSubclass]Ioctl
+	latencies   map[latencyKey]*latencyStats
 }
 
 // NewResults creates a new Results object.
 func NewResults() *Results {
 	return &Results{
 		unsupported: [_numClasses]map[ioctlSubclass]Ioctl{},
+		latencies:   make(map[latencyKey]*latencyStats),
 	}
 }
 
@@ -190,6 +204,13 @@ func (r *Results) Merge(other *Results) {
 			r.AddUnsupportedIoctl(ioctl)
 		}
 	}
+	for key, stats := range other.latencies {
+		if mine, ok := r.latencies[key]; ok {
+			mine.merge(stats)
+		} else {
+			r.latencies[key] = stats
+		}
+	}
 }
 
 // Init reads from nvproxy and sets up the supported ioctl maps.
@@ -219,6 +240,26 @@ func Init() error {
 		alloc:    suppAllocClasses,
 		unknown:  make(map[uint32]struct{}),
 	}
+
+	// UVM ioctls don't encode the size of their parameters in the request, so
+	// the hook relies on nvproxy's definitions of the parameters to capture
+	// them.
+	info, ok := nvproxy.SupportedIoctls(driverVer)
+	if !ok {
+		return fmt.Errorf("host driver version %s is not supported", driverVer)
+	}
+	uvmArgSizes = make(map[uint32]uint32)
+	for nr, ioctlInfo := range info.UvmInfos {
+		if len(ioctlInfo.Structs) == 0 {
+			continue
+		}
+		params, ok := reflect.New(ioctlInfo.Structs[0].Type).Interface().(marshal.Marshallable)
+		if !ok {
+			return fmt.Errorf("parameters of UVM ioctl %s are not marshallable", ioctlInfo.Name)
+		}
+		uvmArgSizes[nr] = uint32(params.SizeBytes())
+	}
+
 	if os.Getenv("GVISOR_IOCTL_SNIFFER_ENFORCE_COMPATIBILITY") == "INSTANT" {
 		crashOnUnsupportedIoctl = true
 	}
@@ -226,6 +267,23 @@ func Init() error {
 	return nil
 }
 
+// UVMArgSizes returns the size of the parameters of each UVM ioctl, in the
+// format expected by the hook in GVISOR_IOCTL_SNIFFER_UVM_SIZES: a comma
+// separated list of <request>=<size>.
+func UVMArgSizes() string {
+	nrs := make([]uint32, 0, len(uvmArgSizes))
+	for nr := range uvmArgSizes {
+		nrs = append(nrs, nr)
+	}
+	sort.Slice(nrs, func(i, j int) bool { return nrs[i] < nrs[j] })
+
+	entries := make([]string, 0, len(nrs))
+	for _, nr := range nrs {
+		entries = append(entries, fmt.Sprintf("%d=%d", nr, uvmArgSizes[nr]))
+	}
+	return strings.Join(entries, ",")
+}
+
 // ReadHookOutput reads the output of the ioctl hook until an EOF is reached.
 func (c Connection) ReadHookOutput(ctx context.Context) *Results {
 	res := NewResults()
@@ -238,6 +296,18 @@ func (c Connection) ReadHookOutput(ctx context.Context) *Results {
 			break
 		}
 
+		if c.recorder != nil {
+			if err := c.recorder.Write(ioctlPB); err != nil {
+				log.Warningf("Error recording ioctl %v: %v", ioctlPB, err)
+			}
+		}
+
+		if !IsNvidiaIoctl(ioctlPB) {
+			log.Debugf("%s", deviceLatencyKey(ioctlPB))
+			res.AddDeviceLatency(ioctlPB)
+			continue
+		}
+
 		// Parse the protobuf
 		ioctl, err := ParseIoctlOutput(ioctlPB)
 		if err != nil {
@@ -246,6 +316,7 @@ func (c Connection) ReadHookOutput(ctx context.Context) *Results {
 		}
 
 		log.Debugf("%s", ioctl)
+		res.AddLatency(ioctl)
 
 		if !ioctl.IsSupported() {
 			res.AddUnsupportedIoctl(ioctl)
@@ -258,6 +329,13 @@ func (c Connection) ReadHookOutput(ctx context.Context) *Results {
 	return res
 }
 
+// IsNvidiaIoctl returns true if the record is an ioctl of an Nvidia device,
+// rather than an mmap or an ioctl of another device class.
+func IsNvidiaIoctl(ioctl *pb.Ioctl) bool {
+	class := ioctl.GetDeviceClass()
+	return ioctl.GetMmap() == nil && (class == "" || class == NvidiaDeviceClass)
+}
+
 // ParseIoctlOutput parses an ioctl protobuf from the ioctl hook.
 func ParseIoctlOutput(ioctl *pb.Ioctl) (Ioctl, error) {
 	parsedIoctl := Ioctl{pb: ioctl}
@@ -16,7 +16,6 @@ package sniffer
 
 import (
 	"context"
-	"encoding/binary"
 	"errors"
 	"fmt"
 	"net"
@@ -24,14 +23,16 @@ import (
 	"sync"
 	"time"
 
-	"google.golang.org/protobuf/proto"
 	pb "gvisor.dev/gvisor/tools/ioctl_sniffer/ioctl_go_proto"
 )
 
 // Connection is a connection to the sniffer hook.
 type Connection struct {
-	protoBytesBuf []byte
-	conn          net.Conn
+	conn net.Conn
+	dec  decoder
+
+	// recorder, if not nil, records all ioctls read from the connection.
+	recorder *RecordWriter
 }
 
 // readFullWithContext tries to fill the buffer with data from the connection. It returns an error
@@ -66,38 +67,25 @@ func (c *Connection) readFullWithContext(ctx context.Context, buf []byte) error
 	return nil
 }
 
-// ReadIoctlProto reads a single ioctl proto from this connection. Our format is:
-//   - 8 byte little endian uint64 containing the size of the proto.
-//   - The proto bytes.
-//
-// This should match the format in sniffer_bridge.h.
-func (c *Connection) ReadIoctlProto(ctx context.Context) (*pb.Ioctl, error) {
-	// First read in proto size
-	var protoSizeBuf [8]byte
-	if err := c.readFullWithContext(ctx, protoSizeBuf[:]); err != nil {
-		return nil, fmt.Errorf("failed to read proto size: %w", err)
-	}
-	protoSize := binary.LittleEndian.Uint64(protoSizeBuf[:])
-
-	// See if we need to reallocate the buffer.
-	if cap(c.protoBytesBuf) < int(protoSize) {
-		c.protoBytesBuf = make([]byte, protoSize)
-	} else {
-		c.protoBytesBuf = c.protoBytesBuf[:protoSize]
-	}
-
-	// Read the proto data.
-	if err := c.readFullWithContext(ctx, c.protoBytesBuf); err != nil {
-		return nil, fmt.Errorf("failed to read proto data: %w", err)
-	}
+// contextReader reads from a connection until the context is cancelled.
+type contextReader struct {
+	ctx context.Context
+	c   *Connection
+}
 
-	// Unmarshal and parse proto.
-	ioctl := &pb.Ioctl{}
-	if err := proto.Unmarshal(c.protoBytesBuf, ioctl); err != nil {
-		return nil, fmt.Errorf("failed to unmarshal proto: %w", err)
+// Read implements io.Reader.Read.
+func (r contextReader) Read(buf []byte) (int, error) {
+	if err := r.c.readFullWithContext(r.ctx, buf); err != nil {
+		return 0, err
 	}
+	return len(buf), nil
+}
 
-	return ioctl, nil
+// ReadIoctlProto reads a single ioctl from this connection, in either of the
+// formats described in sniffer_bridge.h.
+func (c *Connection) ReadIoctlProto(ctx context.Context) (*pb.Ioctl, error) {
+	c.dec.r = contextReader{ctx: ctx, c: c}
+	return c.dec.next()
 }
 
 // Server is a server that accepts connections from the sniffer hook. It reads ioctl protos from
@@ -106,6 +94,7 @@ type Server struct {
 	resultsChan   chan *Results
 	connectionsWG sync.WaitGroup
 	listener      net.Listener
+	recorder      *RecordWriter
 }
 
 // NewServer creates a new Server.
@@ -130,6 +119,12 @@ func (s *Server) Listen() error {
 	return nil
 }
 
+// Record makes the server record all ioctls it reads to w. It must be called
+// before Serve.
+func (s *Server) Record(w *RecordWriter) {
+	s.recorder = w
+}
+
 // Serve opens a new socket server, continually accepts connections from the socket and
 // reads ioctl protos from each connection. It blocks until the context is cancelled.
 func (s *Server) Serve(ctx context.Context) error {
@@ -147,7 +142,7 @@ func (s *Server) Serve(ctx context.Context) error {
 
 			s.connectionsWG.Add(1)
 			go func() {
-				conn := Connection{conn: conn}
+				conn := Connection{conn: conn, recorder: s.recorder}
 				s.resultsChan <- conn.ReadHookOutput(ctx)
 				s.connectionsWG.Done()
 			}()
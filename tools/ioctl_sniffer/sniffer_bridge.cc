@@ -14,24 +14,446 @@
 
 #include "tools/ioctl_sniffer/sniffer_bridge.h"
 
+#include <limits.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tools/ioctl_sniffer/ioctl.pb.h"
 
-thread_local pid_t socket_owner_tid = -1;
-thread_local int socket_fd = -1;
+namespace {
 
-void InitializeSocket() {
+// A thread wakes up the flusher once it has this many bytes buffered.
+constexpr size_t kFlushBytes = 64 << 10;
+
+// Records are dropped once a thread has this many bytes buffered, so that a
+// slow sniffer can't make the workload run out of memory.
+constexpr size_t kMaxBufferedBytes = 16 << 20;
+
+// Buffered records are written at least this often.
+constexpr std::chrono::milliseconds kFlushInterval(10);
+
+// ThreadBuffer holds the records of a single thread. The lock is only
+// contended when the flusher swaps the buffers.
+struct ThreadBuffer {
+  std::mutex mu;
+
+  // Records waiting to be written. Protected by mu.
+  std::string data;
+
+  // Records being written by the flusher, which owns it.
+  std::string spare;
+
+  // Paths already defined by this thread in the binary format, along with
+  // their IDs. Only used by the thread owning the buffer.
+  std::vector<std::pair<std::string, uint16_t>> paths;
+};
+
+// Bridge owns the connection to the sniffer and the thread writing to it.
+class Bridge {
+ public:
+  Bridge(int socket_fd, bool binary)
+      : socket_fd_(socket_fd), binary_(binary) {}
+
+  void Start() { flusher_ = std::thread([this] { Run(); }); }
+
+  // Stop writes all records buffered so far and closes the connection.
+  void Stop();
+
+  // Register returns a new buffer for the calling thread.
+  std::shared_ptr<ThreadBuffer> Register();
+
+  void RequestFlush();
+
+  void Drop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+  bool binary() const { return binary_; }
+
+  // PathID returns the ID of path in the binary format, or -1 if there are too
+  // many paths.
+  int PathID(const std::string &path);
+
+ private:
+  void Run();
+
+  // Flush writes all buffered records to the socket.
+  void Flush(std::vector<std::shared_ptr<ThreadBuffer>> &buffers);
+
+  // WriteAll writes all of iovs to the socket.
+  void WriteAll(std::vector<iovec> &iovs);
+
+  const int socket_fd_;
+  const bool binary_;
+  std::thread flusher_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+
+  // All registered buffers. A buffer is removed once its thread has exited
+  // and its records are written. Protected by mu_.
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+  // Protected by mu_.
+  bool flush_requested_ = false;
+  bool stopping_ = false;
+
+  std::atomic<uint64_t> dropped_{0};
+
+  // IDs of the paths seen so far. Protected by mu_.
+  absl::flat_hash_map<std::string, uint16_t> path_ids_;
+};
+
+int Bridge::PathID(const std::string &path) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = path_ids_.find(path);
+  if (it != path_ids_.end()) {
+    return it->second;
+  }
+  if (path_ids_.size() > UINT16_MAX) {
+    return -1;
+  }
+  uint16_t id = path_ids_.size();
+  path_ids_.emplace(path, id);
+  return id;
+}
+
+std::shared_ptr<ThreadBuffer> Bridge::Register() {
+  auto buffer = std::make_shared<ThreadBuffer>();
+  std::lock_guard<std::mutex> lock(mu_);
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+void Bridge::RequestFlush() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    flush_requested_ = true;
+  }
+  cv_.notify_one();
+}
+
+void Bridge::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  flusher_.join();
+  close(socket_fd_);
+
+  uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+  if (dropped > 0) {
+    std::cerr << "ioctl sniffer dropped " << dropped
+              << " ioctls because it couldn't keep up\n";
+  }
+}
+
+void Bridge::Run() {
+  if (binary_) {
+    // The magic can't be mistaken for the size of a proto.
+    uint64_t magic = kBinaryMagic;
+    std::vector<iovec> iovs = {{&magic, sizeof(magic)}};
+    WriteAll(iovs);
+  }
+
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  for (;;) {
+    bool stopping;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait_for(lock, kFlushInterval,
+                   [this] { return flush_requested_ || stopping_; });
+      flush_requested_ = false;
+      stopping = stopping_;
+
+      // Buffers only referenced from here belong to threads that have exited.
+      // Their records were written by the previous flush unless the thread
+      // buffered more in between, in which case they are removed next time.
+      for (auto it = buffers_.begin(); it != buffers_.end();) {
+        if (it->use_count() == 1 && (*it)->data.empty()) {
+          it = buffers_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      buffers = buffers_;
+    }
+
+    Flush(buffers);
+    buffers.clear();
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+void Bridge::Flush(std::vector<std::shared_ptr<ThreadBuffer>> &buffers) {
+  std::vector<iovec> iovs;
+  for (auto &buffer : buffers) {
+    {
+      std::lock_guard<std::mutex> lock(buffer->mu);
+      buffer->data.swap(buffer->spare);
+    }
+    if (!buffer->spare.empty()) {
+      iovs.push_back({buffer->spare.data(), buffer->spare.size()});
+    }
+  }
+
+  // Each buffer only holds whole records, so records from different threads
+  // are never interleaved.
+  WriteAll(iovs);
+
+  for (auto &buffer : buffers) {
+    buffer->spare.clear();
+  }
+}
+
+void Bridge::WriteAll(std::vector<iovec> &iovs) {
+  size_t next = 0;
+  while (next < iovs.size()) {
+    int count = std::min<size_t>(iovs.size() - next, IOV_MAX);
+    ssize_t n = writev(socket_fd_, &iovs[next], count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Failed to write ioctls to socket: " << strerror(errno)
+                << "\n";
+      break;
+    }
+    while (n > 0) {
+      size_t len = std::min<size_t>(n, iovs[next].iov_len);
+      iovs[next].iov_base = static_cast<char *>(iovs[next].iov_base) + len;
+      iovs[next].iov_len -= len;
+      n -= len;
+      if (iovs[next].iov_len == 0) {
+        next++;
+      }
+    }
+  }
+}
+
+// bridge is the bridge of the current process, created on the first ioctl.
+// Bridges are never freed, since threads may still hold on to their buffers
+// after the bridge is stopped. Protected by bridge_mu.
+std::mutex bridge_mu;
+Bridge *bridge = nullptr;
+
+// exiting is set once the process starts exiting, after which ioctls are no
+// longer recorded. Protected by bridge_mu.
+bool exiting = false;
+
+// bridge_generation is incremented every time bridge changes, so that threads
+// notice that their buffer belongs to the parent after a fork.
+std::atomic<uint64_t> bridge_generation{0};
+
+void StopBridge() {
+  std::lock_guard<std::mutex> lock(bridge_mu);
+  exiting = true;
+  if (bridge != nullptr) {
+    bridge->Stop();
+    bridge = nullptr;
+    bridge_generation.fetch_add(1);
+  }
+}
+
+void PrepareFork() { bridge_mu.lock(); }
+
+void ParentAfterFork() { bridge_mu.unlock(); }
+
+// The flusher doesn't exist in the child, and the parent's records must not be
+// written twice, so the child leaks the parent's bridge and starts its own.
+void ChildAfterFork() {
+  bridge = nullptr;
+  bridge_generation.fetch_add(1);
+  bridge_mu.unlock();
+}
+
+// ThreadState is the buffer of the current thread, along with the generation
+// of the bridge it is registered with.
+struct ThreadState {
+  uint64_t generation = 0;
+  std::shared_ptr<ThreadBuffer> buffer;
+  Bridge *bridge = nullptr;
+  pid_t tid = 0;
+};
+
+thread_local ThreadState thread_state;
+
+// CurrentThreadState returns the state of the current thread, connecting to
+// the sniffer if needed, or nullptr if ioctls shouldn't be recorded anymore.
+ThreadState *CurrentThreadState() {
+  ThreadState &state = thread_state;
+  uint64_t generation = bridge_generation.load();
+  if (state.buffer != nullptr && state.generation == generation) {
+    return &state;
+  }
+
+  std::unique_lock<std::mutex> lock(bridge_mu);
+  static bool registered = false;
+  if (!registered) {
+    pthread_atfork(PrepareFork, ParentAfterFork, ChildAfterFork);
+    atexit(StopBridge);
+    registered = true;
+  }
+  if (bridge == nullptr && !exiting) {
+    // InitializeSocket exits on failure, which needs bridge_mu.
+    lock.unlock();
+    int socket_fd = InitializeSocket();
+    lock.lock();
+    if (bridge == nullptr && !exiting) {
+      const char *format = std::getenv("GVISOR_IOCTL_SNIFFER_FORMAT");
+      bool binary = format != nullptr && strcmp(format, "binary") == 0;
+      bridge = new Bridge(socket_fd, binary);
+      bridge->Start();
+    } else {
+      close(socket_fd);
+    }
+  }
+  if (exiting) {
+    return nullptr;
+  }
+  state.generation = bridge_generation.load();
+  state.buffer = bridge->Register();
+  state.bridge = bridge;
+  state.tid = gettid();
+  return &state;
+}
+
+// Append appends size bytes, which are filled in by fill, to the buffer of the
+// current thread. It returns false if the bytes were dropped because the
+// sniffer is too far behind.
+template <typename F>
+bool Append(ThreadState &state, size_t size, F fill) {
+  ThreadBuffer &buffer = *state.buffer;
+  bool flush;
+  {
+    std::lock_guard<std::mutex> lock(buffer.mu);
+    size_t offset = buffer.data.size();
+    if (offset + size > kMaxBufferedBytes) {
+      state.bridge->Drop();
+      return false;
+    }
+    buffer.data.resize(offset + size);
+    fill(&buffer.data[offset]);
+    flush = offset < kFlushBytes && buffer.data.size() >= kFlushBytes;
+  }
+  if (flush) {
+    state.bridge->RequestFlush();
+  }
+  return true;
+}
+
+void AppendProto(ThreadState &state, const IoctlRecord &record) {
+  gvisor::Ioctl ioctl;
+  ioctl.set_fd_path(*record.fd_path);
+  ioctl.set_device_class(*record.device_class);
+  ioctl.set_ret(record.ret);
+  if (record.mmap) {
+    const MmapArgs &args = *static_cast<const MmapArgs *>(record.arg_data);
+    gvisor::Mmap *mmap = ioctl.mutable_mmap();
+    mmap->set_addr(args.addr);
+    mmap->set_length(args.length);
+    mmap->set_offset(args.offset);
+    mmap->set_prot(args.prot);
+    mmap->set_flags(args.flags);
+  } else {
+    ioctl.set_request(record.request);
+    ioctl.set_arg_data(record.arg_data, record.arg_size);
+  }
+  ioctl.set_time_ns(record.time_ns);
+  ioctl.set_tid(state.tid);
+  ioctl.set_latency_ns(record.latency_ns);
+
+  uint64_t size = ioctl.ByteSizeLong();
+  Append(state, sizeof(size) + size, [&](char *buf) {
+    // Write size of the proto message first.
+    memcpy(buf, &size, sizeof(size));
+    ioctl.SerializeToArray(buf + sizeof(size), size);
+  });
+}
+
+void AppendBinary(ThreadState &state, const IoctlRecord &record) {
+  // Each thread defines the paths it uses, since the buffers of different
+  // threads may be written in any order.
+  auto &paths = state.buffer->paths;
+  int path_id = -1;
+  for (const auto &[path, id] : paths) {
+    if (path == *record.fd_path) {
+      path_id = id;
+      break;
+    }
+  }
+  bool define = path_id < 0;
+  if (define) {
+    path_id = state.bridge->PathID(*record.fd_path);
+    if (path_id < 0) {
+      state.bridge->Drop();
+      return;
+    }
+  }
+
+  BinaryRecordHeader header = {};
+  header.kind = record.mmap ? kBinaryRecordMmap : kBinaryRecordIoctl;
+  header.path_id = path_id;
+  header.size = record.arg_size;
+  header.request = record.request;
+  header.time_ns = record.time_ns;
+  header.latency_ns = record.latency_ns;
+  header.ret = record.ret;
+  header.tid = state.tid;
+
+  BinaryRecordHeader path_header = {};
+  size_t size = sizeof(header) + record.arg_size;
+  if (define) {
+    path_header.kind = kBinaryRecordPath;
+    path_header.path_id = path_id;
+    path_header.size =
+        record.fd_path->size() + 1 + record.device_class->size();
+    size += sizeof(path_header) + path_header.size;
+  }
+
+  bool appended = Append(state, size, [&](char *buf) {
+    if (define) {
+      memcpy(buf, &path_header, sizeof(path_header));
+      buf += sizeof(path_header);
+      memcpy(buf, record.fd_path->data(), record.fd_path->size());
+      buf += record.fd_path->size();
+      *buf++ = '\0';
+      memcpy(buf, record.device_class->data(), record.device_class->size());
+      buf += record.device_class->size();
+    }
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + sizeof(header), record.arg_data, record.arg_size);
+  });
+  if (define && appended) {
+    paths.emplace_back(*record.fd_path, path_id);
+  }
+}
+
+}  // namespace
+
+int InitializeSocket() {
   int sfd = socket(AF_UNIX, SOCK_STREAM, 0);
   if (sfd < 0) {
     std::cerr << "Failed to create socket: " << strerror(errno) << "\n";
@@ -52,22 +474,17 @@ void InitializeSocket() {
     exit(1);
   }
 
-  socket_owner_tid = gettid();
-  socket_fd = sfd;
+  return sfd;
 }
 
-void WriteIoctlProto(gvisor::Ioctl &ioctl) {
-  if (socket_owner_tid != gettid()) {
-    InitializeSocket();
+void WriteIoctl(const IoctlRecord &record) {
+  ThreadState *state = CurrentThreadState();
+  if (state == nullptr) {
+    return;
+  }
+  if (state->bridge->binary()) {
+    AppendBinary(*state, record);
+  } else {
+    AppendProto(*state, record);
   }
-
-  static thread_local std::vector<char> buffer;
-  uint64_t size = ioctl.ByteSizeLong();
-  buffer.resize(size + sizeof(size));
-
-  // Write size of the proto message first.
-  memcpy(buffer.data(), &size, sizeof(size));
-  ioctl.SerializeToArray(buffer.data() + sizeof(size), size);
-
-  write(socket_fd, buffer.data(), buffer.size());
 }
@@ -15,18 +15,98 @@
 #ifndef TOOLS_IOCTL_SNIFFER_SNIFFER_BRIDGE_H_
 #define TOOLS_IOCTL_SNIFFER_SNIFFER_BRIDGE_H_
 
+#include <stdint.h>
 #include <syscall.h>
 
-#include "tools/ioctl_sniffer/ioctl.pb.h"
+#include <string>
 
 inline pid_t gettid() { return syscall(SYS_gettid); }
 
-// Write the ioctl proto to the log output file descriptor. Our format is:
+// MmapArgs holds the arguments and result of an mmap(2) of a device. It's the
+// argument data of mmap records.
+struct MmapArgs {
+  // The address of the mapping, or MAP_FAILED.
+  uint64_t addr;
+  uint64_t length;
+  uint64_t offset;
+  int32_t prot;
+  int32_t flags;
+};
+
+static_assert(sizeof(MmapArgs) == 32, "MmapArgs must match sniffer_bridge.go");
+
+// IoctlRecord describes an ioctl, or an mmap(2) of a device, sent to the
+// sniffer.
+struct IoctlRecord {
+  // The path of the file that the file descriptor is pointing to.
+  const std::string *fd_path;
+
+  // The class of the device, e.g. "nvidia".
+  const std::string *device_class;
+
+  // Set if this is an mmap, in which case arg_data points to MmapArgs and
+  // request is unused.
+  bool mmap;
+
+  uint64_t request;
+
+  // The return value of the ioctl, or of the mmap after it's converted to 0
+  // or -1.
+  int32_t ret;
+
+  // The data pointed to by the argument, which may be empty.
+  const void *arg_data;
+  uint32_t arg_size;
+
+  // CLOCK_MONOTONIC time at which the ioctl returned.
+  uint64_t time_ns;
+
+  // How long the ioctl took, in nanoseconds.
+  uint64_t latency_ns;
+};
+
+// The sniffer supports two formats, which sniffer_bridge.go must match. The
+// format is chosen by setting GVISOR_IOCTL_SNIFFER_FORMAT to "proto" (the
+// default) or "binary".
+//
+// The proto format is a sequence of:
 //   - 8 byte little endian uint64 containing the size of the proto.
-//   - The proto bytes.
-// This should match the format in sniffer_bridge.go.
-void WriteIoctlProto(gvisor::Ioctl &ioctl);
+//   - The Ioctl proto bytes.
+//
+// The binary format starts with the 8 byte kBinaryMagic, followed by a
+// sequence of records made of a BinaryRecordHeader and the number of bytes
+// given by its size. Paths are sent once in kBinaryRecordPath records, which
+// must precede the kBinaryRecordIoctl and kBinaryRecordMmap records referring
+// to them. All integers are little endian.
+constexpr uint64_t kBinaryMagic = 0x314c54434f495647;  // "GVIOCTL1"
+
+// Followed by the path, a NUL byte and the device class. The NUL byte and the
+// device class are missing in recordings made before devices had classes.
+constexpr uint16_t kBinaryRecordPath = 1;
+constexpr uint16_t kBinaryRecordIoctl = 2;  // Followed by the arg data.
+constexpr uint16_t kBinaryRecordMmap = 3;   // Followed by MmapArgs.
+
+struct BinaryRecordHeader {
+  uint16_t kind;
+  uint16_t path_id;
+  uint32_t size;
+  uint64_t request;
+  uint64_t time_ns;
+  uint64_t latency_ns;
+  int32_t ret;
+  int32_t tid;
+};
+
+static_assert(sizeof(BinaryRecordHeader) == 40,
+              "BinaryRecordHeader must match sniffer_bridge.go");
+
+// Write the ioctl or mmap to the sniffer. Records are buffered per thread and
+// written to the socket in batches by a background thread, so this doesn't
+// block on the sniffer. Buffered records are written when the process exits,
+// and are dropped (and counted) if the sniffer falls too far behind.
+void WriteIoctl(const IoctlRecord &record);
 
-void InitializeSocket();
+// Connects to the sniffer and returns the socket.
+int InitializeSocket();
 
 #endif  // TOOLS_IOCTL_SNIFFER_SNIFFER_BRIDGE_H_
@@ -16,10 +16,15 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
@@ -27,7 +32,9 @@
 #include "clang/include/clang/AST/ASTContext.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/Expr.h"
+#include "clang/include/clang/AST/RecordLayout.h"
 #include "clang/include/clang/AST/Type.h"
+#include "clang/include/clang/Basic/SourceManager.h"
 #include "clang/include/clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/include/clang/ASTMatchers/ASTMatchers.h"
 #include "clang/include/clang/Tooling/CommonOptionsParser.h"
@@ -42,6 +49,7 @@ using clang::ast_matchers::hasName;
 using clang::ast_matchers::hasType;
 using clang::ast_matchers::recordDecl;
 using clang::ast_matchers::recordType;
+using clang::ast_matchers::translationUnitDecl;
 using clang::ast_matchers::typedefDecl;
 using clang::ast_matchers::typedefType;
 using clang::ast_matchers::varDecl;
@@ -50,12 +58,34 @@ using clang::ast_matchers::MatchFinder;
 
 using json = nlohmann::json;
 
+// Returns the 64-bit FNV-1a hash of data as a hex string. It is only used to
+// tell whether definitions changed, so it needn't be cryptographic, but it
+// must be stable across runs.
+static std::string ContentHash(const std::string &data) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return absl::StrCat(absl::Hex(hash, absl::kZeroPad16));
+}
+
 struct DriverStructReporter : public MatchFinder::MatchCallback {
   json RecordDefinitions;
   json TypeAliases;
   json Constants;
   absl::flat_hash_set<std::string> ParsedTypes;
 
+  // Files read while parsing the translation unit: the source file and every
+  // header it includes, directly or not.
+  std::set<std::string> Dependencies;
+
+  // Matches the translation unit itself, once parsing is done, to record its
+  // dependencies.
+  auto get_translation_unit_matcher() {
+    return translationUnitDecl().bind("translation_unit");
+  }
+
   // This matches the case where a struct is being defined.
   // E.g.
   // typedef struct {
@@ -92,6 +122,15 @@ struct DriverStructReporter : public MatchFinder::MatchCallback {
   void run(const MatchFinder::MatchResult &result) override {
     const auto *ctx = result.Context;
 
+    if (result.Nodes.getNodeAs<clang::TranslationUnitDecl>(
+            "translation_unit")) {
+      const clang::SourceManager &sm = *result.SourceManager;
+      for (auto it = sm.fileinfo_begin(); it != sm.fileinfo_end(); ++it) {
+        Dependencies.insert(std::string(it->first.getName()));
+      }
+      return;
+    }
+
     const auto *constant_decl =
         result.Nodes.getNodeAs<clang::VarDecl>("constant_decl");
     if (constant_decl) {
@@ -170,9 +209,16 @@ struct DriverStructReporter : public MatchFinder::MatchCallback {
   void add_record_definition(const clang::RecordDecl *record_decl,
                              const std::string &name,
                              const clang::ASTContext *ctx) {
+    // The record layout holds the offsets, size and alignment that the
+    // compiler computed for this record.
+    const clang::ASTRecordLayout &layout =
+        ctx->getASTRecordLayout(record_decl);
+
     json fields;
     for (const auto *field : record_decl->fields()) {
       auto field_type = field->getType();
+      uint64_t field_size =
+          ctx->getTypeSizeInChars(field_type).getQuantity();
 
       // If this is an array type, save the array size then get the underlying
       // element type to recurse on later.
@@ -204,14 +250,15 @@ struct DriverStructReporter : public MatchFinder::MatchCallback {
         absl::StrAppend(&field_type_name, "[", array_size, "]");
       }
 
-      // getFieldOffset returns the size in bits, so we divide by 8 to get
+      // getFieldOffset returns the offset in bits, so we divide by 8 to get
       // bytes.
-      uint64_t offset = ctx->getFieldOffset(field) / 8;
+      uint64_t offset = layout.getFieldOffset(field->getFieldIndex()) / 8;
 
       // Add field to json.
       fields.push_back(json::object({{"name", field->getNameAsString()},
                                      {"type", field_type_name},
-                                     {"offset", offset}}));
+                                     {"offset", offset},
+                                     {"size", field_size}}));
 
       // Recurse on the field type.
       add_type_definition(field_type, base_type_name, ctx);
@@ -219,16 +266,18 @@ struct DriverStructReporter : public MatchFinder::MatchCallback {
 
     std::string source =
         record_decl->getLocation().printToString(ctx->getSourceManager());
-    // getTypeSize returns the size in bits, so we divide by 8 to get bytes.
-    uint64_t size =
-        ctx->getTypeSize(
-            record_decl->getASTContext().getCanonicalTagType(record_decl)) /
-        8;
+    uint64_t size = layout.getSize().getQuantity();
+    uint64_t alignment = layout.getAlignment().getQuantity();
     bool is_union = record_decl->isUnion();
-    RecordDefinitions[name] = json::object({{"source", source},
-                                            {"fields", fields},
-                                            {"size", size},
-                                            {"is_union", is_union}});
+    json definition = json::object({{"fields", fields},
+                                    {"size", size},
+                                    {"alignment", alignment},
+                                    {"is_union", is_union}});
+    // The hash covers the layout but not the source location, which moves
+    // between driver versions without changing the definition.
+    definition["hash"] = ContentHash(definition.dump());
+    definition["source"] = source;
+    RecordDefinitions[name] = definition;
   }
 };
 
@@ -250,6 +299,45 @@ static llvm::cl::opt<std::string> OutputFile(
                    "By default, will print to stdout."),
     llvm::cl::cat(DriverASTParserCategory));
 
+static llvm::cl::opt<unsigned> Jobs(
+    "jobs", "j",
+    llvm::cl::desc("Number of source files to parse in parallel. By default, "
+                   "uses one thread per CPU."),
+    llvm::cl::init(0), llvm::cl::cat(DriverASTParserCategory));
+
+// Parses the given source file, and adds the definitions found for the names
+// in input to output.
+static int ParseSourceFile(
+    const clang::tooling::CompilationDatabase &compilations,
+    const std::string &source, const json &input, json *output) {
+  clang::tooling::ClangTool Tool(compilations, {source});
+
+  DriverStructReporter reporter;
+  MatchFinder finder;
+  finder.addMatcher(reporter.get_translation_unit_matcher(), &reporter);
+  for (json::const_iterator it = input["structs"].begin();
+       it != input["structs"].end(); ++it) {
+    finder.addMatcher(reporter.get_struct_definition_matcher(*it), &reporter);
+    finder.addMatcher(reporter.get_struct_typedef_matcher(*it), &reporter);
+  }
+
+  if (input.contains("constants")) {
+    for (json::const_iterator it = input["constants"].begin();
+         it != input["constants"].end(); ++it) {
+      finder.addMatcher(reporter.get_constant_matcher(*it), &reporter);
+    }
+  }
+
+  // Run tool
+  int ret = Tool.run(clang::tooling::newFrontendActionFactory(&finder).get());
+
+  *output = json::object({{"records", reporter.RecordDefinitions},
+                          {"aliases", reporter.TypeAliases},
+                          {"constants", reporter.Constants},
+                          {"dependencies", reporter.Dependencies}});
+  return ret;
+}
+
 int main(int argc, const char **argv) {
   auto ExpectedParser = clang::tooling::CommonOptionsParser::create(
       argc, argv, DriverASTParserCategory);
@@ -260,11 +348,7 @@ int main(int argc, const char **argv) {
   }
 
   clang::tooling::CommonOptionsParser &OptionsParser = ExpectedParser.get();
-  clang::tooling::ClangTool Tool(OptionsParser.getCompilations(),
-                                 OptionsParser.getSourcePathList());
-
-  DriverStructReporter reporter;
-  MatchFinder finder;
+  const std::vector<std::string> &sources = OptionsParser.getSourcePathList();
 
   // Read from StructNames file.
   std::ifstream InputFileIS(InputFile);
@@ -274,26 +358,52 @@ int main(int argc, const char **argv) {
   }
   json input;
   InputFileIS >> input;
-  for (json::iterator it = input["structs"].begin();
-       it != input["structs"].end(); ++it) {
-    finder.addMatcher(reporter.get_struct_definition_matcher(*it), &reporter);
-    finder.addMatcher(reporter.get_struct_typedef_matcher(*it), &reporter);
-  }
 
-  if (input.contains("constants")) {
-    for (json::iterator it = input["constants"].begin();
-         it != input["constants"].end(); ++it) {
-      finder.addMatcher(reporter.get_constant_matcher(*it), &reporter);
+  // Each source file is a separate translation unit, with its own AST, so
+  // they are parsed in parallel and their definitions merged afterwards.
+  std::vector<json> outputs(sources.size());
+  std::vector<int> rets(sources.size());
+  std::atomic<size_t> next_source = 0;
+  auto worker = [&] {
+    for (size_t i = next_source++; i < sources.size(); i = next_source++) {
+      rets[i] = ParseSourceFile(OptionsParser.getCompilations(), sources[i],
+                                input, &outputs[i]);
     }
+  };
+  unsigned jobs = Jobs != 0 ? Jobs : std::thread::hardware_concurrency();
+  jobs = std::max(1u, std::min<unsigned>(jobs, sources.size()));
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < jobs; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
   }
 
-  // Run tool
-  int ret = Tool.run(clang::tooling::newFrontendActionFactory(&finder).get());
+  // Merge the definitions found in each source file.
+  json output = json::object({{"records", json::object()},
+                              {"aliases", json::object()},
+                              {"constants", json::object()}});
+  std::set<std::string> dependencies;
+  int ret = 0;
+  for (size_t i = 0; i < sources.size(); i++) {
+    for (const char *key : {"records", "aliases", "constants"}) {
+      // Empty definitions are null rather than empty objects.
+      if (outputs[i][key].is_object()) {
+        output[key].update(outputs[i][key]);
+      }
+    }
+    for (const auto &dependency : outputs[i]["dependencies"]) {
+      dependencies.insert(dependency.get<std::string>());
+    }
+    if (rets[i] != 0) {
+      ret = rets[i];
+    }
+  }
+  output["dependencies"] = dependencies;
 
   // Print output.
-  json output = json::object({{"records", reporter.RecordDefinitions},
-                              {"aliases", reporter.TypeAliases},
-                              {"constants", reporter.Constants}});
   if (OutputFile.empty()) {
     std::cout << output.dump() << "\n";
   } else {
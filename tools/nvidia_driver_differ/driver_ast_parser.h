@@ -40,12 +40,22 @@ field mapping each name to its definition, a "aliases" field for any aliases
 that were found, as well as a "constants" field mapping each name to its value.
 A variety of information is outputted:
 - For records, the fields are given as a JSON array of objects with "name",
-  "type", and "offset" keys. The record also has a "size" key indicating the
-  size of the struct in bytes, an "is_union" key indicating whether it is a
-  union or not, and a "source" key containing the file name and line number
-  where it was defined.
+  "type", "offset" and "size" keys, with the offset and size in bytes. The
+  record also has a "size" key indicating the size of the struct in bytes, an
+  "alignment" key indicating its alignment in bytes, an "is_union" key
+  indicating whether it is a union or not, a "source" key containing the
+  file name and line number where it was defined, and a "hash" key holding a
+  hash of everything but the source, which is equal for records with the same
+  layout.
 - For aliases, the type is given as a JSON object with a "type" and "size" key
 
+The output also has a "dependencies" field listing every file read while
+parsing the source files, i.e. the sources and the headers they include. The
+definitions only change if one of these files does.
+
+When multiple source files are given, each is parsed as a separate translation
+unit in parallel (see --jobs), and the definitions found are merged.
+
 Example usage:
     driver_ast_parser --input=input.json -o=output.json driver_source_files.h
 
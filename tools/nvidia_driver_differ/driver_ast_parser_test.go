@@ -56,7 +56,7 @@ func TestParser(t *testing.T) {
 	}()
 
 	input := parser.InputJSON{
-		Structs: []string{"TestStruct", "TestStruct2"},
+		Structs: []string{"TestStruct", "TestStruct2", "TestPaddedStruct"},
 		Constants: []string{
 			"VAR_CONSTANT_MACRO",
 			"VAR_ADDITION_MACRO",
@@ -89,48 +89,65 @@ func TestParser(t *testing.T) {
 		Records: parser.RecordDefs{
 			"TestStruct": parser.RecordDef{
 				Fields: []parser.RecordField{
-					{Name: "a", Type: "int", Offset: 0},
-					{Name: "b", Type: "int", Offset: 4},
-					{Name: "e", Type: "TestStruct::e_t[4]", Offset: 8},
-					{Name: "f", Type: "TestUnion", Offset: 40},
+					{Name: "a", Type: "int", Offset: 0, Size: 4},
+					{Name: "b", Type: "int", Offset: 4, Size: 4},
+					{Name: "e", Type: "TestStruct::e_t[4]", Offset: 8, Size: 32},
+					{Name: "f", Type: "TestUnion", Offset: 40, Size: 4},
 				},
-				Size:    44,
-				IsUnion: false,
-				Source:  "test_struct.cc:25:16",
+				Size:      44,
+				Alignment: 4,
+				IsUnion:   false,
+				Source:    "test_struct.cc:25:16",
 			},
 			"TestStruct2": parser.RecordDef{
 				Fields: []parser.RecordField{
-					{Name: "a", Type: "int", Offset: 0},
-					{Name: "b", Type: "int", Offset: 4},
-					{Name: "e", Type: "TestStruct::e_t[4]", Offset: 8},
-					{Name: "f", Type: "TestUnion", Offset: 40},
+					{Name: "a", Type: "int", Offset: 0, Size: 4},
+					{Name: "b", Type: "int", Offset: 4, Size: 4},
+					{Name: "e", Type: "TestStruct::e_t[4]", Offset: 8, Size: 32},
+					{Name: "f", Type: "TestUnion", Offset: 40, Size: 4},
 				},
-				Size:    44,
-				IsUnion: false,
-				Source:  "test_struct.cc:25:16",
+				Size:      44,
+				Alignment: 4,
+				IsUnion:   false,
+				Source:    "test_struct.cc:25:16",
 			},
 			"TestStruct::e_t": parser.RecordDef{
 				Fields: []parser.RecordField{
-					{Name: "c", Type: "OtherInt", Offset: 0},
-					{Name: "d", Type: "OtherInt", Offset: 4},
+					{Name: "c", Type: "OtherInt", Offset: 0, Size: 4},
+					{Name: "d", Type: "OtherInt", Offset: 4, Size: 4},
 				},
-				Size:    8,
-				IsUnion: false,
-				Source:  "test_struct.cc:28:3",
+				Size:      8,
+				Alignment: 4,
+				IsUnion:   false,
+				Source:    "test_struct.cc:28:3",
 			},
 			"TestUnion": parser.RecordDef{
 				Fields: []parser.RecordField{
-					{Name: "u_a", Type: "int", Offset: 0},
-					{Name: "u_b", Type: "int", Offset: 0},
+					{Name: "u_a", Type: "int", Offset: 0, Size: 4},
+					{Name: "u_b", Type: "int", Offset: 0, Size: 4},
 				},
-				Size:    4,
-				IsUnion: true,
-				Source:  "test_struct.cc:20:9",
+				Size:      4,
+				Alignment: 4,
+				IsUnion:   true,
+				Source:    "test_struct.cc:20:9",
+			},
+			"TestPaddedStruct": parser.RecordDef{
+				Fields: []parser.RecordField{
+					{Name: "a", Type: "char", Offset: 0, Size: 1},
+					{Name: "b", Type: "long", Offset: 8, Size: 8},
+					{Name: "c", Type: "char", Offset: 16, Size: 1},
+				},
+				Size:      24,
+				Alignment: 8,
+				IsUnion:   false,
+				Source:    "test_struct.cc:50:16",
 			},
 		},
 		Aliases: parser.TypeAliases{
 			"OtherInt": parser.TypeDef{Type: "int", Size: 4},
+			"char":     parser.TypeDef{Type: "char", Size: 1},
 			"int":      parser.TypeDef{Type: "int", Size: 4},
+			"long":     parser.TypeDef{Type: "long", Size: 8},
 		},
 		Constants: map[string]uint64{
 			"VAR_CONSTANT_MACRO":          0x1469,
@@ -141,10 +158,38 @@ func TestParser(t *testing.T) {
 		},
 	}
 
-	if diff := cmp.Diff(expectedOutput, outputJSON, cmpopts.IgnoreFields(parser.RecordDef{}, "Source")); diff != "" {
+	if diff := cmp.Diff(expectedOutput, outputJSON, cmpopts.IgnoreFields(parser.RecordDef{}, "Source", "Hash"), cmpopts.IgnoreFields(parser.OutputJSON{}, "Dependencies")); diff != "" {
 		t.Fatalf("output mismatch (-want +got):\n%s", diff)
 	}
 
+	// Records with the same definition have the same hash.
+	records := outputJSON.Records
+	if records["TestStruct"].Hash == "" {
+		t.Errorf("TestStruct has no hash")
+	}
+	if !records["TestStruct"].SameHash(records["TestStruct2"]) {
+		t.Errorf("TestStruct and TestStruct2 have different hashes: %q and %q", records["TestStruct"].Hash, records["TestStruct2"].Hash)
+	}
+	if records["TestStruct"].SameHash(records["TestPaddedStruct"]) {
+		t.Errorf("TestStruct and TestPaddedStruct have the same hash %q", records["TestStruct"].Hash)
+	}
+
+	foundSource := false
+	for _, dependency := range outputJSON.Dependencies {
+		if strings.HasSuffix(dependency, "test_struct.cc") {
+			foundSource = true
+		}
+	}
+	if !foundSource {
+		t.Errorf("dependencies %v don't include test_struct.cc", outputJSON.Dependencies)
+	}
+
+	for name, want := range map[string]uint64{"TestStruct": 0, "TestUnion": 0, "TestPaddedStruct": 14} {
+		if got := outputJSON.Records[name].Padding(); got != want {
+			t.Errorf("padding mismatch for %s: got %d, want %d", name, got, want)
+		}
+	}
+
 	// Only check the source suffix since the absolute path will be different every run.
 	for name, structDef := range outputJSON.Records {
 		if !strings.HasSuffix(structDef.Source, expectedOutput.Records[name].Source) {
@@ -79,6 +79,7 @@ func CreateIncludeFiles(dir string, driverSource DriverSourceDir, nonUVMIoctls,
 		nonUVMFile.Name(),
 		driverSource.GetNonUVMIncludePaths(),
 	)
+	configNonUVM.Sources = includeSources
 
 	// Create include file for uvm sources
 	UVMFile, err := os.CreateTemp(dir, "include_uvm_*.cc")
@@ -96,6 +97,7 @@ func CreateIncludeFiles(dir string, driverSource DriverSourceDir, nonUVMIoctls,
 		UVMFile.Name(),
 		driverSource.GetUVMIncludePaths(),
 	)
+	configUVM.Sources = includeSources
 
 	return []ClangASTConfig{configNonUVM, configUVM}, nil
 }
@@ -0,0 +1,236 @@
+// Copyright 2024 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package parser
+
+import (
+	"bytes"
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"slices"
+	"sort"
+	"strings"
+)
+
+// versionPlaceholder replaces the driver version in paths of cached
+// definitions, so that they can be reused across versions.
+const versionPlaceholder = "{version}"
+
+// sourcePaths maps the paths of a driver source tree to paths that are the
+// same for all driver versions.
+type sourcePaths struct {
+	// dir is the directory the parser runs in, which holds the source tree.
+	dir     string
+	version string
+}
+
+// normalize returns path relative to the parser directory, with the driver
+// version replaced by versionPlaceholder.
+func (p sourcePaths) normalize(path string) string {
+	path = strings.ReplaceAll(path, p.dir+"/", "")
+	return strings.ReplaceAll(path, p.version, versionPlaceholder)
+}
+
+// restore reverses normalize.
+func (p sourcePaths) restore(path string) string {
+	return strings.ReplaceAll(path, versionPlaceholder, p.version)
+}
+
+// resolved returns the path of a file in the parser directory.
+func (p sourcePaths) resolved(path string) string {
+	if filepath.IsAbs(path) {
+		return path
+	}
+	return filepath.Join(p.dir, path)
+}
+
+// hashFile adds name and the contents of the file at path to h.
+func hashFile(h io.Writer, name, path string) error {
+	f, err := os.Open(path)
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+	info, err := f.Stat()
+	if err != nil {
+		return err
+	}
+	fmt.Fprintf(h, "%s\x00%d\x00", name, info.Size())
+	_, err = io.Copy(h, f)
+	return err
+}
+
+// unitKey returns a key identifying a translation unit regardless of the
+// headers it includes. It covers the parser, its input, the translation unit
+// and its include directories.
+func (r *Runner) unitKey(config ClangASTConfig, paths sourcePaths) (string, error) {
+	h := sha256.New()
+	if err := hashFile(h, "parser", r.parserPath); err != nil {
+		return "", err
+	}
+	if err := hashFile(h, "input", r.inputPath); err != nil {
+		return "", err
+	}
+
+	// The translation unit includes the sources by path, and defines
+	// constants for the ioctls.
+	unit, err := os.ReadFile(config.Filename)
+	if err != nil {
+		return "", err
+	}
+	fmt.Fprintf(h, "%s\x00", paths.normalize(string(unit)))
+	for _, include := range config.Includes {
+		fmt.Fprintf(h, "%s\x00", paths.normalize(include))
+	}
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
+
+// cacheKey returns a key identifying the definitions parsed from a
+// translation unit, given its unitKey and the files it depends on. Only
+// dependencies are read, so translation units that include few headers are
+// cheap to check, and translation units whose headers are unchanged between
+// driver versions have the same key.
+func cacheKey(unit string, dependencies []string, paths sourcePaths) (string, error) {
+	h := sha256.New()
+	fmt.Fprintf(h, "%s\x00", unit)
+	for _, dependency := range dependencies {
+		data, err := os.ReadFile(paths.resolved(paths.restore(dependency)))
+		switch {
+		case errors.Is(err, fs.ErrNotExist):
+			// A dependency that is gone changes the key, and cannot be
+			// mistaken for an empty file.
+			fmt.Fprintf(h, "%s\x00missing\x00", dependency)
+			continue
+		case err != nil:
+			return "", err
+		}
+		// Headers that only differ by the driver version they embed, e.g.
+		// in version strings, define the same records.
+		data = bytes.ReplaceAll(data, []byte(paths.version), []byte(versionPlaceholder))
+		fmt.Fprintf(h, "%s\x00%d\x00", dependency, len(data))
+		h.Write(data)
+	}
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
+
+// loadDependencies returns the dependencies recorded for the translation
+// unit identified by unit, or nil if there are none.
+func (r *Runner) loadDependencies(unit string) []string {
+	data, err := os.ReadFile(filepath.Join(r.cacheDir, unit+".deps.json"))
+	if err != nil {
+		return nil
+	}
+	var dependencies []string
+	if err := json.Unmarshal(data, &dependencies); err != nil {
+		return nil
+	}
+	return dependencies
+}
+
+// storeDependencies records the dependencies of the translation unit
+// identified by unit, as the union of known and parsed, and returns them.
+// Taking the union rather than replacing known lets driver versions that
+// include different headers share the record, without invalidating each
+// other's cached definitions every time they are parsed in turn.
+func (r *Runner) storeDependencies(unit string, known, parsed []string, paths sourcePaths) ([]string, error) {
+	union := make(map[string]struct{}, len(known)+len(parsed))
+	for _, dependency := range known {
+		union[dependency] = struct{}{}
+	}
+	for _, dependency := range parsed {
+		union[paths.normalize(dependency)] = struct{}{}
+	}
+	dependencies := make([]string, 0, len(union))
+	for dependency := range union {
+		dependencies = append(dependencies, dependency)
+	}
+	sort.Strings(dependencies)
+	if slices.Equal(dependencies, known) {
+		return dependencies, nil
+	}
+	data, err := json.Marshal(dependencies)
+	if err != nil {
+		return nil, err
+	}
+	return dependencies, r.writeCacheFile(unit+".deps.json", data)
+}
+
+// normalizeSources rewrites the source location of the records in defs with
+// f.
+func normalizeSources(defs *OutputJSON, f func(string) string) {
+	for name, record := range defs.Records {
+		record.Source = f(record.Source)
+		defs.Records[name] = record
+	}
+}
+
+// loadCached returns the definitions cached under key, or nil if there are
+// none.
+func (r *Runner) loadCached(key string, paths sourcePaths) *OutputJSON {
+	data, err := os.ReadFile(filepath.Join(r.cacheDir, key+".json"))
+	if err != nil {
+		return nil
+	}
+	var defs OutputJSON
+	if err := json.Unmarshal(data, &defs); err != nil {
+		return nil
+	}
+	normalizeSources(&defs, paths.restore)
+	return &defs
+}
+
+// storeCached caches defs under key.
+func (r *Runner) storeCached(key string, defs OutputJSON, paths sourcePaths) error {
+	cached := OutputJSON{
+		Records:   make(RecordDefs, len(defs.Records)),
+		Aliases:   defs.Aliases,
+		Constants: defs.Constants,
+	}
+	for name, record := range defs.Records {
+		cached.Records[name] = record
+	}
+	normalizeSources(&cached, paths.normalize)
+	data, err := json.Marshal(cached)
+	if err != nil {
+		return err
+	}
+	return r.writeCacheFile(key+".json", data)
+}
+
+// writeCacheFile writes data to the file name in the cache directory.
+func (r *Runner) writeCacheFile(name string, data []byte) error {
+	// Write to a temporary file first, so that concurrent runs never see a
+	// partial entry.
+	f, err := os.CreateTemp(r.cacheDir, name+".*.tmp")
+	if err != nil {
+		return err
+	}
+	if _, err := f.Write(data); err != nil {
+		f.Close()
+		os.Remove(f.Name())
+		return err
+	}
+	if err := f.Close(); err != nil {
+		os.Remove(f.Name())
+		return err
+	}
+	return os.Rename(f.Name(), filepath.Join(r.cacheDir, name))
+}
@@ -26,6 +26,11 @@ type ClangASTConfig struct {
 	Directory string   `json:"directory"`
 	Arguments []string `json:"arguments"`
 	Filename  string   `json:"file"`
+
+	// Includes lists the include directories, and Sources the files included
+	// by Filename. They determine the definitions parsed from Filename.
+	Includes []string `json:"-"`
+	Sources  []string `json:"-"`
 }
 
 // NewParserConfig creates a ClangASTConfig for the given file using the list of includes.
@@ -40,6 +45,7 @@ func NewParserConfig(directory, filename string, includes []string) ClangASTConf
 		Directory: directory,
 		Arguments: args,
 		Filename:  filename,
+		Includes:  includes,
 	}
 }
 
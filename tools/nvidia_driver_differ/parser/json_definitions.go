@@ -35,6 +35,10 @@ type OutputJSON struct {
 	Records   RecordDefs
 	Aliases   TypeAliases
 	Constants map[string]uint64
+
+	// Dependencies are the files read while parsing: the sources and every
+	// header they include.
+	Dependencies []string `json:",omitempty"`
 }
 
 // Merge merges the struct definitions from b into this OutputJSON.
@@ -51,6 +55,7 @@ func (a *OutputJSON) Merge(b OutputJSON) {
 	maps.Copy(a.Records, b.Records)
 	maps.Copy(a.Aliases, b.Aliases)
 	maps.Copy(a.Constants, b.Constants)
+	a.Dependencies = append(a.Dependencies, b.Dependencies...)
 }
 
 // RecordField represents a field in a record (struct or union).
@@ -58,6 +63,7 @@ type RecordField struct {
 	Name   string
 	Type   string
 	Offset uint64
+	Size   uint64
 }
 
 func (s RecordField) String() string {
@@ -66,15 +72,54 @@ func (s RecordField) String() string {
 
 // RecordDef represents the definition of a record (struct or union).
 type RecordDef struct {
-	Fields  []RecordField
-	Size    uint64
-	IsUnion bool `json:"is_union"`
-	Source  string
+	Fields    []RecordField
+	Size      uint64
+	Alignment uint64
+	IsUnion   bool `json:"is_union"`
+	Source    string
+
+	// Hash is a hash of the definition computed by driver_ast_parser. It
+	// covers everything but the source, so records with equal hashes have
+	// the same definition.
+	Hash string `json:",omitempty"`
+}
+
+// SameHash returns true if both record definitions have a hash and their
+// hashes are equal, which means they don't need to be compared field by
+// field.
+func (s RecordDef) SameHash(other RecordDef) bool {
+	return s.Hash != "" && s.Hash == other.Hash
 }
 
 // Equals returns true if the two record definitions are equal. We ignore the source of the records.
 func (s RecordDef) Equals(other RecordDef) bool {
-	return s.IsUnion == other.IsUnion && s.Size == other.Size && slices.Equal(s.Fields, other.Fields)
+	return s.IsUnion == other.IsUnion && s.Size == other.Size && s.Alignment == other.Alignment && slices.Equal(s.Fields, other.Fields)
+}
+
+// Padding returns the number of bytes in the record that are not covered by
+// any field, i.e. the padding inserted between fields and at the end of the
+// record. For unions, this is the space beyond the largest field.
+func (s RecordDef) Padding() uint64 {
+	var used uint64
+	if s.IsUnion {
+		for _, field := range s.Fields {
+			used = max(used, field.Size)
+		}
+	} else {
+		// Bit fields may share storage, so count each byte range once.
+		var end uint64
+		for _, field := range s.Fields {
+			start := max(field.Offset, end)
+			if fieldEnd := field.Offset + field.Size; fieldEnd > start {
+				used += fieldEnd - start
+				end = fieldEnd
+			}
+		}
+	}
+	if used >= s.Size {
+		return 0
+	}
+	return s.Size - used
 }
 
 // TypeDef represents the definition of a type.
@@ -110,6 +155,12 @@ func GetRecordDiff(name string, a, b RecordDef) string {
 	if a.Size != b.Size {
 		fmt.Fprintf(&sb, "  size: %d -> %d (bytes)\n", a.Size, b.Size)
 	}
+	if a.Alignment != b.Alignment {
+		fmt.Fprintf(&sb, "  alignment: %d -> %d (bytes)\n", a.Alignment, b.Alignment)
+	}
+	if aPad, bPad := a.Padding(), b.Padding(); aPad != bPad {
+		fmt.Fprintf(&sb, "  padding: %d -> %d (bytes)\n", aPad, bPad)
+	}
 	fmt.Fprint(&sb, cmp.Diff(a.Fields, b.Fields))
 
 	return sb.String()
@@ -17,10 +17,12 @@ package parser
 import (
 	"bytes"
 	"encoding/json"
+	"errors"
 	"fmt"
 	"os"
 	"os/exec"
 	"strings"
+	"sync"
 
 	"gvisor.dev/gvisor/pkg/sentry/devices/nvproxy"
 	"gvisor.dev/gvisor/pkg/sentry/devices/nvproxy/nvconf"
@@ -35,6 +37,10 @@ type Runner struct {
 
 	nonUVMIoctls []nvproxy.IoctlName
 	uvmIoctls    []nvproxy.IoctlName
+
+	// cacheDir, if not empty, is where the definitions parsed from each
+	// translation unit are cached.
+	cacheDir string
 }
 
 // NewRunner creates a new Runner around a given parser file and a temporary working directory.
@@ -56,6 +62,18 @@ func (r *Runner) Cleanup() error {
 	return os.RemoveAll(r.dir)
 }
 
+// SetCacheDir makes the runner cache the definitions parsed from each
+// translation unit in dir. Translation units that are unchanged between driver
+// versions, along with all the headers they may include, are then only parsed
+// once.
+func (r *Runner) SetCacheDir(dir string) error {
+	if err := os.MkdirAll(dir, 0755); err != nil {
+		return fmt.Errorf("failed to create cache directory: %w", err)
+	}
+	r.cacheDir = dir
+	return nil
+}
+
 // CreateInputFile saves a list of structs for the runner to parse.
 func (r *Runner) CreateInputFile(info *nvproxy.DriverABIInfo) error {
 	numNonUvm := len(info.FrontendInfos) + len(info.ControlInfos) + len(info.AllocationInfos)
@@ -141,16 +159,81 @@ func (r *Runner) parseSourceFile(sourcePath string) (*OutputJSON, error) {
 	return &defs, nil
 }
 
-// runParserConfig runs the driver_ast_parser on the given config options and merges all the
-// JSON outputs into a single OutputJSON.
-func (r *Runner) runParserConfig(config []ClangASTConfig) (*OutputJSON, error) {
-	var allDefs *OutputJSON = nil
-	for _, config := range config {
-		defs, err := r.parseSourceFile(config.Filename)
+// parseConfig runs the driver_ast_parser on a single translation unit, unless
+// its definitions are cached. Cached definitions are looked up by the
+// contents of the files the translation unit depended on when it was last
+// parsed, so only translation units whose headers changed are parsed again.
+func (r *Runner) parseConfig(config ClangASTConfig, paths sourcePaths) (*OutputJSON, error) {
+	var unit string
+	var dependencies []string
+	if r.cacheDir != "" {
+		var err error
+		if unit, err = r.unitKey(config, paths); err != nil {
+			return nil, fmt.Errorf("failed to compute cache key: %w", err)
+		}
+		if dependencies = r.loadDependencies(unit); dependencies != nil {
+			key, err := cacheKey(unit, dependencies, paths)
+			if err != nil {
+				return nil, fmt.Errorf("failed to compute cache key: %w", err)
+			}
+			if defs := r.loadCached(key, paths); defs != nil {
+				return defs, nil
+			}
+		}
+	}
+
+	defs, err := r.parseSourceFile(config.Filename)
+	if err != nil {
+		return nil, fmt.Errorf("failed to parse source file: %w", err)
+	}
+	// Report sources relative to the parser directory, whether or not they
+	// come from the cache.
+	normalizeSources(defs, func(source string) string {
+		return strings.ReplaceAll(source, paths.dir+"/", "")
+	})
+
+	if unit != "" {
+		// Paths of dependencies are relative to the working directory of
+		// the compile command, which is the parser directory.
+		for i, dependency := range defs.Dependencies {
+			defs.Dependencies[i] = paths.resolved(dependency)
+		}
+		dependencies, err := r.storeDependencies(unit, dependencies, defs.Dependencies, paths)
+		if err != nil {
+			return nil, fmt.Errorf("failed to cache dependencies: %w", err)
+		}
+		key, err := cacheKey(unit, dependencies, paths)
 		if err != nil {
-			return nil, fmt.Errorf("failed to parse source file: %w", err)
+			return nil, fmt.Errorf("failed to compute cache key: %w", err)
 		}
+		if err := r.storeCached(key, *defs, paths); err != nil {
+			return nil, fmt.Errorf("failed to cache definitions: %w", err)
+		}
+	}
+	return defs, nil
+}
+
+// runParserConfig runs the driver_ast_parser on the given config options and merges all the
+// JSON outputs into a single OutputJSON. Each translation unit is parsed in parallel.
+func (r *Runner) runParserConfig(config []ClangASTConfig, paths sourcePaths) (*OutputJSON, error) {
+	results := make([]*OutputJSON, len(config))
+	errs := make([]error, len(config))
+	var wg sync.WaitGroup
+	for i, config := range config {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			results[i], errs[i] = r.parseConfig(config, paths)
+		}()
+	}
+	wg.Wait()
+	if err := errors.Join(errs...); err != nil {
+		return nil, err
+	}
 
+	// Merge in order, so that the result doesn't depend on scheduling.
+	var allDefs *OutputJSON = nil
+	for _, defs := range results {
 		if allDefs == nil {
 			allDefs = defs
 		} else {
@@ -185,7 +268,7 @@ func (r *Runner) ParseDriver(version nvconf.DriverVersion) (*OutputJSON, error)
 		return nil, fmt.Errorf("failed to create compile_commands.json: %w", err)
 	}
 
-	defs, err := r.runParserConfig(config)
+	defs, err := r.runParserConfig(config, sourcePaths{dir: dir, version: source.Name()})
 	if err != nil {
 		return nil, fmt.Errorf("failed to run driver_ast_parser: %w", err)
 	}
@@ -19,6 +19,8 @@ import (
 	"flag"
 	"fmt"
 	"os"
+	"path/filepath"
+	"sync"
 
 	"gvisor.dev/gvisor/tools/nvidia_driver_differ/parser"
 
@@ -32,8 +34,19 @@ import (
 var (
 	baseVersionString = flag.String("base", "", "The first version to compare. This is the version that will be used as the base for the diff.")
 	nextVersionString = flag.String("next", "", "The second version to compare.")
+	largeStructSize   = flag.Uint64("large_struct_size", 4096, "Structs used by ioctls that are at least this many bytes in the next version are reported, since nvproxy copies them in and out of the sandbox on every call.")
+	cacheDir          = flag.String("cache_dir", defaultCacheDir(), "Directory where parsed definitions are cached, so that sources that are unchanged between driver versions aren't parsed again. Set to empty to disable caching.")
 )
 
+// defaultCacheDir returns the default value of --cache_dir.
+func defaultCacheDir() string {
+	dir, err := os.UserCacheDir()
+	if err != nil {
+		return ""
+	}
+	return filepath.Join(dir, "gvisor", "nvidia_driver_differ")
+}
+
 //go:embed driver_ast_parser
 var driverParserBinary []byte
 
@@ -107,22 +120,41 @@ func Main() error {
 		return fmt.Errorf("failed to create temporary structs list: %w", err)
 	}
 
-	// Run driver_ast_parser on .cc files for both versions
-	log.Infof("Parsing driver version %s", baseVersion)
-	baseDefs, err := runner.ParseDriver(baseVersion)
-	if err != nil {
-		return fmt.Errorf("failed to run driver_ast_parser on base version: %w", err)
+	if *cacheDir != "" {
+		if err := runner.SetCacheDir(*cacheDir); err != nil {
+			return fmt.Errorf("failed to set up cache: %w", err)
+		}
 	}
-	log.Infof("Parsing driver version %s", nextVersion)
-	nextDefs, err := runner.ParseDriver(nextVersion)
-	if err != nil {
-		return fmt.Errorf("failed to run driver_ast_parser on next version: %w", err)
+
+	// Run driver_ast_parser on .cc files for both versions in parallel.
+	log.Infof("Parsing driver versions %s and %s", baseVersion, nextVersion)
+	var (
+		baseDefs, nextDefs *parser.OutputJSON
+		baseErr, nextErr   error
+		wg                 sync.WaitGroup
+	)
+	wg.Add(2)
+	go func() {
+		defer wg.Done()
+		baseDefs, baseErr = runner.ParseDriver(baseVersion)
+	}()
+	go func() {
+		defer wg.Done()
+		nextDefs, nextErr = runner.ParseDriver(nextVersion)
+	}()
+	wg.Wait()
+	if baseErr != nil {
+		return fmt.Errorf("failed to run driver_ast_parser on base version: %w", baseErr)
+	}
+	if nextErr != nil {
+		return fmt.Errorf("failed to run driver_ast_parser on next version: %w", nextErr)
 	}
 
 	// Create set of all records found in both versions. This will be a superset of the list of
 	// structs generated above, since the Clang tool also reports recursive and anonymous structs.
 	log.Infof("Comparing record definitions between %s and %s", baseVersion, nextVersion)
 	recordsFound := make(map[nvproxy.DriverStructName]struct{})
+	unchangedRecords := 0
 	for name := range baseDefs.Records {
 		recordsFound[name] = struct{}{}
 	}
@@ -144,10 +176,15 @@ func Main() error {
 			continue
 		}
 
+		if baseRecordDef.SameHash(nextRecordDef) {
+			unchangedRecords++
+			continue
+		}
 		if !baseRecordDef.Equals(nextRecordDef) {
 			log.Infof("\n%v", parser.GetRecordDiff(name, baseRecordDef, nextRecordDef))
 		}
 	}
+	log.Infof("%d of %d records have identical hashes", unchangedRecords, len(recordsFound))
 
 	log.Infof("Comparing type aliases between %s and %s", baseVersion, nextVersion)
 	aliasesFound := make(map[nvproxy.DriverStructName]struct{})
@@ -201,7 +238,8 @@ func Main() error {
 		}
 	}
 
-	// Check if any constants or structs from the input list were missing.
+	// Check if any constants or structs from the input list were missing, and
+	// report structs that are expensive to copy.
 	var missingStructs []nvproxy.DriverStructName
 	var missingConstants []nvproxy.IoctlName
 	checkMissing := func(ioctl nvproxy.IoctlInfo) {
@@ -214,6 +252,9 @@ func Main() error {
 			if !isRecord && !isAlias {
 				missingStructs = append(missingStructs, structDef.Name)
 			}
+			if record, ok := nextDefs.Records[structDef.Name]; ok && record.Size >= *largeStructSize {
+				log.Infof("ioctl %s uses large struct %s: %d bytes (%d bytes of padding)", ioctl.Name, structDef.Name, record.Size, record.Padding())
+			}
 		}
 		if _, ok := constantsFound[ioctl.Name]; !ok {
 			missingConstants = append(missingConstants, ioctl.Name)
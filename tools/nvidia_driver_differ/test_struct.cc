@@ -46,3 +46,9 @@ const unsigned int VAR_ADDITION_MACRO = ADDITION_MACRO;
 const unsigned int VAR_UNSIGNED_HEX_MACRO = UNSIGNED_HEX_MACRO;
 const unsigned int VAR_PARENTHESIZED_HEX_MACRO = PARENTHESIZED_HEX_MACRO;
 const unsigned int VAR_USES_FUNCTION_MACRO = USES_FUNCTION_MACRO;
+
+typedef struct TestPaddedStruct {
+  char a;
+  long b;
+  char c;
+} TestPaddedStruct;
@@ -0,0 +1,77 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package main implements a tool that prints the overhead of gVisor platforms
+// over native execution for the benchmarks in //test/perf.
+//
+// It reads the test logs of the <binary>_native and <binary>_runsc_<platform>
+// targets generated by syscall_test, e.g.:
+//
+//	perfdiff --testlogs=bazel-testlogs/test/perf --platforms=systrap,kvm
+//
+// Other variants can be compared by naming them as platforms. For example,
+// hostinet is compared with netstack for the socket benchmarks generated with
+// add_hostinet by:
+//
+//	perfdiff --testlogs=bazel-testlogs/test/perf --baseline=systrap --platforms=systrap_hostnet
+package main
+
+import (
+	"fmt"
+	"os"
+	"strings"
+
+	"gvisor.dev/gvisor/runsc/flag"
+	"gvisor.dev/gvisor/tools/perfdiff"
+)
+
+var (
+	flagTestLogs  = flag.String("testlogs", "", "path to the bazel-testlogs directory of //test/perf.")
+	flagBaseline  = flag.String("baseline", "native", "runsc platform to compare with, or native.")
+	flagPlatforms = flag.String("platforms", "systrap,kvm", "comma-separated list of runsc platforms to compare with the baseline.")
+	flagCSV       = flag.Bool("csv", false, "print comma-separated values instead of a table.")
+)
+
+func main() {
+	flag.Parse()
+	if *flagTestLogs == "" {
+		flag.CommandLine.Usage()
+		os.Exit(1)
+	}
+	baseline := targetPlatform(*flagBaseline)
+	var others []string
+	for _, p := range strings.Split(*flagPlatforms, ",") {
+		if p = strings.TrimSpace(p); p != "" {
+			others = append(others, targetPlatform(p))
+		}
+	}
+	byPlatform, err := perfdiff.CollectTestLogs(*flagTestLogs, append([]string{baseline}, others...))
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Failed to read test logs: %v\n", err)
+		os.Exit(1)
+	}
+	if err := perfdiff.WriteTable(os.Stdout, byPlatform, baseline, others, *flagCSV); err != nil {
+		fmt.Fprintf(os.Stderr, "Failed to write results: %v\n", err)
+		os.Exit(1)
+	}
+}
+
+// targetPlatform returns the suffix of syscall_test target names for the
+// platform p.
+func targetPlatform(p string) string {
+	if p == "native" {
+		return p
+	}
+	return "runsc_" + p
+}
@@ -0,0 +1,198 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package perfdiff compares the results of the same Google Benchmark
+// binaries run natively and on gVisor platforms.
+package perfdiff
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"regexp"
+	"sort"
+	"strconv"
+	"strings"
+	"text/tabwriter"
+)
+
+// resultRE matches a result line of Google Benchmark console output, e.g.:
+//
+//	BM_Getpid/real_time/threads:4        126 ns          136 ns       400000
+var resultRE = regexp.MustCompile(`^(BM_\S+)\s+([0-9.]+) (ns|us|ms|s)\s+[0-9.]+ (?:ns|us|ms|s)\s+\d+`)
+
+// aggregateSuffixes are the suffixes of lines that Google Benchmark prints
+// for repeated benchmarks, in addition to the results of each repetition.
+var aggregateSuffixes = []string{"_mean", "_median", "_stddev", "_cv"}
+
+var unitNS = map[string]float64{
+	"ns": 1,
+	"us": 1e3,
+	"ms": 1e6,
+	"s":  1e9,
+}
+
+// Results maps benchmark names to all of their measured times in nanoseconds.
+type Results map[string][]float64
+
+// ParseOutput parses Google Benchmark console output and adds the wall time of
+// each benchmark to r. Names are prefixed with prefix.
+func (r Results) ParseOutput(in io.Reader, prefix string) error {
+	s := bufio.NewScanner(in)
+	for s.Scan() {
+		m := resultRE.FindStringSubmatch(strings.TrimSpace(s.Text()))
+		if m == nil {
+			continue
+		}
+		name := m[1]
+		aggregate := false
+		for _, suffix := range aggregateSuffixes {
+			if strings.HasSuffix(name, suffix) {
+				aggregate = true
+				break
+			}
+		}
+		if aggregate {
+			continue
+		}
+		v, err := strconv.ParseFloat(m[2], 64)
+		if err != nil {
+			return fmt.Errorf("invalid time in %q: %w", s.Text(), err)
+		}
+		name = prefix + name
+		r[name] = append(r[name], v*unitNS[m[3]])
+	}
+	return s.Err()
+}
+
+// Median returns the median time of the benchmark name, and false if there are
+// no results for it.
+func (r Results) Median(name string) (float64, bool) {
+	vs := r[name]
+	if len(vs) == 0 {
+		return 0, false
+	}
+	sorted := append([]float64(nil), vs...)
+	sort.Float64s(sorted)
+	n := len(sorted)
+	if n%2 == 1 {
+		return sorted[n/2], true
+	}
+	return (sorted[n/2-1] + sorted[n/2]) / 2, true
+}
+
+// CollectTestLogs reads the results of all benchmarks under dir, which is laid
+// out like bazel-testlogs/test/perf: each test target has a directory named
+// <binary>_<platform> with a test.log file (or several, one per shard).
+//
+// It returns the results of each of platforms. Benchmark names are prefixed
+// with "<binary>:".
+func CollectTestLogs(dir string, platforms []string) (map[string]Results, error) {
+	byPlatform := make(map[string]Results)
+	for _, p := range platforms {
+		byPlatform[p] = make(Results)
+	}
+	err := filepath.Walk(dir, func(path string, info os.FileInfo, err error) error {
+		if err != nil {
+			return err
+		}
+		if info.IsDir() || info.Name() != "test.log" {
+			return nil
+		}
+		rel, err := filepath.Rel(dir, path)
+		if err != nil {
+			return err
+		}
+		target := strings.Split(rel, string(filepath.Separator))[0]
+		// Use the longest matching platform, so that e.g. runsc_systrap
+		// isn't mistaken for a systrap variant of a binary named runsc.
+		platform := ""
+		for _, p := range platforms {
+			if strings.HasSuffix(target, "_"+p) && len(p) > len(platform) {
+				platform = p
+			}
+		}
+		if platform == "" {
+			return nil
+		}
+		binary := strings.TrimSuffix(target, "_"+platform)
+		f, err := os.Open(path)
+		if err != nil {
+			return err
+		}
+		defer f.Close()
+		return byPlatform[platform].ParseOutput(f, binary+":")
+	})
+	return byPlatform, err
+}
+
+// WriteTable writes a table with the median time of each benchmark on the
+// baseline platform, and the median time and its ratio to the baseline on
+// each of the other platforms.
+//
+// If csv is true, the table is written as comma-separated values with one
+// time and one ratio column per platform.
+func WriteTable(w io.Writer, byPlatform map[string]Results, baseline string, others []string, csv bool) error {
+	names := make(map[string]struct{})
+	for _, r := range byPlatform {
+		for name := range r {
+			names[name] = struct{}{}
+		}
+	}
+	sorted := make([]string, 0, len(names))
+	for name := range names {
+		sorted = append(sorted, name)
+	}
+	sort.Strings(sorted)
+
+	sep := "\t"
+	tw := tabwriter.NewWriter(w, 0, 8, 2, ' ', 0)
+	out := io.Writer(tw)
+	if csv {
+		sep = ","
+		out = w
+	}
+
+	header := []string{"benchmark", baseline + " (ns)"}
+	for _, p := range others {
+		header = append(header, p+" (ns)", p+"/"+baseline)
+	}
+	fmt.Fprintln(out, strings.Join(header, sep))
+	for _, name := range sorted {
+		base, haveBase := byPlatform[baseline].Median(name)
+		row := []string{name, formatNS(base, haveBase)}
+		for _, p := range others {
+			v, ok := byPlatform[p].Median(name)
+			ratio := "-"
+			if ok && haveBase && base > 0 {
+				ratio = strconv.FormatFloat(v/base, 'f', 2, 64)
+			}
+			row = append(row, formatNS(v, ok), ratio)
+		}
+		fmt.Fprintln(out, strings.Join(row, sep))
+	}
+	if csv {
+		return nil
+	}
+	return tw.Flush()
+}
+
+func formatNS(v float64, ok bool) string {
+	if !ok {
+		return "-"
+	}
+	return strconv.FormatFloat(v, 'f', 1, 64)
+}
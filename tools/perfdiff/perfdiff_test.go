@@ -0,0 +1,125 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package perfdiff
+
+import (
+	"bytes"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+const output = `Running /tmp/getpid_benchmark
+Run on (8 X 2000 MHz CPU s)
+-------------------------------------------------------------------------
+Benchmark                               Time             CPU   Iterations
+-------------------------------------------------------------------------
+BM_Getpid                             100 ns          100 ns      7000000
+BM_Getppid/real_time/threads:4       1.50 us         1.60 us       400000
+BM_Getppid/real_time/threads:4       2.50 us         2.60 us       400000
+BM_Getppid/real_time/threads:4_mean  2.00 us         2.10 us            2
+`
+
+func TestParseOutput(t *testing.T) {
+	r := make(Results)
+	if err := r.ParseOutput(strings.NewReader(output), "getpid:"); err != nil {
+		t.Fatalf("ParseOutput failed: %v", err)
+	}
+	if len(r) != 2 {
+		t.Errorf("got %d benchmarks, want 2: %v", len(r), r)
+	}
+	if got, ok := r.Median("getpid:BM_Getpid"); !ok || got != 100 {
+		t.Errorf("Median(BM_Getpid) = %v, %v, want 100, true", got, ok)
+	}
+	if got, ok := r.Median("getpid:BM_Getppid/real_time/threads:4"); !ok || got != 2000 {
+		t.Errorf("Median(BM_Getppid) = %v, %v, want 2000, true", got, ok)
+	}
+	if _, ok := r.Median("getpid:BM_Missing"); ok {
+		t.Errorf("Median(BM_Missing) succeeded")
+	}
+}
+
+func TestCollectTestLogs(t *testing.T) {
+	dir := t.TempDir()
+	logs := map[string]string{
+		"getpid_benchmark_native/test.log":                     "BM_Getpid  100 ns  100 ns  1000\n",
+		"getpid_benchmark_runsc_systrap/shard_1_of_2/test.log": "BM_Getpid  300 ns  300 ns  1000\n",
+		"getpid_benchmark_runsc_systrap/shard_2_of_2/test.log": "BM_Getpid  500 ns  500 ns  1000\n",
+		"getpid_benchmark_runsc_systrap_overlay/test.log":      "BM_Getpid  900 ns  900 ns  1000\n",
+		"unrelated/test.log":                                   "BM_Getpid  1 ns  1 ns  1000\n",
+	}
+	for path, data := range logs {
+		path = filepath.Join(dir, path)
+		if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+			t.Fatalf("MkdirAll failed: %v", err)
+		}
+		if err := os.WriteFile(path, []byte(data), 0644); err != nil {
+			t.Fatalf("WriteFile failed: %v", err)
+		}
+	}
+
+	byPlatform, err := CollectTestLogs(dir, []string{"native", "runsc_systrap", "runsc_kvm"})
+	if err != nil {
+		t.Fatalf("CollectTestLogs failed: %v", err)
+	}
+	if got, ok := byPlatform["native"].Median("getpid_benchmark:BM_Getpid"); !ok || got != 100 {
+		t.Errorf("native median = %v, %v, want 100, true", got, ok)
+	}
+	if got, ok := byPlatform["runsc_systrap"].Median("getpid_benchmark:BM_Getpid"); !ok || got != 400 {
+		t.Errorf("systrap median = %v, %v, want 400, true", got, ok)
+	}
+
+	var buf bytes.Buffer
+	if err := WriteTable(&buf, byPlatform, "native", []string{"runsc_systrap", "runsc_kvm"}, true); err != nil {
+		t.Fatalf("WriteTable failed: %v", err)
+	}
+	want := "benchmark,native (ns),runsc_systrap (ns),runsc_systrap/native,runsc_kvm (ns),runsc_kvm/native\n" +
+		"getpid_benchmark:BM_Getpid,100.0,400.0,4.00,-,-\n"
+	if got := buf.String(); got != want {
+		t.Errorf("WriteTable:\ngot:\n%s\nwant:\n%s", got, want)
+	}
+}
+
+func TestCollectTestLogsVariants(t *testing.T) {
+	dir := t.TempDir()
+	logs := map[string]string{
+		"tcp_benchmark_runsc_systrap/test.log":         "BM_TCP  200 ns  200 ns  1000\n",
+		"tcp_benchmark_runsc_systrap_hostnet/test.log": "BM_TCP  100 ns  100 ns  1000\n",
+	}
+	for path, data := range logs {
+		path = filepath.Join(dir, path)
+		if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+			t.Fatalf("MkdirAll failed: %v", err)
+		}
+		if err := os.WriteFile(path, []byte(data), 0644); err != nil {
+			t.Fatalf("WriteFile failed: %v", err)
+		}
+	}
+
+	byPlatform, err := CollectTestLogs(dir, []string{"runsc_systrap", "runsc_systrap_hostnet"})
+	if err != nil {
+		t.Fatalf("CollectTestLogs failed: %v", err)
+	}
+	var buf bytes.Buffer
+	if err := WriteTable(&buf, byPlatform, "runsc_systrap", []string{"runsc_systrap_hostnet"}, true); err != nil {
+		t.Fatalf("WriteTable failed: %v", err)
+	}
+	want := "benchmark,runsc_systrap (ns),runsc_systrap_hostnet (ns),runsc_systrap_hostnet/runsc_systrap\n" +
+		"tcp_benchmark:BM_TCP,200.0,100.0,0.50\n"
+	if got := buf.String(); got != want {
+		t.Errorf("WriteTable:\ngot:\n%s\nwant:\n%s", got, want)
+	}
+}
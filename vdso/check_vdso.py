@@ -184,6 +184,89 @@ def CheckRelocs(vdso_path):
     Fatal("VDSO contains relocations: %s", output)
 
 
+# Symbols that the VDSO must export, by ELF machine as reported by readelf.
+_EXPECTED_SYMBOLS = {
+    "Advanced Micro Devices X86-64": [
+        "__kernel_rt_sigreturn",
+        "__vdso_clock_getres",
+        "__vdso_clock_gettime",
+        "__vdso_getcpu",
+        "__vdso_getrandom",
+        "__vdso_gettimeofday",
+        "__vdso_time",
+        "clock_getres",
+        "clock_gettime",
+        "getcpu",
+        "gettimeofday",
+        "time",
+    ],
+    "AArch64": [
+        "__kernel_clock_getres",
+        "__kernel_clock_gettime",
+        "__kernel_getrandom",
+        "__kernel_gettimeofday",
+        "__kernel_rt_sigreturn",
+    ],
+}
+
+_MACHINE_RE = re.compile(r"^\s+Machine:\s+(?P<machine>.*\S)\s*$")
+
+_DYNSYM_RE = re.compile(r"""^\s+\d+:\s+
+                            (?P<value>[0-9a-f]+)\s+
+                            \d+\s+
+                            (?P<type>\S+)\s+
+                            (?P<bind>\S+)\s+
+                            \S+\s+
+                            (?P<ndx>\S+)\s+
+                            (?P<name>[^@\s]+)""", re.VERBOSE)
+
+
+def CheckSymbols(vdso_path):
+  """Verifies the VDSO exports the expected functions.
+
+  The readelf line format looks like:
+
+  Symbol table '.dynsym' contains 13 entries:
+     Num:    Value          Size Type    Bind   Vis      Ndx Name
+       0: 0000000000000000     0 NOTYPE  LOCAL  DEFAULT  UND
+       1: ffffffffff701010   104 FUNC    WEAK   DEFAULT   11 clock_gettime@@LINUX_2.6
+     ...
+
+  Args:
+    vdso_path: Path to VDSO binary.
+  """
+  output = subprocess.check_output(["readelf", "-hW", vdso_path]).decode()
+  machine = None
+  for line in output.split("\n"):
+    m = re.search(_MACHINE_RE, line)
+    if m:
+      machine = m.group("machine")
+      break
+
+  if machine not in _EXPECTED_SYMBOLS:
+    Fatal("VDSO has unexpected machine %r:\n%s", machine, output)
+
+  output = subprocess.check_output(["readelf", "--dyn-syms", "-W",
+                                    vdso_path]).decode()
+  exported = set()
+  for line in output.split("\n"):
+    m = re.search(_DYNSYM_RE, line)
+    if not m:
+      continue
+
+    if m.group("type") != "FUNC" or m.group("ndx") == "UND":
+      continue
+
+    if m.group("bind") not in ("GLOBAL", "WEAK"):
+      continue
+
+    exported.add(m.group("name"))
+
+  missing = [s for s in _EXPECTED_SYMBOLS[machine] if s not in exported]
+  if missing:
+    Fatal("VDSO does not export %s:\n%s", ", ".join(missing), output)
+
+
 def main():
   parser = argparse.ArgumentParser(description="Verify VDSO ELF.")
   parser.add_argument("--vdso", required=True, help="Path to VDSO ELF")
@@ -195,6 +278,7 @@ def main():
 
   CheckSegments(args.vdso)
   CheckRelocs(args.vdso)
+  CheckSymbols(args.vdso)
 
   if args.check_data:
     CheckData(args.vdso)
@@ -18,30 +18,59 @@
 #include <stdint.h>
 
 #include "vdso/barrier.h"
+#include "vdso/params.h"
 
 namespace vdso {
 
 #if __x86_64__
 
-// TODO(b/74613497): The appropriate barrier instruction to use with rdtsc on
-// x86_64 depends on the vendor. Intel processors can use lfence but AMD may
-// need mfence, depending on MSR_F10H_DECFG_LFENCE_SERIALIZE_BIT.
+// cycle_clock returns the current value of the cycle counter, using the
+// ordering sequence selected by mode (one of kCycleClock* in params.h).
+static inline uint64_t cycle_clock(uint64_t mode) {
+  uint32_t lo, hi;
+  if (mode == kCycleClockRDTSCP) {
+    uint32_t aux;
+    asm volatile("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux) : : "memory");
+  } else {
+    if (mode == kCycleClockMFence) {
+      asm volatile("mfence" : : : "memory");
+    } else {
+      asm volatile("lfence" : : : "memory");
+    }
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  }
+  return ((uint64_t)hi << 32) | lo;
+}
 
-static inline uint64_t cycle_clock(void) {
+// cycle_clock_unordered is cycle_clock without the barrier, so the counter may
+// be read before preceding instructions complete.
+static inline uint64_t cycle_clock_unordered(void) {
   uint32_t lo, hi;
-  asm volatile("lfence" : : : "memory");
   asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
   return ((uint64_t)hi << 32) | lo;
 }
 
 #elif __aarch64__
 
-static inline uint64_t cycle_clock(void) {
+// cycle_clock returns the current value of the virtual counter, read as
+// selected by mode (one of kCycleClock* in params.h).
+static inline uint64_t cycle_clock(uint64_t mode) {
   uint64_t val;
-  asm volatile("mrs %0, CNTVCT_EL0" : "=r"(val)::"memory");
+  if (mode == kCycleClockCNTVCTSS) {
+    // CNTVCTSS_EL0, spelled by its encoding for older assemblers.
+    asm volatile("mrs %0, S3_3_C14_C0_6" : "=r"(val)::"memory");
+  } else {
+    asm volatile("mrs %0, CNTVCT_EL0" : "=r"(val)::"memory");
+  }
   return val;
 }
 
+// cycle_clock_unordered reads CNTVCT_EL0, which isn't ordered against
+// preceding instructions.
+static inline uint64_t cycle_clock_unordered(void) {
+  return cycle_clock(kCycleClockCNTVCT);
+}
+
 #else
 #error "unsupported architecture"
 #endif
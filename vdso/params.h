@@ -0,0 +1,155 @@
+// Copyright 2018 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VDSO_PARAMS_H_
+#define VDSO_PARAMS_H_
+
+#include <stdint.h>
+
+// Values of params_data.getcpu_mode.
+//
+// These must be kept in sync with vdsoGetcpu* in pkg/sentry/kernel/vdso.go.
+enum {
+  // getcpu() must make a system call.
+  kGetcpuSyscall = 0,
+
+  // The sandbox has a single CPU, so getcpu() always returns CPU 0.
+  kGetcpuSingleCPU = 1,
+
+  // The sentry stores the CPU number in IA32_TSC_AUX, so getcpu() can read
+  // it with rdtscp.
+  kGetcpuTSCAux = 2,
+};
+
+// Values of params_data.cycle_clock_mode, selecting the instruction sequence
+// used to read the cycle counter. The sentry picks one at boot based on the
+// host CPU.
+//
+// These must be kept in sync with vdsoCycleClock* in pkg/sentry/kernel.
+#if __x86_64__
+enum {
+  // lfence; rdtsc. lfence orders rdtsc on Intel, and on AMD when the host
+  // kernel enables MSR_F10H_DECFG_LFENCE_SERIALIZE_BIT.
+  kCycleClockLFence = 0,
+
+  // mfence; rdtsc. Needed on AMD CPUs without RDTSCP.
+  kCycleClockMFence = 1,
+
+  // rdtscp, which waits for all preceding instructions on either vendor
+  // without also serializing the instructions that follow.
+  kCycleClockRDTSCP = 2,
+};
+#elif __aarch64__
+enum {
+  // mrs CNTVCT_EL0, without an isb. The read may be speculated ahead of
+  // preceding instructions.
+  kCycleClockCNTVCT = 0,
+
+  // mrs CNTVCTSS_EL0, the self-synchronized view of the virtual counter
+  // added by FEAT_ECV (ARMv8.6), which is read in program order without an
+  // isb.
+  kCycleClockCNTVCTSS = 1,
+};
+#endif
+
+// struct clock_params holds the parameters of a single clock in struct
+// params_data.
+//
+// It must be kept in sync with the corresponding fields of vdsoParams in
+// pkg/sentry/kernel/vdso.go.
+//
+// Elapsed cycles are converted to nanoseconds as (cycles * mult) >> shift,
+// where mult and shift are precomputed by the sentry from frequency.
+struct clock_params {
+  uint64_t ready;
+  int64_t base_cycles;
+  int64_t base_ref;
+  uint64_t frequency;
+  uint64_t mult;
+  uint64_t shift;
+};
+
+// struct params_data holds one generation of the parameters in struct params.
+//
+// It must be kept in sync with vdsoParams in pkg/sentry/kernel/vdso.go.
+struct params_data {
+  struct clock_params monotonic;
+  struct clock_params realtime;
+
+  uint64_t getcpu_mode;
+  uint64_t cycle_clock_mode;
+
+  // Offset of CLOCK_TAI from CLOCK_REALTIME in nanoseconds. Only meaningful
+  // if realtime.ready is set.
+  int64_t tai_offset;
+
+  // Changes whenever getrandom() states must fetch a new key with the
+  // getrandom system call. If 0, getrandom() must make a system call.
+  uint64_t rng_generation;
+};
+
+// struct params defines the layout of the parameter page maintained by the
+// kernel (i.e., sentry).
+//
+// This is similar to the VVAR page maintained by the normal Linux kernel for
+// its VDSO, but it has a different layout.
+//
+// The parameters are double-buffered and protected by seq_count as a latch,
+// like Linux's seqcount_latch_t: readers use data[seq_count & 1], and the
+// sentry writes the other copy before incrementing seq_count to switch
+// readers to it. Readers therefore never wait for an update to finish; they
+// only retry if an update overtook their read. While the sentry updates its
+// clocks, readers are switched to a copy in which no clock is ready, so that
+// they make system calls rather than use the previous parameters.
+//
+// It must be kept in sync with VDSOParamPage in pkg/sentry/kernel/vdso.go.
+struct params {
+  uint64_t seq_count;
+
+  struct params_data data[2];
+};
+
+// Returns a pointer to the global parameter page.
+//
+// This page lives in the page just before the VDSO binary itself. The linker
+// defines _params as the page before the VDSO.
+//
+// Ideally, we'd simply declare _params as an extern struct params.
+// Unfortunately various combinations of old/new versions of gcc/clang and
+// gold/bfd struggle to generate references to such a global without generating
+// relocations.
+//
+// So instead, we use inline assembly with a construct that seems to have wide
+// compatibility across many toolchains.
+#if __x86_64__
+
+inline struct params* get_params() {
+  struct params* p = nullptr;
+  asm("leaq _params(%%rip), %0" : "=r"(p) : :);
+  return p;
+}
+
+#elif __aarch64__
+
+inline struct params* get_params() {
+  struct params* p = nullptr;
+  asm("adr %0, _params" : "=r"(p) : :);
+  return p;
+}
+
+#else
+#error "unsupported architecture"
+#endif
+
+#endif  // VDSO_PARAMS_H_
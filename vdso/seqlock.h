@@ -23,13 +23,15 @@
 
 namespace vdso {
 
-inline int32_t read_seqcount_begin(const uint64_t* s) {
+// read_seqcount_latch() begins a read of latched data, as described in struct
+// params. The low bit of the returned value selects the copy to read.
+inline uint64_t read_seqcount_latch(const uint64_t* s) {
   uint64_t seq = *s;
   read_barrier();
-  return seq & ~1;
+  return seq;
 }
 
-inline int read_seqcount_retry(const uint64_t* s, uint64_t seq) {
+inline int read_seqcount_latch_retry(const uint64_t* s, uint64_t seq) {
   read_barrier();
   return unlikely(*s != seq);
 }
@@ -13,13 +13,16 @@
 // limitations under the License.
 
 // This is the VDSO for sandboxed binaries. This file just contains the entry
-// points to the VDSO. All of the real work is done in vdso_time.cc
+// points to the VDSO. All of the real work is done in vdso_time.cc,
+// vdso_getcpu.cc and vdso_getrandom.cc.
 
 #define _DEFAULT_SOURCE  // ensure glibc provides struct timezone.
 #include <sys/time.h>
 #include <time.h>
 
 #include "vdso/syscalls.h"
+#include "vdso/vdso_getcpu.h"
+#include "vdso/vdso_getrandom.h"
 #include "vdso/vdso_time.h"
 
 namespace vdso {
@@ -29,22 +32,37 @@ int __common_clock_gettime(clockid_t clock, struct timespec* ts) {
   int ret;
 
   switch (clock) {
-    case CLOCK_REALTIME_COARSE:
-      // Fallthrough, CLOCK_REALTIME_COARSE is an alias for CLOCK_REALTIME
     case CLOCK_REALTIME:
       ret = ClockRealtime(ts);
       break;
 
+    case CLOCK_REALTIME_COARSE:
+      ret = ClockRealtimeCoarse(ts);
+      break;
+
+    case CLOCK_TAI:
+      ret = ClockTAI(ts);
+      break;
+
     case CLOCK_BOOTTIME:
-      // Fallthrough, CLOCK_BOOTTIME is an alias for CLOCK_MONOTONIC
+      // Fallthrough, CLOCK_BOOTTIME is an alias for CLOCK_MONOTONIC, as in the
+      // sentry: gVisor has no concept of suspend.
     case CLOCK_MONOTONIC_RAW:
-      // Fallthrough, CLOCK_MONOTONIC_RAW is an alias for CLOCK_MONOTONIC
-    case CLOCK_MONOTONIC_COARSE:
-      // Fallthrough, CLOCK_MONOTONIC_COARSE is an alias for CLOCK_MONOTONIC
+      // Fallthrough, CLOCK_MONOTONIC_RAW is approximated by CLOCK_MONOTONIC
     case CLOCK_MONOTONIC:
       ret = ClockMonotonic(ts);
       break;
 
+    case CLOCK_MONOTONIC_COARSE:
+      ret = ClockMonotonicCoarse(ts);
+      break;
+
+    case CLOCK_PROCESS_CPUTIME_ID:
+      // Fallthrough, CPU-time clocks are per-task state. The parameter page is
+      // shared by every task in the sandbox, and the VDSO has no per-thread
+      // anchor through which the sentry could publish a task's accumulated
+      // CPU time, so these always go to the sentry.
+    case CLOCK_THREAD_CPUTIME_ID:
     default:
       ret = sys_clock_gettime(clock, ts);
       break;
@@ -53,15 +71,41 @@ int __common_clock_gettime(clockid_t clock, struct timespec* ts) {
   return ret;
 }
 
+int __common_clock_getres(clockid_t clock, struct timespec* res) {
+  int ret = 0;
+
+  switch (clock) {
+    case CLOCK_REALTIME:
+    case CLOCK_REALTIME_COARSE:
+    case CLOCK_TAI:
+    case CLOCK_MONOTONIC:
+    case CLOCK_MONOTONIC_COARSE:
+    case CLOCK_MONOTONIC_RAW:
+    case CLOCK_BOOTTIME: {
+      // The sentry reports a resolution of 1ns for every clock.
+      if (res == nullptr) {
+        return 0;
+      }
+
+      res->tv_sec = 0;
+      res->tv_nsec = 1;
+      break;
+    }
+
+    default:
+      ret = sys_clock_getres(clock, res);
+      break;
+  }
+
+  return ret;
+}
+
 int __common_gettimeofday(struct timeval* tv, struct timezone* tz) {
   if (tv) {
-    struct timespec ts;
-    int ret = ClockRealtime(&ts);
+    int ret = GettimeofdayRealtime(tv);
     if (ret) {
       return ret;
     }
-    tv->tv_sec = ts.tv_sec;
-    tv->tv_usec = ts.tv_nsec / 1000;
   }
 
   // Nobody should be calling gettimeofday() with a non-NULL
@@ -99,25 +143,36 @@ extern "C" int gettimeofday(struct timeval* tv, struct timezone* tz)
 
 // __vdso_time() implements time()
 extern "C" time_t __vdso_time(time_t* t) {
-  struct timespec ts;
-  ClockRealtime(&ts);
+  time_t now = TimeRealtime();
   if (t) {
-    *t = ts.tv_sec;
+    *t = now;
   }
-  return ts.tv_sec;
+  return now;
 }
 extern "C" time_t time(time_t* t) __attribute__((weak, alias("__vdso_time")));
 
+// __vdso_clock_getres() implements clock_getres()
+extern "C" int __vdso_clock_getres(clockid_t clock, struct timespec* res) {
+  return __common_clock_getres(clock, res);
+}
+extern "C" int clock_getres(clockid_t clock, struct timespec* res)
+    __attribute__((weak, alias("__vdso_clock_getres")));
+
 // __vdso_getcpu() implements getcpu()
 extern "C" long __vdso_getcpu(unsigned* cpu, unsigned* node,
                               struct getcpu_cache* cache) {
-  // No optimizations yet, just make the real system call.
-  return sys_getcpu(cpu, node, cache);
+  return GetCPU(cpu, node, cache);
 }
 extern "C" long getcpu(unsigned* cpu, unsigned* node,
                        struct getcpu_cache* cache)
     __attribute__((weak, alias("__vdso_getcpu")));
 
+// __vdso_getrandom() implements getrandom()
+extern "C" ssize_t __vdso_getrandom(void* buf, size_t len, unsigned int flags,
+                                    void* opaque_state, size_t opaque_len) {
+  return GetRandom(buf, len, flags, opaque_state, opaque_len);
+}
+
 #elif __aarch64__
 
 // __kernel_clock_gettime() implements clock_gettime()
@@ -132,27 +187,14 @@ extern "C" int __kernel_gettimeofday(struct timeval* tv, struct timezone* tz) {
 
 // __kernel_clock_getres() implements clock_getres()
 extern "C" int __kernel_clock_getres(clockid_t clock, struct timespec* res) {
-  int ret = 0;
-
-  switch (clock) {
-    case CLOCK_REALTIME:
-    case CLOCK_MONOTONIC:
-    case CLOCK_BOOTTIME: {
-      if (res == nullptr) {
-        return 0;
-      }
-
-      res->tv_sec = 0;
-      res->tv_nsec = 1;
-      break;
-    }
-
-    default:
-      ret = sys_clock_getres(clock, res);
-      break;
-  }
+  return __common_clock_getres(clock, res);
+}
 
-  return ret;
+// __kernel_getrandom() implements getrandom()
+extern "C" ssize_t __kernel_getrandom(void* buf, size_t len,
+                                      unsigned int flags, void* opaque_state,
+                                      size_t opaque_len) {
+  return GetRandom(buf, len, flags, opaque_state, opaque_len);
 }
 
 #else
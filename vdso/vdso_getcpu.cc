@@ -0,0 +1,67 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vdso/vdso_getcpu.h"
+
+#include <stdint.h>
+
+#include "vdso/params.h"
+#include "vdso/seqlock.h"
+#include "vdso/syscalls.h"
+
+namespace vdso {
+
+#if __x86_64__
+
+// read_tsc_aux returns the value of IA32_TSC_AUX on the current CPU.
+static inline uint32_t read_tsc_aux(void) {
+  uint32_t lo, hi, aux;
+  asm volatile("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux));
+  return aux;
+}
+
+// GetCPU() is the VDSO implementation of getcpu(). The cache argument has
+// been unused by Linux since 2.6.24 and is ignored here too.
+long GetCPU(unsigned* cpu, unsigned* node, struct getcpu_cache* cache) {
+  struct params* params = get_params();
+  uint64_t seq;
+  uint64_t mode;
+  uint32_t now_cpu;
+
+  do {
+    seq = read_seqcount_latch(&params->seq_count);
+    mode = params->data[seq & 1].getcpu_mode;
+    now_cpu = 0;
+    if (mode == kGetcpuTSCAux) {
+      now_cpu = read_tsc_aux();
+    }
+  } while (read_seqcount_latch_retry(&params->seq_count, seq));
+
+  if (mode != kGetcpuSingleCPU && mode != kGetcpuTSCAux) {
+    return sys_getcpu(cpu, node, cache);
+  }
+
+  if (cpu) {
+    *cpu = now_cpu;
+  }
+  // The sentry always reports node 0.
+  if (node) {
+    *node = 0;
+  }
+  return 0;
+}
+
+#endif  // __x86_64__
+
+}  // namespace vdso
@@ -0,0 +1,333 @@
+// Copyright 2026 The gVisor Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// getrandom() in the VDSO, with the same interface as Linux's
+// __vdso_getrandom (Linux 6.11): the caller allocates a state per thread,
+// and random bytes are generated from a key in the state with ChaCha20. The
+// key is fetched with the getrandom system call whenever the sentry changes
+// params_data.rng_generation, and replaced with fresh ChaCha20 output after
+// every call so that earlier output can't be recovered from the state.
+//
+// Compare Linux lib/vdso/getrandom.c.
+
+#include "vdso/vdso_getrandom.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "vdso/barrier.h"
+#include "vdso/compiler.h"
+#include "vdso/params.h"
+#include "vdso/seqlock.h"
+#include "vdso/syscalls.h"
+
+#ifndef MAP_DROPPABLE
+#define MAP_DROPPABLE 0x08
+#endif
+
+namespace vdso {
+namespace {
+
+// Flags accepted by getrandom(2). Any others are left to the sentry to
+// reject.
+constexpr unsigned int kGrndNonblock = 0x1;
+constexpr unsigned int kGrndRandom = 0x2;
+constexpr unsigned int kGrndInsecure = 0x4;
+
+constexpr size_t kPageSize = 4096;
+
+// Largest number of bytes returned by one call, as for Linux's MAX_RW_COUNT.
+constexpr size_t kMaxRWCount = 0x7ffff000;
+
+constexpr size_t kChaChaBlockSize = 64;
+constexpr size_t kChaChaKeySize = 32;
+
+// Number of unused bytes of output kept in struct state after each refill.
+constexpr size_t kBatchSize = 2 * kChaChaBlockSize - kChaChaKeySize;
+
+// struct vgetrandom_opaque_params tells the caller how to allocate states.
+//
+// It must be kept in sync with struct vgetrandom_opaque_params in Linux
+// include/uapi/linux/random.h.
+struct vgetrandom_opaque_params {
+  uint32_t size_of_opaque_state;
+  uint32_t mmap_prot;
+  uint32_t mmap_flags;
+  uint32_t reserved[13];
+};
+
+// struct state is the per-thread state allocated by the caller, which only
+// knows its size, so its layout is private to the VDSO.
+struct state {
+  // Two ChaCha20 blocks of output: kBatchSize bytes of output not yet
+  // returned from pos onwards, followed by the key used for the next blocks.
+  uint8_t batch_key[2 * kChaChaBlockSize];
+
+  // params_data.rng_generation when the key was last fetched from the
+  // sentry. In the child of fork(2), the state is zero-filled by
+  // MAP_DROPPABLE, so this never matches and the child fetches its own key.
+  uint64_t generation;
+
+  // Offset of the first unreturned byte in batch_key.
+  uint8_t pos;
+
+  // Set while GetRandom uses the state, in case a signal handler calls
+  // GetRandom with the same state.
+  bool in_use;
+};
+
+static_assert(kBatchSize <= UINT8_MAX, "pos can't index batch");
+
+template <typename T>
+inline T read_once(const T* p) {
+  return *const_cast<const volatile T*>(p);
+}
+
+template <typename T>
+inline void write_once(T* p, T v) {
+  *const_cast<volatile T*>(p) = v;
+}
+
+// rng_generation returns the current params_data.rng_generation.
+uint64_t rng_generation() {
+  struct params* params = get_params();
+  uint64_t seq;
+  uint64_t gen;
+  do {
+    seq = read_seqcount_latch(&params->seq_count);
+    gen = params->data[seq & 1].rng_generation;
+  } while (read_seqcount_latch_retry(&params->seq_count, seq));
+  return gen;
+}
+
+inline uint32_t load32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+inline void store32(uint8_t* p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+inline uint32_t rotl32(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+inline void quarter_round(uint32_t* x, int a, int b, int c, int d) {
+  x[a] += x[b];
+  x[d] = rotl32(x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = rotl32(x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = rotl32(x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = rotl32(x[b] ^ x[c], 7);
+}
+
+// chacha20_blocks writes nblocks blocks of ChaCha20 output for the key at
+// key, starting with block *counter, to dst, and advances *counter. The nonce
+// is always 0, since each key is only used by a single call to GetRandom.
+//
+// The key is read before any output is written, so dst may overlap it.
+void chacha20_blocks(uint8_t* dst, const uint8_t* key, uint64_t* counter,
+                     size_t nblocks) {
+  uint32_t input[16] = {
+      // "expand 32-byte k"
+      0x61707865,
+      0x3320646e,
+      0x79622d32,
+      0x6b206574,
+  };
+  for (int i = 0; i < 8; i++) {
+    input[4 + i] = load32(key + 4 * i);
+  }
+
+  for (size_t n = 0; n < nblocks; n++) {
+    input[12] = static_cast<uint32_t>(*counter);
+    input[13] = static_cast<uint32_t>(*counter >> 32);
+    uint32_t x[16];
+    for (int i = 0; i < 16; i++) {
+      x[i] = input[i];
+    }
+    for (int i = 0; i < 10; i++) {
+      quarter_round(x, 0, 4, 8, 12);
+      quarter_round(x, 1, 5, 9, 13);
+      quarter_round(x, 2, 6, 10, 14);
+      quarter_round(x, 3, 7, 11, 15);
+      quarter_round(x, 0, 5, 10, 15);
+      quarter_round(x, 1, 6, 11, 12);
+      quarter_round(x, 2, 7, 8, 13);
+      quarter_round(x, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; i++) {
+      store32(dst + 4 * i, x[i] + input[i]);
+    }
+    dst += kChaChaBlockSize;
+    (*counter)++;
+  }
+
+  // Don't leave the key on the stack.
+  volatile uint32_t* v = input;
+  for (int i = 0; i < 16; i++) {
+    v[i] = 0;
+  }
+}
+
+// copy_and_zero copies len bytes from src to dst and zeroes them in src, so
+// that returned bytes can't be recovered from the state.
+//
+// src is volatile so that the compiler can't turn this into calls to memcpy
+// and memset, which the VDSO doesn't have, or drop the zeroing.
+void copy_and_zero(uint8_t* dst, volatile uint8_t* src, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = src[i];
+    src[i] = 0;
+  }
+}
+
+}  // namespace
+
+// GetRandom() is the VDSO implementation of getrandom(). See Linux
+// getrandom_vdso(3).
+ssize_t GetRandom(void* buf, size_t len, unsigned int flags,
+                  void* opaque_state, size_t opaque_len) {
+  // A query for how to allocate states.
+  if (unlikely(opaque_len == ~0UL && buf == nullptr && len == 0 &&
+               flags == 0)) {
+    auto opaque_params =
+        static_cast<struct vgetrandom_opaque_params*>(opaque_state);
+    opaque_params->size_of_opaque_state = sizeof(struct state);
+    opaque_params->mmap_prot = PROT_READ | PROT_WRITE;
+    opaque_params->mmap_flags = MAP_DROPPABLE | MAP_ANONYMOUS;
+    for (int i = 0; i < 13; i++) {
+      opaque_params->reserved[i] = 0;
+    }
+    return 0;
+  }
+
+  auto s = static_cast<struct state*>(opaque_state);
+
+  // The caller must not let a state straddle a page.
+  if (unlikely((reinterpret_cast<uintptr_t>(s) & (kPageSize - 1)) +
+                   sizeof(*s) >
+               kPageSize)) {
+    return -EFAULT;
+  }
+
+  // Leave unknown flags, and states of the wrong size (e.g. after the VDSO
+  // changed across checkpoint/restore), to the sentry.
+  if (unlikely(flags & ~(kGrndNonblock | kGrndRandom | kGrndInsecure)) ||
+      unlikely(opaque_len != sizeof(*s))) {
+    return sys_getrandom(buf, len, flags);
+  }
+
+  uint64_t gen = rng_generation();
+  if (unlikely(gen == 0)) {
+    return sys_getrandom(buf, len, flags);
+  }
+
+  if (unlikely(len == 0)) {
+    return 0;
+  }
+
+  // A signal handler that interrupts GetRandom and calls it again with the
+  // same state sees in_use set. The handler runs to completion before the
+  // interrupted call resumes, so this needn't be atomic.
+  if (unlikely(read_once(&s->in_use))) {
+    return sys_getrandom(buf, len, flags);
+  }
+  write_once(&s->in_use, true);
+
+  if (len > kMaxRWCount) {
+    len = kMaxRWCount;
+  }
+  bool retried = false;
+
+retry:
+  if (unlikely(read_once(&s->generation) != gen)) {
+    // Store the generation before fetching the key: if the process forks
+    // in between, the child fetches a different key than the parent.
+    write_once(&s->generation, gen);
+    barrier();
+
+    uint8_t* key = s->batch_key + kBatchSize;
+    if (sys_getrandom(key, kChaChaKeySize, 0) !=
+        static_cast<long>(kChaChaKeySize)) {
+      write_once(&s->generation, static_cast<uint64_t>(0));
+      write_once(&s->in_use, false);
+      return sys_getrandom(buf, len, flags);
+    }
+
+    // The batch was generated from the previous key; discard it.
+    s->pos = kBatchSize;
+  }
+
+  {
+    uint8_t* dst = static_cast<uint8_t*>(buf);
+    size_t remaining = len;
+    uint64_t counter = 0;
+    while (true) {
+      // First return output left over from the previous call.
+      size_t n = kBatchSize - s->pos;
+      if (n > remaining) {
+        n = remaining;
+      }
+      copy_and_zero(dst, s->batch_key + s->pos, n);
+      s->pos += n;
+      dst += n;
+      remaining -= n;
+      if (remaining == 0) {
+        break;
+      }
+
+      // Generate whole blocks directly into the buffer.
+      size_t nblocks = remaining / kChaChaBlockSize;
+      if (nblocks != 0) {
+        chacha20_blocks(dst, s->batch_key + kBatchSize, &counter, nblocks);
+        dst += nblocks * kChaChaBlockSize;
+        remaining -= nblocks * kChaChaBlockSize;
+      }
+
+      // Refill the batch, which also replaces the key.
+      chacha20_blocks(s->batch_key, s->batch_key + kBatchSize, &counter,
+                      sizeof(s->batch_key) / kChaChaBlockSize);
+      s->pos = 0;
+    }
+  }
+
+  barrier();
+
+  // If the generation changed while generating output, or the state was
+  // zeroed by fork(2) in another thread, the output may be from a key that
+  // is no longer valid. Start over once with a new key, then give up and
+  // make a system call.
+  uint64_t new_gen = rng_generation();
+  if (unlikely(read_once(&s->generation) != new_gen)) {
+    if (retried || new_gen == 0) {
+      write_once(&s->in_use, false);
+      return sys_getrandom(buf, len, flags);
+    }
+    retried = true;
+    gen = new_gen;
+    goto retry;
+  }
+
+  write_once(&s->in_use, false);
+  return len;
+}
+
+}  // namespace vdso
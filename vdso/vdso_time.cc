@@ -19,65 +19,14 @@
 #include <time.h>
 
 #include "vdso/cycle_clock.h"
+#include "vdso/params.h"
 #include "vdso/seqlock.h"
 #include "vdso/syscalls.h"
 
-// struct params defines the layout of the parameter page maintained by the
-// kernel (i.e., sentry).
-//
-// This is similar to the VVAR page maintained by the normal Linux kernel for
-// its VDSO, but it has a different layout.
-//
-// It must be kept in sync with VDSOParamPage in pkg/sentry/kernel/vdso.go.
-struct params {
-  uint64_t seq_count;
-
-  uint64_t monotonic_ready;
-  int64_t monotonic_base_cycles;
-  int64_t monotonic_base_ref;
-  uint64_t monotonic_frequency;
-
-  uint64_t realtime_ready;
-  int64_t realtime_base_cycles;
-  int64_t realtime_base_ref;
-  uint64_t realtime_frequency;
-};
-
-// Returns a pointer to the global parameter page.
-//
-// This page lives in the page just before the VDSO binary itself. The linker
-// defines _params as the page before the VDSO.
-//
-// Ideally, we'd simply declare _params as an extern struct params.
-// Unfortunately various combinations of old/new versions of gcc/clang and
-// gold/bfd struggle to generate references to such a global without generating
-// relocations.
-//
-// So instead, we use inline assembly with a construct that seems to have wide
-// compatibility across many toolchains.
-#if __x86_64__
-
-inline struct params* get_params() {
-  struct params* p = nullptr;
-  asm("leaq _params(%%rip), %0" : "=r"(p) : :);
-  return p;
-}
-
-#elif __aarch64__
-
-inline struct params* get_params() {
-  struct params* p = nullptr;
-  asm("adr %0, _params" : "=r"(p) : :);
-  return p;
-}
-
-#else
-#error "unsupported architecture"
-#endif
-
 namespace vdso {
 
 const uint64_t kNsecsPerSec = 1000000000UL;
+const uint64_t kNsecsPerUsec = 1000UL;
 
 inline struct timespec ns_to_timespec(uint64_t ns) {
   struct timespec ts;
@@ -86,39 +35,90 @@ inline struct timespec ns_to_timespec(uint64_t ns) {
   return ts;
 }
 
-inline uint64_t cycles_to_ns(uint64_t frequency, uint64_t cycles) {
-  uint64_t mult = (kNsecsPerSec << 32) / frequency;
-  return ((unsigned __int128)cycles * mult) >> 32;
+inline uint64_t cycles_to_ns(uint64_t mult, uint64_t shift, uint64_t cycles) {
+  return ((unsigned __int128)cycles * mult) >> shift;
 }
 
-// ClockRealtime() is the VDSO implementation of clock_gettime(CLOCK_REALTIME).
-int ClockRealtime(struct timespec* ts) {
+// clock_read_ns() computes the current time of CLOCK_REALTIME if realtime is
+// true, or of CLOCK_MONOTONIC otherwise, in nanoseconds. It returns false if
+// the sentry has not yet published usable parameters for the clock, in which
+// case the caller must make a system call.
+//
+// If coarse is true, the cycle counter is read without ordering it against
+// earlier instructions. The result may then be earlier than a preceding
+// ordered read by the few cycles the counter read was speculated ahead,
+// which is within the precision callers of the COARSE clocks ask for.
+//
+// If tai is true (which requires realtime), the result is CLOCK_TAI instead,
+// with the offset read from the same generation of parameters as the clock.
+inline bool clock_read_ns(bool realtime, bool coarse, int64_t* ns,
+                          bool tai = false) {
   struct params* params = get_params();
   uint64_t seq;
   uint64_t ready;
   int64_t base_ref;
   int64_t base_cycles;
-  uint64_t frequency;
+  uint64_t mult;
+  uint64_t shift;
   int64_t now_cycles;
+  int64_t offset;
 
   do {
-    seq = read_seqcount_begin(&params->seq_count);
-    ready = params->realtime_ready;
-    base_ref = params->realtime_base_ref;
-    base_cycles = params->realtime_base_cycles;
-    frequency = params->realtime_frequency;
-    now_cycles = cycle_clock();
-  } while (read_seqcount_retry(&params->seq_count, seq));
+    seq = read_seqcount_latch(&params->seq_count);
+    const struct params_data* data = &params->data[seq & 1];
+    const struct clock_params* cp =
+        realtime ? &data->realtime : &data->monotonic;
+    ready = cp->ready;
+    base_ref = cp->base_ref;
+    base_cycles = cp->base_cycles;
+    mult = cp->mult;
+    shift = cp->shift;
+    offset = tai ? data->tai_offset : 0;
+    now_cycles = coarse ? cycle_clock_unordered()
+                        : cycle_clock(data->cycle_clock_mode);
+  } while (read_seqcount_latch_retry(&params->seq_count, seq));
 
   if (!ready) {
     // The sandbox kernel ensures that we won't compute a time later than this
     // once the params are ready.
-    return sys_clock_gettime(CLOCK_REALTIME, ts);
+    return false;
   }
 
   int64_t delta_cycles =
       (now_cycles < base_cycles) ? 0 : now_cycles - base_cycles;
-  int64_t now_ns = base_ref + cycles_to_ns(frequency, delta_cycles);
+  *ns = base_ref + offset + cycles_to_ns(mult, shift, delta_cycles);
+  return true;
+}
+
+// clock_read() computes the current time of clock, which is CLOCK_REALTIME or
+// a variant if realtime is true, or CLOCK_MONOTONIC or a variant otherwise.
+inline int clock_read(bool realtime, clockid_t clock, bool coarse,
+                      struct timespec* ts) {
+  int64_t now_ns;
+  if (!clock_read_ns(realtime, coarse, &now_ns)) {
+    return sys_clock_gettime(clock, ts);
+  }
+  *ts = ns_to_timespec(now_ns);
+  return 0;
+}
+
+// ClockRealtime() is the VDSO implementation of clock_gettime(CLOCK_REALTIME).
+int ClockRealtime(struct timespec* ts) {
+  return clock_read(true, CLOCK_REALTIME, false, ts);
+}
+
+// ClockRealtimeCoarse() is the VDSO implementation of
+// clock_gettime(CLOCK_REALTIME_COARSE).
+int ClockRealtimeCoarse(struct timespec* ts) {
+  return clock_read(true, CLOCK_REALTIME_COARSE, true, ts);
+}
+
+// ClockTAI() is the VDSO implementation of clock_gettime(CLOCK_TAI).
+int ClockTAI(struct timespec* ts) {
+  int64_t now_ns;
+  if (!clock_read_ns(true, false, &now_ns, true)) {
+    return sys_clock_gettime(CLOCK_TAI, ts);
+  }
   *ts = ns_to_timespec(now_ns);
   return 0;
 }
@@ -126,33 +126,48 @@ int ClockRealtime(struct timespec* ts) {
 // ClockMonotonic() is the VDSO implementation of
 // clock_gettime(CLOCK_MONOTONIC).
 int ClockMonotonic(struct timespec* ts) {
-  struct params* params = get_params();
-  uint64_t seq;
-  uint64_t ready;
-  int64_t base_ref;
-  int64_t base_cycles;
-  uint64_t frequency;
-  int64_t now_cycles;
+  return clock_read(false, CLOCK_MONOTONIC, false, ts);
+}
 
-  do {
-    seq = read_seqcount_begin(&params->seq_count);
-    ready = params->monotonic_ready;
-    base_ref = params->monotonic_base_ref;
-    base_cycles = params->monotonic_base_cycles;
-    frequency = params->monotonic_frequency;
-    now_cycles = cycle_clock();
-  } while (read_seqcount_retry(&params->seq_count, seq));
+// ClockMonotonicCoarse() is the VDSO implementation of
+// clock_gettime(CLOCK_MONOTONIC_COARSE).
+int ClockMonotonicCoarse(struct timespec* ts) {
+  return clock_read(false, CLOCK_MONOTONIC_COARSE, true, ts);
+}
 
-  if (!ready) {
-    // The sandbox kernel ensures that we won't compute a time later than this
-    // once the params are ready.
-    return sys_clock_gettime(CLOCK_MONOTONIC, ts);
+// TimeRealtime() is the VDSO implementation of time().
+//
+// Like Linux, time() is served at coarse precision: its result only needs to
+// be accurate to the second.
+time_t TimeRealtime() {
+  int64_t now_ns;
+  if (!clock_read_ns(true, true, &now_ns)) {
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec;
   }
+  return static_cast<uint64_t>(now_ns) / kNsecsPerSec;
+}
 
-  int64_t delta_cycles =
-      (now_cycles < base_cycles) ? 0 : now_cycles - base_cycles;
-  int64_t now_ns = base_ref + cycles_to_ns(frequency, delta_cycles);
-  *ts = ns_to_timespec(now_ns);
+// GettimeofdayRealtime() is the VDSO implementation of gettimeofday() for a
+// non-NULL tv.
+int GettimeofdayRealtime(struct timeval* tv) {
+  int64_t now_ns;
+  if (!clock_read_ns(true, false, &now_ns)) {
+    struct timespec ts;
+    int ret = sys_clock_gettime(CLOCK_REALTIME, &ts);
+    if (ret) {
+      return ret;
+    }
+    tv->tv_sec = ts.tv_sec;
+    tv->tv_usec = ts.tv_nsec / kNsecsPerUsec;
+    return 0;
+  }
+  // Both divisors are constants, so these compile to multiplications by
+  // their reciprocals rather than divisions.
+  uint64_t now_us = static_cast<uint64_t>(now_ns) / kNsecsPerUsec;
+  tv->tv_sec = now_us / (kNsecsPerSec / kNsecsPerUsec);
+  tv->tv_usec = now_us % (kNsecsPerSec / kNsecsPerUsec);
   return 0;
 }
 
@@ -15,12 +15,18 @@
 #ifndef VDSO_VDSO_TIME_H_
 #define VDSO_VDSO_TIME_H_
 
+#include <sys/time.h>
 #include <time.h>
 
 namespace vdso {
 
 int ClockRealtime(struct timespec* ts);
+int ClockRealtimeCoarse(struct timespec* ts);
+int ClockTAI(struct timespec* ts);
 int ClockMonotonic(struct timespec* ts);
+int ClockMonotonicCoarse(struct timespec* ts);
+time_t TimeRealtime();
+int GettimeofdayRealtime(struct timeval* tv);
 
 }  // namespace vdso
 